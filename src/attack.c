@@ -17,6 +17,7 @@
  */
 #include "angband.h"
 
+#include "birth.h"
 #include "cave.h"
 #include "cmds.h"
 #include "game-cmd.h"
@@ -257,7 +258,7 @@ bool py_attack_real(int y, int x)
 {
 	int bonus, chance;
 
-	monster_type *m_ptr = &mon_list[cave_m_idx[y][x]];
+	monster_type *m_ptr = &mon_list[cave->grid[y][x].m_idx];
 	monster_race *r_ptr = &r_info[m_ptr->r_idx];
 	monster_lore *l_ptr = &l_list[m_ptr->r_idx];
 
@@ -285,7 +286,7 @@ bool py_attack_real(int y, int x)
 	if (m_ptr->ml) monster_race_track(m_ptr->r_idx);
 
 	/* Track a new monster */
-	if (m_ptr->ml) health_track(cave_m_idx[y][x]);
+	if (m_ptr->ml) health_track(cave->grid[y][x].m_idx);
 
 	/* Handle player fear (only for invisible monsters) */
 	if (p_ptr->state.afraid)
@@ -412,7 +413,7 @@ bool py_attack_real(int y, int x)
 	}
 
 	/* Damage, check for fear and death */
-	dead = mon_take_hit(cave_m_idx[y][x], dmg, &fear, NULL);
+	dead = mon_take_hit(cave->grid[y][x].m_idx, dmg, &fear, NULL);
 
 	/* Hack -- delay fear messages */
 	if (fear && m_ptr->ml)
@@ -629,9 +630,9 @@ void do_cmd_fire(cmd_code code, cmd_arg args[])
 		}
 
 		/* Handle monster */
-		if (cave_m_idx[y][x] > 0)
+		if (cave->grid[y][x].m_idx > 0)
 		{
-			monster_type *m_ptr = &mon_list[cave_m_idx[y][x]];
+			monster_type *m_ptr = &mon_list[cave->grid[y][x].m_idx];
 			monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
 			int chance2 = chance - distance(p_ptr->py, p_ptr->px, y, x);
@@ -724,7 +725,7 @@ void do_cmd_fire(cmd_code code, cmd_arg args[])
 					if (m_ptr->ml) monster_race_track(m_ptr->r_idx);
 
 					/* Hack -- Track this monster */
-					if (m_ptr->ml) health_track(cave_m_idx[y][x]);
+					if (m_ptr->ml) health_track(cave->grid[y][x].m_idx);
 
 				}
 
@@ -736,7 +737,7 @@ void do_cmd_fire(cmd_code code, cmd_arg args[])
 				}
 
 				/* Hit the monster, check for death */
-				if (mon_take_hit(cave_m_idx[y][x], tdam, &fear, note_dies))
+				if (mon_take_hit(cave->grid[y][x].m_idx, tdam, &fear, note_dies))
 				{
 					/* Dead monster */
 				}
@@ -745,7 +746,7 @@ void do_cmd_fire(cmd_code code, cmd_arg args[])
 				else
 				{
 					/* Message */
-					message_pain(cave_m_idx[y][x], tdam);
+					message_pain(cave->grid[y][x].m_idx, tdam);
 
 					/* Take note */
 					if (fear && m_ptr->ml)
@@ -1019,9 +1020,9 @@ void do_cmd_throw(cmd_code code, cmd_arg args[])
 		}
 
 		/* Handle monster */
-		if (cave_m_idx[y][x] > 0)
+		if (cave->grid[y][x].m_idx > 0)
 		{
-			monster_type *m_ptr = &mon_list[cave_m_idx[y][x]];
+			monster_type *m_ptr = &mon_list[cave->grid[y][x].m_idx];
 			monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
 			int chance2 = chance - distance(p_ptr->py, p_ptr->px, y, x);
@@ -1105,7 +1106,7 @@ void do_cmd_throw(cmd_code code, cmd_arg args[])
 					if (m_ptr->ml) monster_race_track(m_ptr->r_idx);
 
 					/* Hack -- Track this monster */
-					if (m_ptr->ml) health_track(cave_m_idx[y][x]);
+					if (m_ptr->ml) health_track(cave->grid[y][x].m_idx);
 				}
 
 				/* Learn the bonuses */
@@ -1122,7 +1123,7 @@ void do_cmd_throw(cmd_code code, cmd_arg args[])
 							   tdam, m_ptr->hp);
 
 				/* Hit the monster, check for death */
-				if (mon_take_hit(cave_m_idx[y][x], tdam, &fear, note_dies))
+				if (mon_take_hit(cave->grid[y][x].m_idx, tdam, &fear, note_dies))
 				{
 					/* Dead monster */
 				}
@@ -1131,7 +1132,7 @@ void do_cmd_throw(cmd_code code, cmd_arg args[])
 				else
 				{
 					/* Message */
-					message_pain(cave_m_idx[y][x], tdam);
+					message_pain(cave->grid[y][x].m_idx, tdam);
 
 					/* Take note */
 					if (fear && m_ptr->ml)
@@ -1183,3 +1184,270 @@ void textui_cmd_throw(void)
 	cmd_set_arg_item(cmd_get_top(), 0, item);
 	cmd_set_arg_target(cmd_get_top(), 1, dir);
 }
+
+
+/*
+ * Fights longer than this many player turns are called a draw
+ */
+#define MELEE_BENCH_TURNS	1000
+
+/*
+ * Build a level 'plev' character from the first sex, race and class, with
+ * 17 in every stat before adjustments, average hitpoints and the class's
+ * starting kit.
+ */
+static void melee_bench_player(int plev)
+{
+	int i;
+
+	player_init(p_ptr);
+	player_generate(p_ptr, NULL, NULL, NULL);
+
+	for (i = 0; i < A_MAX; i++)
+	{
+		int stat = 17 + rp_ptr->r_adj[i] + cp_ptr->c_adj[i];
+
+		p_ptr->stat_max[i] = p_ptr->stat_cur[i] = MIN(MAX(stat, 3), 18);
+	}
+
+	for (i = 1; i < PY_MAX_LEVEL; i++)
+		p_ptr->player_hp[i] = p_ptr->player_hp[i - 1] +
+		                      (p_ptr->hitdie + 1) / 2;
+
+	p_ptr->lev = p_ptr->max_lev = plev;
+	if (plev > 1)
+		p_ptr->exp = p_ptr->max_exp =
+		             player_exp[plev - 2] * p_ptr->expfact / 100L;
+
+	player_outfit(p_ptr);
+
+	p_ptr->update |= (PU_BONUS | PU_HP | PU_MANA);
+	update_stuff();
+
+	p_ptr->chp = p_ptr->mhp;
+	p_ptr->csp = p_ptr->msp;
+}
+
+/*
+ * Lay out a lit room of 3x4 floor grids around (y, x), with the player at
+ * (y, x), in an otherwise solid level
+ */
+static void melee_bench_arena(int y, int x)
+{
+	int yy, xx;
+
+	wipe_o_list();
+	wipe_mon_list();
+
+	for (yy = y - 1; yy <= y + 1; yy++)
+	{
+		for (xx = x - 1; xx <= x + 2; xx++)
+		{
+			cave->grid[yy][xx].feat = FEAT_FLOOR;
+			cave->grid[yy][xx].info = (CAVE_GLOW | CAVE_ROOM);
+			cave->grid[yy][xx].info2 = 0;
+			cave->grid[yy][xx].m_idx = 0;
+		}
+	}
+
+	player_place(y, x);
+	p_ptr->update |= (PU_UPDATE_VIEW);
+	update_stuff();
+}
+
+static int melee_bench_cmp(const void *a, const void *b)
+{
+	return (*(const int *)a - *(const int *)b);
+}
+
+static void melee_bench_print(const char *what, int *v, int n)
+{
+	long total = 0;
+	int i;
+
+	if (!n) return;
+
+	sort(v, n, sizeof(*v), melee_bench_cmp);
+	for (i = 0; i < n; i++) total += v[i];
+
+	printf("  %-18s mean %7.1f  min %5d  10%% %5d  median %5d  90%% %5d  max %5d\n",
+	       what, (double)total / n, v[0], v[n / 10], v[n / 2],
+	       v[n * 9 / 10], v[n - 1]);
+}
+
+/*
+ * Fight 'count' fresh monsters of race 'r_idx', one at a time, in a room
+ * of their own, and print how the fights went and how fast they were.
+ *
+ * The player and monster take their turns by energy as in the dungeon: the
+ * player through py_attack() and the monster through make_attack_normal().
+ * The monster stands and fights -- it doesn't move or cast spells -- and
+ * poison and cuts don't hurt between turns, though timed effects do run
+ * down.  The player is put back as they were after every fight, and the
+ * messages go nowhere.
+ *
+ * The complex RNG is seeded the same every time, so a run can be repeated
+ * exactly to time a change to the melee code.
+ */
+void melee_benchmark(int r_idx, int plev, int count)
+{
+	int py = DUNGEON_HGT / 2;
+	int px = DUNGEON_WID / 2;
+
+	monster_race *r_ptr;
+	player_type saved;
+	object_type *saved_inven;
+	byte max_num;
+
+	int *turns = C_ZNEW(count, int);
+	int *taken = C_ZNEW(count, int);
+	int *dealt = C_ZNEW(count, int);
+	int won = 0, lost = 0, robbed = 0, drawn = 0;
+
+	clock_t start;
+	double secs;
+	int y, x, i;
+
+	if ((r_idx < 1) || (r_idx >= z_info->r_max) || !r_info[r_idx].name)
+		quit_fmt("No monster race %d to fight", r_idx);
+
+	r_ptr = &r_info[r_idx];
+
+	msg_quiet = TRUE;
+	Rand_quick = FALSE;
+	Rand_state_init(0);
+
+	/* Solid rock everywhere, but for the arena */
+	cave->height = DUNGEON_HGT;
+	cave->width = DUNGEON_WID;
+	for (y = 0; y < DUNGEON_HGT; y++)
+	{
+		for (x = 0; x < DUNGEON_WID; x++)
+		{
+			cave->grid[y][x].feat = FEAT_PERM_SOLID;
+			cave->grid[y][x].info = 0;
+			cave->grid[y][x].info2 = 0;
+			cave->grid[y][x].m_idx = 0;
+		}
+	}
+
+	melee_bench_player(plev);
+	character_dungeon = TRUE;
+
+	/* Deep enough that the monster can be there */
+	p_ptr->depth = MIN(r_ptr->level, MAX_DEPTH - 1);
+
+	max_num = r_ptr->max_num;
+
+	saved = *p_ptr;
+	saved_inven = C_ZNEW(ALL_INVEN_TOTAL, object_type);
+	C_COPY(saved_inven, p_ptr->inventory, ALL_INVEN_TOTAL, object_type);
+
+	start = clock();
+
+	for (i = 0; i < count; i++)
+	{
+		object_type *inven = p_ptr->inventory;
+		monster_type *m_ptr;
+		int m_idx, hp;
+
+		/* Put the player back as they were */
+		*p_ptr = saved;
+		p_ptr->inventory = inven;
+		C_COPY(inven, saved_inven, ALL_INVEN_TOTAL, object_type);
+		r_ptr->max_num = max_num;
+
+		melee_bench_arena(py, px);
+
+		if (!place_monster_aux(py, px + 1, r_idx, FALSE, FALSE))
+			quit_fmt("Couldn't place monster race %d", r_idx);
+
+		m_idx = cave->grid[py][px + 1].m_idx;
+		m_ptr = &mon_list[m_idx];
+		hp = m_ptr->hp;
+		update_mon(m_idx, TRUE);
+
+		while (TRUE)
+		{
+			/* The player's turn */
+			if (p_ptr->energy >= 100)
+			{
+				if (++turns[i] > MELEE_BENCH_TURNS)
+				{
+					drawn++;
+					break;
+				}
+
+				if (p_ptr->timed[TMD_PARALYZED])
+					p_ptr->energy_use = 100;
+				else
+					py_attack(m_ptr->fy, m_ptr->fx);
+
+				p_ptr->energy -= p_ptr->energy_use;
+
+				if (p_ptr->notice) notice_stuff();
+				if (p_ptr->update) update_stuff();
+
+				if (!m_ptr->r_idx)
+				{
+					dealt[i] = hp + 1;
+					won++;
+					break;
+				}
+			}
+
+			/* The monster's turn */
+			if (monster_energy(m_idx) >= 100)
+			{
+				monster_set_energy(m_idx, monster_energy(m_idx) - 100);
+				make_attack_normal(m_idx);
+
+				if (p_ptr->notice) notice_stuff();
+				if (p_ptr->update) update_stuff();
+
+				if (p_ptr->is_dead)
+				{
+					lost++;
+					break;
+				}
+
+				/* Blinked away after stealing */
+				if (distance(py, px, m_ptr->fy, m_ptr->fx) > 1)
+				{
+					robbed++;
+					break;
+				}
+			}
+
+			if (!(turn % 10)) decrease_timeouts();
+
+			p_ptr->energy += extract_energy[p_ptr->state.speed];
+			turn++;
+		}
+
+		if (m_ptr->r_idx) dealt[i] = hp - m_ptr->hp;
+		taken[i] = p_ptr->mhp - p_ptr->chp;
+	}
+
+	secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	printf("%d fights with %s (race %d) as a level %d %s %s in %.2fs",
+	       count, r_ptr->name, r_idx, plev, rp_ptr->name, cp_ptr->name,
+	       secs);
+	if (secs > 0) printf(" (%.0f fights/s)", count / secs);
+	printf("\n");
+
+	printf("  won %d, lost %d, robbed %d, drawn %d\n", won, lost, robbed,
+	       drawn);
+	melee_bench_print("player turns", turns, count);
+	melee_bench_print("HP taken off it", dealt, count);
+	melee_bench_print("HP taken off you", taken, count);
+
+	*p_ptr = saved;
+	FREE(saved_inven);
+	FREE(turns);
+	FREE(taken);
+	FREE(dealt);
+
+	msg_quiet = FALSE;
+}
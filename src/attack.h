@@ -6,5 +6,6 @@
 extern int breakage_chance(const object_type *o_ptr);
 extern bool test_hit(int chance, int ac, int vis);
 extern void py_attack(int y, int x);
+extern void melee_benchmark(int r_idx, int plev, int count);
 
 #endif /* !ATTACK_H */
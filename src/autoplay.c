@@ -0,0 +1,431 @@
+/*
+ * File: autoplay.c
+ * Purpose: A simple automated player, for soak testing
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+#include "angband.h"
+#include "autoplay.h"
+#include "game-cmd.h"
+#include "monster/monster.h"
+#include "object/object.h"
+
+/*
+ * The automated player has no cleverness at all: it fights the nearest
+ * monster it can see, rests when hurt, eats when weak, explores, and takes
+ * the stairs down once a level is explored (or it has been there a while).
+ * It only exists to keep the game busy for long runs -- breeders, piles of
+ * objects, thousands of levels -- to find where it gets slow or leaks.
+ *
+ * Each command it picks goes on the command queue with cmd_insert(), just
+ * where the player's would, so the game itself doesn't know the difference
+ * and nothing ever waits for a key.  To that end every turn gets a command,
+ * "-more-" prompts are cleared automatically and shop entrances are never
+ * stepped on while it plays, and when the character dies it cheats death
+ * and starts again from the town.  Characters it has played are marked as
+ * not scoring.  Should the game still ask for a key, the front end can
+ * answer with an escape through autoplay_answer(), which counts them.
+ *
+ * It knows the grids the character has seen, rather than just those the
+ * game remembers, as torch-lit floor isn't remembered.
+ */
+
+/* Player turns on a level before heading for the stairs anyway */
+#define AUTOPLAY_LEVEL_TURNS	2000
+
+/* Player turns on a level before giving up on finding any stairs */
+#define AUTOPLAY_STUCK_TURNS	5000
+
+/* Commands in a row taking no time before just waiting a turn */
+#define AUTOPLAY_FREE_MAX	4
+
+static bool ap_playing;
+static s32b ap_end_turn;
+static int ap_max_depth;
+static bool ap_old_auto_more;
+
+/* The turn of the last command, and how many in a row came on it */
+static s32b ap_turn;
+static int ap_free;
+
+/* The level being played, and player turns spent on it */
+static int ap_depth;
+static s32b ap_level_start;
+static s32b ap_level_turns;
+
+/* What's been seen of the level */
+static byte ap_seen[DUNGEON_HGT][DUNGEON_WID];
+
+/* The grids searched, and the first step towards each */
+static u16b ap_queue[DUNGEON_HGT * DUNGEON_WID];
+static byte ap_step[DUNGEON_HGT][DUNGEON_WID];
+
+/* What's been done */
+static struct autoplay_stats ap_stats;
+
+
+/*** Knowledge ***/
+
+/*
+ * Whether the character knows what is at (y, x)
+ */
+static bool ap_known(int y, int x)
+{
+	return (ap_seen[y][x] || (cave->grid[y][x].info & CAVE_MARK));
+}
+
+/*
+ * Note the grids in view, starting again on a new level
+ */
+static void ap_look(void)
+{
+	int y, x;
+
+	if ((p_ptr->depth != ap_depth) || (old_turn != ap_level_start))
+	{
+		C_WIPE(ap_seen, DUNGEON_HGT, byte[DUNGEON_WID]);
+		ap_depth = p_ptr->depth;
+		ap_level_start = old_turn;
+		ap_level_turns = 0;
+		ap_stats.levels++;
+		ap_stats.max_depth = MAX(ap_stats.max_depth, p_ptr->depth);
+	}
+
+	for (y = 0; y < cave->height; y++)
+		for (x = 0; x < cave->width; x++)
+			if (player_can_see_bold(y, x)) ap_seen[y][x] = 1;
+}
+
+/*
+ * Whether the character might walk through (y, x), opening or clearing it
+ * if need be
+ */
+static bool ap_passable(int y, int x)
+{
+	int feat = cave->grid[y][x].feat;
+
+	/* Never into the shops */
+	if ((feat >= FEAT_SHOP_HEAD) && (feat <= FEAT_SHOP_TAIL)) return FALSE;
+
+	/* Nor onto known traps */
+	if ((feat >= FEAT_TRAP_HEAD) && (feat <= FEAT_TRAP_TAIL)) return FALSE;
+
+	if (cave_floor_bold(y, x)) return TRUE;
+
+	return ((feat >= FEAT_DOOR_HEAD) && (feat <= FEAT_DOOR_TAIL)) ||
+			(feat == FEAT_RUBBLE);
+}
+
+
+/*** Finding the way ***/
+
+enum ap_goal
+{
+	GOAL_MONSTER,	/* A monster the character can see */
+	GOAL_UNKNOWN,	/* A grid the character hasn't seen */
+	GOAL_MORE,	/* A down staircase */
+	GOAL_LESS	/* An up staircase */
+};
+
+static bool ap_is_goal(int y, int x, enum ap_goal goal)
+{
+	int m_idx = cave->grid[y][x].m_idx;
+
+	switch (goal)
+	{
+		case GOAL_MONSTER:
+			return (m_idx > 0) && mon_list[m_idx].ml;
+
+		case GOAL_UNKNOWN:
+			return !ap_known(y, x);
+
+		case GOAL_MORE:
+			return ap_known(y, x) && (cave->grid[y][x].feat == FEAT_MORE);
+
+		case GOAL_LESS:
+			return ap_known(y, x) && (cave->grid[y][x].feat == FEAT_LESS);
+	}
+
+	return FALSE;
+}
+
+/*
+ * The direction of the first step on the shortest known way to the nearest
+ * `goal`, or 0 if there's none in reach.  The character's own grid isn't a
+ * goal.
+ */
+static int ap_find(enum ap_goal goal)
+{
+	int py = p_ptr->py;
+	int px = p_ptr->px;
+	int head = 0, tail = 0;
+	int i;
+
+	C_WIPE(ap_step, DUNGEON_HGT, byte[DUNGEON_WID]);
+
+	/* The first steps */
+	for (i = 0; i < 8; i++)
+	{
+		int d = ddd[i];
+		int y = py + ddy[d];
+		int x = px + ddx[d];
+
+		if (!in_bounds_fully(y, x)) continue;
+		if (ap_is_goal(y, x, goal)) return d;
+		if (!ap_known(y, x) || !ap_passable(y, x)) continue;
+
+		ap_step[y][x] = d;
+		ap_queue[tail++] = GRID(y, x);
+	}
+
+	ap_step[py][px] = 5;
+
+	/* Spread out from them */
+	while (head < tail)
+	{
+		int g = ap_queue[head++];
+		int gy = GRID_Y(g);
+		int gx = GRID_X(g);
+
+		for (i = 0; i < 8; i++)
+		{
+			int y = gy + ddy_ddd[i];
+			int x = gx + ddx_ddd[i];
+
+			if (!in_bounds_fully(y, x) || ap_step[y][x]) continue;
+			if (ap_is_goal(y, x, goal)) return ap_step[gy][gx];
+			if (!ap_known(y, x) || !ap_passable(y, x)) continue;
+
+			ap_step[y][x] = ap_step[gy][gx];
+			ap_queue[tail++] = GRID(y, x);
+		}
+	}
+
+	return 0;
+}
+
+
+/*** Acting ***/
+
+/*
+ * Step in direction `dir`, first opening, bashing or clearing the way
+ */
+static void ap_step_to(int dir)
+{
+	int y = p_ptr->py + ddy[dir];
+	int x = p_ptr->px + ddx[dir];
+	int feat = cave->grid[y][x].feat;
+	cmd_code code = CMD_WALK;
+
+	/* Monsters are fought wherever they are */
+	if (cave->grid[y][x].m_idx > 0)
+		code = CMD_WALK;
+	else if (feat == FEAT_RUBBLE)
+		code = CMD_TUNNEL;
+	else if ((feat >= FEAT_DOOR_HEAD + 0x08) && (feat <= FEAT_DOOR_TAIL))
+		code = CMD_BASH;
+	else if ((feat >= FEAT_DOOR_HEAD) && (feat <= FEAT_DOOR_TAIL))
+		code = CMD_OPEN;
+
+	cmd_insert(code);
+	cmd_set_arg_direction(cmd_get_top(), 0, dir);
+}
+
+/*
+ * Eat something, if there's anything to eat
+ */
+static bool ap_eat(void)
+{
+	int i;
+
+	for (i = 0; i < INVEN_PACK; i++)
+	{
+		if (!p_ptr->inventory[i].k_idx) continue;
+		if (!obj_is_food(&p_ptr->inventory[i])) continue;
+
+		cmd_insert(CMD_EAT);
+		cmd_set_arg_item(cmd_get_top(), 0, i);
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+/*
+ * Choose the character's next command
+ */
+static void ap_choose(void)
+{
+	bool explored;
+	int dir;
+
+	/* Something has gone wrong; just let time pass */
+	if (ap_free >= AUTOPLAY_FREE_MAX)
+	{
+		cmd_insert(CMD_HOLD);
+		return;
+	}
+
+	/* Eat when weak */
+	if ((p_ptr->food < PY_FOOD_WEAK) && ap_eat()) return;
+
+	/* Fight the nearest monster in view */
+	if (monsters_in_view())
+	{
+		dir = ap_find(GOAL_MONSTER);
+		if (dir)
+		{
+			ap_step_to(dir);
+			return;
+		}
+	}
+
+	/* Rest when hurt and there's nothing about */
+	else if (p_ptr->chp < p_ptr->mhp / 2)
+	{
+		cmd_insert(CMD_REST);
+		cmd_set_arg_choice(cmd_get_top(), 0, REST_ALL_POINTS);
+		return;
+	}
+
+	dir = ap_find(GOAL_UNKNOWN);
+	explored = (dir == 0);
+
+	/* Take the stairs, down until deep enough and then up and down again */
+	if (explored || (ap_level_turns > AUTOPLAY_LEVEL_TURNS))
+	{
+		bool down = (p_ptr->depth < ap_max_depth);
+		int feat = cave->grid[p_ptr->py][p_ptr->px].feat;
+		int stairs_dir;
+
+		if (feat == (down ? FEAT_MORE : FEAT_LESS))
+		{
+			cmd_insert(down ? CMD_GO_DOWN : CMD_GO_UP);
+			return;
+		}
+
+		stairs_dir = ap_find(down ? GOAL_MORE : GOAL_LESS);
+		if (stairs_dir) dir = stairs_dir;
+	}
+
+	if (dir)
+	{
+		ap_step_to(dir);
+		return;
+	}
+
+	/*
+	 * Nowhere to go: fall through the floor, as if through a trapdoor.
+	 * The level only changes once this turn is over, so there still has
+	 * to be a command for it.
+	 */
+	if (ap_level_turns > AUTOPLAY_STUCK_TURNS)
+		dungeon_change_level(MIN(p_ptr->depth + 1, ap_max_depth));
+
+	cmd_insert(CMD_HOLD);
+}
+
+
+/*** Interface ***/
+
+/*
+ * Start playing automatically for `turns` game turns, going no deeper than
+ * `max_depth`
+ */
+void autoplay_start(s32b turns, int max_depth)
+{
+	if (!ap_playing)
+	{
+		ap_old_auto_more = OPT(auto_more);
+		OPT(auto_more) = TRUE;
+	}
+
+	ap_playing = TRUE;
+	ap_end_turn = turn + turns;
+	ap_max_depth = MAX(1, MIN(max_depth, MAX_DEPTH - 1));
+	ap_free = 0;
+	ap_depth = -1;
+
+	p_ptr->noscore |= NOSCORE_BORG;
+}
+
+/*
+ * Stop playing automatically
+ */
+void autoplay_stop(void)
+{
+	if (!ap_playing) return;
+
+	ap_playing = FALSE;
+	OPT(auto_more) = ap_old_auto_more;
+}
+
+/*
+ * Queue the character's next command, if playing automatically.  Returns
+ * FALSE (and stops) once the time is up, leaving the player to choose.
+ */
+bool autoplay_command(void)
+{
+	if (!ap_playing) return FALSE;
+
+	if (turn >= ap_end_turn)
+	{
+		autoplay_stop();
+		return FALSE;
+	}
+
+	/* Count commands which take no time */
+	if (turn == ap_turn) ap_free++;
+	else ap_free = 0;
+	ap_turn = turn;
+
+	ap_look();
+	ap_choose();
+
+	ap_level_turns++;
+	ap_stats.commands++;
+
+	return TRUE;
+}
+
+/*
+ * Whether the character should cheat death, as it is being played
+ * automatically
+ */
+bool autoplay_cheat_death(void)
+{
+	if (!ap_playing) return FALSE;
+
+	ap_stats.deaths++;
+	return TRUE;
+}
+
+/*
+ * Whether a key the game is waiting for should be answered with an escape,
+ * as it is being played automatically
+ */
+bool autoplay_answer(void)
+{
+	if (!ap_playing) return FALSE;
+
+	ap_stats.prompts++;
+	return TRUE;
+}
+
+/*
+ * What has been done while playing automatically
+ */
+void autoplay_get_stats(struct autoplay_stats *stats)
+{
+	*stats = ap_stats;
+	stats->playing = ap_playing;
+}
@@ -0,0 +1,23 @@
+/* autoplay.h - a simple automated player, for soak testing */
+
+#ifndef AUTOPLAY_H
+#define AUTOPLAY_H
+
+struct autoplay_stats
+{
+	bool playing;		/* Still playing */
+	u32b commands;		/* Commands given */
+	u32b levels;		/* Levels played on */
+	u32b deaths;		/* Deaths cheated */
+	u32b prompts;		/* Prompts answered with an escape */
+	int max_depth;		/* Deepest level reached */
+};
+
+extern void autoplay_start(s32b turns, int max_depth);
+extern void autoplay_stop(void);
+extern bool autoplay_command(void);
+extern bool autoplay_cheat_death(void);
+extern bool autoplay_answer(void);
+extern void autoplay_get_stats(struct autoplay_stats *stats);
+
+#endif /* !AUTOPLAY_H */
@@ -22,9 +22,11 @@
 #include "game-event.h"
 #include "game-cmd.h"
 #include "history.h"
+#include "level-cache.h"
 #include "object/inventory.h"
 #include "object/tvalsval.h"
 #include "object/object.h"
+#include "monster/monster.h"
 #include "squelch.h"
 #include "ui-menu.h"
 
@@ -280,6 +282,68 @@ static void get_stats(int stat_use[A_MAX])
 }
 
 
+/*
+ * Most sets of stats the autoroller will roll before giving up
+ */
+#define AUTOROLL_MAX_ROLLS	1000000L
+
+/*
+ * Read the autoroller's minimum stats from a string of up to A_MAX values,
+ * written either as plain numbers or as "18/xx".  Missing values are 3.
+ */
+static void autoroll_parse(const char *s, int mins[A_MAX])
+{
+	int i;
+
+	for (i = 0; i < A_MAX; i++)
+	{
+		int n = 0, pct = 0, len = 0;
+
+		mins[i] = 3;
+
+		if (!s || sscanf(s, " %d%n", &n, &len) < 1) continue;
+		s += len;
+
+		/* "18/xx" values */
+		if (*s == '/' && sscanf(s + 1, "%d%n", &pct, &len) == 1)
+		{
+			s += len + 1;
+			if (pct > 220) pct = 220;
+			n = 18 + pct;
+		}
+
+		mins[i] = n;
+	}
+}
+
+/*
+ * Roll stats as for CMD_ROLL_STATS until every stat, after race and class
+ * bonuses, is at least the minimum given, or AUTOROLL_MAX_ROLLS have been
+ * tried.  Returns the number of rolls, or 0 if none met the minimums (in
+ * which case the last roll is kept).
+ *
+ * The rolls use the RNG just as the same number of manual rerolls would.
+ */
+static long autoroll_stats(int stat_use[A_MAX], const int mins[A_MAX])
+{
+	long rolls;
+
+	for (rolls = 1; rolls <= AUTOROLL_MAX_ROLLS; rolls++)
+	{
+		int i;
+
+		get_stats(stat_use);
+
+		for (i = 0; i < A_MAX; i++)
+			if (stat_use[i] < mins[i]) break;
+
+		if (i == A_MAX) return rolls;
+	}
+
+	return 0;
+}
+
+
 static void roll_hp(void)
 {
 	int i, j, min_value, max_value;
@@ -440,6 +504,9 @@ void player_init(struct player *p) {
 		a_ptr->seen = FALSE;
 	}
 
+	/* No levels to go back to */
+	level_cache_wipe();
+
 
 	/* Start with no quests */
 	for (i = 0; q_list && i < MAX_Q_IDX; i++)
@@ -474,6 +541,9 @@ void player_init(struct player *p) {
 	if (z_info)
 		r_info[z_info->r_max-1].max_num = 0;
 
+	/* All the uniques are alive again */
+	get_mon_num_reset();
+
 
 	/* Hack -- Well fed player */
 	p->food = PY_FOOD_FULL - 1;
@@ -688,6 +758,7 @@ static void recalculate_stats(int *stats, int points_left)
 	event_signal(EVENT_AC);
 	event_signal(EVENT_HP);
 	event_signal(EVENT_STATS);
+	event_signal(EVENT_END);
 }
 
 static void reset_stats(int stats[A_MAX], int points_spent[A_MAX], int *points_left)
@@ -1142,14 +1213,30 @@ void player_birth(bool quickstart_allowed)
 
 			rolled_stats = FALSE;
 		}
-		else if (cmd->command == CMD_ROLL_STATS)
+		else if (cmd->command == CMD_ROLL_STATS ||
+		         cmd->command == CMD_AUTOROLL_STATS)
 		{
 			int i;
 
 			save_roller_data(&prev);
 
 			/* Get a new character */
-			get_stats(stats);
+			if (cmd->command == CMD_ROLL_STATS)
+			{
+				get_stats(stats);
+			}
+
+			/* .string is the minimum stats */
+			else
+			{
+				int mins[A_MAX];
+
+				autoroll_parse(cmd->arg[0].string, mins);
+				string_free((void *) cmd->arg[0].string);
+
+				if (!autoroll_stats(stats, mins))
+					bell("No roll met those minimums.");
+			}
 
 			/* Update stats with bonuses, etc. */
 			get_bonuses();
@@ -1162,6 +1249,7 @@ void player_birth(bool quickstart_allowed)
 			event_signal(EVENT_AC);
 			event_signal(EVENT_HP);
 			event_signal(EVENT_STATS);
+			event_signal(EVENT_END);
 
 			/* Give the UI some dummy info about the points situation. */
 			points_left = 0;
@@ -1189,6 +1277,7 @@ void player_birth(bool quickstart_allowed)
 			event_signal(EVENT_AC);
 			event_signal(EVENT_HP);
 			event_signal(EVENT_STATS);
+			event_signal(EVENT_END);
 		}
 		else if (cmd->command == CMD_NAME_CHOICE)
 		{
@@ -3,6 +3,8 @@
 #ifndef BIRTH_H
 #define BIRTH_H
 
+extern void player_init(struct player *p);
+extern void player_outfit(struct player *p);
 extern void player_generate(struct player *p, const player_sex *s,
                             struct player_race *r, player_class *c);
 
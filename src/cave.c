@@ -17,9 +17,12 @@
  */
 
 #include "angband.h"
+#include "cave.h"
 #include "game-event.h"
 #include "game-cmd.h"
+#include "generate.h"
 #include "object/tvalsval.h"
+#include "perf.h"
 #include "squelch.h"
 
 /*
@@ -48,51 +51,54 @@ int distance(int y1, int x1, int y2, int x2)
 
 
 /*
- * A simple, fast, integer-based line-of-sight algorithm.  By Joseph Hall,
- * 4116 Brewster Drive, Raleigh NC 27606.  Email to jnh@ecemwl.ncsu.edu.
- *
- * This function returns TRUE if a "line of sight" can be traced from the
- * center of the grid (x1,y1) to the center of the grid (x2,y2), with all
- * of the grids along this path (except for the endpoints) being non-wall
- * grids.  Actually, the "chess knight move" situation is handled by some
- * special case code which allows the grid diagonally next to the player
- * to be obstructed, because this yields better gameplay semantics.  This
- * algorithm is totally reflexive, except for "knight move" situations.
- *
- * Because this function uses (short) ints for all calculations, overflow
- * may occur if dx and dy exceed 90.
- *
- * Once all the degenerate cases are eliminated, we determine the "slope"
- * ("m"), and we use special "fixed point" mathematics in which we use a
- * special "fractional component" for one of the two location components
- * ("qy" or "qx"), which, along with the slope itself, are "scaled" by a
- * scale factor equal to "abs(dy*dx*2)" to keep the math simple.  Then we
- * simply travel from start to finish along the longer axis, starting at
- * the border between the first and second tiles (where the y offset is
- * thus half the slope), using slope and the fractional component to see
- * when motion along the shorter axis is necessary.  Since we assume that
- * vision is not blocked by "brushing" the corner of any grid, we must do
- * some special checks to avoid testing grids which are "brushed" but not
- * actually "entered".
+ * Find the distance() from (y, x) to each of the `n` points (ys[i], xs[i]),
+ * capped at 255, in dists[].
  *
- * Angband three different "line of sight" type concepts, including this
- * function (which is used almost nowhere), the "project()" method (which
- * is used for determining the paths of projectables and spells and such),
- * and the "update_view()" concept (which is used to determine which grids
- * are "viewable" by the player, which is used for many things, such as
- * determining which grids are illuminated by the player's torch, and which
- * grids and monsters can be "seen" by the player, etc).
+ * This is written without branches, as max(dy,dx) + min(dy,dx) / 2, so the
+ * compiler can do several points at once.
  */
-bool los(int y1, int x1, int y2, int x2)
+void distance_many(int y, int x, const byte *ys, const byte *xs, byte *dists,
+		int n)
 {
-	/* Delta */
-	int dx, dy;
+	int i;
 
-	/* Absolute */
-	int ax, ay;
+	for (i = 0; i < n; i++)
+	{
+		int ay = abs(ys[i] - y);
+		int ax = abs(xs[i] - x);
+		int d = MAX(ay, ax) + (MIN(ay, ax) >> 1);
+
+		dists[i] = (byte)MIN(d, 255);
+	}
+}
+
+
+/*
+ * Which grids los() has to look at depends only on the offset between
+ * the two ends, so for offsets up to MAX_SIGHT in each direction they are
+ * worked out once, by los_path(), and kept here as offsets from the start
+ * in GRID() terms.  There are paths going south-east and south-west; those
+ * going north are the same, negated.
+ *
+ * No path has more than ay + ax grids on it, which bounds the total.
+ */
+#define LOS_TABLE_SIZE	(MAX_SIGHT + 1)
+#define LOS_TABLE_GRIDS	(LOS_TABLE_SIZE * LOS_TABLE_SIZE * MAX_SIGHT)
 
-	/* Signs */
-	int sx, sy;
+static u16b los_start[LOS_TABLE_SIZE][LOS_TABLE_SIZE];
+static byte los_count[LOS_TABLE_SIZE][LOS_TABLE_SIZE];
+static s16b los_grids[2][LOS_TABLE_GRIDS];
+static bool los_ready = FALSE;
+
+
+/*
+ * Find the grids which must all be open for there to be line of sight from
+ * (0, 0) to (ay, ax), putting them in py[] and px[] and returning how many
+ * there are.  Both offsets are non-negative, and at least one is 2 or more.
+ */
+static int los_path(int ay, int ax, byte *py, byte *px)
+{
+	int n = 0;
 
 	/* Fractions */
 	int qx, qy;
@@ -107,91 +113,41 @@ bool los(int y1, int x1, int y2, int x2)
 	int m;
 
 
-	/* Extract the offset */
-	dy = y2 - y1;
-	dx = x2 - x1;
-
-	/* Extract the absolute offset */
-	ay = ABS(dy);
-	ax = ABS(dx);
-
-
-	/* Handle adjacent (or identical) grids */
-	if ((ax < 2) && (ay < 2)) return (TRUE);
-
-
-	/* Directly South/North */
-	if (!dx)
+	/* Directly South */
+	if (!ax)
 	{
-		/* South -- check for walls */
-		if (dy > 0)
-		{
-			for (ty = y1 + 1; ty < y2; ty++)
-			{
-				if (!cave_floor_bold(ty, x1)) return (FALSE);
-			}
-		}
-
-		/* North -- check for walls */
-		else
+		for (ty = 1; ty < ay; ty++)
 		{
-			for (ty = y1 - 1; ty > y2; ty--)
-			{
-				if (!cave_floor_bold(ty, x1)) return (FALSE);
-			}
+			py[n] = ty; px[n++] = 0;
 		}
 
-		/* Assume los */
-		return (TRUE);
+		return (n);
 	}
 
-	/* Directly East/West */
-	if (!dy)
+	/* Directly East */
+	if (!ay)
 	{
-		/* East -- check for walls */
-		if (dx > 0)
-		{
-			for (tx = x1 + 1; tx < x2; tx++)
-			{
-				if (!cave_floor_bold(y1, tx)) return (FALSE);
-			}
-		}
-
-		/* West -- check for walls */
-		else
+		for (tx = 1; tx < ax; tx++)
 		{
-			for (tx = x1 - 1; tx > x2; tx--)
-			{
-				if (!cave_floor_bold(y1, tx)) return (FALSE);
-			}
+			py[n] = 0; px[n++] = tx;
 		}
 
-		/* Assume los */
-		return (TRUE);
+		return (n);
 	}
 
 
-	/* Extract some signs */
-	sx = (dx < 0) ? -1 : 1;
-	sy = (dy < 0) ? -1 : 1;
-
-
-	/* Vertical "knights" */
-	if (ax == 1)
+	/* Vertical "knights" -- only the grid next to the start matters */
+	if ((ax == 1) && (ay == 2))
 	{
-		if (ay == 2)
-		{
-			if (cave_floor_bold(y1 + sy, x1)) return (TRUE);
-		}
+		py[n] = 1; px[n++] = 0;
+		return (n);
 	}
 
 	/* Horizontal "knights" */
-	else if (ay == 1)
+	if ((ay == 1) && (ax == 2))
 	{
-		if (ax == 2)
-		{
-			if (cave_floor_bold(y1, x1 + sx)) return (TRUE);
-		}
+		py[n] = 0; px[n++] = 1;
+		return (n);
 	}
 
 
@@ -209,43 +165,43 @@ bool los(int y1, int x1, int y2, int x2)
 		qy = ay * ay;
 		m = qy << 1;
 
-		tx = x1 + sx;
+		tx = 1;
 
 		/* Consider the special case where slope == 1. */
 		if (qy == f2)
 		{
-			ty = y1 + sy;
+			ty = 1;
 			qy -= f1;
 		}
 		else
 		{
-			ty = y1;
+			ty = 0;
 		}
 
 		/* Note (below) the case (qy == f2), where */
 		/* the LOS exactly meets the corner of a tile. */
-		while (x2 - tx)
+		while (ax - tx)
 		{
-			if (!cave_floor_bold(ty, tx)) return (FALSE);
+			py[n] = ty; px[n++] = tx;
 
 			qy += m;
 
 			if (qy < f2)
 			{
-				tx += sx;
+				tx++;
 			}
 			else if (qy > f2)
 			{
-				ty += sy;
-				if (!cave_floor_bold(ty, tx)) return (FALSE);
+				ty++;
+				py[n] = ty; px[n++] = tx;
 				qy -= f1;
-				tx += sx;
+				tx++;
 			}
 			else
 			{
-				ty += sy;
+				ty++;
 				qy -= f1;
-				tx += sx;
+				tx++;
 			}
 		}
 	}
@@ -257,46 +213,197 @@ bool los(int y1, int x1, int y2, int x2)
 		qx = ax * ax;
 		m = qx << 1;
 
-		ty = y1 + sy;
+		ty = 1;
 
 		if (qx == f2)
 		{
-			tx = x1 + sx;
+			tx = 1;
 			qx -= f1;
 		}
 		else
 		{
-			tx = x1;
+			tx = 0;
 		}
 
 		/* Note (below) the case (qx == f2), where */
 		/* the LOS exactly meets the corner of a tile. */
-		while (y2 - ty)
+		while (ay - ty)
 		{
-			if (!cave_floor_bold(ty, tx)) return (FALSE);
+			py[n] = ty; px[n++] = tx;
 
 			qx += m;
 
 			if (qx < f2)
 			{
-				ty += sy;
+				ty++;
 			}
 			else if (qx > f2)
 			{
-				tx += sx;
-				if (!cave_floor_bold(ty, tx)) return (FALSE);
+				tx++;
+				py[n] = ty; px[n++] = tx;
 				qx -= f1;
-				ty += sy;
+				ty++;
 			}
 			else
 			{
-				tx += sx;
+				tx++;
 				qx -= f1;
-				ty += sy;
+				ty++;
+			}
+		}
+	}
+
+	return (n);
+}
+
+
+/*
+ * Fill in the table of los() paths
+ */
+static void los_init(void)
+{
+	byte py[2 * MAX_SIGHT], px[2 * MAX_SIGHT];
+	int ay, ax, i;
+	int n = 0;
+
+	for (ay = 0; ay < LOS_TABLE_SIZE; ay++)
+	{
+		for (ax = 0; ax < LOS_TABLE_SIZE; ax++)
+		{
+			los_start[ay][ax] = n;
+
+			/* Adjacent grids need nothing */
+			if ((ax < 2) && (ay < 2))
+				los_count[ay][ax] = 0;
+			else
+				los_count[ay][ax] = los_path(ay, ax, py, px);
+
+			for (i = 0; i < los_count[ay][ax]; i++, n++)
+			{
+				los_grids[0][n] = GRID(py[i], px[i]);
+				los_grids[1][n] = GRID(py[i], 0) - px[i];
 			}
 		}
 	}
 
+	los_ready = TRUE;
+}
+
+
+/*
+ * Check the line of sight between two grids too far apart for the table
+ */
+static bool los_far(int y1, int x1, int dy, int dx)
+{
+	byte py[2 * DUNGEON_WID], px[2 * DUNGEON_WID];
+	int sy = (dy < 0) ? -1 : 1;
+	int sx = (dx < 0) ? -1 : 1;
+	int i, n;
+
+	n = los_path(ABS(dy), ABS(dx), py, px);
+
+	for (i = 0; i < n; i++)
+	{
+		if (!cave_floor_bold(y1 + sy * py[i], x1 + sx * px[i]))
+			return (FALSE);
+	}
+
+	return (TRUE);
+}
+
+
+/*
+ * A simple, fast, integer-based line-of-sight algorithm.  By Joseph Hall,
+ * 4116 Brewster Drive, Raleigh NC 27606.  Email to jnh@ecemwl.ncsu.edu.
+ *
+ * This function returns TRUE if a "line of sight" can be traced from the
+ * center of the grid (x1,y1) to the center of the grid (x2,y2), with all
+ * of the grids along this path (except for the endpoints) being non-wall
+ * grids.  Actually, the "chess knight move" situation is handled by some
+ * special case code which allows the grid diagonally next to the player
+ * to be obstructed, because this yields better gameplay semantics.  This
+ * algorithm is totally reflexive, except for "knight move" situations.
+ *
+ * Because this function uses (short) ints for all calculations, overflow
+ * may occur if dx and dy exceed 90.
+ *
+ * Once all the degenerate cases are eliminated, we determine the "slope"
+ * ("m"), and we use special "fixed point" mathematics in which we use a
+ * special "fractional component" for one of the two location components
+ * ("qy" or "qx"), which, along with the slope itself, are "scaled" by a
+ * scale factor equal to "abs(dy*dx*2)" to keep the math simple.  Then we
+ * simply travel from start to finish along the longer axis, starting at
+ * the border between the first and second tiles (where the y offset is
+ * thus half the slope), using slope and the fractional component to see
+ * when motion along the shorter axis is necessary.  Since we assume that
+ * vision is not blocked by "brushing" the corner of any grid, we must do
+ * some special checks to avoid testing grids which are "brushed" but not
+ * actually "entered".
+ *
+ * The grids to be checked depend only on the offset between the ends, so
+ * los_path() works them out, and for short distances they are looked up in
+ * a table of its results rather than worked out each time.
+ *
+ * Angband three different "line of sight" type concepts, including this
+ * function (which is used almost nowhere), the "project()" method (which
+ * is used for determining the paths of projectables and spells and such),
+ * and the "update_view()" concept (which is used to determine which grids
+ * are "viewable" by the player, which is used for many things, such as
+ * determining which grids are illuminated by the player's torch, and which
+ * grids and monsters can be "seen" by the player, etc).
+ */
+bool los(int y1, int x1, int y2, int x2)
+{
+	/* Delta */
+	int dx, dy;
+
+	/* Absolute */
+	int ax, ay;
+
+	const grid_type *g;
+	const s16b *path;
+	int i, n;
+
+
+	PERF_COUNT(PERF_LOS);
+
+	/* Extract the offset */
+	dy = y2 - y1;
+	dx = x2 - x1;
+
+	/* Extract the absolute offset */
+	ay = ABS(dy);
+	ax = ABS(dx);
+
+
+	/* Handle adjacent (or identical) grids */
+	if ((ax < 2) && (ay < 2)) return (TRUE);
+
+	/* Long paths aren't in the table */
+	if ((ay >= LOS_TABLE_SIZE) || (ax >= LOS_TABLE_SIZE))
+		return (los_far(y1, x1, dy, dx));
+
+	if (!los_ready) los_init();
+
+	/* Look up the path */
+	g = &cave->grid[y1][x1];
+	path = &los_grids[(dx < 0) != (dy < 0)][los_start[ay][ax]];
+	n = los_count[ay][ax];
+
+	/* Check for walls, going south */
+	if (dy >= 0)
+	{
+		for (i = 0; i < n; i++)
+			if (g[path[i]].info & (CAVE_WALL)) return (FALSE);
+	}
+
+	/* Going north, the path is the other way up and round */
+	else
+	{
+		for (i = 0; i < n; i++)
+			if (g[-path[i]].info & (CAVE_WALL)) return (FALSE);
+	}
+
 	/* Assume los */
 	return (TRUE);
 }
@@ -621,19 +728,108 @@ static void special_wall_display(byte *a, char *c, bool in_view, int feat)
 /* 
  * Checks if a square is at the (inner) edge of a trap detect area 
  */ 
-bool dtrap_edge(int y, int x) 
-{ 
-	/* Check if the square is a dtrap in the first place */ 
- 	if (!cave_info2[y][x] & CAVE2_DTRAP) return FALSE; 
+bool dtrap_edge(int y, int x)
+{
+	/* Check if the square is a dtrap in the first place */
+	if (!(cave->grid[y][x].info2 & CAVE2_DTRAP)) return FALSE;
+
+	/* Check for non-dtrap adjacent grids */
+	if (in_bounds_fully(y + 1, x    ) && !(cave->grid[y + 1][x    ].info2 & CAVE2_DTRAP)) return TRUE;
+	if (in_bounds_fully(y    , x + 1) && !(cave->grid[y    ][x + 1].info2 & CAVE2_DTRAP)) return TRUE;
+	if (in_bounds_fully(y - 1, x    ) && !(cave->grid[y - 1][x    ].info2 & CAVE2_DTRAP)) return TRUE;
+	if (in_bounds_fully(y    , x - 1) && !(cave->grid[y    ][x - 1].info2 & CAVE2_DTRAP)) return TRUE;
+
+	return FALSE;
+}
+
+
+/*
+ * How terrain looks depends only on the feature, its lighting, whether it
+ * is in view or on the edge of a trap detect, and a few global settings, so
+ * the results of the lighting functions above are kept in a table.  Each
+ * entry remembers the feature attr/char it was made from, so that changes
+ * from pref files or the knowledge menus are noticed, and the whole table
+ * is forgotten when the settings change.
+ */
+struct feat_visual
+{
+	bool valid;
+	byte src_a;
+	char src_c;
+	byte a;
+	char c;
+};
+
+static struct feat_visual *feat_visuals;
+static int feat_visuals_max;
+static u32b feat_visuals_key;
+
+#define FEAT_VISUAL_IDX(f, lighting, in_view, border) \
+	((((f) * 3 + (lighting)) * 2 + (in_view)) * 2 + (border))
+
+/*
+ * The global settings which the lighting functions use
+ */
+static u32b feat_visual_key(void)
+{
+	return ((u32b)use_graphics << 5) |
+	       (OPT(view_special_light) ? 0x10 : 0) |
+	       (OPT(view_granite_light) ? 0x08 : 0) |
+	       (OPT(view_yellow_light) ? 0x04 : 0) |
+	       (OPT(view_bright_light) ? 0x02 : 0) |
+	       (p_ptr->timed[TMD_BLIND] ? 0x01 : 0);
+}
+
+static const struct feat_visual *feat_visual_get(const grid_data *g)
+{
+	feature_type *f_ptr = &f_info[g->f_idx];
+	struct feat_visual *fv;
+	u32b key = feat_visual_key();
+	int border = (g->trapborder && g->f_idx == FEAT_FLOOR) ? 1 : 0;
+
+	/* Start again if the settings have changed */
+	if (feat_visuals_max != z_info->f_max)
+	{
+		FREE(feat_visuals);
+		feat_visuals_max = z_info->f_max;
+		feat_visuals = C_ZNEW(FEAT_VISUAL_IDX(feat_visuals_max, 0, 0, 0),
+		                      struct feat_visual);
+		feat_visuals_key = key;
+	}
+	else if (feat_visuals_key != key)
+	{
+		C_WIPE(feat_visuals, FEAT_VISUAL_IDX(feat_visuals_max, 0, 0, 0),
+		       struct feat_visual);
+		feat_visuals_key = key;
+	}
+
+	fv = &feat_visuals[FEAT_VISUAL_IDX(g->f_idx, g->lighting,
+	                                   g->in_view ? 1 : 0, border)];
+
+	if (fv->valid && (fv->src_a == f_ptr->x_attr) &&
+	    (fv->src_c == f_ptr->x_char))
+		return fv;
+
+	/* Normal attr and char */
+	fv->src_a = fv->a = f_ptr->x_attr;
+	fv->src_c = fv->c = f_ptr->x_char;
+	fv->valid = TRUE;
 
- 	/* Check for non-dtrap adjacent grids */ 
- 	if (in_bounds_fully(y + 1, x    ) && (!cave_info2[y + 1][x    ] & CAVE2_DTRAP)) return TRUE; 
- 	if (in_bounds_fully(y    , x + 1) && (!cave_info2[y    ][x + 1] & CAVE2_DTRAP)) return TRUE; 
- 	if (in_bounds_fully(y - 1, x    ) && (!cave_info2[y - 1][x    ] & CAVE2_DTRAP)) return TRUE; 
- 	if (in_bounds_fully(y    , x - 1) && (!cave_info2[y    ][x - 1] & CAVE2_DTRAP)) return TRUE; 
+	/* Check for trap detection boundaries */
+	if (border && (use_graphics == GRAPHICS_NONE ||
+	               use_graphics == GRAPHICS_PSEUDO))
+		fv->a = TERM_L_GREEN;
+
+	/* Special lighting effects */
+	if (g->f_idx <= FEAT_INVIS && OPT(view_special_light))
+		special_lighting_floor(&fv->a, &fv->c, g->lighting, g->in_view);
 
-	return FALSE; 
-} 
+	/* Special lighting effects (walls only) */
+	if (g->f_idx > FEAT_INVIS && OPT(view_granite_light))
+		special_wall_display(&fv->a, &fv->c, g->in_view, g->f_idx);
+
+	return fv;
+}
 
 
 /*
@@ -675,27 +871,13 @@ void grid_data_as_text(grid_data *g, byte *ap, char *cp, byte *tap, char *tcp)
 {
 	byte a;
 	char c;
-	
-	feature_type *f_ptr = &f_info[g->f_idx];
-
-	/* Normal attr and char */
-	a = f_ptr->x_attr;
-	c = f_ptr->x_char;
 
-	/* Check for trap detection boundaries */
-	if (g->trapborder && g->f_idx == FEAT_FLOOR &&
-			(use_graphics == GRAPHICS_NONE ||
-				use_graphics == GRAPHICS_PSEUDO))
-		a = TERM_L_GREEN;
+	const struct feat_visual *fv = feat_visual_get(g);
 
-	/* Special lighting effects */
-	if (g->f_idx <= FEAT_INVIS && OPT(view_special_light))
-		special_lighting_floor(&a, &c, g->lighting, g->in_view);
+	/* Terrain attr and char, with lighting */
+	a = fv->a;
+	c = fv->c;
 
-	/* Special lighting effects (walls only) */
-	if (g->f_idx > FEAT_INVIS && OPT(view_granite_light)) 
-		special_wall_display(&a, &c, g->in_view, g->f_idx);
-		
 	/* Save the terrain info for the transparency effects */
 	(*tap) = a;
 	(*tcp) = c;
@@ -944,11 +1126,11 @@ void map_info(unsigned y, unsigned x, grid_data *g)
 	object_type *o_ptr;
 	byte info, info2;
 
-	assert(x < DUNGEON_WID);
-	assert(y < DUNGEON_HGT);
+	assert(x < (unsigned)cave->width);
+	assert(y < (unsigned)cave->height);
 
-	info = cave_info[y][x];
-	info2 = cave_info2[y][x];
+	info = cave->grid[y][x].info;
+	info2 = cave->grid[y][x].info2;
 	
 	/* Default "clear" values, others will be set later where appropriate. */
 	g->first_k_idx = 0;
@@ -956,15 +1138,15 @@ void map_info(unsigned y, unsigned x, grid_data *g)
 	g->lighting = LIGHT_GLOW;
 
 	/* Set things we can work out right now */
-	g->f_idx = cave_feat[y][x];
-	g->in_view = (info & CAVE_SEEN) ? TRUE : FALSE;
-	g->is_player = (cave_m_idx[y][x] < 0) ? TRUE : FALSE;
-	g->m_idx = (g->is_player) ? 0 : cave_m_idx[y][x];
+	g->f_idx = cave->grid[y][x].feat;
+	g->in_view = player_can_see_bold(y, x) ? TRUE : FALSE;
+	g->is_player = (cave->grid[y][x].m_idx < 0) ? TRUE : FALSE;
+	g->m_idx = (g->is_player) ? 0 : cave->grid[y][x].m_idx;
 	g->hallucinate = p_ptr->timed[TMD_IMAGE] ? TRUE : FALSE;
 	g->trapborder = (dtrap_edge(y, x)) ? TRUE : FALSE;
 
 	/* If the grid is memorised or can currently be seen */
-	if ((info & CAVE_MARK) || (info & CAVE_SEEN))
+	if ((info & CAVE_MARK) || g->in_view)
 	{
 		/* Apply "mimic" field */
 		g->f_idx = f_info[g->f_idx].mimic;
@@ -976,7 +1158,7 @@ void map_info(unsigned y, unsigned x, grid_data *g)
 			g->f_idx = FEAT_FLOOR;
 
 			/* Handle currently visible grids */
-			if (info & CAVE_SEEN)
+			if (g->in_view)
 			{
 				/* Only lit by "torch" light */
 				if (info & CAVE_GLOW)
@@ -1301,11 +1483,13 @@ void note_spot(int y, int x)
 	object_type *o_ptr;
 
 	/* Get cave info */
-	info = cave_info[y][x];
+	info = cave->grid[y][x].info;
 
 	/* Require "seen" flag */
-	if (!(info & (CAVE_SEEN))) return;
+	if (!player_can_see_bold(y, x)) return;
 
+	/* Note it as seen, for travelling */
+	cave->grid[y][x].info2 |= (CAVE2_SEEN);
 
 	/* Hack -- memorize objects */
 	for (o_ptr = get_first_object(y, x); o_ptr; o_ptr = get_next_object(o_ptr))
@@ -1319,14 +1503,14 @@ void note_spot(int y, int x)
 	if (!(info & (CAVE_MARK)))
 	{
 		/* Memorize some "boring" grids */
-		if (cave_feat[y][x] <= FEAT_INVIS)
+		if (cave->grid[y][x].feat <= FEAT_INVIS)
 		{
 			/* Option -- memorize certain floors */
 			if (((info & (CAVE_GLOW)) && OPT(view_perma_grids)) ||
 			    OPT(view_torch_grids))
 			{
 				/* Memorize */
-				cave_info[y][x] |= (CAVE_MARK);
+				cave->grid[y][x].info |= (CAVE_MARK);
 			}
 		}
 
@@ -1334,7 +1518,7 @@ void note_spot(int y, int x)
 		else
 		{
 			/* Memorize */
-			cave_info[y][x] |= (CAVE_MARK);
+			cave->grid[y][x].info |= (CAVE_MARK);
 		}
 	}
 }
@@ -1550,31 +1734,117 @@ static byte priority(byte a, char c)
 
 
 /*
- * Display a "small-scale" map of the dungeon in the active Term.
- *
- * Note that this function must "disable" the special lighting effects so
- * that the "priority" function will work.
- *
- * Note the use of a specialized "priority" function to allow this function
- * to work with any graphic attr/char mappings, and the attempts to optimize
- * this function where possible.
- *
- * If "cy" and "cx" are not NULL, then returns the screen location at which
- * the player was displayed, so the cursor can be moved to that location,
- * and restricts the horizontal map size to SCREEN_WID.  Otherwise, nothing
- * is returned (obviously), and no restrictions are enforced.
+ * The size of the "small-scale" map in the active Term, and of the level
+ * it shows.  Returns FALSE if there is no room for it.
  */
-void display_map(int *cy, int *cx)
+static bool display_map_size(int *map_hgt, int *map_wid, int *dungeon_hgt,
+                             int *dungeon_wid)
 {
-	int py = p_ptr->py;
-	int px = p_ptr->px;
+	/* Desired map height */
+	*map_hgt = Term->hgt - 2;
+	*map_wid = Term->wid - 2;
+
+	*dungeon_hgt = cave->height;
+	*dungeon_wid = cave->width;
+
+	/* Prevent accidents */
+	if (*map_hgt > *dungeon_hgt) *map_hgt = *dungeon_hgt;
+	if (*map_wid > *dungeon_wid) *map_wid = *dungeon_wid;
+
+	/* Prevent accidents */
+	return ((*map_wid >= 1) && (*map_hgt >= 1));
+}
+
+/*
+ * Find the place on the "small-scale" map where grid (y, x) is shown
+ */
+static void display_map_place(int y, int x, int map_hgt, int map_wid,
+                              int dungeon_hgt, int dungeon_wid,
+                              int *row, int *col)
+{
+	*row = (y * map_hgt / dungeon_hgt);
+	*col = (x * map_wid / dungeon_wid);
+
+	if (tile_width > 1)
+	{
+	        *col = *col - (*col % tile_width);
+	}
+	if (tile_height > 1)
+	{
+	        *row = *row - (*row % tile_height);
+	}
+}
+
+/*
+ * Get the attr/char at a map location, returning its priority
+ */
+static byte display_map_grid(int y, int x, byte *ap, char *cp)
+{
+	grid_data g;
+
+	map_info(y, x, &g);
+	grid_data_as_text(&g, ap, cp, ap, cp);
+
+	return priority(*ap, *cp);
+}
+
+/*
+ * Draw one place on the "small-scale" map
+ */
+static void display_map_put(int row, int col, byte a, char c)
+{
+	Term_putch(col + 1, row + 1, a, c);
+
+	if ((tile_width > 1) || (tile_height > 1))
+	{
+	        Term_big_putch(col + 1, row + 1, a, c);
+	}
+}
+
+/*
+ * Make sure the player is visible on the "small-scale" map
+ */
+static void display_map_player(int map_hgt, int map_wid, int dungeon_hgt,
+                               int dungeon_wid, int *cy, int *cx)
+{
+	monster_race *r_ptr = &r_info[0];
+	int row, col;
+
+	/* Player location */
+	display_map_place(p_ptr->py, p_ptr->px, map_hgt, map_wid, dungeon_hgt,
+	                  dungeon_wid, &row, &col);
+
+	/* Draw the player */
+	display_map_put(row, col, r_ptr->x_attr, r_ptr->x_char);
+
+	/* Return player location */
+	if (cy != NULL) (*cy) = row + 1;
+	if (cx != NULL) (*cx) = col + 1;
+}
+
 
+/*
+ * Display a "small-scale" map of the dungeon in the active Term.
+ *
+ * Note that this function must "disable" the special lighting effects so
+ * that the "priority" function will work.
+ *
+ * Note the use of a specialized "priority" function to allow this function
+ * to work with any graphic attr/char mappings, and the attempts to optimize
+ * this function where possible.
+ *
+ * If "cy" and "cx" are not NULL, then returns the screen location at which
+ * the player was displayed, so the cursor can be moved to that location,
+ * and restricts the horizontal map size to SCREEN_WID.  Otherwise, nothing
+ * is returned (obviously), and no restrictions are enforced.
+ */
+void display_map(int *cy, int *cx)
+{
 	int map_hgt, map_wid;
 	int dungeon_hgt, dungeon_wid;
 	int row, col;
 
 	int x, y;
-	grid_data g;
 
 	byte ta;
 	char tc;
@@ -1587,21 +1857,8 @@ void display_map(int *cy, int *cx)
 	bool old_view_special_light;
 	bool old_view_granite_light;
 
-	monster_race *r_ptr = &r_info[0];
-
-	/* Desired map height */
-	map_hgt = Term->hgt - 2;
-	map_wid = Term->wid - 2;
-
-	dungeon_hgt = (p_ptr->depth == 0) ? TOWN_HGT : DUNGEON_HGT;
-	dungeon_wid = (p_ptr->depth == 0) ? TOWN_WID : DUNGEON_WID;
-
-	/* Prevent accidents */
-	if (map_hgt > dungeon_hgt) map_hgt = dungeon_hgt;
-	if (map_wid > dungeon_wid) map_wid = dungeon_wid;
-
-	/* Prevent accidents */
-	if ((map_wid < 1) || (map_hgt < 1)) return;
+	if (!display_map_size(&map_hgt, &map_wid, &dungeon_hgt, &dungeon_wid))
+		return;
 
 
 	/* Save lighting effects */
@@ -1613,10 +1870,6 @@ void display_map(int *cy, int *cx)
 	OPT(view_granite_light) = FALSE;
 
 
-	/* Nothing here */
-	ta = TERM_WHITE;
-	tc = ' ';
-
 	/* Clear the priorities */
 	for (y = 0; y < map_hgt; ++y)
 	{
@@ -1636,35 +1889,17 @@ void display_map(int *cy, int *cx)
 	{
 		for (x = 0; x < dungeon_wid; x++)
 		{
-			row = (y * map_hgt / dungeon_hgt);
-			col = (x * map_wid / dungeon_wid);
-
-			if (tile_width > 1)
-			{
-			        col = col - (col % tile_width);
-			}
-			if (tile_height > 1)
-			{
-			        row = row - (row % tile_height);
-			}
+			display_map_place(y, x, map_hgt, map_wid, dungeon_hgt,
+			                  dungeon_wid, &row, &col);
 
-			/* Get the attr/char at that map location */
-			map_info(y, x, &g);
-			grid_data_as_text(&g, &ta, &tc, &ta, &tc);
-
-			/* Get the priority of that attr/char */
-			tp = priority(ta, tc);
+			/* Get the priority of the attr/char at that map location */
+			tp = display_map_grid(y, x, &ta, &tc);
 
 			/* Save "best" */
 			if (mp[row][col] < tp)
 			{
 				/* Add the character */
-				Term_putch(col + 1, row + 1, ta, tc);
-
-				if ((tile_width > 1) || (tile_height > 1))
-				{
-				        Term_big_putch(col + 1, row + 1, ta, tc);
-				}
+				display_map_put(row, col, ta, tc);
 
 				/* Save priority */
 				mp[row][col] = tp;
@@ -1673,39 +1908,105 @@ void display_map(int *cy, int *cx)
 	}
 
 
-	/* Player location */
-	row = (py * map_hgt / dungeon_hgt);
-	col = (px * map_wid / dungeon_wid);
+	/*** Make sure the player is visible ***/
+	display_map_player(map_hgt, map_wid, dungeon_hgt, dungeon_wid, cy, cx);
 
-	if (tile_width > 1)
-	{
-	        col = col - (col % tile_width);
-	}
-	if (tile_height > 1)
-	{
-		row = row - (row % tile_height);
-	}
 
-	/*** Make sure the player is visible ***/
+	/* Restore lighting effects */
+	OPT(view_special_light) = old_view_special_light;
+	OPT(view_granite_light) = old_view_granite_light;
+}
 
-	/* Get the "player" attr */
-	ta = r_ptr->x_attr;
 
-	/* Get the "player" char */
-	tc = r_ptr->x_char;
+/*
+ * Update the "small-scale" map drawn by display_map() in the active Term,
+ * when only the grids in the plane "grids" have changed since.
+ *
+ * Each place on the map which shows one of them is worked out again from
+ * all the grids it covers, in the same order display_map() uses, so the
+ * result is the same as drawing the whole map again.
+ */
+void display_map_grids(const planeword *grids)
+{
+	static planeword done[CAVE_PLANE_SIZE];
 
-	/* Draw the player */
-	Term_putch(col + 1, row + 1, ta, tc);
+	int map_hgt, map_wid;
+	int dungeon_hgt, dungeon_wid;
+	int g;
 
-	if ((tile_width > 1) || (tile_height > 1))
+	bool old_view_special_light;
+	bool old_view_granite_light;
+
+	if (!display_map_size(&map_hgt, &map_wid, &dungeon_hgt, &dungeon_wid))
+		return;
+
+	/* Save and disable lighting effects */
+	old_view_special_light = OPT(view_special_light);
+	old_view_granite_light = OPT(view_granite_light);
+	OPT(view_special_light) = FALSE;
+	OPT(view_granite_light) = FALSE;
+
+	plane_wipe(done, CAVE_PLANE_SIZE);
+
+	for (g = plane_next(grids, CAVE_PLANE_SIZE, 0); g >= 0;
+	     g = plane_next(grids, CAVE_PLANE_SIZE, g + 1))
 	{
-	        Term_big_putch(col + 1, row + 1, ta, tc);
+		int row, col;
+		int y, x, y0, y1, x0, x1;
+		int th = MAX(tile_height, 1);
+		int tw = MAX(tile_width, 1);
+
+		byte best = 0;
+		byte ba = TERM_WHITE;
+		char bc = ' ';
+
+		if ((GRID_Y(g) >= dungeon_hgt) || (GRID_X(g) >= dungeon_wid))
+			continue;
+
+		display_map_place(GRID_Y(g), GRID_X(g), map_hgt, map_wid,
+		                  dungeon_hgt, dungeon_wid, &row, &col);
+
+		/* Each place only needs doing once */
+		if (plane_has(done, GRID(row, col))) continue;
+		plane_on(done, GRID(row, col));
+
+		/* The grids which can be shown there */
+		y0 = (row * dungeon_hgt + map_hgt - 1) / map_hgt;
+		y1 = MIN(((row + th) * dungeon_hgt + map_hgt - 1) / map_hgt,
+		         dungeon_hgt);
+		x0 = (col * dungeon_wid + map_wid - 1) / map_wid;
+		x1 = MIN(((col + tw) * dungeon_wid + map_wid - 1) / map_wid,
+		         dungeon_wid);
+
+		for (y = y0; y < y1; y++)
+		{
+			for (x = x0; x < x1; x++)
+			{
+				int r, c;
+				byte ta;
+				char tc;
+				byte tp;
+
+				display_map_place(y, x, map_hgt, map_wid, dungeon_hgt,
+				                  dungeon_wid, &r, &c);
+				if ((r != row) || (c != col)) continue;
+
+				/* Keep the first "best", as display_map() does */
+				tp = display_map_grid(y, x, &ta, &tc);
+				if (tp > best)
+				{
+					best = tp;
+					ba = ta;
+					bc = tc;
+				}
+			}
+		}
+
+		if (best) display_map_put(row, col, ba, bc);
 	}
-  
-	/* Return player location */
-	if (cy != NULL) (*cy) = row + 1;
-	if (cx != NULL) (*cx) = col + 1;
 
+	display_map_player(map_hgt, map_wid, dungeon_hgt, dungeon_wid, NULL,
+	                   NULL);
 
 	/* Restore lighting effects */
 	OPT(view_special_light) = old_view_special_light;
@@ -1829,15 +2130,14 @@ void do_cmd_view_map(void)
  * the special effects lighting code, and for the efficient redisplay of any
  * grids whose visual representation may have changed.
  *
- * Several pieces of information about each cave grid are stored in various
- * two dimensional arrays, with one unit of information for each grid in the
- * dungeon.  Some of these arrays have been intentionally expanded by a small
- * factor to make the two dimensional array accesses faster by allowing the
- * use of shifting instead of multiplication.
+ * The information about each cave grid is stored in a single "grid_type"
+ * record in the "cave->grid" array, so that one grid costs one cache line.
+ * The rows of this array have been intentionally expanded by a small factor
+ * to make the two dimensional array accesses faster by allowing the use of
+ * shifting instead of multiplication.
  *
  * Several pieces of information about each cave grid are stored in the
- * "cave_info" array, which is a special two dimensional array of bytes,
- * one for each cave grid, each containing eight separate "flags" which
+ * "info" field of its record, a byte containing eight separate "flags" which
  * describe some property of the cave grid.  These flags can be checked and
  * modified extremely quickly, especially when special idioms are used to
  * force the compiler to keep a local register pointing to the base of the
@@ -1906,13 +2206,16 @@ void do_cmd_view_map(void)
  * and "update_view()" whenever the "CAVE_WALL" or "CAVE_GLOW" flags change
  * for a grid which has "CAVE_VIEW" set.  This flag must be very fast.
  *
+ * The "CAVE_VIEW" and "CAVE_SEEN" flags are not stored in "info", but in
+ * the "cave->view" and "cave->seen" bitplanes (one bit per "grid" value),
+ * so that they can be cleared and compared a machine word at a time.
+ *
  * The "CAVE_TEMP" flag is used for a variety of temporary purposes.  This
- * flag is used to determine if the "CAVE_SEEN" flag for a grid has changed
- * during the "update_view()" function.  This flag is used to "spread" light
- * or darkness through a room.  This flag is used by the "monster flow code".
- * This flag must always be cleared by any code which sets it, often, this
- * can be optimized by the use of the special "temp_g", "temp_y", "temp_x"
- * arrays (and the special "temp_n" global).  This flag must be very fast.
+ * flag is used to "spread" light or darkness through a room.  This flag is
+ * used by the "monster flow code".  This flag must always be cleared by any
+ * code which sets it, often, this can be optimized by the use of the special
+ * "temp_g", "temp_y", "temp_x" arrays (and the special "temp_n" global).
+ * This flag must be very fast.
  *
  * Note that the "CAVE_MARK" flag is used for many reasons, some of which
  * are strictly for optimization purposes.  The "CAVE_MARK" flag means that
@@ -2586,7 +2889,152 @@ errr vinfo_init(void)
 
 
 /*
- * Forget the "CAVE_VIEW" grids, redrawing as needed
+ * Incremental "update_view()" state
+ *
+ * Each octant of the field of view is cast on its own, and the grids it
+ * found are remembered here, with their distance from the player and
+ * whether they would be "seen" by their own light.  The player's light is
+ * only applied when the octants are put together, so while the player stays
+ * put only those octants which contain a grid whose wall or light state has
+ * changed since they were cast (see "view_grid_changed()") need to be cast
+ * again, whatever happens to the light radius.
+ */
+static struct
+{
+	bool valid;
+
+	int py;
+	int px;
+	int radius;
+
+	byte dirty;
+
+	int n[8];
+	u16b g[8][VINFO_MAX_GRIDS];
+	byte d[8][VINFO_MAX_GRIDS];
+	byte glow[8][VINFO_MAX_GRIDS];
+} view_cache;
+
+
+/*
+ * The grids lit by each light-carrying monster, as they were last worked
+ * out.  They only change when the monster or the player moves or the walls
+ * change, so most calls to "update_view()" just copy them.
+ */
+struct monster_light
+{
+	s16b r_idx;
+	byte fy, fx;
+	byte py, px;
+	u32b stamp;
+
+	byte n;
+	u16b g[9];
+};
+
+static struct monster_light *monster_lights;
+static int monster_lights_size;
+
+/* Changed whenever the walls may have, making all monster lights stale */
+static u32b light_stamp;
+
+
+/*
+ * Memo of "projectable(y, x, py, px, PROJECT_NONE)" for the current player
+ * grid, filled in lazily as monsters ask for it.
+ *
+ * Only walls can block such a projection, so the memo stays good until the
+ * player moves or "view_grid_changed()" reports a terrain change.
+ */
+static planeword proj_known[CAVE_PLANE_SIZE];
+static planeword proj_ok[CAVE_PLANE_SIZE];
+static bool proj_empty = TRUE;
+static int proj_py = -1;
+static int proj_px = -1;
+
+
+/*
+ * Forget the memo of projections to the player
+ *
+ * This is done for every terrain change, including the many thousands made
+ * while a level is being generated, so the wipe is skipped when there is
+ * nothing to forget.
+ */
+static void proj_forget(void)
+{
+	if (proj_empty) return;
+
+	plane_wipe(proj_known, CAVE_PLANE_SIZE);
+	proj_empty = TRUE;
+}
+
+
+/*
+ * Note that the "CAVE_WALL" or "CAVE_GLOW" flag of some grids in the
+ * rectangle from (y1, x1) to (y2, x2) has changed.
+ *
+ * This marks the octants which contain any grid of the rectangle, or next to
+ * it (walls are lit by their neighbours), as needing to be cast again by the
+ * next "update_view()".  The caller must still ask for PU_UPDATE_VIEW.
+ */
+void view_area_changed(int y1, int x1, int y2, int x2)
+{
+	int o2;
+
+	/* The rectangle and its neighbours, relative to the player */
+	int dy1 = y1 - 1 - view_cache.py, dy2 = y2 + 1 - view_cache.py;
+	int dx1 = x1 - 1 - view_cache.px, dx2 = x2 + 1 - view_cache.px;
+
+	/* Projections to the player, and monster lights, may have changed */
+	proj_forget();
+	light_stamp++;
+
+	if (!view_cache.valid) return;
+
+	/*
+	 * In octant-relative offsets (see "vinfo_init()") the rectangle is still
+	 * one, from (ay1, ax1) to (ay2, ax2), and an octant holds the grids with
+	 * 0 <= oy <= ox: it meets the rectangle if the nearest grid to the
+	 * player of the rectangle in the octant is in sight.
+	 */
+	for (o2 = 0; o2 < 8; o2++)
+	{
+		int ay1, ay2, ax1, ax2;
+		int ny, nx;
+
+		switch (o2)
+		{
+			case 0: ay1 = dy1; ay2 = dy2; ax1 = dx1; ax2 = dx2; break;
+			case 1: ay1 = dx1; ay2 = dx2; ax1 = dy1; ax2 = dy2; break;
+			case 2: ay1 = -dx2; ay2 = -dx1; ax1 = dy1; ax2 = dy2; break;
+			case 3: ay1 = dy1; ay2 = dy2; ax1 = -dx2; ax2 = -dx1; break;
+			case 4: ay1 = -dy2; ay2 = -dy1; ax1 = -dx2; ax2 = -dx1; break;
+			case 5: ay1 = -dx2; ay2 = -dx1; ax1 = -dy2; ax2 = -dy1; break;
+			case 6: ay1 = dx1; ay2 = dx2; ax1 = -dy2; ax2 = -dy1; break;
+			default: ay1 = -dy2; ay2 = -dy1; ax1 = dx1; ax2 = dx2; break;
+		}
+
+		ny = MAX(ay1, 0);
+		nx = MAX(ax1, ny);
+
+		if ((ay2 < ny) || (ax2 < nx)) continue;
+		if (distance(0, 0, ny, nx) > MAX_SIGHT) continue;
+
+		view_cache.dirty |= (1 << o2);
+	}
+}
+
+/*
+ * Note that the "CAVE_WALL" or "CAVE_GLOW" flag of a grid has changed.
+ */
+void view_grid_changed(int y, int x)
+{
+	view_area_changed(y, x, y, x);
+}
+
+
+/*
+ * Forget the "view" grids, redrawing as needed
  */
 void forget_view(void)
 {
@@ -2595,32 +3043,32 @@ void forget_view(void)
 	int fast_view_n = view_n;
 	u16b *fast_view_g = view_g;
 
-	byte *fast_cave_info = &cave_info[0][0];
 
+	/* The next update_view() must start from scratch */
+	view_cache.valid = FALSE;
+	light_stamp++;
+
+	/* As must any projections to the player */
+	proj_forget();
+
+	/* And anything else built from the view */
+	cave->view_stamp++;
 
 	/* None to forget */
 	if (!fast_view_n) return;
 
-	/* Clear them all */
+	/* Clear the "view" and "seen" planes */
+	plane_wipe(cave->view, CAVE_PLANE_SIZE);
+	plane_wipe(cave->seen, CAVE_PLANE_SIZE);
+
+	/* Redraw them all */
 	for (i = 0; i < fast_view_n; i++)
 	{
-		int y, x;
-
 		/* Grid */
 		g = fast_view_g[i];
 
-		/* Location */
-		y = GRID_Y(g);
-		x = GRID_X(g);
-
-		/* Clear "CAVE_VIEW" and "CAVE_SEEN" flags */
-		fast_cave_info[g] &= ~(CAVE_VIEW | CAVE_SEEN);
-
-		/* Clear "CAVE_LIGHT" flag */
-		/* fast_cave_info[g] &= ~(CAVE_LIGHT); */
-
 		/* Redraw */
-		light_spot(y, x);
+		light_spot(GRID_Y(g), GRID_X(g));
 	}
 
 	/* None left */
@@ -2634,66 +3082,345 @@ void forget_view(void)
 
 
 /*
- * Calculate the complete field of view using a new algorithm
- *
- * If "view_g" and "temp_g" were global pointers to arrays of grids, as
- * opposed to actual arrays of grids, then we could be more efficient by
- * using "pointer swapping".
- *
- * Note the following idiom, which is used in the function below.
- * This idiom processes each "octant" of the field of view, in a
- * clockwise manner, starting with the east strip, south side,
- * and for each octant, allows a simple calculation to set "g"
- * equal to the proper grids, relative to "pg", in the octant.
- *
- *   for (o2 = 0; o2 < 8; o2++)
- *   ...
- *         g = pg + p->grid[o2];
- *   ...
- *
- *
- * Normally, vision along the major axes is more likely than vision
- * along the diagonal axes, so we check the bits corresponding to
- * the lines of sight near the major axes first.
- *
- * We use the "temp_g" array (and the "CAVE_TEMP" flag) to keep track of
- * which grids were previously marked "CAVE_SEEN", since only those grids
- * whose "CAVE_SEEN" value changes during this routine must be redrawn.
- *
- * This function is now responsible for maintaining the "CAVE_SEEN"
- * flags as well as the "CAVE_VIEW" flags, which is good, because
- * the only grids which normally need to be memorized and/or redrawn
- * are the ones whose "CAVE_SEEN" flag changes during this routine.
- *
- * Basically, this function divides the "octagon of view" into octants of
- * grids (where grids on the main axes and diagonal axes are "shared" by
- * two octants), and processes each octant one at a time, processing each
- * octant one grid at a time, processing only those grids which "might" be
- * viewable, and setting the "CAVE_VIEW" flag for each grid for which there
- * is an (unobstructed) line of sight from the center of the player grid to
- * any internal point in the grid (and collecting these "CAVE_VIEW" grids
- * into the "view_g" array), and setting the "CAVE_SEEN" flag for the grid
- * if, in addition, the grid is "illuminated" in some way.
- *
- * This function relies on a theorem (suggested and proven by Mat Hostetter)
- * which states that in each octant of a field of view, a given grid will
- * be "intersected" by one or more unobstructed "lines of sight" from the
- * center of the player grid if and only if it is "intersected" by at least
- * one such unobstructed "line of sight" which passes directly through some
- * corner of some grid in the octant which is not shared by any other octant.
- * The proof is based on the fact that there are at least three significant
- * lines of sight involving any non-shared grid in any octant, one which
- * intersects the grid and passes though the corner of the grid closest to
- * the player, and two which "brush" the grid, passing through the "outer"
- * corners of the grid, and that any line of sight which intersects a grid
- * without passing through the corner of a grid in the octant can be "slid"
- * slowly towards the corner of the grid closest to the player, until it
- * either reaches it or until it brushes the corner of another grid which
- * is closer to the player, and in either case, the existanc of a suitable
- * line of sight is thus demonstrated.
+ * Cast a single octant of the field of view into the "view_cache".
  *
- * It turns out that in each octant of the radius 20 "octagon of view",
- * there are 161 grids (with 128 not shared by any other octant), and there
+ * See "update_view()" for the algorithm.
+ */
+static void update_view_octant(int o2, int pg, int py, int px)
+{
+	grid_type *fast_cave_grid = &cave->grid[0][0];
+
+	vinfo_type *p;
+
+	/* Last added */
+	vinfo_type *last = &vinfo[0];
+
+	/* Grid queue */
+	int queue_head = 0;
+	int queue_tail = 0;
+	vinfo_type *queue[VINFO_MAX_GRIDS*2];
+
+	/* Grids already recorded (the player grid is handled elsewhere) */
+	bool done[VINFO_MAX_GRIDS];
+
+	/* Slope bit vector */
+	u32b bits0 = VINFO_BITS_0;
+	u32b bits1 = VINFO_BITS_1;
+	u32b bits2 = VINFO_BITS_2;
+	u32b bits3 = VINFO_BITS_3;
+
+	int n = 0;
+
+	memset(done, 0, sizeof(done));
+	done[0] = TRUE;
+
+	/* Initial grids */
+	queue[queue_tail++] = &vinfo[1];
+	queue[queue_tail++] = &vinfo[2];
+
+	/* Process queue */
+	while (queue_head < queue_tail)
+	{
+		int e;
+		int g;
+		byte info;
+
+		/* Dequeue next grid */
+		p = queue[queue_head++];
+
+		/* Check bits */
+		if (!((bits0 & (p->bits_0)) ||
+		      (bits1 & (p->bits_1)) ||
+		      (bits2 & (p->bits_2)) ||
+		      (bits3 & (p->bits_3))))
+			continue;
+
+		/* Extract grid value XXX XXX XXX */
+		e = p - vinfo;
+		g = pg + p->grid[o2];
+
+		/* Get grid info */
+		info = fast_cave_grid[g].info;
+
+		/* Handle wall */
+		if (info & (CAVE_WALL))
+		{
+			/* Clear bits */
+			bits0 &= ~(p->bits_0);
+			bits1 &= ~(p->bits_1);
+			bits2 &= ~(p->bits_2);
+			bits3 &= ~(p->bits_3);
+
+			/* Newly viewable wall */
+			if (!done[e])
+			{
+				bool seen = FALSE;
+
+				done[e] = TRUE;
+
+				/* Perma-lit grids */
+				if (info & (CAVE_GLOW))
+				{
+					int y = GRID_Y(g);
+					int x = GRID_X(g);
+
+					/* Hack -- move towards player */
+					int yy = (y < py) ? (y + 1) : (y > py) ? (y - 1) : y;
+					int xx = (x < px) ? (x + 1) : (x > px) ? (x - 1) : x;
+
+					/* Check for "simple" illumination */
+					if (cave->grid[yy][xx].info & (CAVE_GLOW))
+						seen = TRUE;
+				}
+
+				/* Remember the grid */
+				view_cache.g[o2][n] = g;
+				view_cache.d[o2][n] = p->d;
+				view_cache.glow[o2][n++] = seen;
+			}
+		}
+
+		/* Handle non-wall */
+		else
+		{
+			/* Enqueue child */
+			if (last != p->next_0)
+			{
+				queue[queue_tail++] = last = p->next_0;
+			}
+
+			/* Enqueue child */
+			if (last != p->next_1)
+			{
+				queue[queue_tail++] = last = p->next_1;
+			}
+
+			/* Newly viewable non-wall */
+			if (!done[e])
+			{
+				done[e] = TRUE;
+
+				/* Remember the grid (and whether it's perma-lit) */
+				view_cache.g[o2][n] = g;
+				view_cache.d[o2][n] = p->d;
+				view_cache.glow[o2][n++] = (info & (CAVE_GLOW)) ? TRUE : FALSE;
+			}
+		}
+	}
+
+	view_cache.n[o2] = n;
+}
+
+
+/*
+ * Work out the grids lit by monster `m_ptr`, for the player at (py, px):
+ * the 3x3 box centered on it, less what the player can't see, and walls if
+ * the player can't see the monster.
+ */
+static void update_view_monster_light(struct monster_light *light,
+		const monster_type *m_ptr, int py, int px)
+{
+	int fy = m_ptr->fy;
+	int fx = m_ptr->fx;
+	bool in_los = los(py, px, fy, fx);
+	int i, j;
+
+	light->r_idx = m_ptr->r_idx;
+	light->fy = fy;
+	light->fx = fx;
+	light->py = py;
+	light->px = px;
+	light->stamp = light_stamp;
+	light->n = 0;
+
+	for (i = -1; i <= 1; i++)
+	{
+		for (j = -1; j <= 1; j++)
+		{
+			int sy = fy + i;
+			int sx = fx + j;
+
+			/* If the monster isn't visible we can only light open tiles */
+			if (!in_los && !cave_floor_bold(sy, sx))
+				continue;
+
+			/* If the tile is too far away we won't light it */
+			if (distance(py, px, sy, sx) > MAX_SIGHT)
+				continue;
+
+			/* If the tile itself isn't in LOS, don't light it */
+			if (!los(py, px, sy, sx))
+				continue;
+
+			light->g[light->n++] = GRID(sy, sx);
+		}
+	}
+}
+
+
+/*
+ * Build the "view" and "seen" planes and the "view_g" array from the cast
+ * octants, the player grid, and any light-carrying monsters.
+ */
+static void update_view_assemble(int pg, int radius)
+{
+	int py = GRID_Y(pg);
+	int px = GRID_X(pg);
+
+	int i, k, g, o2;
+
+	int fast_view_n = 0;
+	u16b *fast_view_g = view_g;
+
+	planeword *fast_view = cave->view;
+	planeword *fast_seen = cave->seen;
+
+
+	/* Clear the "view" and "seen" planes */
+	plane_wipe(fast_view, CAVE_PLANE_SIZE);
+	plane_wipe(fast_seen, CAVE_PLANE_SIZE);
+
+	/* Scan monster list and add monster lites */
+	if (monster_lights_size < mon_size)
+	{
+		monster_lights = mem_realloc(monster_lights,
+				mon_size * sizeof(struct monster_light));
+		C_WIPE(monster_lights + monster_lights_size,
+				mon_size - monster_lights_size, struct monster_light);
+		monster_lights_size = mon_size;
+	}
+
+	for (k = 1; k < mon_max; k++)
+	{
+		const monster_type *m_ptr = &mon_list[k];
+		struct monster_light *light = &monster_lights[k];
+
+		/* Skip dead monsters */
+		if (!m_ptr->r_idx) continue;
+
+		/* Skip monsters not carrying lite */
+		if (!rf_has(r_info[m_ptr->r_idx].flags, RF_HAS_LITE)) continue;
+
+		/* Work out what it lights, if that may have changed */
+		if ((light->r_idx != m_ptr->r_idx) || (light->stamp != light_stamp) ||
+		    (light->fy != m_ptr->fy) || (light->fx != m_ptr->fx) ||
+		    (light->py != py) || (light->px != px))
+			update_view_monster_light(light, m_ptr, py, px);
+
+		for (i = 0; i < light->n; i++)
+		{
+			g = light->g[i];
+
+			/* Mark the square lit and seen */
+			plane_on(fast_seen, g);
+
+			/* Save in array */
+			if (!plane_has(fast_view, g))
+			{
+				plane_on(fast_view, g);
+				fast_view_g[fast_view_n++] = g;
+			}
+		}
+	}
+
+	/* Player grid is always viewable */
+	if (!plane_has(fast_view, pg))
+	{
+		plane_on(fast_view, pg);
+		fast_view_g[fast_view_n++] = pg;
+	}
+
+	/* Torch-lit or perma-lit player grid */
+	if ((0 < radius) || (cave->grid[py][px].info & (CAVE_GLOW)))
+		plane_on(fast_seen, pg);
+
+	/* Octant grids */
+	for (o2 = 0; o2 < 8; o2++)
+	{
+		for (i = 0; i < view_cache.n[o2]; i++)
+		{
+			g = view_cache.g[o2][i];
+
+			/* Mark as "seen", if torch-lit or perma-lit */
+			if ((view_cache.d[o2][i] < radius) || view_cache.glow[o2][i])
+				plane_on(fast_seen, g);
+
+			/* Grids on the axes belong to two octants */
+			if (plane_has(fast_view, g)) continue;
+
+			/* Mark as "viewable" and save in array */
+			plane_on(fast_view, g);
+			fast_view_g[fast_view_n++] = g;
+		}
+	}
+
+	/* Save 'view_n' */
+	view_n = fast_view_n;
+}
+
+
+/*
+ * Calculate the complete field of view using a new algorithm
+ *
+ * If "view_g" and "temp_g" were global pointers to arrays of grids, as
+ * opposed to actual arrays of grids, then we could be more efficient by
+ * using "pointer swapping".
+ *
+ * Note the following idiom, which is used in the function below.
+ * This idiom processes each "octant" of the field of view, in a
+ * clockwise manner, starting with the east strip, south side,
+ * and for each octant, allows a simple calculation to set "g"
+ * equal to the proper grids, relative to "pg", in the octant.
+ *
+ *   for (o2 = 0; o2 < 8; o2++)
+ *   ...
+ *         g = pg + p->grid[o2];
+ *   ...
+ *
+ *
+ * Normally, vision along the major axes is more likely than vision
+ * along the diagonal axes, so we check the bits corresponding to
+ * the lines of sight near the major axes first.
+ *
+ * We keep a copy of the old "seen" bitplane to find the grids whose "seen"
+ * state changes during this routine, since only those must be redrawn.  The
+ * copy, the clearing of the planes, and the comparison of the old and new
+ * planes all work a word (64 grids) at a time.
+ *
+ * This function is now responsible for maintaining the "CAVE_SEEN"
+ * flags as well as the "CAVE_VIEW" flags, which is good, because
+ * the only grids which normally need to be memorized and/or redrawn
+ * are the ones whose "CAVE_SEEN" flag changes during this routine.
+ *
+ * Basically, this function divides the "octagon of view" into octants of
+ * grids (where grids on the main axes and diagonal axes are "shared" by
+ * two octants), and processes each octant one at a time, processing each
+ * octant one grid at a time, processing only those grids which "might" be
+ * viewable, and setting the "CAVE_VIEW" flag for each grid for which there
+ * is an (unobstructed) line of sight from the center of the player grid to
+ * any internal point in the grid (and collecting these "CAVE_VIEW" grids
+ * into the "view_g" array), and setting the "CAVE_SEEN" flag for the grid
+ * if, in addition, the grid is "illuminated" in some way.
+ *
+ * This function relies on a theorem (suggested and proven by Mat Hostetter)
+ * which states that in each octant of a field of view, a given grid will
+ * be "intersected" by one or more unobstructed "lines of sight" from the
+ * center of the player grid if and only if it is "intersected" by at least
+ * one such unobstructed "line of sight" which passes directly through some
+ * corner of some grid in the octant which is not shared by any other octant.
+ * The proof is based on the fact that there are at least three significant
+ * lines of sight involving any non-shared grid in any octant, one which
+ * intersects the grid and passes though the corner of the grid closest to
+ * the player, and two which "brush" the grid, passing through the "outer"
+ * corners of the grid, and that any line of sight which intersects a grid
+ * without passing through the corner of a grid in the octant can be "slid"
+ * slowly towards the corner of the grid closest to the player, until it
+ * either reaches it or until it brushes the corner of another grid which
+ * is closer to the player, and in either case, the existanc of a suitable
+ * line of sight is thus demonstrated.
+ *
+ * It turns out that in each octant of the radius 20 "octagon of view",
+ * there are 161 grids (with 128 not shared by any other octant), and there
  * are exactly 126 distinct "lines of sight" passing from the center of the
  * player grid through any corner of any non-shared grid in the octant.  To
  * determine if a grid is "viewable" by the player, therefore, you need to
@@ -2726,419 +3453,316 @@ void update_view(void)
 
 	int pg = GRID(py,px);
 
-	int i, j, k, g, o2;
+	int g, o2;
 
 	int radius;
 
-	int fast_view_n = view_n;
-	u16b *fast_view_g = view_g;
+	bool reused = FALSE;
 
-	int fast_temp_n = 0;
-	u16b *fast_temp_g = temp_g;
+	planeword *fast_seen = cave->seen;
 
-	byte *fast_cave_info = &cave_info[0][0];
-
-	byte info;
+	static planeword old_seen[CAVE_PLANE_SIZE];
+	static planeword changed[CAVE_PLANE_SIZE];
 
 
 	/*** Step 0 -- Begin ***/
 
-	/* Save the old "view" grids for later */
-	for (i = 0; i < fast_view_n; i++)
-	{
-		/* Grid */
-		g = fast_view_g[i];
+	/* Save the old "seen" grids for later */
+	plane_copy(old_seen, fast_seen, CAVE_PLANE_SIZE);
 
-		/* Get grid info */
-		info = fast_cave_info[g];
+	/* Extract "radius" value */
+	radius = p_ptr->cur_light;
 
-		/* Save "CAVE_SEEN" grids */
-		if (info & (CAVE_SEEN))
-		{
-			/* Set "CAVE_TEMP" flag */
-			info |= (CAVE_TEMP);
+	/* Handle real light */
+	if (radius > 0) ++radius;
+
+	/* Moving changes every octant */
+	if (!view_cache.valid || (view_cache.py != py) || (view_cache.px != px))
+	{
+		view_cache.valid = TRUE;
+		view_cache.py = py;
+		view_cache.px = px;
+		view_cache.dirty = 0xFF;
+	}
+
+	/* Changing the light radius only changes what is seen */
+	if (view_cache.radius != radius)
+	{
+		view_cache.radius = radius;
+		cave->view_stamp++;
+	}
 
-			/* Save grid for later */
-			fast_temp_g[fast_temp_n++] = g;
-		}
 
-		/* Clear "CAVE_VIEW" and "CAVE_SEEN" flags */
-		info &= ~(CAVE_VIEW | CAVE_SEEN);
+	/*** Step 1 -- octants ***/
 
-		/* Clear "CAVE_LIGHT" flag */
-		/* info &= ~(CAVE_LIGHT); */
+	/* Anything built from the view must be rebuilt */
+	if (view_cache.dirty) cave->view_stamp++;
 
-		/* Save cave info */
-		fast_cave_info[g] = info;
+	/* Cast only the octants which may have changed */
+	for (o2 = 0; o2 < 8; o2++)
+	{
+		if (view_cache.dirty & (1 << o2))
+			update_view_octant(o2, pg, py, px);
+		else
+			reused = TRUE;
 	}
 
-	/* Reset the "view" array */
-	fast_view_n = 0;
+	view_cache.dirty = 0;
 
-	/* Extract "radius" value */
-	radius = p_ptr->cur_light;
 
-	/* Handle real light */
-	if (radius > 0) ++radius;
+	/*** Step 2 -- Build the view ***/
 
-	/* Scan monster list and add monster lites */
-	for (k = 1; k < z_info->m_max; k++)
-	{
-		/* Check the k'th monster */
-		monster_type *m_ptr = &mon_list[k];
-		monster_race *r_ptr = &r_info[m_ptr->r_idx];
+	update_view_assemble(pg, radius);
 
-		/* Access the location */
-		int fx = m_ptr->fx;
-		int fy = m_ptr->fy;
-		
-		bool in_los = los(p_ptr->py, p_ptr->px, fy, fx);
+#ifdef CHECK_VIEW_CACHE
 
-		/* Skip dead monsters */
-		if (!m_ptr->r_idx) continue;
+	/* Compare the incremental view with a full recompute */
+	if (reused)
+	{
+		static planeword check_view[CAVE_PLANE_SIZE];
+		static planeword check_seen[CAVE_PLANE_SIZE];
 
-		/* Skip monsters not carrying lite */
-		if (!rf_has(r_ptr->flags, RF_HAS_LITE)) continue;
-		
-		/* Light a 3x3 box centered on the monster */
-		for (i = -1; i <= 1; i++)
-		{
-			for (j = -1; j <= 1; j++)
-			{
-				int sy = fy + i;
-				int sx = fx + j;
-				
-				/* If the monster isn't visible we can only light open tiles */
-				if (!in_los && !cave_floor_bold(sy, sx))
-					continue;
+		plane_copy(check_view, cave->view, CAVE_PLANE_SIZE);
+		plane_copy(check_seen, fast_seen, CAVE_PLANE_SIZE);
 
-				/* If the tile is too far away we won't light it */
-				if (distance(p_ptr->py, p_ptr->px, sy, sx) > MAX_SIGHT)
-					continue;
-				
-				/* If the tile itself isn't in LOS, don't light it */
-				if (!los(p_ptr->py, p_ptr->px, sy, sx))
-					continue;
-				
-				g = GRID(sy, sx);
+		for (o2 = 0; o2 < 8; o2++)
+			update_view_octant(o2, pg, py, px);
 
-				/* Mark the square lit and seen */
-				fast_cave_info[g] |= (CAVE_VIEW | CAVE_SEEN);
-				
-				/* Save in array */
-				fast_view_g[fast_view_n++] = g;
-			}
-		}
+		update_view_assemble(pg, radius);
+
+		if (memcmp(check_view, cave->view, sizeof(check_view)) ||
+		    memcmp(check_seen, fast_seen, sizeof(check_seen)))
+			msg_print("update_view(): incremental view is out of date!");
 	}
 
+#else /* CHECK_VIEW_CACHE */
 
-	/*** Step 1 -- player grid ***/
+	/* Unused */
+	(void)reused;
 
-	/* Player grid */
-	g = pg;
+#endif /* CHECK_VIEW_CACHE */
 
-	/* Get grid info */
-	info = fast_cave_info[g];
 
-	/* Assume viewable */
-	info |= (CAVE_VIEW);
+	/*** Step 3 -- Complete the algorithm ***/
 
-	/* Torch-lit grid */
-	if (0 < radius)
+	/* Handle blindness -- no grid can be "seen" */
+	if (p_ptr->timed[TMD_BLIND])
+		plane_wipe(fast_seen, CAVE_PLANE_SIZE);
+
+	/* Send the redraws together */
+	event_queue_begin();
+
+	/* Was not "seen", is now "seen" */
+	plane_andnot(changed, fast_seen, old_seen, CAVE_PLANE_SIZE);
+	for (g = plane_next(changed, CAVE_PLANE_SIZE, 0); g >= 0;
+			g = plane_next(changed, CAVE_PLANE_SIZE, g + 1))
 	{
-		/* Mark as "CAVE_SEEN" */
-		info |= (CAVE_SEEN);
+		/* Note */
+		note_spot(GRID_Y(g), GRID_X(g));
 
-		/* Mark as "CAVE_LIGHT" */
-		/* info |= (CAVE_LIGHT); */
+		/* Redraw */
+		light_spot(GRID_Y(g), GRID_X(g));
 	}
 
-	/* Perma-lit grid */
-	else if (info & (CAVE_GLOW))
+	/* Was "seen", is now not "seen" */
+	plane_andnot(changed, old_seen, fast_seen, CAVE_PLANE_SIZE);
+	for (g = plane_next(changed, CAVE_PLANE_SIZE, 0); g >= 0;
+			g = plane_next(changed, CAVE_PLANE_SIZE, g + 1))
 	{
-		/* Mark as "CAVE_SEEN" */
-		info |= (CAVE_SEEN);
+		/* Redraw */
+		light_spot(GRID_Y(g), GRID_X(g));
 	}
 
-	/* Save cave info */
-	fast_cave_info[g] = info;
+	event_queue_end();
+}
 
-	/* Save in array */
-	fast_view_g[fast_view_n++] = g;
 
 
-	/*** Step 2 -- octants ***/
 
-	/* Scan each octant */
-	for (o2 = 0; o2 < 8; o2++)
-	{
-		vinfo_type *p;
+/*
+ * Hack -- provide some "speed" for the "flow" code
+ * This entry is the generation stamp of the current flow, as saved in
+ * the "when" field of the grids it reaches.  Older stamps mark the
+ * player's trail, and a "when" value of "zero" means "not used".
+ *
+ * The stamp only wraps around every 65535 updates, at which point all
+ * the "when" fields are forgotten, so the "when" values of any two grids
+ * can always be compared directly.  Trails older than FLOW_TRAIL_AGE
+ * updates are ignored, see flow_trail().
+ */
+static u16b flow_save = 0;
 
-		/* Last added */
-		vinfo_type *last = &vinfo[0];
+/*
+ * The grid the current flow was computed from
+ */
+static int flow_py, flow_px;
 
-		/* Grid queue */
-		int queue_head = 0;
-		int queue_tail = 0;
-		vinfo_type *queue[VINFO_MAX_GRIDS*2];
+/*
+ * The current flow must be recomputed, because a grid became impassable
+ */
+static bool flow_blocked;
 
-		/* Slope bit vector */
-		u32b bits0 = VINFO_BITS_0;
-		u32b bits1 = VINFO_BITS_1;
-		u32b bits2 = VINFO_BITS_2;
-		u32b bits3 = VINFO_BITS_3;
+/*
+ * Grids opened up since the last update.  As long as the player stays
+ * put these only shorten paths, which can be repaired in place.
+ */
+static planeword flow_opened[CAVE_PLANE_SIZE];
 
-		/* Reset queue */
-		queue_head = queue_tail = 0;
+/*
+ * Queue of grids, as GRID() values, used by "update_flow()".  Every grid
+ * is enqueued at most once per pass, so it never overflows.
+ */
+static u16b flow_queue[DUNGEON_HGT * DUNGEON_WID];
 
-		/* Initial grids */
-		queue[queue_tail++] = &vinfo[1];
-		queue[queue_tail++] = &vinfo[2];
 
-		/* Process queue */
-		while (queue_head < queue_tail)
-		{
-			/* Dequeue next grid */
-			p = queue[queue_head++];
-
-			/* Check bits */
-			if ((bits0 & (p->bits_0)) ||
-			    (bits1 & (p->bits_1)) ||
-			    (bits2 & (p->bits_2)) ||
-			    (bits3 & (p->bits_3)))
-			{
-				/* Extract grid value XXX XXX XXX */
-				g = pg + p->grid[o2];
 
-				/* Get grid info */
-				info = fast_cave_info[g];
+/*
+ * Hack -- forget the "flow" information
+ */
+void forget_flow(void)
+{
+	/* Nothing to forget */
+	if (!flow_save) return;
 
-				/* Handle wall */
-				if (info & (CAVE_WALL))
-				{
-					/* Clear bits */
-					bits0 &= ~(p->bits_0);
-					bits1 &= ~(p->bits_1);
-					bits2 &= ~(p->bits_2);
-					bits3 &= ~(p->bits_3);
-
-					/* Newly viewable wall */
-					if (!(info & (CAVE_VIEW)))
-					{
-						/* Mark as viewable */
-						info |= (CAVE_VIEW);
-
-						/* Torch-lit grids */
-						if (p->d < radius)
-						{
-							/* Mark as "CAVE_SEEN" */
-							info |= (CAVE_SEEN);
-
-							/* Mark as "CAVE_LIGHT" */
-							/* info |= (CAVE_LIGHT); */
-						}
-
-						/* Perma-lit grids */
-						else if (info & (CAVE_GLOW))
-						{
-							int y = GRID_Y(g);
-							int x = GRID_X(g);
-
-							/* Hack -- move towards player */
-							int yy = (y < py) ? (y + 1) : (y > py) ? (y - 1) : y;
-							int xx = (x < px) ? (x + 1) : (x > px) ? (x - 1) : x;
-
-							/* Check for "simple" illumination */
-							if (cave_info[yy][xx] & (CAVE_GLOW))
-							{
-								/* Mark as seen */
-								info |= (CAVE_SEEN);
-							}
-						}
-
-						/* Save cave info */
-						fast_cave_info[g] = info;
-
-						/* Save in array */
-						fast_view_g[fast_view_n++] = g;
-					}
-				}
+	cave->flow_stamp++;
 
-				/* Handle non-wall */
-				else
-				{
-					/* Enqueue child */
-					if (last != p->next_0)
-					{
-						queue[queue_tail++] = last = p->next_0;
-					}
+	/* Forget the old data */
+	C_WIPE(cave->cost, cave->height * DUNGEON_WID, byte);
+	C_WIPE(cave->when, cave->height * DUNGEON_WID, u16b);
 
-					/* Enqueue child */
-					if (last != p->next_1)
-					{
-						queue[queue_tail++] = last = p->next_1;
-					}
+	/* Forget pending changes */
+	flow_blocked = FALSE;
+	plane_wipe(flow_opened, CAVE_PLANE_SIZE);
 
-					/* Newly viewable non-wall */
-					if (!(info & (CAVE_VIEW)))
-					{
-						/* Mark as "viewable" */
-						info |= (CAVE_VIEW);
-
-						/* Torch-lit grids */
-						if (p->d < radius)
-						{
-							/* Mark as "CAVE_SEEN" */
-							info |= (CAVE_SEEN);
-
-							/* Mark as "CAVE_LIGHT" */
-							/* info |= (CAVE_LIGHT); */
-						}
-
-						/* Perma-lit grids */
-						else if (info & (CAVE_GLOW))
-						{
-							/* Mark as "CAVE_SEEN" */
-							info |= (CAVE_SEEN);
-						}
-
-						/* Save cave info */
-						fast_cave_info[g] = info;
-
-						/* Save in array */
-						fast_view_g[fast_view_n++] = g;
-					}
-				}
-			}
-		}
-	}
+	/* Start over */
+	flow_save = 0;
+}
 
 
-	/*** Step 3 -- Complete the algorithm ***/
+/*
+ * Note that the passability of grid (y, x) may have changed from that of
+ * feature "old_feat", for the next update of the flow.
+ */
+static void flow_grid_changed(int y, int x, int old_feat)
+{
+	bool was_open = (old_feat < FEAT_RUBBLE);
+	bool is_open = (cave->grid[y][x].feat < FEAT_RUBBLE);
 
-	/* Handle blindness */
-	if (p_ptr->timed[TMD_BLIND])
-	{
-		/* Process "new" grids */
-		for (i = 0; i < fast_view_n; i++)
-		{
-			/* Grid */
-			g = fast_view_g[i];
+	/* No change, or no flow to change */
+	if ((was_open == is_open) || !flow_save) return;
 
-			/* Grid cannot be "CAVE_SEEN" */
-			fast_cave_info[g] &= ~(CAVE_SEEN);
-		}
-	}
+	if (is_open)
+		plane_on(flow_opened, GRID(y, x));
+	else
+		flow_blocked = TRUE;
 
-	/* Process "new" grids */
-	for (i = 0; i < fast_view_n; i++)
-	{
-		/* Grid */
-		g = fast_view_g[i];
+	/* Update the flow */
+	p_ptr->update |= (PU_UPDATE_FLOW);
+}
 
-		/* Get grid info */
-		info = fast_cave_info[g];
 
-		/* Was not "CAVE_SEEN", is now "CAVE_SEEN" */
-		if ((info & (CAVE_SEEN)) && !(info & (CAVE_TEMP)))
-		{
-			int y, x;
+/*
+ * Determine if the player's flow has reached grid (y, x) recently enough
+ * for monsters to follow it.
+ */
+bool flow_trail(int y, int x)
+{
+	u16b when = cave->when[y][x];
+
+	/* Never reached */
+	if (!when) return (FALSE);
+
+	/* Too old */
+	return ((u16b)(flow_save - when) < FLOW_TRAIL_AGE);
+}
+
+
+/*
+ * Spread the current flow outwards from the "n" grids in flow_queue[],
+ * which must have been stamped already and be in order of cost.  Grids are
+ * (re)stamped whenever a shorter path to them is found.
+ *
+ * We do not need a priority queue because the cost from grid to grid
+ * is always "one" (even along diagonals) and we process them in order.
+ */
+static void flow_spread(int n)
+{
+	int flow_head = 0;
+	int flow_tail = n;
 
-			/* Location */
-			y = GRID_Y(g);
-			x = GRID_X(g);
+	u16b flow_n = flow_save;
 
-			/* Note */
-			note_spot(y, x);
+	/* Now process the queue */
+	while (flow_head != flow_tail)
+	{
+		/* Extract the next entry */
+		int g = flow_queue[flow_head++];
+		int ty = GRID_Y(g);
+		int tx = GRID_X(g);
+		int d;
 
-			/* Redraw */
-			light_spot(y, x);
-		}
-	}
+		/* Child cost */
+		int cost = cave->cost[ty][tx] + 1;
 
-	/* Process "old" grids */
-	for (i = 0; i < fast_temp_n; i++)
-	{
-		/* Grid */
-		g = fast_temp_g[i];
+		/* Hack -- Limit flow depth */
+		if (cost >= MONSTER_FLOW_DEPTH) continue;
 
-		/* Get grid info */
-		info = fast_cave_info[g];
+		/* Add the "children" */
+		for (d = 0; d < 8; d++)
+		{
+			/* Child location */
+			int y = ty + ddy_ddd[d];
+			int x = tx + ddx_ddd[d];
 
-		/* Clear "CAVE_TEMP" flag */
-		info &= ~(CAVE_TEMP);
+			/* Ignore entries with no shorter path */
+			if ((cave->when[y][x] == flow_n) && (cave->cost[y][x] <= cost))
+				continue;
 
-		/* Save cave info */
-		fast_cave_info[g] = info;
+			/* Ignore "walls" and "rubble" */
+			if (cave->grid[y][x].feat >= FEAT_RUBBLE) continue;
 
-		/* Was "CAVE_SEEN", is now not "CAVE_SEEN" */
-		if (!(info & (CAVE_SEEN)))
-		{
-			int y, x;
+			/* Save the time-stamp */
+			cave->when[y][x] = flow_n;
 
-			/* Location */
-			y = GRID_Y(g);
-			x = GRID_X(g);
+			/* Save the flow cost */
+			cave->cost[y][x] = cost;
 
-			/* Redraw */
-			light_spot(y, x);
+			/* Enqueue that entry */
+			flow_queue[flow_tail++] = GRID(y, x);
 		}
 	}
-
-
-	/* Save 'view_n' */
-	view_n = fast_view_n;
 }
 
 
-
-
-/*
- * Size of the circular queue used by "update_flow()"
- */
-#define FLOW_MAX 2048
-
 /*
- * Hack -- provide some "speed" for the "flow" code
- * This entry is the "current index" for the "when" field
- * Note that a "when" value of "zero" means "not used".
- *
- * Note that the "cost" indexes from 1 to 127 are for
- * "old" data, and from 128 to 255 are for "new" data.
- *
- * This means that as long as the player does not "teleport",
- * then any monster up to 128 + MONSTER_FLOW_DEPTH will be
- * able to track down the player, and in general, will be
- * able to track down either the player or a position recently
- * occupied by the player.
+ * Repair the current flow around a grid which has been opened up, by
+ * spreading the flow through it from its cheapest current neighbour.
  */
-static int flow_save = 0;
+static void flow_repair(int y, int x)
+{
+	int d, cost = MONSTER_FLOW_DEPTH;
 
+	/* Find the cheapest way in */
+	for (d = 0; d < 8; d++)
+	{
+		int yy = y + ddy_ddd[d];
+		int xx = x + ddx_ddd[d];
 
+		if (cave->when[yy][xx] != flow_save) continue;
+		if (cave->grid[yy][xx].feat >= FEAT_RUBBLE) continue;
 
-/*
- * Hack -- forget the "flow" information
- */
-void forget_flow(void)
-{
-	int x, y;
+		if (cave->cost[yy][xx] + 1 < cost) cost = cave->cost[yy][xx] + 1;
+	}
 
-	/* Nothing to forget */
-	if (!flow_save) return;
+	/* Out of reach, or nothing shorter */
+	if (cost >= MONSTER_FLOW_DEPTH) return;
+	if ((cave->when[y][x] == flow_save) && (cave->cost[y][x] <= cost)) return;
 
-	/* Check the entire dungeon */
-	for (y = 0; y < DUNGEON_HGT; y++)
-	{
-		for (x = 0; x < DUNGEON_WID; x++)
-		{
-			/* Forget the old data */
-			cave_cost[y][x] = 0;
-			cave_when[y][x] = 0;
-		}
-	}
+	cave->when[y][x] = flow_save;
+	cave->cost[y][x] = cost;
 
-	/* Start over */
-	flow_save = 0;
+	flow_queue[0] = GRID(y, x);
+	flow_spread(1);
 }
 
 
@@ -3150,125 +3774,71 @@ void forget_flow(void)
  * In addition, mark the "when" of the grids that can reach the player
  * with the incremented value of "flow_save".
  *
- * Hack -- use the local "flow_y" and "flow_x" arrays as a "circular
- * queue" of cave grids.
- *
- * We do not need a priority queue because the cost from grid to grid
- * is always "one" (even along diagonals) and we process them in order.
+ * If the player hasn't moved and no grid has been blocked since the last
+ * update, the previous flow is still good apart from grids which have been
+ * opened up, and only the paths through those are recomputed.
  */
 void update_flow(void)
 {
 	int py = p_ptr->py;
 	int px = p_ptr->px;
 
-	int ty, tx;
+	int g;
 
-	int y, x;
 
-	int n, d;
+	/* Hack -- disabled */
+	if (!OPT(adult_ai_sound)) return;
+
+	cave->flow_stamp++;
 
-	int flow_n;
 
-	int flow_tail = 0;
-	int flow_head = 0;
+	/*** Repair the flow ***/
 
-	byte flow_y[FLOW_MAX];
-	byte flow_x[FLOW_MAX];
+	if (flow_save && !flow_blocked && (py == flow_py) && (px == flow_px))
+	{
+		for (g = plane_next(flow_opened, CAVE_PLANE_SIZE, 0); g >= 0;
+		     g = plane_next(flow_opened, CAVE_PLANE_SIZE, g + 1))
+			flow_repair(GRID_Y(g), GRID_X(g));
 
+		plane_wipe(flow_opened, CAVE_PLANE_SIZE);
 
-	/* Hack -- disabled */
-	if (!OPT(adult_ai_sound)) return;
+		return;
+	}
 
 
 	/*** Cycle the flow ***/
 
 	/* Cycle the flow */
-	if (flow_save++ == 255)
+	if (++flow_save == 0)
 	{
-		/* Cycle the flow */
-		for (y = 0; y < DUNGEON_HGT; y++)
-		{
-			for (x = 0; x < DUNGEON_WID; x++)
-			{
-				int w = cave_when[y][x];
-				cave_when[y][x] = (w >= 128) ? (w - 128) : 0;
-			}
-		}
+		/* Forget the old stamps */
+		C_WIPE(cave->when, cave->height * DUNGEON_WID, u16b);
 
 		/* Restart */
-		flow_save = 128;
+		flow_save = 1;
 	}
 
-	/* Local variable */
-	flow_n = flow_save;
+	flow_py = py;
+	flow_px = px;
+	flow_blocked = FALSE;
+	plane_wipe(flow_opened, CAVE_PLANE_SIZE);
 
 
 	/*** Player Grid ***/
 
 	/* Save the time-stamp */
-	cave_when[py][px] = flow_n;
+	cave->when[py][px] = flow_save;
 
 	/* Save the flow cost */
-	cave_cost[py][px] = 0;
+	cave->cost[py][px] = 0;
 
 	/* Enqueue that entry */
-	flow_y[flow_head] = py;
-	flow_x[flow_head] = px;
-
-	/* Advance the queue */
-	++flow_tail;
+	flow_queue[0] = GRID(py, px);
 
 
 	/*** Process Queue ***/
 
-	/* Now process the queue */
-	while (flow_head != flow_tail)
-	{
-		/* Extract the next entry */
-		ty = flow_y[flow_head];
-		tx = flow_x[flow_head];
-
-		/* Forget that entry (with wrap) */
-		if (++flow_head == FLOW_MAX) flow_head = 0;
-
-		/* Child cost */
-		n = cave_cost[ty][tx] + 1;
-
-		/* Hack -- Limit flow depth */
-		if (n == MONSTER_FLOW_DEPTH) continue;
-
-		/* Add the "children" */
-		for (d = 0; d < 8; d++)
-		{
-			int old_head = flow_tail;
-
-			/* Child location */
-			y = ty + ddy_ddd[d];
-			x = tx + ddx_ddd[d];
-
-			/* Ignore "pre-stamped" entries */
-			if (cave_when[y][x] == flow_n) continue;
-
-			/* Ignore "walls" and "rubble" */
-			if (cave_feat[y][x] >= FEAT_RUBBLE) continue;
-
-			/* Save the time-stamp */
-			cave_when[y][x] = flow_n;
-
-			/* Save the flow cost */
-			cave_cost[y][x] = n;
-
-			/* Enqueue that entry */
-			flow_y[flow_tail] = y;
-			flow_x[flow_tail] = x;
-
-			/* Advance the queue */
-			if (++flow_tail == FLOW_MAX) flow_tail = 0;
-
-			/* Hack -- Overflow by forgetting new entry */
-			if (flow_tail == flow_head) flow_tail = old_head;
-		}
-	}
+	flow_spread(1);
 }
 
 
@@ -3311,13 +3881,13 @@ void wiz_light(void)
 	}
 
 	/* Scan all normal grids */
-	for (y = 1; y < DUNGEON_HGT-1; y++)
+	for (y = 1; y < cave->height-1; y++)
 	{
 		/* Scan all normal grids */
-		for (x = 1; x < DUNGEON_WID-1; x++)
+		for (x = 1; x < cave->width-1; x++)
 		{
 			/* Process all non-walls */
-			if (cave_feat[y][x] < FEAT_SECRET)
+			if (cave->grid[y][x].feat < FEAT_SECRET)
 			{
 				/* Scan all neighbors */
 				for (i = 0; i < 9; i++)
@@ -3326,20 +3896,20 @@ void wiz_light(void)
 					int xx = x + ddx_ddd[i];
 
 					/* Perma-light the grid */
-					cave_info[yy][xx] |= (CAVE_GLOW);
+					cave->grid[yy][xx].info |= (CAVE_GLOW);
 
 					/* Memorize normal features */
-					if (cave_feat[yy][xx] > FEAT_INVIS)
+					if (cave->grid[yy][xx].feat > FEAT_INVIS)
 					{
 						/* Memorize the grid */
-						cave_info[yy][xx] |= (CAVE_MARK);
+						cave->grid[yy][xx].info |= (CAVE_MARK);
 					}
 
 					/* Normally, memorize floors (see above) */
 					if (OPT(view_perma_grids) && !OPT(view_torch_grids))
 					{
 						/* Memorize the grid */
-						cave_info[yy][xx] |= (CAVE_MARK);
+						cave->grid[yy][xx].info |= (CAVE_MARK);
 					}
 				}
 			}
@@ -3363,13 +3933,13 @@ void wiz_dark(void)
 
 
 	/* Forget every grid */
-	for (y = 0; y < DUNGEON_HGT; y++)
+	for (y = 0; y < cave->height; y++)
 	{
-		for (x = 0; x < DUNGEON_WID; x++)
+		for (x = 0; x < cave->width; x++)
 		{
 			/* Process the grid */
-			cave_info[y][x] &= ~(CAVE_MARK);
-			cave_info2[y][x] &= ~(CAVE2_DTRAP);
+			cave->grid[y][x].info &= ~(CAVE_MARK);
+			cave->grid[y][x].info2 &= ~(CAVE2_DTRAP | CAVE2_SEEN);
 		}
 	}
 
@@ -3411,25 +3981,25 @@ void town_illuminate(bool daytime)
 		for (x = 0; x < TOWN_WID; x++)
 		{
 			/* Interesting grids */
-			if (cave_feat[y][x] > FEAT_INVIS)
+			if (cave->grid[y][x].feat > FEAT_INVIS)
 			{
 				/* Illuminate the grid */
-				cave_info[y][x] |= (CAVE_GLOW);
+				cave->grid[y][x].info |= (CAVE_GLOW);
 
 				/* Memorize the grid */
-				cave_info[y][x] |= (CAVE_MARK);
+				cave->grid[y][x].info |= (CAVE_MARK);
 			}
 
 			/* Boring grids (light) */
 			else if (daytime)
 			{
 				/* Illuminate the grid */
-				cave_info[y][x] |= (CAVE_GLOW);
+				cave->grid[y][x].info |= (CAVE_GLOW);
 
 				/* Hack -- Memorize grids */
 				if (OPT(view_perma_grids))
 				{
-					cave_info[y][x] |= (CAVE_MARK);
+					cave->grid[y][x].info |= (CAVE_MARK);
 				}
 			}
 
@@ -3437,12 +4007,12 @@ void town_illuminate(bool daytime)
 			else
 			{
 				/* Darken the grid */
-				cave_info[y][x] &= ~(CAVE_GLOW);
+				cave->grid[y][x].info &= ~(CAVE_GLOW);
 
 				/* Hack -- Forget grids */
 				if (OPT(view_perma_grids))
 				{
-					cave_info[y][x] &= ~(CAVE_MARK);
+					cave->grid[y][x].info &= ~(CAVE_MARK);
 				}
 			}
 		}
@@ -3455,8 +4025,8 @@ void town_illuminate(bool daytime)
 		for (x = 0; x < TOWN_WID; x++)
 		{
 			/* Track shop doorways */
-			if ((cave_feat[y][x] >= FEAT_SHOP_HEAD) &&
-			    (cave_feat[y][x] <= FEAT_SHOP_TAIL))
+			if ((cave->grid[y][x].feat >= FEAT_SHOP_HEAD) &&
+			    (cave->grid[y][x].feat <= FEAT_SHOP_TAIL))
 			{
 				for (i = 0; i < 8; i++)
 				{
@@ -3464,12 +4034,12 @@ void town_illuminate(bool daytime)
 					int xx = x + ddx_ddd[i];
 
 					/* Illuminate the grid */
-					cave_info[yy][xx] |= (CAVE_GLOW);
+					cave->grid[yy][xx].info |= (CAVE_GLOW);
 
 					/* Hack -- Memorize grids */
 					if (OPT(view_perma_grids))
 					{
-						cave_info[yy][xx] |= (CAVE_MARK);
+						cave->grid[yy][xx].info |= (CAVE_MARK);
 					}
 				}
 			}
@@ -3486,26 +4056,52 @@ void town_illuminate(bool daytime)
 
 
 
+/*
+ * Between cave_batch_begin() and cave_batch_end(), cave_set_feat() only
+ * changes the grids and remembers which; the view, the projection cache
+ * and the screen are then brought up to date once for all of them.
+ */
+static int cave_batch_depth;
+static bool cave_batch_any;
+static planeword cave_batch_changed[CAVE_PLANE_SIZE];
+
+
 /*
  * Change the "feat" flag for a grid, and notice/redraw the grid
  */
 void cave_set_feat(int y, int x, int feat)
 {
+	int old_feat = cave->grid[y][x].feat;
+
 	/* Change the feature */
-	cave_feat[y][x] = feat;
+	cave->grid[y][x].feat = feat;
 
 	/* Handle "wall/door" grids */
 	if (feat >= FEAT_DOOR_HEAD)
 	{
-		cave_info[y][x] |= (CAVE_WALL);
+		cave->grid[y][x].info |= (CAVE_WALL);
 	}
 
 	/* Handle "floor"/etc grids */
 	else
 	{
-		cave_info[y][x] &= ~(CAVE_WALL);
+		cave->grid[y][x].info &= ~(CAVE_WALL);
+	}
+
+	/* The flow may have changed */
+	flow_grid_changed(y, x, old_feat);
+
+	/* Leave the rest to cave_batch_end() */
+	if (cave_batch_depth)
+	{
+		plane_on(cave_batch_changed, GRID(y, x));
+		cave_batch_any = TRUE;
+		return;
 	}
 
+	/* The view may have changed */
+	view_grid_changed(y, x);
+
 	/* Notice/Redraw */
 	if (character_dungeon)
 	{
@@ -3518,6 +4114,47 @@ void cave_set_feat(int y, int x, int feat)
 }
 
 
+/*
+ * Start changing a lot of terrain at once, as above
+ */
+void cave_batch_begin(void)
+{
+	cave_batch_depth++;
+}
+
+
+/*
+ * Finish changing a lot of terrain at once
+ */
+void cave_batch_end(void)
+{
+	int g;
+
+	assert(cave_batch_depth > 0);
+
+	if (--cave_batch_depth || !cave_batch_any) return;
+	cave_batch_any = FALSE;
+
+	/* Cast the whole view again */
+	proj_forget();
+	light_stamp++;
+	view_cache.dirty = 0xFF;
+	p_ptr->update |= (PU_UPDATE_VIEW);
+
+	/* Notice the changed grids */
+	for (g = plane_next(cave_batch_changed, CAVE_PLANE_SIZE, 0); g >= 0;
+	     g = plane_next(cave_batch_changed, CAVE_PLANE_SIZE, g + 1))
+	{
+		if (character_dungeon) note_spot(GRID_Y(g), GRID_X(g));
+	}
+
+	plane_wipe(cave_batch_changed, CAVE_PLANE_SIZE);
+
+	/* Redraw the map once */
+	if (character_dungeon) p_ptr->redraw |= (PR_MAP);
+}
+
+
 
 /*
  * Determine the path taken by a projection.
@@ -3559,6 +4196,56 @@ void cave_set_feat(int y, int x, int feat)
  * This algorithm is similar to, but slightly different from, the one used
  * by "update_view_los()", and very different from the one used by "los()".
  */
+/*
+ * Paths whose offsets and range are both within this are traced from
+ * path_slant[]
+ */
+#define PATH_SLANT_MAX	32
+
+/*
+ * Bit "i" of path_slant[major][minor] is set when step "i" of a path with
+ * larger offset "major" and smaller offset "minor" also moves one grid in
+ * the minor direction; this is project_path()'s "frac" arithmetic, done once
+ * for every path it could need.
+ */
+static u32b path_slant[PATH_SLANT_MAX + 1][PATH_SLANT_MAX + 1];
+
+static void path_slant_init(void)
+{
+	int major, minor, i;
+
+	/* Only once; the table always holds some slanted paths */
+	if (path_slant[2][1]) return;
+
+	for (major = 1; major <= PATH_SLANT_MAX; major++)
+	{
+		for (minor = 0; minor < major; minor++)
+		{
+			int half = major * minor;
+			int full = half << 1;
+			int frac = minor * minor;
+			int m = frac << 1;
+			u32b bits = 0;
+
+			if (!m) continue;
+
+			for (i = 0; i < PATH_SLANT_MAX; i++)
+			{
+				frac += m;
+
+				if (frac >= half)
+				{
+					bits |= (1UL << i);
+					frac -= full;
+				}
+			}
+
+			path_slant[major][minor] = bits;
+		}
+	}
+}
+
+
 int project_path(u16b *gp, int range, int y1, int x1, int y2, int x2, int flg)
 {
 	int y, x;
@@ -3611,6 +4298,63 @@ int project_path(u16b *gp, int range, int y1, int x1, int y2, int x2, int flg)
 	}
 
 
+	/* Most paths are short enough to be traced from the table */
+	if ((ay != ax) && (ay <= PATH_SLANT_MAX) && (ax <= PATH_SLANT_MAX) &&
+	    (range <= PATH_SLANT_MAX))
+	{
+		/* Steps along the longer ("major") and shorter ("minor") axes */
+		int my = (ay > ax) ? sy : 0;
+		int mx = (ay > ax) ? 0 : sx;
+		u32b slant;
+
+		path_slant_init();
+		slant = (ay > ax) ? path_slant[ay][ax] : path_slant[ax][ay];
+
+		/* Start */
+		y = y1 + my;
+		x = x1 + mx;
+
+		/* Create the projection path */
+		while (1)
+		{
+			/* Save grid */
+			gp[n++] = GRID(y,x);
+
+			/* Hack -- Check maximum range */
+			if ((n + (k >> 1)) >= range) break;
+
+			/* Sometimes stop at destination grid */
+			if (!(flg & (PROJECT_THRU)))
+			{
+				if ((x == x2) && (y == y2)) break;
+			}
+
+			/* Always stop at non-initial wall grids */
+			if (!cave_floor_bold(y, x)) break;
+
+			/* Sometimes stop at non-initial monsters/players */
+			if (flg & (PROJECT_STOP))
+			{
+				if (cave->grid[y][x].m_idx != 0) break;
+			}
+
+			/* Slant */
+			if (slant & (1UL << (n - 1)))
+			{
+				y += (my ? 0 : sy);
+				x += (mx ? 0 : sx);
+				k++;
+			}
+
+			/* Advance */
+			y += my;
+			x += mx;
+		}
+
+		return (n);
+	}
+
+
 	/* Number of "units" in one "half" grid */
 	half = (ay * ax);
 
@@ -3652,7 +4396,7 @@ int project_path(u16b *gp, int range, int y1, int x1, int y2, int x2, int flg)
 			/* Sometimes stop at non-initial monsters/players */
 			if (flg & (PROJECT_STOP))
 			{
-				if ((n > 0) && (cave_m_idx[y][x] != 0)) break;
+				if ((n > 0) && (cave->grid[y][x].m_idx != 0)) break;
 			}
 
 			/* Slant */
@@ -3714,7 +4458,7 @@ int project_path(u16b *gp, int range, int y1, int x1, int y2, int x2, int flg)
 			/* Sometimes stop at non-initial monsters/players */
 			if (flg & (PROJECT_STOP))
 			{
-				if ((n > 0) && (cave_m_idx[y][x] != 0)) break;
+				if ((n > 0) && (cave->grid[y][x].m_idx != 0)) break;
 			}
 
 			/* Slant */
@@ -3770,7 +4514,7 @@ int project_path(u16b *gp, int range, int y1, int x1, int y2, int x2, int flg)
 			/* Sometimes stop at non-initial monsters/players */
 			if (flg & (PROJECT_STOP))
 			{
-				if ((n > 0) && (cave_m_idx[y][x] != 0)) break;
+				if ((n > 0) && (cave->grid[y][x].m_idx != 0)) break;
 			}
 
 			/* Advance (Y) */
@@ -3804,6 +4548,8 @@ bool projectable(int y1, int x1, int y2, int x2, int flg)
 	int grid_n = 0;
 	u16b grid_g[512];
 
+	PERF_COUNT(PERF_LOS);
+
 	/* Check the projection path */
 	grid_n = project_path(grid_g, MAX_RANGE, y1, x1, y2, x2, flg);
 
@@ -3826,6 +4572,131 @@ bool projectable(int y1, int x1, int y2, int x2, int flg)
 
 
 
+/*
+ * Determine if a bolt spell cast from (y,x) would reach the player, assuming
+ * that no monster gets in the way.
+ *
+ * This is "projectable(y, x, py, px, PROJECT_NONE)", but each grid is only
+ * worked out once until the player moves or nearby terrain changes.
+ */
+bool projectable_to_player(int y, int x)
+{
+	int py = p_ptr->py;
+	int px = p_ptr->px;
+
+	int g = GRID(y, x);
+
+	/* The player has moved */
+	if ((py != proj_py) || (px != proj_px))
+	{
+		proj_forget();
+		proj_py = py;
+		proj_px = px;
+	}
+
+	/* Work it out once */
+	if (!plane_has(proj_known, g))
+	{
+		plane_on(proj_known, g);
+		proj_empty = FALSE;
+
+		if (projectable(y, x, py, px, PROJECT_NONE))
+			plane_on(proj_ok, g);
+		else
+			plane_off(proj_ok, g);
+	}
+
+	return (plane_has(proj_ok, g) != 0);
+}
+
+
+
+/*
+ * The grids cave_find_in_range() has still to try, by number within its
+ * range.  find_left[i] only counts if find_stamp[i] is the current
+ * find_serial; otherwise grid "i" is still where it started.  That way
+ * nothing needs to be set up before each search, however big its range.
+ */
+static u16b find_left[DUNGEON_HGT * DUNGEON_WID];
+static u32b find_stamp[DUNGEON_HGT * DUNGEON_WID];
+static u32b find_serial;
+
+#define FIND_LEFT(I) \
+	((find_stamp[I] == find_serial) ? find_left[I] : (I))
+
+
+/*
+ * Find a grid from rows "y1" to "y2" and columns "x1" to "x2" which "pred"
+ * accepts, and put it in (*yp, *xp).  Every such grid is equally likely.
+ *
+ * The grids are tried in a random order without repeats, so this needs one
+ * random number per grid tried and always finishes.  Returns FALSE if "pred"
+ * accepts none of them.
+ */
+bool cave_find_in_range(int *yp, int y1, int y2, int *xp, int x1, int x2,
+		cave_predicate pred)
+{
+	int w = x2 - x1 + 1;
+	int n = w * (y2 - y1 + 1);
+
+	if ((w <= 0) || (n <= 0)) return FALSE;
+
+	/* Forget the last search */
+	if (!++find_serial)
+	{
+		C_WIPE(find_stamp, DUNGEON_HGT * DUNGEON_WID, u32b);
+		find_serial = 1;
+	}
+
+	while (n)
+	{
+		int i = randint0(n);
+		int g = FIND_LEFT(i);
+		int y = y1 + g / w;
+		int x = x1 + g % w;
+
+		/* Don't try it again */
+		n--;
+		find_left[i] = FIND_LEFT(n);
+		find_stamp[i] = find_serial;
+
+		if (pred(y, x))
+		{
+			(*yp) = y;
+			(*xp) = x;
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+
+/*
+ * Find a grid anywhere on the level which "pred" accepts, as above
+ */
+bool cave_find(int *yp, int *xp, cave_predicate pred)
+{
+	return cave_find_in_range(yp, 0, level_hgt - 1, xp, 0, level_wid - 1,
+			pred);
+}
+
+
+/*
+ * Where scatter() is looking from, and how far
+ */
+static int scatter_y, scatter_x, scatter_d;
+
+static bool scatter_ok(int y, int x)
+{
+	/* Ignore "excessively distant" locations */
+	if ((scatter_d > 1) &&
+	    (distance(scatter_y, scatter_x, y, x) > scatter_d)) return FALSE;
+
+	/* Require "line of sight" */
+	return los(scatter_y, scatter_x, y, x);
+}
+
 /*
  * Standard "find me a location" function
  *
@@ -3839,32 +4710,21 @@ bool projectable(int y1, int x1, int y2, int x2, int flg)
  */
 void scatter(int *yp, int *xp, int y, int x, int d, int m)
 {
-	int nx, ny;
-
-
 	/* Unused parameter */
 	(void)m;
 
-	/* Pick a location */
-	while (TRUE)
-	{
-		/* Pick a new location */
-		ny = rand_spread(y, d);
-		nx = rand_spread(x, d);
-
-		/* Ignore annoying locations */
-		if (!in_bounds_fully(ny, nx)) continue;
-
-		/* Ignore "excessively distant" locations */
-		if ((d > 1) && (distance(y, x, ny, nx) > d)) continue;
+	scatter_y = y;
+	scatter_x = x;
+	scatter_d = d;
 
-		/* Require "line of sight" */
-		if (los(y, x, ny, nx)) break;
-	}
+	/* Pick a location */
+	if (cave_find_in_range(yp, MAX(y - d, 1), MIN(y + d, cave->height - 2),
+			xp, MAX(x - d, 1), MIN(x + d, cave->width - 2), scatter_ok))
+		return;
 
-	/* Save the location */
-	(*yp) = ny;
-	(*xp) = nx;
+	/* Nowhere else in sight, so stay put */
+	(*yp) = y;
+	(*xp) = x;
 }
 
 
@@ -3970,8 +4830,8 @@ void disturb(int stop_search, int unused_flag)
 		p_ptr->redraw |= (PR_STATE);
 	}
 
-	/* Flush the input if requested */
-	if (OPT(flush_disturb)) flush();
+	/* Flush the input if requested, or if it's been piling up */
+	if (OPT(flush_disturb) || Term_key_behind()) flush();
 }
 
 
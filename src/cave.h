@@ -4,8 +4,16 @@
 #define CAVE_H
 
 #include "z-type.h"
+#include "z-bitflag.h"
+
+/*
+ * A test of a grid, for cave_find()
+ */
+typedef bool (*cave_predicate)(int y, int x);
 
 extern int distance(int y1, int x1, int y2, int x2);
+extern void distance_many(int y, int x, const byte *ys, const byte *xs,
+		byte *dists, int n);
 extern bool los(int y1, int x1, int y2, int x2);
 extern bool no_light(void);
 extern bool cave_valid_bold(int y, int x);
@@ -18,19 +26,29 @@ extern void note_spot(int y, int x);
 extern void light_spot(int y, int x);
 extern void prt_map(void);
 extern void display_map(int *cy, int *cx);
+extern void display_map_grids(const planeword *grids);
 extern void do_cmd_view_map(void);
 extern errr vinfo_init(void);
 extern void forget_view(void);
+extern void view_area_changed(int y1, int x1, int y2, int x2);
+extern void view_grid_changed(int y, int x);
 extern void update_view(void);
 extern void forget_flow(void);
+extern bool flow_trail(int y, int x);
 extern void update_flow(void);
 extern void map_area(void);
 extern void wiz_light(void);
 extern void wiz_dark(void);
 extern void town_illuminate(bool daytime);
 extern void cave_set_feat(int y, int x, int feat);
+extern void cave_batch_begin(void);
+extern void cave_batch_end(void);
 extern int project_path(u16b *gp, int range, int y1, int x1, int y2, int x2, int flg);
 extern bool projectable(int y1, int x1, int y2, int x2, int flg);
+extern bool projectable_to_player(int y, int x);
+extern bool cave_find_in_range(int *yp, int y1, int y2, int *xp, int x1,
+		int x2, cave_predicate pred);
+extern bool cave_find(int *yp, int *xp, cave_predicate pred);
 extern void scatter(int *yp, int *xp, int y, int x, int d, int m);
 extern void health_track(int m_idx);
 extern void monster_race_track(int r_idx);
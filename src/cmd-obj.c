@@ -620,6 +620,9 @@ void do_cmd_use(cmd_code code, cmd_arg args[])
 			const object_kind *k_ptr = &k_info[o_ptr->k_idx];
 			o_ptr->timeout += randcalc(k_ptr->time, 0, RANDOMISE);
 		}
+
+		/* A rod on the floor now needs recharging */
+		if (item < 0) o_list_charging = TRUE;
 	}
 	else if (used && use == USE_SINGLE)
 	{
@@ -641,7 +644,7 @@ void do_cmd_use(cmd_code code, cmd_arg args[])
 	}
 	
 	/* Hack to make Glyph of Warding work properly */
-	if (cave_feat[py][px] == FEAT_GLYPH)
+	if (cave->grid[py][px].feat == FEAT_GLYPH)
 	{
 		/* Shift any objects to further away */
 		for (o_ptr = get_first_object(py, px); o_ptr; o_ptr =
@@ -118,6 +118,7 @@ static struct generic_command cmd_action[] =
 	{ "Search for traps/doors",     's', CMD_SEARCH, NULL },
 	{ "Disarm a trap or chest",     'D', CMD_DISARM, NULL },
 	{ "Rest for a while",           'R', CMD_NULL, textui_cmd_rest },
+	{ "Travel or explore",          'H', CMD_NULL, textui_cmd_travel },
 	{ "Look around",                'l', CMD_NULL, do_cmd_look },
 	{ "Target monster or location", '*', CMD_NULL, do_cmd_target },
 	{ "Target closest monster",     '\'', CMD_NULL, do_cmd_target_closest },
@@ -77,7 +77,7 @@ bool search(bool verbose)
 			if (randint0(100) < chance)
 			{
 				/* Invisible trap */
-				if (cave_feat[y][x] == FEAT_INVIS)
+				if (cave->grid[y][x].feat == FEAT_INVIS)
 				{
 					found = TRUE;
 
@@ -92,7 +92,7 @@ bool search(bool verbose)
 				}
 
 				/* Secret door */
-				if (cave_feat[y][x] == FEAT_SECRET)
+				if (cave->grid[y][x].feat == FEAT_SECRET)
 				{
 					found = TRUE;
 
@@ -174,7 +174,7 @@ static void py_pickup_gold(void)
 
 
 	/* Pick up all the ordinary gold objects */
-	for (this_o_idx = cave_o_idx[py][px]; this_o_idx; this_o_idx = next_o_idx)
+	for (this_o_idx = cave->grid[py][px].o_idx; this_o_idx; this_o_idx = next_o_idx)
 	{
 		/* Get the object */
 		o_ptr = &o_list[this_o_idx];
@@ -406,7 +406,7 @@ byte py_pickup(int pickup)
 
 
 	/* Nothing to pick up -- return */
-	if (!cave_o_idx[py][px]) return (0);
+	if (!cave->grid[py][px].o_idx) return (0);
 
 
 	/* Always pickup gold, effortlessly */
@@ -414,7 +414,7 @@ byte py_pickup(int pickup)
 
 
 	/* Scan the remaining objects */
-	for (this_o_idx = cave_o_idx[py][px]; this_o_idx; this_o_idx = next_o_idx)
+	for (this_o_idx = cave->grid[py][px].o_idx; this_o_idx; this_o_idx = next_o_idx)
 	{
 		/* Get the object and the next object */
 		o_ptr = &o_list[this_o_idx];
@@ -624,13 +624,13 @@ void move_player(int dir)
 
 
 	/* Attack monsters */
-	if (cave_m_idx[y][x] > 0)
+	if (cave->grid[y][x].m_idx > 0)
 		py_attack(y, x);
 
 	/* Optionally alter known traps/doors on movement */
-	else if (OPT(easy_alter) && (cave_info[y][x] & CAVE_MARK) &&
-			(cave_feat[y][x] >= FEAT_TRAP_HEAD) &&
-			(cave_feat[y][x] <= FEAT_DOOR_TAIL))
+	else if (OPT(easy_alter) && (cave->grid[y][x].info & CAVE_MARK) &&
+			(cave->grid[y][x].feat >= FEAT_TRAP_HEAD) &&
+			(cave->grid[y][x].feat <= FEAT_DOOR_TAIL))
 	{
 		/* Auto-repeat if not already repeating */
 		if (cmd_get_nrepeats() == 0)
@@ -646,21 +646,21 @@ void move_player(int dir)
 		disturb(0, 0);
 
 		/* Notice unknown obstacles */
-		if (!(cave_info[y][x] & CAVE_MARK))
+		if (!(cave->grid[y][x].info & CAVE_MARK))
 		{
 			/* Rubble */
-			if (cave_feat[y][x] == FEAT_RUBBLE)
+			if (cave->grid[y][x].feat == FEAT_RUBBLE)
 			{
 				message(MSG_HITWALL, 0, "You feel a pile of rubble blocking your way.");
-				cave_info[y][x] |= (CAVE_MARK);
+				cave->grid[y][x].info |= (CAVE_MARK);
 				light_spot(y, x);
 			}
 
 			/* Closed door */
-			else if (cave_feat[y][x] < FEAT_SECRET)
+			else if (cave->grid[y][x].feat < FEAT_SECRET)
 			{
 				message(MSG_HITWALL, 0, "You feel a door blocking your way.");
-				cave_info[y][x] |= (CAVE_MARK);
+				cave->grid[y][x].info |= (CAVE_MARK);
 				light_spot(y, x);
 			}
 
@@ -668,7 +668,7 @@ void move_player(int dir)
 			else
 			{
 				message(MSG_HITWALL, 0, "You feel a wall blocking your way.");
-				cave_info[y][x] |= (CAVE_MARK);
+				cave->grid[y][x].info |= (CAVE_MARK);
 				light_spot(y, x);
 			}
 		}
@@ -676,9 +676,9 @@ void move_player(int dir)
 		/* Mention known obstacles */
 		else
 		{
-			if (cave_feat[y][x] == FEAT_RUBBLE)
+			if (cave->grid[y][x].feat == FEAT_RUBBLE)
 				message(MSG_HITWALL, 0, "There is a pile of rubble blocking your way.");
-			else if (cave_feat[y][x] < FEAT_SECRET)
+			else if (cave->grid[y][x].feat < FEAT_SECRET)
 				message(MSG_HITWALL, 0, "There is a door blocking your way.");
 			else
 				message(MSG_HITWALL, 0, "There is a wall blocking your way.");
@@ -692,8 +692,8 @@ void move_player(int dir)
 		/* sound(MSG_WALK); */
 
 		/* See if trap detection status will change */
-		old_dtrap = ((cave_info2[py][px] & (CAVE2_DTRAP)) != 0);
-		new_dtrap = ((cave_info2[y][x] & (CAVE2_DTRAP)) != 0);
+		old_dtrap = ((cave->grid[py][px].info2 & (CAVE2_DTRAP)) != 0);
+		new_dtrap = ((cave->grid[y][x].info2 & (CAVE2_DTRAP)) != 0);
 
 		/* Note the change in the detect status */
 		if (old_dtrap != new_dtrap) p_ptr->redraw |= (PR_DTRAP);
@@ -731,8 +731,8 @@ void move_player(int dir)
 
 
 		/* Handle "store doors" */
-		if ((cave_feat[p_ptr->py][p_ptr->px] >= FEAT_SHOP_HEAD) &&
-			(cave_feat[p_ptr->py][p_ptr->px] <= FEAT_SHOP_TAIL))
+		if ((cave->grid[p_ptr->py][p_ptr->px].feat >= FEAT_SHOP_HEAD) &&
+			(cave->grid[p_ptr->py][p_ptr->px].feat <= FEAT_SHOP_TAIL))
 		{
 			/* Disturb */
 			disturb(0, 0);
@@ -748,7 +748,7 @@ void move_player(int dir)
 
 
 		/* Discover invisible traps */
-		if (cave_feat[y][x] == FEAT_INVIS)
+		if (cave->grid[y][x].feat == FEAT_INVIS)
 		{
 			/* Disturb */
 			disturb(0, 0);
@@ -764,8 +764,8 @@ void move_player(int dir)
 		}
 
 		/* Set off an visible trap */
-		else if ((cave_feat[y][x] >= FEAT_TRAP_HEAD) &&
-		         (cave_feat[y][x] <= FEAT_TRAP_TAIL))
+		else if ((cave->grid[y][x].feat >= FEAT_TRAP_HEAD) &&
+		         (cave->grid[y][x].feat <= FEAT_TRAP_TAIL))
 		{
 			/* Disturb */
 			disturb(0, 0);
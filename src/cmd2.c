@@ -35,7 +35,7 @@
 void do_cmd_go_up(cmd_code code, cmd_arg args[])
 {
 	/* Verify stairs */
-	if (cave_feat[p_ptr->py][p_ptr->px] != FEAT_LESS)
+	if (cave->grid[p_ptr->py][p_ptr->px].feat != FEAT_LESS)
 	{
 		msg_print("I see no up staircase here.");
 		return;
@@ -69,7 +69,7 @@ void do_cmd_go_up(cmd_code code, cmd_arg args[])
 void do_cmd_go_down(cmd_code code, cmd_arg args[])
 {
 	/* Verify stairs */
-	if (cave_feat[p_ptr->py][p_ptr->px] != FEAT_MORE)
+	if (cave->grid[p_ptr->py][p_ptr->px].feat != FEAT_MORE)
 	{
 		msg_print("I see no down staircase here.");
 		return;
@@ -145,7 +145,7 @@ static s16b chest_check(int y, int x)
 
 
 	/* Scan all objects in the grid */
-	for (this_o_idx = cave_o_idx[y][x]; this_o_idx; this_o_idx = next_o_idx)
+	for (this_o_idx = cave->grid[y][x].o_idx; this_o_idx; this_o_idx = next_o_idx)
 	{
 		object_type *o_ptr;
 
@@ -530,10 +530,10 @@ int count_feats(int *y, int *x, bool (*test)(int feat), bool under)
 		if (!in_bounds_fully(yy, xx)) continue;
 
 		/* Must have knowledge */
-		if (!(cave_info[yy][xx] & (CAVE_MARK))) continue;
+		if (!(cave->grid[yy][xx].info & (CAVE_MARK))) continue;
 
 		/* Not looking for this feature */
-		if (!((*test)(cave_feat[yy][xx]))) continue;
+		if (!((*test)(cave->grid[yy][xx].feat))) continue;
 
 		/* Count it */
 		++count;
@@ -615,7 +615,7 @@ int coords_to_dir(int y, int x)
 static bool do_cmd_open_test(int y, int x)
 {
 	/* Must have knowledge */
-	if (!(cave_info[y][x] & (CAVE_MARK)))
+	if (!(cave->grid[y][x].info & (CAVE_MARK)))
 	{
 		/* Message */
 		msg_print("You see nothing there.");
@@ -625,8 +625,8 @@ static bool do_cmd_open_test(int y, int x)
 	}
 
 	/* Must be a closed door */
-	if (!((cave_feat[y][x] >= FEAT_DOOR_HEAD) &&
-	      (cave_feat[y][x] <= FEAT_DOOR_TAIL)))
+	if (!((cave->grid[y][x].feat >= FEAT_DOOR_HEAD) &&
+	      (cave->grid[y][x].feat <= FEAT_DOOR_TAIL)))
 	{
 		/* Message */
 		message(MSG_NOTHING_TO_OPEN, 0, "You see nothing there to open.");
@@ -647,7 +647,7 @@ static bool do_cmd_open_test(int y, int x)
  *
  * Returns TRUE if repeated commands may continue
  */
-static bool do_cmd_open_aux(int y, int x)
+bool do_cmd_open_aux(int y, int x)
 {
 	int i, j;
 
@@ -659,14 +659,14 @@ static bool do_cmd_open_aux(int y, int x)
 
 
 	/* Jammed door */
-	if (cave_feat[y][x] >= FEAT_DOOR_HEAD + 0x08)
+	if (cave->grid[y][x].feat >= FEAT_DOOR_HEAD + 0x08)
 	{
 		/* Stuck */
 		msg_print("The door appears to be stuck.");
 	}
 
 	/* Locked door */
-	else if (cave_feat[y][x] >= FEAT_DOOR_HEAD + 0x01)
+	else if (cave->grid[y][x].feat >= FEAT_DOOR_HEAD + 0x01)
 	{
 		/* Disarm factor */
 		i = p_ptr->state.skills[SKILL_DISARM];
@@ -676,7 +676,7 @@ static bool do_cmd_open_aux(int y, int x)
 		if (p_ptr->timed[TMD_CONFUSED] || p_ptr->timed[TMD_IMAGE]) i = i / 10;
 
 		/* Extract the lock power */
-		j = cave_feat[y][x] - FEAT_DOOR_HEAD;
+		j = cave->grid[y][x].feat - FEAT_DOOR_HEAD;
 
 		/* Extract the difficulty XXX XXX XXX */
 		j = i - (j * 4);
@@ -780,7 +780,7 @@ void do_cmd_open(cmd_code code, cmd_arg args[])
 
 
 	/* Monster */
-	if (cave_m_idx[y][x] > 0)
+	if (cave->grid[y][x].m_idx > 0)
 	{
 		/* Message */
 		msg_print("There is a monster in the way!");
@@ -814,7 +814,7 @@ void do_cmd_open(cmd_code code, cmd_arg args[])
 static bool do_cmd_close_test(int y, int x)
 {
 	/* Must have knowledge */
-	if (!(cave_info[y][x] & (CAVE_MARK)))
+	if (!(cave->grid[y][x].info & (CAVE_MARK)))
 	{
 		/* Message */
 		msg_print("You see nothing there.");
@@ -824,8 +824,8 @@ static bool do_cmd_close_test(int y, int x)
 	}
 
  	/* Require open/broken door */
-	if ((cave_feat[y][x] != FEAT_OPEN) &&
-	    (cave_feat[y][x] != FEAT_BROKEN))
+	if ((cave->grid[y][x].feat != FEAT_OPEN) &&
+	    (cave->grid[y][x].feat != FEAT_BROKEN))
 	{
 		/* Message */
 		msg_print("You see nothing there to close.");
@@ -854,7 +854,7 @@ static bool do_cmd_close_aux(int y, int x)
 	if (!do_cmd_close_test(y, x)) return (FALSE);
 
 	/* Broken door */
-	if (cave_feat[y][x] == FEAT_BROKEN)
+	if (cave->grid[y][x].feat == FEAT_BROKEN)
 	{
 		/* Message */
 		msg_print("The door appears to be broken.");
@@ -914,7 +914,7 @@ void do_cmd_close(cmd_code code, cmd_arg args[])
 
 
 	/* Monster */
-	if (cave_m_idx[y][x] > 0)
+	if (cave->grid[y][x].m_idx > 0)
 	{
 		/* Message */
 		msg_print("There is a monster in the way!");
@@ -941,7 +941,7 @@ void do_cmd_close(cmd_code code, cmd_arg args[])
 static bool do_cmd_tunnel_test(int y, int x)
 {
 	/* Must have knowledge */
-	if (!(cave_info[y][x] & (CAVE_MARK)))
+	if (!(cave->grid[y][x].info & (CAVE_MARK)))
 	{
 		/* Message */
 		msg_print("You see nothing there.");
@@ -984,7 +984,7 @@ static bool twall(int y, int x)
 	sound(MSG_DIG);
 
 	/* Forget the wall */
-	cave_info[y][x] &= ~(CAVE_MARK);
+	cave->grid[y][x].info &= ~(CAVE_MARK);
 
 	/* Remove the feature */
 	cave_set_feat(y, x, FEAT_FLOOR);
@@ -992,8 +992,8 @@ static bool twall(int y, int x)
 	/* Update the visuals */
 	p_ptr->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
 
-	/* Fully update the flow */
-	p_ptr->update |= (PU_FORGET_FLOW | PU_UPDATE_FLOW);
+	/* Update the flow */
+	p_ptr->update |= (PU_UPDATE_FLOW);
 
 	/* Result */
 	return (TRUE);
@@ -1022,13 +1022,13 @@ static bool do_cmd_tunnel_aux(int y, int x)
 	/* sound(MSG_DIG); */
 
 	/* Titanium */
-	if (cave_feat[y][x] >= FEAT_PERM_EXTRA)
+	if (cave->grid[y][x].feat >= FEAT_PERM_EXTRA)
 	{
 		msg_print("This seems to be permanent rock.");
 	}
 
 	/* Granite */
-	else if (cave_feat[y][x] >= FEAT_WALL_EXTRA)
+	else if (cave->grid[y][x].feat >= FEAT_WALL_EXTRA)
 	{
 		/* Tunnel */
 		if ((p_ptr->state.skills[SKILL_DIGGING] > 40 + randint0(1600)) && twall(y, x))
@@ -1046,20 +1046,20 @@ static bool do_cmd_tunnel_aux(int y, int x)
 	}
 
 	/* Quartz / Magma */
-	else if (cave_feat[y][x] >= FEAT_MAGMA)
+	else if (cave->grid[y][x].feat >= FEAT_MAGMA)
 	{
 		bool okay = FALSE;
 		bool gold = FALSE;
 		bool hard = FALSE;
 
 		/* Found gold */
-		if (cave_feat[y][x] >= FEAT_MAGMA_H)
+		if (cave->grid[y][x].feat >= FEAT_MAGMA_H)
 		{
 			gold = TRUE;
 		}
 
 		/* Extract "quartz" flag XXX XXX XXX */
-		if ((cave_feat[y][x] - FEAT_MAGMA) & 0x01)
+		if ((cave->grid[y][x].feat - FEAT_MAGMA) & 0x01)
 		{
 			hard = TRUE;
 		}
@@ -1115,7 +1115,7 @@ static bool do_cmd_tunnel_aux(int y, int x)
 	}
 
 	/* Rubble */
-	else if (cave_feat[y][x] == FEAT_RUBBLE)
+	else if (cave->grid[y][x].feat == FEAT_RUBBLE)
 	{
 		/* Remove the rubble */
 		if ((p_ptr->state.skills[SKILL_DIGGING] > randint0(200)) && twall(y, x))
@@ -1130,7 +1130,7 @@ static bool do_cmd_tunnel_aux(int y, int x)
 				place_object(y, x, p_ptr->depth, FALSE, FALSE);
 
 				/* Observe the new object */
-				if (!squelch_hide_item(&o_list[cave_o_idx[y][x]]) &&
+				if (!squelch_hide_item(&o_list[cave->grid[y][x].o_idx]) &&
 				    player_can_see_bold(y, x))
 				{
 					msg_print("You have found something!");
@@ -1147,7 +1147,7 @@ static bool do_cmd_tunnel_aux(int y, int x)
 	}
 
 	/* Secret doors */
-	else if (cave_feat[y][x] >= FEAT_SECRET)
+	else if (cave->grid[y][x].feat >= FEAT_SECRET)
 	{
 		/* Tunnel */
 		if ((p_ptr->state.skills[SKILL_DIGGING] > 30 + randint0(1200)) && twall(y, x))
@@ -1229,7 +1229,7 @@ void do_cmd_tunnel(cmd_code code, cmd_arg args[])
 
 
 	/* Monster */
-	if (cave_m_idx[y][x] > 0)
+	if (cave->grid[y][x].m_idx > 0)
 	{
 		/* Message */
 		msg_print("There is a monster in the way!");
@@ -1255,7 +1255,7 @@ void do_cmd_tunnel(cmd_code code, cmd_arg args[])
 static bool do_cmd_disarm_test(int y, int x)
 {
 	/* Must have knowledge */
-	if (!(cave_info[y][x] & (CAVE_MARK)))
+	if (!(cave->grid[y][x].info & (CAVE_MARK)))
 	{
 		/* Message */
 		msg_print("You see nothing there.");
@@ -1265,8 +1265,8 @@ static bool do_cmd_disarm_test(int y, int x)
 	}
 
 	/* Require an actual trap */
-	if (!((cave_feat[y][x] >= FEAT_TRAP_HEAD) &&
-	      (cave_feat[y][x] <= FEAT_TRAP_TAIL)))
+	if (!((cave->grid[y][x].feat >= FEAT_TRAP_HEAD) &&
+	      (cave->grid[y][x].feat <= FEAT_TRAP_TAIL)))
 	{
 		/* Message */
 		msg_print("You see nothing there to disarm.");
@@ -1301,7 +1301,7 @@ static bool do_cmd_disarm_aux(int y, int x)
 
 
 	/* Get the trap name */
-	name = f_info[cave_feat[y][x]].name;
+	name = f_info[cave->grid[y][x].feat].name;
 
 	/* Get the "disarm" factor */
 	i = p_ptr->state.skills[SKILL_DISARM];
@@ -1331,7 +1331,7 @@ static bool do_cmd_disarm_aux(int y, int x)
 		gain_exp(power);
 
 		/* Forget the trap */
-		cave_info[y][x] &= ~(CAVE_MARK);
+		cave->grid[y][x].info &= ~(CAVE_MARK);
 
 		/* Remove the trap */
 		cave_set_feat(y, x, FEAT_FLOOR);
@@ -1410,7 +1410,7 @@ void do_cmd_disarm(cmd_code code, cmd_arg args[])
 
 
 	/* Monster */
-	if (cave_m_idx[y][x] > 0)
+	if (cave->grid[y][x].m_idx > 0)
 	{
 		/* Message */
 		msg_print("There is a monster in the way!");
@@ -1444,7 +1444,7 @@ void do_cmd_disarm(cmd_code code, cmd_arg args[])
 static bool do_cmd_bash_test(int y, int x)
 {
 	/* Must have knowledge */
-	if (!(cave_info[y][x] & (CAVE_MARK)))
+	if (!(cave->grid[y][x].info & (CAVE_MARK)))
 	{
 		/* Message */
 		msg_print("You see nothing there.");
@@ -1454,8 +1454,8 @@ static bool do_cmd_bash_test(int y, int x)
 	}
 
 	/* Require a door */
-	if (!((cave_feat[y][x] >= FEAT_DOOR_HEAD) &&
-	      (cave_feat[y][x] <= FEAT_DOOR_TAIL)))
+	if (!((cave->grid[y][x].feat >= FEAT_DOOR_HEAD) &&
+	      (cave->grid[y][x].feat <= FEAT_DOOR_TAIL)))
 	{
 		/* Message */
 		msg_print("You see nothing there to bash.");
@@ -1495,7 +1495,7 @@ static bool do_cmd_bash_aux(int y, int x)
 	bash = adj_str_blow[p_ptr->state.stat_ind[A_STR]];
 
 	/* Extract door power */
-	temp = ((cave_feat[y][x] - FEAT_DOOR_HEAD) & 0x07);
+	temp = ((cave->grid[y][x].feat - FEAT_DOOR_HEAD) & 0x07);
 
 	/* Compare bash power to door power XXX XXX XXX */
 	temp = (bash - (temp * 10));
@@ -1598,7 +1598,7 @@ void do_cmd_bash(cmd_code code, cmd_arg args[])
 
 
 	/* Monster */
-	if (cave_m_idx[y][x] > 0)
+	if (cave->grid[y][x].m_idx > 0)
 	{
 		/* Message */
 		msg_print("There is a monster in the way!");
@@ -1644,10 +1644,10 @@ void do_cmd_alter_aux(int dir)
 
 
 	/* Original feature */
-	feat = cave_feat[y][x];
+	feat = cave->grid[y][x].feat;
 
 	/* Must have knowledge to know feature XXX XXX */
-	if (!(cave_info[y][x] & (CAVE_MARK))) feat = FEAT_NONE;
+	if (!(cave->grid[y][x].info & (CAVE_MARK))) feat = FEAT_NONE;
 
 
 	/* Take a turn */
@@ -1663,7 +1663,7 @@ void do_cmd_alter_aux(int dir)
 
 
 	/* Attack monsters */
-	if (cave_m_idx[y][x] > 0)
+	if (cave->grid[y][x].m_idx > 0)
 	{
 		py_attack(y, x);
 	}
@@ -1757,7 +1757,7 @@ static bool get_spike(int *ip)
 static bool do_cmd_spike_test(int y, int x)
 {
 	/* Must have knowledge */
-	if (!(cave_info[y][x] & (CAVE_MARK)))
+	if (!(cave->grid[y][x].info & (CAVE_MARK)))
 	{
 		/* Message */
 		msg_print("You see nothing there.");
@@ -1767,8 +1767,8 @@ static bool do_cmd_spike_test(int y, int x)
 	}
 
 	/* Require a door */
-	if (!((cave_feat[y][x] >= FEAT_DOOR_HEAD) &&
-	      (cave_feat[y][x] <= FEAT_DOOR_TAIL)))
+	if (!((cave->grid[y][x].feat >= FEAT_DOOR_HEAD) &&
+	      (cave->grid[y][x].feat <= FEAT_DOOR_TAIL)))
 	{
 		/* Message */
 		msg_print("You see nothing there to spike.");
@@ -1825,7 +1825,7 @@ void do_cmd_spike(cmd_code code, cmd_arg args[])
 
 
 	/* Monster */
-	if (cave_m_idx[y][x] > 0)
+	if (cave->grid[y][x].m_idx > 0)
 	{
 		/* Message */
 		msg_print("There is a monster in the way!");
@@ -1844,15 +1844,15 @@ void do_cmd_spike(cmd_code code, cmd_arg args[])
 		msg_print("You jam the door with a spike.");
 
 		/* Convert "locked" to "stuck" XXX XXX XXX */
-		if (cave_feat[y][x] < FEAT_DOOR_HEAD + 0x08)
+		if (cave->grid[y][x].feat < FEAT_DOOR_HEAD + 0x08)
 		{
-			cave_feat[y][x] += 0x08;
+			cave->grid[y][x].feat += 0x08;
 		}
 
 		/* Add one spike to the door */
-		if (cave_feat[y][x] < FEAT_DOOR_TAIL)
+		if (cave->grid[y][x].feat < FEAT_DOOR_TAIL)
 		{
-			cave_feat[y][x] += 0x01;
+			cave->grid[y][x].feat += 0x01;
 		}
 
 		/* Use up, and describe, a single spike, from the bottom */
@@ -1869,7 +1869,7 @@ void do_cmd_spike(cmd_code code, cmd_arg args[])
 static bool do_cmd_walk_test(int y, int x)
 {
 	/* Allow attack on visible monsters if unafraid */
-	if ((cave_m_idx[y][x] > 0) && (mon_list[cave_m_idx[y][x]].ml))
+	if ((cave->grid[y][x].m_idx > 0) && (mon_list[cave->grid[y][x].m_idx].ml))
 	{
 		/* Handle player fear */
 		if(p_ptr->state.afraid)
@@ -1878,7 +1878,7 @@ static bool do_cmd_walk_test(int y, int x)
 			char m_name[80];
 			monster_type *m_ptr;
 
-			m_ptr = &mon_list[cave_m_idx[y][x]];
+			m_ptr = &mon_list[cave->grid[y][x].m_idx];
 			monster_desc(m_name, sizeof(m_name), m_ptr, 0);
 
 			/* Message */
@@ -1893,20 +1893,20 @@ static bool do_cmd_walk_test(int y, int x)
 	}
 
 	/* Hack -- walking obtains knowledge XXX XXX */
-	if (!(cave_info[y][x] & (CAVE_MARK))) return (TRUE);
+	if (!(cave->grid[y][x].info & (CAVE_MARK))) return (TRUE);
 
 	/* Require open space */
 	if (!cave_floor_bold(y, x))
 	{
 		/* Rubble */
-		if (cave_feat[y][x] == FEAT_RUBBLE)
+		if (cave->grid[y][x].feat == FEAT_RUBBLE)
 		{
 			/* Message */
 			message(MSG_HITWALL, 0, "There is a pile of rubble in the way!");
 		}
 
 		/* Door */
-		else if (cave_feat[y][x] < FEAT_SECRET)
+		else if (cave->grid[y][x].feat < FEAT_SECRET)
 		{
 			/* Hack -- Handle "OPT(easy_alter)" */
 			if (OPT(easy_alter)) return (TRUE);
@@ -2050,6 +2050,31 @@ void do_cmd_pathfind(cmd_code code, cmd_arg args[])
 }
 
 
+/*
+ * Travel to a grid or the nearest known staircase, or explore.
+ *
+ * As for the pathfinder, travelling while confused is not allowed.
+ */
+void do_cmd_travel(cmd_code code, cmd_arg args[])
+{
+	/* Hack XXX XXX XXX */
+	if (p_ptr->timed[TMD_CONFUSED])
+	{
+		msg_print("You are too confused!");
+		return;
+	}
+
+	if (travel_start(args[0].choice, args[1].point.y, args[1].point.x))
+	{
+		p_ptr->running = 1000;
+		/* Calculate torch radius */
+		p_ptr->update |= (PU_TORCH);
+		p_ptr->running_withpathfind = FALSE;
+		run_step(0);
+	}
+}
+
+
 
 /*
  * Stay still.  Search.  Enter stores.
@@ -2077,8 +2102,8 @@ void do_cmd_hold(cmd_code code, cmd_arg args[])
 	(void)py_pickup(0);
 
 	/* Hack -- enter a store if we are on one */
-	if ((cave_feat[p_ptr->py][p_ptr->px] >= FEAT_SHOP_HEAD) &&
-	    (cave_feat[p_ptr->py][p_ptr->px] <= FEAT_SHOP_TAIL))
+	if ((cave->grid[p_ptr->py][p_ptr->px].feat >= FEAT_SHOP_HEAD) &&
+	    (cave->grid[p_ptr->py][p_ptr->px].feat <= FEAT_SHOP_TAIL))
 	{
 		/* Disturb */
 		disturb(0, 0);
@@ -2201,6 +2226,26 @@ void textui_cmd_rest(void)
 }
 
 
+void textui_cmd_travel(void)
+{
+	char ch;
+	int choice;
+
+	if (!get_com("Travel to? (< up staircase, > down staircase, x explore) ", &ch))
+		return;
+
+	if (ch == '<') choice = TRAVEL_UP;
+	else if (ch == '>') choice = TRAVEL_DOWN;
+	else if ((ch == 'x') || (ch == 'H') || (ch == '&')) choice = TRAVEL_EXPLORE;
+	else return;
+
+	/* The grid is only wanted for TRAVEL_GRID, from the look command */
+	cmd_insert(CMD_TRAVEL);
+	cmd_set_arg_choice(cmd_get_top(), 0, choice);
+	cmd_set_arg_point(cmd_get_top(), 1, p_ptr->py, p_ptr->px);
+}
+
+
 /*
  * Hack -- commit suicide
  */
@@ -46,14 +46,17 @@ void do_cmd_walk(cmd_code code, cmd_arg args[]);
 void do_cmd_jump(cmd_code code, cmd_arg args[]);
 void do_cmd_run(cmd_code code, cmd_arg args[]);
 void do_cmd_pathfind(cmd_code code, cmd_arg args[]);
+void do_cmd_travel(cmd_code code, cmd_arg args[]);
 void do_cmd_hold(cmd_code code, cmd_arg args[]);
 void do_cmd_pickup(cmd_code code, cmd_arg args[]);
 void do_cmd_rest(cmd_code code, cmd_arg args[]);
 void do_cmd_suicide(cmd_code code, cmd_arg args[]);
 void do_cmd_save_game(cmd_code code, cmd_arg args[]);
 
+bool do_cmd_open_aux(int y, int x);
 void do_cmd_alter_aux(int dir);
 void textui_cmd_rest(void);
+void textui_cmd_travel(void);
 void textui_cmd_suicide(void);
 
 /* cmd3.c */
@@ -92,6 +92,20 @@
 /* Allow changing macros at run-time */
 #define ALLOW_MACROS
 
+/* Check each incremental update_view() against a full recompute (slow) */
+/* #define CHECK_VIEW_CACHE */
+
+/* Time each game turn, for the debug command "P" (see perf.h) */
+/* #define ALLOW_PERF */
+
+/*
+ * LOW_MEMORY, for handheld ports, packs the cave rows, keeps fewer messages,
+ * grows the object and monster lists in smaller steps, leaves descriptions
+ * in the data cache until they're shown, and notes memory use at startup.
+ * It is set by the makefile (see Makefile.nds), as the z-* files don't see
+ * this one.
+ */
+
 
 
 /*** Borg ***/
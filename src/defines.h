@@ -102,16 +102,18 @@
 
 
 /*
- * Number of grids in each dungeon (vertically)
- * Must be a multiple of SCREEN_HGT
- * Must be less or equal to 256
+ * Largest number of grids in a level (vertically)
+ * Must be less than 256, as coordinates are often kept in a byte
+ *
+ * Each level has its own size, up to this, in cave->height.
  */
 #define DUNGEON_HGT		66
 
 /*
- * Number of grids in each dungeon (horizontally)
- * Must be a multiple of SCREEN_WID
- * Must be less or equal to 256
+ * Largest number of grids in a level (horizontally)
+ * Must be less or equal to 256, as GRID() packs a row into 256 grids
+ *
+ * Each level has its own size, up to this, in cave->width.
  */
 #define DUNGEON_WID		198
 
@@ -166,6 +168,25 @@
  */
 #define MAX_DEPTH	128
 
+/*
+ * Number of object and monster slots a new level is generated with free.
+ * Once fewer are left, generation places no more, so the level neither has
+ * to be thrown away nor compacted as soon as play begins (see "dungeon()").
+ */
+#define GEN_SLOTS_FREE	32
+
+/*
+ * Slots o_list[] and mon_list[] grow by at a time, up to z_info->o_max and
+ * z_info->m_max, and start each level with
+ */
+#ifdef LOW_MEMORY
+# define OBJ_LIST_CHUNK	64
+# define MON_LIST_CHUNK	64
+#else
+# define OBJ_LIST_CHUNK	256
+# define MON_LIST_CHUNK	256
+#endif
+
 
 /*
  * Maximum size of the "view" array (see "cave.c")
@@ -501,6 +522,18 @@ enum
 	REST_SOME_POINTS = -3
 };
 
+/*
+ * Where the player is travelling to
+ */
+enum
+{
+	TRAVEL_NONE = 0,
+	TRAVEL_GRID,
+	TRAVEL_UP,
+	TRAVEL_DOWN,
+	TRAVEL_EXPLORE
+};
+
 
 
 /*** General index values ***/
@@ -881,6 +914,28 @@ enum
  */
 #define MONSTER_FLOW_DEPTH 32
 
+/*
+ * Number of flow updates for which monsters can follow the player's trail
+ */
+#define FLOW_TRAIL_AGE 128
+
+/*
+ * Flow fields shared by all monsters (see monster/flow.c)
+ */
+#define FLOW_SAFETY		0	/* Out of the player's line of sight */
+#define FLOW_AMBUSH		1	/* Just out of the player's line of sight */
+#define FLOW_MAX		2
+
+/*
+ * Distance of grids too far from the goals of a flow field
+ */
+#define FLOW_FAR		255
+
+/*
+ * Maximum distance pack monsters will go to lie in ambush
+ */
+#define FLOW_AMBUSH_DEPTH	10
+
 
 
 /*** Monster blow constants ***/
@@ -1104,12 +1159,12 @@ enum
 #define CAVE_GLOW		0x02 	/* self-illuminating */
 #define CAVE_ICKY		0x04 	/* part of a vault */
 #define CAVE_ROOM		0x08 	/* part of a room */
-#define CAVE_SEEN		0x10 	/* seen flag */
-#define CAVE_VIEW		0x20 	/* view flag */
+/* 0x10 and 0x20 are unused, see cave->seen and cave->view */
 #define CAVE_TEMP		0x40 	/* temp flag */
 #define CAVE_WALL		0x80 	/* wall flag */
 
 #define CAVE2_DTRAP		0x01	/* trap detected grid */
+#define CAVE2_SEEN		0x02	/* seen, even if not memorized */
 
 
 /*** Object flags ***/
@@ -1347,7 +1402,8 @@ enum
  * Special Monster Flags (all temporary)
  */
 #define MFLAG_VIEW	0x01	/* Monster is in line of sight */
-/* xxx */
+#define MFLAG_DORM	0x02	/* Monster is dormant (off the schedule) */
+#define MFLAG_HURT	0x04	/* Monster is in mon_hurt[] */
 #define MFLAG_NICE	0x20	/* Monster is still being nice */
 #define MFLAG_SHOW	0x40	/* Monster is recently memorized */
 #define MFLAG_MARK	0x80	/* Monster is currently memorized */
@@ -1604,8 +1660,8 @@ enum
  * Some monster types are different.
  */
 #define monster_is_unusual(R) \
-	(flags_test((R)->flags, RF_SIZE, RF_DEMON, RF_UNDEAD, RF_STUPID, FLAG_END) || \
-	strchr("Evg", (R)->d_char))
+	(rf_has((R)->flags, RF_DEMON) || rf_has((R)->flags, RF_UNDEAD) || \
+	rf_has((R)->flags, RF_STUPID) || strchr("Evg", (R)->d_char))
 
 /*
  * Convert an "attr"/"char" pair into a "pict" (P)
@@ -1626,23 +1682,39 @@ enum
 	((char)((byte)(P)))
 
 
+/*
+ * Grids in each row of the cave arrays (see GRID()); a power of two, so that
+ * a "grid" splits cheaply, unless memory is short
+ */
+#ifdef LOW_MEMORY
+# define CAVE_ROW	DUNGEON_WID
+#else
+# define CAVE_ROW	256
+#endif
+
+/*
+ * Size (in words) of a bitplane covering every "grid" value (see GRID())
+ */
+#define CAVE_PLANE_SIZE \
+	PLANE_SIZE(DUNGEON_HGT * CAVE_ROW)
+
 /*
  * Convert a "location" (Y,X) into a "grid" (G)
  */
 #define GRID(Y,X) \
-	(256 * (Y) + (X))
+	(CAVE_ROW * (Y) + (X))
 
 /*
  * Convert a "grid" (G) into a "location" (Y)
  */
 #define GRID_Y(G) \
-	((int)((G) / 256U))
+	((int)((G) / (unsigned)CAVE_ROW))
 
 /*
  * Convert a "grid" (G) into a "location" (X)
  */
 #define GRID_X(G) \
-	((int)((G) % 256U))
+	((int)((G) % (unsigned)CAVE_ROW))
 
 
 /*
@@ -1662,8 +1734,8 @@ enum
  * Determines if a map location is "meaningful"
  */
 #define in_bounds(Y,X) \
-	(((unsigned)(Y) < (unsigned)(DUNGEON_HGT)) && \
-	 ((unsigned)(X) < (unsigned)(DUNGEON_WID)))
+	(((unsigned)(Y) < (unsigned)(cave->height)) && \
+	 ((unsigned)(X) < (unsigned)(cave->width)))
 
 /*
  * Determines if a map location is fully inside the outer walls
@@ -1671,8 +1743,8 @@ enum
  * often we need to exclude the outer walls from calculations.
  */
 #define in_bounds_fully(Y,X) \
-	(((Y) > 0) && ((Y) < DUNGEON_HGT-1) && \
-	 ((X) > 0) && ((X) < DUNGEON_WID-1))
+	(((Y) > 0) && ((Y) < cave->height-1) && \
+	 ((X) > 0) && ((X) < cave->width-1))
 
 
 /*
@@ -1694,7 +1766,7 @@ enum
  * Note the use of the new "CAVE_WALL" flag.
  */
 #define cave_floor_bold(Y,X) \
-	(!(cave_info[Y][X] & (CAVE_WALL)))
+	(!(cave->grid[Y][X].info & (CAVE_WALL)))
 
 /*
  * Determine if a "legal" grid is a "clean" floor grid
@@ -1703,8 +1775,8 @@ enum
  * Line 2 -- forbid normal objects
  */
 #define cave_clean_bold(Y,X) \
-	((cave_feat[Y][X] == FEAT_FLOOR) && \
-	 (cave_o_idx[Y][X] == 0))
+	((cave->grid[Y][X].feat == FEAT_FLOOR) && \
+	 (cave->grid[Y][X].o_idx == 0))
 
 /*
  * Determine if a "legal" grid is an "empty" floor grid
@@ -1714,7 +1786,7 @@ enum
  */
 #define cave_empty_bold(Y,X) \
 	(cave_floor_bold(Y,X) && \
-	 (cave_m_idx[Y][X] == 0))
+	 (cave->grid[Y][X].m_idx == 0))
 
 /*
  * Determine if a "legal" grid is an "naked" floor grid
@@ -1724,9 +1796,9 @@ enum
  * Line 3 -- forbid player/monsters
  */
 #define cave_naked_bold(Y,X) \
-	((cave_feat[Y][X] == FEAT_FLOOR) && \
-	 (cave_o_idx[Y][X] == 0) && \
-	 (cave_m_idx[Y][X] == 0))
+	((cave->grid[Y][X].feat == FEAT_FLOOR) && \
+	 (cave->grid[Y][X].o_idx == 0) && \
+	 (cave->grid[Y][X].m_idx == 0))
 
 
 /*
@@ -1737,11 +1809,11 @@ enum
  * Line 4-5 -- shop doors
  */
 #define cave_perma_bold(Y,X) \
-	((cave_feat[Y][X] >= FEAT_PERM_EXTRA) || \
-	 ((cave_feat[Y][X] == FEAT_LESS) || \
-	  (cave_feat[Y][X] == FEAT_MORE)) || \
-	 ((cave_feat[Y][X] >= FEAT_SHOP_HEAD) && \
-	  (cave_feat[Y][X] <= FEAT_SHOP_TAIL)))
+	((cave->grid[Y][X].feat >= FEAT_PERM_EXTRA) || \
+	 ((cave->grid[Y][X].feat == FEAT_LESS) || \
+	  (cave->grid[Y][X].feat == FEAT_MORE)) || \
+	 ((cave->grid[Y][X].feat >= FEAT_SHOP_HEAD) && \
+	  (cave->grid[Y][X].feat <= FEAT_SHOP_TAIL)))
 
 
 /*
@@ -1750,7 +1822,7 @@ enum
  * Note the use of comparison to zero to force a "boolean" result
  */
 #define player_has_los_bold(Y,X) \
-	((cave_info[Y][X] & (CAVE_VIEW)) != 0)
+	(plane_has(cave->view, GRID(Y,X)) != 0)
 
 
 /*
@@ -1759,7 +1831,7 @@ enum
  * Note the use of comparison to zero to force a "boolean" result
  */
 #define player_can_see_bold(Y,X) \
-	((cave_info[Y][X] & (CAVE_SEEN)) != 0)
+	(plane_has(cave->seen, GRID(Y,X)) != 0)
 
 
 /*
@@ -17,6 +17,8 @@
  */
 
 #include "angband.h"
+#include "attack.h"
+#include "autoplay.h"
 #include "button.h"
 #include "cave.h"
 #include "cmds.h"
@@ -24,8 +26,11 @@
 #include "game-event.h"
 #include "generate.h"
 #include "init.h"
+#include "level-cache.h"
 #include "monster/monster.h"
 #include "object/tvalsval.h"
+#include "perf.h"
+#include "state-hash.h"
 #include "prefs.h"
 #include "spells.h"
 #include "target.h"
@@ -35,6 +40,9 @@
  */
 void dungeon_change_level(int dlev)
 {
+	/* Keep the level being left, to come back to */
+	if (OPT(adult_persist)) level_cache_store();
+
 	/* New depth */
 	p_ptr->depth = dlev;
 
@@ -43,37 +51,7 @@ void dungeon_change_level(int dlev)
 	if (!dlev && daycount)
 	{
 		if (OPT(cheat_xtra)) msg_print("Updating Shops...");
-		while (daycount--)
-		{
-			int n;
-
-			/* Maintain each shop (except home) */
-			for (n = 0; n < MAX_STORES; n++)
-			{
-				/* Skip the home */
-				if (n == STORE_HOME) continue;
-
-				/* Maintain */
-				store_maint(n);
-			}
-
-			/* Sometimes, shuffle the shop-keepers */
-			if (one_in_(STORE_SHUFFLE))
-			{
-				/* Message */
-				if (OPT(cheat_xtra)) msg_print("Shuffling a Shopkeeper...");
-
-				/* Pick a random shop (except home) */
-				while (1)
-				{
-					n = randint0(MAX_STORES);
-					if (n != STORE_HOME) break;
-				}
-
-				/* Shuffle it */
-				store_shuffle(n);
-			}
-		}
+		store_update(daycount);
 		daycount = 0;
 		if (OPT(cheat_xtra)) msg_print("Done.");
 	}
@@ -188,18 +166,16 @@ static void regenmana(int percent)
  */
 static void regen_monsters(void)
 {
-	int i, frac;
+	int n, frac;
 
-	/* Regenerate everyone */
-	for (i = 1; i < mon_max; i++)
+	/* Regenerate everyone who needs it (backwards, as they drop out) */
+	for (n = mon_hurt_num - 1; n >= 0; n--)
 	{
-		/* Check the i'th monster */
-		monster_type *m_ptr = &mon_list[i];
+		int m_idx = mon_hurt[n];
+		/* Check the monster */
+		monster_type *m_ptr = &mon_list[m_idx];
 		monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-		/* Skip dead monsters */
-		if (!m_ptr->r_idx) continue;
-
 		/* Allow regeneration (if needed) */
 		if (m_ptr->hp < m_ptr->maxhp)
 		{
@@ -219,8 +195,11 @@ static void regen_monsters(void)
 			if (m_ptr->hp > m_ptr->maxhp) m_ptr->hp = m_ptr->maxhp;
 
 			/* Redraw (later) if needed */
-			if (p_ptr->health_who == i) p_ptr->redraw |= (PR_HEALTH);
+			if (p_ptr->health_who == m_idx) p_ptr->redraw |= (PR_HEALTH);
 		}
+
+		/* Healed, here or elsewhere */
+		if (m_ptr->hp >= m_ptr->maxhp) monster_healed(m_idx);
 	}
 }
 
@@ -372,18 +351,7 @@ static void recharge_objects(void)
 	}
 
 	/*** Recharge the ground ***/
-	for (i = 1; i < o_max; i++)
-	{
-		/* Get the object */
-		o_ptr = &o_list[i];
-
-		/* Skip dead objects */
-		if (!o_ptr->k_idx) continue;
-
-		/* Recharge rods on the ground */
-		if (o_ptr->tval == TV_ROD)
-			recharge_timeout(o_ptr);
-	}
+	recharge_floor_rods();
 }
 
 
@@ -440,7 +408,7 @@ static void play_ambient_sound(void)
 /*
  * Helper for process_world -- decrement p_ptr->timed[] fields.
  */
-static void decrease_timeouts(void)
+void decrease_timeouts(void)
 {
 	int adjust = (adj_con_fix[p_ptr->state.stat_ind[A_CON]] + 1);
 	int i;
@@ -907,7 +875,7 @@ static void process_player_aux(void)
  */
 static void process_player(void)
 {
-	int i;
+	int n;
 
 	/*** Check for interrupts ***/
 
@@ -995,8 +963,19 @@ static void process_player(void)
 		/* Place the cursor on the player */
 		move_cursor_relative(p_ptr->py, p_ptr->px);
 
-		/* Refresh (optional) */
-		Term_fresh();
+		/*
+		 * Refresh (optional).  Part way along a run, or a repeated
+		 * command such as tunnelling, there is nothing to watch unless a
+		 * monster is in view, so the screen is left until it stops.
+		 */
+		if (!((p_ptr->running && !p_ptr->running_withpathfind) ||
+		      (cmd_get_nrepeats() > 0)) ||
+		    monsters_in_view())
+		{
+			PERF_START(PERF_TERM_FRESH);
+			Term_fresh();
+			PERF_STOP(PERF_TERM_FRESH);
+		}
 
 		/* Hack -- Pack Overflow */
 		pack_overflow();
@@ -1084,12 +1063,11 @@ static void process_player(void)
 			/* Place the cursor on the player */
 			move_cursor_relative(p_ptr->py, p_ptr->px);
 
+			/* Let the automated player choose, if it's playing */
+			autoplay_command();
+
 			/* Get and process a command */
 			process_command(CMD_GAME, FALSE);
-
-			/* Mega hack - redraw if big graphics - sorry NRM */
-			if ((tile_width > 1) || (tile_height > 1)) 
-			        p_ptr->redraw |= (PR_MAP);
 		}
 
 
@@ -1116,17 +1094,16 @@ static void process_player(void)
 				/* Clear the flag */
 				shimmer_monsters = FALSE;
 
-				/* Shimmer multi-hued monsters */
-				for (i = 1; i < mon_max; i++)
+				/* Shimmer multi-hued monsters (those out of sight look
+				   no different redrawn, and they set the flag again
+				   when they come into view) */
+				for (n = mon_vis_next(0); n; n = mon_vis_next(n))
 				{
 					monster_type *m_ptr;
 					monster_race *r_ptr;
 
 					/* Get the monster */
-					m_ptr = &mon_list[i];
-
-					/* Skip dead monsters */
-					if (!m_ptr->r_idx) continue;
+					m_ptr = &mon_list[n];
 
 					/* Get the monster race */
 					r_ptr = &r_info[m_ptr->r_idx];
@@ -1149,12 +1126,13 @@ static void process_player(void)
 				repair_mflag_nice = FALSE;
 
 				/* Process monsters */
-				for (i = 1; i < mon_max; i++)
+				for (n = mon_live_num - 1; n >= 0; n--)
 				{
+					int m_idx = mon_live[n];
 					monster_type *m_ptr;
 
 					/* Get the monster */
-					m_ptr = &mon_list[i];
+					m_ptr = &mon_list[m_idx];
 
 					/* Skip dead monsters */
 					/* if (!m_ptr->r_idx) continue; */
@@ -1171,12 +1149,13 @@ static void process_player(void)
 				repair_mflag_mark = FALSE;
 
 				/* Process the monsters */
-				for (i = 1; i < mon_max; i++)
+				for (n = mon_live_num - 1; n >= 0; n--)
 				{
+					int m_idx = mon_live[n];
 					monster_type *m_ptr;
 
 					/* Get the monster */
-					m_ptr = &mon_list[i];
+					m_ptr = &mon_list[m_idx];
 
 					/* Skip dead monsters */
 					/* if (!m_ptr->r_idx) continue; */
@@ -1198,7 +1177,7 @@ static void process_player(void)
 						m_ptr->mflag &= ~(MFLAG_MARK);
 
 						/* Update the monster */
-						update_mon(i, FALSE);
+						update_mon(m_idx, FALSE);
 					}
 				}
 			}
@@ -1211,12 +1190,13 @@ static void process_player(void)
 			repair_mflag_show = FALSE;
 
 			/* Process the monsters */
-			for (i = 1; i < mon_max; i++)
+			for (n = mon_live_num - 1; n >= 0; n--)
 			{
+				int m_idx = mon_live[n];
 				monster_type *m_ptr;
 
 				/* Get the monster */
-				m_ptr = &mon_list[i];
+				m_ptr = &mon_list[m_idx];
 
 				/* Skip dead monsters */
 				/* if (!m_ptr->r_idx) continue; */
@@ -1281,17 +1261,16 @@ byte get_flicker(byte a)
  */
 void do_animation(void)
 {
-	int i;
+	int m_idx;
 
-	for (i = 1; i < mon_max; i++)
+	/* Only the visible monsters are drawn */
+	for (m_idx = mon_vis_next(0); m_idx; m_idx = mon_vis_next(m_idx))
 	{
 		byte attr;
-		monster_type *m_ptr = &mon_list[i];
+		monster_type *m_ptr = &mon_list[m_idx];
 		monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-		if (!m_ptr || !m_ptr->ml)
-			continue;
-		else if (rf_has(r_ptr->flags, RF_ATTR_MULTI))
+		if (rf_has(r_ptr->flags, RF_ATTR_MULTI))
 			attr = randint1(BASIC_COLORS - 1);
 		else if (rf_has(r_ptr->flags, RF_ATTR_FLICKER))
 			attr = get_flicker(r_ptr->x_attr);
@@ -1324,6 +1303,30 @@ void idle_update(void)
 }
 
 
+/*
+ * Skip over game turns on which nothing would happen: the player doesn't
+ * have enough energy to move, no monster is due to act, and it isn't a
+ * turn on which the world is processed.  Going round the main loop for
+ * each of these would only give the player energy, so do that directly.
+ *
+ * This must be called where nothing is waiting to be noticed, updated or
+ * redrawn, and the object and monster lists don't need compacting, so that
+ * what follows is exactly what the main loop would reach turn by turn.
+ */
+static void skip_idle_turns(void)
+{
+	int gain = extract_energy[p_ptr->state.speed];
+
+	if (p_ptr->notice || p_ptr->update || p_ptr->redraw) return;
+
+	while ((p_ptr->energy < 100) && (turn % 10) && !monsters_due())
+	{
+		p_ptr->energy += gain;
+		turn++;
+	}
+}
+
+
 /*
  * Interact with the current dungeon level.
  *
@@ -1332,11 +1335,6 @@ void idle_update(void)
  */
 static void dungeon(void)
 {
-	monster_type *m_ptr;
-	int i;
-
-
-
 	/* Hack -- enforce illegal panel */
 	Term->offset_y = DUNGEON_HGT;
 	Term->offset_x = DUNGEON_WID;
@@ -1387,7 +1385,7 @@ static void dungeon(void)
 	/* If autosave is pending, do it now. */
 	if (p_ptr->autosave)
 	{
-		save_game();
+		autosave_game();
 		p_ptr->autosave = FALSE;
 	}
 
@@ -1485,19 +1483,24 @@ static void dungeon(void)
 	/* Main loop */
 	while (TRUE)
 	{
-		/* Hack -- Compact the monster list occasionally */
-		if (mon_cnt + 32 > z_info->m_max) compact_monsters(64);
+		/* Hack -- Grow the monster list, or compact it once it can't */
+		if ((mon_cnt + 32 > mon_size) && !mon_list_grow(mon_cnt + 32))
+			compact_monsters(64);
 
 		/* Hack -- Compress the monster list occasionally */
 		if (mon_cnt + 32 < mon_max) compact_monsters(0);
 
 
-		/* Hack -- Compact the object list occasionally */
-		if (o_cnt + 32 > z_info->o_max) compact_objects(64);
+		/* Hack -- Grow the object list, or compact it once it can't */
+		if ((o_cnt + 32 > o_size) && !o_list_grow(o_cnt + 32))
+			compact_objects(64);
 
 		/* Hack -- Compress the object list occasionally */
 		if (o_cnt + 32 < o_max) compact_objects(0);
 
+		/* Skip game turns on which nothing would happen */
+		skip_idle_turns();
+
 		/* Can the player move? */
 		while ((p_ptr->energy >= 100) && !p_ptr->leaving)
 		{
@@ -1505,15 +1508,13 @@ static void dungeon(void)
     		do_animation(); 
 
 			/* process monster with even more energy first */
+			PERF_START(PERF_PROCESS_MONSTERS);
 			process_monsters((byte)(p_ptr->energy + 1));
+			PERF_STOP(PERF_PROCESS_MONSTERS);
 
 			/* if still alive */
 			if (!p_ptr->leaving)
 			{
-			        /* Mega hack -redraw big graphics - sorry NRM */
-			        if ((tile_width > 1) || (tile_height > 1)) 
-				        p_ptr->redraw |= (PR_MAP);
-
 				/* Process the player */
 				process_player();
 			}
@@ -1536,7 +1537,9 @@ static void dungeon(void)
 
 
 		/* Process all of the monsters */
+		PERF_START(PERF_PROCESS_MONSTERS);
 		process_monsters(100);
+		PERF_STOP(PERF_PROCESS_MONSTERS);
 
 		/* Notice stuff */
 		if (p_ptr->notice) notice_stuff();
@@ -1555,7 +1558,9 @@ static void dungeon(void)
 
 
 		/* Process the world */
+		PERF_START(PERF_PROCESS_WORLD);
 		process_world();
+		PERF_STOP(PERF_PROCESS_WORLD);
 
 		/* Notice stuff */
 		if (p_ptr->notice) notice_stuff();
@@ -1577,20 +1582,11 @@ static void dungeon(void)
 		/* Give the player some energy */
 		p_ptr->energy += extract_energy[p_ptr->state.speed];
 
-		/* Give energy to all monsters */
-		for (i = mon_max - 1; i >= 1; i--)
-		{
-			/* Access the monster */
-			m_ptr = &mon_list[i];
-
-			/* Ignore "dead" monsters */
-			if (!m_ptr->r_idx) continue;
-
-			/* Give this monster some energy */
-			m_ptr->energy += extract_energy[m_ptr->mspeed];
-		}
+		/* Monsters gain energy implicitly, see monster_energy() */
 
 		/* Count game turns */
+		state_hash_turn();
+		PERF_TURN_END();
 		turn++;
 	}
 }
@@ -1670,6 +1666,44 @@ void play_game(void)
 	(void)Term_set_cursor(FALSE);
 
 
+	/* Benchmark level generation instead of playing */
+	if (arg_bench_count)
+	{
+		if (arg_bench_depth_max)
+			gen_benchmark_depths(arg_bench_seed, arg_bench_depth,
+			                     arg_bench_depth_max, arg_bench_count,
+			                     getenv("BENCH_SAVE"), getenv("BENCH_BASELINE"));
+		else
+			gen_benchmark(arg_bench_seed, arg_bench_depth, arg_bench_count);
+		quit(NULL);
+	}
+
+	/* Benchmark melee instead of playing */
+	if (arg_fight_count)
+	{
+		melee_benchmark(arg_fight_race, arg_fight_level, arg_fight_count);
+		quit(NULL);
+	}
+
+	/* Describe a savefile instead of playing */
+	if (arg_describe)
+	{
+		savefile_describe(arg_describe);
+		quit(NULL);
+	}
+
+#ifdef ALLOW_SPOILERS
+
+	/* Write the spoilers instead of playing */
+	if (arg_spoil)
+	{
+		spoil_all(arg_spoil_seed != 0, arg_spoil_seed);
+		quit(NULL);
+	}
+
+#endif /* ALLOW_SPOILERS */
+
+
 	/*** Try to load the savefile ***/
 
 	p_ptr->is_dead = TRUE;
@@ -1732,6 +1766,9 @@ void play_game(void)
 		Rand_state_init(seed);
 	}
 
+	/* Savefiles from before the dungeon seed get one now */
+	if (!seed_dungeon) seed_dungeon = randint0(0x10000000);
+
 	/* Roll new character */
 	if (new_game)
 	{
@@ -1750,6 +1787,9 @@ void play_game(void)
 		/* Hack -- seed for random artifacts */
 		seed_randart = randint0(0x10000000);
 
+		/* Hack -- seed for dungeon levels */
+		seed_dungeon = randint0(0x10000000);
+
 		/* Roll up a new character. Quickstart is allowed if ht_birth is set */
 		player_birth(p_ptr->ht_birth ? TRUE : FALSE);
 
@@ -1877,7 +1917,8 @@ void play_game(void)
 		if (p_ptr->playing && p_ptr->is_dead)
 		{
 			/* Mega-Hack -- Allow player to cheat death */
-			if ((p_ptr->wizard || OPT(cheat_live)) && !get_check("Die? "))
+			if (autoplay_cheat_death() ||
+			    ((p_ptr->wizard || OPT(cheat_live)) && !get_check("Die? ")))
 			{
 				/* Mark social class, reset age, if needed */
 				if (p_ptr->sc) p_ptr->sc = p_ptr->age = 0;
@@ -1941,8 +1982,8 @@ void play_game(void)
 		/* Handle "death" */
 		if (p_ptr->is_dead) break;
 
-		/* Make a new level */
-		generate_cave();
+		/* Make a new level, unless there's one kept for this depth */
+		if (!level_cache_restore(p_ptr->depth)) generate_cave();
 	}
 
 	/* Disallow big cursor */
@@ -49,7 +49,7 @@ static const info_entry effects[] =
  */
 bool effect_aim(effect_type effect)
 {
-	if (effect < 1 || effect > EF_MAX)
+	if (effect < 1 || effect >= EF_MAX)
 		return FALSE;
 
 	return effects[effect].aim;
@@ -57,16 +57,16 @@ bool effect_aim(effect_type effect)
 
 int effect_power(effect_type effect)
 {
-	if (effect < 1 || effect > EF_MAX)
-		return FALSE;
+	if (effect < 1 || effect >= EF_MAX)
+		return 0;
 
 	return effects[effect].power;
 }
 
 const char *effect_desc(effect_type effect)
 {
-	if (effect < 1 || effect > EF_MAX)
-		return FALSE;
+	if (effect < 1 || effect >= EF_MAX)
+		return NULL;
 
 	return effects[effect].desc;
 }
@@ -164,7 +164,7 @@ bool effect_do(effect_type effect, bool *ident, bool aware, int dir, int beam,
 	int px = p_ptr->px;
 	int dam, chance;
 
-	if (effect < 1 || effect > EF_MAX)
+	if (effect < 1 || effect >= EF_MAX)
 	{
 		msg_print("Bad effect passed to do_effect().  Please report this bug.");
 		return FALSE;
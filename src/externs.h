@@ -6,7 +6,7 @@
  */
 
 /* pathfind.c */
-extern char pf_result[];
+extern byte pf_result[];
 extern int pf_result_index;
 
 /* tables.c */
@@ -39,6 +39,16 @@ extern const xchar_type latin1_encode[];
 extern cptr copyright;
 extern bool arg_wizard;
 extern bool arg_rebalance;
+extern u32b arg_bench_seed;
+extern int arg_bench_depth;
+extern int arg_bench_depth_max;
+extern int arg_bench_count;
+extern int arg_fight_race;
+extern int arg_fight_level;
+extern int arg_fight_count;
+extern cptr arg_describe;
+extern bool arg_spoil;
+extern u32b arg_spoil_seed;
 extern int arg_graphics;
 extern bool arg_graphics_nice;
 extern bool character_generated;
@@ -50,6 +60,7 @@ extern s16b character_xtra;
 extern u32b seed_randart;
 extern u32b seed_flavor;
 extern u32b seed_town;
+extern u32b seed_dungeon;
 extern s16b num_repro;
 extern char summon_kin_type;
 extern s32b turn;
@@ -58,6 +69,7 @@ extern int use_graphics;
 extern bool use_graphics_nice;
 extern s16b signal_count;
 extern bool msg_flag;
+extern bool msg_quiet;
 extern bool inkey_base;
 extern bool inkey_xtra;
 extern u32b inkey_scan;
@@ -70,8 +82,11 @@ extern bool repair_mflag_show;
 extern bool repair_mflag_mark;
 extern s16b o_max;
 extern s16b o_cnt;
+extern s16b o_size;
+extern bool o_list_charging;
 extern s16b mon_max;
 extern s16b mon_cnt;
+extern s16b mon_size;
 extern byte feeling;
 extern s16b rating;
 extern bool good_item_flag;
@@ -88,16 +103,14 @@ extern int temp_n;
 extern u16b *temp_g;
 extern byte *temp_y;
 extern byte *temp_x;
-extern byte (*cave_info)[256];
-extern byte (*cave_info2)[256];
-extern byte (*cave_feat)[DUNGEON_WID];
-extern s16b (*cave_o_idx)[DUNGEON_WID];
-extern s16b (*cave_m_idx)[DUNGEON_WID];
-extern byte (*cave_cost)[DUNGEON_WID];
-extern byte (*cave_when)[DUNGEON_WID];
+extern struct cave *cave;
 extern maxima *z_info;
 extern object_type *o_list;
 extern monster_type *mon_list;
+extern s16b *mon_live;
+extern s16b mon_live_num;
+extern s16b *mon_hurt;
+extern s16b mon_hurt_num;
 extern s32b tot_mon_power;
 extern monster_lore *l_list;
 extern quest *q_list;
@@ -200,6 +213,7 @@ void death_screen(void);
 /* dungeon.c */
 extern void dungeon_change_level(int dlev);
 extern void play_game(void);
+extern void decrease_timeouts(void);
 extern int value_check_aux1(const object_type *o_ptr);
 extern void idle_update(void);
 
@@ -214,10 +228,22 @@ bool make_attack_normal(int m_idx);
 
 /* melee2.c */
 extern bool make_attack_spell(int m_idx);
+extern int monster_energy(int m_idx);
+extern void monster_set_energy(int m_idx, int energy);
+extern void monster_set_speed(int m_idx, int speed);
+extern void monster_schedule(int m_idx);
+extern void monster_unschedule(int m_idx);
+extern void monster_schedule_wipe(void);
+extern bool monsters_due(void);
+bool monster_remote(int m_idx);
+void monster_rouse(int m_idx);
 extern void process_monsters(byte minimum_energy);
 
 /* pathfind.c */
+extern int path_search(int y1, int x1, int y2, int x2, path_passable_f passable,
+	byte *path, int max);
 extern bool findpath(int y, int x);
+extern bool travel_start(int goal, int y, int x);
 extern byte get_angle_to_grid[41][41];
 extern int get_angle_to_target(int y0, int x0, int y1, int x1, int dir);
 extern void get_grid_using_angle(int angle, int y0, int x0,
@@ -241,8 +267,16 @@ extern void signals_ignore_tstp(void);
 extern void signals_handle_tstp(void);
 extern void signals_init(void);
 
-/* save.c */
+/* savefile.c */
 extern bool old_save(void);
+extern bool old_save_background(void);
+extern bool old_save_wait(void);
+extern bool savefile_save_blocks(const char *path, const char *const *blocks);
+extern bool savefile_save_blocks_delta(const char *path, const char *const *blocks);
+extern bool savefile_load_blocks(const char *path, const char *const *blocks);
+extern byte *savefile_save_level(u32b *len);
+extern bool savefile_load_level(byte *data, u32b len);
+extern bool savefile_describe(const char *path);
 
 /* store.c */
 void do_cmd_store_knowledge(void);
@@ -272,6 +306,7 @@ extern void put_str(cptr str, int row, int col);
 extern void c_prt(byte attr, cptr str, int row, int col);
 extern void prt(cptr str, int row, int col);
 extern void text_out_to_file(byte attr, cptr str);
+extern void x_textblock_append(textblock *tb, int encoding, const char *fmt, ...);
 extern void text_out_to_screen(byte a, cptr str);
 extern void text_out(const char *fmt, ...);
 extern void text_out_c(byte a, const char *fmt, ...);
@@ -330,6 +365,7 @@ char* random_hint(void);
 
 /* wiz-spoil.c */
 bool make_fake_artifact(object_type *o_ptr, byte name1);
+void spoil_all(bool randarts, u32b randart_seed);
 
 
 
@@ -939,19 +939,49 @@ void display_player(int mode)
 
 
 /*
- * Hack -- Dump a character description file
- *
- * XXX XXX XXX Allow the "full" flag to dump additional info,
- * and trigger its usage from various places in the code.
+ * Add `w` columns of rows `y1` to `y2` - 1 of the screen, from column `x`,
+ * to a character dump
  */
-errr file_character(const char *path, bool full)
+static void dump_screen_rows(textblock *tb, int encoding, int x, int y1,
+		int y2, int w)
 {
-	int i, x, y;
-
+	char buf[1024];
+	int i, y;
 	byte a;
 	char c;
 
-	ang_file *fp;
+	for (y = y1; y < y2; y++)
+	{
+		for (i = 0; i < w; i++)
+		{
+			/* Get the attr/char */
+			(void)(Term_what(x + i, y, &a, &c));
+
+			/* Dump it */
+			buf[i] = c;
+		}
+
+		/* Back up over spaces */
+		while ((i > 0) && (buf[i-1] == ' ')) --i;
+
+		/* Terminate */
+		buf[i] = '\0';
+
+		/* End the row */
+		x_textblock_append(tb, encoding, "%s\n", buf);
+	}
+}
+
+/*
+ * Add a character description to `tb`.
+ *
+ * Everything is read from the game (and the character screen) here, and
+ * one textblock is reused for all the item descriptions, so the dump is a
+ * snapshot which can be written out afterwards by anything, at leisure.
+ */
+void dump_character(textblock *tb)
+{
+	int i;
 
 	store_type *st_ptr = &store[STORE_HOME];
 
@@ -959,24 +989,19 @@ errr file_character(const char *path, bool full)
 
 	byte (*old_xchar_hook)(byte c) = Term->xchar_hook;
 
-	char buf[1024];
+	textblock *info = textblock_new();
 
 	/* We use either ascii or system-specific encoding */
  	int encoding = OPT(xchars_to_file) ? SYSTEM_SPECIFIC : ASCII;
 
-	/* Unused parameter */
-	(void)full;
-
-
-	/* Open the file for writing */
-	fp = file_open(path, MODE_WRITE, FTYPE_TEXT);
-	if (!fp) return (-1);
-
 	/* Display the requested encoding -- ASCII or system-specific */
  	if (!OPT(xchars_to_file)) Term->xchar_hook = NULL;
 
+	/* Room for a typical dump */
+	textblock_reserve(tb, 16384);
+
 	/* Begin dump */
-	file_putf(fp, "  [%s %s Character Dump]\n\n",
+	textblock_append(tb, "  [%s %s Character Dump]\n\n",
 	        VERSION_NAME, VERSION_STRING);
 
 
@@ -984,85 +1009,21 @@ errr file_character(const char *path, bool full)
 	display_player(0);
 
 	/* Dump part of the screen */
-	for (y = 1; y < 23; y++)
-	{
-		/* Dump each row */
-		for (x = 0; x < 79; x++)
-		{
-			/* Get the attr/char */
-			(void)(Term_what(x, y, &a, &c));
-
-			/* Dump it */
-			buf[x] = c;
-		}
-
-		/* Back up over spaces */
-		while ((x > 0) && (buf[x-1] == ' ')) --x;
-
-		/* Terminate */
-		buf[x] = '\0';
-
-		/* End the row */
-		x_file_putf(fp, encoding, "%s\n", buf);
-	}
+	dump_screen_rows(tb, encoding, 0, 1, 23, 79);
 
 	/* Skip a line */
-	file_putf(fp, "\n");
+	textblock_append(tb, "\n");
 
 	/* Display player */
 	display_player(1);
 
-	/* Dump part of the screen */
-	for (y = 11; y < 20; y++)
-	{
-		/* Dump each row */
-		for (x = 0; x < 39; x++)
-		{
-			/* Get the attr/char */
-			(void)(Term_what(x, y, &a, &c));
-
-			/* Dump it */
-			buf[x] = c;
-		}
-
-		/* Back up over spaces */
-		while ((x > 0) && (buf[x-1] == ' ')) --x;
-
-		/* Terminate */
-		buf[x] = '\0';
-
-		/* End the row */
-		x_file_putf(fp, encoding, "%s\n", buf);
-	}
-
-	/* Skip a line */
-	file_putf(fp, "\n");
-
-	/* Dump part of the screen */
-	for (y = 11; y < 20; y++)
-	{
-		/* Dump each row */
-		for (x = 0; x < 39; x++)
-		{
-			/* Get the attr/char */
-			(void)(Term_what(x + 40, y, &a, &c));
-
-			/* Dump it */
-			buf[x] = c;
-		}
-
-		/* Back up over spaces */
-		while ((x > 0) && (buf[x-1] == ' ')) --x;
-
-		/* Terminate */
-		buf[x] = '\0';
-
-		/* End the row */
-		x_file_putf(fp, encoding, "%s\n", buf);
-	}
+	/* Dump part of the screen, one side and then the other */
+	dump_screen_rows(tb, encoding, 0, 11, 20, 39);
+	textblock_append(tb, "\n");
+	dump_screen_rows(tb, encoding, 40, 11, 20, 39);
 
 	/* Skip some lines */
-	file_putf(fp, "\n\n");
+	textblock_append(tb, "\n\n");
 
 
 	/* If dead, dump last messages -- Prfnoff */
@@ -1070,34 +1031,34 @@ errr file_character(const char *path, bool full)
 	{
 		i = messages_num();
 		if (i > 15) i = 15;
-		file_putf(fp, "  [Last Messages]\n\n");
+		textblock_append(tb, "  [Last Messages]\n\n");
 		while (i-- > 0)
 		{
-			x_file_putf(fp, encoding, "> %s\n", message_str((s16b)i));
+			x_textblock_append(tb, encoding, "> %s\n", message_str((s16b)i));
 		}
-		x_file_putf(fp, encoding, "\nKilled by %s.\n\n", p_ptr->died_from);
+		x_textblock_append(tb, encoding, "\nKilled by %s.\n\n", p_ptr->died_from);
 	}
 
 
 	/* Dump the equipment */
-	file_putf(fp, "  [Character Equipment]\n\n");
+	textblock_append(tb, "  [Character Equipment]\n\n");
 	for (i = INVEN_WIELD; i < ALL_INVEN_TOTAL; i++)
 	{
 		if (i == INVEN_TOTAL)
 		{
-			file_putf(fp, "\n\n  [Character Quiver]\n\n");
+			textblock_append(tb, "\n\n  [Character Quiver]\n\n");
 			continue;
 		}
 		object_desc(o_name, sizeof(o_name), &p_ptr->inventory[i],
 				ODESC_PREFIX | ODESC_FULL);
 
-		x_file_putf(fp, encoding, "%c) %s\n", index_to_label(i), o_name);
+		x_textblock_append(tb, encoding, "%c) %s\n", index_to_label(i), o_name);
 		if (p_ptr->inventory[i].k_idx)
-			object_info_chardump(fp, &p_ptr->inventory[i], 5, 72);
+			object_info_chardump(tb, info, &p_ptr->inventory[i], 5, 72);
 	}
 
 	/* Dump the inventory */
-	file_putf(fp, "\n\n  [Character Inventory]\n\n");
+	textblock_append(tb, "\n\n  [Character Inventory]\n\n");
 	for (i = 0; i < INVEN_PACK; i++)
 	{
 		if (!p_ptr->inventory[i].k_idx) break;
@@ -1105,45 +1066,45 @@ errr file_character(const char *path, bool full)
 		object_desc(o_name, sizeof(o_name), &p_ptr->inventory[i],
 					ODESC_PREFIX | ODESC_FULL);
 
-		x_file_putf(fp, encoding, "%c) %s\n", index_to_label(i), o_name);
-		object_info_chardump(fp, &p_ptr->inventory[i], 5, 72);
+		x_textblock_append(tb, encoding, "%c) %s\n", index_to_label(i), o_name);
+		object_info_chardump(tb, info, &p_ptr->inventory[i], 5, 72);
 	}
-	file_putf(fp, "\n\n");
+	textblock_append(tb, "\n\n");
 
 
 	/* Dump the Home -- if anything there */
 	if (st_ptr->stock_num)
 	{
 		/* Header */
-		file_putf(fp, "  [Home Inventory]\n\n");
+		textblock_append(tb, "  [Home Inventory]\n\n");
 
 		/* Dump all available items */
 		for (i = 0; i < st_ptr->stock_num; i++)
 		{
 			object_desc(o_name, sizeof(o_name), &st_ptr->stock[i],
 						ODESC_PREFIX | ODESC_FULL);
-			x_file_putf(fp, encoding, "%c) %s\n", I2A(i), o_name);
+			x_textblock_append(tb, encoding, "%c) %s\n", I2A(i), o_name);
 
-			object_info_chardump(fp, &st_ptr->stock[i], 5, 72);
+			object_info_chardump(tb, info, &st_ptr->stock[i], 5, 72);
 		}
 
 		/* Add an empty line */
-		file_putf(fp, "\n\n");
+		textblock_append(tb, "\n\n");
 	}
 
 	/* Dump character history */
-	dump_history(fp);
-	file_putf(fp, "\n\n");
+	dump_history(tb);
+	textblock_append(tb, "\n\n");
 
 	/* Dump options */
-	file_putf(fp, "  [Options]\n\n");
+	textblock_append(tb, "  [Options]\n\n");
 
 	/* Dump options */
 	for (i = OPT_ADULT; i < OPT_MAX; i++)
 	{
 		if (option_name(i))
 		{
-			file_putf(fp, "%-45s: %s (%s)\n",
+			textblock_append(tb, "%-45s: %s (%s)\n",
 			        option_desc(i),
 			        op_ptr->opt[i] ? "yes" : "no ",
 			        option_name(i));
@@ -1151,16 +1112,48 @@ errr file_character(const char *path, bool full)
 	}
 
 	/* Skip some lines */
-	file_putf(fp, "\n\n");
+	textblock_append(tb, "\n\n");
 
 	/* Return to standard display */
  	Term->xchar_hook = old_xchar_hook;
 
-	file_close(fp);
+	textblock_free(info);
+}
+
+
+/*
+ * Hack -- Dump a character description file
+ *
+ * The dump is put together in memory by dump_character(), then written out
+ * in one go.
+ *
+ * XXX XXX XXX Allow the "full" flag to dump additional info,
+ * and trigger its usage from various places in the code.
+ */
+errr file_character(const char *path, bool full)
+{
+	ang_file *fp;
+	textblock *tb;
+	bool ok;
+
+	/* Unused parameter */
+	(void)full;
+
 
+	/* Open the file for writing */
+	fp = file_open(path, MODE_WRITE, FTYPE_TEXT);
+	if (!fp) return (-1);
+
+	tb = textblock_new();
+	dump_character(tb);
+
+	ok = textblock_write(tb, fp);
+	textblock_free(tb);
+
+	if (!file_close(fp)) ok = FALSE;
 
 	/* Success */
-	return (0);
+	return (ok ? 0 : -1);
 }
 
 
@@ -1176,14 +1169,30 @@ static void string_lower(char *buf)
 }
 
 
+/*
+ * Get a line of a file being perused into "buf", as file_getl() would.
+ */
+static bool show_file_getl(ang_file *fff, char *buf, size_t n)
+{
+	const char *text;
+	size_t len;
+
+	if (!file_getl_ref(fff, buf, n, &text, &len)) return FALSE;
+
+	if (text != buf) memcpy(buf, text, len);
+	buf[len] = '\0';
+
+	return TRUE;
+}
+
+
 /*
  * Recursive file perusal.
  *
  * Return FALSE on "?", otherwise TRUE.
  *
- * This function could be made much more efficient with the use of "seek"
- * functionality, especially when moving backwards through a file, or
- * forwards through a file by less than a page at a time.  XXX XXX XXX
+ * The file is read through once to find the menu items, the tag, and where
+ * each "real" line starts, so that any line can be gone to directly.
  */
 bool show_file(cptr name, cptr what, int line, int mode)
 {
@@ -1197,6 +1206,10 @@ bool show_file(cptr name, cptr what, int line, int mode)
 	/* Number of "real" lines in the file */
 	int size;
 
+	/* Where each "real" line starts */
+	u32b *offsets = NULL;
+	int offsets_max = 0;
+
 	/* Backup value for "line" */
 	int back = 0;
 
@@ -1308,11 +1321,16 @@ bool show_file(cptr name, cptr what, int line, int mode)
 	}
 
 
+	/* Read it from memory if possible */
+	(void)file_map(fff, NULL);
+
 	/* Pre-Parse the file */
 	while (TRUE)
 	{
+		u32b pos = file_tell(fff);
+
 		/* Read a line or stop */
-		if (!file_getl(fff, buf, sizeof(buf))) break;
+		if (!show_file_getl(fff, buf, sizeof(buf))) break;
 
 		/* XXX Parse "menu" items */
 		if (prefix(buf, "***** "))
@@ -1354,6 +1372,14 @@ bool show_file(cptr name, cptr what, int line, int mode)
 			continue;
 		}
 
+		/* Remember where it is */
+		if (next == offsets_max)
+		{
+			offsets_max = offsets_max ? 2 * offsets_max : 256;
+			offsets = mem_realloc(offsets, offsets_max * sizeof(*offsets));
+		}
+		offsets[next] = pos;
+
 		/* Count the "real" lines */
 		next++;
 	}
@@ -1375,32 +1401,12 @@ bool show_file(cptr name, cptr what, int line, int mode)
 		if (line < 0) line = 0;
 
 
-		/* Re-open the file if needed */
-		if (next > line)
-		{
-			/* Close it */
-			file_close(fff);
-
-			/* Hack -- Re-Open the file */
-			fff = file_open(path, MODE_READ, -1);
-			if (!fff) return (TRUE);
-
-			/* File has been restarted */
-			next = 0;
-		}
-
-
 		/* Goto the selected line */
-		while (next < line)
+		next = line;
+		if ((line < size) && !file_seek(fff, offsets[line]))
 		{
-			/* Get a line */
-			if (!file_getl(fff, buf, sizeof(buf))) break;
-
-			/* Skip tags/links */
-			if (prefix(buf, "***** ")) continue;
-
-			/* Count the lines */
-			next++;
+			ch = ESCAPE;
+			break;
 		}
 
 
@@ -1411,7 +1417,8 @@ bool show_file(cptr name, cptr what, int line, int mode)
 			if (!i) line = next;
 
 			/* Get a line of the file or stop */
-			if (!file_getl(fff, buf, sizeof(buf))) break;
+			if ((next >= size) || !show_file_getl(fff, buf, sizeof(buf)))
+				break;
 
 			/* Hack -- skip "special" lines */
 			if (prefix(buf, "***** ")) continue;
@@ -1614,6 +1621,7 @@ bool show_file(cptr name, cptr what, int line, int mode)
 
 	/* Close the file */
 	file_close(fff);
+	mem_free(offsets);
 
 	/* Done */
 	return (ch != '?');
@@ -1711,7 +1719,7 @@ void process_player_name(bool sf)
 /*
  * Save the game
  */
-void save_game(void)
+static void save_game_aux(bool background)
 {
 	/* Disturb the player */
 	disturb(1, 0);
@@ -1735,7 +1743,7 @@ void save_game(void)
 	signals_ignore_tstp();
 
 	/* Save the player */
-	if (old_save())
+	if (background ? old_save_background() : old_save())
 	{
 		prt("Saving game... done.", 0, 0);
 	}
@@ -1756,6 +1764,24 @@ void save_game(void)
 	my_strcpy(p_ptr->died_from, "(alive and well)", sizeof(p_ptr->died_from));
 }
 
+void save_game(void)
+{
+	save_game_aux(FALSE);
+}
+
+/*
+ * Save the game without waiting for the savefile to be written, for
+ * autosaves.  If the last one couldn't be written, save as normal instead,
+ * so the player hears about it.
+ */
+void autosave_game(void)
+{
+	if (!old_save_wait())
+		save_game_aux(FALSE);
+	else
+		save_game_aux(TRUE);
+}
+
 
 
 /*
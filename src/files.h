@@ -8,12 +8,14 @@ extern void player_flags(bitflag f[OF_SIZE]);
 extern void display_player(int mode);
 extern void display_player_stat_info(void);
 extern void display_player_xtra_info(void);
+extern void dump_character(textblock *tb);
 extern errr file_character(cptr name, bool full);
 extern bool show_file(cptr name, cptr what, int line, int mode);
 extern void do_cmd_help(void);
 extern void process_player_name(bool sf);
 extern bool get_name(char *buf, size_t buflen);
 extern void save_game(void);
+extern void autosave_game(void);
 extern void close_game(void);
 extern void exit_game_panic(void);
 
@@ -58,6 +58,7 @@ static struct
 	{ CMD_RESET_STATS, { arg_CHOICE }, NULL, FALSE, 0 },
 	{ CMD_ROLL_STATS, { arg_NONE }, NULL, FALSE, 0 },
 	{ CMD_PREV_STATS, { arg_NONE }, NULL, FALSE, 0 },
+	{ CMD_AUTOROLL_STATS, { arg_STRING }, NULL, FALSE, 0 },
 	{ CMD_NAME_CHOICE, { arg_STRING }, NULL, FALSE, 0 },
 	{ CMD_ACCEPT_CHARACTER, { arg_NONE }, NULL, FALSE, 0 },
 
@@ -78,6 +79,7 @@ static struct
 	{ CMD_JAM, { arg_DIRECTION }, do_cmd_spike, FALSE, 0 },
 	{ CMD_REST, { arg_CHOICE }, do_cmd_rest, FALSE, 0 },
 	{ CMD_PATHFIND, { arg_POINT }, do_cmd_pathfind, FALSE, 0 },
+	{ CMD_TRAVEL, { arg_CHOICE, arg_POINT }, do_cmd_travel, FALSE, 0 },
 	{ CMD_PICKUP, { arg_ITEM }, do_cmd_pickup, FALSE, 0 },
 	{ CMD_WIELD, { arg_ITEM, arg_NUMBER }, do_cmd_wield, FALSE, 0 },
 	{ CMD_TAKEOFF, { arg_ITEM }, do_cmd_takeoff, FALSE, 0 },
@@ -311,7 +313,7 @@ void cmd_set_arg_target(game_command *cmd, int n, int target)
 	cmd->arg_present[n] = TRUE;
 }
 
-void cmd_set_arg_point(game_command *cmd, int n, int x, int y)
+void cmd_set_arg_point(game_command *cmd, int n, int y, int x)
 {
 	int idx = cmd_idx(cmd->command);
 
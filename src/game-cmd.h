@@ -27,6 +27,7 @@ typedef enum cmd_code
 	CMD_RESET_STATS,
 	CMD_ROLL_STATS,
 	CMD_PREV_STATS,
+	CMD_AUTOROLL_STATS,
 	CMD_NAME_CHOICE,
 	CMD_ACCEPT_CHARACTER,
 
@@ -40,6 +41,7 @@ typedef enum cmd_code
 	CMD_WALK,
 	CMD_JUMP,
 	CMD_PATHFIND,
+	CMD_TRAVEL,
 
 	CMD_INSCRIBE,
 	CMD_UNINSCRIBE,
@@ -191,7 +193,7 @@ void cmd_set_arg_choice(game_command *cmd, int n, int choice);
 void cmd_set_arg_string(game_command *cmd, int n, const char *str);
 void cmd_set_arg_direction(game_command *cmd, int n, int dir);
 void cmd_set_arg_target(game_command *cmd, int n, int target);
-void cmd_set_arg_point(game_command *cmd, int n, int x, int y);
+void cmd_set_arg_point(game_command *cmd, int n, int y, int x);
 void cmd_set_arg_item(game_command *cmd, int n, int item);
 void cmd_set_arg_number(game_command *cmd, int n, int num);
 
@@ -30,6 +30,167 @@ struct event_handler_entry
 
 struct event_handler_entry *event_handlers[N_GAME_EVENTS];
 
+/*
+ * Between event_queue_begin() and event_queue_end(), plain and point events
+ * are kept back and sent once each when the outermost region ends, with a
+ * whole-map point (-1, -1) standing in for every other point of that type.
+ * Other events flush the queue and are then sent at once, so the order
+ * handlers see things in is kept.
+ */
+struct queued_event
+{
+	game_event_type type;
+	bool point;
+	int x, y;
+};
+
+static int event_queue_depth;
+static struct queued_event *event_queue;
+static size_t event_queue_len;
+static size_t event_queue_size;
+
+/* Plain events, and whole-map points, already queued */
+static bool event_queued[N_GAME_EVENTS];
+static bool event_queued_all[N_GAME_EVENTS];
+
+/* Open hash of queue entries + 1 for points, to find repeats */
+static size_t *event_queue_hash;
+static size_t event_queue_hash_size;
+
+#define EVENT_POINT_HASH(type, x, y) \
+	((((u32b)(type) * 31 + (u32b)(x)) * 257 + (u32b)(y)) * 2654435761U)
+
+static void game_event_dispatch(game_event_type type, game_event_data *data);
+
+static void event_queue_flush(void)
+{
+	struct queued_event *queue = event_queue;
+	size_t i, len = event_queue_len, size = event_queue_size;
+	bool all[N_GAME_EVENTS];
+
+	/* Take the queue, so that handlers can queue events of their own */
+	C_COPY(all, event_queued_all, N_GAME_EVENTS, bool);
+	event_queue = NULL;
+	event_queue_len = event_queue_size = 0;
+	C_WIPE(event_queued, N_GAME_EVENTS, bool);
+	C_WIPE(event_queued_all, N_GAME_EVENTS, bool);
+	if (event_queue_hash)
+		C_WIPE(event_queue_hash, event_queue_hash_size, size_t);
+
+	for (i = 0; i < len; i++)
+	{
+		struct queued_event *e = &queue[i];
+
+		if (e->point)
+		{
+			game_event_data data;
+
+			/* Covered by a whole-map point */
+			if (all[e->type] && (e->x != -1 || e->y != -1))
+				continue;
+
+			data.point.x = e->x;
+			data.point.y = e->y;
+			game_event_dispatch(e->type, &data);
+		}
+		else
+		{
+			game_event_dispatch(e->type, NULL);
+		}
+	}
+
+	/* Keep the memory for next time */
+	if (!event_queue)
+	{
+		event_queue = queue;
+		event_queue_size = size;
+	}
+	else
+	{
+		mem_free(queue);
+	}
+}
+
+static struct queued_event *event_queue_add(game_event_type type)
+{
+	struct queued_event *e;
+
+	if (event_queue_len == event_queue_size)
+	{
+		event_queue_size = event_queue_size ? event_queue_size * 2 : 64;
+		event_queue = mem_realloc(event_queue,
+		                          event_queue_size * sizeof *event_queue);
+	}
+
+	e = &event_queue[event_queue_len++];
+	e->type = type;
+	e->point = FALSE;
+	e->x = e->y = 0;
+
+	return e;
+}
+
+/*
+ * Queue a point, unless it already is; the hash is kept at least twice the
+ * size of the queue
+ */
+static void event_queue_point(game_event_type type, int x, int y)
+{
+	struct queued_event *e;
+	size_t h;
+
+	if (2 * (event_queue_len + 1) > event_queue_hash_size)
+	{
+		size_t i;
+
+		FREE(event_queue_hash);
+		event_queue_hash_size = event_queue_hash_size ?
+			event_queue_hash_size * 2 : 256;
+		event_queue_hash = C_ZNEW(event_queue_hash_size, size_t);
+
+		for (i = 0; i < event_queue_len; i++)
+		{
+			e = &event_queue[i];
+			if (!e->point) continue;
+
+			h = EVENT_POINT_HASH(e->type, e->x, e->y) &
+				(event_queue_hash_size - 1);
+			while (event_queue_hash[h])
+				h = (h + 1) & (event_queue_hash_size - 1);
+			event_queue_hash[h] = i + 1;
+		}
+	}
+
+	h = EVENT_POINT_HASH(type, x, y) & (event_queue_hash_size - 1);
+	for (; event_queue_hash[h]; h = (h + 1) & (event_queue_hash_size - 1))
+	{
+		e = &event_queue[event_queue_hash[h] - 1];
+		if ((e->type == type) && (e->x == x) && (e->y == y)) return;
+	}
+
+	event_queue_hash[h] = event_queue_len + 1;
+
+	e = event_queue_add(type);
+	e->point = TRUE;
+	e->x = x;
+	e->y = y;
+
+	if ((x == -1) && (y == -1)) event_queued_all[type] = TRUE;
+}
+
+void event_queue_begin(void)
+{
+	event_queue_depth++;
+}
+
+void event_queue_end(void)
+{
+	assert(event_queue_depth > 0);
+
+	if (--event_queue_depth == 0)
+		event_queue_flush();
+}
+
 static void game_event_dispatch(game_event_type type, game_event_data *data)
 {
 	struct event_handler_entry *this = event_handlers[type];
@@ -111,6 +272,13 @@ void event_remove_handler_set(game_event_type *type, size_t n_types, game_event_
 
 void event_signal(game_event_type type)
 {
+	if (event_queue_depth)
+	{
+		if (!event_queued[type]) event_queue_add(type);
+		event_queued[type] = TRUE;
+		return;
+	}
+
 	game_event_dispatch(type, NULL);
 }
 
@@ -119,6 +287,7 @@ void event_signal_flag(game_event_type type, bool flag)
 	game_event_data data;
 	data.flag = flag;
 
+	if (event_queue_depth) event_queue_flush();
 	game_event_dispatch(type, &data);
 }
 
@@ -129,6 +298,12 @@ void event_signal_point(game_event_type type, int x, int y)
 	data.point.x = x;
 	data.point.y = y;
 
+	if (event_queue_depth)
+	{
+		event_queue_point(type, x, y);
+		return;
+	}
+
 	game_event_dispatch(type, &data);
 }
 
@@ -138,6 +313,7 @@ void event_signal_string(game_event_type type, const char *s)
 	game_event_data data;
 	data.string = s;
 
+	if (event_queue_depth) event_queue_flush();
 	game_event_dispatch(type, &data);
 }
 
@@ -148,6 +324,7 @@ void event_signal_birthpoints(int stats[6], int remaining)
 	data.birthstats.stats = stats;
 	data.birthstats.remaining = remaining;
 
+	if (event_queue_depth) event_queue_flush();
 	game_event_dispatch(EVENT_BIRTHPOINTS, &data);
 }
 
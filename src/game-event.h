@@ -101,6 +101,9 @@ void event_remove_handler(game_event_type type, game_event_handler *fn, void *us
 void event_add_handler_set(game_event_type *type, size_t n_types, game_event_handler *fn, void *user);
 void event_remove_handler_set(game_event_type *type, size_t n_types, game_event_handler *fn, void *user);
 
+void event_queue_begin(void);
+void event_queue_end(void);
+
 void event_signal_birthpoints(int stats[6], int remaining);
 
 void event_signal_point(game_event_type, int x, int y);
@@ -19,6 +19,7 @@
 #include "angband.h"
 #include "cave.h"
 #include "files.h"
+#include "generate.h"
 #include "monster/monster.h"
 #include "object/tvalsval.h"
 #include "trap.h"
@@ -127,6 +128,9 @@
 #define DUN_TUN_CON	15	/* Chance of extra tunneling */
 #define DUN_TUN_PEN	25	/* Chance of doors at room entrances */
 #define DUN_TUN_JCT	90	/* Chance of doors at tunnel junctions */
+#define DUN_TUN_LOOP	30	/* Chance of an extra tunnel from each room */
+#define DUN_TUN_BEND	1	/* Cost of a bend in a planned tunnel */
+#define DUN_TUN_JIT	6	/* Random extra cost of a bend */
 
 /*
  * Dungeon streamer generation values
@@ -178,11 +182,16 @@
 #define WALL_MAX	500
 #define TUNN_MAX	900
 
+/*
+ * Most grids a tunnel plan may look at before giving up
+ */
+#define PLAN_MAX	8000
 
 /*
- * Maximum number of room types
+ * Steps a tunnel may walk, per grid it has to go, before it is planned
  */
-#define ROOM_MAX	10
+#define TUNN_EFFORT	4
+
 
 /*
  * Treasure allocation probabilities for nests
@@ -192,17 +201,55 @@
 #define UNDEAD_NEST_OBJ 5
 
 
+/*
+ * Height and width of the dungeon levels to make, which can be anything
+ * from TOWN_HGT by TOWN_WID up to DUNGEON_HGT by DUNGEON_WID (smaller
+ * levels are handy for benchmarks).  The town is always TOWN_HGT by
+ * TOWN_WID.  The size of the current level is in cave->height and
+ * cave->width.
+ */
+int dungeon_want_hgt = DUNGEON_HGT;
+int dungeon_want_wid = DUNGEON_WID;
+
 /*
  * Height and width for the currently generated level
  *
- * This differs from DUNGEON_HGT (and dungeon_hgt) in that it bounds the part
+ * This differs from cave->height and cave->width in that it bounds the part
  * of the level that might actually contain open squares. It will vary from
- * level to level, unlike the constant.
+ * level to level.
  */
 int level_hgt  = DUNGEON_HGT;
 int level_wid  = DUNGEON_WID;
 
 
+/*
+ * Generation profile, see "gen_profile_describe()"
+ */
+struct gen_profile gen_profile;
+
+/*
+ * What went into the level, see "struct level_tally"
+ */
+struct level_tally level_tally;
+
+/*
+ * The seed the current level was generated from
+ */
+u32b seed_level;
+
+
+/*
+ * Add the time since "*start" to phase "phase", and restart the clock
+ */
+static void gen_profile_phase(int phase, clock_t *start)
+{
+	clock_t now = clock();
+
+	gen_profile.phase[phase] += now - *start;
+	*start = now;
+}
+
+
 /*
  * Simple structure to hold a map location
  */
@@ -234,6 +281,10 @@ struct room_data
 
 /*
  * Structure to hold all "dungeon generation" data
+ *
+ * One of these is set up by generate_cave() for each attempt at a level,
+ * and passed down to the functions that need it, rather than being kept
+ * in a global.
  */
 
 typedef struct dun_data dun_data;
@@ -260,20 +311,14 @@ struct dun_data
 	int row_rooms;
 	int col_rooms;
 
-	/* Array of which blocks are used */
-	bool room_map[MAX_ROOMS_ROW][MAX_ROOMS_COL];
+	/* Which blocks are used, one bit per column of blocks in each row */
+	u32b room_map[MAX_ROOMS_ROW];
 
 	/* Hack -- there is a pit/nest on this level */
 	bool crowded;
 };
 
 
-/*
- * Dungeon generation data -- see "cave_gen()"
- */
-static dun_data *dun;
-
-
 /*
  * Array of room types (assumes 11x11 blocks)
  */
@@ -328,45 +373,51 @@ static void rand_dir(int *rdir, int *cdir)
 
 
 /*
- * Returns random co-ordinates for player/monster/object
+ * Grids the player may start on
  */
-static void new_player_spot(void)
+static bool player_spot_ok(int y, int x)
 {
-	int y, x;
+	/* Must be a "naked" floor grid */
+	if (!cave_naked_bold(y, x)) return FALSE;
 
-	/* Place the player */
-	while (1)
-	{
-		/* Pick a legal spot */
-		y = rand_range(1, level_hgt - 2);
-		x = rand_range(1, level_wid - 2);
+	/* Refuse to start on anti-teleport grids */
+	if (cave->grid[y][x].info & (CAVE_ICKY)) return FALSE;
 
-		/* Must be a "naked" floor grid */
-		if (!cave_naked_bold(y, x)) continue;
+	return TRUE;
+}
+
+/*
+ * Returns random co-ordinates for player/monster/object
+ *
+ * Returns FALSE if there is nowhere the player can start.
+ */
+static bool new_player_spot(void)
+{
+	int y, x;
 
-		/* Refuse to start on anti-teleport grids */
-		if (cave_info[y][x] & (CAVE_ICKY)) continue;
+	/* Pick a legal spot */
+	if (!cave_find_in_range(&y, 1, level_hgt - 2, &x, 1, level_wid - 2,
+			player_spot_ok))
+		return FALSE;
 
-		if (!OPT(adult_no_stairs))
+	if (!OPT(adult_no_stairs))
+	{
+		if (p_ptr->create_down_stair)
 		{
-			if (p_ptr->create_down_stair)
-			{
-				cave_set_feat(y, x, FEAT_MORE);
-				p_ptr->create_down_stair = FALSE;
-			}
-			else if (p_ptr->create_up_stair)
-			{
-				cave_set_feat(y, x, FEAT_LESS);
-				p_ptr->create_up_stair = FALSE;
-			}
+			cave_set_feat(y, x, FEAT_MORE);
+			p_ptr->create_down_stair = FALSE;
+		}
+		else if (p_ptr->create_up_stair)
+		{
+			cave_set_feat(y, x, FEAT_LESS);
+			p_ptr->create_up_stair = FALSE;
 		}
-
-		/* Done */
-		break;
 	}
 
 	/* Place the player */
 	player_place(y, x);
+
+	return TRUE;
 }
 
 
@@ -382,10 +433,10 @@ static int next_to_walls(int y, int x)
 {
 	int k = 0;
 
-	if (cave_feat[y+1][x] >= FEAT_WALL_EXTRA) k++;
-	if (cave_feat[y-1][x] >= FEAT_WALL_EXTRA) k++;
-	if (cave_feat[y][x+1] >= FEAT_WALL_EXTRA) k++;
-	if (cave_feat[y][x-1] >= FEAT_WALL_EXTRA) k++;
+	if (cave->grid[y+1][x].feat >= FEAT_WALL_EXTRA) k++;
+	if (cave->grid[y-1][x].feat >= FEAT_WALL_EXTRA) k++;
+	if (cave->grid[y][x+1].feat >= FEAT_WALL_EXTRA) k++;
+	if (cave->grid[y][x-1].feat >= FEAT_WALL_EXTRA) k++;
 
 	return (k);
 }
@@ -464,6 +515,11 @@ void place_object(int y, int x, int level, bool good, bool great)
 	/* Paranoia */
 	if (!in_bounds(y, x)) return;
 
+	/* Don't fill a new level up */
+	if (!character_dungeon && (o_cnt + GEN_SLOTS_FREE >= o_size) &&
+	    !o_list_grow(o_cnt + GEN_SLOTS_FREE + 1))
+		return;
+
 	/* Hack -- clean floor space */
 	if (!cave_clean_bold(y, x)) return;
 
@@ -476,6 +532,10 @@ void place_object(int y, int x, int level, bool good, bool great)
 	/* Make an object (if possible) */
 	if (make_object(i_ptr, level, good, great))
 	{
+		s16b old_cnt = o_cnt;
+		bool ood = !cursed_p(i_ptr) &&
+				(k_info[i_ptr->k_idx].level > p_ptr->depth);
+
 		i_ptr->origin = ORIGIN_FLOOR;
 		i_ptr->origin_depth = p_ptr->depth;
 
@@ -485,6 +545,13 @@ void place_object(int y, int x, int level, bool good, bool great)
 			/* XXX Should this be done in floor_carry? */
 			a_info[i_ptr->name1].created = FALSE;
 		}
+
+		/* Count it, unless it went on a pile like it */
+		else if (o_cnt > old_cnt)
+		{
+			level_tally.objects++;
+			if (ood) level_tally.ood++;
+		}
 	}
 }
 
@@ -500,6 +567,11 @@ void place_gold(int y, int x, int level)
 	/* Paranoia */
 	if (!in_bounds(y, x)) return;
 
+	/* Don't fill a new level up */
+	if (!character_dungeon && (o_cnt + GEN_SLOTS_FREE >= o_size) &&
+	    !o_list_grow(o_cnt + GEN_SLOTS_FREE + 1))
+		return;
+
 	/* Require clean floor space */
 	if (!cave_clean_bold(y, x)) return;
 
@@ -513,7 +585,8 @@ void place_gold(int y, int x, int level)
 	make_gold(i_ptr, level, SV_GOLD_ANY);
 
 	/* Give it to the floor */
-	(void)floor_carry(y, x, i_ptr);
+	if (floor_carry(y, x, i_ptr))
+		level_tally.gold += i_ptr->pval;
 }
 
 
@@ -606,60 +679,64 @@ void place_random_door(int y, int x)
 
 
 
+/*
+ * How many walls alloc_stairs() wants next to its stairs
+ */
+static int stair_walls;
+
+static bool stair_spot_ok(int y, int x)
+{
+	/* Require "naked" floor grid */
+	if (!cave_naked_bold(y, x)) return FALSE;
+
+	/* Require a certain number of adjacent walls */
+	return (next_to_walls(y, x) >= stair_walls);
+}
+
 /*
  * Places some staircases near walls
  */
 static void alloc_stairs(int feat, int num, int walls)
 {
-	int y, x, i, j, flag;
+	int y, x, i;
 
 
 	/* Place "num" stairs */
 	for (i = 0; i < num; i++)
 	{
-		/* Place some stairs */
-		for (flag = FALSE; !flag; )
+		/* Find a spot, with fewer walls if need be */
+		for (stair_walls = walls; ; stair_walls--)
 		{
-			/* Try several times, then decrease "walls" */
-			for (j = 0; !flag && j <= 3000; j++)
-			{
-				/* Pick a random grid */
-				y = randint0(level_hgt);
-				x = randint0(level_wid);
-
-				/* Require "naked" floor grid */
-				if (!cave_naked_bold(y, x)) continue;
+			if (cave_find_in_range(&y, 1, level_hgt - 2, &x, 1, level_wid - 2,
+					stair_spot_ok)) break;
 
-				/* Require a certain number of adjacent walls */
-				if (next_to_walls(y, x) < walls) continue;
-
-				/* Town -- must go down */
-				if (!p_ptr->depth)
-				{
-					/* Clear previous contents, add down stairs */
-					cave_set_feat(y, x, FEAT_MORE);
-				}
+			/* Nowhere at all */
+			if (!stair_walls) return;
+		}
 
-				/* Quest -- must go up */
-				else if (is_quest(p_ptr->depth) || (p_ptr->depth >= MAX_DEPTH-1))
-				{
-					/* Clear previous contents, add up stairs */
-					cave_set_feat(y, x, FEAT_LESS);
-				}
+		/* Require fewer walls next time */
+		walls = stair_walls;
+		if (walls) walls--;
 
-				/* Requested type */
-				else
-				{
-					/* Clear previous contents, add stairs */
-					cave_set_feat(y, x, feat);
-				}
+		/* Town -- must go down */
+		if (!p_ptr->depth)
+		{
+			/* Clear previous contents, add down stairs */
+			cave_set_feat(y, x, FEAT_MORE);
+		}
 
-				/* All done */
-				flag = TRUE;
-			}
+		/* Quest -- must go up */
+		else if (is_quest(p_ptr->depth) || (p_ptr->depth >= MAX_DEPTH-1))
+		{
+			/* Clear previous contents, add up stairs */
+			cave_set_feat(y, x, FEAT_LESS);
+		}
 
-			/* Require fewer walls */
-			if (walls) walls--;
+		/* Requested type */
+		else
+		{
+			/* Clear previous contents, add stairs */
+			cave_set_feat(y, x, feat);
 		}
 	}
 }
@@ -667,42 +744,52 @@ static void alloc_stairs(int feat, int num, int walls)
 
 
 /*
- * Allocates some objects (using "place" and "type")
+ * Grids nothing is on
  */
-static void alloc_object(int set, int typ, int num, int depth)
+static bool cave_naked_ok(int y, int x)
+{
+	return (cave_naked_bold(y, x));
+}
+
+
+/*
+ * Where alloc_object() wants its objects
+ */
+static int object_set;
+
+static bool object_spot_ok(int y, int x)
 {
-	int y, x, k, tries;
 	bool room;
 
-	/* Place some objects */
-	for (k = 0; k < num; k++)
-	{
-		tries = 0;
+	/* Require "naked" floor grid */
+	if (!cave_naked_bold(y, x)) return FALSE;
 
-		/* Pick a "legal" spot */
-		while (tries < 10000)
-		{
-			tries++;
+	/* Check for "room" */
+	room = (cave->grid[y][x].info & (CAVE_ROOM)) ? TRUE : FALSE;
 
-			/* Location */
-			y = randint0(level_hgt);
-			x = randint0(level_wid);
+	/* Require corridor? */
+	if ((object_set == ALLOC_SET_CORR) && room) return FALSE;
 
-			/* Require "naked" floor grid */
-			if (!cave_naked_bold(y, x)) continue;
+	/* Require room? */
+	if ((object_set == ALLOC_SET_ROOM) && !room) return FALSE;
 
-			/* Check for "room" */
-			room = (cave_info[y][x] & (CAVE_ROOM)) ? TRUE : FALSE;
+	return TRUE;
+}
 
-			/* Require corridor? */
-			if ((set == ALLOC_SET_CORR) && room) continue;
+/*
+ * Allocates some objects (using "place" and "type")
+ */
+static void alloc_object(int set, int typ, int num, int depth)
+{
+	int y, x, k;
 
-			/* Require room? */
-			if ((set == ALLOC_SET_ROOM) && !room) continue;
+	object_set = set;
 
-			/* Accept it */
-			break;
-		}
+	/* Place some objects */
+	for (k = 0; k < num; k++)
+	{
+		/* Pick a "legal" spot */
+		if (!cave_find(&y, &x, object_spot_ok)) return;
 
 		/* Place something */
 		switch (typ)
@@ -751,8 +838,8 @@ static void build_streamer(int feat, int chance)
 
 
 	/* Hack -- Choose starting point */
-	y = rand_spread(DUNGEON_HGT / 2, 10);
-	x = rand_spread(DUNGEON_WID / 2, 15);
+	y = rand_spread(cave->height / 2, 10);
+	x = rand_spread(cave->width / 2, 15);
 
 	/* Choose a random compass direction */
 	dir = ddd[randint0(8)];
@@ -775,14 +862,14 @@ static void build_streamer(int feat, int chance)
 			}
 
 			/* Only convert "granite" walls */
-			if (cave_feat[ty][tx] < FEAT_WALL_EXTRA) continue;
-			if (cave_feat[ty][tx] > FEAT_WALL_SOLID) continue;
+			if (cave->grid[ty][tx].feat < FEAT_WALL_EXTRA) continue;
+			if (cave->grid[ty][tx].feat > FEAT_WALL_SOLID) continue;
 
 			/* Clear previous contents, add proper vein type */
 			cave_set_feat(ty, tx, feat);
 
 			/* Hack -- Add some (known) treasure */
-			if (one_in_(chance)) cave_feat[ty][tx] += 0x04;
+			if (one_in_(chance)) cave->grid[ty][tx].feat += 0x04;
 		}
 
 		/* Advance the streamer */
@@ -927,8 +1014,8 @@ static void generate_room(int y1, int x1, int y2, int x2, int light)
 	{
 		for (x = x1; x <= x2; x++)
 		{
-			cave_info[y][x] |= (CAVE_ROOM);
-			if (light) cave_info[y][x] |= (CAVE_GLOW);
+			cave->grid[y][x].info |= (CAVE_ROOM);
+			if (light) cave->grid[y][x].info |= (CAVE_GLOW);
 		}
 	}
 }
@@ -1883,6 +1970,7 @@ static void build_type5(int y0, int x0)
 
 	/* Increase the level rating */
 	rating += 10;
+	level_tally.pits++;
 
 	/* (Sometimes) Cause a "special feeling" (for "Monster Nests") */
 	if ((p_ptr->depth <= 40) &&
@@ -2197,6 +2285,7 @@ static void build_type6(int y0, int x0)
 
 	/* Increase the level rating */
 	rating += 10;
+	level_tally.pits++;
 
 	/* (Sometimes) Cause a "special feeling" (for "Monster Pits") */
 	if ((p_ptr->depth <= 40) &&
@@ -2260,144 +2349,141 @@ static void build_type6(int y0, int x0)
 
 /*
  * Hack -- fill in "vault" rooms
+ *
+ * The vault's text has been turned into lists of its non-blank grids when
+ * "vault.txt" was read (see "compile_vault()" in init2.c).
  */
-static void build_vault(int y0, int x0, int ymax, int xmax, cptr data)
+static void build_vault(int y0, int x0, const vault_type *v_ptr)
 {
-	int dx, dy, x, y;
+	int i, x, y;
 
-	cptr t;
+	/* Top left corner */
+	int y1 = y0 - (v_ptr->hgt / 2);
+	int x1 = x0 - (v_ptr->wid / 2);
 
 
 	/* Place dungeon features and objects */
-	for (t = data, dy = 0; dy < ymax; dy++)
+	for (i = 0; i < v_ptr->n_grids; i++)
 	{
-		for (dx = 0; dx < xmax; dx++, t++)
-		{
-			/* Extract the location */
-			x = x0 - (xmax / 2) + dx;
-			y = y0 - (ymax / 2) + dy;
+		const struct vault_grid *g = &v_ptr->grids[i];
 
-			/* Hack -- skip "non-grids" */
-			if (*t == ' ') continue;
+		/* Extract the location */
+		x = x1 + g->x;
+		y = y1 + g->y;
 
-			/* Lay down a floor */
-			cave_set_feat(y, x, FEAT_FLOOR);
+		/* Lay down a floor */
+		cave_set_feat(y, x, FEAT_FLOOR);
 
-			/* Part of a vault */
-			cave_info[y][x] |= (CAVE_ROOM | CAVE_ICKY);
+		/* Part of a vault */
+		cave->grid[y][x].info |= (CAVE_ROOM | CAVE_ICKY);
 
-			/* Analyze the grid */
-			switch (*t)
+		/* Analyze the grid */
+		switch (g->code)
+		{
+			/* Granite wall (outer) */
+			case '%':
 			{
-				/* Granite wall (outer) */
-				case '%':
-				{
-					cave_set_feat(y, x, FEAT_WALL_OUTER);
-					break;
-				}
-
-				/* Granite wall (inner) */
-				case '#':
-				{
-					cave_set_feat(y, x, FEAT_WALL_INNER);
-					break;
-				}
+				cave_set_feat(y, x, FEAT_WALL_OUTER);
+				break;
+			}
 
-				/* Permanent wall (inner) */
-				case 'X':
-				{
-					cave_set_feat(y, x, FEAT_PERM_INNER);
-					break;
-				}
+			/* Granite wall (inner) */
+			case '#':
+			{
+				cave_set_feat(y, x, FEAT_WALL_INNER);
+				break;
+			}
 
-				/* Treasure/trap */
-				case '*':
-				{
-					if (randint0(100) < 75)
-					{
-						place_object(y, x, p_ptr->depth, FALSE, FALSE);
-					}
-					else
-					{
-						place_trap(y, x);
-					}
-					break;
-				}
+			/* Permanent wall (inner) */
+			case 'X':
+			{
+				cave_set_feat(y, x, FEAT_PERM_INNER);
+				break;
+			}
 
-				/* Secret doors */
-				case '+':
+			/* Treasure/trap */
+			case '*':
+			{
+				if (randint0(100) < 75)
 				{
-					place_secret_door(y, x);
-					break;
+					place_object(y, x, p_ptr->depth, FALSE, FALSE);
 				}
-
-				/* Trap */
-				case '^':
+				else
 				{
 					place_trap(y, x);
-					break;
 				}
+				break;
+			}
+
+			/* Secret doors */
+			case '+':
+			{
+				place_secret_door(y, x);
+				break;
+			}
+
+			/* Trap */
+			case '^':
+			{
+				place_trap(y, x);
+				break;
 			}
 		}
 	}
 
 
 	/* Place dungeon monsters and objects */
-	for (t = data, dy = 0; dy < ymax; dy++)
+	for (i = 0; i < v_ptr->n_spawns; i++)
 	{
-		for (dx = 0; dx < xmax; dx++, t++)
-		{
-			/* Extract the grid */
-			x = x0 - (xmax/2) + dx;
-			y = y0 - (ymax/2) + dy;
+		const struct vault_grid *g = &v_ptr->spawns[i];
 
-			/* Hack -- skip "non-grids" */
-			if (*t == ' ') continue;
+		/* Extract the grid */
+		x = x1 + g->x;
+		y = y1 + g->y;
 
-			/* Analyze the symbol */
-			switch (*t)
+		/* Analyze the symbol */
+		switch (g->code)
+		{
+			/* Monster */
+			case '&':
 			{
-				/* Monster */
-				case '&':
-				{
-					place_monster(y, x, p_ptr->depth + 5, TRUE, TRUE);
-					break;
-				}
+				place_monster(y, x, p_ptr->depth + 5, TRUE, TRUE);
+				break;
+			}
 
-				/* Meaner monster */
-				case '@':
-				{
-					place_monster(y, x, p_ptr->depth + 11, TRUE, TRUE);
-					break;
-				}
+			/* Meaner monster */
+			case '@':
+			{
+				place_monster(y, x, p_ptr->depth + 11, TRUE, TRUE);
+				break;
+			}
 
-				/* Meaner monster, plus treasure */
-				case '9':
-				{
-					place_monster(y, x, p_ptr->depth + 9, TRUE, TRUE);
-					place_object(y, x, p_ptr->depth + 7, TRUE, FALSE);
-					break;
-				}
+			/* Meaner monster, plus treasure */
+			case '9':
+			{
+				place_monster(y, x, p_ptr->depth + 9, TRUE, TRUE);
+				place_object(y, x, p_ptr->depth + 7, TRUE, FALSE);
+				break;
+			}
 
-				/* Nasty monster and treasure */
-				case '8':
-				{
-					place_monster(y, x, p_ptr->depth + 40, TRUE, TRUE);
-					place_object(y, x, p_ptr->depth + 20, TRUE, FALSE);
-					break;
-				}
+			/* Nasty monster and treasure */
+			case '8':
+			{
+				place_monster(y, x, p_ptr->depth + 40, TRUE, TRUE);
+				place_object(y, x, p_ptr->depth + 20, TRUE, FALSE);
+				break;
+			}
 
-				/* Monster and/or object */
-				case ',':
-				{
-					if (randint0(100) < 50)
-						place_monster(y, x, p_ptr->depth + 3, TRUE, TRUE);
+			/* Monster and/or object */
+			case ',':
+			{
+				if (randint0(100) < 50)
+					place_monster(y, x, p_ptr->depth + 3, TRUE, TRUE);
 
-					if (randint0(100) < 50)
-						place_object(y, x, p_ptr->depth + 7, FALSE, FALSE);
+				if (randint0(100) < 50)
+					place_object(y, x, p_ptr->depth + 7, FALSE, FALSE);
 
-					break;
-				}
+				break;
 			}
 		}
 	}
@@ -2427,6 +2513,7 @@ static void build_type7(int y0, int x0)
 
 	/* Boost the rating */
 	rating += v_ptr->rat;
+	level_tally.vaults++;
 
 	/* (Sometimes) Cause a special feeling */
 	if ((p_ptr->depth <= 50) ||
@@ -2436,7 +2523,7 @@ static void build_type7(int y0, int x0)
 	}
 
 	/* Hack -- Build the vault */
-	build_vault(y0, x0, v_ptr->hgt, v_ptr->wid, v_ptr->text);
+	build_vault(y0, x0, v_ptr);
 }
 
 
@@ -2463,6 +2550,7 @@ static void build_type8(int y0, int x0)
 
 	/* Boost the rating */
 	rating += v_ptr->rat;
+	level_tally.vaults++;
 
 	/* (Sometimes) Cause a special feeling */
 	if ((p_ptr->depth <= 50) ||
@@ -2472,7 +2560,7 @@ static void build_type8(int y0, int x0)
 	}
 
 	/* Hack -- Build the vault */
-	build_vault(y0, x0, v_ptr->hgt, v_ptr->wid, v_ptr->text);
+	build_vault(y0, x0, v_ptr);
 }
 
 /*
@@ -2497,6 +2585,7 @@ static void build_type9(int y0, int x0)
 
 	/* Boost the rating */
 	rating += v_ptr->rat;
+	level_tally.vaults++;
 
 	/* (Sometimes) Cause a special feeling */
 	if ((p_ptr->depth <= 50) ||
@@ -2506,10 +2595,139 @@ static void build_type9(int y0, int x0)
 	}
 
 	/* Hack -- Build the vault */
-	build_vault(y0, x0, v_ptr->hgt, v_ptr->wid, v_ptr->text);
+	build_vault(y0, x0, v_ptr);
+}
+
+
+
+/*
+ * Add grid (y, x) to the tunnel being built, which started at (start_row,
+ * start_col), and return FALSE if the tunnel should stop there.
+ *
+ * The grid must already be known to be a legal step; see build_tunnel().
+ */
+static bool tunnel_step(dun_data *dun, int y, int x, bool *door_flag,
+                        int start_row, int start_col)
+{
+	int yy, xx;
+
+	/* Pierce "outer" walls of rooms */
+	if (cave->grid[y][x].feat == FEAT_WALL_OUTER)
+	{
+		/* Save the wall location */
+		if (dun->wall_n < WALL_MAX)
+		{
+			dun->wall[dun->wall_n].y = y;
+			dun->wall[dun->wall_n].x = x;
+			dun->wall_n++;
+		}
+
+		/* Forbid re-entry near this piercing */
+		for (yy = y - 1; yy <= y + 1; yy++)
+		{
+			for (xx = x - 1; xx <= x + 1; xx++)
+			{
+				/* Convert adjacent "outer" walls as "solid" walls */
+				if (cave->grid[yy][xx].feat == FEAT_WALL_OUTER)
+				{
+					/* Change the wall to a "solid" wall */
+					cave_set_feat(yy, xx, FEAT_WALL_SOLID);
+				}
+			}
+		}
+	}
+
+	/* Travel quickly through rooms */
+	else if (cave->grid[y][x].info & (CAVE_ROOM))
+	{
+		/* Nothing to do */
+	}
+
+	/* Tunnel through all other walls */
+	else if (cave->grid[y][x].feat >= FEAT_WALL_EXTRA)
+	{
+		/* Save the tunnel location */
+		if (dun->tunn_n < TUNN_MAX)
+		{
+			dun->tunn[dun->tunn_n].y = y;
+			dun->tunn[dun->tunn_n].x = x;
+			dun->tunn_n++;
+		}
+
+		/* Allow door in next grid */
+		*door_flag = FALSE;
+	}
+
+	/* Handle corridor intersections or overlaps */
+	else
+	{
+		/* Collect legal door locations */
+		if (!*door_flag)
+		{
+			/* Save the door location */
+			if (dun->door_n < DOOR_MAX)
+			{
+				dun->door[dun->door_n].y = y;
+				dun->door[dun->door_n].x = x;
+				dun->door_n++;
+			}
+
+			/* No door in next grid */
+			*door_flag = TRUE;
+		}
+
+		/* Hack -- allow pre-emptive tunnel termination */
+		if (randint0(100) >= DUN_TUN_CON)
+		{
+			/* Terminate the tunnel */
+			if ((ABS(y - start_row) > 10) || (ABS(x - start_col) > 10))
+				return (FALSE);
+		}
+	}
+
+	return (TRUE);
 }
 
 
+/*
+ * Turn the tunnel that has been built into corridor, and open up the
+ * piercings it made in the walls of rooms
+ */
+static void tunnel_finish(dun_data *dun)
+{
+	int i, y, x;
+
+	/* Turn the tunnel into corridor */
+	for (i = 0; i < dun->tunn_n; i++)
+	{
+		/* Get the grid */
+		y = dun->tunn[i].y;
+		x = dun->tunn[i].x;
+
+		/* Clear previous contents, add a floor */
+		cave_set_feat(y, x, FEAT_FLOOR);
+	}
+
+
+	/* Apply the piercings that we found */
+	for (i = 0; i < dun->wall_n; i++)
+	{
+		/* Get the grid */
+		y = dun->wall[i].y;
+		x = dun->wall[i].x;
+
+		/* Convert to floor grid */
+		cave_set_feat(y, x, FEAT_FLOOR);
+
+		/* Occasional doorway */
+		if (randint0(100) < DUN_TUN_PEN)
+		{
+			/* Place a random door */
+			place_random_door(y, x);
+		}
+	}
+}
+
 
 /*
  * Constructs a tunnel between two points
@@ -2544,16 +2762,24 @@ static void build_type9(int y0, int x0)
  *   FEAT_PERM_INNER -- inner room walls (perma)
  *   FEAT_PERM_OUTER -- outer room walls (perma)
  *   FEAT_PERM_SOLID -- dungeon border (perma)
+ *
+ * The walk gives up once it has taken TUNN_EFFORT steps per grid of the
+ * distance it had to go (plus a few), returning FALSE with the place it got
+ * to in "end".  Otherwise it returns TRUE, having either got there or run
+ * into another corridor.
  */
-static void build_tunnel(int row1, int col1, int row2, int col2)
+static bool build_tunnel(dun_data *dun, int row1, int col1, int row2, int col2,
+                         coord *end)
 {
-	int i, y, x;
+	int y, x;
 	int tmp_row, tmp_col;
 	int row_dir, col_dir;
 	int start_row, start_col;
 	int main_loop_count = 0;
+	int effort = TUNN_EFFORT * (ABS(row2 - row1) + ABS(col2 - col1)) + 20;
 
 	bool door_flag = FALSE;
+	bool done = TRUE;
 
 
 
@@ -2571,8 +2797,12 @@ static void build_tunnel(int row1, int col1, int row2, int col2)
 	/* Keep going until done (or bored) */
 	while ((row1 != row2) || (col1 != col2))
 	{
-		/* Mega-Hack -- Paranoia -- prevent infinite loops */
-		if (main_loop_count++ > 2000) break;
+		/* Give up on wandering tunnels */
+		if (main_loop_count++ > effort)
+		{
+			done = FALSE;
+			break;
+		}
 
 		/* Allow bends in the tunnel */
 		if (randint0(100) < DUN_TUN_CHG)
@@ -2611,152 +2841,366 @@ static void build_tunnel(int row1, int col1, int row2, int col2)
 
 
 		/* Avoid the edge of the dungeon */
-		if (cave_feat[tmp_row][tmp_col] == FEAT_PERM_SOLID) continue;
+		if (cave->grid[tmp_row][tmp_col].feat == FEAT_PERM_SOLID) continue;
 
 		/* Avoid the edge of vaults */
-		if (cave_feat[tmp_row][tmp_col] == FEAT_PERM_OUTER) continue;
+		if (cave->grid[tmp_row][tmp_col].feat == FEAT_PERM_OUTER) continue;
 
 		/* Avoid "solid" granite walls */
-		if (cave_feat[tmp_row][tmp_col] == FEAT_WALL_SOLID) continue;
+		if (cave->grid[tmp_row][tmp_col].feat == FEAT_WALL_SOLID) continue;
 
-		/* Pierce "outer" walls of rooms */
-		if (cave_feat[tmp_row][tmp_col] == FEAT_WALL_OUTER)
+		/* Only pierce "outer" walls of rooms from outside */
+		if (cave->grid[tmp_row][tmp_col].feat == FEAT_WALL_OUTER)
 		{
 			/* Get the "next" location */
 			y = tmp_row + row_dir;
 			x = tmp_col + col_dir;
 
 			/* Hack -- Avoid outer/solid permanent walls */
-			if (cave_feat[y][x] == FEAT_PERM_SOLID) continue;
-			if (cave_feat[y][x] == FEAT_PERM_OUTER) continue;
+			if (cave->grid[y][x].feat == FEAT_PERM_SOLID) continue;
+			if (cave->grid[y][x].feat == FEAT_PERM_OUTER) continue;
 
 			/* Hack -- Avoid outer/solid granite walls */
-			if (cave_feat[y][x] == FEAT_WALL_OUTER) continue;
-			if (cave_feat[y][x] == FEAT_WALL_SOLID) continue;
+			if (cave->grid[y][x].feat == FEAT_WALL_OUTER) continue;
+			if (cave->grid[y][x].feat == FEAT_WALL_SOLID) continue;
+		}
 
-			/* Accept this location */
-			row1 = tmp_row;
-			col1 = tmp_col;
+		/* Accept this location */
+		row1 = tmp_row;
+		col1 = tmp_col;
 
-			/* Save the wall location */
-			if (dun->wall_n < WALL_MAX)
-			{
-				dun->wall[dun->wall_n].y = row1;
-				dun->wall[dun->wall_n].x = col1;
-				dun->wall_n++;
-			}
+		/* Build the tunnel */
+		if (!tunnel_step(dun, row1, col1, &door_flag, start_row, start_col))
+			break;
+	}
+
+	tunnel_finish(dun);
+
+	end->y = row1;
+	end->x = col1;
+	return (done);
+}
+
+
+/*
+ * Scratch space for plan_tunnel().  A search state is a grid and the
+ * direction the tunnel entered it in, numbered (GRID(y, x) * 4 + dir);
+ * plan_stamp[] marks which states the current search has reached, so that
+ * nothing needs clearing between searches.
+ */
+#define PLAN_STATES	(DUNGEON_HGT * CAVE_ROW * 4)
+
+static u16b plan_stamp[PLAN_STATES];	/* Search that last reached the state */
+static u16b plan_cost[PLAN_STATES];	/* Cheapest cost found to the state */
+static u32b plan_from[PLAN_STATES];	/* State it was reached from */
+static u32b plan_heap[PLAN_MAX * 4];	/* Open states, as (estimate << 17 | state) */
+static u16b plan_search = 0;
 
-			/* Forbid re-entry near this piercing */
-			for (y = row1 - 1; y <= row1 + 1; y++)
-			{
-				for (x = col1 - 1; x <= col1 + 1; x++)
-				{
-					/* Convert adjacent "outer" walls as "solid" walls */
-					if (cave_feat[y][x] == FEAT_WALL_OUTER)
-					{
-						/* Change the wall to a "solid" wall */
-						cave_set_feat(y, x, FEAT_WALL_SOLID);
-					}
-				}
-			}
-		}
 
-		/* Travel quickly through rooms */
-		else if (cave_info[tmp_row][tmp_col] & (CAVE_ROOM))
+/*
+ * Remove the open state with the lowest estimate from the heap of "n"
+ */
+static u32b plan_pop(int n)
+{
+	u32b top = plan_heap[0];
+	u32b last = plan_heap[n - 1];
+	int i = 0;
+
+	n--;
+
+	while (TRUE)
+	{
+		int c = 2 * i + 1;
+
+		if (c >= n) break;
+		if ((c + 1 < n) && (plan_heap[c + 1] < plan_heap[c])) c++;
+		if (last <= plan_heap[c]) break;
+
+		plan_heap[i] = plan_heap[c];
+		i = c;
+	}
+
+	plan_heap[i] = last;
+
+	return (top);
+}
+
+
+/*
+ * Add a state to the heap of "n"
+ */
+static void plan_push(int n, u32b entry)
+{
+	int i = n;
+
+	while (i > 0)
+	{
+		int p = (i - 1) / 2;
+
+		if (plan_heap[p] <= entry) break;
+
+		plan_heap[i] = plan_heap[p];
+		i = p;
+	}
+
+	plan_heap[i] = entry;
+}
+
+
+/*
+ * The cost of entering grid (y, x) going in direction "dir" from grid
+ * (y - ddy_ddd[dir], x - ddx_ddd[dir]), or zero if the tunnel can't go
+ * there.  These are the same rules build_tunnel() walks by.
+ */
+static int plan_step_cost(int y, int x, int dir)
+{
+	int feat;
+
+	if (!in_bounds_fully(y, x)) return (0);
+
+	feat = cave->grid[y][x].feat;
+
+	/* Avoid the edge of the dungeon and of vaults, and "solid" walls */
+	if ((feat == FEAT_PERM_SOLID) || (feat == FEAT_PERM_OUTER) ||
+	    (feat == FEAT_WALL_SOLID))
+		return (0);
+
+	/* Outer walls of rooms may be pierced, if the room is beyond them */
+	if (feat == FEAT_WALL_OUTER)
+	{
+		int beyond = cave->grid[y + ddy_ddd[dir]][x + ddx_ddd[dir]].feat;
+
+		if ((beyond == FEAT_PERM_SOLID) || (beyond == FEAT_PERM_OUTER) ||
+		    (beyond == FEAT_WALL_OUTER) || (beyond == FEAT_WALL_SOLID))
+			return (0);
+
+		return (3);
+	}
+
+	/* Rooms and corridors are cheap to go through */
+	if ((cave->grid[y][x].info & (CAVE_ROOM)) || (feat < FEAT_WALL_EXTRA))
+		return (1);
+
+	/* Granite costs a little more, by a random amount */
+	return (2 + randint0(3));
+}
+
+
+/*
+ * Plan a tunnel from (row1, col1) to (row2, col2) and build it, returning
+ * FALSE (having built nothing) if it can't be done in reasonable time.
+ *
+ * This is a best-first search over the grids the random walk could use,
+ * with random extra costs for granite and for bends so that the tunnel
+ * doesn't look too unlike the walk's.  It gives up after looking at
+ * PLAN_MAX grids, so no tunnel takes long.
+ */
+static bool plan_tunnel(dun_data *dun, int row1, int col1, int row2, int col2)
+{
+	static coord path[DUNGEON_HGT * DUNGEON_WID];
+
+	int n = 0, looked = 0, len = 0, i, dir;
+	u32b goal = 0;
+	bool found = FALSE, door_flag = FALSE;
+
+	/* A new search; start again when the stamps run out */
+	if (++plan_search == 0)
+	{
+		C_WIPE(plan_stamp, PLAN_STATES, u16b);
+		plan_search = 1;
+	}
+
+	/* Start out in every direction */
+	for (dir = 0; dir < 4; dir++)
+	{
+		u32b state = GRID(row1, col1) * 4 + dir;
+		int est = 3 * (ABS(row2 - row1) + ABS(col2 - col1));
+
+		plan_stamp[state] = plan_search;
+		plan_cost[state] = 0;
+		plan_from[state] = state;
+		plan_push(n++, ((u32b)est << 17) | state);
+	}
+
+	while (n && (looked < PLAN_MAX))
+	{
+		u32b state = plan_pop(n--) & 0x1FFFF;
+		int g = state / 4;
+		int y = GRID_Y(g), x = GRID_X(g);
+		int last = state % 4;
+
+		/* Arrived */
+		if ((y == row2) && (x == col2))
 		{
-			/* Accept the location */
-			row1 = tmp_row;
-			col1 = tmp_col;
+			goal = state;
+			found = TRUE;
+			break;
 		}
 
-		/* Tunnel through all other walls */
-		else if (cave_feat[tmp_row][tmp_col] >= FEAT_WALL_EXTRA)
+		looked++;
+
+		for (dir = 0; dir < 4; dir++)
 		{
-			/* Accept this location */
-			row1 = tmp_row;
-			col1 = tmp_col;
+			int ny = y + ddy_ddd[dir];
+			int nx = x + ddx_ddd[dir];
+			int cost, est;
+			u32b next;
 
-			/* Save the tunnel location */
-			if (dun->tunn_n < TUNN_MAX)
-			{
-				dun->tunn[dun->tunn_n].y = row1;
-				dun->tunn[dun->tunn_n].x = col1;
-				dun->tunn_n++;
-			}
+			/* A piercing must go straight on into the room */
+			if ((cave->grid[y][x].feat == FEAT_WALL_OUTER) && (dir != last))
+				continue;
 
-			/* Allow door in next grid */
-			door_flag = FALSE;
-		}
+			cost = plan_step_cost(ny, nx, dir);
+			if (!cost) continue;
 
-		/* Handle corridor intersections or overlaps */
-		else
-		{
-			/* Accept the location */
-			row1 = tmp_row;
-			col1 = tmp_col;
+			/* Bends cost more */
+			if ((dir != last) && (state != plan_from[state]))
+				cost += DUN_TUN_BEND + randint0(DUN_TUN_JIT);
 
-			/* Collect legal door locations */
-			if (!door_flag)
-			{
-				/* Save the door location */
-				if (dun->door_n < DOOR_MAX)
-				{
-					dun->door[dun->door_n].y = row1;
-					dun->door[dun->door_n].x = col1;
-					dun->door_n++;
-				}
+			cost += plan_cost[state];
+			if (cost > 60000) continue;
 
-				/* No door in next grid */
-				door_flag = TRUE;
-			}
+			next = GRID(ny, nx) * 4 + dir;
+			if ((plan_stamp[next] == plan_search) && (plan_cost[next] <= cost))
+				continue;
 
-			/* Hack -- allow pre-emptive tunnel termination */
-			if (randint0(100) >= DUN_TUN_CON)
-			{
-				/* Distance between row1 and start_row */
-				tmp_row = row1 - start_row;
-				if (tmp_row < 0) tmp_row = (-tmp_row);
+			/* No room left to look further */
+			if (n >= (int)N_ELEMENTS(plan_heap)) continue;
 
-				/* Distance between col1 and start_col */
-				tmp_col = col1 - start_col;
-				if (tmp_col < 0) tmp_col = (-tmp_col);
+			plan_stamp[next] = plan_search;
+			plan_cost[next] = cost;
+			plan_from[next] = state;
 
-				/* Terminate the tunnel */
-				if ((tmp_row > 10) || (tmp_col > 10)) break;
-			}
+			est = cost + 3 * (ABS(row2 - ny) + ABS(col2 - nx));
+			plan_push(n++, ((u32b)MIN(est, 0x7FFF) << 17) | next);
 		}
 	}
 
+	if (!found) return (FALSE);
 
-	/* Turn the tunnel into corridor */
-	for (i = 0; i < dun->tunn_n; i++)
+	/* Read the path back from the goal */
+	while (plan_from[goal] != goal)
 	{
-		/* Get the grid */
-		y = dun->tunn[i].y;
-		x = dun->tunn[i].x;
+		path[len].y = GRID_Y(goal / 4);
+		path[len].x = GRID_X(goal / 4);
+		len++;
+		goal = plan_from[goal];
+	}
 
-		/* Clear previous contents, add a floor */
-		cave_set_feat(y, x, FEAT_FLOOR);
+	/* Build the tunnel along it, from the start */
+	dun->tunn_n = 0;
+	dun->wall_n = 0;
+
+	for (i = len - 1; i >= 0; i--)
+	{
+		int y = path[i].y, x = path[i].x;
+
+		/* An earlier piercing has walled this off; pierce it anyway */
+		if (cave->grid[y][x].feat == FEAT_WALL_SOLID)
+			cave_set_feat(y, x, FEAT_WALL_OUTER);
+
+		if (!tunnel_step(dun, y, x, &door_flag, row1, col1)) break;
 	}
 
+	tunnel_finish(dun);
 
-	/* Apply the piercings that we found */
-	for (i = 0; i < dun->wall_n; i++)
+	return (TRUE);
+}
+
+
+/*
+ * Join room "i" to room "j": walk a tunnel there, and if the walk wanders
+ * off, plan the rest of the way from wherever it got to
+ */
+static void join_rooms(dun_data *dun, int i, int j)
+{
+	int y2 = dun->cent[j].y, x2 = dun->cent[j].x;
+	coord end;
+
+	gen_profile.tunnels++;
+	if (build_tunnel(dun, dun->cent[i].y, dun->cent[i].x, y2, x2, &end))
+		return;
+
+	gen_profile.tunnels_planned++;
+	if (!plan_tunnel(dun, end.y, end.x, y2, x2))
+		gen_profile.tunnels_failed++;
+}
+
+
+/*
+ * Connect all the rooms together.
+ *
+ * Each room is joined to the nearest room already joined up, which gives a
+ * spanning tree of short tunnels, each started from the room that is new
+ * to the tree.  If a tunnel stops early at another corridor, that corridor
+ * is part of the tree already.
+ *
+ * Tunnels "travel quickly" through rooms without digging, so a tunnel into
+ * a vault or an inner room may not really get anywhere; so, as when every
+ * room was joined to two others, rooms at the ends of the tree, and some
+ * others, get one more tunnel, to a room anywhere on the level.  This also
+ * gives the level its loops and long corridors.
+ */
+static void connect_rooms(dun_data *dun)
+{
+	bool joined[CENT_MAX];
+	int near[CENT_MAX];
+	int dist[CENT_MAX];
+	int tunnels[CENT_MAX];
+	int i, j, k;
+
+	if (dun->cent_n < 2) return;
+
+	/* Start the tree with the first room */
+	for (i = 0; i < dun->cent_n; i++)
 	{
-		/* Get the grid */
-		y = dun->wall[i].y;
-		x = dun->wall[i].x;
+		joined[i] = FALSE;
+		near[i] = 0;
+		tunnels[i] = 0;
+		dist[i] = distance(dun->cent[i].y, dun->cent[i].x,
+		                   dun->cent[0].y, dun->cent[0].x);
+	}
+	joined[0] = TRUE;
 
-		/* Convert to floor grid */
-		cave_set_feat(y, x, FEAT_FLOOR);
+	/* Add the rest, nearest first */
+	for (k = 1; k < dun->cent_n; k++)
+	{
+		int best = -1;
 
-		/* Occasional doorway */
-		if (randint0(100) < DUN_TUN_PEN)
+		for (i = 0; i < dun->cent_n; i++)
+			if (!joined[i] && ((best < 0) || (dist[i] < dist[best])))
+				best = i;
+
+		join_rooms(dun, best, near[best]);
+		joined[best] = TRUE;
+		tunnels[best]++;
+		tunnels[near[best]]++;
+
+		for (i = 0; i < dun->cent_n; i++)
 		{
-			/* Place a random door */
-			place_random_door(y, x);
+			int d;
+
+			if (joined[i]) continue;
+
+			d = distance(dun->cent[i].y, dun->cent[i].x,
+			             dun->cent[best].y, dun->cent[best].x);
+			if (d < dist[i])
+			{
+				dist[i] = d;
+				near[i] = best;
+			}
 		}
 	}
+
+	/* A few more tunnels */
+	for (i = 0; i < dun->cent_n; i++)
+	{
+		if ((tunnels[i] > 1) && (randint0(100) >= DUN_TUN_LOOP)) continue;
+
+		j = randint0(dun->cent_n - 1);
+		if (j >= i) j++;
+		join_rooms(dun, i, j);
+	}
 }
 
 
@@ -2787,10 +3231,10 @@ static int next_to_corr(int y1, int x1)
 		if (!cave_floor_bold(y, x)) continue;
 
 		/* Skip non "empty floor" grids */
-		if (cave_feat[y][x] != FEAT_FLOOR) continue;
+		if (cave->grid[y][x].feat != FEAT_FLOOR) continue;
 
 		/* Skip grids inside rooms */
-		if (cave_info[y][x] & (CAVE_ROOM)) continue;
+		if (cave->grid[y][x].info & (CAVE_ROOM)) continue;
 
 		/* Count these grids */
 		k++;
@@ -2813,15 +3257,15 @@ static bool possible_doorway(int y, int x)
 	if (next_to_corr(y, x) >= 2)
 	{
 		/* Check Vertical */
-		if ((cave_feat[y-1][x] >= FEAT_MAGMA) &&
-		    (cave_feat[y+1][x] >= FEAT_MAGMA))
+		if ((cave->grid[y-1][x].feat >= FEAT_MAGMA) &&
+		    (cave->grid[y+1][x].feat >= FEAT_MAGMA))
 		{
 			return (TRUE);
 		}
 
 		/* Check Horizontal */
-		if ((cave_feat[y][x-1] >= FEAT_MAGMA) &&
-		    (cave_feat[y][x+1] >= FEAT_MAGMA))
+		if ((cave->grid[y][x-1].feat >= FEAT_MAGMA) &&
+		    (cave->grid[y][x+1].feat >= FEAT_MAGMA))
 		{
 			return (TRUE);
 		}
@@ -2841,10 +3285,10 @@ static void try_door(int y, int x)
 	if (!in_bounds(y, x)) return;
 
 	/* Ignore walls */
-	if (cave_feat[y][x] >= FEAT_MAGMA) return;
+	if (cave->grid[y][x].feat >= FEAT_MAGMA) return;
 
 	/* Ignore room grids */
-	if (cave_info[y][x] & (CAVE_ROOM)) return;
+	if (cave->grid[y][x].info & (CAVE_ROOM)) return;
 
 	/* Occasional door (if allowed) */
 	if ((randint0(100) < DUN_TUN_JCT) && possible_doorway(y, x))
@@ -2857,18 +3301,93 @@ static void try_door(int y, int x)
 
 
 
+/*
+ * The bits for blocks "bx1" to "bx2" of a row of "room_map"
+ */
+#define BLOCK_MASK(BX1, BX2) \
+	((((u32b)1 << ((BX2) - (BX1) + 1)) - 1) << (BX1))
+
+
+/*
+ * Count the blocks set in a row of blocks
+ */
+static int blocks_count(u32b w)
+{
+#ifdef __GNUC__
+	return __builtin_popcount(w);
+#else
+	int n = 0;
+
+	for (; w; w &= w - 1) n++;
+
+	return (n);
+#endif
+}
+
+
+/*
+ * Find the "k"th block (from zero) set in a row of blocks, which must have
+ * more than "k" set
+ */
+static int blocks_nth(u32b w, int k)
+{
+	/* Drop the lowest blocks */
+	while (k--) w &= w - 1;
+
+#ifdef __GNUC__
+	return __builtin_ctz(w);
+#else
+	{
+		int bx = 0;
+
+		while (!(w & 1))
+		{
+			w >>= 1;
+			bx++;
+		}
+
+		return (bx);
+	}
+#endif
+}
+
+
+/*
+ * Check that no room has used any of the blocks from (by1, bx1) to
+ * (by2, bx2), a row of blocks at a time
+ */
+static bool room_blocks_free(const dun_data *dun, int by1, int bx1, int by2,
+                             int bx2)
+{
+	u32b mask = BLOCK_MASK(bx1, bx2);
+	int by;
+
+	for (by = by1; by <= by2; by++)
+		if (dun->room_map[by] & mask) return (FALSE);
+
+	return (TRUE);
+}
+
+
 /*
  * Attempt to build a room of the given type at the given block
  *
  * Note that we restrict the number of "crowded" rooms to reduce
  * the chance of overflowing the monster list during level creation.
  */
-static bool room_build(int by0, int bx0, int typ)
+static bool room_build(dun_data *dun, int by0, int bx0, int typ)
 {
 	int y, x;
-	int by, bx;
+	int by;
 	int by1, bx1, by2, bx2;
 
+	u32b mask;
+
+	clock_t start;
+
+
+	/* Profile the attempt */
+	if ((typ > 0) && (typ < ROOM_MAX)) gen_profile.room_tries[typ]++;
 
 	/* Restrict level */
 	if (p_ptr->depth < room[typ].level) return (FALSE);
@@ -2887,13 +3406,7 @@ static bool room_build(int by0, int bx0, int typ)
 	if ((bx1 < 0) || (bx2 >= dun->col_rooms)) return (FALSE);
 
 	/* Verify open space */
-	for (by = by1; by <= by2; by++)
-	{
-		for (bx = bx1; bx <= bx2; bx++)
-		{
-			if (dun->room_map[by][bx]) return (FALSE);
-		}
-	}
+	if (!room_blocks_free(dun, by1, bx1, by2, bx2)) return (FALSE);
 
 	/* It is *extremely* important that the following calculation */
 	/* be *exactly* correct to prevent memory errors XXX XXX XXX */
@@ -2902,6 +3415,9 @@ static bool room_build(int by0, int bx0, int typ)
 	y = ((by1 + by2 + 1) * BLOCK_HGT) / 2;
 	x = ((bx1 + bx2 + 1) * BLOCK_WID) / 2;
 
+	/* Time the room */
+	start = clock();
+
 	/* Build a room */
 	switch (typ)
 	{
@@ -2920,6 +3436,9 @@ static bool room_build(int by0, int bx0, int typ)
 		default: return (FALSE);
 	}
 
+	gen_profile.room_built[typ]++;
+	gen_profile.room_time[typ] += clock() - start;
+
 	/* Save the room location */
 	if (dun->cent_n < CENT_MAX)
 	{
@@ -2929,12 +3448,10 @@ static bool room_build(int by0, int bx0, int typ)
 	}
 
 	/* Reserve some blocks */
+	mask = BLOCK_MASK(bx1, bx2);
 	for (by = by1; by <= by2; by++)
 	{
-		for (bx = bx1; bx <= bx2; bx++)
-		{
-			dun->room_map[by][bx] = TRUE;
-		}
+		dun->room_map[by] |= mask;
 	}
 
 	/* Count "crowded" rooms */
@@ -2946,19 +3463,18 @@ static bool room_build(int by0, int bx0, int typ)
 
 
 /*
- * Generate a new dungeon level
- *
- * Note that "dun_body" adds about 4000 bytes of memory to the stack.
+ * Generate a new dungeon level, using the generation data "dun"
  */
-static void cave_gen(void)
+static void cave_gen(dun_data *dun)
 {
 	int i, j, k, l, y, x, y1, x1;
 	int by, bx;
 	int num_rooms, size_percent;
 
-	bool blocks_tried[MAX_ROOMS_ROW][MAX_ROOMS_COL];
+	/* Blocks not yet tried for a room, one bit per block as in room_map */
+	u32b untried[MAX_ROOMS_ROW];
 
-	dun_data dun_body;
+	clock_t start = clock();
 
 	/* Possibly generate fewer rooms in a smaller area via a scaling factor.
 	 * Since we scale row_rooms and col_rooms by the same amount, DUN_ROOMS
@@ -2977,15 +3493,12 @@ static void cave_gen(void)
 
 	/* scale the various generation variables */
 	num_rooms = DUN_ROOMS * size_percent / 100;
-	level_hgt = DUNGEON_HGT * size_percent / 100;
-	level_wid  = DUNGEON_WID * size_percent / 100;
-
-	/* Global data */
-	dun = &dun_body;
+	level_hgt = cave->height * size_percent / 100;
+	level_wid  = cave->width * size_percent / 100;
 
 	/* Hack -- Start with basic granite */
-	for (y = 0; y < DUNGEON_HGT; y++)
-		for (x = 0; x < DUNGEON_WID; x++)
+	for (y = 0; y < cave->height; y++)
+		for (x = 0; x < cave->width; x++)
 			cave_set_feat(y, x, FEAT_WALL_EXTRA);
 
 	/* Actual maximum number of rooms on this level */
@@ -2994,8 +3507,10 @@ static void cave_gen(void)
 
 	/* Initialize the room table */
 	for (by = 0; by < dun->row_rooms; by++)
-		for (bx = 0; bx < dun->col_rooms; bx++)
-			dun->room_map[by][bx] = blocks_tried[by][bx]  = FALSE;
+		untried[by] = BLOCK_MASK(0, dun->col_rooms - 1);
+
+	/* No blocks are used yet */
+	C_WIPE(dun->room_map, MAX_ROOMS_ROW, u32b);
 
 	/* No "crowded" rooms yet */
 	dun->crowded = FALSE;
@@ -3012,29 +3527,19 @@ static void cave_gen(void)
 
 		/* Pick a block for the room; j counts blocks we haven't tried */
 		j = 0;
-		for(by=0; by < dun->row_rooms; by++)
-			for(bx=0; bx < dun->col_rooms; bx++)
-				if (!blocks_tried[by][bx]) j++;
+		for (by = 0; by < dun->row_rooms; by++)
+			j += blocks_count(untried[by]);
 
 		/* If we've tried all blocks we're done */
 		if (j == 0) break;
 
 		/* OK, choose one of the j blocks we haven't tried. Then figure out */
-		/* which one that actually was */
+		/* which one that actually was, a row at a time */
 		k = randint0(j);
-		l = 0;
-		for(by=0; by < dun->row_rooms; by++)
-		{
-			for(bx=0; bx < dun->col_rooms; bx++)
-			{
-				if (blocks_tried[by][bx]) continue;
-				if (l == k) break;
-				l++;
-			}
-			if (l == k) break;
-		}
-		
-		blocks_tried[by][bx] = TRUE;
+		for (by = 0; k >= (l = blocks_count(untried[by])); by++) k -= l;
+		bx = blocks_nth(untried[by], k);
+
+		untried[by] &= ~BLOCK_MASK(bx, bx);
 
 		/* Move GV vault creation to the beginning */
 		/* There are two problems with GV creation, overlapping other rooms, 
@@ -3070,7 +3575,7 @@ static void cave_gen(void)
 			}
 
 			/* Attempt to pass the depth check and build a GV */
-			if (randint0(denominator) < numerator && room_build(by, bx, 9))
+			if (randint0(denominator) < numerator && room_build(dun, by, bx, 9))
 				continue;
 		}
 
@@ -3084,46 +3589,48 @@ static void cave_gen(void)
 			if (randint0(DUN_UNUSUAL) < p_ptr->depth)
 			{
 				/* Type 8 -- Medium vault (10%) */
-				if ((k < 10) && room_build(by, bx, 8)) continue;
+				if ((k < 10) && room_build(dun, by, bx, 8)) continue;
 
 				/* Type 7 -- Lesser vault (15%) */
-				if ((k < 25) && room_build(by, bx, 7)) continue;
+				if ((k < 25) && room_build(dun, by, bx, 7)) continue;
 
 				/* Type 6 -- Monster pit (15%) */
-				if ((k < 40) && room_build(by, bx, 6)) continue;
+				if ((k < 40) && room_build(dun, by, bx, 6)) continue;
 
 				/* Type 5 -- Monster nest (10%) */
-				if ((k < 50) && room_build(by, bx, 5)) continue;
+				if ((k < 50) && room_build(dun, by, bx, 5)) continue;
 			}
 
 			/* Type 4 -- Large room (25%) */
-			if ((k < 25) && room_build(by, bx, 4)) continue;
+			if ((k < 25) && room_build(dun, by, bx, 4)) continue;
 
 			/* Type 3 -- Cross room (25%) */
-			if ((k < 50) && room_build(by, bx, 3)) continue;
+			if ((k < 50) && room_build(dun, by, bx, 3)) continue;
 
 			/* Type 2 -- Overlapping (50%) */
-			if ((k < 100) && room_build(by, bx, 2)) continue;
+			if ((k < 100) && room_build(dun, by, bx, 2)) continue;
 		}
 
 		/* Attempt a trivial room */
-		if (room_build(by, bx, 1)) continue;
+		if (room_build(dun, by, bx, 1)) continue;
 	}
 
+	gen_profile_phase(GEN_PHASE_ROOMS, &start);
+
 	/* Special boundary walls -- Bottom */
-	for (x = 0; x < DUNGEON_WID; x++)
+	for (x = 0; x < cave->width; x++)
 	{
 		/* Clear previous contents, add "solid" perma-wall */
 		cave_set_feat(0, x, FEAT_PERM_SOLID);
-		cave_set_feat(DUNGEON_HGT - 1, x, FEAT_PERM_SOLID);
+		cave_set_feat(cave->height - 1, x, FEAT_PERM_SOLID);
 	}
 
 	/* Special boundary walls -- Left */
-	for (y = 0; y < DUNGEON_HGT; y++)
+	for (y = 0; y < cave->height; y++)
 	{
 		/* Clear previous contents, add "solid" perma-wall */
 		cave_set_feat(y, 0, FEAT_PERM_SOLID);
-		cave_set_feat(y, DUNGEON_WID - 1, FEAT_PERM_SOLID);
+		cave_set_feat(y, cave->width - 1, FEAT_PERM_SOLID);
 	}
 
 	/* Hack -- Scramble the room order */
@@ -3142,20 +3649,8 @@ static void cave_gen(void)
 	/* Start with no tunnel doors */
 	dun->door_n = 0;
 
-	/* Hack -- connect the first room to the last room */
-	y = dun->cent[dun->cent_n-1].y;
-	x = dun->cent[dun->cent_n-1].x;
-
 	/* Connect all the rooms together */
-	for (i = 0; i < dun->cent_n; i++)
-	{
-		/* Connect the room to the previous room */
-		build_tunnel(dun->cent[i].y, dun->cent[i].x, y, x);
-
-		/* Remember the "previous" room */
-		y = dun->cent[i].y;
-		x = dun->cent[i].x;
-	}
+	connect_rooms(dun);
 
 	/* Place intersection doors */
 	for (i = 0; i < dun->door_n; i++)
@@ -3172,6 +3667,8 @@ static void cave_gen(void)
 	}
 
 
+	gen_profile_phase(GEN_PHASE_TUNNELS, &start);
+
 	/* Hack -- Add some magma streamers */
 	for (i = 0; i < DUN_STR_MAG; i++)
 	{
@@ -3185,12 +3682,16 @@ static void cave_gen(void)
 	}
 
 
+	gen_profile_phase(GEN_PHASE_STREAMERS, &start);
+
 	/* Place 3 or 4 down stairs near some walls */
 	alloc_stairs(FEAT_MORE, rand_range(3, 4), 3);
 
 	/* Place 1 or 2 up stairs near some walls */
 	alloc_stairs(FEAT_LESS, rand_range(1, 2), 3);
 
+	gen_profile_phase(GEN_PHASE_STAIRS, &start);
+
 
 	/* Basic "amount" */
 	k = (p_ptr->depth / 3);
@@ -3204,7 +3705,9 @@ static void cave_gen(void)
 	alloc_object(ALLOC_SET_BOTH, ALLOC_TYP_TRAP, randint1(k), p_ptr->depth);
 
 	/* Determine the character location */
-	new_player_spot();
+	if (!new_player_spot()) return;
+
+	gen_profile_phase(GEN_PHASE_OBJECTS, &start);
 
 	/* Pick a base number of monsters */
 	i = MIN_M_ALLOC_LEVEL + randint1(8);
@@ -3231,13 +3734,7 @@ static void cave_gen(void)
 				int y, x;
 
 				/* Pick a location */
-				while (1)
-				{
-					y = randint0(level_hgt);
-					x = randint0(level_wid);
-
-					if (cave_naked_bold(y, x)) break;
-				}
+				if (!cave_find(&y, &x, cave_naked_ok)) break;
 
 				/* Place the questor */
 				place_monster_aux(y, x, i, TRUE, TRUE);
@@ -3246,6 +3743,8 @@ static void cave_gen(void)
 	}
 
 
+	gen_profile_phase(GEN_PHASE_MONSTERS, &start);
+
 	/* Put some objects in rooms */
 	alloc_object(ALLOC_SET_ROOM,
 	             ALLOC_TYP_OBJECT, Rand_normal(DUN_AMT_ROOM, 3),
@@ -3258,6 +3757,8 @@ static void cave_gen(void)
 	alloc_object(ALLOC_SET_BOTH,
 	             ALLOC_TYP_GOLD, Rand_normal(DUN_AMT_GOLD, 3),
 	             p_ptr->depth);
+
+	gen_profile_phase(GEN_PHASE_OBJECTS, &start);
 }
 
 
@@ -3426,6 +3927,70 @@ static void town_gen_hack(void)
 
 
 
+/*
+ * The town's layout, as made by town_gen_hack() from seed_town, so that
+ * later trips to town needn't build it again
+ */
+static byte town_feat[TOWN_HGT][TOWN_WID];
+static int town_stair_y, town_stair_x;
+static u32b town_feat_seed;
+static bool town_feat_valid = FALSE;
+
+
+/*
+ * Lay out the town, building it the first time and copying it afterwards,
+ * and place the player on the stairs
+ */
+static void town_layout(void)
+{
+	int y, x;
+
+	/* Copy the layout we made before */
+	if (town_feat_valid && (town_feat_seed == seed_town))
+	{
+		for (y = 0; y < TOWN_HGT; y++)
+			for (x = 0; x < TOWN_WID; x++)
+				cave_set_feat(y, x, town_feat[y][x]);
+
+		player_place(town_stair_y, town_stair_x);
+		return;
+	}
+
+	/* Start with solid walls */
+	for (y = 0; y < cave->height; y++)
+	{
+		for (x = 0; x < cave->width; x++)
+		{
+			/* Create "solid" perma-wall */
+			cave_set_feat(y, x, FEAT_PERM_SOLID);
+		}
+	}
+
+	/* Then place some floors */
+	for (y = 1; y < TOWN_HGT - 1; y++)
+	{
+		for (x = 1; x < TOWN_WID - 1; x++)
+		{
+			/* Create empty floor */
+			cave_set_feat(y, x, FEAT_FLOOR);
+		}
+	}
+
+	/* Build stuff */
+	town_gen_hack();
+
+	/* Remember it all */
+	for (y = 0; y < TOWN_HGT; y++)
+		for (x = 0; x < TOWN_WID; x++)
+			town_feat[y][x] = cave->grid[y][x].feat;
+
+	town_stair_y = p_ptr->py;
+	town_stair_x = p_ptr->px;
+	town_feat_seed = seed_town;
+	town_feat_valid = TRUE;
+}
+
+
 /*
  * Town logic flow for generation of new town
  *
@@ -3444,7 +4009,7 @@ static void town_gen_hack(void)
  */
 static void town_gen(void)
 {
-	int i, y, x;
+	int i;
 	int residents;
 	bool daytime;
 
@@ -3469,28 +4034,8 @@ static void town_gen(void)
 		residents = MIN_M_ALLOC_TN;
 	}
 
-	/* Start with solid walls */
-	for (y = 0; y < DUNGEON_HGT; y++)
-	{
-		for (x = 0; x < DUNGEON_WID; x++)
-		{
-			/* Create "solid" perma-wall */
-			cave_set_feat(y, x, FEAT_PERM_SOLID);
-		}
-	}
-
-	/* Then place some floors */
-	for (y = 1; y < TOWN_HGT - 1; y++)
-	{
-		for (x = 1; x < TOWN_WID - 1; x++)
-		{
-			/* Create empty floor */
-			cave_set_feat(y, x, FEAT_FLOOR);
-		}
-	}
-
-	/* Build stuff */
-	town_gen_hack();
+	/* Build stuff (or copy what we built last time) */
+	town_layout();
 
 	/* Apply illumination */
 	town_illuminate(daytime);
@@ -3508,36 +4053,50 @@ static void town_gen(void)
 
 
 /*
- * Clear the dungeon, ready for generation to begin.
+ * Clear the dungeon, ready for generation (or a kept level) to begin.
  */
-static void clear_cave(void)
+void clear_cave(void)
 {
 	int x, y;
 
 	wipe_o_list();
 	wipe_mon_list();
 
-	/* Clear flags and flow information. */
-	for (y = 0; y < DUNGEON_HGT; y++)
+	/* Size the new level */
+	if (!p_ptr->depth)
 	{
-		for (x = 0; x < DUNGEON_WID; x++)
+		cave->height = TOWN_HGT;
+		cave->width = TOWN_WID;
+	}
+	else
+	{
+		cave->height = MIN(MAX(dungeon_want_hgt, TOWN_HGT), DUNGEON_HGT);
+		cave->width = MIN(MAX(dungeon_want_wid, TOWN_WID), DUNGEON_WID);
+	}
+
+	/* Clear features and flags. */
+	for (y = 0; y < cave->height; y++)
+	{
+		for (x = 0; x < cave->width; x++)
 		{
 			/* No features */
-			cave_feat[y][x] = 0;
+			cave->grid[y][x].feat = 0;
 
 			/* No flags */
-			cave_info[y][x] = 0;
-			cave_info2[y][x] = 0;
-
-			/* No flow */
-			cave_cost[y][x] = 0;
-			cave_when[y][x] = 0;
+			cave->grid[y][x].info = 0;
+			cave->grid[y][x].info2 = 0;
 
 			/* Clear any left-over monsters (should be none) and the player. */
-			cave_m_idx[y][x] = 0;
+			cave->grid[y][x].m_idx = 0;
 		}
 	}
 
+	/* Nothing in view */
+	forget_view();
+
+	/* No flow */
+	forget_flow();
+
 	/* Mega-Hack -- no player in dungeon yet */
 	p_ptr->px = p_ptr->py = 0;
 
@@ -3551,6 +4110,7 @@ static void clear_cave(void)
 
 	/* Nothing good here yet */
 	rating = 0;
+	WIPE(&level_tally, struct level_tally);
 }
 
 
@@ -3610,13 +4170,72 @@ static int calculate_feeling(int rating, int depth)
  *
  * Hack -- allow auto-scumming via a gameplay option.
  *
- * Note that this function resets "cave_feat" and "cave_info" directly.
+ * Note that this function resets the "feat" and "info" of every grid directly.
+ */
+/*
+ * Derive the seed for a new level from the dungeon seed, the depth and the
+ * game turn.  A serial number keeps levels made on the same turn (by the
+ * stats collector, say) apart.
+ */
+static u32b level_seed(void)
+{
+	static u32b serial = 0;
+
+	u32b seed = seed_dungeon;
+
+	seed ^= (u32b)(p_ptr->depth + 1) * 0x9E3779B9UL;
+	seed ^= (u32b)turn * 0x85EBCA6BUL;
+	seed ^= ++serial * 0xC2B2AE35UL;
+
+	/* Mix the bits */
+	seed ^= seed >> 16;
+	seed *= 0x7FEB352DUL;
+	seed ^= seed >> 15;
+	seed *= 0x846CA68BUL;
+	seed ^= seed >> 16;
+
+	return (seed);
+}
+
+
+/*
+ * Generate a random dungeon level with a new seed
  */
 void generate_cave(void)
+{
+	generate_cave_seed(level_seed());
+}
+
+
+/*
+ * Generate the dungeon level that "seed" gives at the current depth.
+ *
+ * The complex RNG is seeded with "seed" for the whole of generation, with
+ * restarts carrying on from where the failed attempt left it, and put back
+ * as it was afterwards; so the same seed, depth and game state always give
+ * the same level, and the game itself plays on as if nothing had happened.
+ */
+void generate_cave_seed(u32b seed)
 {
 	const char *error = "no generation";
 	int counter = 0;
 
+	/* Note that this adds about 4000 bytes of memory to the stack */
+	dun_data dun_body;
+
+	u32b old_state[RAND_DEG];
+	u32b old_i = state_i;
+	bool old_quick = Rand_quick;
+
+	/* Seed the level */
+	memcpy(old_state, STATE, sizeof(old_state));
+	Rand_quick = FALSE;
+	Rand_state_init(seed);
+	seed_level = seed;
+
+	if (OPT(cheat_room))
+		msg_format("Level seed %08lx.", (unsigned long)seed);
+
 	/* Generate */
 	while (error)
 	{
@@ -3633,25 +4252,33 @@ void generate_cave(void)
 		if (!p_ptr->depth)
 			town_gen();
 		else
-			cave_gen();
+			cave_gen(&dun_body);
+
 
+		/* Note what the level is like */
+		level_tally.rating = rating;
+		level_tally.feeling = calculate_feeling(rating, p_ptr->depth);
 
 		/* It takes 1000 game turns for "feelings" to recharge */
 		if (((turn - old_turn) < 1000) && (old_turn > 1))
 			feeling = 0;
 		else
-			feeling = calculate_feeling(rating, p_ptr->depth);
+			feeling = level_tally.feeling;
 
 		/* Hack -- regenerate "over-flow" levels */
 		if (o_max >= z_info->o_max)
 			error = "too many objects";
 		if (mon_max >= z_info->m_max)
 			error = "too many monsters";
+		if (!p_ptr->py)
+			error = "nowhere to start";
 
 
 		if (OPT(cheat_room) && error)
 			msg_format("Generation restarted: %s.", error);
 
+		if (error) gen_profile.restarts++;
+
 		counter++;
 		if (counter > 100)
 		{
@@ -3660,9 +4287,307 @@ void generate_cave(void)
 		}
 	}
 
+	/* Back to the game's own random numbers */
+	memcpy(STATE, old_state, sizeof(old_state));
+	state_i = old_i;
+	Rand_quick = old_quick;
+
 	/* The dungeon is ready */
 	character_dungeon = TRUE;
+	gen_profile.levels++;
 
 	/* Remember when the last dungeon level was created */
 	if (p_ptr->depth > 0) old_turn = turn;
 }
+
+
+/*
+ * Names of the room types, for the generation profile
+ */
+static const char *room_names[ROOM_MAX] =
+{
+	NULL,
+	"simple",
+	"overlapping",
+	"crossed",
+	"large",
+	"nest",
+	"pit",
+	"lesser vault",
+	"medium vault",
+	"greater vault"
+};
+
+/*
+ * Names of the phases of "cave_gen()", for the generation profile
+ */
+static const char *phase_names[GEN_PHASE_MAX] =
+{
+	"rooms",
+	"tunnels",
+	"streamers",
+	"stairs",
+	"monsters",
+	"objects"
+};
+
+
+/*
+ * Forget the generation profile
+ */
+void gen_profile_reset(void)
+{
+	WIPE(&gen_profile, struct gen_profile);
+}
+
+
+/*
+ * Convert a profile time to milliseconds
+ */
+double gen_profile_msec(clock_t t)
+{
+	return (1000.0 * t / CLOCKS_PER_SEC);
+}
+
+
+/*
+ * Describe the generation profile: the time spent in each phase of
+ * "cave_gen()" and the attempts at each type of room, per level generated
+ */
+void gen_profile_describe(textblock *tb)
+{
+	int i;
+	double levels = MAX(gen_profile.levels, 1);
+
+	textblock_append(tb, "%lu levels generated, %lu attempts thrown away.\n",
+	                 (unsigned long)gen_profile.levels,
+	                 (unsigned long)gen_profile.restarts);
+	textblock_append(tb, "%lu tunnels, %lu finished by a plan, %lu unfinished.\n",
+	                 (unsigned long)gen_profile.tunnels,
+	                 (unsigned long)gen_profile.tunnels_planned,
+	                 (unsigned long)gen_profile.tunnels_failed);
+	textblock_append(tb, "This level's seed is %08lx.\n\n",
+	                 (unsigned long)seed_level);
+
+	textblock_append(tb, "%-16s %10s\n", "Phase", "ms/level");
+	for (i = 0; i < GEN_PHASE_MAX; i++)
+		textblock_append(tb, "%-16s %10.3f\n", phase_names[i],
+		                 gen_profile_msec(gen_profile.phase[i]) / levels);
+
+	textblock_append(tb, "\n%-16s %10s %10s %10s\n", "Room type",
+	                 "tries", "built", "ms/level");
+	for (i = 1; i < ROOM_MAX; i++)
+		textblock_append(tb, "%-16s %10lu %10lu %10.3f\n", room_names[i],
+		                 (unsigned long)gen_profile.room_tries[i],
+		                 (unsigned long)gen_profile.room_built[i],
+		                 gen_profile_msec(gen_profile.room_time[i]) / levels);
+}
+
+
+/*
+ * Checksum the terrain of the current level
+ */
+static u32b gen_checksum(void)
+{
+	u32b sum = 0;
+	int y, x;
+
+	for (y = 0; y < cave->height; y++)
+		for (x = 0; x < cave->width; x++)
+			sum = (sum * 31) + cave->grid[y][x].feat;
+
+	return (sum);
+}
+
+
+/*
+ * Generate the level "seed" gives at "depth" "count" times, and print the
+ * generation profile, so that a slow level can be timed and profiled on
+ * its own.  The levels are checksummed to show that they really are the
+ * same each time.
+ */
+void gen_benchmark(u32b seed, int depth, int count)
+{
+	textblock *tb = textblock_new();
+	u32b sum = 0;
+	bool same = TRUE;
+	int i;
+
+	p_ptr->depth = depth;
+	gen_profile_reset();
+
+	for (i = 0; i < count; i++)
+	{
+		generate_cave_seed(seed);
+
+		if (!i) sum = gen_checksum();
+		else if (gen_checksum() != sum) same = FALSE;
+	}
+
+	printf("Level seed %08lx at depth %d, %d times: checksum %08lx%s\n",
+	       (unsigned long)seed, depth, count, (unsigned long)sum,
+	       same ? "" : " (levels differed!)");
+
+	gen_profile_describe(tb);
+	printf("%s", textblock_text(tb));
+	textblock_free(tb);
+}
+
+
+/*
+ * Read the rates and checksums of a gen_benchmark_depths() run written to
+ * file "path", for depths up to MAX_DEPTH - 1 and (as depth MAX_DEPTH) all
+ * of them together; depths not in the file get a rate of 0.
+ */
+static void gen_baseline_read(const char *path, double rate[MAX_DEPTH + 1],
+		u32b sum[MAX_DEPTH + 1])
+{
+	ang_file *f = file_open(path, MODE_READ, -1);
+	char buf[80];
+
+	if (!f)
+	{
+		printf("Couldn't read the baseline %s.\n", path);
+		return;
+	}
+
+	while (file_getl(f, buf, sizeof(buf)))
+	{
+		int depth;
+		double r;
+		unsigned long s;
+
+		if (sscanf(buf, "depth %d %lf %lx", &depth, &r, &s) == 3)
+		{
+			if ((depth < 1) || (depth >= MAX_DEPTH)) continue;
+		}
+		else if (sscanf(buf, "all %lf %lx", &r, &s) == 2)
+			depth = MAX_DEPTH;
+		else
+			continue;
+
+		rate[depth] = r;
+		sum[depth] = (u32b)s;
+	}
+
+	file_close(f);
+}
+
+/*
+ * Print one line of gen_benchmark_depths(): the levels per second, the
+ * attempts thrown away and the time in each phase per level, and how the
+ * rate compares to the baseline "base_rate" (if there is one), noting if
+ * the levels weren't the ones the baseline made
+ */
+static void gen_benchmark_line(const char *label, u32b levels, clock_t t,
+		u32b sum, double base_rate, u32b base_sum)
+{
+	double secs = (double)t / CLOCKS_PER_SEC;
+	double rate = (secs > 0) ? levels / secs : 0.0;
+	int i;
+
+	printf("%-6s %9.1f %8lu", label, rate, (unsigned long)gen_profile.restarts);
+	for (i = 0; i < GEN_PHASE_MAX; i++)
+		printf(" %9.3f", gen_profile_msec(gen_profile.phase[i]) /
+		       MAX(levels, 1));
+	printf("  %08lx", (unsigned long)sum);
+
+	if (base_rate > 0)
+		printf("  %5.2fx%s", rate / base_rate,
+		       (sum == base_sum) ? "" : " (other levels)");
+
+	printf("\n");
+}
+
+/*
+ * Generate "count" levels at each depth from "min_depth" to "max_depth",
+ * with level seeds drawn from master seed "seed", and print for each depth
+ * and for them all how many levels were made each second, the attempts
+ * thrown away and the time spent in each phase of generation.
+ *
+ * If "save" names a file, the rate and a checksum of the levels at each
+ * depth are written to it, and if "baseline" names a file written that way
+ * the rates are compared against it.  Each depth draws its seeds from its
+ * own stream, so a run over some of the depths makes the same levels at
+ * them as one over all of them.
+ */
+void gen_benchmark_depths(u32b seed, int min_depth, int max_depth, int count,
+		const char *save, const char *baseline)
+{
+	static double base_rate[MAX_DEPTH + 1];
+	static u32b base_sum[MAX_DEPTH + 1];
+
+	struct gen_profile all;
+	ang_file *save_file = NULL;
+	clock_t all_time = 0;
+	u32b all_sum = 0;
+	int depth, i;
+
+	if (baseline && baseline[0])
+		gen_baseline_read(baseline, base_rate, base_sum);
+
+	if (save && save[0])
+	{
+		save_file = file_open(save, MODE_WRITE, FTYPE_TEXT);
+		if (!save_file) printf("Couldn't write %s.\n", save);
+	}
+
+	printf("Master seed %08lx, %d levels at each depth from %d to %d\n\n",
+	       (unsigned long)seed, count, min_depth, max_depth);
+	printf("%-6s %9s %8s", "Depth", "levels/s", "restarts");
+	for (i = 0; i < GEN_PHASE_MAX; i++)
+		printf(" %9s", phase_names[i]);
+	printf("  %-8s\n", "checksum");
+
+	WIPE(&all, struct gen_profile);
+
+	for (depth = min_depth; depth <= max_depth; depth++)
+	{
+		rand_stream rs;
+		char label[8];
+		clock_t start, t;
+		u32b sum = 0;
+
+		p_ptr->depth = depth;
+		gen_profile_reset();
+		Rand_stream_init(&rs, seed ^ (depth * 0x9E3779B9U));
+
+		start = clock();
+		for (i = 0; i < count; i++)
+		{
+			generate_cave_seed(Rand_stream_next(&rs));
+			sum = (sum * 31) + gen_checksum();
+		}
+		t = clock() - start;
+
+		strnfmt(label, sizeof(label), "%d", depth);
+		gen_benchmark_line(label, count, t, sum, base_rate[depth],
+		                   base_sum[depth]);
+
+		if (save_file)
+			file_putf(save_file, "depth %d %.1f %08lx\n", depth,
+			          (t > 0) ? count * (double)CLOCKS_PER_SEC / t : 0.0,
+			          (unsigned long)sum);
+
+		/* Add it to the whole */
+		all_time += t;
+		all_sum = (all_sum * 31) + sum;
+		all.restarts += gen_profile.restarts;
+		for (i = 0; i < GEN_PHASE_MAX; i++)
+			all.phase[i] += gen_profile.phase[i];
+	}
+
+	gen_profile = all;
+	printf("\n");
+	gen_benchmark_line("All", count * (max_depth - min_depth + 1), all_time,
+	                   all_sum, base_rate[MAX_DEPTH], base_sum[MAX_DEPTH]);
+
+	if (save_file)
+	{
+		file_putf(save_file, "all %.1f %08lx\n", (all_time > 0) ?
+		          count * (max_depth - min_depth + 1) *
+		          (double)CLOCKS_PER_SEC / all_time : 0.0,
+		          (unsigned long)all_sum);
+		file_close(save_file);
+	}
+}
@@ -3,6 +3,67 @@
 #ifndef GENERATE_H
 #define GENERATE_H
 
+#include "z-textblock.h"
+
+/*
+ * Maximum number of room types
+ */
+#define ROOM_MAX	10
+
+/*
+ * Phases of "cave_gen()" timed by the generation profile
+ */
+enum
+{
+	GEN_PHASE_ROOMS = 0,
+	GEN_PHASE_TUNNELS,
+	GEN_PHASE_STREAMERS,
+	GEN_PHASE_STAIRS,
+	GEN_PHASE_MONSTERS,
+	GEN_PHASE_OBJECTS,
+
+	GEN_PHASE_MAX
+};
+
+/*
+ * Where level generation has spent its time since "gen_profile_reset()"
+ */
+struct gen_profile
+{
+	u32b levels;			/* Levels generated */
+	u32b restarts;			/* Attempts thrown away */
+	u32b tunnels;			/* Tunnels between rooms */
+	u32b tunnels_planned;		/* ... which wandered, and were planned */
+	u32b tunnels_failed;		/* ... which couldn't be planned either */
+
+	clock_t phase[GEN_PHASE_MAX];	/* Time spent in each phase */
+
+	u32b room_tries[ROOM_MAX];	/* Calls to room_build() for each type */
+	u32b room_built[ROOM_MAX];	/* ... which built the room */
+	clock_t room_time[ROOM_MAX];	/* Time spent building each type */
+};
+
+/*
+ * What went into the current level, added up as it was made so that nothing
+ * needs to look through the level for it afterwards
+ */
+struct level_tally
+{
+	u32b objects;			/* Objects put on the floor, not counting gold */
+	u32b gold;				/* Gold put on the floor */
+	u16b ood;				/* Out of depth objects among them */
+	u16b vaults;			/* Vaults built */
+	u16b pits;				/* Monster nests and pits built */
+	s16b rating;			/* The level rating */
+	byte feeling;			/* Its feeling, however soon after the last */
+};
+
+extern struct gen_profile gen_profile;
+extern struct level_tally level_tally;
+extern u32b seed_level;
+
+extern int dungeon_want_hgt;
+extern int dungeon_want_wid;
 extern int level_hgt;
 extern int level_wid;
 void place_object(int y, int x, int level, bool good, bool great);
@@ -10,6 +71,14 @@ void place_gold(int y, int x, int level);
 void place_secret_door(int y, int x);
 void place_closed_door(int y, int x);
 void place_random_door(int y, int x);
+extern void clear_cave(void);
 extern void generate_cave(void);
+extern void generate_cave_seed(u32b seed);
+extern void gen_profile_reset(void);
+extern double gen_profile_msec(clock_t t);
+extern void gen_profile_describe(textblock *tb);
+extern void gen_benchmark(u32b seed, int depth, int count);
+extern void gen_benchmark_depths(u32b seed, int min_depth, int max_depth,
+		int count, const char *save, const char *baseline);
 
 #endif /* !GENERATE_H */
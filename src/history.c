@@ -21,7 +21,7 @@
 
 /*
  * Number of slots available at birth in the player history list.  Defaults to
- * 10 and will expand automatically as new history entries are added, up the
+ * 10 and will double automatically as new history entries are added, up to
  * the maximum defined value.
  */
 #define HISTORY_BIRTH_SIZE  10
@@ -39,11 +39,48 @@ static size_t history_ctr;
 static size_t history_size;
 
 
+/*
+ * What the list holds for each artifact, kept up to date as entries are
+ * added or change type so that the artifact queries don't have to search
+ * the whole list
+ */
+struct history_artifact
+{
+	size_t last;		/* Index of the newest entry, if there are any */
+	u16b entries;		/* Entries for the artifact */
+	u16b known;			/* ... of which are HISTORY_ARTIFACT_KNOWN */
+	u16b active;		/* ... of which are not HISTORY_ARTIFACT_LOST */
+};
+
+static struct history_artifact history_artifacts[256];
+
+
 #define LIMITLOW(a, b) if (a < b) a = b;
 #define LIMITHI(a, b) if (a > b) a = b;
 
 
 
+/*
+ * Add (`dir` = 1) or remove (`dir` = -1) entry `i` from the artifact index.
+ * Entries are "removed" around changes to their type, and then put back.
+ */
+static void history_index(size_t i, int dir)
+{
+	struct history_artifact *art = &history_artifacts[history_list[i].a_idx];
+
+	if (dir > 0 && (!art->entries || i > art->last))
+		art->last = i;
+
+	art->entries += dir;
+
+	if (history_list[i].type & HISTORY_ARTIFACT_KNOWN)
+		art->known += dir;
+
+	if (!(history_list[i].type & HISTORY_ARTIFACT_LOST))
+		art->active += dir;
+}
+
+
 /*
  * Initialise an empty history list.
  */
@@ -65,6 +102,8 @@ void history_clear(void)
 	FREE(history_list);
 	history_ctr = 0;
 	history_size = 0;
+
+	WIPE(history_artifacts, history_artifacts);
 }
 
 
@@ -81,11 +120,8 @@ static bool history_set_num(size_t num)
 	if (num < history_size)  return FALSE;
 	if (num == history_size) return FALSE;
 
-	/* Allocate new memory, copy across */
-	/* XXX Should use mem_realloc() */
-	new_list = C_ZNEW(num, history_info);
-	C_COPY(new_list, history_list, history_ctr, history_info);
-	FREE(history_list);
+	new_list = mem_realloc(history_list, num * sizeof(history_info));
+	C_WIPE(new_list + history_size, num - history_size, history_info);
 
 	history_list = new_list;
 	history_size = num;
@@ -108,18 +144,15 @@ size_t history_get_num(void)
  */
 static bool history_know_artifact(byte a_idx)
 {
-	size_t i = history_ctr;
+	size_t i = history_artifacts[a_idx].last;
 
-	while (i--)
-	{
-		if (history_list[i].a_idx == a_idx)
-		{
-			history_list[i].type = HISTORY_ARTIFACT_KNOWN;
-			return TRUE;
-		}
-	}
+	if (!history_artifacts[a_idx].entries) return FALSE;
 
-	return FALSE;
+	history_index(i, -1);
+	history_list[i].type = HISTORY_ARTIFACT_KNOWN;
+	history_index(i, 1);
+
+	return TRUE;
 }
 
 
@@ -129,15 +162,15 @@ static bool history_know_artifact(byte a_idx)
  */
 bool history_lose_artifact(byte a_idx)
 {
-	size_t i = history_ctr;
+	size_t i = history_artifacts[a_idx].last;
 
-	while (i--)
+	if (history_artifacts[a_idx].entries)
 	{
-		if (history_list[i].a_idx == a_idx)
-		{
-			history_list[i].type |= HISTORY_ARTIFACT_LOST;
-			return TRUE;
-		}
+		history_index(i, -1);
+		history_list[i].type |= HISTORY_ARTIFACT_LOST;
+		history_index(i, 1);
+
+		return TRUE;
 	}
 
 	/* If we lost an artifact that didn't previously have a history, then we missed it */
@@ -161,7 +194,7 @@ bool history_add_full(u16b type, byte a_idx, s16b dlev, s16b clev, s32b turn, co
 		history_init(HISTORY_BIRTH_SIZE);
 
 	/* Expand the history list if appropriate */
-	else if ((history_ctr == history_size) && !history_set_num(history_size + 10))
+	else if ((history_ctr == history_size) && !history_set_num(history_size * 2))
 		return FALSE;
 
 	/* History list exists and is not full.  Add an entry at the current counter location. */
@@ -173,6 +206,7 @@ bool history_add_full(u16b type, byte a_idx, s16b dlev, s16b clev, s32b turn, co
 	my_strcpy(history_list[history_ctr].event,
 	          text, sizeof(history_list[history_ctr].event));
 
+	history_index(history_ctr, 1);
 	history_ctr++;
 
 	return TRUE;
@@ -197,14 +231,7 @@ bool history_add(const char *event, u16b type, byte a_idx)
  */
 bool history_is_artifact_known(byte a_idx)
 {
-	size_t i = history_ctr;
-
-	while (i--)
-	{
-		if (history_list[i].a_idx == a_idx && (history_list[i].type & HISTORY_ARTIFACT_KNOWN))
-			return TRUE;
-	}
-	return FALSE;
+	return (history_artifacts[a_idx].known > 0);
 }
 
 
@@ -216,20 +243,9 @@ bool history_is_artifact_known(byte a_idx)
  */
 static bool history_is_artifact_logged(byte a_idx)
 {
-	size_t i = history_ctr;
-
-	while (i--)
-	{
-		/* Don't count ARTIFACT_LOST entries; then we can handle
-		 * re-finding previously lost artifacts in preserve mode  */
-		if (history_list[i].type & HISTORY_ARTIFACT_LOST)
-			continue;
-
-		if (history_list[i].a_idx == a_idx)
-			return TRUE;
-	}
-
-	return FALSE;
+	/* Don't count ARTIFACT_LOST entries; then we can handle
+	 * re-finding previously lost artifacts in preserve mode  */
+	return (history_artifacts[a_idx].active > 0);
 }
 
 
@@ -294,8 +310,10 @@ void history_unmask_unknown(void)
 	{
 		if (history_list[i].type & HISTORY_ARTIFACT_UNKNOWN)
 		{
+			history_index(i, -1);
 			history_list[i].type &= ~(HISTORY_ARTIFACT_UNKNOWN);
 			history_list[i].type |= HISTORY_ARTIFACT_KNOWN;
+			history_index(i, 1);
 		}
 	}
 }
@@ -442,8 +460,8 @@ void history_display(void)
 }
 
 
-/* Dump character history to a file, which we assume is already open. */
-void dump_history(ang_file *file)
+/* Add the character history to a character dump. */
+void dump_history(textblock *tb)
 {
 	size_t i;
 	char buf[90];
@@ -451,10 +469,10 @@ void dump_history(ang_file *file)
 	/* We use either ascii or system-specific encoding */
  	int encoding = OPT(xchars_to_file) ? SYSTEM_SPECIFIC : ASCII;
 
-        file_putf(file, "============================================================\n");
-        file_putf(file, "                   CHAR.\n");
-        file_putf(file, "|   TURN  | DEPTH |LEVEL| EVENT\n");
-        file_putf(file, "============================================================\n");
+        textblock_append(tb, "============================================================\n");
+        textblock_append(tb, "                   CHAR.\n");
+        textblock_append(tb, "|   TURN  | DEPTH |LEVEL| EVENT\n");
+        textblock_append(tb, "============================================================\n");
 
 	for (i = 0; i < (last_printable_item() + 1); i++)
 	{
@@ -470,8 +488,7 @@ void dump_history(ang_file *file)
                 if (history_list[i].type & HISTORY_ARTIFACT_LOST)
                                 my_strcat(buf, " (LOST)", sizeof(buf));
 
-		x_file_putf(file, encoding, "%s", buf);
-		file_put(file, "\n");
+		x_textblock_append(tb, encoding, "%s\n", buf);
 	}
 
 	return;
@@ -3,6 +3,8 @@
 #ifndef HISTORY_H
 #define HISTORY_H
 
+#include "z-textblock.h"
+
 void history_clear(void);
 size_t history_get_num(void);
 bool history_add_full(u16b type, byte a_idx, s16b dlev, s16b clev, s32b turn, const char *text);
@@ -11,7 +13,7 @@ bool history_add_artifact(byte a_idx, bool known, bool found);
 void history_unmask_unknown(void);
 bool history_lose_artifact(byte a_idx);
 void history_display(void);
-void dump_history(ang_file *file);
+void dump_history(textblock *tb);
 bool history_is_artifact_known(byte a_idx);
 
 extern history_info *history_list;
@@ -35,10 +35,14 @@ extern struct parser *init_parse_hints(void);
 #endif
 
 extern errr parse_file(struct parser *p, const char *filename);
+extern mem_arena *init_strings;
+extern bool init_times;
 
 extern void init_file_paths(const char *config, const char *lib, const char *data);
 extern void create_needed_dirs(void);
 extern bool init_angband(void);
+extern const char *cache_text(const char *text);
+extern bool init_hints(void);
 extern void cleanup_angband(void);
 
 #endif /* INCLUDED_INIT_H */
@@ -25,12 +25,21 @@
 #include "init.h"
 #include "macro.h"
 #include "monster/constants.h"
+#include "monster/monster.h"
 #include "object/tvalsval.h"
 #include "option.h"
 #include "parser.h"
 #include "prefs.h"
 #include "squelch.h"
 
+#ifdef HAVE_PTHREAD_H
+# include <pthread.h>
+#endif
+
+#ifdef SET_UID
+# include <sys/time.h>
+#endif
+
 /*
  * This file is used to initialize various variables and arrays for the
  * Angband game.  Note the use of "fd_read()" and "fd_write()" to bypass
@@ -62,23 +71,6 @@ static void print_error(struct file_parser *fp, struct parser *p) {
 	quit_fmt("Parse error in %s line %d column %d.", fp->name, s.line, s.col);
 }
 
-errr run_parser(struct file_parser *fp) {
-	struct parser *p = fp->init();
-	errr r;
-	if (!p) {
-		return PARSE_ERROR_GENERIC;
-	}
-	r = fp->run(p);
-	if (r) {
-		print_error(fp, p);
-		return r;
-	}
-	r = fp->finish(p);
-	if (r)
-		print_error(fp, p);
-	return r;
-}
-
 static const char *k_info_flags[] = {
 	#define OF(a, b) #a,
 	#include "list-object-flags.h"
@@ -92,16 +84,72 @@ static const char *effect_list[] = {
 	#undef EFFECT
 };
 
-static int lookup_flag(const char **flag_table, const char *flag_name) {
-	int i = FLAG_START;
+/*
+ * Flag names are found through an open-addressed hash of each flag table,
+ * built the first time the table is used.  init_stages_run() builds them all
+ * before starting any parser threads, so that they're only read from then on.
+ */
+#define FLAG_HASH_TABLES	4
 
-	while (flag_table[i] && !streq(flag_table[i], flag_name))
-		i++;
+struct flag_hash {
+	const char **table;
+	size_t size;		/* Number of slots, a power of two */
+	u16b *slot;			/* Index of the name in "table", or zero if empty */
+};
 
-	/* End of table reached without match */
-	if (!flag_table[i]) i = FLAG_END;
+static struct flag_hash flag_hashes[FLAG_HASH_TABLES];
 
-	return i;
+static u32b flag_name_hash(const char *name) {
+	/* FNV-1a */
+	u32b hash = 2166136261UL;
+	while (*name)
+		hash = (hash ^ (unsigned char)*name++) * 16777619UL;
+	return hash;
+}
+
+static struct flag_hash *flag_hash_get(const char **flag_table) {
+	struct flag_hash *h = NULL;
+	size_t i, n;
+
+	for (i = 0; i < FLAG_HASH_TABLES; i++) {
+		if (flag_hashes[i].table == flag_table)
+			return &flag_hashes[i];
+		if (!h && !flag_hashes[i].table)
+			h = &flag_hashes[i];
+	}
+
+	/* Too many tables */
+	assert(h);
+
+	/* Keep the table at most half full */
+	for (n = FLAG_START; flag_table[n]; n++) ;
+	for (h->size = 16; h->size < 2 * n; h->size *= 2) ;
+	h->slot = mem_zalloc(h->size * sizeof(*h->slot));
+	h->table = flag_table;
+
+	for (i = FLAG_START; i < n; i++) {
+		size_t j = flag_name_hash(flag_table[i]) & (h->size - 1);
+
+		/* The first of any duplicate names wins, as for a linear search */
+		while (h->slot[j] && !streq(flag_table[h->slot[j]], flag_table[i]))
+			j = (j + 1) & (h->size - 1);
+		if (!h->slot[j])
+			h->slot[j] = i;
+	}
+
+	return h;
+}
+
+static int lookup_flag(const char **flag_table, const char *flag_name) {
+	struct flag_hash *h = flag_hash_get(flag_table);
+	size_t j = flag_name_hash(flag_name) & (h->size - 1);
+
+	for (; h->slot[j]; j = (j + 1) & (h->size - 1))
+		if (streq(flag_table[h->slot[j]], flag_name))
+			return h->slot[j];
+
+	/* No match */
+	return FLAG_END;
 }
 
 static errr grab_flag(bitflag *flags, const size_t size, const char **flag_table, const char *flag_name) {
@@ -260,16 +308,21 @@ void create_needed_dirs(void)
 
 errr parse_file(struct parser *p, const char *filename) {
 	char path[1024];
+	char name[80];
 	char buf[1024];
+	const char *line;
+	size_t len;
 	ang_file *fh;
 	errr r = 0;
 
-	path_build(path, sizeof(path), ANGBAND_DIR_EDIT, format("%s.txt", filename));
+	/* Not format(), which isn't safe to use from the parser threads */
+	strnfmt(name, sizeof(name), "%s.txt", filename);
+	path_build(path, sizeof(path), ANGBAND_DIR_EDIT, name);
 	fh = file_open(path, MODE_READ, -1);
 	if (!fh)
 		quit(format("Cannot open '%s.txt'", filename));
-	while (file_getl(fh, buf, sizeof(buf))) {
-		r = parser_parse(p, buf);
+	while (file_getl_ref(fh, buf, sizeof(buf), &line, &len)) {
+		r = parser_parse_n(p, line, len);
 		if (r)
 			break;
 	}
@@ -368,7 +421,7 @@ static enum parser_error parse_k_n(struct parser *p) {
 	k->next = h;
 	parser_setpriv(p, k);
 	k->kidx = idx;
-	k->name = string_make(name);
+	k->name = parser_strdup(p, name);
 	return PARSE_ERROR_NONE;
 }
 
@@ -463,13 +516,14 @@ static enum parser_error parse_k_f(struct parser *p) {
 	struct object_kind *k = parser_priv(p);
 	char *s = string_make(parser_getstr(p, "flags"));
 	char *t;
+	char *rest;
 	assert(k);
 
-	t = strtok(s, " |");
+	t = my_strtok(s, " |", &rest);
 	while (t) {
 		if (grab_flag(k->flags, OF_SIZE, k_info_flags, t))
 			break;
-		t = strtok(NULL, " |");
+		t = my_strtok(NULL, " |", &rest);
 	}
 	mem_free(s);
 	return t ? PARSE_ERROR_INVALID_FLAG : PARSE_ERROR_NONE;
@@ -491,7 +545,7 @@ static enum parser_error parse_k_e(struct parser *p) {
 static enum parser_error parse_k_d(struct parser *p) {
 	struct object_kind *k = parser_priv(p);
 	assert(k);
-	k->text = string_append(k->text, parser_getstr(p, "text"));
+	k->text = parser_strappend(p, k->text, parser_getstr(p, "text"));
 	return PARSE_ERROR_NONE;
 }
 
@@ -527,6 +581,9 @@ static errr finish_parse_k(struct parser *p) {
 		memcpy(&k_info[k->kidx], k, sizeof(*k));
 	}
 
+	/* The parsers waiting on this one look kinds up at once */
+	kind_index_build();
+
 	k = parser_priv(p);
 	while (k) {
 		n = k->next;
@@ -554,7 +611,7 @@ static enum parser_error parse_a_n(struct parser *p) {
 	a->next = h;
 	parser_setpriv(p, a);
 	a->aidx = idx;
-	a->name = string_make(name);
+	a->name = parser_strdup(p, name);
 
 	/* Ignore all elements */
 	flags_set(a->flags, OF_SIZE, OF_IGNORE_MASK, FLAG_END);
@@ -629,17 +686,18 @@ static enum parser_error parse_a_f(struct parser *p) {
 	struct artifact *a = parser_priv(p);
 	char *s;
 	char *t;
+	char *rest;
 	assert(a);
 
 	if (!parser_hasval(p, "flags"))
 		return PARSE_ERROR_NONE;
 	s = string_make(parser_getstr(p, "flags"));
 
-	t = strtok(s, " |");
+	t = my_strtok(s, " |", &rest);
 	while (t) {
 		if (grab_flag(a->flags, OF_SIZE, k_info_flags, t))
 			break;
-		t = strtok(NULL, " |");
+		t = my_strtok(NULL, " |", &rest);
 	}
 	mem_free(s);
 	return t ? PARSE_ERROR_INVALID_FLAG : PARSE_ERROR_NONE;
@@ -660,7 +718,7 @@ static enum parser_error parse_a_m(struct parser *p) {
 	struct artifact *a = parser_priv(p);
 	assert(a);
 
-	a->effect_msg = string_append(a->effect_msg, parser_getstr(p, "text"));
+	a->effect_msg = parser_strappend(p, a->effect_msg, parser_getstr(p, "text"));
 	return PARSE_ERROR_NONE;
 }
 
@@ -668,7 +726,7 @@ static enum parser_error parse_a_d(struct parser *p) {
 	struct artifact *a = parser_priv(p);
 	assert(a);
 
-	a->text = string_append(a->text, parser_getstr(p, "text"));
+	a->text = parser_strappend(p, a->text, parser_getstr(p, "text"));
 	return PARSE_ERROR_NONE;
 }
 
@@ -747,7 +805,7 @@ static enum parser_error parse_names_d(struct parser *p) {
 
 	s->nnames[s->section]++;
 	ns->next = s->names[s->section];
-	ns->str = string_make(name);
+	ns->str = parser_strdup(p, name);
 	s->names[s->section] = ns;
 	return PARSE_ERROR_NONE;
 }
@@ -805,7 +863,7 @@ static enum parser_error parse_f_n(struct parser *p) {
 	f->next = h;
 	f->fidx = idx;
 	f->mimic = idx;
-	f->name = string_make(name);
+	f->name = parser_strdup(p, name);
 	parser_setpriv(p, f);
 	return PARSE_ERROR_NONE;
 }
@@ -889,6 +947,7 @@ static enum parser_error parse_f_f(struct parser *p) {
 	char *flags;
 	struct feature *f = parser_priv(p);
 	char *s;
+	char *rest;
 
 	if (!f)
 		return PARSE_ERROR_MISSING_RECORD_HEADER;
@@ -897,13 +956,13 @@ static enum parser_error parse_f_f(struct parser *p) {
 		return PARSE_ERROR_NONE;
 	flags = string_make(parser_getstr(p, "flags"));
 
-	s = strtok(flags, " |");
+	s = my_strtok(flags, " |", &rest);
 	while (s) {
 		if (grab_one_flag(&f->flags, f_info_flags, s)) {
 			mem_free(s);
 			return PARSE_ERROR_INVALID_FLAG;
 		}
-		s = strtok(NULL, " |");
+		s = my_strtok(NULL, " |", &rest);
 	}
 
 	mem_free(flags);
@@ -989,7 +1048,7 @@ static enum parser_error parse_e_n(struct parser *p) {
 	e->next = h;
 	parser_setpriv(p, e);
 	e->eidx = idx;
-	e->name = string_make(name);
+	e->name = parser_strdup(p, name);
 	return PARSE_ERROR_NONE;
 }
 
@@ -1088,17 +1147,18 @@ static enum parser_error parse_e_f(struct parser *p) {
 	struct ego_item *e = parser_priv(p);
 	char *s;
 	char *t;
+	char *rest;
 
 	if (!e)
 		return PARSE_ERROR_MISSING_RECORD_HEADER;
 	if (!parser_hasval(p, "flags"))
 		return PARSE_ERROR_NONE;
 	s = string_make(parser_getstr(p, "flags"));
-	t = strtok(s, " |");
+	t = my_strtok(s, " |", &rest);
 	while (t) {
 		if (grab_flag(e->flags, OF_SIZE, k_info_flags,t))
 			break;
-		t = strtok(NULL, " |");
+		t = my_strtok(NULL, " |", &rest);
 	}
 	mem_free(s);
 	return t ? PARSE_ERROR_INVALID_FLAG : PARSE_ERROR_NONE;
@@ -1109,7 +1169,7 @@ static enum parser_error parse_e_d(struct parser *p) {
 
 	if (!e)
 		return PARSE_ERROR_MISSING_RECORD_HEADER;
-	e->text = string_append(e->text, parser_getstr(p, "text"));
+	e->text = parser_strappend(p, e->text, parser_getstr(p, "text"));
 	return PARSE_ERROR_NONE;
 }
 
@@ -1233,7 +1293,7 @@ static enum parser_error parse_r_n(struct parser *p) {
 	memset(r, 0, sizeof(*r));
 	r->next = h;
 	r->ridx = parser_getuint(p, "index");
-	r->name = string_make(parser_getstr(p, "name"));
+	r->name = parser_strdup(p, parser_getstr(p, "name"));
 	parser_setpriv(p, r);
 	return PARSE_ERROR_NONE;
 }
@@ -1356,19 +1416,20 @@ static enum parser_error parse_r_f(struct parser *p) {
 	struct monster_race *r = parser_priv(p);
 	char *flags;
 	char *s;
+	char *rest;
 
 	if (!r)
 		return PARSE_ERROR_MISSING_RECORD_HEADER;
 	if (!parser_hasval(p, "flags"))
 		return PARSE_ERROR_NONE;
 	flags = string_make(parser_getstr(p, "flags"));
-	s = strtok(flags, " |");
+	s = my_strtok(flags, " |", &rest);
 	while (s) {
 		if (grab_flag(r->flags, RF_SIZE, r_info_flags, s)) {
 			mem_free(flags);
 			return PARSE_ERROR_INVALID_FLAG;
 		}
-		s = strtok(NULL, " |");
+		s = my_strtok(NULL, " |", &rest);
 	}
 
 	mem_free(flags);
@@ -1380,7 +1441,7 @@ static enum parser_error parse_r_d(struct parser *p) {
 
 	if (!r)
 		return PARSE_ERROR_MISSING_RECORD_HEADER;
-	r->text = string_append(r->text, parser_getstr(p, "desc"));
+	r->text = parser_strappend(p, r->text, parser_getstr(p, "desc"));
 	return PARSE_ERROR_NONE;
 }
 
@@ -1396,13 +1457,14 @@ static enum parser_error parse_r_s(struct parser *p) {
 	struct monster_race *r = parser_priv(p);
 	char *flags;
 	char *s;
+	char *rest;
 	int pct;
 	int ret = PARSE_ERROR_NONE;
 
 	if (!r)
 		return PARSE_ERROR_MISSING_RECORD_HEADER;
 	flags = string_make(parser_getstr(p, "spells"));
-	s = strtok(flags, " |");
+	s = my_strtok(flags, " |", &rest);
 	while (s) {
 		if (1 == sscanf(s, "1_IN_%d", &pct)) {
 			if (pct < 1 || pct > 100) {
@@ -1417,7 +1479,7 @@ static enum parser_error parse_r_s(struct parser *p) {
 				break;
 			}
 		}
-		s = strtok(NULL, " |");
+		s = my_strtok(NULL, " |", &rest);
 	}
 
 	mem_free(flags);
@@ -2380,7 +2442,7 @@ static enum parser_error parse_p_n(struct parser *p) {
 
 	r->next = h;
 	r->ridx = parser_getuint(p, "index");
-	r->name = string_make(parser_getstr(p, "name"));
+	r->name = parser_strdup(p, parser_getstr(p, "name"));
 	parser_setpriv(p, r);
 	return PARSE_ERROR_NONE;
 }
@@ -2461,17 +2523,18 @@ static enum parser_error parse_p_f(struct parser *p) {
 	struct player_race *r = parser_priv(p);
 	char *flags;
 	char *s;
+	char *rest;
 
 	if (!r)
 		return PARSE_ERROR_MISSING_RECORD_HEADER;
 	if (!parser_hasval(p, "flags"))
 		return PARSE_ERROR_NONE;
 	flags = string_make(parser_getstr(p, "flags"));
-	s = strtok(flags, " |");
+	s = my_strtok(flags, " |", &rest);
 	while (s) {
 		if (grab_flag(r->flags, OF_SIZE, k_info_flags, s))
 			break;
-		s = strtok(NULL, " |");
+		s = my_strtok(NULL, " |", &rest);
 	}
 	mem_free(flags);
 	return s ? PARSE_ERROR_INVALID_FLAG : PARSE_ERROR_NONE;
@@ -2489,17 +2552,18 @@ static enum parser_error parse_p_y(struct parser *p) {
 	struct player_race *r = parser_priv(p);
 	char *flags;
 	char *s;
+	char *rest;
 
 	if (!r)
 		return PARSE_ERROR_MISSING_RECORD_HEADER;
 	if (!parser_hasval(p, "flags"))
 		return PARSE_ERROR_NONE;
 	flags = string_make(parser_getstr(p, "flags"));
-	s = strtok(flags, " |");
+	s = my_strtok(flags, " |", &rest);
 	while (s) {
 		if (grab_flag(r->pflags, PF_SIZE, player_info_flags, s))
 			break;
-		s = strtok(NULL, " |");
+		s = my_strtok(NULL, " |", &rest);
 	}
 	mem_free(flags);
 	return s ? PARSE_ERROR_INVALID_FLAG : PARSE_ERROR_NONE;
@@ -2509,16 +2573,17 @@ static enum parser_error parse_p_c(struct parser *p) {
 	struct player_race *r = parser_priv(p);
 	char *classes;
 	char *s;
+	char *rest;
 
 	if (!r)
 		return PARSE_ERROR_MISSING_RECORD_HEADER;
 	if (!parser_hasval(p, "classes"))
 		return PARSE_ERROR_NONE;
 	classes = string_make(parser_getstr(p, "classes"));
-	s = strtok(classes, " |");
+	s = my_strtok(classes, " |", &rest);
 	while (s) {
 		r->choice |= 1 << atoi(s);
-		s = strtok(NULL, " |");
+		s = my_strtok(NULL, " |", &rest);
 	}
 	mem_free(classes);
 	return PARSE_ERROR_NONE;
@@ -2577,7 +2642,7 @@ static enum parser_error parse_c_n(struct parser *p) {
 	struct player_class *h = parser_priv(p);
 	struct player_class *c = mem_zalloc(sizeof *c);
 	c->cidx = parser_getuint(p, "index");
-	c->name = string_make(parser_getstr(p, "name"));
+	c->name = parser_strdup(p, parser_getstr(p, "name"));
 	c->next = h;
 	parser_setpriv(p, c);
 	return PARSE_ERROR_NONE;
@@ -2693,7 +2758,7 @@ static enum parser_error parse_c_t(struct parser *p) {
 		return PARSE_ERROR_MISSING_RECORD_HEADER;
 	for (i = 0; i < PY_MAX_LEVEL / 5; i++) {
 		if (!c->title[i]) {
-			c->title[i] = string_make(parser_getstr(p, "title"));
+			c->title[i] = parser_strdup(p, parser_getstr(p, "title"));
 			break;
 		}
 	}
@@ -2737,17 +2802,18 @@ static enum parser_error parse_c_f(struct parser *p) {
 	struct player_class *c = parser_priv(p);
 	char *flags;
 	char *s;
+	char *rest;
 
 	if (!c)
 		return PARSE_ERROR_MISSING_RECORD_HEADER;
 	if (!parser_hasval(p, "flags"))
 		return PARSE_ERROR_NONE;
 	flags = string_make(parser_getstr(p, "flags"));
-	s = strtok(flags, " |");
+	s = my_strtok(flags, " |", &rest);
 	while (s) {
 		if (grab_flag(c->pflags, PF_SIZE, player_info_flags, s))
 			break;
-		s = strtok(NULL, " |");
+		s = my_strtok(NULL, " |", &rest);
 	}
 
 	mem_free(flags);
@@ -2809,7 +2875,7 @@ static enum parser_error parse_v_n(struct parser *p) {
 	struct vault *v = mem_zalloc(sizeof *v);
 
 	v->vidx = parser_getuint(p, "index");
-	v->name = string_make(parser_getstr(p, "name"));
+	v->name = parser_strdup(p, parser_getstr(p, "name"));
 	v->next = h;
 	parser_setpriv(p, v);
 	return PARSE_ERROR_NONE;
@@ -2839,7 +2905,7 @@ static enum parser_error parse_v_d(struct parser *p) {
 
 	if (!v)
 		return PARSE_ERROR_MISSING_RECORD_HEADER;
-	v->text = string_append(v->text, parser_getstr(p, "text"));
+	v->text = parser_strappend(p, v->text, parser_getstr(p, "text"));
 	return PARSE_ERROR_NONE;
 }
 
@@ -2857,6 +2923,53 @@ static errr run_parse_v(struct parser *p) {
 	return parse_file(p, "vault");
 }
 
+/*
+ * Is a vault grid one which places a monster?  See "build_vault()".
+ */
+static bool vault_code_spawns(char code) {
+	return (code && strchr("&@98,", code));
+}
+
+/*
+ * Turn a vault's text into the lists of grids "build_vault()" works from,
+ * so the blank parts needn't be looked at each time the vault is built.
+ */
+static void compile_vault(struct vault *v) {
+	size_t len = v->text ? strlen(v->text) : 0;
+	int y, x, n = 0, m = 0;
+
+	/* Count the grids */
+	for (y = 0; y < v->hgt; y++) {
+		for (x = 0; x < v->wid; x++) {
+			size_t i = y * v->wid + x;
+			if (i >= len || v->text[i] == ' ') continue;
+			n++;
+			if (vault_code_spawns(v->text[i])) m++;
+		}
+	}
+
+	v->grids = mem_zalloc(MAX(n, 1) * sizeof(*v->grids));
+	v->spawns = mem_zalloc(MAX(m, 1) * sizeof(*v->spawns));
+
+	/* List them */
+	for (y = 0; y < v->hgt; y++) {
+		for (x = 0; x < v->wid; x++) {
+			size_t i = y * v->wid + x;
+			struct vault_grid g;
+
+			if (i >= len || v->text[i] == ' ') continue;
+
+			g.y = y;
+			g.x = x;
+			g.code = v->text[i];
+
+			v->grids[v->n_grids++] = g;
+			if (vault_code_spawns(g.code))
+				v->spawns[v->n_spawns++] = g;
+		}
+	}
+}
+
 static errr finish_parse_v(struct parser *p) {
 	struct vault *v, *n;
 
@@ -2864,6 +2977,7 @@ static errr finish_parse_v(struct parser *p) {
 	for (v = parser_priv(p); v; v = v->next) {
 		if (v->vidx >= z_info->v_max)
 			continue;
+		compile_vault(v);
 		memcpy(&v_info[v->vidx], v, sizeof(*v));
 	}
 
@@ -2904,7 +3018,7 @@ static enum parser_error parse_h_d(struct parser *p) {
 
 	if (!h)
 		return PARSE_ERROR_MISSING_RECORD_HEADER;
-	h->text = string_append(h->text, parser_getstr(p, "text"));
+	h->text = parser_strappend(p, h->text, parser_getstr(p, "text"));
 	return PARSE_ERROR_NONE;
 }
 
@@ -2993,7 +3107,7 @@ static enum parser_error parse_flavor_d(struct parser *p) {
 
 	if (!f)
 		return PARSE_ERROR_MISSING_RECORD_HEADER;
-	f->text = string_append(f->text, parser_getstr(p, "desc"));
+	f->text = parser_strappend(p, f->text, parser_getstr(p, "desc"));
 	return PARSE_ERROR_NONE;
 }
 
@@ -3044,7 +3158,7 @@ static enum parser_error parse_s_n(struct parser *p) {
 	struct spell *s = mem_zalloc(sizeof *s);
 	s->next = parser_priv(p);
 	s->sidx = parser_getuint(p, "index");
-	s->name = string_make(parser_getstr(p, "name"));
+	s->name = parser_strdup(p, parser_getstr(p, "name"));
 	parser_setpriv(p, s);
 	return PARSE_ERROR_NONE;
 }
@@ -3071,7 +3185,7 @@ static enum parser_error parse_s_d(struct parser *p) {
 	if (!s)
 		return PARSE_ERROR_MISSING_RECORD_HEADER;
 
-	s->text = string_append(s->text, parser_getstr(p, "desc"));
+	s->text = parser_strappend(p, s->text, parser_getstr(p, "desc"));
 	return PARSE_ERROR_NONE;
 }
 
@@ -3154,7 +3268,7 @@ static enum parser_error parse_hint(struct parser *p) {
 	struct hint *h = parser_priv(p);
 	struct hint *new = mem_zalloc(sizeof *new);
 
-	new->hint = string_make(parser_getstr(p, "text"));
+	new->hint = parser_strdup(p, parser_getstr(p, "text"));
 	new->next = h;
 
 	parser_setpriv(p, new);
@@ -3218,7 +3332,6 @@ static errr init_other(void)
 	/* Initialize squelch things */
 	autoinscribe_init();
 	squelch_init();
-	textui_knowledge_init();
 
 	/* Initialize the "message" package */
 	(void)messages_init();
@@ -3238,20 +3351,10 @@ static errr init_other(void)
 
 	/*** Prepare dungeon arrays ***/
 
-	/* Padded into array */
-	cave_info = C_ZNEW(DUNGEON_HGT, byte_256);
-	cave_info2 = C_ZNEW(DUNGEON_HGT, byte_256);
-
-	/* Feature array */
-	cave_feat = C_ZNEW(DUNGEON_HGT, byte_wid);
-
-	/* Entity arrays */
-	cave_o_idx = C_ZNEW(DUNGEON_HGT, s16b_wid);
-	cave_m_idx = C_ZNEW(DUNGEON_HGT, s16b_wid);
-
-	/* Flow arrays */
-	cave_cost = C_ZNEW(DUNGEON_HGT, byte_wid);
-	cave_when = C_ZNEW(DUNGEON_HGT, byte_wid);
+	/* The level itself */
+	cave = ZNEW(struct cave);
+	cave->height = DUNGEON_HGT;
+	cave->width = DUNGEON_WID;
 
 
 	/*** Prepare "vinfo" array ***/
@@ -3262,11 +3365,9 @@ static errr init_other(void)
 
 	/*** Prepare entity arrays ***/
 
-	/* Objects */
-	o_list = C_ZNEW(z_info->o_max, object_type);
-
-	/* Monsters */
-	mon_list = C_ZNEW(z_info->m_max, monster_type);
+	/* Objects, and monsters, a chunk of each to start with */
+	o_list_grow(1);
+	mon_list_grow(1);
 
 
 	/*** Prepare lore array ***/
@@ -3503,6 +3604,822 @@ static errr init_alloc(void)
 
 
 
+/*** Binary cache of the larger edit files ***/
+
+/*
+ * Parsing the edit files is most of the work of starting up, so the arrays
+ * built from the larger ones are written to the user directory once they
+ * have been parsed, and read straight back on later starts for as long as
+ * the cache is newer than every file it was built from.
+ *
+ * The cache is a header and then each array as it is in memory, except that
+ * string pointers are stored as offsets (plus one, so NULL stays zero) into
+ * a block of strings at the end, and other pointers are cleared.  On loading
+ * the strings are used in place, from one allocation that is kept for the
+ * rest of the game just as the parser's strings would have been.
+ *
+ * In low-memory builds, only the names and other short strings are kept
+ * once the arrays are loaded.  The descriptions are left in the file, their
+ * pointers holding their offsets into the string block again, and are read
+ * back by cache_text() when they're shown.
+ *
+ * The header also holds a hash of the build that wrote the cache: when this
+ * file was compiled, the size of a pointer, and the size of each cached
+ * structure with the offsets of its pointers.  This file is rebuilt whenever
+ * the parsers or any of the structures change, so a cache is only read back
+ * by the build that wrote it, and one left by another build is made again.
+ *
+ * Bump CACHE_VERSION whenever the layout of the cache itself changes.
+ */
+#define CACHE_NAME		"data.cache"
+#define CACHE_VERSION	2
+
+/* The edit files whose arrays are cached, with "limits" for their sizes */
+static const char *cache_sources[] =
+{
+	"limits", "terrain", "object", "ego_item", "monster", "artifact", "vault"
+};
+
+#define CACHE_POINTERS_MAX	3
+
+struct cache_array
+{
+	void **array;
+	size_t size;
+	u16b *count;
+
+	/* Offsets of the string pointers and of any other pointers */
+	size_t strings[CACHE_POINTERS_MAX];
+	int n_strings;
+	int texts;		/* Which of the strings are descriptions, as bits */
+	size_t clear[CACHE_POINTERS_MAX];
+	int n_clear;
+};
+
+static struct cache_array cache_arrays[6];
+
+struct cache_header
+{
+	char magic[8];
+	u32b version;
+	u32b build;			/* Hash of the build, from cache_build() */
+	char game[32];
+	u32b sizes[N_ELEMENTS(cache_arrays)];
+	u32b counts[N_ELEMENTS(cache_arrays)];
+	u32b strings;		/* Length of the string block */
+};
+
+/* Write down which arrays are cached and where their pointers are */
+#define CACHE_ARRAY(i, a, c) \
+	cache_arrays[i].array = (void **)&(a); \
+	cache_arrays[i].size = sizeof(*(a)); \
+	cache_arrays[i].count = &z_info->c
+#define CACHE_STRING(i, type, field) \
+	cache_arrays[i].strings[cache_arrays[i].n_strings++] = \
+		offsetof(type, field)
+#define CACHE_TEXT(i, type, field) \
+	cache_arrays[i].texts |= 1 << cache_arrays[i].n_strings; \
+	CACHE_STRING(i, type, field)
+#define CACHE_CLEAR(i, type, field) \
+	cache_arrays[i].clear[cache_arrays[i].n_clear++] = offsetof(type, field)
+
+#ifdef LOW_MEMORY
+/* Where the string block starts in the cache, once descriptions are left there */
+static u32b cache_text_at;
+#endif
+
+static void cache_init(void)
+{
+	WIPE(cache_arrays, cache_arrays);
+
+	CACHE_ARRAY(0, f_info, f_max);
+	CACHE_STRING(0, feature_type, name);
+	CACHE_CLEAR(0, feature_type, next);
+
+	CACHE_ARRAY(1, k_info, k_max);
+	CACHE_STRING(1, object_kind, name);
+	CACHE_TEXT(1, object_kind, text);
+	CACHE_CLEAR(1, object_kind, next);
+
+	CACHE_ARRAY(2, e_info, e_max);
+	CACHE_STRING(2, ego_item_type, name);
+	CACHE_TEXT(2, ego_item_type, text);
+	CACHE_CLEAR(2, ego_item_type, next);
+
+	CACHE_ARRAY(3, r_info, r_max);
+	CACHE_STRING(3, monster_race, name);
+	CACHE_TEXT(3, monster_race, text);
+	CACHE_CLEAR(3, monster_race, next);
+
+	CACHE_ARRAY(4, a_info, a_max);
+	CACHE_STRING(4, artifact_type, name);
+	CACHE_TEXT(4, artifact_type, text);
+	CACHE_STRING(4, artifact_type, effect_msg);
+	CACHE_CLEAR(4, artifact_type, next);
+
+	/* Vaults are compiled again after loading */
+	CACHE_ARRAY(5, v_info, v_max);
+	CACHE_STRING(5, vault_type, name);
+	CACHE_TEXT(5, vault_type, text);
+	CACHE_CLEAR(5, vault_type, next);
+	CACHE_CLEAR(5, vault_type, grids);
+	CACHE_CLEAR(5, vault_type, spawns);
+}
+
+/*
+ * Mix `v` into hash `h` (FNV-1a, a word at a time)
+ */
+#define CACHE_MIX(h, v) \
+	((h) = ((h) ^ (u32b)(v)) * 16777619UL)
+
+/*
+ * Hash what a cache depends on besides the edit files: this build, and the
+ * layout of the arrays
+ */
+static u32b cache_build(void)
+{
+	const char *stamp = __DATE__ " " __TIME__;
+	u32b h = 2166136261UL;
+	size_t i;
+	int k;
+
+	while (*stamp)
+		CACHE_MIX(h, (byte)*stamp++);
+
+	CACHE_MIX(h, sizeof(void *));
+
+	for (i = 0; i < N_ELEMENTS(cache_arrays); i++)
+	{
+		const struct cache_array *c = &cache_arrays[i];
+
+		CACHE_MIX(h, c->size);
+		CACHE_MIX(h, c->texts);
+
+		for (k = 0; k < c->n_strings; k++)
+			CACHE_MIX(h, c->strings[k]);
+		for (k = 0; k < c->n_clear; k++)
+			CACHE_MIX(h, c->clear[k] + 1);
+	}
+
+	return h;
+}
+
+static void cache_header_init(struct cache_header *h)
+{
+	size_t i;
+
+	WIPE(h, struct cache_header);
+	my_strcpy(h->magic, "ANGCACHE", sizeof(h->magic));
+	h->version = CACHE_VERSION;
+	h->build = cache_build();
+	my_strcpy(h->game, VERSION_STRING, sizeof(h->game));
+
+	for (i = 0; i < N_ELEMENTS(cache_arrays); i++)
+	{
+		h->sizes[i] = cache_arrays[i].size;
+		h->counts[i] = *cache_arrays[i].count;
+	}
+}
+
+static void cache_path(char *buf, size_t len)
+{
+	path_build(buf, len, ANGBAND_DIR_USER, CACHE_NAME);
+}
+
+#ifdef LOW_MEMORY
+/*
+ * Copy the short strings of the arrays just loaded to init_strings, and turn
+ * the descriptions back into offsets into "strings", which is freed
+ */
+static void cache_defer_text(const struct cache_header *h, char *strings)
+{
+	size_t i, j;
+	int k;
+
+	if (!init_strings) init_strings = arena_new();
+
+	/* The string block follows the header and the arrays */
+	cache_text_at = sizeof(*h);
+
+	for (i = 0; i < N_ELEMENTS(cache_arrays); i++)
+	{
+		struct cache_array *c = &cache_arrays[i];
+
+		cache_text_at += h->sizes[i] * h->counts[i];
+
+		for (j = 0; j < h->counts[i]; j++)
+		{
+			char *elt = (char *)*c->array + j * c->size;
+
+			for (k = 0; k < c->n_strings; k++)
+			{
+				char **str = (char **)(elt + c->strings[k]);
+
+				if (!*str) continue;
+
+				if (c->texts & (1 << k))
+					*str = (char *)(size_t)(*str - strings + 1);
+				else
+					*str = arena_string(init_strings, *str);
+			}
+		}
+	}
+
+	mem_free(strings);
+}
+#endif /* LOW_MEMORY */
+
+/*
+ * The description "text" of an entry of one of the cached arrays.  In
+ * low-memory builds, if the arrays came from the cache, it is read from there
+ * into a buffer which the next call reuses.
+ */
+const char *cache_text(const char *text)
+{
+#ifdef LOW_MEMORY
+	static char buf[4096];
+	char path[1024];
+	ang_file *fh;
+	int n = 0;
+
+	if (!cache_text_at || !text) return text;
+
+	cache_path(path, sizeof(path));
+	fh = file_open(path, MODE_READ, -1);
+	if (fh)
+	{
+		if (file_seek(fh, cache_text_at + (u32b)(size_t)text - 1))
+			n = file_read(fh, buf, sizeof(buf) - 1);
+		file_close(fh);
+	}
+
+	buf[MAX(n, 0)] = '\0';
+	return buf;
+#else
+	return text;
+#endif
+}
+
+/*
+ * Read the cached arrays, if there's a cache that is still good.  Either all
+ * of the arrays are set up, or none of them are.
+ */
+static bool cache_load(void)
+{
+	char path[1024];
+	struct cache_header want, h;
+	void *arrays[N_ELEMENTS(cache_arrays)];
+	char *strings = NULL;
+	ang_file *fh;
+	bool ok = TRUE;
+	size_t i, j;
+	int k;
+
+	cache_init();
+	cache_path(path, sizeof(path));
+
+	/* The cache has to be newer than all of its sources */
+	for (i = 0; i < N_ELEMENTS(cache_sources); i++)
+	{
+		char src[1024];
+
+		path_build(src, sizeof(src), ANGBAND_DIR_EDIT,
+		           format("%s.txt", cache_sources[i]));
+		if (!file_newer(path, src)) return FALSE;
+	}
+
+	fh = file_open(path, MODE_READ, -1);
+	if (!fh) return FALSE;
+
+	/* It has to be from this build, for these sizes of array */
+	cache_header_init(&want);
+	if (file_read(fh, (char *)&h, sizeof(h)) != (int)sizeof(h) ||
+	    memcmp(&h, &want, offsetof(struct cache_header, strings)) ||
+	    !h.strings)
+	{
+		file_close(fh);
+		return FALSE;
+	}
+
+	WIPE(arrays, arrays);
+	for (i = 0; ok && i < N_ELEMENTS(cache_arrays); i++)
+	{
+		size_t len = h.sizes[i] * h.counts[i];
+
+		arrays[i] = mem_zalloc(len);
+		ok = (file_read(fh, arrays[i], len) == (int)len);
+	}
+
+	if (ok)
+	{
+		strings = mem_alloc(h.strings);
+		ok = (file_read(fh, strings, h.strings) == (int)h.strings) &&
+			!strings[h.strings - 1];
+	}
+
+	file_close(fh);
+
+	/* Point the strings back into the string block */
+	for (i = 0; ok && i < N_ELEMENTS(cache_arrays); i++)
+	{
+		struct cache_array *c = &cache_arrays[i];
+
+		for (j = 0; ok && j < h.counts[i]; j++)
+		{
+			char *elt = (char *)arrays[i] + j * c->size;
+
+			for (k = 0; k < c->n_strings; k++)
+			{
+				char **str = (char **)(elt + c->strings[k]);
+				size_t off = (size_t)*str;
+
+				if (off > h.strings)
+					ok = FALSE;
+				else
+					*str = off ? strings + off - 1 : NULL;
+			}
+		}
+	}
+
+	if (!ok)
+	{
+		for (i = 0; i < N_ELEMENTS(cache_arrays); i++)
+			mem_free(arrays[i]);
+		mem_free(strings);
+		return FALSE;
+	}
+
+	for (i = 0; i < N_ELEMENTS(cache_arrays); i++)
+		*cache_arrays[i].array = arrays[i];
+
+	/* Redo what finishing the parse would have done */
+	for (j = 0; j < z_info->v_max; j++)
+	{
+		v_info[j].n_grids = v_info[j].n_spawns = 0;
+		compile_vault(&v_info[j]);
+	}
+	eval_e_slays(e_info);
+	tot_mon_power = 0;
+	for (j = 0; j < z_info->r_max; j++)
+		tot_mon_power += r_info[j].power;
+
+#ifdef LOW_MEMORY
+	cache_defer_text(&h, strings);
+#endif
+
+	return TRUE;
+}
+
+/*
+ * Add string "str" to the string block being built in "buf", returning the
+ * offset to store for it
+ */
+static size_t cache_string(char **buf, size_t *len, size_t *size,
+                           const char *str)
+{
+	size_t n, off;
+
+	if (!str) return 0;
+
+	n = strlen(str) + 1;
+	while (*len + n > *size)
+	{
+		*size = *size ? 2 * *size : 65536;
+		*buf = mem_realloc(*buf, *size);
+	}
+
+	memcpy(*buf + *len, str, n);
+	off = *len + 1;
+	*len += n;
+
+	return off;
+}
+
+/*
+ * Write the arrays out to the cache.  Nothing is lost if this fails.
+ */
+static void cache_save(void)
+{
+	char path[1024], tmp[1024];
+	struct cache_header h;
+	void *arrays[N_ELEMENTS(cache_arrays)];
+	char *strings = NULL;
+	size_t len = 0, size = 0;
+	ang_file *fh;
+	bool ok;
+	size_t i, j;
+	int k;
+
+	cache_init();
+	cache_header_init(&h);
+
+	/* Copy the arrays, swapping the pointers for offsets */
+	for (i = 0; i < N_ELEMENTS(cache_arrays); i++)
+	{
+		struct cache_array *c = &cache_arrays[i];
+
+		arrays[i] = mem_alloc(c->size * h.counts[i]);
+		memcpy(arrays[i], *c->array, c->size * h.counts[i]);
+
+		for (j = 0; j < h.counts[i]; j++)
+		{
+			char *elt = (char *)arrays[i] + j * c->size;
+
+			for (k = 0; k < c->n_strings; k++)
+			{
+				char **str = (char **)(elt + c->strings[k]);
+				*str = (char *)cache_string(&strings, &len, &size, *str);
+			}
+
+			for (k = 0; k < c->n_clear; k++)
+				*(void **)(elt + c->clear[k]) = NULL;
+		}
+	}
+
+	/* Always end with a NUL, so the block is never empty */
+	cache_string(&strings, &len, &size, "");
+	h.strings = len;
+
+	/* Write to a new file, and only replace the cache once it's complete */
+	cache_path(path, sizeof(path));
+	strnfmt(tmp, sizeof(tmp), "%s.new", path);
+
+	fh = file_open(tmp, MODE_WRITE, FTYPE_RAW);
+	ok = (fh != NULL);
+	if (ok)
+	{
+		ok = file_write(fh, (char *)&h, sizeof(h));
+		for (i = 0; ok && i < N_ELEMENTS(cache_arrays); i++)
+			ok = file_write(fh, arrays[i], cache_arrays[i].size * h.counts[i]);
+		if (ok) ok = file_write(fh, strings, len);
+		if (!file_close(fh)) ok = FALSE;
+
+		if (ok) ok = file_move(tmp, path);
+		if (!ok) file_delete(tmp);
+	}
+
+	for (i = 0; i < N_ELEMENTS(cache_arrays); i++)
+		mem_free(arrays[i]);
+	mem_free(strings);
+}
+
+
+
+/*** Parsing the edit files ***/
+
+/*
+ * The edit files are parsed in the order below when it has to be one at a
+ * time.  Where threads are available, stages are instead handed out to
+ * INIT_WORKERS threads as soon as the stage they look things up in (if any)
+ * is done.  Each parser still fills in its own array from its own file, so
+ * what ends up where doesn't depend on the order they finish in.
+ *
+ * Errors can only be reported from the main thread, once all the workers
+ * have stopped.
+ */
+#define INIT_WORKERS	4
+
+enum init_state
+{
+	STAGE_WAITING = 0,
+	STAGE_RUNNING,
+	STAGE_DONE
+};
+
+struct init_stage
+{
+	struct file_parser *fp;
+	const char *what;
+	struct file_parser *needs;	/* Stage that must be done first, if any */
+	bool cached;				/* Loaded by cache_load() instead */
+
+	enum init_state state;
+	errr result;
+	struct parser *failed;		/* To report the error from, if any */
+	mem_arena *strings;			/* Names and text the stage read */
+	double secs;				/* How long it took */
+};
+
+static struct init_stage init_stages[] =
+{
+	{ &f_parser,		"features",		NULL,		TRUE },
+	{ &k_parser,		"objects",		NULL,		TRUE },
+	{ &e_parser,		"ego-items",	NULL,		TRUE },
+	{ &r_parser,		"monsters",		NULL,		TRUE },
+	{ &a_parser,		"artifacts",	&k_parser,	TRUE },
+	{ &v_parser,		"vaults",		NULL,		TRUE },
+	{ &h_parser,		"histories",	NULL,		FALSE },
+	{ &p_parser,		"races",		NULL,		FALSE },
+	{ &c_parser,		"classes",		&k_parser,	FALSE },
+	{ &flavor_parser,	"flavors",		&k_parser,	FALSE },
+	{ &s_parser,		"spells",		NULL,		FALSE },
+	{ &names_parser,	"random names",	NULL,		FALSE },
+};
+
+#ifdef HAVE_PTHREAD_H
+static pthread_mutex_t init_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t init_cond = PTHREAD_COND_INITIALIZER;
+# define init_stages_lock()		pthread_mutex_lock(&init_lock)
+# define init_stages_unlock()	pthread_mutex_unlock(&init_lock)
+# define init_stages_wait()		pthread_cond_wait(&init_cond, &init_lock)
+# define init_stages_changed()	pthread_cond_broadcast(&init_cond)
+#else
+# define init_stages_lock()
+# define init_stages_unlock()
+# define init_stages_wait()
+# define init_stages_changed()
+#endif
+
+/*
+ * With "-xinit-times", how long each part of init_angband() took is written
+ * to stderr once it's done, each edit file parsed on its own after the
+ * part which parsed them.  Parsing runs on several threads, so the files
+ * can add up to more than that part.
+ */
+bool init_times;
+
+#define INIT_PARTS_MAX	16
+
+static const char *init_part_what[INIT_PARTS_MAX];
+static double init_part_start[INIT_PARTS_MAX + 1];
+static int init_parts;
+static int init_part_stages = -1;
+
+/*
+ * Seconds since some point, by the wall clock where there is one
+ */
+static double init_clock(void)
+{
+#ifdef SET_UID
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/*
+ * Start the next part of init_angband(), and say so
+ */
+static void init_part(const char *what)
+{
+	if (init_times && (init_parts < INIT_PARTS_MAX))
+	{
+		init_part_what[init_parts] = what;
+		init_part_start[init_parts++] = init_clock();
+	}
+
+	event_signal_string(EVENT_INITSTATUS, what);
+}
+
+/*
+ * Write out how long each part of init_angband() took
+ */
+static void init_times_report(void)
+{
+	int i;
+	size_t j;
+
+	if (!init_times || !init_parts) return;
+
+	init_part_start[init_parts] = init_clock();
+
+	for (i = 0; i < init_parts; i++)
+	{
+		fprintf(stderr, "init: %8.4fs  %s\n",
+		        init_part_start[i + 1] - init_part_start[i],
+		        init_part_what[i]);
+
+		if (i != init_part_stages) continue;
+
+		for (j = 0; j < N_ELEMENTS(init_stages); j++)
+			if (init_stages[j].secs > 0)
+				fprintf(stderr, "init: %8.4fs    %s\n",
+				        init_stages[j].secs, init_stages[j].fp->name);
+	}
+
+	fprintf(stderr, "init: %8.4fs  total\n",
+	        init_part_start[init_parts] - init_part_start[0]);
+}
+
+/*
+ * Note how much memory startup has left in use, where memory is short
+ */
+static void init_memory_report(void)
+{
+#ifdef LOW_MEMORY
+	long bytes = 0;
+	int i;
+
+	for (i = 0; i < MEM_TAG_MAX; i++)
+	{
+		struct mem_stats st;
+
+		mem_tag_stats(i, &st);
+		fprintf(stderr, "memory: %-12s %8ld bytes in %lu blocks\n",
+		        mem_tag_name(i), st.bytes, (unsigned long)st.count);
+		bytes += st.bytes;
+	}
+
+	event_signal_string(EVENT_INITSTATUS,
+	                    format("Memory in use: %ldK", (bytes + 1023) / 1024));
+#endif
+}
+
+/*
+ * Names and text read by parsers outside init_stages; each stage has its own
+ * arena, so that the workers needn't share one.
+ */
+mem_arena *init_strings;
+
+/*
+ * Run one stage, keeping its strings in "strings", without reporting any error
+ */
+static errr parse_stage(struct file_parser *fp, mem_arena *strings,
+		struct parser **failed)
+{
+	struct parser *p = fp->init();
+	errr r;
+
+	*failed = NULL;
+	if (!p)
+		return PARSE_ERROR_GENERIC;
+
+	parser_setarena(p, strings);
+	r = fp->run(p);
+	if (!r)
+		r = fp->finish(p);
+	if (r)
+		*failed = p;
+	return r;
+}
+
+errr run_parser(struct file_parser *fp) {
+	struct parser *p;
+	errr r;
+
+	if (!init_strings) init_strings = arena_new();
+	r = parse_stage(fp, init_strings, &p);
+	if (p)
+		print_error(fp, p);
+	return r;
+}
+
+/*
+ * Read the hints, which are only wanted in the shops, the first time they're
+ * asked for.  Returns FALSE if there are none.
+ */
+bool init_hints(void)
+{
+	static bool tried = FALSE;
+
+	if (!tried)
+	{
+		tried = TRUE;
+		run_parser(&hints_parser);
+	}
+
+	return hints != NULL;
+}
+
+/*
+ * The stage for parser "fp"
+ */
+static struct init_stage *init_stage_find(struct file_parser *fp)
+{
+	size_t i;
+
+	for (i = 0; i < N_ELEMENTS(init_stages); i++)
+		if (init_stages[i].fp == fp) return &init_stages[i];
+
+	return NULL;
+}
+
+/*
+ * Keep taking the first stage that's ready to run, until there are none
+ * left.  Without threads, the order of init_stages means there always is one.
+ */
+static void *init_stages_work(void *unused)
+{
+	(void)unused;
+
+	init_stages_lock();
+
+	while (TRUE)
+	{
+		struct init_stage *st = NULL;
+		bool waiting = FALSE;
+		size_t i;
+
+		for (i = 0; i < N_ELEMENTS(init_stages) && !st; i++)
+		{
+			struct init_stage *s = &init_stages[i];
+			struct init_stage *need = s->needs ? init_stage_find(s->needs) : NULL;
+
+			if (s->state != STAGE_WAITING) continue;
+			waiting = TRUE;
+
+			if (!need || need->state == STAGE_DONE)
+				st = s;
+		}
+
+		if (!waiting) break;
+
+		if (!st)
+		{
+			init_stages_wait();
+			continue;
+		}
+
+		st->state = STAGE_RUNNING;
+		init_stages_unlock();
+
+		/* Don't look anything up in a stage that failed */
+		if (st->needs && init_stage_find(st->needs)->result)
+			st->result = PARSE_ERROR_GENERIC;
+		else
+		{
+			double started = init_times ? init_clock() : 0;
+
+			st->result = parse_stage(st->fp, st->strings, &st->failed);
+			if (init_times) st->secs = init_clock() - started;
+		}
+
+		init_stages_lock();
+		st->state = STAGE_DONE;
+		init_stages_changed();
+	}
+
+	init_stages_unlock();
+
+	return NULL;
+}
+
+/*
+ * Build the hashes of all the flag tables
+ */
+static void flag_hashes_init(void)
+{
+	flag_hash_get(k_info_flags);
+	flag_hash_get(r_info_flags);
+	flag_hash_get(r_info_spell_flags);
+	flag_hash_get(player_info_flags);
+}
+
+/*
+ * Parse all of the edit files in init_stages, except those already loaded
+ * from the cache if "cached"
+ */
+static void init_stages_run(bool cached)
+{
+#ifdef HAVE_PTHREAD_H
+	pthread_t workers[INIT_WORKERS - 1];
+	int n = 0;
+#endif
+	size_t i;
+
+	for (i = 0; i < N_ELEMENTS(init_stages); i++)
+	{
+		struct init_stage *st = &init_stages[i];
+
+		st->state = (cached && st->cached) ? STAGE_DONE : STAGE_WAITING;
+		st->result = 0;
+		st->failed = NULL;
+		st->secs = 0;
+		if (st->state == STAGE_WAITING && !st->strings)
+			st->strings = arena_new();
+	}
+
+	flag_hashes_init();
+
+#ifdef HAVE_PTHREAD_H
+	/* The main thread works too, so it's fine if no threads start */
+	while (n < INIT_WORKERS - 1 &&
+	       !pthread_create(&workers[n], NULL, init_stages_work, NULL))
+		n++;
+
+	init_stages_work(NULL);
+
+	while (n--)
+		pthread_join(workers[n], NULL);
+#else
+	init_stages_work(NULL);
+#endif
+
+	/* Report the first failure, in the usual order */
+	for (i = 0; i < N_ELEMENTS(init_stages); i++)
+	{
+		struct init_stage *st = &init_stages[i];
+
+		if (st->failed) print_error(st->fp, st->failed);
+		if (st->result) quit_fmt("Cannot initialize %s", st->what);
+	}
+}
+
+
+
 /*
  * Hack -- main Angband initialization entry point
  *
@@ -3552,92 +4469,56 @@ static errr init_alloc(void)
  */
 bool init_angband(void)
 {
+	bool cached;
+
 	event_signal(EVENT_ENTER_INIT);
 
 
 	/*** Initialize some arrays ***/
 
 	/* Initialize size info */
-	event_signal_string(EVENT_INITSTATUS, "Initializing array sizes...");
+	init_part("Initializing array sizes...");
 	if (run_parser(&z_parser)) quit("Cannot initialize sizes");
 
-	/* Initialize feature info */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (features)");
-	if (run_parser(&f_parser)) quit("Cannot initialize features");
-
-	/* Initialize object info */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (objects)");
-	if (run_parser(&k_parser)) quit("Cannot initialize objects");
-
-	/* Initialize ego-item info */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (ego-items)");
-	if (run_parser(&e_parser)) quit("Cannot initialize ego-items");
+	/* Initialize the larger arrays from the cache, if it's still good */
+	init_part("Initializing arrays... (cached)");
+	cached = cache_load();
 
-	/* Initialize monster info */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (monsters)");
-	if (run_parser(&r_parser)) quit("Cannot initialize monsters");
+	/* Parse the rest of the edit files */
+	init_part("Initializing arrays... (edit files)");
+	init_part_stages = init_parts - 1;
+	init_stages_run(cached);
 
-	/* Initialize artifact info */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (artifacts)");
-	if (run_parser(&a_parser)) quit("Cannot initialize artifacts");
-
-	/* Initialize feature info */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (vaults)");
-	if (run_parser(&v_parser)) quit("Cannot initialize vaults");
-
-	/* Initialize history info */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (histories)");
-	if (run_parser(&h_parser)) quit("Cannot initialize histories");
-
-	/* Initialize race info */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (races)");
-	if (run_parser(&p_parser)) quit("Cannot initialize races");
-
-	/* Initialize class info */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (classes)");
-	if (run_parser(&c_parser)) quit("Cannot initialize classes");
-
-	/* Initialize flavor info */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (flavors)");
-	if (run_parser(&flavor_parser)) quit("Cannot initialize flavors");
-
-	/* Initialize spell info */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (spells)");
-	if (run_parser(&s_parser)) quit("Cannot initialize spells");
-
-	/* Initialize hint text */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (hints)");
-	if (run_parser(&hints_parser)) quit("Cannot initialize hints");
+	/* Save the larger arrays for next time */
+	if (!cached) cache_save();
 
 	/* Initialize spellbook info */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (spellbooks)");
+	init_part("Initializing arrays... (spellbooks)");
 	init_books();
 
 	/* Initialise store stocking data */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (store stocks)");
+	init_part("Initializing arrays... (store stocks)");
 	store_init();
 
-	/* Initialise random name data */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (random names)");
-	if (run_parser(&names_parser)) quit("Can't parse names");
-
 	/* Initialize some other arrays */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (other)");
+	init_part("Initializing arrays... (other)");
 	if (init_other()) quit("Cannot initialize other stuff");
 
 	/* Initialize some other arrays */
-	event_signal_string(EVENT_INITSTATUS, "Initializing arrays... (alloc)");
+	init_part("Initializing arrays... (alloc)");
 	if (init_alloc()) quit("Cannot initialize alloc stuff");
 
 	/*** Load default user pref files ***/
 
 	/* Initialize feature info */
-	event_signal_string(EVENT_INITSTATUS, "Loading basic user pref file...");
+	init_part("Loading basic user pref file...");
 
 	/* Process that file */
 	(void)process_pref_file("pref.prf", FALSE);
 
 	/* Done */
+	init_times_report();
+	init_memory_report();
 	event_signal_string(EVENT_INITSTATUS, "Initialization complete");
 
 	/* Sneakily init command list */
@@ -3672,6 +4553,9 @@ void cleanup_angband(void)
 	int i;
 
 
+	/* Finish writing any savefile */
+	old_save_wait();
+
 	/* Free the macros */
 	macro_free();
 
@@ -3683,6 +4567,9 @@ void cleanup_angband(void)
 	FREE(alloc_ego_table);
 	FREE(alloc_race_table);
 
+	/* Free the slay ratings */
+	free_slay_cache();
+
 	if (store)
 	{
 		/* Free the store inventories */
@@ -3693,6 +4580,7 @@ void cleanup_angband(void)
 
 			/* Free the store inventory */
 			FREE(st_ptr->stock);
+			FREE(st_ptr->stock_key);
 			FREE(st_ptr->table);
 		}
 	}
@@ -3709,18 +4597,24 @@ void cleanup_angband(void)
 	/* Free the lore, monster, and object lists */
 	FREE(l_list);
 	FREE(mon_list);
+	FREE(mon_live);
+	FREE(mon_hurt);
 	FREE(o_list);
 
-	/* Flow arrays */
-	FREE(cave_when);
-	FREE(cave_cost);
-
 	/* Free the cave */
-	FREE(cave_o_idx);
-	FREE(cave_m_idx);
-	FREE(cave_feat);
-	FREE(cave_info2);
-	FREE(cave_info);
+	FREE(cave);
+
+	/* Free the vaults, and the grid lists made for building them */
+	if (v_info)
+	{
+		for (i = 0; i < z_info->v_max; i++)
+		{
+			FREE(v_info[i].grids);
+			FREE(v_info[i].spawns);
+		}
+
+		FREE(v_info);
+	}
 
 	/* Free the "update_view()" array */
 	FREE(view_g);
@@ -3740,6 +4634,23 @@ void cleanup_angband(void)
 	mem_free(r_info);
 	mem_free(c_info);
 
+	/* Free the flag name hashes */
+	for (i = 0; i < FLAG_HASH_TABLES; i++)
+	{
+		mem_free(flag_hashes[i].slot);
+		WIPE(&flag_hashes[i], struct flag_hash);
+	}
+
+	/* Free the names and text from the edit files */
+	for (i = 0; i < (int)N_ELEMENTS(init_stages); i++)
+	{
+		arena_free(init_stages[i].strings);
+		init_stages[i].strings = NULL;
+	}
+
+	arena_free(init_strings);
+	init_strings = NULL;
+
 	/* Free the format() buffer */
 	vformat_kill();
 
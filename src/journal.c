@@ -0,0 +1,429 @@
+/*
+ * File: journal.c
+ * Purpose: Record the player's input, and play it back at full speed
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+#include "angband.h"
+#include "journal.h"
+#include "state-hash.h"
+
+/*
+ * A journal is every key and mouse press the port gives the game, noted
+ * with how many times the game had asked the port for input (a "poll":
+ * TERM_XTRA_EVENT or TERM_XTRA_FLUSH) when it came.  Everything the game
+ * does follows from its input and its RNG, so starting from the same
+ * savefile (or from the same point in a new game, since the RNG is in the
+ * journal too) and giving it the same input on the same polls plays the
+ * same game, however long the player took to press each key.
+ *
+ * Many commands never pass through the command queue, and many prompts
+ * are answered part way through one, so it is the input that is kept
+ * rather than the game_command structs.
+ *
+ * When playing back, the journal answers the polls in place of the port,
+ * skips delays, and leaves the terms unmapped so nothing is drawn.  When
+ * it runs out, the port takes over again.  Every JOURNAL_CHECK_KEYS keys
+ * the game's turn and state_hash() are recorded too, and checked when
+ * played back, to show where a replay went its own way.
+ *
+ * The file is "ANGJRNL1", the RNG and the game turn, then records of a tag
+ * byte, the polls since the last record (as a number of 7-bit groups, low
+ * first, with the top bit set on all but the last) and then:
+ *
+ *   'K' <key>
+ *   'M' <x> <y> <button>
+ *   'C' <turn, 4 bytes> <hash, 4 bytes>
+ *
+ * Multi-byte values are little-endian.
+ */
+#define JOURNAL_CHECK_KEYS	64
+
+static ang_file *journal_file;
+static bool journal_playing;
+
+/* Polls since the journal started, and at the last record */
+static u32b journal_polls;
+static u32b journal_last;
+
+/* Keys recorded or played, and the first turn which didn't match (or -1) */
+static u32b journal_keys;
+static s32b journal_bad_turn;
+
+/* The next record to play */
+static bool next_ok;
+static byte next_tag;
+static u32b next_poll;
+static u32b next_data[3];
+
+/* Whether each term was mapped before playing started */
+static bool journal_mapped[ANGBAND_TERM_MAX];
+
+
+/*** Reading and writing ***/
+
+static void journal_put_u32(u32b v)
+{
+	int i;
+
+	for (i = 0; i < 4; i++)
+		file_writec(journal_file, (byte)(v >> (8 * i)));
+}
+
+static bool journal_get_u32(u32b *v)
+{
+	byte b;
+	int i;
+
+	*v = 0;
+	for (i = 0; i < 4; i++)
+	{
+		if (!file_readc(journal_file, &b)) return FALSE;
+		*v |= (u32b)b << (8 * i);
+	}
+
+	return TRUE;
+}
+
+/*
+ * Start a record with tag `tag`
+ */
+static void journal_put_head(byte tag)
+{
+	u32b delta = journal_polls - journal_last;
+
+	file_writec(journal_file, tag);
+
+	while (delta >= 0x80)
+	{
+		file_writec(journal_file, (byte)(delta | 0x80));
+		delta >>= 7;
+	}
+	file_writec(journal_file, (byte)delta);
+
+	journal_last = journal_polls;
+}
+
+/*
+ * Read the next record to play, if there is one
+ */
+static void journal_get_next(void)
+{
+	u32b delta = 0;
+	int shift = 0;
+	byte b;
+	int i, n;
+
+	next_ok = FALSE;
+
+	if (!file_readc(journal_file, &next_tag)) return;
+
+	do
+	{
+		if (!file_readc(journal_file, &b)) return;
+		delta |= (u32b)(b & 0x7F) << shift;
+		shift += 7;
+	}
+	while ((b & 0x80) && (shift < 32));
+
+	next_poll += delta;
+
+	switch (next_tag)
+	{
+		case 'K': n = 1; break;
+		case 'M': n = 3; break;
+
+		case 'C':
+		{
+			if (!journal_get_u32(&next_data[0])) return;
+			if (!journal_get_u32(&next_data[1])) return;
+			next_ok = TRUE;
+			return;
+		}
+
+		default: return;
+	}
+
+	for (i = 0; i < n; i++)
+	{
+		if (!file_readc(journal_file, &b)) return;
+		next_data[i] = b;
+	}
+
+	next_ok = TRUE;
+}
+
+
+/*** Recording ***/
+
+/*
+ * Note a key or mouse press from the port
+ */
+static void journal_key(const ui_event_data *ke)
+{
+	if (journal_playing) return;
+
+	/* Check in every so often */
+	if (!(journal_keys % JOURNAL_CHECK_KEYS))
+	{
+		journal_put_head('C');
+		journal_put_u32((u32b)turn);
+		journal_put_u32(state_hash());
+	}
+
+	if (ke->type == EVT_MOUSE)
+	{
+		journal_put_head('M');
+		file_writec(journal_file, ke->mousex);
+		file_writec(journal_file, ke->mousey);
+		file_writec(journal_file, (byte)ke->index);
+	}
+	else
+	{
+		journal_put_head('K');
+		file_writec(journal_file, (byte)ke->key);
+	}
+
+	journal_keys++;
+}
+
+
+/*** Playing back ***/
+
+/*
+ * Note that the game has gone its own way, if it's the first time
+ */
+static void journal_differs(void)
+{
+	if (journal_bad_turn < 0) journal_bad_turn = turn;
+}
+
+/*
+ * Stop playing, and let the port be seen again
+ */
+static void journal_done(void)
+{
+	term *old = Term;
+	int i;
+
+	if (!journal_playing) return;
+	journal_playing = FALSE;
+
+	for (i = 0; i < ANGBAND_TERM_MAX; i++)
+	{
+		if (!angband_term[i]) continue;
+
+		Term_activate(angband_term[i]);
+		Term->mapped_flag = journal_mapped[i];
+		if (Term->mapped_flag) Term_redraw();
+	}
+
+	Term_activate(old);
+}
+
+/*
+ * Play the records due by this poll.  Those which are late (if the game
+ * asks for input more often than it did) are played at once, so it keeps
+ * going, and the game is noted as differing.  The poll after the last
+ * records, which the port answered when recording, goes back to the port.
+ */
+static void journal_play(void)
+{
+	if (!next_ok)
+	{
+		journal_done();
+		return;
+	}
+
+	while (next_ok && (next_poll <= journal_polls))
+	{
+		if (next_poll < journal_polls) journal_differs();
+
+		switch (next_tag)
+		{
+			case 'K':
+				Term_keypress(next_data[0]);
+				journal_keys++;
+				break;
+
+			case 'M':
+				Term_mousepress(next_data[0], next_data[1], next_data[2]);
+				journal_keys++;
+				break;
+
+			case 'C':
+				if ((next_data[0] != (u32b)turn) ||
+				    (next_data[1] != state_hash()))
+					journal_differs();
+				break;
+		}
+
+		journal_get_next();
+	}
+}
+
+/*
+ * Count polls, and stand in for the port while playing
+ */
+static bool journal_xtra(int n, int v)
+{
+	switch (n)
+	{
+		case TERM_XTRA_EVENT:
+		case TERM_XTRA_FLUSH:
+		{
+			journal_polls++;
+			if (!journal_playing) return FALSE;
+
+			journal_play();
+
+			/* Once it runs out, the port answers */
+			return journal_playing;
+		}
+
+		/* No waiting about */
+		case TERM_XTRA_DELAY:
+		case TERM_XTRA_BORED:
+			return journal_playing;
+	}
+
+	return FALSE;
+}
+
+
+/*** Starting and stopping ***/
+
+/*
+ * Start recording the player's input to file `name` in the user directory.
+ * Returns FALSE if it can't be opened.
+ */
+bool journal_record(const char *name)
+{
+	char buf[1024];
+	int i;
+
+	journal_stop();
+
+	path_build(buf, sizeof(buf), ANGBAND_DIR_USER, name);
+	journal_file = file_open(buf, MODE_WRITE, FTYPE_RAW);
+	if (!journal_file) return FALSE;
+
+	file_write(journal_file, "ANGJRNL1", 8);
+	file_writec(journal_file, Rand_quick ? 1 : 0);
+	journal_put_u32(Rand_value);
+	journal_put_u32(state_i);
+	for (i = 0; i < RAND_DEG; i++)
+		journal_put_u32(STATE[i]);
+	journal_put_u32((u32b)turn);
+
+	journal_polls = journal_last = 0;
+	journal_keys = 0;
+	journal_bad_turn = -1;
+
+	Term_xtra_journal = journal_xtra;
+	Term_key_journal = journal_key;
+
+	return TRUE;
+}
+
+/*
+ * Start playing back the input in file `name` in the user directory, from
+ * the same point in the game as it was recorded.  Returns FALSE if the
+ * file can't be opened or isn't a journal.
+ */
+bool journal_play_file(const char *name)
+{
+	char buf[1024];
+	byte quick;
+	u32b start_turn;
+	int i;
+
+	journal_stop();
+
+	path_build(buf, sizeof(buf), ANGBAND_DIR_USER, name);
+	journal_file = file_open(buf, MODE_READ, FTYPE_RAW);
+	if (!journal_file) return FALSE;
+
+	if ((file_read(journal_file, buf, 8) != 8) ||
+	    strncmp(buf, "ANGJRNL1", 8) || !file_readc(journal_file, &quick) ||
+	    !journal_get_u32(&Rand_value) || !journal_get_u32(&state_i))
+	{
+		journal_stop();
+		return FALSE;
+	}
+
+	for (i = 0; i < RAND_DEG; i++)
+		journal_get_u32(&STATE[i]);
+	journal_get_u32(&start_turn);
+
+	Rand_quick = quick ? TRUE : FALSE;
+	state_i %= RAND_DEG;
+
+	journal_polls = journal_last = 0;
+	journal_keys = 0;
+	journal_bad_turn = (start_turn == (u32b)turn) ? -1 : turn;
+
+	/* Nothing is shown while playing */
+	for (i = 0; i < ANGBAND_TERM_MAX; i++)
+	{
+		if (!angband_term[i]) continue;
+
+		journal_mapped[i] = angband_term[i]->mapped_flag;
+		angband_term[i]->mapped_flag = FALSE;
+	}
+
+	journal_playing = TRUE;
+	Term_xtra_journal = journal_xtra;
+	Term_key_journal = journal_key;
+
+	/* Play what came on the poll recording started in */
+	next_poll = 0;
+	journal_get_next();
+	journal_play();
+
+	return TRUE;
+}
+
+/*
+ * Stop recording or playing
+ */
+void journal_stop(void)
+{
+	journal_done();
+
+	Term_xtra_journal = NULL;
+	Term_key_journal = NULL;
+
+	if (journal_file)
+	{
+		file_close(journal_file);
+		journal_file = NULL;
+	}
+}
+
+/*
+ * Whether a journal is still being played
+ */
+bool journal_is_playing(void)
+{
+	return journal_playing;
+}
+
+/*
+ * How many keys have been recorded or played, and the first turn on which
+ * the game played back differed from the one recorded, or -1 if none did
+ */
+u32b journal_count(s32b *bad_turn)
+{
+	if (bad_turn) *bad_turn = journal_bad_turn;
+	return journal_keys;
+}
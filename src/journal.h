@@ -0,0 +1,12 @@
+/* journal.h - recording and playing back the player's input */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+extern bool journal_record(const char *name);
+extern bool journal_play_file(const char *name);
+extern void journal_stop(void);
+extern bool journal_is_playing(void);
+extern u32b journal_count(s32b *bad_turn);
+
+#endif /* !JOURNAL_H */
@@ -0,0 +1,383 @@
+/*
+ * File: level-cache.c
+ * Purpose: Keep the levels the player leaves, to be returned to
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+#include "angband.h"
+#include "cave.h"
+#include "generate.h"
+#include "history.h"
+#include "level-cache.h"
+#include "monster/monster.h"
+#include "savefile.h"
+
+/*
+ * With the "adult_persist" option, the level the player leaves is kept as
+ * its "dungeon", "objects" and "monsters" savefile blocks, so it gets the
+ * savefile's run-length encoding and compression of the cave and is read
+ * back by the savefile's own loaders.  Going back to that depth restores it
+ * in place of generating a new level.
+ *
+ * Only one level is kept for each depth, and only LEVEL_CACHE_BYTES of them
+ * in all; past that the level left longest ago is forgotten.  Kept levels
+ * go into the savefile too, in the "levels" block.
+ *
+ * While a level is kept its uniques still count as alive and its artifacts
+ * as created, so that neither can turn up anywhere else.  When it is
+ * forgotten they are let go, just as if it had been left for good.
+ */
+#define LEVEL_CACHE_BYTES	(1024L * 1024L)
+
+/*
+ * An artifact on a kept level
+ */
+struct kept_artifact
+{
+	byte a_idx;
+	bool sensed;	/* Whether it would be lost, rather than preserved */
+};
+
+/*
+ * A kept level
+ */
+struct kept_level
+{
+	byte *data;		/* Savefile blocks, or NULL if none is kept */
+	u32b len;
+	u32b bytes;		/* Memory used, including the lists below */
+
+	u32b stamp;		/* When it was left */
+	byte feeling;
+
+	s16b *uniques;		/* Races of the uniques on it */
+	u16b n_uniques;
+
+	struct kept_artifact *artifacts;
+	u16b n_artifacts;
+};
+
+static struct kept_level kept_levels[MAX_DEPTH];
+
+/* Memory used by kept levels, and the last stamp given out */
+static u32b kept_bytes;
+static u32b kept_stamp;
+
+/*
+ * The objects and monsters on the current level are kept; wipe_o_list() and
+ * wipe_mon_list() then leave its artifacts and uniques accounted for.
+ */
+bool level_kept;
+
+
+/*
+ * Count the memory used by kept level `k`
+ */
+static void level_count(struct kept_level *k)
+{
+	k->bytes = k->len + k->n_uniques * sizeof(s16b) +
+			k->n_artifacts * sizeof(struct kept_artifact);
+	kept_bytes += k->bytes;
+}
+
+/*
+ * Free kept level `k`, leaving its uniques and artifacts as they were
+ */
+static void level_free(struct kept_level *k)
+{
+	if (!k->data) return;
+
+	kept_bytes -= k->bytes;
+
+	mem_free(k->data);
+	FREE(k->uniques);
+	FREE(k->artifacts);
+	WIPE(k, struct kept_level);
+}
+
+/*
+ * Forget kept level `k` for good, letting go of its uniques and artifacts
+ * in the same way as wipe_o_list() and wipe_mon_list() do on leaving a
+ * level.
+ */
+static void level_forget(struct kept_level *k)
+{
+	int i;
+
+	for (i = 0; i < k->n_uniques; i++)
+		r_info[k->uniques[i]].cur_num--;
+
+	if (k->n_uniques) get_mon_num_reset();
+
+	for (i = 0; i < k->n_artifacts; i++)
+	{
+		const struct kept_artifact *a = &k->artifacts[i];
+
+		if (!OPT(adult_no_preserve) && !a->sensed)
+			a_info[a->a_idx].created = FALSE;
+		else
+			history_lose_artifact(a->a_idx);
+	}
+
+	level_free(k);
+}
+
+
+/*
+ * Keep the current level, which the player is about to leave
+ */
+void level_cache_store(void)
+{
+	struct kept_level *k;
+	int i, n;
+
+	/* Only dungeon levels, and only once */
+	if (!character_dungeon || !p_ptr->depth || level_kept) return;
+
+	k = &kept_levels[p_ptr->depth];
+	level_forget(k);
+
+	k->data = savefile_save_level(&k->len);
+	if (!k->data) return;
+
+	/* Saving compacted the lists, so everything in them is real */
+	for (n = 0, i = 1; i < mon_max; i++)
+		if (rf_has(r_info[mon_list[i].r_idx].flags, RF_UNIQUE)) n++;
+
+	k->uniques = C_ZNEW(MAX(n, 1), s16b);
+	for (i = 1; i < mon_max; i++)
+		if (rf_has(r_info[mon_list[i].r_idx].flags, RF_UNIQUE))
+			k->uniques[k->n_uniques++] = mon_list[i].r_idx;
+
+	for (n = 0, i = 1; i < o_max; i++)
+		if (artifact_of(&o_list[i])) n++;
+
+	k->artifacts = C_ZNEW(MAX(n, 1), struct kept_artifact);
+	for (i = 1; i < o_max; i++)
+	{
+		struct kept_artifact *a = &k->artifacts[k->n_artifacts];
+
+		if (!artifact_of(&o_list[i])) continue;
+
+		a->a_idx = o_list[i].name1;
+		a->sensed = object_was_sensed(&o_list[i]);
+		k->n_artifacts++;
+	}
+
+	k->feeling = feeling;
+	k->stamp = ++kept_stamp;
+	level_count(k);
+
+	level_kept = TRUE;
+
+	/* Forget the levels left longest ago until the rest fit */
+	while (kept_bytes > LEVEL_CACHE_BYTES)
+	{
+		struct kept_level *oldest = NULL;
+
+		for (i = 1; i < MAX_DEPTH; i++)
+		{
+			if (!kept_levels[i].data || (i == p_ptr->depth)) continue;
+			if (!oldest || (kept_levels[i].stamp < oldest->stamp))
+				oldest = &kept_levels[i];
+		}
+
+		if (!oldest) break;
+		level_forget(oldest);
+	}
+}
+
+
+/*
+ * Bring back the level kept for `depth` in place of the current one,
+ * returning FALSE if there isn't one (or it can't be read), in which case
+ * a new level must be generated.
+ */
+bool level_cache_restore(int depth)
+{
+	struct kept_level *k;
+	u16b old_daycount = daycount;
+	bool ok;
+	int i;
+
+	if ((depth <= 0) || (depth >= MAX_DEPTH)) return FALSE;
+
+	k = &kept_levels[depth];
+	if (!k->data) return FALSE;
+
+	/* Leave the current level, as generation would */
+	clear_cave();
+	character_dungeon = FALSE;
+
+	/* The uniques are counted again as they're placed */
+	for (i = 0; i < k->n_uniques; i++)
+		r_info[k->uniques[i]].cur_num--;
+
+	k->n_uniques = 0;
+
+	ok = savefile_load_level(k->data, k->len) && p_ptr->py;
+
+	/* The time away from town isn't part of the level */
+	daycount = old_daycount;
+
+	if (!ok)
+	{
+		level_forget(k);
+		return FALSE;
+	}
+
+	feeling = k->feeling;
+
+	/* The artifacts are back on the level */
+	k->n_artifacts = 0;
+	level_free(k);
+
+	return TRUE;
+}
+
+
+/*
+ * Throw away every kept level, for a new character
+ */
+void level_cache_wipe(void)
+{
+	int i;
+
+	for (i = 1; i < MAX_DEPTH; i++)
+		level_free(&kept_levels[i]);
+
+	level_kept = FALSE;
+}
+
+
+/*
+ * Write the kept levels to the savefile
+ */
+void wr_levels(void)
+{
+	int depth, i;
+	u16b count = 0;
+
+	if (p_ptr->is_dead)
+		return;
+
+	for (depth = 1; depth < MAX_DEPTH; depth++)
+		if (kept_levels[depth].data) count++;
+
+	wr_u16b(count);
+
+	for (depth = 1; depth < MAX_DEPTH; depth++)
+	{
+		const struct kept_level *k = &kept_levels[depth];
+
+		if (!k->data) continue;
+
+		wr_u16b(depth);
+		wr_u32b(k->stamp);
+		wr_byte(k->feeling);
+
+		wr_u32b(k->len);
+		wr_bytes(k->data, k->len);
+
+		wr_u16b(k->n_uniques);
+		for (i = 0; i < k->n_uniques; i++)
+			wr_s16b(k->uniques[i]);
+
+		wr_u16b(k->n_artifacts);
+		for (i = 0; i < k->n_artifacts; i++)
+		{
+			wr_byte(k->artifacts[i].a_idx);
+			wr_byte(k->artifacts[i].sensed);
+		}
+	}
+}
+
+
+/*
+ * Read the kept levels from the savefile
+ */
+int rd_levels(u32b version)
+{
+	u16b count, depth, n;
+	u32b j;
+	int i;
+	byte tmp8u;
+
+	if (p_ptr->is_dead)
+		return 0;
+
+	rd_u16b(&count);
+
+	while (count--)
+	{
+		struct kept_level *k;
+
+		rd_u16b(&depth);
+		if ((depth < 1) || (depth >= MAX_DEPTH))
+		{
+			note(format("Bad kept level depth (%d)!", depth));
+			return (-1);
+		}
+
+		k = &kept_levels[depth];
+		level_free(k);
+
+		rd_u32b(&k->stamp);
+		rd_byte(&k->feeling);
+
+		rd_u32b(&k->len);
+		k->data = mem_alloc(MAX(k->len, 1));
+		for (j = 0; j < k->len; j++)
+			rd_byte(&k->data[j]);
+
+		rd_u16b(&n);
+		k->uniques = C_ZNEW(MAX(n, 1), s16b);
+		for (i = 0; i < n; i++)
+		{
+			rd_s16b(&k->uniques[i]);
+			if ((k->uniques[i] <= 0) || (k->uniques[i] >= z_info->r_max))
+			{
+				note(format("Bad kept monster race (%d)!", k->uniques[i]));
+				return (-1);
+			}
+
+			/* Still alive */
+			r_info[k->uniques[i]].cur_num++;
+			k->n_uniques++;
+		}
+
+		rd_u16b(&n);
+		k->artifacts = C_ZNEW(MAX(n, 1), struct kept_artifact);
+		for (i = 0; i < n; i++)
+		{
+			rd_byte(&k->artifacts[i].a_idx);
+			rd_byte(&tmp8u);
+			k->artifacts[i].sensed = tmp8u ? TRUE : FALSE;
+
+			if (!k->artifacts[i].a_idx ||
+			    (k->artifacts[i].a_idx >= z_info->a_max))
+			{
+				note(format("Bad kept artifact (%d)!", k->artifacts[i].a_idx));
+				return (-1);
+			}
+
+			k->n_artifacts++;
+		}
+
+		level_count(k);
+		kept_stamp = MAX(kept_stamp, k->stamp);
+	}
+
+	get_mon_num_reset();
+
+	return 0;
+}
@@ -0,0 +1,12 @@
+/* level-cache.h - levels kept to be returned to */
+
+#ifndef LEVEL_CACHE_H
+#define LEVEL_CACHE_H
+
+extern bool level_kept;
+
+extern void level_cache_store(void);
+extern bool level_cache_restore(int depth);
+extern void level_cache_wipe(void);
+
+#endif /* !LEVEL_CACHE_H */
@@ -630,6 +630,9 @@ static int rd_monster_memory(void)
 		/* Repair the spell lore flags */
 		rsf_inter(l_ptr->spell_flags, r_ptr->spell_flags);
 	}
+
+	/* Unique monsters may have died */
+	get_mon_num_reset();
 	
 	return 0;
 }
@@ -976,6 +979,10 @@ static int rd_squelch(void)
 	{
 	}
 	
+	/* Forget any inscriptions from before */
+	for (i = 0; i < z_info->k_max; i++)
+		k_info[i].note = 0;
+
 	/* Read the current number of auto-inscriptions */
 	rd_u16b(&inscriptions_count);
 	
@@ -988,6 +995,11 @@ static int rd_squelch(void)
 		rd_string(tmp, sizeof(tmp));
 		
 		inscriptions[i].inscription_idx = quark_add(tmp);
+
+		if ((inscriptions[i].kind_idx > 0) &&
+				(inscriptions[i].kind_idx < z_info->k_max))
+			k_info[inscriptions[i].kind_idx].note =
+				inscriptions[i].inscription_idx;
 	}
 	
 	return 0;
@@ -1468,6 +1480,10 @@ static int rd_dungeon(void)
 		return (1);
 	}
 
+	/* Old savefiles always have full-sized levels */
+	cave->height = DUNGEON_HGT;
+	cave->width = DUNGEON_WID;
+
 
 	/*** Run length decoding ***/
 
@@ -1482,7 +1498,7 @@ static int rd_dungeon(void)
 		for (i = count; i > 0; i--)
 		{
 			/* Extract "info" */
-			cave_info[y][x] = tmp8u;
+			cave->grid[y][x].info = tmp8u;
 
 			/* Advance/Wrap */
 			if (++x >= DUNGEON_WID)
@@ -1507,7 +1523,7 @@ static int rd_dungeon(void)
 		for (i = count; i > 0; i--)
 		{
 			/* Extract "info" */
-			cave_info2[y][x] = tmp8u;
+			cave->grid[y][x].info2 = tmp8u;
 
 			/* Advance/Wrap */
 			if (++x >= DUNGEON_WID)
@@ -1590,7 +1606,7 @@ static int rd_objects(void)
 	rd_u16b(&limit);
 
 	/* Verify maximum */
-	if (limit > z_info->o_max)
+	if (!o_list_grow(limit))
 	{
 		note(format("Too many (%d) object entries!", limit));
 		return (-1);
@@ -1644,10 +1660,10 @@ static int rd_objects(void)
 			/* ToDo: Verify coordinates */
 
 			/* Link the object to the pile */
-			o_ptr->next_o_idx = cave_o_idx[y][x];
+			o_ptr->next_o_idx = cave->grid[y][x].o_idx;
 
 			/* Link the floor to the object */
-			cave_o_idx[y][x] = o_idx;
+			cave->grid[y][x].o_idx = o_idx;
 		}
 	}
 
@@ -1668,7 +1684,7 @@ static int rd_monsters(void)
 	rd_u16b(&limit);
 
 	/* Hack -- verify */
-	if (limit > z_info->m_max)
+	if (!mon_list_grow(limit))
 	{
 		note(format("Too many (%d) monster entries!", limit));
 		return (-1);
@@ -37,8 +37,6 @@ static int rd_item(object_type *o_ptr)
 	byte tmp8u;
 	u16b tmp16u;
 
-	size_t i;
-
 	object_kind *k_ptr;
 
 	char buf[128];
@@ -109,18 +107,15 @@ static int rd_item(object_type *o_ptr)
 	rd_u16b(&o_ptr->origin_xtra);
 
 	/* Hack - XXX - MarbleDice - Maximum saveable flags = 96 */
-	for (i = 0; i < 12 && i < OF_SIZE; i++)
-		rd_byte(&o_ptr->flags[i]);
-	if (i < 12) strip_bytes(12 - i);
-	
+	rd_bytes(o_ptr->flags, MIN(12, OF_SIZE));
+	if (OF_SIZE < 12) strip_bytes(12 - OF_SIZE);
 
 	memset(&o_ptr->known_flags, 0, sizeof(o_ptr->known_flags));
 	if (ver > 4)
 	{
 		/* Hack - XXX - MarbleDice - Maximum saveable flags = 96 */
-		for (i = 0; i < 12 && i < OF_SIZE; i++)
-			rd_byte(&o_ptr->known_flags[i]);
-		if (i < 12) strip_bytes(12 - i);
+		rd_bytes(o_ptr->known_flags, MIN(12, OF_SIZE));
+		if (OF_SIZE < 12) strip_bytes(12 - OF_SIZE);
 	}
 	else if (ver > 2)
 	{
@@ -456,7 +451,11 @@ int rd_messages(u32b version)
 
 
 
-int rd_monster_memory(u32b version)
+/*
+ * Read the monster memory from before version 2 of the block, which had
+ * every race in full
+ */
+static int rd_monster_memory_1(void)
 {
 	int r_idx;
 	u16b tmp16u;
@@ -524,11 +523,122 @@ int rd_monster_memory(u32b version)
 		/* Repair the spell lore flags */
 		rsf_inter(l_ptr->spell_flags, r_ptr->spell_flags);
 	}
+
+	/* Unique monsters may have died */
+	get_mon_num_reset();
 	
 	return 0;
 }
 
 
+/*
+ * Read `n` bytes of flags saved with `saved` bytes in the set
+ */
+static void rd_lore_flags(bitflag *flags, size_t n, size_t saved)
+{
+	size_t i;
+
+	for (i = 0; i < saved && i < n; i++)
+		rd_byte(&flags[i]);
+	if (i < saved) strip_bytes(saved - i);
+}
+
+int rd_monster_memory(u32b version)
+{
+	int r_idx;
+	u16b r_max, n, i;
+	byte rf_size, rsf_size;
+
+	if (version < 2) return rd_monster_memory_1();
+
+	rd_u16b(&r_max);
+	rd_byte(&rf_size);
+	rd_byte(&rsf_size);
+	rd_u16b(&n);
+
+	/* Incompatible save files */
+	if (r_max > z_info->r_max)
+	{
+		note(format("Too many (%u) monster races!", r_max));
+		return (-1);
+	}
+
+	/* Races without an entry know nothing */
+	for (r_idx = 0; r_idx < z_info->r_max; r_idx++)
+	{
+		WIPE(&l_list[r_idx], monster_lore);
+		r_info[r_idx].max_num = lore_default_max_num(r_idx);
+	}
+
+	for (i = 0; i < n; i++)
+	{
+		monster_race *r_ptr;
+		monster_lore *l_ptr;
+		u16b idx;
+		byte parts;
+		size_t j;
+
+		rd_u16b(&idx);
+		rd_byte(&parts);
+
+		if (idx >= r_max)
+		{
+			note(format("Bad monster race (%u)!", idx));
+			return (-1);
+		}
+
+		r_ptr = &r_info[idx];
+		l_ptr = &l_list[idx];
+
+		if (parts & LORE_COUNTS)
+		{
+			rd_s16b(&l_ptr->sights);
+			rd_s16b(&l_ptr->deaths);
+			rd_s16b(&l_ptr->pkills);
+			rd_s16b(&l_ptr->tkills);
+		}
+
+		if (parts & LORE_WAKE)
+		{
+			rd_byte(&l_ptr->wake);
+			rd_byte(&l_ptr->ignore);
+		}
+
+		if (parts & LORE_DROPS)
+		{
+			rd_byte(&l_ptr->drop_gold);
+			rd_byte(&l_ptr->drop_item);
+		}
+
+		if (parts & LORE_CASTS)
+		{
+			rd_byte(&l_ptr->cast_innate);
+			rd_byte(&l_ptr->cast_spell);
+		}
+
+		if (parts & LORE_BLOWS)
+			for (j = 0; j < MONSTER_BLOW_MAX; j++)
+				rd_byte(&l_ptr->blows[j]);
+
+		if (parts & LORE_FLAGS)
+			rd_lore_flags(l_ptr->flags, RF_SIZE, rf_size);
+		if (parts & LORE_SPELLS)
+			rd_lore_flags(l_ptr->spell_flags, RSF_SIZE, rsf_size);
+
+		if (parts & LORE_MAX_NUM)
+			rd_byte(&r_ptr->max_num);
+
+		/* Repair the spell lore flags */
+		rsf_inter(l_ptr->spell_flags, r_ptr->spell_flags);
+	}
+
+	/* Unique monsters may have died */
+	get_mon_num_reset();
+
+	return 0;
+}
+
+
 int rd_object_memory(u32b version)
 {
 	int i;
@@ -688,8 +798,6 @@ static u32b randart_version;
  */
 int rd_player(u32b version)
 {
-	int i;
-
 	byte num;
 
 
@@ -741,9 +849,9 @@ int rd_player(u32b version)
 	rd_s16b(&p_ptr->wt);
 
 	/* Read the stat info */
-	for (i = 0; i < A_MAX; i++) rd_s16b(&p_ptr->stat_max[i]);
-	for (i = 0; i < A_MAX; i++) rd_s16b(&p_ptr->stat_cur[i]);
-	for (i = 0; i < A_MAX; i++) rd_s16b(&p_ptr->stat_birth[i]);
+	rd_s16b_array(p_ptr->stat_max, A_MAX);
+	rd_s16b_array(p_ptr->stat_cur, A_MAX);
+	rd_s16b_array(p_ptr->stat_birth, A_MAX);
 
 	rd_s16b(&p_ptr->ht_birth);
 	rd_s16b(&p_ptr->wt_birth);
@@ -804,8 +912,7 @@ int rd_player(u32b version)
 	if (num <= TMD_MAX)
 	{
 		/* Read all the effects */
-		for (i = 0; i < num; i++)
-			rd_s16b(&p_ptr->timed[i]);
+		rd_s16b_array(p_ptr->timed, num);
 
 		/* Initialize any entries not read */
 		if (num < TMD_MAX)
@@ -814,8 +921,7 @@ int rd_player(u32b version)
 	else
 	{
 		/* Probably in trouble anyway */
-		for (i = 0; i < TMD_MAX; i++)
-			rd_s16b(&p_ptr->timed[i]);
+		rd_s16b_array(p_ptr->timed, TMD_MAX);
 
 		/* Discard unused entries */
 		strip_bytes(2 * (num - TMD_MAX));
@@ -872,6 +978,10 @@ int rd_squelch(u32b version)
 		}
 	}
 	
+	/* Forget any inscriptions from before */
+	for (i = 0; i < z_info->k_max; i++)
+		k_info[i].note = 0;
+
 	/* Read the current number of auto-inscriptions */
 	rd_u16b(&inscriptions_count);
 	
@@ -884,6 +994,11 @@ int rd_squelch(u32b version)
 		rd_string(tmp, sizeof(tmp));
 		
 		inscriptions[i].inscription_idx = quark_add(tmp);
+
+		if ((inscriptions[i].kind_idx > 0) &&
+				(inscriptions[i].kind_idx < z_info->k_max))
+			k_info[inscriptions[i].kind_idx].note =
+				inscriptions[i].inscription_idx;
 	}
 	
 	return 0;
@@ -900,8 +1015,11 @@ int rd_misc(u32b version)
 	/* Read the randart seed */
 	rd_u32b(&seed_randart);
 
+	/* Read the dungeon level seed (zero in older savefiles) */
+	rd_u32b(&seed_dungeon);
+
 	/* Skip the flags */
-	strip_bytes(12);
+	strip_bytes(8);
 
 
 	/* Hack -- the two "special seeds" */
@@ -934,7 +1052,6 @@ int rd_misc(u32b version)
 
 int rd_player_hp(u32b version)
 {
-	int i;
 	u16b tmp16u;
 
 	/* Read the player_hp array */
@@ -948,8 +1065,7 @@ int rd_player_hp(u32b version)
 	}
 
 	/* Read the player_hp array */
-	for (i = 0; i < tmp16u; i++)
-		rd_s16b(&p_ptr->player_hp[i]);
+	rd_s16b_array(p_ptr->player_hp, tmp16u);
 
 	return 0;
 }
@@ -957,11 +1073,8 @@ int rd_player_hp(u32b version)
 
 int rd_player_spells(u32b version)
 {
-	int i;
 	u16b tmp16u;
 	
-	int cnt;
-	
 	/* Read the number of spells */
 	rd_u16b(&tmp16u);
 	if (tmp16u > PY_MAX_SPELLS)
@@ -971,12 +1084,10 @@ int rd_player_spells(u32b version)
 	}
 	
 	/* Read the spell flags */
-	for (i = 0; i < tmp16u; i++)
-		rd_byte(&p_ptr->spell_flags[i]);
+	rd_bytes(p_ptr->spell_flags, tmp16u);
 	
 	/* Read the spell order */
-	for (i = 0, cnt = 0; i < tmp16u; i++, cnt++)
-		rd_byte(&p_ptr->spell_order[cnt]);
+	rd_bytes(p_ptr->spell_order, tmp16u);
 	
 	/* Success */
 	return (0);
@@ -988,7 +1099,7 @@ int rd_player_spells(u32b version)
  */
 int rd_randarts(u32b version)
 {
-	size_t i, j;
+	size_t i;
 	byte tmp8u;
 	s16b tmp16s;
 	u16b tmp16u;
@@ -1068,9 +1179,8 @@ int rd_randarts(u32b version)
 				rd_s32b(&a_ptr->cost);
 
 				/* Hack - XXX - MarbleDice - Maximum saveable flags = 96 */
-				for (j = 0; j < 12 && j < OF_SIZE; j++)
-					rd_byte(&a_ptr->flags[j]);
-				if (j < 12) strip_bytes(OF_SIZE - j);
+				rd_bytes(a_ptr->flags, MIN(12, OF_SIZE));
+				if (OF_SIZE < 12) strip_bytes(12 - OF_SIZE);
 
 				rd_byte(&a_ptr->level);
 				rd_byte(&a_ptr->rarity);
@@ -1297,15 +1407,85 @@ int rd_stores(u32b version)
 
 
 
+/*
+ * Read the cave of newer savefiles: the run-length encoding of the
+ * cave_info flags, cave_info2 and the features, compressed.
+ */
+static int rd_dungeon_runs(void)
+{
+	u32b len;
+	byte *runs;
+	size_t pos = 0;
+	int plane;
+
+	rd_u32b(&len);
+
+	/* At worst every grid starts a new run in each plane */
+	if (!len || (len > (u32b)(3 * 2 * cave->height * cave->width)))
+		return (-1);
+
+	runs = mem_alloc(len);
+	if (rd_compressed(runs, len))
+	{
+		mem_free(runs);
+		return (-1);
+	}
+
+	for (plane = 0; plane < 3; plane++)
+	{
+		int y = 0, x = 0;
+
+		while (y < cave->height)
+		{
+			byte count, tmp8u;
+
+			if (pos + 2 > len)
+			{
+				mem_free(runs);
+				return (-1);
+			}
+
+			/* Grab RLE info */
+			count = runs[pos++];
+			tmp8u = runs[pos++];
+
+			/* Apply the RLE info */
+			for (; count > 0; count--)
+			{
+				if (plane == 0)
+					cave->grid[y][x].info = tmp8u;
+				else if (plane == 1)
+					cave->grid[y][x].info2 = tmp8u;
+				else
+					cave_set_feat(y, x, tmp8u);
+
+				/* Advance/Wrap */
+				if (++x >= cave->width)
+				{
+					/* Wrap */
+					x = 0;
+
+					/* Advance/Wrap */
+					if (++y >= cave->height) break;
+				}
+			}
+		}
+	}
+
+	mem_free(runs);
+
+	return (0);
+}
+
+
 /*
  * Read the dungeon
  *
  * The monsters/objects must be loaded in the same order
  * that they were stored, since the actual indexes matter.
  *
- * Note that the size of the dungeon is now hard-coded to
- * DUNGEON_HGT by DUNGEON_WID, and any dungeon with another
- * size will be silently discarded by this routine.
+ * Note that a dungeon bigger than DUNGEON_HGT by DUNGEON_WID will be
+ * silently discarded by this routine.
  *
  * Note that dungeon objects, including objects held by monsters, are
  * placed directly into the dungeon, using "object_copy()", which will
@@ -1352,7 +1532,8 @@ int rd_dungeon(u32b version)
 	}
 
 	/* Ignore illegal dungeons */
-	if ((ymax != DUNGEON_HGT) || (xmax != DUNGEON_WID))
+	if ((ymax < 1) || (ymax > DUNGEON_HGT) ||
+	    (xmax < 1) || (xmax > DUNGEON_WID))
 	{
 		/* XXX XXX XXX */
 		note(format("Ignoring illegal dungeon size (%d,%d).", ymax, xmax));
@@ -1360,90 +1541,109 @@ int rd_dungeon(u32b version)
 	}
 
 	/* Ignore illegal dungeons */
-	if ((px < 0) || (px >= DUNGEON_WID) ||
-	    (py < 0) || (py >= DUNGEON_HGT))
+	if ((px < 0) || (px >= xmax) ||
+	    (py < 0) || (py >= ymax))
 	{
 		note(format("Ignoring illegal player location (%d,%d).", py, px));
 		return (1);
 	}
 
 
+	/* The level is this size */
+	cave->height = ymax;
+	cave->width = xmax;
+
+
 	/*** Run length decoding ***/
 
-	/* Load the dungeon data */
-	for (x = y = 0; y < DUNGEON_HGT; )
+	/* Newer savefiles compress the runs */
+	if (version >= 2)
 	{
-		/* Grab RLE info */
-		rd_byte(&count);
-		rd_byte(&tmp8u);
+		if (rd_dungeon_runs())
+		{
+			note("Damaged dungeon data!");
+			return (-1);
+		}
+	}
 
-		/* Apply the RLE info */
-		for (i = count; i > 0; i--)
+	/* Older ones store them as they are */
+	else
+	{
+		/* Load the dungeon data */
+		for (x = y = 0; y < cave->height; )
 		{
-			/* Extract "info" */
-			cave_info[y][x] = tmp8u;
+			/* Grab RLE info */
+			rd_byte(&count);
+			rd_byte(&tmp8u);
 
-			/* Advance/Wrap */
-			if (++x >= DUNGEON_WID)
+			/* Apply the RLE info */
+			for (i = count; i > 0; i--)
 			{
-				/* Wrap */
-				x = 0;
+				/* Extract "info" */
+				cave->grid[y][x].info = tmp8u;
 
 				/* Advance/Wrap */
-				if (++y >= DUNGEON_HGT) break;
+				if (++x >= cave->width)
+				{
+					/* Wrap */
+					x = 0;
+
+					/* Advance/Wrap */
+					if (++y >= cave->height) break;
+				}
 			}
 		}
-	}
-
-	/* Load the dungeon data */
-	for (x = y = 0; y < DUNGEON_HGT; )
-	{
-		/* Grab RLE info */
-		rd_byte(&count);
-		rd_byte(&tmp8u);
 
-		/* Apply the RLE info */
-		for (i = count; i > 0; i--)
+		/* Load the dungeon data */
+		for (x = y = 0; y < cave->height; )
 		{
-			/* Extract "info" */
-			cave_info2[y][x] = tmp8u;
+			/* Grab RLE info */
+			rd_byte(&count);
+			rd_byte(&tmp8u);
 
-			/* Advance/Wrap */
-			if (++x >= DUNGEON_WID)
+			/* Apply the RLE info */
+			for (i = count; i > 0; i--)
 			{
-				/* Wrap */
-				x = 0;
+				/* Extract "info" */
+				cave->grid[y][x].info2 = tmp8u;
 
 				/* Advance/Wrap */
-				if (++y >= DUNGEON_HGT) break;
+				if (++x >= cave->width)
+				{
+					/* Wrap */
+					x = 0;
+
+					/* Advance/Wrap */
+					if (++y >= cave->height) break;
+				}
 			}
 		}
-	}
-
 
-	/*** Run length decoding ***/
 
-	/* Load the dungeon data */
-	for (x = y = 0; y < DUNGEON_HGT; )
-	{
-		/* Grab RLE info */
-		rd_byte(&count);
-		rd_byte(&tmp8u);
+		/*** Run length decoding ***/
 
-		/* Apply the RLE info */
-		for (i = count; i > 0; i--)
+		/* Load the dungeon data */
+		for (x = y = 0; y < cave->height; )
 		{
-			/* Extract "feat" */
-			cave_set_feat(y, x, tmp8u);
+			/* Grab RLE info */
+			rd_byte(&count);
+			rd_byte(&tmp8u);
 
-			/* Advance/Wrap */
-			if (++x >= DUNGEON_WID)
+			/* Apply the RLE info */
+			for (i = count; i > 0; i--)
 			{
-				/* Wrap */
-				x = 0;
+				/* Extract "feat" */
+				cave_set_feat(y, x, tmp8u);
 
 				/* Advance/Wrap */
-				if (++y >= DUNGEON_HGT) break;
+				if (++x >= cave->width)
+				{
+					/* Wrap */
+					x = 0;
+
+					/* Advance/Wrap */
+					if (++y >= cave->height) break;
+				}
 			}
 		}
 	}
@@ -1489,7 +1689,7 @@ int rd_objects(u32b version)
 	rd_u16b(&limit);
 
 	/* Verify maximum */
-	if (limit > z_info->o_max)
+	if (!o_list_grow(limit))
 	{
 		note(format("Too many (%d) object entries!", limit));
 		return (-1);
@@ -1543,10 +1743,10 @@ int rd_objects(u32b version)
 			/* ToDo: Verify coordinates */
 
 			/* Link the object to the pile */
-			o_ptr->next_o_idx = cave_o_idx[y][x];
+			o_ptr->next_o_idx = cave->grid[y][x].o_idx;
 
 			/* Link the floor to the object */
-			cave_o_idx[y][x] = o_idx;
+			cave->grid[y][x].o_idx = o_idx;
 		}
 	}
 
@@ -1567,7 +1767,7 @@ int rd_monsters(u32b version)
 	rd_u16b(&limit);
 
 	/* Hack -- verify */
-	if (limit > z_info->m_max)
+	if (!mon_list_grow(limit))
 	{
 		note(format("Too many (%d) monster entries!", limit));
 		return (-1);
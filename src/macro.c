@@ -17,23 +17,52 @@ char **macro__pat;
 char **macro__act;
 static bool macro__use[256];
 
+/*
+ * The macros in order of their patterns (by strcmp()), so that lookups
+ * can binary search rather than scan.  Every pattern which starts with a
+ * given string comes straight after it (or where it would be) in this
+ * order.
+ */
+static s16b *macro__order;
+
+
+/*
+ * Return the position in macro__order of the first pattern which is not
+ * less than "pat" (macro__num if there is none)
+ */
+static int macro_lower_bound(cptr pat)
+{
+	int lo = 0, hi = macro__num;
+
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+
+		if (strcmp(macro__pat[macro__order[mid]], pat) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+
 /*
  * Find the macro (if any) which exactly matches the given pattern
  */
 int macro_find_exact(cptr pat)
 {
-	int i;
+	int pos;
 
 	/* Nothing possible */
 	if (!macro__use[(byte)(pat[0])])
 		return -1;
 
-	/* Scan the macros */
-	for (i = 0; i < macro__num; ++i)
-	{
-		if (streq(macro__pat[i], pat))
-			return i;
-	}
+	pos = macro_lower_bound(pat);
+
+	if ((pos < macro__num) && streq(macro__pat[macro__order[pos]], pat))
+		return macro__order[pos];
 
 	/* No matches */
 	return -1;
@@ -41,22 +70,21 @@ int macro_find_exact(cptr pat)
 
 
 /*
- * Find the first macro (if any) which contains the given pattern
+ * Find a macro (if any) which contains the given pattern
  */
 int macro_find_check(cptr pat)
 {
-	int i;
+	int pos;
 
 	/* Nothing possible */
 	if (!macro__use[(byte)(pat[0])])
 		return -1;
 
-	/* Scan the macros */
-	for (i = 0; i < macro__num; ++i)
-	{
-		if (prefix(macro__pat[i], pat))
-			return i;
-	}
+	/* The first pattern at or after "pat" is the only one to check */
+	pos = macro_lower_bound(pat);
+
+	if ((pos < macro__num) && prefix(macro__pat[macro__order[pos]], pat))
+		return macro__order[pos];
 
 	/* Nothing */
 	return -1;
@@ -64,22 +92,24 @@ int macro_find_check(cptr pat)
 
 
 /*
- * Find the first macro (if any) which contains the given pattern and more
+ * Find a macro (if any) which contains the given pattern and more
  */
 int macro_find_maybe(cptr pat)
 {
-	int i;
+	int pos;
 
 	/* Nothing possible */
 	if (!macro__use[(byte)(pat[0])])
 		return -1;
 
-	/* Scan the macros */
-	for (i = 0; i < macro__num; ++i)
-	{
-		if (prefix(macro__pat[i], pat) && !streq(macro__pat[i], pat))
-			return i;
-	}
+	pos = macro_lower_bound(pat);
+
+	/* Skip the pattern itself */
+	if ((pos < macro__num) && streq(macro__pat[macro__order[pos]], pat))
+		pos++;
+
+	if ((pos < macro__num) && prefix(macro__pat[macro__order[pos]], pat))
+		return macro__order[pos];
 
 	/* Nothing */
 	return -1;
@@ -92,31 +122,27 @@ int macro_find_maybe(cptr pat)
  */
 int macro_find_ready(cptr pat)
 {
-	int i, t, n = -1, s = -1;
+	char buf[1024];
+	int n;
 
 	/* Nothing possible */
 	if (!macro__use[(byte)(pat[0])])
 		return -1;
 
-	/* Scan the macros */
-	for (i = 0; i < macro__num; ++i)
-	{
-		/* Skip macros which are not contained by the pattern */
-		if (!prefix(pat, macro__pat[i])) continue;
+	my_strcpy(buf, pat, sizeof(buf));
 
-		/* Obtain the length of this macro */
-		t = strlen(macro__pat[i]);
-
-		/* Only track the "longest" pattern */
-		if ((n >= 0) && (s > t)) continue;
+	/* Try each start of the pattern, longest first */
+	for (n = strlen(buf); n > 0; n--)
+	{
+		int k;
 
-		/* Track the entry */
-		n = i;
-		s = t;
+		buf[n] = '\0';
+		k = macro_find_exact(buf);
+		if (k >= 0) return k;
 	}
 
-	/* Result */
-	return n;
+	/* Nothing */
+	return -1;
 }
 
 /*
@@ -152,12 +178,20 @@ errr macro_add(cptr pat, cptr act)
 	/* Create a new macro */
 	else
 	{
+		int pos = macro_lower_bound(pat);
+
 		/* Get a new index */
-		n = macro__num++;
-		if (macro__num >= MACRO_MAX) quit("Too many macros!");
+		n = macro__num;
+		if (macro__num + 1 >= MACRO_MAX) quit("Too many macros!");
 
 		/* Save the pattern */
 		macro__pat[n] = string_make(pat);
+
+		/* Keep the patterns in order */
+		memmove(&macro__order[pos + 1], &macro__order[pos],
+		        (macro__num - pos) * sizeof(*macro__order));
+		macro__order[pos] = n;
+		macro__num++;
 	}
 
 	/* Save the action */
@@ -183,6 +217,9 @@ errr macro_init(void)
 	/* Macro actions */
 	macro__act = C_ZNEW(MACRO_MAX, char *);
 
+	/* Macro order */
+	macro__order = C_ZNEW(MACRO_MAX, s16b);
+
 	/* Success */
 	return (0);
 }
@@ -205,6 +242,8 @@ errr macro_free(void)
 
 	FREE(macro__pat);
 	FREE(macro__act);
+	FREE(macro__order);
+	macro__num = 0;
 
 	/* Free the keymaps */
 	for (i = 0; i < KEYMAP_MODES; ++i)
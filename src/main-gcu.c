@@ -168,6 +168,28 @@ static bool use_big_screen;
  */
 static int bg_color = COLOR_BLACK;
 
+/*
+ * Some term has been refreshed, but the screen not yet updated
+ */
+static bool gcu_update_pending = FALSE;
+
+
+/*
+ * Update the screen from every term refreshed since the last time.
+ *
+ * TERM_XTRA_FRESH only copies a term into curses' idea of the screen, so
+ * that when the main term and its subwindows are all refreshed together,
+ * only one lot of output goes to the terminal.  This sends it, and must be
+ * done before waiting for anything.
+ */
+static void gcu_update(void)
+{
+	if (!gcu_update_pending) return;
+
+	(void)doupdate();
+	gcu_update_pending = FALSE;
+}
+
 /*
  * Lookup table for the "alternate character set".
  *
@@ -512,6 +534,9 @@ static errr Term_xtra_gcu_event(int v)
 {
 	int i, j, k;
 
+	/* Show what has been drawn */
+	gcu_update();
+
 	/* Wait */
 	if (v)
 	{
@@ -523,6 +548,7 @@ static errr Term_xtra_gcu_event(int v)
 		{
 			i = getch();
 			idle_update();
+			gcu_update();
 		}
 		cbreak();
 
@@ -755,7 +781,8 @@ static errr Term_xtra_gcu(int n, int v)
 
 		/* Flush the Curses buffer */
 		case TERM_XTRA_FRESH:
-		(void)wrefresh(td->win);
+		(void)wnoutrefresh(td->win);
+		gcu_update_pending = TRUE;
 		return (0);
 
 #ifdef USE_CURS_SET
@@ -782,6 +809,7 @@ static errr Term_xtra_gcu(int n, int v)
 
 		/* Delay */
 		case TERM_XTRA_DELAY:
+		gcu_update();
 		if (v > 0)
 			usleep(1000 * v);
 		return (0);
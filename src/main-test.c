@@ -4,12 +4,64 @@
  */
 
 #include "angband.h"
+#include "autoplay.h"
 #include "birth.h"
+#include "generate.h"
+#include "journal.h"
+#include "perf.h"
+#include "state-hash.h"
+#include "wizard.h"
+
+#include <time.h>
+
+#ifdef SET_UID
+# include <sys/resource.h>
+#endif
 
 static int prompt = 0;
 static int verbose = 0;
 static int nextkey = 0;
 
+/*
+ * The screen can be recorded to a file (or a pipe) as a stream of the
+ * changes made by each refresh.  The stream starts with the header
+ *
+ *   "ANGTERM1" <width> <height>
+ *
+ * followed by one frame per refresh which changed anything:
+ *
+ *   'F' <cursor x> <cursor y> <cursor visible> <runs, 2 bytes>
+ *
+ * and then that many runs of changed grids in one colour:
+ *
+ *   <x> <y> <length> <attr> <length chars>
+ *
+ * All values are single bytes unless noted; two-byte ones are little-endian.
+ * Replaying the runs in order onto a blank screen gives what was shown.
+ */
+#define RECORD_WID	80
+#define RECORD_HGT	24
+
+static ang_file *record_file = NULL;
+static byte record_buf[8 + RECORD_WID * RECORD_HGT * 5];
+static size_t record_len = 0;
+static int record_runs = 0;
+static bool record_cv = FALSE;
+static byte record_cx = 0, record_cy = 0;
+
+/*
+ * A benchmark times the game between "bench-start" and "bench-stop", and
+ * reports game turns per second, allocations, peak memory and (if built
+ * with ALLOW_PERF) the per-turn profile.  The work in between is whatever
+ * the script does: load a savefile with -u, then feed in keys to run,
+ * rest, fight or descend.
+ */
+static char bench_name[80];
+static bool bench_on = FALSE;
+static clock_t bench_clock;
+static s32b bench_turn;
+static u32b bench_allocs;
+
 static void c_key(char *rest) {
 	if (!strcmp(rest, "left")) {
 		nextkey = ARROW_LEFT;
@@ -48,6 +100,323 @@ static void c_verbose(char *rest) {
 	}
 }
 
+static errr term_batch_test(int n, const term_cell *cells);
+
+static void c_record(char *rest) {
+	term *t = angband_term[0];
+
+	if (record_file) {
+		file_close(record_file);
+		record_file = NULL;
+		t->batch_hook = NULL;
+	}
+
+	if (!rest || !*rest) {
+		printf("cmd-record: off\n");
+		return;
+	}
+
+	record_file = file_open(rest, MODE_WRITE, FTYPE_RAW);
+	if (!record_file) {
+		printf("cmd-record: can't open '%s'\n", rest);
+		return;
+	}
+
+	file_write(record_file, "ANGTERM1", 8);
+	file_writec(record_file, t->wid);
+	file_writec(record_file, t->hgt);
+	printf("cmd-record: %s\n", rest);
+
+	/* Start with the whole screen */
+	t->batch_hook = term_batch_test;
+	record_len = 0;
+	record_runs = 0;
+	Term_activate(t);
+	Term_redraw();
+}
+
+static void c_keys(char *rest) {
+	char buf[1024];
+	char *s;
+
+	if (!rest) return;
+
+	/* Allow "\e", "^X" and the like */
+	text_to_ascii(buf, sizeof(buf), rest);
+
+	for (s = buf; *s; s++)
+		Term_keypress((unsigned char)*s);
+}
+
+static void c_depth(char *rest) {
+	int depth = rest ? atoi(rest) : 0;
+
+	if ((depth < 0) || (depth >= MAX_DEPTH)) {
+		printf("depth: bad depth '%s'\n", rest);
+		return;
+	}
+
+	/* Takes effect once the game gets a key */
+	dungeon_change_level(depth);
+	Term_keypress(ESCAPE);
+	printf("depth: %d\n", depth);
+}
+
+static void c_level_size(char *rest) {
+	int hgt, wid;
+
+	if (!rest || (sscanf(rest, "%d %d", &hgt, &wid) != 2) ||
+	    (hgt < TOWN_HGT) || (hgt > DUNGEON_HGT) ||
+	    (wid < TOWN_WID) || (wid > DUNGEON_WID)) {
+		printf("level-size: bad size '%s'\n", rest ? rest : "");
+		return;
+	}
+
+	/* Takes effect at the next new level */
+	dungeon_want_hgt = hgt;
+	dungeon_want_wid = wid;
+	printf("level-size: %d %d\n", hgt, wid);
+}
+
+static void c_bench_start(char *rest) {
+	my_strcpy(bench_name, rest ? rest : "bench", sizeof(bench_name));
+	bench_on = TRUE;
+	bench_clock = clock();
+	bench_turn = turn;
+	bench_allocs = mem_alloc_count();
+#ifdef ALLOW_PERF
+	perf_reset();
+#endif
+	printf("bench-start: %s\n", bench_name);
+}
+
+static void c_bench_stop(char *rest) {
+	double secs = (double)(clock() - bench_clock) / CLOCKS_PER_SEC;
+	s32b turns = turn - bench_turn;
+	long peak = 0;
+
+#ifdef SET_UID
+	struct rusage ru;
+
+	if (!getrusage(RUSAGE_SELF, &ru)) peak = ru.ru_maxrss;
+#endif
+
+	if (!bench_on) {
+		printf("bench-stop: not started\n");
+		return;
+	}
+	bench_on = FALSE;
+
+	printf("bench: %s %ld game turns in %.3fs, %.0f turns/s, "
+	       "%lu allocations, peak %ldkB, now at depth %d\n", bench_name,
+	       (long)turns, secs, (secs > 0) ? turns / secs : 0.0,
+	       (unsigned long)(mem_alloc_count() - bench_allocs), peak, p_ptr->depth);
+
+#ifdef ALLOW_PERF
+	{
+		textblock *tb = textblock_new();
+
+		perf_describe(tb);
+		printf("%s", textblock_text(tb));
+		textblock_free(tb);
+	}
+#endif
+}
+
+/*
+ * Seed the RNG, so that two runs of a script play the same game
+ */
+static void c_seed(char *rest) {
+	unsigned long seed;
+
+	if (!rest || (sscanf(rest, "%lx", &seed) != 1)) {
+		printf("seed: bad seed '%s'\n", rest ? rest : "");
+		return;
+	}
+
+	Rand_quick = FALSE;
+	Rand_state_init(seed);
+	printf("seed: %08lx\n", seed);
+}
+
+/*
+ * "state-log <every> <file>" writes the hash of the game state every so many
+ * game turns to a file in the user directory, and "state-check <every>
+ * <file>" checks a later run against it; "state-stop" ends either and says
+ * how the check went.  So a script can be run before and after a change to
+ * show that the game plays the same.
+ */
+static void c_state_start(char *rest, bool check) {
+	char name[80];
+	int every;
+
+	if (!rest || (sscanf(rest, "%d %79s", &every, name) != 2) ||
+	    (every <= 0)) {
+		printf("state: bad arguments '%s'\n", rest ? rest : "");
+		return;
+	}
+
+	if (!state_hash_start(every, name, check)) {
+		printf("state: can't open '%s'\n", name);
+		return;
+	}
+
+	printf("state: %s %s every %d turns\n", check ? "checking" : "logging",
+	       name, every);
+}
+
+static void c_state_log(char *rest) {
+	c_state_start(rest, FALSE);
+}
+
+static void c_state_check(char *rest) {
+	c_state_start(rest, TRUE);
+}
+
+static void c_state_stop(char *rest) {
+	s32b bad;
+	u32b checked = state_hash_checked(&bad);
+
+	state_hash_start(0, NULL, FALSE);
+
+	printf("state: hash %08lx, %lu checked, ", (unsigned long)state_hash(),
+	       (unsigned long)checked);
+	if (bad < 0) printf("all matched\n");
+	else printf("first differed at turn %ld\n", (long)bad);
+}
+
+/*
+ * "journal-record <file>" records every key from here on to a file in the
+ * user directory, and "journal-replay <file>" plays it back at full speed,
+ * from the same point in a later run; the rest of the script carries on
+ * once it has all been played.  "journal-stop" ends either and says how
+ * many keys there were and whether the game matched the recording.
+ */
+static void c_journal_record(char *rest) {
+	if (!rest || !journal_record(rest)) {
+		printf("journal: can't record to '%s'\n", rest ? rest : "");
+		return;
+	}
+
+	printf("journal: recording to %s\n", rest);
+}
+
+static void c_journal_replay(char *rest) {
+	if (!rest || !journal_play_file(rest)) {
+		printf("journal: can't play '%s'\n", rest ? rest : "");
+		return;
+	}
+
+	printf("journal: playing %s\n", rest);
+}
+
+static void c_journal_stop(char *rest) {
+	s32b bad;
+	u32b keys = journal_count(&bad);
+
+	journal_stop();
+
+	printf("journal: %lu keys, turn %ld, hash %08lx, ", (unsigned long)keys,
+	       (long)turn, (unsigned long)state_hash());
+	if (bad < 0) printf("all matched\n");
+	else printf("first differed at turn %ld\n", (long)bad);
+}
+
+/*
+ * "autoplay <turns> [<depth>]" lets the automated player play for so many
+ * game turns, going no deeper than <depth> (by default the bottom); the
+ * rest of the script carries on once it's done.  "autoplay?" says what it
+ * has done.  It may come before or after "depth"; each takes effect once
+ * the game gets a key.
+ */
+static void c_autoplay(char *rest) {
+	long turns;
+	int depth = MAX_DEPTH - 1;
+
+	if (!rest || (sscanf(rest, "%ld %d", &turns, &depth) < 1) ||
+	    (turns <= 0)) {
+		printf("autoplay: bad arguments '%s'\n", rest ? rest : "");
+		return;
+	}
+
+	/* Takes effect once the game gets a key */
+	autoplay_start(turns, depth);
+	Term_keypress(ESCAPE);
+	printf("autoplay: %ld turns\n", turns);
+}
+
+static void c_autoplay_query(char *rest) {
+	struct autoplay_stats stats;
+
+	autoplay_get_stats(&stats);
+	printf("autoplay: turn %ld, %lu commands, %lu levels, %lu deaths, "
+	       "%lu prompts, max depth %d%s\n", (long)turn,
+	       (unsigned long)stats.commands, (unsigned long)stats.levels,
+	       (unsigned long)stats.deaths, (unsigned long)stats.prompts,
+	       stats.max_depth, stats.playing ? ", playing" : "");
+}
+
+/*
+ * "item-stats <tval> <sval> <n|g|e> <rolls> [<workers>]" makes so many
+ * normal, good or excellent items at every depth, in so many processes, and
+ * says how many of each kind asked for came out the same as, better or
+ * worse than an average one.
+ */
+/*
+ * "drop-stats <kills>" simulates so many deaths of every monster race at a
+ * range of depths and writes what they dropped to "drops.csv" in the user
+ * directory (if the build has statistics turned on).
+ */
+static void c_drop_stats(char *rest) {
+	int kills = rest ? atoi(rest) : 0;
+
+	if (kills <= 0) {
+		printf("drop-stats: bad kills '%s'\n", rest ? rest : "");
+		return;
+	}
+
+	printf("drop-stats: %s\n", stats_collect_drops(kills) ? "done" : "failed");
+}
+
+static void c_item_stats(char *rest) {
+	char tval_name[40], sval_name[80];
+	char quality;
+	long rolls;
+	int workers = 1;
+	int tval, sval, k_idx, depth;
+
+	if (!rest || (sscanf(rest, "%39s %79s %c %ld %d", tval_name, sval_name,
+	                     &quality, &rolls, &workers) < 4) ||
+	    !strchr("nge", quality) || (rolls <= 0)) {
+		printf("item-stats: bad arguments '%s'\n", rest ? rest : "");
+		return;
+	}
+
+	tval = tval_find_idx(tval_name);
+	sval = (tval > 0) ? lookup_sval(tval, sval_name) : -1;
+	k_idx = (sval >= 0) ? lookup_kind(tval, sval) : 0;
+	if (!k_idx) {
+		printf("item-stats: no such item '%s %s'\n", tval_name, sval_name);
+		return;
+	}
+
+	for (depth = 0; depth < MAX_DEPTH; depth++) {
+		struct wiz_roll_stats stats;
+		object_type ref;
+		bool ok;
+
+		object_prep(&ref, &k_info[k_idx], depth, AVERAGE);
+
+		ok = wiz_roll_items(&ref, depth, quality != 'n', quality == 'e',
+		                    rolls, workers, &stats);
+
+		printf("item-stats: depth %d, rolls %ld, matches %ld, better %ld, "
+		       "worse %ld, other %ld%s\n", depth, stats.rolls,
+		       stats.matches, stats.better, stats.worse, stats.other,
+		       ok ? "" : " (workers failed)");
+	}
+}
+
 static void c_version(char *rest) {
 	printf("cmd-version: %s %s\n", VERSION_NAME, VERSION_STRING);
 }
@@ -121,9 +490,26 @@ typedef struct {
 
 static test_cmd cmds[] = {
 	{ "#", c_noop },
+	{ "autoplay", c_autoplay },
+	{ "autoplay?", c_autoplay_query },
 	{ "key", c_key },
+	{ "keys", c_keys },
+	{ "depth", c_depth },
+	{ "drop-stats", c_drop_stats },
+	{ "item-stats", c_item_stats },
+	{ "journal-record", c_journal_record },
+	{ "journal-replay", c_journal_replay },
+	{ "journal-stop", c_journal_stop },
+	{ "level-size", c_level_size },
+	{ "bench-start", c_bench_start },
+	{ "bench-stop", c_bench_stop },
 	{ "noop", c_noop },
 	{ "quit", c_quit },
+	{ "record", c_record },
+	{ "seed", c_seed },
+	{ "state-log", c_state_log },
+	{ "state-check", c_state_check },
+	{ "state-stop", c_state_stop },
 	{ "verbose", c_verbose },
 	{ "version?", c_version },
 
@@ -204,7 +590,32 @@ static errr term_xtra_noise(int v) {
 }
 
 static errr term_xtra_fresh(int v) {
+	term_win *scr = Term->scr;
+	bool cv = (scr->cv && !scr->cu);
+	byte head[6];
+
 	if (verbose) printf("term-xtra-fresh %d\n", v);
+	if (!record_file) return 0;
+
+	/* Skip frames which changed nothing */
+	if (!record_runs && (cv == record_cv) &&
+	    (!cv || ((scr->cx == record_cx) && (scr->cy == record_cy))))
+		return 0;
+
+	head[0] = 'F';
+	head[1] = scr->cx;
+	head[2] = scr->cy;
+	head[3] = cv;
+	head[4] = record_runs & 0xFF;
+	head[5] = record_runs >> 8;
+	file_write(record_file, (const char *)head, sizeof(head));
+	file_write(record_file, (const char *)record_buf, record_len);
+
+	record_cv = cv;
+	record_cx = scr->cx;
+	record_cy = scr->cy;
+	record_len = 0;
+	record_runs = 0;
 	return 0;
 }
 
@@ -224,6 +635,20 @@ static errr term_xtra_event(int v) {
 		Term_keypress(nextkey);
 		nextkey = 0;
 	}
+
+	/*
+	 * The game only checking for a keypress (as it does while resting
+	 * or running) doesn't move the script on, so long commands run to
+	 * completion
+	 */
+	if (!v) return 0;
+
+	/* Nor does a prompt the automated player left unanswered */
+	if (autoplay_answer()) {
+		Term_keypress(ESCAPE);
+		return 0;
+	}
+
 	return test_docmd();
 }
 
@@ -281,10 +706,39 @@ static errr term_text_test(int x, int y, int n, byte a, const char *s) {
 	return 0;
 }
 
+/*
+ * Add the grids changed by a refresh to the frame being recorded
+ */
+static errr term_batch_test(int n, const term_cell *cells) {
+	int i, len;
+
+	for (i = 0; i < n; i += len) {
+		const term_cell *first = &cells[i];
+		int j;
+
+		len = 1;
+		while ((i + len < n) && (cells[i + len].y == first->y) &&
+		       (cells[i + len].x == first->x + len) &&
+		       (cells[i + len].a == first->a))
+			len++;
+
+		record_buf[record_len++] = first->x;
+		record_buf[record_len++] = first->y;
+		record_buf[record_len++] = len;
+		record_buf[record_len++] = first->a;
+		for (j = 0; j < len; j++)
+			record_buf[record_len++] = cells[i + j].c;
+		record_runs++;
+	}
+
+	if (verbose) printf("term-batch %d\n", n);
+	return 0;
+}
+
 static void term_data_link(int i) {
 	term *t = &td.t;
 
-	term_init(t, 80, 24, 256);
+	term_init(t, RECORD_WID, RECORD_HGT, 256);
 
 	t->init_hook = term_init_test;
 	t->nuke_hook = term_nuke_test;
@@ -2566,13 +2566,13 @@ static void windows_map_aux(void)
 	byte ta;
 	char tc;
 
-	td->map_tile_wid = (td->tile_wid * td->cols) / DUNGEON_WID;
-	td->map_tile_hgt = (td->tile_hgt * td->rows) / DUNGEON_HGT;
+	td->map_tile_wid = (td->tile_wid * td->cols) / cave->width;
+	td->map_tile_hgt = (td->tile_hgt * td->rows) / cave->height;
 
 	min_x = 0;
 	min_y = 0;
-	max_x = DUNGEON_WID;
-	max_y = DUNGEON_HGT;
+	max_x = cave->width;
+	max_y = cave->height;
 
 	/* Draw the map */
 	for (x = min_x; x < max_x; x++)
@@ -267,6 +267,10 @@ struct metadpy
  *
  *	- Bit Flag: We should nuke 'win' when done with it
  *
+ *	- The server-side copy drawn into instead of 'win', if any
+ *	- The size of that copy
+ *	- The part of it not yet copied to 'win'
+ *
  *	- Bit Flag: 1st extra flag
  *	- Bit Flag: 2nd extra flag
  *	- Bit Flag: 3rd extra flag
@@ -296,6 +300,10 @@ struct infowin
 	unsigned int flag2:1;
 	unsigned int flag3:1;
 	unsigned int flag4:1;
+
+	Pixmap buffer;
+	s16b buffer_w, buffer_h;
+	s16b dx1, dy1, dx2, dy2;
 };
 
 
@@ -781,6 +789,9 @@ static errr Infowin_nuke(void)
 {
 	infowin *iwin = Infowin;
 
+	/* Free the copy */
+	if (iwin->buffer) XFreePixmap(Metadpy->dpy, iwin->buffer);
+
 	/* Nuke if requested */
 	if (iwin->nuke)
 	{
@@ -1024,13 +1035,128 @@ static errr Infowin_locate(int x, int y, int w, int h)
 #endif /* IGNORE_UNUSED_FUNCTIONS */
 
 
+/*
+ * Drawing into infowins
+ *
+ * With backing pixmaps on ("-b"), everything is drawn into a copy of each
+ * window kept on the X server, and the part that changed is copied to the
+ * window once per "Term_fresh()".  Exposed parts of the window are then
+ * copied from there too, instead of being drawn again, which saves a lot
+ * of traffic when the display is across a network.
+ */
+static bool x11_backing = FALSE;
+
+/* The GC used to copy from the backing pixmaps */
+static GC backing_gc = NULL;
+
+/* Where drawing into the current infowin should go */
+#define Infowin_drawable() \
+	(Infowin->buffer ? (Drawable)Infowin->buffer : (Drawable)Infowin->win)
+
+
+/*
+ * Note that a part of the current infowin's copy has been drawn on
+ */
+static void Infowin_damage(int x, int y, int w, int h)
+{
+	if (!Infowin->buffer) return;
+
+	/* Nothing waiting yet */
+	if (Infowin->dx1 >= Infowin->dx2)
+	{
+		Infowin->dx1 = x;
+		Infowin->dy1 = y;
+		Infowin->dx2 = x + w;
+		Infowin->dy2 = y + h;
+		return;
+	}
+
+	if (x < Infowin->dx1) Infowin->dx1 = x;
+	if (y < Infowin->dy1) Infowin->dy1 = y;
+	if (x + w > Infowin->dx2) Infowin->dx2 = x + w;
+	if (y + h > Infowin->dy2) Infowin->dy2 = y + h;
+}
+
+
+/*
+ * Copy a part of the current infowin's copy to the window
+ */
+static void Infowin_copy(int x, int y, int w, int h)
+{
+	if ((w <= 0) || (h <= 0)) return;
+
+	XCopyArea(Metadpy->dpy, Infowin->buffer, Infowin->win, backing_gc,
+	          x, y, w, h, x, y);
+}
+
+
+/*
+ * Copy what has been drawn since the last time to the window
+ */
+static void Infowin_flush(void)
+{
+	if (!Infowin->buffer || (Infowin->dx1 >= Infowin->dx2)) return;
+
+	Infowin_copy(Infowin->dx1, Infowin->dy1,
+	             Infowin->dx2 - Infowin->dx1, Infowin->dy2 - Infowin->dy1);
+
+	Infowin->dx1 = Infowin->dx2 = 0;
+}
+
+
+/*
+ * Make the current infowin's copy the size of the window, keeping what
+ * was drawn into the old one
+ */
+static void Infowin_backing(void)
+{
+	Pixmap old = Infowin->buffer;
+
+	if (!backing_gc)
+		backing_gc = XCreateGC(Metadpy->dpy, Metadpy->root, 0, NULL);
+
+	/* Already the right size */
+	if (old && (Infowin->buffer_w == Infowin->w) &&
+	    (Infowin->buffer_h == Infowin->h))
+		return;
+
+	Infowin->buffer = XCreatePixmap(Metadpy->dpy, Infowin->win,
+	                                Infowin->w, Infowin->h, Metadpy->depth);
+	XFillRectangle(Metadpy->dpy, Infowin->buffer, clr[TERM_DARK]->gc,
+	               0, 0, Infowin->w, Infowin->h);
+
+	if (old)
+	{
+		XCopyArea(Metadpy->dpy, old, Infowin->buffer, backing_gc,
+		          0, 0, Infowin->buffer_w, Infowin->buffer_h, 0, 0);
+		XFreePixmap(Metadpy->dpy, old);
+	}
+
+	Infowin->buffer_w = Infowin->w;
+	Infowin->buffer_h = Infowin->h;
+
+	Infowin_damage(0, 0, Infowin->w, Infowin->h);
+}
+
+
 /*
  * Visually clear Infowin
  */
 static errr Infowin_wipe(void)
 {
+	/* Clear the copy, to be copied to the window */
+	if (Infowin->buffer)
+	{
+		XFillRectangle(Metadpy->dpy, Infowin->buffer, clr[TERM_DARK]->gc,
+		               0, 0, Infowin->buffer_w, Infowin->buffer_h);
+		Infowin_damage(0, 0, Infowin->buffer_w, Infowin->buffer_h);
+	}
+
 	/* Execute the request */
-	XClearWindow(Metadpy->dpy, Infowin->win);
+	else
+	{
+		XClearWindow(Metadpy->dpy, Infowin->win);
+	}
 
 	/* Success */
 	return (0);
@@ -1492,7 +1618,9 @@ static errr Infofnt_text_std(int x, int y, cptr str, int len)
 	h = td->tile_hgt;
 
 	/* Fill the background */
-	XFillRectangle(Metadpy->dpy, Infowin->win, clr[TERM_DARK]->gc, x, y, w, h);
+	XFillRectangle(Metadpy->dpy, Infowin_drawable(), clr[TERM_DARK]->gc,
+	               x, y, w, h);
+	Infowin_damage(x, y, w, h);
 
 
 	/*** Actually draw 'str' onto the infowin ***/
@@ -1513,7 +1641,7 @@ static errr Infofnt_text_std(int x, int y, cptr str, int len)
 		for (i = 0; i < len; ++i)
 		{
 			/* Note that the Infoclr is set up to contain the Infofnt */
-			XDrawImageString(Metadpy->dpy, Infowin->win, Infoclr->gc,
+			XDrawImageString(Metadpy->dpy, Infowin_drawable(), Infoclr->gc,
 			                 x + i * td->tile_wid + Infofnt->off, y, str + i, 1);
 		}
 	}
@@ -1522,7 +1650,7 @@ static errr Infofnt_text_std(int x, int y, cptr str, int len)
 	else
 	{
 		/* Note that the Infoclr is set up to contain the Infofnt */
-		XDrawImageString(Metadpy->dpy, Infowin->win, Infoclr->gc,
+		XDrawImageString(Metadpy->dpy, Infowin_drawable(), Infoclr->gc,
 		                 x, y, str, len);
 	}
 
@@ -1567,7 +1695,8 @@ static errr Infofnt_text_non(int x, int y, cptr str, int len)
 	/*** Actually 'paint' the area ***/
 
 	/* Just do a Fill Rectangle */
-	XFillRectangle(Metadpy->dpy, Infowin->win, Infoclr->gc, x, y, w, h);
+	XFillRectangle(Metadpy->dpy, Infowin_drawable(), Infoclr->gc, x, y, w, h);
+	Infowin_damage(x, y, w, h);
 
 	/* Success */
 	return (0);
@@ -1868,6 +1997,14 @@ static errr CheckEvent(bool wait)
 		{
 			int x1, x2, y1, y2;
 
+			/* Copy it back from the backing pixmap */
+			if (Infowin->buffer)
+			{
+				Infowin_copy(xev->xexpose.x, xev->xexpose.y,
+				             xev->xexpose.width, xev->xexpose.height);
+				break;
+			}
+
 			x1 = (xev->xexpose.x - Infowin->ox) / td->tile_wid;
 			x2 = (xev->xexpose.x + xev->xexpose.width - Infowin->ox) / td->tile_wid;
 
@@ -1907,6 +2044,9 @@ static errr CheckEvent(bool wait)
 			Infowin->w = xev->xconfigure.width;
 			Infowin->h = xev->xconfigure.height;
 
+			/* Keep the backing pixmap the same size */
+			if (Infowin->buffer) Infowin_backing();
+
 			/* Determine "proper" number of rows/cols */
 			cols = ((Infowin->w - (ox + ox)) / td->tile_wid);
 			rows = ((Infowin->h - (oy + oy)) / td->tile_hgt);
@@ -2032,7 +2172,7 @@ static errr Term_xtra_x11(int n, int v)
 		case TERM_XTRA_NOISE: Metadpy_do_beep(); return (0);
 
 		/* Flush the output XXX XXX */
-		case TERM_XTRA_FRESH: Metadpy_update(1, 0, 0); return (0);
+		case TERM_XTRA_FRESH: Infowin_flush(); Metadpy_update(1, 0, 0); return (0);
 
 		/* Process random events XXX */
 		case TERM_XTRA_BORED: return (CheckEvent(0));
@@ -2070,10 +2210,13 @@ static errr Term_curs_x11(int x, int y)
 {
 	term_data *td = (term_data*)(Term->data);
 
-	XDrawRectangle(Metadpy->dpy, Infowin->win, xor->gc,
+	XDrawRectangle(Metadpy->dpy, Infowin_drawable(), xor->gc,
 			 x * td->tile_wid + Infowin->ox,
 			 y * td->tile_hgt + Infowin->oy,
 			 td->tile_wid - 1, td->tile_hgt - 1);
+	Infowin_damage(x * td->tile_wid + Infowin->ox,
+	               y * td->tile_hgt + Infowin->oy,
+	               td->tile_wid, td->tile_hgt);
 
 	/* Success */
 	return (0);
@@ -2087,10 +2230,13 @@ static errr Term_bigcurs_x11(int x, int y)
 {
 	term_data *td = (term_data*)(Term->data);
 
-	XDrawRectangle(Metadpy->dpy, Infowin->win, xor->gc,
+	XDrawRectangle(Metadpy->dpy, Infowin_drawable(), xor->gc,
 			 x * td->tile_wid + Infowin->ox,
 			 y * td->tile_hgt + Infowin->oy,
 			 td->tile_wid2 - 1, td->tile_hgt - 1);
+	Infowin_damage(x * td->tile_wid + Infowin->ox,
+	               y * td->tile_hgt + Infowin->oy,
+	               td->tile_wid2, td->tile_hgt);
 
 	/* Success */
 	return (0);
@@ -2129,6 +2275,114 @@ static errr Term_text_x11(int x, int y, int n, byte a, cptr s)
 }
 
 
+/*
+ * Runs of changed grids drawn by one pass of Term_batch_x11()
+ */
+#define BATCH_RUNS 256
+
+/*
+ * Draw every grid changed by a refresh (see "Term_fresh()").
+ *
+ * The changed grids are split into runs of one colour, as they would be for
+ * Term_text_x11(), but the backgrounds of all the runs are filled with a
+ * single request, and each colour's font is only set once per frame.  That
+ * takes the number of requests per run from three down to one.
+ */
+static errr Term_batch_x11(int n, const term_cell *cells)
+{
+	term_data *td = (term_data*)(Term->data);
+
+	XRectangle rects[BATCH_RUNS];
+	int starts[BATCH_RUNS];
+	int lens[BATCH_RUNS];
+	bool font_set[MAX_COLORS];
+
+	int i = 0;
+
+	(void)C_WIPE(font_set, MAX_COLORS, bool);
+
+	while (i < n)
+	{
+		int runs = 0;
+		int r;
+
+		/* Find some runs */
+		while ((i < n) && (runs < BATCH_RUNS))
+		{
+			const term_cell *first = &cells[i];
+			int len = 1;
+
+			while ((i + len < n) &&
+			       (cells[i + len].y == first->y) &&
+			       (cells[i + len].x == first->x + len) &&
+			       (cells[i + len].a == first->a))
+				len++;
+
+			rects[runs].x = first->x * td->tile_wid + Infowin->ox;
+			rects[runs].y = first->y * td->tile_hgt + Infowin->oy;
+			rects[runs].width = len * td->tile_wid;
+			rects[runs].height = td->tile_hgt;
+			starts[runs] = i;
+			lens[runs] = len;
+
+			Infowin_damage(rects[runs].x, rects[runs].y,
+			               rects[runs].width, rects[runs].height);
+
+			runs++;
+			i += len;
+		}
+
+		/* Erase behind all of them at once */
+		XFillRectangles(Metadpy->dpy, Infowin_drawable(), clr[TERM_DARK]->gc,
+		                rects, runs);
+
+		/* Draw the text that isn't black */
+		for (r = 0; r < runs; r++)
+		{
+			const term_cell *first = &cells[starts[r]];
+			char buf[256];
+			int j;
+
+			if ((first->a == TERM_DARK) || !first->c) continue;
+
+			for (j = 0; j < lens[r]; j++)
+				buf[j] = cells[starts[r] + j].c;
+
+			Infoclr_set(clr[first->a]);
+
+			/* Be sure the correct font is ready */
+			if (!font_set[first->a])
+			{
+				XSetFont(Metadpy->dpy, Infoclr->gc, Infofnt->info->fid);
+				font_set[first->a] = TRUE;
+			}
+
+			/* Monotize the font */
+			if (Infofnt->mono)
+			{
+				for (j = 0; j < lens[r]; j++)
+				{
+					XDrawImageString(Metadpy->dpy, Infowin_drawable(), Infoclr->gc,
+					                 rects[r].x + j * td->tile_wid + Infofnt->off,
+					                 rects[r].y + Infofnt->asc, buf + j, 1);
+				}
+			}
+
+			/* Assume monospaced font */
+			else
+			{
+				XDrawImageString(Metadpy->dpy, Infowin_drawable(), Infoclr->gc,
+				                 rects[r].x, rects[r].y + Infofnt->asc,
+				                 buf, lens[r]);
+			}
+		}
+	}
+
+	/* Success */
+	return (0);
+}
+
+
 
 
 static void save_prefs(void)
@@ -2520,6 +2774,9 @@ static errr term_data_init(term_data *td, int i)
 	/* Use the size hints */
 	XSetWMNormalHints(Metadpy->dpy, Infowin->win, sh);
 
+	/* Draw into a backing pixmap */
+	if (x11_backing) Infowin_backing();
+
 	/* Map the window */
 	Infowin_map();
 
@@ -2547,6 +2804,7 @@ static errr term_data_init(term_data *td, int i)
 	t->bigcurs_hook = Term_bigcurs_x11;
 	t->wipe_hook = Term_wipe_x11;
 	t->text_hook = Term_text_x11;
+	t->batch_hook = Term_batch_x11;
 
 	/* Save the data */
 	t->data = td;
@@ -2559,7 +2817,7 @@ static errr term_data_init(term_data *td, int i)
 }
 
 
-const char help_x11[] = "Basic X11, subopts -d<display> -n<windows> -x<file>";
+const char help_x11[] = "Basic X11, subopts -d<display> -n<windows> -x<file> -b";
 
 static void hook_quit(cptr str)
 {
@@ -2654,6 +2912,12 @@ errr init_x11(int argc, char **argv)
 			continue;
 		}
 
+		if (prefix(argv[i], "-b"))
+		{
+			x11_backing = TRUE;
+			continue;
+		}
+
 		plog_fmt("Ignoring option: %s", argv[i]);
 	}
 
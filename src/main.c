@@ -87,6 +87,9 @@ static void quit_hook(cptr s)
 	/* Unused parameter */
 	(void)s;
 
+	/* Don't leave a savefile half-written */
+	old_save_wait();
+
 	/* Scan windows */
 	for (j = ANGBAND_TERM_MAX - 1; j >= 0; j--)
 	{
@@ -232,10 +235,13 @@ static void debug_opt(const char *arg) {
 		mem_flags |= MEM_POISON_ALLOC;
 	else if (streq(arg, "mem-poison-free"))
 		mem_flags |= MEM_POISON_FREE;
+	else if (streq(arg, "init-times"))
+		init_times = TRUE;
 	else {
 		puts("Debug flags:");
 		puts("  mem-poison-alloc: Poison all memory allocations");
 		puts("   mem-poison-free: Poison all freed memory");
+		puts("        init-times: Time each part of startup, on stderr");
 		exit(0);
 	}
 }
@@ -257,6 +263,8 @@ int main(int argc, char *argv[])
 
 	bool args = TRUE;
 
+	unsigned long bench_seed;
+
 
 	/* Save the "program name" XXX XXX XXX */
 	argv0 = argv[0];
@@ -354,6 +362,60 @@ int main(int argc, char *argv[])
 				debug_opt(arg);
 				continue;
 
+			case 's':
+			case 'S':
+			{
+				/* A range of depths, or just the one */
+				if (sscanf(arg, "%lx,%d-%d,%d", &bench_seed, &arg_bench_depth,
+				           &arg_bench_depth_max, &arg_bench_count) != 4)
+				{
+					arg_bench_depth_max = 0;
+					if (sscanf(arg, "%lx,%d,%d", &bench_seed,
+					           &arg_bench_depth, &arg_bench_count) != 3)
+						goto usage;
+				}
+				if ((arg_bench_depth < 1) || (arg_bench_depth >= MAX_DEPTH) ||
+				    (arg_bench_depth_max >= MAX_DEPTH) ||
+				    (arg_bench_depth_max && (arg_bench_depth_max < arg_bench_depth)) ||
+				    (arg_bench_count < 1))
+					goto usage;
+				arg_bench_seed = bench_seed;
+				continue;
+			}
+
+			case 'f':
+			case 'F':
+			{
+				if (sscanf(arg, "%d,%d,%d", &arg_fight_race,
+				           &arg_fight_level, &arg_fight_count) != 3)
+					goto usage;
+				if ((arg_fight_level < 1) ||
+				    (arg_fight_level > PY_MAX_LEVEL) ||
+				    (arg_fight_count < 1))
+					goto usage;
+				continue;
+			}
+
+			case 'i':
+			case 'I':
+			{
+				if (!*arg) goto usage;
+				arg_describe = arg;
+				continue;
+			}
+
+			case 'p':
+			case 'P':
+			{
+				unsigned long spoil_seed = 0;
+
+				if (*arg && (sscanf(arg, "%lx", &spoil_seed) != 1))
+					goto usage;
+				arg_spoil = TRUE;
+				arg_spoil_seed = spoil_seed;
+				continue;
+			}
+
 			case '-':
 			{
 				argv[i] = argv[0];
@@ -373,6 +435,11 @@ int main(int argc, char *argv[])
 				puts("  -r             Rebalance monsters");
 				puts("  -g             Request graphics mode");
 				puts("  -x<opt>        Debug options; see -xhelp");
+				puts("  -s<s>,<d>,<n>  Generate the level with hex seed <s> at depth <d> <n> times, and quit");
+				puts("  -s<s>,<d>-<e>,<n> Time <n> levels from master hex seed <s> at each depth <d> to <e>, and quit");
+				puts("  -f<r>,<l>,<n>  Fight monster race <r> <n> times as a level <l> character, and quit");
+				puts("  -i<file>       Describe the character in savefile <file>, and quit");
+				puts("  -p[<s>]        Write the spoiler files, with the random artifacts from hex seed <s>, and quit");
 				puts("  -u<who>        Use your <who> savefile");
 				puts("  -d<path>       Store pref files and screendumps in <path>");
 				puts("  -m<sys>        Use module <sys>, where <sys> can be:");
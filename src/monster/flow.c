@@ -0,0 +1,204 @@
+/*
+ * File: monster/flow.c
+ * Purpose: Flow fields shared by all monsters
+ *
+ * Copyright (c) 1997 Ben Harrison, James E. Wilson, Robert A. Koeneke
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+#include "cave.h"
+#include "monster/monster.h"
+
+/*
+ * The player's "sound" and "scent" are kept in cave->cost and cave->when
+ * by update_flow().  The fields here are instead built from the player's
+ * view: each holds the number of steps from every grid to the nearest of
+ * its "goal" grids, so that a monster only has to compare its neighbours
+ * to head for one.
+ *
+ * A field is only built when a monster asks for it, and then kept until
+ * the view changes, so however many monsters are using it, it is built at
+ * most once per player move.
+ */
+struct flow_field
+{
+	bool valid;                         /* Built at all */
+	u32b view_stamp;                    /* cave->view_stamp when built */
+	byte dist[DUNGEON_HGT][DUNGEON_WID];  /* Steps to the nearest goal */
+};
+
+static struct flow_field flow_fields[FLOW_MAX];
+
+/*
+ * Queue of grids, as GRID() values, used to build the fields
+ */
+static u16b flow_queue[DUNGEON_HGT * DUNGEON_WID];
+
+
+/*
+ * Grids monsters can walk through (as far as the flow is concerned)
+ */
+static bool flow_passable(int y, int x)
+{
+	return (cave->grid[y][x].feat < FEAT_RUBBLE);
+}
+
+
+/*
+ * Spread field "f" out from the "n" goal grids in flow_queue[], which
+ * must already have a distance of zero, up to "depth" steps.  Only grids
+ * with a distance of FLOW_FAR are entered.
+ */
+static void flow_field_spread(struct flow_field *f, int n, int depth)
+{
+	int head = 0, tail = n;
+
+	while (head != tail)
+	{
+		int g = flow_queue[head++];
+		int ty = GRID_Y(g);
+		int tx = GRID_X(g);
+		int cost = f->dist[ty][tx] + 1;
+		int d;
+
+		if (cost > depth) continue;
+
+		for (d = 0; d < 8; d++)
+		{
+			int y = ty + ddy_ddd[d];
+			int x = tx + ddx_ddd[d];
+
+			if (f->dist[y][x] != FLOW_FAR) continue;
+			if (!flow_passable(y, x)) continue;
+
+			f->dist[y][x] = cost;
+			flow_queue[tail++] = GRID(y, x);
+		}
+	}
+}
+
+
+/*
+ * Build the "safety" field: goals are floor grids out of the player's line
+ * of sight.  Only grids in view can be any distance from safety, so only
+ * those need to be looked at.
+ */
+static void flow_build_safety(struct flow_field *f)
+{
+	int g, n = 0;
+
+	/* Everything out of view is safe */
+	C_WIPE(f->dist, cave->height * DUNGEON_WID, byte);
+
+	/* Everything in view is not */
+	for (g = plane_next(cave->view, CAVE_PLANE_SIZE, 0); g >= 0;
+	     g = plane_next(cave->view, CAVE_PLANE_SIZE, g + 1))
+		f->dist[GRID_Y(g)][GRID_X(g)] = FLOW_FAR;
+
+	/* Grids in view next to safety are one step away from it */
+	for (g = plane_next(cave->view, CAVE_PLANE_SIZE, 0); g >= 0;
+	     g = plane_next(cave->view, CAVE_PLANE_SIZE, g + 1))
+	{
+		int y = GRID_Y(g);
+		int x = GRID_X(g);
+		int d;
+
+		if (!flow_passable(y, x)) continue;
+
+		for (d = 0; d < 8; d++)
+		{
+			int yy = y + ddy_ddd[d];
+			int xx = x + ddx_ddd[d];
+
+			if (!in_bounds(yy, xx)) continue;
+			if (player_has_los_bold(yy, xx)) continue;
+			if (!cave_floor_bold(yy, xx)) continue;
+
+			f->dist[y][x] = 1;
+			flow_queue[n++] = g;
+			break;
+		}
+	}
+
+	flow_field_spread(f, n, MAX_SIGHT);
+}
+
+
+/*
+ * Build the "ambush" field: goals are floor grids just out of the player's
+ * line of sight, but not next to him, where pack monsters can lie in wait.
+ */
+static void flow_build_ambush(struct flow_field *f)
+{
+	int py = p_ptr->py;
+	int px = p_ptr->px;
+
+	int g, n = 0;
+
+	/* Nothing is near an ambush yet */
+	memset(f->dist, FLOW_FAR, cave->height * sizeof(f->dist[0]));
+
+	/* Find the grids bordering the view */
+	for (g = plane_next(cave->view, CAVE_PLANE_SIZE, 0); g >= 0;
+	     g = plane_next(cave->view, CAVE_PLANE_SIZE, g + 1))
+	{
+		int y = GRID_Y(g);
+		int x = GRID_X(g);
+		int d;
+
+		if (!flow_passable(y, x)) continue;
+
+		for (d = 0; d < 8; d++)
+		{
+			int yy = y + ddy_ddd[d];
+			int xx = x + ddx_ddd[d];
+
+			if (!in_bounds_fully(yy, xx)) continue;
+			if (f->dist[yy][xx] == 0) continue;
+			if (player_has_los_bold(yy, xx)) continue;
+			if (!cave_floor_bold(yy, xx)) continue;
+			if (distance(yy, xx, py, px) < 2) continue;
+
+			f->dist[yy][xx] = 0;
+			flow_queue[n++] = GRID(yy, xx);
+		}
+	}
+
+	flow_field_spread(f, n, FLOW_AMBUSH_DEPTH);
+}
+
+
+/*
+ * Return the number of steps from grid (y, x) to the nearest goal of flow
+ * field "which", or FLOW_FAR if there is none nearby.
+ */
+int monster_flow_dist(int which, int y, int x)
+{
+	struct flow_field *f = &flow_fields[which];
+
+	/* Rebuild the field if the view has changed */
+	if (!f->valid || (f->view_stamp != cave->view_stamp))
+	{
+		if (which == FLOW_SAFETY)
+			flow_build_safety(f);
+		else
+			flow_build_ambush(f);
+
+		f->valid = TRUE;
+		f->view_stamp = cave->view_stamp;
+	}
+
+	return (f->dist[y][x]);
+}
+
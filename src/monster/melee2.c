@@ -21,9 +21,14 @@
 #include "monster/constants.h"
 #include "monster/monster.h"
 #include "object/tvalsval.h"
+#include "perf.h"
 #include "spells.h"
 #include "squelch.h"
 
+#ifdef HAVE_PTHREAD_H
+# include <pthread.h>
+#endif
+
 /*
  * Determine if a bolt will arrive, checking that no monsters are in the way
  */
@@ -355,7 +360,7 @@ static bool summon_possible(int y1, int x1)
 			if (distance(y1, x1, y, x) > 2) continue;
 
 			/* Hack: no summon on glyph of warding */
-			if (cave_feat[y][x] == FEAT_GLYPH) continue;
+			if (cave->grid[y][x].feat == FEAT_GLYPH) continue;
 
 			/* Require empty floor grid in line of sight */
 			if (cave_empty_bold(y, x) && los(y1, x1, y, x))
@@ -440,6 +445,36 @@ static void breath(int m_idx, int typ, int dam_hp)
 	 BASE2_LOG_HACK_FRAGMENT(A,1))
 
 
+/*
+ * The spell groups from defines.h, built once as masks so that choosing a
+ * spell doesn't have to go through the lists with flags_test() every time
+ */
+static bitflag escape_mask[RSF_SIZE];
+static bitflag attack_mask[RSF_SIZE];
+static bitflag summon_mask[RSF_SIZE];
+static bitflag tactic_mask[RSF_SIZE];
+static bitflag annoy_mask[RSF_SIZE];
+static bitflag haste_mask[RSF_SIZE];
+static bitflag heal_mask[RSF_SIZE];
+static bitflag int_mask[RSF_SIZE];
+static bitflag bolt_mask[RSF_SIZE];
+
+static void spell_masks_init(void)
+{
+	if (!rsf_is_empty(attack_mask)) return;
+
+	flags_init(escape_mask, RSF_SIZE, RSF_ESCAPE_MASK, FLAG_END);
+	flags_init(attack_mask, RSF_SIZE, RSF_ATTACK_MASK, FLAG_END);
+	flags_init(summon_mask, RSF_SIZE, RSF_SUMMON_MASK, FLAG_END);
+	flags_init(tactic_mask, RSF_SIZE, RSF_TACTIC_MASK, FLAG_END);
+	flags_init(annoy_mask, RSF_SIZE, RSF_ANNOY_MASK, FLAG_END);
+	flags_init(haste_mask, RSF_SIZE, RSF_HASTE_MASK, FLAG_END);
+	flags_init(heal_mask, RSF_SIZE, RSF_HEAL_MASK, FLAG_END);
+	flags_init(int_mask, RSF_SIZE, RSF_INT_MASK, FLAG_END);
+	flags_init(bolt_mask, RSF_SIZE, RSF_BOLT_MASK, FLAG_END);
+}
+
+
 /*
  * Have a monster choose a spell to cast.
  *
@@ -469,14 +504,16 @@ static int choose_attack_spell(int m_idx, bitflag f[RSF_SIZE])
 	/* Smart monsters restrict their spell choices. */
 	if (OPT(adult_ai_smart) && !rf_has(r_ptr->flags, RF_STUPID))
 	{
+		spell_masks_init();
+
 		/* What have we got? */
-		has_escape = flags_test(f, RSF_SIZE, RSF_ESCAPE_MASK, FLAG_END);
-		has_attack = flags_test(f, RSF_SIZE, RSF_ATTACK_MASK, FLAG_END);
-		has_summon = flags_test(f, RSF_SIZE, RSF_SUMMON_MASK, FLAG_END);
-		has_tactic = flags_test(f, RSF_SIZE, RSF_TACTIC_MASK, FLAG_END);
-		has_annoy = flags_test(f, RSF_SIZE, RSF_ANNOY_MASK, FLAG_END);
-		has_haste = flags_test(f, RSF_SIZE, RSF_HASTE_MASK, FLAG_END);
-		has_heal = flags_test(f, RSF_SIZE, RSF_HEAL_MASK, FLAG_END);
+		has_escape = rsf_is_inter(f, escape_mask);
+		has_attack = rsf_is_inter(f, attack_mask);
+		has_summon = rsf_is_inter(f, summon_mask);
+		has_tactic = rsf_is_inter(f, tactic_mask);
+		has_annoy = rsf_is_inter(f, annoy_mask);
+		has_haste = rsf_is_inter(f, haste_mask);
+		has_heal = rsf_is_inter(f, heal_mask);
 
 		/*** Try to pick an appropriate spell type ***/
 
@@ -484,14 +521,14 @@ static int choose_attack_spell(int m_idx, bitflag f[RSF_SIZE])
 		if (has_escape && ((m_ptr->hp < m_ptr->maxhp / 4) || m_ptr->monfear))
 		{
 			/* Choose escape spell */
-			flags_mask(f, RSF_SIZE, RSF_ESCAPE_MASK, FLAG_END);
+			rsf_inter(f, escape_mask);
 		}
 
 		/* Still hurt badly, couldn't flee, attempt to heal */
 		else if (has_heal && m_ptr->hp < m_ptr->maxhp / 4)
 		{
 			/* Choose heal spell */
-			flags_mask(f, RSF_SIZE, RSF_HEAL_MASK, FLAG_END);
+			rsf_inter(f, heal_mask);
 		}
 
 		/* Player is close and we have attack spells, blink away */
@@ -499,7 +536,7 @@ static int choose_attack_spell(int m_idx, bitflag f[RSF_SIZE])
 		         has_attack && (randint0(100) < 75))
 		{
 			/* Choose tactical spell */
-			flags_mask(f, RSF_SIZE, RSF_TACTIC_MASK, FLAG_END);
+			rsf_inter(f, tactic_mask);
 		}
 
 		/* We're hurt (not badly), try to heal */
@@ -507,42 +544,42 @@ static int choose_attack_spell(int m_idx, bitflag f[RSF_SIZE])
 		         (randint0(100) < 60))
 		{
 			/* Choose heal spell */
-			flags_mask(f, RSF_SIZE, RSF_HEAL_MASK, FLAG_END);
+			rsf_inter(f, heal_mask);
 		}
 
 		/* Summon if possible (sometimes) */
 		else if (has_summon && (randint0(100) < 50))
 		{
 			/* Choose summon spell */
-			flags_mask(f, RSF_SIZE, RSF_SUMMON_MASK, FLAG_END);
+			rsf_inter(f, summon_mask);
 		}
 
 		/* Attack spell (most of the time) */
 		else if (has_attack && (randint0(100) < 85))
 		{
 			/* Choose attack spell */
-			flags_mask(f, RSF_SIZE, RSF_ATTACK_MASK, FLAG_END);
+			rsf_inter(f, attack_mask);
 		}
 
 		/* Try another tactical spell (sometimes) */
 		else if (has_tactic && (randint0(100) < 50))
 		{
 			/* Choose tactic spell */
-			flags_mask(f, RSF_SIZE, RSF_TACTIC_MASK, FLAG_END);
+			rsf_inter(f, tactic_mask);
 		}
 
 		/* Haste self if we aren't already somewhat hasted (rarely) */
 		else if (has_haste && (randint0(100) < (20 + r_ptr->speed - m_ptr->mspeed)))
 		{
 			/* Choose haste spell */
-			flags_mask(f, RSF_SIZE, RSF_HASTE_MASK, FLAG_END);
+			rsf_inter(f, haste_mask);
 		}
 
 		/* Annoy player (most of the time) */
 		else if (has_annoy && (randint0(100) < 85))
 		{
 			/* Choose annoyance spell */
-			flags_mask(f, RSF_SIZE, RSF_ANNOY_MASK, FLAG_END);
+			rsf_inter(f, annoy_mask);
 		}
 
 		/* Else choose no spell */
@@ -556,10 +593,8 @@ static int choose_attack_spell(int m_idx, bitflag f[RSF_SIZE])
 	}
 
 	/* Extract all spells: "innate", "normal", "bizarre" */
-	for (i = FLAG_START, num = 0; i < RSF_MAX; i++)
-	{
-		if (rsf_has(f, i)) spells[num++] = i;
-	}
+	for (i = rsf_next(f, FLAG_START); i != FLAG_END; i = rsf_next(f, i + 1))
+		spells[num++] = i;
 
 	/* Paranoia */
 	if (num == 0) return 0;
@@ -676,7 +711,7 @@ bool make_attack_spell(int m_idx)
 		if (m_ptr->cdis > MAX_RANGE) return (FALSE);
 
 		/* Check path */
-		if (!projectable(m_ptr->fy, m_ptr->fx, py, px, PROJECT_NONE))
+		if (!projectable_to_player(m_ptr->fy, m_ptr->fx))
 			return (FALSE);
 	}
 
@@ -685,6 +720,8 @@ bool make_attack_spell(int m_idx)
 	rlev = ((r_ptr->level >= 1) ? r_ptr->level : 1);
 
 
+	spell_masks_init();
+
 	/* Extract the racial spell flags */
 	rsf_copy(f, r_ptr->spell_flags);
 
@@ -695,7 +732,7 @@ bool make_attack_spell(int m_idx)
 	    randint0(100) < 50)
 	{
 		/* Require intelligent spells */
-		flags_mask(f, RSF_SIZE, RSF_INT_MASK, FLAG_END);
+		rsf_inter(f, int_mask);
 
 		/* No spells left */
 		if (rsf_is_empty(f)) return (FALSE);
@@ -712,18 +749,19 @@ bool make_attack_spell(int m_idx)
 	if (!rf_has(r_ptr->flags, RF_STUPID))
 	{
 		/* Check for a clean bolt shot */
-		if (flags_test(f, RSF_SIZE, RSF_BOLT_MASK, FLAG_END) &&
+		if (rsf_is_inter(f, bolt_mask) &&
 			!clean_shot(m_ptr->fy, m_ptr->fx, py, px))
 		{
 			/* Remove spells that will only hurt friends */
-			flags_clear(f, RSF_SIZE, RSF_BOLT_MASK, FLAG_END);
+			rsf_diff(f, bolt_mask);
 		}
 
-		/* Check for a possible summon */
-		if (!(summon_possible(m_ptr->fy, m_ptr->fx)))
+		/* Check for a possible summon, if there are any to cast */
+		if (rsf_is_inter(f, summon_mask) &&
+		    !summon_possible(m_ptr->fy, m_ptr->fx))
 		{
 			/* Remove summoning spells */
-			flags_clear(f, RSF_SIZE, RSF_SUMMON_MASK, FLAG_END);
+			rsf_diff(f, summon_mask);
 		}
 
 		/* No spells left */
@@ -1598,14 +1636,14 @@ bool make_attack_spell(int m_idx)
 			if (m_ptr->mspeed < r_ptr->speed + 10)
 			{
 				msg_format("%^s starts moving faster.", m_name);
-				m_ptr->mspeed += 10;
+				monster_set_speed(m_idx, m_ptr->mspeed + 10);
 			}
 
 			/* Allow small speed increases to base+20 */
 			else if (m_ptr->mspeed < r_ptr->speed + 20)
 			{
 				msg_format("%^s starts moving faster.", m_name);
-				m_ptr->mspeed += 2;
+				monster_set_speed(m_idx, m_ptr->mspeed + 2);
 			}
 
 			break;
@@ -2192,18 +2230,18 @@ static bool get_moves_aux(int m_idx, int *yp, int *xp)
 	x1 = m_ptr->fx;
 
 	/* The player is not currently near the monster grid */
-	if (cave_when[y1][x1] < cave_when[py][px])
+	if (cave->when[y1][x1] < cave->when[py][px])
 	{
-		/* The player has never been near the monster grid */
-		if (cave_when[y1][x1] == 0) return (FALSE);
+		/* The player has never been near the monster grid (recently) */
+		if (!flow_trail(y1, x1)) return (FALSE);
 
 		/* The monster is not allowed to track the player */
 		if (!OPT(adult_ai_smell)) return (FALSE);
 	}
 
 	/* Monster is too far away to notice the player */
-	if (cave_cost[y1][x1] > MONSTER_FLOW_DEPTH) return (FALSE);
-	if (cave_cost[y1][x1] > r_ptr->aaf) return (FALSE);
+	if (cave->cost[y1][x1] > MONSTER_FLOW_DEPTH) return (FALSE);
+	if (cave->cost[y1][x1] > r_ptr->aaf) return (FALSE);
 
 	/* Hack -- Player can see us, run towards him */
 	if (player_has_los_bold(y1, x1)) return (FALSE);
@@ -2216,17 +2254,17 @@ static bool get_moves_aux(int m_idx, int *yp, int *xp)
 		x = x1 + ddx_ddd[i];
 
 		/* Ignore illegal locations */
-		if (cave_when[y][x] == 0) continue;
+		if (!flow_trail(y, x)) continue;
 
 		/* Ignore ancient locations */
-		if (cave_when[y][x] < when) continue;
+		if (cave->when[y][x] < when) continue;
 
 		/* Ignore distant locations */
-		if (cave_cost[y][x] > cost) continue;
+		if (cave->cost[y][x] > cost) continue;
 
 		/* Save the cost and time */
-		when = cave_when[y][x];
-		cost = cave_cost[y][x];
+		when = cave->when[y][x];
+		cost = cave->cost[y][x];
 
 		/* Hack -- Save the "twiddled" location */
 		(*yp) = py + 16 * ddy_ddd[i];
@@ -2240,6 +2278,201 @@ static bool get_moves_aux(int m_idx, int *yp, int *xp)
 	return (TRUE);
 }
 
+
+/*
+ * Monster plans
+ *
+ * When a lot of monsters are due at once, the parts of their decisions which
+ * only read the level -- for now, get_moves_aux() -- are worked out for all
+ * of them before any of them acts, on MONSTER_PLAN_THREADS threads.  Each
+ * monster then uses its plan when it comes to decide, but only if nothing
+ * the plan was made from has changed since, and otherwise decides as usual.
+ * A plan is a pure function of what it checks, so the game goes exactly the
+ * same way whether plans are made or not and however many threads make them.
+ */
+#define MONSTER_PLAN_MIN	128	/* Due monsters needed to bother */
+#define MONSTER_PLAN_THREADS	4
+
+struct monster_plan
+{
+	bool valid;
+
+	/* What it was made from */
+	s16b r_idx;
+	byte fy, fx;
+	byte py, px;
+	u32b view_stamp;
+	u32b flow_stamp;
+
+	/* get_moves_aux() */
+	bool moves;
+	s16b y, x;
+};
+
+static struct monster_plan *monster_plans;
+static int monster_plans_size;
+
+/* The monsters to plan for */
+static s16b *plan_queue;
+static int plan_count;
+
+/*
+ * Make the plan for monster `m_idx`.  This mustn't change anything but the
+ * plan, as it runs on many threads at once.
+ */
+static void monster_plan_make(int m_idx)
+{
+	struct monster_plan *plan = &monster_plans[m_idx];
+	const monster_type *m_ptr = &mon_list[m_idx];
+	int y = 0, x = 0;
+
+	plan->r_idx = m_ptr->r_idx;
+	plan->fy = m_ptr->fy;
+	plan->fx = m_ptr->fx;
+	plan->py = p_ptr->py;
+	plan->px = p_ptr->px;
+	plan->view_stamp = cave->view_stamp;
+	plan->flow_stamp = cave->flow_stamp;
+
+	plan->moves = get_moves_aux(m_idx, &y, &x);
+	plan->y = y;
+	plan->x = x;
+
+	plan->valid = TRUE;
+}
+
+/*
+ * Make every `step`th plan in plan_queue[], starting with the `first`
+ */
+static void monster_plan_share(int first, int step)
+{
+	int i;
+
+	for (i = first; i < plan_count; i += step)
+		monster_plan_make(plan_queue[i]);
+}
+
+#ifdef HAVE_PTHREAD_H
+
+static pthread_mutex_t plan_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t plan_start = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t plan_done = PTHREAD_COND_INITIALIZER;
+
+/* Rounds of planning started, and helpers still busy with this one */
+static u32b plan_round;
+static int plan_busy;
+
+/* Threads helping the game thread, once started */
+static int plan_helpers = -1;
+
+static void *plan_thread_main(void *arg)
+{
+	int first = (int)(size_t)arg;
+	u32b round = 0;
+
+	pthread_mutex_lock(&plan_lock);
+
+	while (TRUE)
+	{
+		while (plan_round == round)
+			pthread_cond_wait(&plan_start, &plan_lock);
+
+		round = plan_round;
+		pthread_mutex_unlock(&plan_lock);
+
+		monster_plan_share(first, plan_helpers + 1);
+
+		pthread_mutex_lock(&plan_lock);
+		if (--plan_busy == 0) pthread_cond_signal(&plan_done);
+	}
+
+	return NULL;
+}
+
+/*
+ * Make all the plans in plan_queue[], sharing them out between the helper
+ * threads and this one
+ */
+static void monster_plan_all(void)
+{
+	/* Start the helpers the first time */
+	if (plan_helpers < 0)
+	{
+		pthread_t thread;
+
+		for (plan_helpers = 0; plan_helpers < MONSTER_PLAN_THREADS - 1;
+				plan_helpers++)
+		{
+			if (pthread_create(&thread, NULL, plan_thread_main,
+					(void *)(size_t)(plan_helpers + 1)))
+				break;
+
+			pthread_detach(thread);
+		}
+	}
+
+	/* The helpers only count as started if they all are */
+	if (plan_helpers < MONSTER_PLAN_THREADS - 1)
+	{
+		monster_plan_share(0, 1);
+		return;
+	}
+
+	pthread_mutex_lock(&plan_lock);
+	plan_busy = plan_helpers;
+	plan_round++;
+	pthread_cond_broadcast(&plan_start);
+	pthread_mutex_unlock(&plan_lock);
+
+	monster_plan_share(0, plan_helpers + 1);
+
+	pthread_mutex_lock(&plan_lock);
+	while (plan_busy)
+		pthread_cond_wait(&plan_done, &plan_lock);
+	pthread_mutex_unlock(&plan_lock);
+}
+
+#else /* HAVE_PTHREAD_H */
+
+static void monster_plan_all(void)
+{
+	monster_plan_share(0, 1);
+}
+
+#endif /* HAVE_PTHREAD_H */
+
+/*
+ * get_moves_aux(), using the monster's plan if it still holds
+ */
+static bool get_moves_planned(int m_idx, int *yp, int *xp)
+{
+	struct monster_plan *plan;
+	const monster_type *m_ptr = &mon_list[m_idx];
+
+	if (m_idx >= monster_plans_size) return get_moves_aux(m_idx, yp, xp);
+
+	plan = &monster_plans[m_idx];
+	if (!plan->valid) return get_moves_aux(m_idx, yp, xp);
+
+	/* Plans are only good for one move */
+	plan->valid = FALSE;
+
+	if ((plan->r_idx != m_ptr->r_idx) ||
+	    (plan->fy != m_ptr->fy) || (plan->fx != m_ptr->fx) ||
+	    (plan->py != p_ptr->py) || (plan->px != p_ptr->px) ||
+	    (plan->view_stamp != cave->view_stamp) ||
+	    (plan->flow_stamp != cave->flow_stamp))
+		return get_moves_aux(m_idx, yp, xp);
+
+	if (plan->moves)
+	{
+		*yp = plan->y;
+		*xp = plan->x;
+	}
+
+	return plan->moves;
+}
+
 /*
  * Provide a location to flee to, but give the player a wide berth.
  *
@@ -2272,15 +2505,15 @@ static bool get_fear_moves_aux(int m_idx, int *yp, int *xp)
 	x1 = fx - (*xp);
 
 	/* The player is not currently near the monster grid */
-	if (cave_when[fy][fx] < cave_when[py][px])
+	if (cave->when[fy][fx] < cave->when[py][px])
 	{
 		/* No reason to attempt flowing */
 		return (FALSE);
 	}
 
 	/* Monster is too far away to use flow information */
-	if (cave_cost[fy][fx] > MONSTER_FLOW_DEPTH) return (FALSE);
-	if (cave_cost[fy][fx] > r_ptr->aaf) return (FALSE);
+	if (cave->cost[fy][fx] > MONSTER_FLOW_DEPTH) return (FALSE);
+	if (cave->cost[fy][fx] > r_ptr->aaf) return (FALSE);
 
 	/* Check nearby grids, diagonals first */
 	for (i = 7; i >= 0; i--)
@@ -2292,16 +2525,16 @@ static bool get_fear_moves_aux(int m_idx, int *yp, int *xp)
 		x = fx + ddx_ddd[i];
 
 		/* Ignore illegal locations */
-		if (cave_when[y][x] == 0) continue;
+		if (!flow_trail(y, x)) continue;
 
 		/* Ignore ancient locations */
-		if (cave_when[y][x] < when) continue;
+		if (cave->when[y][x] < when) continue;
 
 		/* Calculate distance of this grid from our destination */
 		dis = distance(y, x, y1, x1);
 
 		/* Score this grid */
-		s = 5000 / (dis + 3) - 500 / (cave_cost[y][x] + 1);
+		s = 5000 / (dis + 3) - 500 / (cave->cost[y][x] + 1);
 
 		/* No negative scores */
 		if (s < 0) s = 0;
@@ -2310,7 +2543,7 @@ static bool get_fear_moves_aux(int m_idx, int *yp, int *xp)
 		if (s < score) continue;
 
 		/* Save the score and time */
-		when = cave_when[y][x];
+		when = cave->when[y][x];
 		score = s;
 
 		/* Save the location */
@@ -2331,151 +2564,17 @@ static bool get_fear_moves_aux(int m_idx, int *yp, int *xp)
 
 
 
-/*
- * Hack -- Precompute a bunch of calls to distance() in find_safety() and
- * find_hiding().
- *
- * The pair of arrays dist_offsets_y[n] and dist_offsets_x[n] contain the
- * offsets of all the locations with a distance of n from a central point,
- * with an offset of (0,0) indicating no more offsets at this distance.
- *
- * This is, of course, fairly unreadable, but it eliminates multiple loops
- * from the previous version.
- *
- * It is probably better to replace these arrays with code to compute
- * the relevant arrays, even if the storage is pre-allocated in hard
- * coded sizes.  At the very least, code should be included which is
- * able to generate and dump these arrays (ala "los()").  XXX XXX XXX
- *
- * Also, the storage needs could be reduced by using char.  XXX XXX XXX
- *
- * These arrays could be combined into two big arrays, using sub-arrays
- * to hold the offsets and lengths of each portion of the sub-arrays, and
- * this could perhaps also be used somehow in the "look" code.  XXX XXX XXX
- */
-
-
-static const int d_off_y_0[] =
-{ 0 };
-
-static const int d_off_x_0[] =
-{ 0 };
-
-
-static const int d_off_y_1[] =
-{ -1, -1, -1, 0, 0, 1, 1, 1, 0 };
-
-static const int d_off_x_1[] =
-{ -1, 0, 1, -1, 1, -1, 0, 1, 0 };
-
-
-static const int d_off_y_2[] =
-{ -1, -1, -2, -2, -2, 0, 0, 1, 1, 2, 2, 2, 0 };
-
-static const int d_off_x_2[] =
-{ -2, 2, -1, 0, 1, -2, 2, -2, 2, -1, 0, 1, 0 };
-
-
-static const int d_off_y_3[] =
-{ -1, -1, -2, -2, -3, -3, -3, 0, 0, 1, 1, 2, 2,
-  3, 3, 3, 0 };
-
-static const int d_off_x_3[] =
-{ -3, 3, -2, 2, -1, 0, 1, -3, 3, -3, 3, -2, 2,
-  -1, 0, 1, 0 };
-
-
-static const int d_off_y_4[] =
-{ -1, -1, -2, -2, -3, -3, -3, -3, -4, -4, -4, 0,
-  0, 1, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 0 };
-
-static const int d_off_x_4[] =
-{ -4, 4, -3, 3, -2, -3, 2, 3, -1, 0, 1, -4, 4,
-  -4, 4, -3, 3, -2, -3, 2, 3, -1, 0, 1, 0 };
-
-
-static const int d_off_y_5[] =
-{ -1, -1, -2, -2, -3, -3, -4, -4, -4, -4, -5, -5,
-  -5, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 4, 4, 5, 5,
-  5, 0 };
-
-static const int d_off_x_5[] =
-{ -5, 5, -4, 4, -4, 4, -2, -3, 2, 3, -1, 0, 1,
-  -5, 5, -5, 5, -4, 4, -4, 4, -2, -3, 2, 3, -1,
-  0, 1, 0 };
-
-
-static const int d_off_y_6[] =
-{ -1, -1, -2, -2, -3, -3, -4, -4, -5, -5, -5, -5,
-  -6, -6, -6, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5,
-  5, 5, 6, 6, 6, 0 };
-
-static const int d_off_x_6[] =
-{ -6, 6, -5, 5, -5, 5, -4, 4, -2, -3, 2, 3, -1,
-  0, 1, -6, 6, -6, 6, -5, 5, -5, 5, -4, 4, -2,
-  -3, 2, 3, -1, 0, 1, 0 };
-
-
-static const int d_off_y_7[] =
-{ -1, -1, -2, -2, -3, -3, -4, -4, -5, -5, -5, -5,
-  -6, -6, -6, -6, -7, -7, -7, 0, 0, 1, 1, 2, 2, 3,
-  3, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 0 };
-
-static const int d_off_x_7[] =
-{ -7, 7, -6, 6, -6, 6, -5, 5, -4, -5, 4, 5, -2,
-  -3, 2, 3, -1, 0, 1, -7, 7, -7, 7, -6, 6, -6,
-  6, -5, 5, -4, -5, 4, 5, -2, -3, 2, 3, -1, 0,
-  1, 0 };
-
-
-static const int d_off_y_8[] =
-{ -1, -1, -2, -2, -3, -3, -4, -4, -5, -5, -6, -6,
-  -6, -6, -7, -7, -7, -7, -8, -8, -8, 0, 0, 1, 1,
-  2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
-  8, 8, 8, 0 };
-
-static const int d_off_x_8[] =
-{ -8, 8, -7, 7, -7, 7, -6, 6, -6, 6, -4, -5, 4,
-  5, -2, -3, 2, 3, -1, 0, 1, -8, 8, -8, 8, -7,
-  7, -7, 7, -6, 6, -6, 6, -4, -5, 4, 5, -2, -3,
-  2, 3, -1, 0, 1, 0 };
-
-
-static const int d_off_y_9[] =
-{ -1, -1, -2, -2, -3, -3, -4, -4, -5, -5, -6, -6,
-  -7, -7, -7, -7, -8, -8, -8, -8, -9, -9, -9, 0,
-  0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 7,
-  7, 8, 8, 8, 8, 9, 9, 9, 0 };
-
-static const int d_off_x_9[] =
-{ -9, 9, -8, 8, -8, 8, -7, 7, -7, 7, -6, 6, -4,
-  -5, 4, 5, -2, -3, 2, 3, -1, 0, 1, -9, 9, -9,
-  9, -8, 8, -8, 8, -7, 7, -7, 7, -6, 6, -4, -5,
-  4, 5, -2, -3, 2, 3, -1, 0, 1, 0 };
-
-
-static const int *dist_offsets_y[10] =
-{
-	d_off_y_0, d_off_y_1, d_off_y_2, d_off_y_3, d_off_y_4,
-	d_off_y_5, d_off_y_6, d_off_y_7, d_off_y_8, d_off_y_9
-};
-
-static const int *dist_offsets_x[10] =
-{
-	d_off_x_0, d_off_x_1, d_off_x_2, d_off_x_3, d_off_x_4,
-	d_off_x_5, d_off_x_6, d_off_x_7, d_off_x_8, d_off_x_9
-};
-
-
 /*
  * Choose a "safe" location near a monster for it to run toward.
  *
- * A location is "safe" if it can be reached quickly and the player
- * is not able to fire into it (it isn't a "clean shot").  So, this will
- * cause monsters to "duck" behind walls.  Hopefully, monsters will also
- * try to run towards corridor openings if they are in a room.
+ * A location is "safe" if the player is not able to fire into it (it
+ * isn't a "clean shot").  So, this will cause monsters to "duck" behind
+ * walls.  Hopefully, monsters will also try to run towards corridor
+ * openings if they are in a room.
  *
- * This function may take lots of CPU time if lots of monsters are fleeing.
+ * The monster heads down the shared "safety" flow field, preferring grids
+ * further from the player, and once safe it keeps away from the player
+ * without leaving cover.
  *
  * Return TRUE if a safe location is available.
  */
@@ -2489,73 +2588,52 @@ static bool find_safety(int m_idx, int *yp, int *xp)
 	int py = p_ptr->py;
 	int px = p_ptr->px;
 
-	int i, y, x, dy, dx, d, dis;
-	int gy = 0, gx = 0, gdis = 0;
+	int i, y, x, d, dis;
+	int gy = fy, gx = fx;
+	int gd = monster_flow_dist(FLOW_SAFETY, fy, fx);
+	int gdis = distance(fy, fx, py, px);
 
-	const int *y_offsets;
-	const int *x_offsets;
+	/* No safe place nearby */
+	if (gd == FLOW_FAR) return (FALSE);
 
-	/* Start with adjacent locations, spread further */
-	for (d = 1; d < 10; d++)
+	/* Check adjacent locations */
+	for (i = 0; i < 8; i++)
 	{
-		/* Get the lists of points with a distance d from (fx, fy) */
-		y_offsets = dist_offsets_y[d];
-		x_offsets = dist_offsets_x[d];
-
-		/* Check the locations */
-		for (i = 0, dx = x_offsets[0], dy = y_offsets[0];
-		     dx != 0 || dy != 0;
-		     i++, dx = x_offsets[i], dy = y_offsets[i])
-		{
-			y = fy + dy;
-			x = fx + dx;
-
-			/* Skip illegal locations */
-			if (!in_bounds_fully(y, x)) continue;
-
-			/* Skip locations in a wall */
-			if (!cave_floor_bold(y, x)) continue;
+		y = fy + ddy_ddd[i];
+		x = fx + ddx_ddd[i];
 
-			/* Check for "availability" (if monsters can flow) */
-			if (OPT(adult_ai_sound))
-			{
-				/* Ignore grids very far from the player */
-				if (cave_when[y][x] < cave_when[py][px]) continue;
+		/* Skip illegal locations */
+		if (!in_bounds_fully(y, x)) continue;
 
-				/* Ignore too-distant grids */
-				if (cave_cost[y][x] > cave_cost[fy][fx] + 2 * d) continue;
-			}
+		/* Skip locations in a wall */
+		if (!cave_floor_bold(y, x)) continue;
 
-			/* Check for absence of shot (more or less) */
-			if (!player_has_los_bold(y,x))
-			{
-				/* Calculate distance from player */
-				dis = distance(y, x, py, px);
+		/* Never move away from safety */
+		d = monster_flow_dist(FLOW_SAFETY, y, x);
+		if (d > gd) continue;
 
-				/* Remember if further than previous */
-				if (dis > gdis)
-				{
-					gy = y;
-					gx = x;
-					gdis = dis;
-				}
-			}
-		}
+		/* Calculate distance from player */
+		dis = distance(y, x, py, px);
 
-		/* Check for success */
-		if (gdis > 0)
+		/* Remember if closer to safety, or further from the player */
+		if ((d < gd) || ((d == gd) && (dis > gdis)))
 		{
-			/* Good location */
-			(*yp) = fy - gy;
-			(*xp) = fx - gx;
-
-			/* Found safe place */
-			return (TRUE);
+			gy = y;
+			gx = x;
+			gd = d;
+			gdis = dis;
 		}
 	}
 
-	/* No safe place */
-	return (FALSE);
+	/* Nowhere better to go */
+	if ((gy == fy) && (gx == fx) && gd) return (FALSE);
+
+	/* Good location */
+	(*yp) = fy - gy;
+	(*xp) = fx - gx;
+
+	/* Found safe place */
+	return (TRUE);
 }
 
 
@@ -2567,6 +2645,9 @@ static bool find_safety(int m_idx, int *yp, int *xp)
  * Pack monsters will use this to "ambush" the player and lure him out
  * of corridors into open space so they can swarm him.
  *
+ * The monster heads down the shared "ambush" flow field, towards grids
+ * just out of the player's sight, and then lies in wait there.
+ *
  * Return TRUE if a good location is available.
  */
 static bool find_hiding(int m_idx, int *yp, int *xp)
@@ -2579,65 +2660,61 @@ static bool find_hiding(int m_idx, int *yp, int *xp)
 	int py = p_ptr->py;
 	int px = p_ptr->px;
 
-	int i, y, x, dy, dx, d, dis;
-	int gy = 0, gx = 0, gdis = 999, min;
-
-	const int *y_offsets, *x_offsets;
+	int i, y, x, d, dis;
+	int gy = fy, gx = fx, gdis = 999;
+	int gd = monster_flow_dist(FLOW_AMBUSH, fy, fx);
+	int here = gd;
 
-	/* Closest distance to get */
-	min = distance(py, px, fy, fx) * 3 / 4 + 2;
+	/* No good place nearby */
+	if (here == FLOW_FAR) return (FALSE);
 
-	/* Start with adjacent locations, spread further */
-	for (d = 1; d < 10; d++)
+	/* Already in place */
+	if (here == 0)
 	{
-		/* Get the lists of points with a distance d from (fx, fy) */
-		y_offsets = dist_offsets_y[d];
-		x_offsets = dist_offsets_x[d];
+		(*yp) = 0;
+		(*xp) = 0;
 
-		/* Check the locations */
-		for (i = 0, dx = x_offsets[0], dy = y_offsets[0];
-		     dx != 0 || dy != 0;
-		     i++, dx = x_offsets[i], dy = y_offsets[i])
-		{
-			y = fy + dy;
-			x = fx + dx;
+		return (TRUE);
+	}
 
-			/* Skip illegal locations */
-			if (!in_bounds_fully(y, x)) continue;
+	/* Check adjacent locations */
+	for (i = 0; i < 8; i++)
+	{
+		y = fy + ddy_ddd[i];
+		x = fx + ddx_ddd[i];
 
-			/* Skip occupied locations */
-			if (!cave_empty_bold(y, x)) continue;
+		/* Skip illegal locations */
+		if (!in_bounds_fully(y, x)) continue;
 
-			/* Check for hidden, available grid */
-			if (!player_has_los_bold(y, x) && (clean_shot(fy, fx, y, x)))
-			{
-				/* Calculate distance from player */
-				dis = distance(y, x, py, px);
+		/* Skip occupied locations */
+		if (!cave_empty_bold(y, x)) continue;
 
-				/* Remember if closer than previous */
-				if (dis < gdis && dis >= min)
-				{
-					gy = y;
-					gx = x;
-					gdis = dis;
-				}
-			}
-		}
+		/* Only move closer to the hiding place */
+		d = monster_flow_dist(FLOW_AMBUSH, y, x);
+		if (d >= here) continue;
 
-		/* Check for success */
-		if (gdis < 999)
-		{
-			/* Good location */
-			(*yp) = fy - gy;
-			(*xp) = fx - gx;
+		/* Calculate distance from player */
+		dis = distance(y, x, py, px);
 
-			/* Found good place */
-			return (TRUE);
+		/* Remember if closer than previous */
+		if ((d < gd) || ((d == gd) && (dis < gdis)))
+		{
+			gy = y;
+			gx = x;
+			gd = d;
+			gdis = dis;
 		}
 	}
 
 	/* No good place */
-	return (FALSE);
+	if ((gy == fy) && (gx == fx)) return (FALSE);
+
+	/* Good location */
+	(*yp) = fy - gy;
+	(*xp) = fx - gx;
+
+	/* Found good place */
+	return (TRUE);
 }
 
 
@@ -2667,7 +2744,7 @@ static bool get_moves(int m_idx, int mm[5])
 	if (OPT(adult_ai_sound))
 	{
 		/* Flow towards the player */
-		(void)get_moves_aux(m_idx, &y2, &x2);
+		(void)get_moves_planned(m_idx, &y2, &x2);
 	}
 
 	/* Extract the "pseudo-direction" */
@@ -2688,8 +2765,8 @@ static bool get_moves(int m_idx, int mm[5])
 		{
 			/* Check grid around the player for room interior (room walls count)
 			   or other empty space */
-			if ((cave_feat[py + ddy_ddd[i]][px + ddx_ddd[i]] <= FEAT_MORE) ||
-				(cave_info[py + ddy_ddd[i]][px + ddx_ddd[i]] & (CAVE_ROOM)))
+			if ((cave->grid[py + ddy_ddd[i]][px + ddx_ddd[i]].feat <= FEAT_MORE) ||
+				(cave->grid[py + ddy_ddd[i]][px + ddx_ddd[i]].info & (CAVE_ROOM)))
 			{
 				/* One more open grid */
 				open++;
@@ -3261,7 +3338,7 @@ static void process_monster(int m_idx)
 			for (x = ox - 1; x <= ox + 1; x++)
 			{
 				/* Count monsters */
-				if (cave_m_idx[y][x] > 0) k++;
+				if (cave->grid[y][x].m_idx > 0) k++;
 			}
 		}
 
@@ -3374,7 +3451,7 @@ static void process_monster(int m_idx)
 		}
 
 		/* Permanent wall in the way */
-		else if (cave_feat[ny][nx] >= FEAT_PERM_EXTRA)
+		else if (cave->grid[ny][nx].feat >= FEAT_PERM_EXTRA)
 		{
 			/* Nothing */
 		}
@@ -3405,7 +3482,7 @@ static void process_monster(int m_idx)
 				do_move = TRUE;
 
 				/* Forget the wall */
-				cave_info[ny][nx] &= ~(CAVE_MARK);
+				cave->grid[ny][nx].info &= ~(CAVE_MARK);
 
 				/* Notice */
 				cave_set_feat(ny, nx, FEAT_FLOOR);
@@ -3415,9 +3492,9 @@ static void process_monster(int m_idx)
 			}
 
 			/* Handle doors and secret doors */
-			else if (((cave_feat[ny][nx] >= FEAT_DOOR_HEAD) &&
-						 (cave_feat[ny][nx] <= FEAT_DOOR_TAIL)) ||
-						(cave_feat[ny][nx] == FEAT_SECRET))
+			else if (((cave->grid[ny][nx].feat >= FEAT_DOOR_HEAD) &&
+						 (cave->grid[ny][nx].feat <= FEAT_DOOR_TAIL)) ||
+						(cave->grid[ny][nx].feat == FEAT_SECRET))
 			{
 				bool may_bash = TRUE;
 
@@ -3435,8 +3512,8 @@ static void process_monster(int m_idx)
 				if (rf_has(r_ptr->flags, RF_OPEN_DOOR))
 				{
 					/* Closed doors and secret doors */
-					if ((cave_feat[ny][nx] == FEAT_DOOR_HEAD) ||
-						 (cave_feat[ny][nx] == FEAT_SECRET))
+					if ((cave->grid[ny][nx].feat == FEAT_DOOR_HEAD) ||
+						 (cave->grid[ny][nx].feat == FEAT_SECRET))
 					{
 						/* The door is open */
 						did_open_door = TRUE;
@@ -3446,12 +3523,12 @@ static void process_monster(int m_idx)
 					}
 
 					/* Locked doors (not jammed) */
-					else if (cave_feat[ny][nx] < FEAT_DOOR_HEAD + 0x08)
+					else if (cave->grid[ny][nx].feat < FEAT_DOOR_HEAD + 0x08)
 					{
 						int k;
 
 						/* Door power */
-						k = ((cave_feat[ny][nx] - FEAT_DOOR_HEAD) & 0x07);
+						k = ((cave->grid[ny][nx].feat - FEAT_DOOR_HEAD) & 0x07);
 
 						/* Try to unlock it XXX XXX XXX */
 						if (randint0(m_ptr->hp / 10) > k)
@@ -3471,7 +3548,7 @@ static void process_monster(int m_idx)
 					int k;
 
 					/* Door power */
-					k = ((cave_feat[ny][nx] - FEAT_DOOR_HEAD) & 0x07);
+					k = ((cave->grid[ny][nx].feat - FEAT_DOOR_HEAD) & 0x07);
 
 					/* Attempt to Bash XXX XXX XXX */
 					if (randint0(m_ptr->hp / 10) > k)
@@ -3513,7 +3590,7 @@ static void process_monster(int m_idx)
 
 
 		/* Hack -- check for Glyph of Warding */
-		if (do_move && (cave_feat[ny][nx] == FEAT_GLYPH))
+		if (do_move && (cave->grid[ny][nx].feat == FEAT_GLYPH))
 		{
 			/* Assume no move allowed */
 			do_move = FALSE;
@@ -3522,13 +3599,13 @@ static void process_monster(int m_idx)
 			if (randint1(BREAK_GLYPH) < r_ptr->level)
 			{
 				/* Describe observable breakage */
-				if (cave_info[ny][nx] & (CAVE_MARK))
+				if (cave->grid[ny][nx].info & (CAVE_MARK))
 				{
 					msg_print("The rune of protection is broken!");
 				}
 
 				/* Forget the rune */
-				cave_info[ny][nx] &= ~(CAVE_MARK);
+				cave->grid[ny][nx].info &= ~(CAVE_MARK);
 
 				/* Break the rune */
 				cave_set_feat(ny, nx, FEAT_FLOOR);
@@ -3540,7 +3617,7 @@ static void process_monster(int m_idx)
 
 
 		/* The player is in the way. */
-		if (do_move && (cave_m_idx[ny][nx] < 0))
+		if (do_move && (cave->grid[ny][nx].m_idx < 0))
 		{
 			/* Learn about if the monster attacks */
 			if (m_ptr->ml) rf_on(l_ptr->flags, RF_NEVER_BLOW);
@@ -3579,9 +3656,9 @@ static void process_monster(int m_idx)
 
 
 		/* A monster is in the way */
-		if (do_move && (cave_m_idx[ny][nx] > 0))
+		if (do_move && (cave->grid[ny][nx].m_idx > 0))
 		{
-			monster_type *n_ptr = &mon_list[cave_m_idx[ny][nx]];
+			monster_type *n_ptr = &mon_list[cave->grid[ny][nx].m_idx];
 
 			/* Kill weaker monsters */
 			int kill_ok = rf_has(r_ptr->flags, RF_KILL_BODY);
@@ -3663,7 +3740,7 @@ static void process_monster(int m_idx)
 
 
 			/* Scan all objects in the grid */
-			for (this_o_idx = cave_o_idx[ny][nx]; this_o_idx; this_o_idx = next_o_idx)
+			for (this_o_idx = cave->grid[ny][nx].o_idx; this_o_idx; this_o_idx = next_o_idx)
 			{
 				object_type *o_ptr;
 
@@ -3795,9 +3872,6 @@ static void process_monster(int m_idx)
 	{
 		/* Update the visuals */
 		p_ptr->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
-
-		/* Fully update the flow XXX XXX XXX */
-		p_ptr->update |= (PU_FORGET_FLOW | PU_UPDATE_FLOW);
 	}
 
 
@@ -3837,9 +3911,9 @@ static bool monster_can_flow(int m_idx)
 		int fx = m_ptr->fx;
 
 		/* Check the flow (normal aaf is about 20) */
-		if ((cave_when[fy][fx] == cave_when[p_ptr->py][p_ptr->px]) &&
-		    (cave_cost[fy][fx] < MONSTER_FLOW_DEPTH) &&
-		    (cave_cost[fy][fx] < r_ptr->aaf))
+		if ((cave->when[fy][fx] == cave->when[p_ptr->py][p_ptr->px]) &&
+		    (cave->cost[fy][fx] < MONSTER_FLOW_DEPTH) &&
+		    (cave->cost[fy][fx] < r_ptr->aaf))
 		{
 			return TRUE;
 		}
@@ -3851,12 +3925,211 @@ static bool monster_can_flow(int m_idx)
 
 
 
+/*
+ * Monsters waiting to act, in a "timing wheel" of lists indexed by the game
+ * turn on which each monster next has enough energy to move.  Even the
+ * slowest monster gets a move every 100 game turns, so no monster is ever
+ * due further ahead than the wheel goes round.
+ *
+ * A monster's "energy" is only brought up to date when it acts or changes
+ * speed, as of "energy_turn"; in between it is implied by its speed, so
+ * monsters which aren't due cost nothing per game turn.
+ *
+ * Each list is kept in decreasing order of monster index, the order in
+ * which monsters have always been processed.
+ */
+#define SCHED_SLOTS	128
+
+static s16b sched_head[SCHED_SLOTS];
+
+
+/*
+ * Return the current energy of a monster
+ */
+int monster_energy(int m_idx)
+{
+	monster_type *m_ptr = &mon_list[m_idx];
+	int energy = m_ptr->energy +
+	        extract_energy[m_ptr->mspeed] * (turn - m_ptr->energy_turn);
+
+	/* A dormant monster would have spent 100 energy on each missed move */
+	if (m_ptr->mflag & (MFLAG_DORM)) energy %= 100;
+
+	return (energy);
+}
+
+/*
+ * Set the current energy of a monster, and reschedule it
+ */
+void monster_set_energy(int m_idx, int energy)
+{
+	monster_type *m_ptr = &mon_list[m_idx];
+
+	monster_unschedule(m_idx);
+
+	m_ptr->energy = energy;
+	m_ptr->energy_turn = turn;
+	m_ptr->mflag &= ~(MFLAG_DORM);
+
+	monster_schedule(m_idx);
+}
+
+/*
+ * Change the speed of a monster, from the next grant of energy on
+ */
+void monster_set_speed(int m_idx, int speed)
+{
+	monster_type *m_ptr = &mon_list[m_idx];
+	int energy = monster_energy(m_idx);
+
+	m_ptr->mspeed = speed;
+	monster_set_energy(m_idx, energy);
+}
+
+/*
+ * Enter a monster into the wheel, according to its energy and speed.
+ * The monster must not already be in it.
+ */
+void monster_schedule(int m_idx)
+{
+	monster_type *m_ptr = &mon_list[m_idx];
+	int energy = monster_energy(m_idx);
+	int gain = extract_energy[m_ptr->mspeed];
+	int slot, i, prev = 0;
+
+	/* Game turn on which the monster reaches 100 energy */
+	m_ptr->energy_due = turn;
+	if (energy < 100)
+		m_ptr->energy_due += (100 - energy + gain - 1) / gain;
+
+	/* Find its place in the list */
+	slot = m_ptr->energy_due % SCHED_SLOTS;
+	for (i = sched_head[slot]; i > m_idx; i = mon_list[i].sched_next)
+		prev = i;
+
+	/* Link it in */
+	m_ptr->sched_prev = prev;
+	m_ptr->sched_next = i;
+
+	if (prev) mon_list[prev].sched_next = m_idx;
+	else sched_head[slot] = m_idx;
+
+	if (i) mon_list[i].sched_prev = m_idx;
+}
+
+/*
+ * Remove a monster from the wheel
+ */
+void monster_unschedule(int m_idx)
+{
+	monster_type *m_ptr = &mon_list[m_idx];
+	int slot = m_ptr->energy_due % SCHED_SLOTS;
+
+	if (m_ptr->sched_prev)
+		mon_list[m_ptr->sched_prev].sched_next = m_ptr->sched_next;
+	else if (sched_head[slot] == m_idx)
+		sched_head[slot] = m_ptr->sched_next;
+
+	if (m_ptr->sched_next)
+		mon_list[m_ptr->sched_next].sched_prev = m_ptr->sched_prev;
+
+	m_ptr->sched_prev = m_ptr->sched_next = 0;
+}
+
+/*
+ * Whether any monster may be due to act this game turn
+ */
+bool monsters_due(void)
+{
+	return (sched_head[turn % SCHED_SLOTS] != 0);
+}
+
+/*
+ * Empty the wheel, along with the monster list
+ */
+void monster_schedule_wipe(void)
+{
+	C_WIPE(sched_head, SCHED_SLOTS, s16b);
+}
+
+
+/*
+ * Sleeping monsters far from the player are "dormant": they are taken off the
+ * wheel altogether, since they would do nothing on their turns anyway, and
+ * only put back when something could make them act (see monster_rouse()).
+ *
+ * A monster is "remote" if it is too far away to sense the player, to be in
+ * view, or to smell the player along the flow (which never takes fewer steps
+ * than the larger of the axis distances).
+ */
+bool monster_remote(int m_idx)
+{
+	monster_type *m_ptr = &mon_list[m_idx];
+	monster_race *r_ptr = &r_info[m_ptr->r_idx];
+	int reach = MIN(r_ptr->aaf, MONSTER_FLOW_DEPTH);
+
+	if (m_ptr->cdis <= r_ptr->aaf) return (FALSE);
+	if (m_ptr->cdis <= MAX_SIGHT) return (FALSE);
+	if (OPT(adult_ai_sound) && (m_ptr->cdis <= reach + reach / 2)) return (FALSE);
+
+	return (TRUE);
+}
+
+/*
+ * Put a dormant monster back on the wheel, with the energy it would have
+ * had if it had been taking (empty) turns all along
+ */
+void monster_rouse(int m_idx)
+{
+	monster_type *m_ptr = &mon_list[m_idx];
+
+	if (!(m_ptr->mflag & (MFLAG_DORM))) return;
+
+	monster_set_energy(m_idx, monster_energy(m_idx));
+}
+
+
+/*
+ * Make plans for the monsters in schedule slot `slot` with at least
+ * `minimum_energy`, if there are enough of them to be worth it
+ */
+static void monster_plans_make(int slot, int minimum_energy)
+{
+	int i;
+
+	if (!OPT(adult_ai_sound)) return;
+
+	if (monster_plans_size < mon_size)
+	{
+		FREE(monster_plans);
+		FREE(plan_queue);
+
+		monster_plans_size = mon_size;
+		monster_plans = C_ZNEW(monster_plans_size, struct monster_plan);
+		plan_queue = C_ZNEW(monster_plans_size, s16b);
+	}
+
+	plan_count = 0;
+	for (i = sched_head[slot]; i; i = mon_list[i].sched_next)
+	{
+		monster_plans[i].valid = FALSE;
+
+		if (monster_energy(i) >= minimum_energy)
+			plan_queue[plan_count++] = i;
+	}
+
+	if (plan_count < MONSTER_PLAN_MIN) return;
+
+	monster_plan_all();
+}
+
+
 /*
  * Process all the "live" monsters, once per game turn.
  *
- * During each game turn, we scan through the list of all the "live" monsters,
- * (backwards, so we can excise any "freshly dead" monsters), energizing each
- * monster, and allowing fully energized monsters to move, attack, pass, etc.
+ * During each game turn, we go through the monsters which have enough energy
+ * to act this turn (backwards, so we can excise any "freshly dead" monsters),
+ * allowing them to move, attack, pass, etc.
  *
  * Note that monsters can never move in the monster array (except when the
  * "compact_monsters()" function is called by "dungeon()" or "save_player()").
@@ -3877,31 +4150,40 @@ static bool monster_can_flow(int m_idx)
  */
 void process_monsters(byte minimum_energy)
 {
-	int i;
+	int i, last = mon_max;
+	int slot = turn % SCHED_SLOTS;
 
 	monster_type *m_ptr;
 	monster_race *r_ptr;
 
-	/* Process the monsters (backwards) */
-	for (i = mon_max - 1; i >= 1; i--)
+	/* Look ahead for them all at once, if there are a lot */
+	monster_plans_make(slot, minimum_energy);
+
+	/* Process the monsters due this turn (backwards) */
+	while (TRUE)
 	{
 		/* Handle "leaving" */
 		if (p_ptr->leaving) break;
 
+		/* Find the next monster with enough energy to move */
+		for (i = sched_head[slot]; i; i = mon_list[i].sched_next)
+		{
+			if (i >= last) continue;
+			if (monster_energy(i) >= minimum_energy) break;
+		}
 
-		/* Get the monster */
-		m_ptr = &mon_list[i];
+		/* Done */
+		if (!i) break;
 
+		last = i;
 
-		/* Ignore "dead" monsters */
-		if (!m_ptr->r_idx) continue;
 
+		/* Get the monster */
+		m_ptr = &mon_list[i];
 
-		/* Not enough energy to move */
-		if (m_ptr->energy < minimum_energy) continue;
 
 		/* Use up "some" energy */
-		m_ptr->energy -= 100;
+		monster_set_energy(i, monster_energy(i) - 100);
 
 
 		/* Heal monster? XXX XXX XXX */
@@ -3924,6 +4206,14 @@ void process_monsters(byte minimum_energy)
 		{
 			/* Process the monster */
 			process_monster(i);
+			PERF_COUNT(PERF_MONSTERS);
+		}
+
+		/* Let sleeping monsters far away lie until something rouses them */
+		else if (m_ptr->csleep && monster_remote(i))
+		{
+			monster_unschedule(i);
+			m_ptr->mflag |= (MFLAG_DORM);
 		}
 	}
 }
@@ -5,12 +5,16 @@
 
 #include "monster/types.h"
 
+/* flow.c */
+extern int monster_flow_dist(int which, int y, int x);
+
 /* monster1.c */
 extern void describe_monster(int r_idx, bool spoilers);
 extern void roff_top(int r_idx);
 extern void screen_roff(int r_idx);
 extern void display_roff(int r_idx);
 extern int lookup_monster(const char *name);
+extern int lookup_monster_prefix(const char *prefix, int *matches);
 
 /* monster2.c */
 extern bool wake_monster(monster_type *m_ptr);
@@ -18,15 +22,21 @@ extern void delete_monster_idx(int i);
 extern void delete_monster(int y, int x);
 extern void compact_monsters(int size);
 extern void wipe_mon_list(void);
+extern bool mon_list_grow(int size);
+extern bool monsters_in_view(void);
+extern int mon_vis_next(int m_idx);
 extern s16b mon_pop(void);
 extern void get_mon_num_prep(void);
 extern s16b get_mon_num(int level);
+extern void get_mon_num_reset(void);
 extern void display_monlist(void);
 extern void monster_desc(char *desc, size_t max, const monster_type *m_ptr, int mode);
 extern void lore_do_probe(int m_idx);
 extern void lore_treasure(int m_idx, int num_item, int num_gold);
 extern void update_mon(int m_idx, bool full);
 extern void update_monsters(bool full);
+extern void monster_hurt(int m_idx);
+extern void monster_healed(int m_idx);
 extern s16b monster_carry(int m_idx, object_type *j_ptr);
 extern void monster_swap(int y1, int x1, int y2, int x2);
 extern s16b player_place(int y, int x);
@@ -38,6 +48,9 @@ extern bool summon_specific(int y1, int x1, int lev, int type, int delay);
 extern bool multiply_monster(int m_idx);
 extern void message_pain(int m_idx, int dam);
 extern void update_smart_learn(int m_idx, int what);
+void monster_make_drops(const monster_race *r_ptr, int depth,
+		void (*drop)(object_type *o_ptr, void *data), void *data,
+		int *dump_item, int *dump_gold);
 void monster_death(int m_idx);
 bool mon_take_hit(int m_idx, int dam, bool *fear, cptr note);
 extern void monster_flags_known(const monster_race *r_ptr, const monster_lore *l_ptr, bitflag flags[RF_SIZE]);
@@ -17,8 +17,10 @@
  */
 
 #include "angband.h"
+#include "init.h"
 #include "monster/constants.h"
 #include "monster/monster.h"
+#include "name-index.h"
 #include "object/tvalsval.h"
 
 /*
@@ -497,10 +499,108 @@ static bool know_damage(int r_idx, const monster_lore *l_ptr, int i)
 static void describe_monster_desc(int r_idx)
 {
 	const monster_race *r_ptr = &r_info[r_idx];
-	text_out("%s\n", r_ptr->text);
+	text_out("%s\n", cache_text(r_ptr->text));
 }
 
 
+/*
+ * The average damage of each spell of each race, as shown in recall and
+ * spoilers.  It depends only on the race's level and hit points, so the
+ * whole table is made the first time it's wanted and again only if r_info
+ * is replaced; recall just picks out the spells the player knows of.
+ */
+static s16b (*race_spell_dam)[RSF_MAX];
+static const monster_race *race_spell_dam_of;
+static int race_spell_dam_max;
+
+static void race_spell_dam_make(const monster_race *r_ptr, s16b dam[RSF_MAX])
+{
+	int hp = r_ptr->avg_hp;
+	int lev = r_ptr->level;
+	int i;
+
+	for (i = 0; i < RSF_MAX; i++)
+	{
+		int v = 0;
+
+		if (!rsf_has(r_ptr->spell_flags, i)) continue;
+
+		switch (i)
+		{
+			case RSF_ARROW_1: v = ARROW1_DMG(lev, AVERAGE); break;
+			case RSF_ARROW_2: v = ARROW2_DMG(lev, AVERAGE); break;
+			case RSF_ARROW_3: v = ARROW3_DMG(lev, AVERAGE); break;
+			case RSF_ARROW_4: v = ARROW4_DMG(lev, AVERAGE); break;
+			case RSF_BOULDER: v = BOULDER_DMG(lev, AVERAGE); break;
+			case RSF_BR_ACID: v = MIN(hp / BR_ACID_DIVISOR, BR_ACID_MAX); break;
+			case RSF_BR_ELEC: v = MIN(hp / BR_ELEC_DIVISOR, BR_ELEC_MAX); break;
+			case RSF_BR_FIRE: v = MIN(hp / BR_FIRE_DIVISOR, BR_FIRE_MAX); break;
+			case RSF_BR_COLD: v = MIN(hp / BR_COLD_DIVISOR, BR_COLD_MAX); break;
+			case RSF_BR_POIS: v = MIN(hp / BR_POIS_DIVISOR, BR_POIS_MAX); break;
+			case RSF_BR_NETH: v = MIN(hp / BR_NETH_DIVISOR, BR_NETH_MAX); break;
+			case RSF_BR_LIGHT: v = MIN(hp / BR_LIGHT_DIVISOR, BR_LIGHT_MAX); break;
+			case RSF_BR_DARK: v = MIN(hp / BR_DARK_DIVISOR, BR_DARK_MAX); break;
+			case RSF_BR_CONF: v = MIN(hp / BR_CONF_DIVISOR, BR_CONF_MAX); break;
+			case RSF_BR_SOUN: v = MIN(hp / BR_SOUN_DIVISOR, BR_SOUN_MAX); break;
+			case RSF_BR_CHAO: v = MIN(hp / BR_CHAO_DIVISOR, BR_CHAO_MAX); break;
+			case RSF_BR_DISE: v = MIN(hp / BR_DISE_DIVISOR, BR_DISE_MAX); break;
+			case RSF_BR_NEXU: v = MIN(hp / BR_NEXU_DIVISOR, BR_NEXU_MAX); break;
+			case RSF_BR_TIME: v = MIN(hp / BR_TIME_DIVISOR, BR_TIME_MAX); break;
+			case RSF_BR_INER: v = MIN(hp / BR_INER_DIVISOR, BR_INER_MAX); break;
+			case RSF_BR_GRAV: v = MIN(hp / BR_GRAV_DIVISOR, BR_GRAV_MAX); break;
+			case RSF_BR_SHAR: v = MIN(hp / BR_SHAR_DIVISOR, BR_SHAR_MAX); break;
+			case RSF_BR_PLAS: v = MIN(hp / BR_PLAS_DIVISOR, BR_PLAS_MAX); break;
+			case RSF_BR_WALL: v = MIN(hp / BR_FORC_DIVISOR, BR_FORC_MAX); break;
+			case RSF_BA_MANA: v = BA_MANA_DMG(lev, AVERAGE); break;
+			case RSF_BA_DARK: v = BA_DARK_DMG(lev, AVERAGE); break;
+			case RSF_BA_WATE: v = BA_WATE_DMG(lev, AVERAGE); break;
+			case RSF_BA_NETH: v = BA_NETH_DMG(lev, AVERAGE); break;
+			case RSF_BA_FIRE: v = BA_FIRE_DMG(lev, AVERAGE); break;
+			case RSF_BA_ACID: v = BA_ACID_DMG(lev, AVERAGE); break;
+			case RSF_BA_COLD: v = BA_COLD_DMG(lev, AVERAGE); break;
+			case RSF_BA_ELEC: v = BA_ELEC_DMG(lev, AVERAGE); break;
+			case RSF_BA_POIS: v = BA_POIS_DMG(lev, AVERAGE); break;
+			case RSF_BO_MANA: v = BO_MANA_DMG(lev, AVERAGE); break;
+			case RSF_BO_PLAS: v = BO_PLAS_DMG(lev, AVERAGE); break;
+			case RSF_BO_ICEE: v = BO_ICEE_DMG(lev, AVERAGE); break;
+			case RSF_BO_WATE: v = BO_WATE_DMG(lev, AVERAGE); break;
+			case RSF_BO_NETH: v = BO_NETH_DMG(lev, AVERAGE); break;
+			case RSF_BO_FIRE: v = BO_FIRE_DMG(lev, AVERAGE); break;
+			case RSF_BO_ACID: v = BO_ACID_DMG(lev, AVERAGE); break;
+			case RSF_BO_COLD: v = BO_COLD_DMG(lev, AVERAGE); break;
+			case RSF_BO_ELEC: v = BO_ELEC_DMG(lev, AVERAGE); break;
+			case RSF_MISSILE: v = MISSILE_DMG(lev, AVERAGE); break;
+			case RSF_BRAIN_SMASH: v = BRAIN_SMASH_DMG(lev, AVERAGE); break;
+			case RSF_MIND_BLAST: v = MIND_BLAST_DMG(lev, AVERAGE); break;
+			case RSF_CAUSE_4: v = CAUSE4_DMG(lev, AVERAGE); break;
+			case RSF_CAUSE_3: v = CAUSE3_DMG(lev, AVERAGE); break;
+			case RSF_CAUSE_2: v = CAUSE2_DMG(lev, AVERAGE); break;
+			case RSF_CAUSE_1: v = CAUSE1_DMG(lev, AVERAGE); break;
+		}
+
+		dam[i] = (s16b)v;
+	}
+}
+
+static const s16b *race_spell_dam_get(int r_idx)
+{
+	int i;
+
+	if ((race_spell_dam_of != r_info) || (race_spell_dam_max != z_info->r_max))
+	{
+		FREE(race_spell_dam);
+		race_spell_dam = mem_zalloc(z_info->r_max * sizeof(*race_spell_dam));
+
+		for (i = 0; i < z_info->r_max; i++)
+			race_spell_dam_make(&r_info[i], race_spell_dam[i]);
+
+		race_spell_dam_of = r_info;
+		race_spell_dam_max = z_info->r_max;
+	}
+
+	return race_spell_dam[r_idx];
+}
+
 static void describe_monster_spells(int r_idx, const monster_lore *l_ptr, const int colors[RSF_MAX])
 {
 	const monster_race *r_ptr = &r_info[r_idx];
@@ -513,7 +613,8 @@ static void describe_monster_spells(int r_idx, const monster_lore *l_ptr, const
 	cptr vp[64]; /* list item names */
 	int vc[64]; /* list colors */
 	int vd[64]; /* list avg damage values */
-	int known_hp;
+	bool known_hp;
+	const s16b *dam = race_spell_dam_get(r_idx);
 	
 	/* Get the known monster flags */
 	monster_flags_known(r_ptr, l_ptr, f);
@@ -535,31 +636,31 @@ static void describe_monster_spells(int r_idx, const monster_lore *l_ptr, const
 	{
 		vp[vn] = "fire an arrow";
 		vc[vn] = colors[RSF_ARROW_1];
-		vd[vn++] = ARROW1_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_ARROW_1];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_ARROW_2))
 	{
 		vp[vn] = "fire arrows";
 		vc[vn] = colors[RSF_ARROW_2];
-		vd[vn++] = ARROW2_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_ARROW_2];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_ARROW_3))
 	{
 		vp[vn] = "fire a missile";
 		vc[vn] = colors[RSF_ARROW_3];
-		vd[vn++] = ARROW3_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_ARROW_3];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_ARROW_4))
 	{
 		vp[vn] = "fire missiles";
 		vc[vn] = colors[RSF_ARROW_4];
-		vd[vn++] = ARROW4_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_ARROW_4];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BOULDER))
 	{
 		vp[vn] = "throw boulders";
 		vc[vn] = colors[RSF_BOULDER];
-		vd[vn++] = BOULDER_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BOULDER];
 	}
 
 	/* Describe innate attacks */
@@ -574,121 +675,121 @@ static void describe_monster_spells(int r_idx, const monster_lore *l_ptr, const
 	vn = 0;
 	for(m = 0; m < 64; m++) { vd[m] = 0; vc[m] = TERM_WHITE; }
 
-	known_hp = know_armour(r_idx, l_ptr) ? r_ptr->avg_hp : 0;
+	known_hp = know_armour(r_idx, l_ptr);
 
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_ACID))
 	{
 		vp[vn] = "acid";
 		vc[vn] = colors[RSF_BR_ACID];
-		vd[vn++] = MIN(known_hp / BR_ACID_DIVISOR, BR_ACID_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_ACID] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_ELEC))
 	{
 		vp[vn] = "lightning";
 		vc[vn] = colors[RSF_BR_ELEC];
-		vd[vn++] = MIN(known_hp / BR_ELEC_DIVISOR, BR_ELEC_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_ELEC] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_FIRE))
 	{
 		vp[vn] = "fire";
 		vc[vn] = colors[RSF_BR_FIRE];
-		vd[vn++] = MIN(known_hp / BR_FIRE_DIVISOR, BR_FIRE_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_FIRE] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_COLD))
 	{
 		vp[vn] = "frost";
 		vc[vn] = colors[RSF_BR_COLD];
-		vd[vn++] = MIN(known_hp / BR_COLD_DIVISOR, BR_COLD_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_COLD] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_POIS))
 	{
 		vp[vn] = "poison";
 		vc[vn] = colors[RSF_BR_POIS];
-		vd[vn++] = MIN(known_hp / BR_POIS_DIVISOR, BR_POIS_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_POIS] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_NETH))
 	{
 		vp[vn] = "nether";
 		vc[vn] = colors[RSF_BR_NETH];
-		vd[vn++] = MIN(known_hp / BR_NETH_DIVISOR, BR_NETH_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_NETH] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_LIGHT))
 	{
 		vp[vn] = "light";
 		vc[vn] = colors[RSF_BR_LIGHT];
-		vd[vn++] = MIN(known_hp / BR_LIGHT_DIVISOR, BR_LIGHT_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_LIGHT] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_DARK))
 	{
 		vp[vn] = "darkness";
 		vc[vn] = colors[RSF_BR_DARK];
-		vd[vn++] = MIN(known_hp / BR_DARK_DIVISOR, BR_DARK_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_DARK] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_CONF))
 	{
 		vp[vn] = "confusion";
 		vc[vn] = colors[RSF_BR_CONF];
-		vd[vn++] = MIN(known_hp / BR_CONF_DIVISOR, BR_CONF_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_CONF] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_SOUN))
 	{
 		vp[vn] = "sound";
 		vc[vn] = colors[RSF_BR_SOUN];
-		vd[vn++] = MIN(known_hp / BR_SOUN_DIVISOR, BR_SOUN_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_SOUN] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_CHAO))
 	{
 		vp[vn] = "chaos";
 		vc[vn] = colors[RSF_BR_CHAO];
-		vd[vn++] = MIN(known_hp / BR_CHAO_DIVISOR, BR_CHAO_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_CHAO] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_DISE))
 	{
 		vp[vn] = "disenchantment";
 		vc[vn] = colors[RSF_BR_DISE];
-		vd[vn++] = MIN(known_hp / BR_DISE_DIVISOR, BR_DISE_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_DISE] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_NEXU))
 	{
 		vp[vn] = "nexus";
 		vc[vn] = colors[RSF_BR_NEXU];
-		vd[vn++] = MIN(known_hp / BR_NEXU_DIVISOR, BR_NEXU_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_NEXU] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_TIME))
 	{
 		vp[vn] = "time";
 		vc[vn] = colors[RSF_BR_TIME];
-		vd[vn++] = MIN(known_hp / BR_TIME_DIVISOR, BR_TIME_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_TIME] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_INER))
 	{
 		vp[vn] = "inertia";
 		vc[vn] = colors[RSF_BR_INER];
-		vd[vn++] = MIN(known_hp / BR_INER_DIVISOR, BR_INER_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_INER] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_GRAV))
 	{
 		vp[vn] = "gravity";
 		vc[vn] = colors[RSF_BR_GRAV];
-		vd[vn++] = MIN(known_hp / BR_GRAV_DIVISOR, BR_GRAV_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_GRAV] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_SHAR))
 	{
 		vp[vn] = "shards";
 		vc[vn] = colors[RSF_BR_SHAR];
-		vd[vn++] = MIN(known_hp / BR_SHAR_DIVISOR, BR_SHAR_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_SHAR] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_PLAS))
 	{
 		vp[vn] = "plasma";
 		vc[vn] = colors[RSF_BR_PLAS];
-		vd[vn++] = MIN(known_hp / BR_PLAS_DIVISOR, BR_PLAS_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_PLAS] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_WALL))
 	{
 		vp[vn] = "force";
 		vc[vn] = colors[RSF_BR_WALL];
-		vd[vn++] = MIN(known_hp / BR_FORC_DIVISOR, BR_FORC_MAX);
+		vd[vn++] = known_hp ? dam[RSF_BR_WALL] : 0;
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BR_MANA))
 	{
@@ -719,55 +820,55 @@ static void describe_monster_spells(int r_idx, const monster_lore *l_ptr, const
 	{
 		vp[vn] = "invoke mana storms";
 		vc[vn] = colors[RSF_BA_MANA];
-		vd[vn++] = BA_MANA_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BA_MANA];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BA_DARK))
 	{
 		vp[vn] = "invoke darkness storms";
 		vc[vn] = colors[RSF_BA_DARK];
-		vd[vn++] = BA_DARK_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BA_DARK];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BA_WATE))
 	{
 		vp[vn] = "produce water balls";
 		vc[vn] = colors[RSF_BA_WATE];
-		vd[vn++] = BA_WATE_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BA_WATE];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BA_NETH))
 	{
 		vp[vn] = "produce nether balls";
 		vc[vn] = colors[RSF_BA_NETH];
-		vd[vn++] = BA_NETH_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BA_NETH];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BA_FIRE))
 	{
 		vp[vn] = "produce fire balls";
 		vc[vn] = colors[RSF_BA_FIRE];
-		vd[vn++] = BA_FIRE_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BA_FIRE];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BA_ACID))
 	{
 		vp[vn] = "produce acid balls";
 		vc[vn] = colors[RSF_BA_ACID];
-		vd[vn++] = BA_ACID_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BA_ACID];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BA_COLD))
 	{
 		vp[vn] = "produce frost balls";
 		vc[vn] = colors[RSF_BA_COLD];
-		vd[vn++] = BA_COLD_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BA_COLD];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BA_ELEC))
 	{
 		vp[vn] = "produce lightning balls";
 		vc[vn] = colors[RSF_BA_ELEC];
-		vd[vn++] = BA_ELEC_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BA_ELEC];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BA_POIS))
 	{
 		vp[vn] = "produce poison balls";
 		vc[vn] = colors[RSF_BA_POIS];
-		vd[vn++] = BA_POIS_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BA_POIS];
 	}
 
 	/* Bolt spells */
@@ -775,55 +876,55 @@ static void describe_monster_spells(int r_idx, const monster_lore *l_ptr, const
 	{
 		vp[vn] = "produce mana bolts";
 		vc[vn] = colors[RSF_BO_MANA];
-		vd[vn++] = BO_MANA_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BO_MANA];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BO_PLAS))
 	{
 		vp[vn] = "produce plasma bolts";
 		vc[vn] = colors[RSF_BO_PLAS];
-		vd[vn++] = BO_PLAS_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BO_PLAS];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BO_ICEE))
 	{
 		vp[vn] = "produce ice bolts";
 		vc[vn] = colors[RSF_BO_ICEE];
-		vd[vn++] = BO_ICEE_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BO_ICEE];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BO_WATE))
 	{
 		vp[vn] = "produce water bolts";
 		vc[vn] = colors[RSF_BO_WATE];
-		vd[vn++] = BO_WATE_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BO_WATE];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BO_NETH))
 	{
 		vp[vn] = "produce nether bolts";
 		vc[vn] = colors[RSF_BO_NETH];
-		vd[vn++] = BO_NETH_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BO_NETH];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BO_FIRE))
 	{
 		vp[vn] = "produce fire bolts";
 		vc[vn] = colors[RSF_BO_FIRE];
-		vd[vn++] = BO_FIRE_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BO_FIRE];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BO_ACID))
 	{
 		vp[vn] = "produce acid bolts";
 		vc[vn] = colors[RSF_BO_ACID];
-		vd[vn++] = BO_ACID_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BO_ACID];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BO_COLD))
 	{
 		vp[vn] = "produce frost bolts";
 		vc[vn] = colors[RSF_BO_COLD];
-		vd[vn++] = BO_COLD_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BO_COLD];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BO_ELEC))
 	{
 		vp[vn] = "produce lightning bolts";
 		vc[vn] = colors[RSF_BO_ELEC];
-		vd[vn++] = BO_ELEC_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BO_ELEC];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_BO_POIS))
 	{
@@ -835,7 +936,7 @@ static void describe_monster_spells(int r_idx, const monster_lore *l_ptr, const
 	{
 		vp[vn] = "produce magic missiles";
 		vc[vn] = colors[RSF_MISSILE];
-		vd[vn++] = MISSILE_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_MISSILE];
 	}
 
 	/* Curses */
@@ -843,37 +944,37 @@ static void describe_monster_spells(int r_idx, const monster_lore *l_ptr, const
 	{
 		vp[vn] = "cause brain smashing";
 		vc[vn] = colors[RSF_BRAIN_SMASH];
-		vd[vn++] = BRAIN_SMASH_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_BRAIN_SMASH];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_MIND_BLAST))
 	{
 		vp[vn] = "cause mind blasting";
 		vc[vn] = colors[RSF_MIND_BLAST];
-		vd[vn++] = MIND_BLAST_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_MIND_BLAST];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_CAUSE_4))
 	{
 		vp[vn] = "cause mortal wounds";
 		vc[vn] = colors[RSF_CAUSE_4];
-		vd[vn++] = CAUSE4_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_CAUSE_4];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_CAUSE_3))
 	{
 		vp[vn] = "cause critical wounds";
 		vc[vn] = colors[RSF_CAUSE_3];
-		vd[vn++] = CAUSE3_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_CAUSE_3];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_CAUSE_2))
 	{
 		vp[vn] = "cause serious wounds";
 		vc[vn] = colors[RSF_CAUSE_2];
-		vd[vn++] = CAUSE2_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_CAUSE_2];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_CAUSE_1))
 	{
 		vp[vn] = "cause light wounds";
 		vc[vn] = colors[RSF_CAUSE_1];
-		vd[vn++] = CAUSE1_DMG(r_ptr->level, AVERAGE);
+		vd[vn++] = dam[RSF_CAUSE_1];
 	}
 	if (rsf_has(l_ptr->spell_flags, RSF_FORGET))
 	{
@@ -1867,19 +1968,16 @@ static void cheat_monster_lore(int r_idx, monster_lore *l_ptr)
  * left edge of the screen, on a cleared line, in which the recall is
  * to take place.  One extra blank line is left after the recall.
  */
-void describe_monster(int r_idx, bool spoilers)
+static void describe_monster_aux(int r_idx, bool spoilers,
+		const int melee_colors[RBE_MAX], const int spell_colors[RSF_MAX])
 {
 	monster_lore lore;
 	bitflag f[RF_SIZE];
-	int melee_colors[RBE_MAX], spell_colors[RSF_MAX];
 
 	/* Get the race and lore */
 	const monster_race *r_ptr = &r_info[r_idx];
 	monster_lore *l_ptr = &l_list[r_idx];
 
-	/* Determine the special attack colors */
-	get_attack_colors(melee_colors, spell_colors);
-
 	/* Hack -- create a copy of the monster-memory */
 	COPY(&lore, l_ptr, monster_lore);
 
@@ -1931,6 +2029,112 @@ void describe_monster(int r_idx, bool spoilers)
 	text_out("\n");
 }
 
+void describe_monster(int r_idx, bool spoilers)
+{
+	int melee_colors[RBE_MAX], spell_colors[RSF_MAX];
+	int i;
+
+	/* Spoilers don't depend on the character, who may not even exist */
+	if (spoilers)
+	{
+		for (i = 0; i < RBE_MAX; i++) melee_colors[i] = TERM_WHITE;
+		for (i = 0; i < RSF_MAX; i++) spell_colors[i] = TERM_WHITE;
+	}
+
+	/* Determine the special attack colors */
+	else
+		get_attack_colors(melee_colors, spell_colors);
+
+	describe_monster_aux(r_idx, spoilers, melee_colors, spell_colors);
+}
+
+
+/*
+ * Everything the on-screen recall of a race depends on.  If any of these
+ * change the text has to be built again; anything else the describe_*()
+ * functions start looking at must be added here too.
+ */
+struct roff_key
+{
+	int r_idx;
+	monster_lore lore;
+	int melee_colors[RBE_MAX];
+	int spell_colors[RSF_MAX];
+	s16b lev;
+	s16b max_depth;
+	int to_hit;
+	bool cheat_know;
+};
+
+/*
+ * The last recall shown on screen, kept as the sequence of text_out_hook()
+ * calls that produced it: each is an attr byte followed by a nul-terminated
+ * string.  Replaying the calls rather than the screen means the text still
+ * wraps to whatever term it is shown in.
+ */
+static struct roff_key roff_cache_key;
+static bool roff_cache_valid;
+static char roff_cache_buf[8192];
+static size_t roff_cache_len;
+static bool roff_cache_full;
+
+static void roff_cache_hook(byte a, cptr str)
+{
+	size_t n = strlen(str) + 2;
+
+	if (roff_cache_len + n > sizeof(roff_cache_buf))
+		roff_cache_full = TRUE;
+
+	if (!roff_cache_full)
+	{
+		roff_cache_buf[roff_cache_len] = (char)a;
+		my_strcpy(roff_cache_buf + roff_cache_len + 1, str, n - 1);
+		roff_cache_len += n;
+	}
+
+	text_out_to_screen(a, str);
+}
+
+/*
+ * Recall a monster race to the screen, reusing the text from last time
+ * when nothing it depends on has changed.  The monster subwindow is
+ * redrawn every time the target or health tracking changes, which is
+ * usually to another member of the same race.
+ */
+static void describe_monster_screen(int r_idx)
+{
+	struct roff_key key;
+	size_t i;
+
+	WIPE(&key, struct roff_key);
+	key.r_idx = r_idx;
+	COPY(&key.lore, &l_list[r_idx], monster_lore);
+	get_attack_colors(key.melee_colors, key.spell_colors);
+	key.lev = p_ptr->lev;
+	key.max_depth = p_ptr->max_depth;
+	key.to_hit = p_ptr->state.skills[SKILL_TO_HIT_MELEE] +
+		((p_ptr->state.to_h + p_ptr->inventory[INVEN_WIELD].to_h) *
+		BTH_PLUS_ADJ);
+	key.cheat_know = OPT(cheat_know);
+
+	if (roff_cache_valid && !memcmp(&key, &roff_cache_key, sizeof(key)))
+	{
+		for (i = 0; i < roff_cache_len; i += strlen(roff_cache_buf + i + 1) + 2)
+			text_out_to_screen((byte)roff_cache_buf[i], roff_cache_buf + i + 1);
+		return;
+	}
+
+	/* Build the text, keeping a copy of it */
+	roff_cache_len = 0;
+	roff_cache_full = FALSE;
+	text_out_hook = roff_cache_hook;
+	describe_monster_aux(r_idx, FALSE, key.melee_colors, key.spell_colors);
+	text_out_hook = text_out_to_screen;
+
+	COPY(&roff_cache_key, &key, struct roff_key);
+	roff_cache_valid = !roff_cache_full;
+}
+
 
 
 
@@ -2001,7 +2205,7 @@ void screen_roff(int r_idx)
 	text_out_hook = text_out_to_screen;
 
 	/* Recall monster */
-	describe_monster(r_idx, FALSE);
+	describe_monster_screen(r_idx);
 
 	/* Describe monster */
 	roff_top(r_idx);
@@ -2031,13 +2235,29 @@ void display_roff(int r_idx)
 	text_out_hook = text_out_to_screen;
 
 	/* Recall monster */
-	describe_monster(r_idx, FALSE);
+	describe_monster_screen(r_idx);
 
 	/* Describe monster */
 	roff_top(r_idx);
 }
 
 
+/*
+ * Monster races by name
+ */
+static struct name_index race_names;
+
+static const char *race_name(int r_idx)
+{
+	return r_info[r_idx].name;
+}
+
+static void race_names_build(void)
+{
+	if (name_index_stale(&race_names, r_info, z_info->r_max))
+		name_index_build(&race_names, r_info, z_info->r_max, race_name);
+}
+
 /*
  * Return the r_idx of the monster with the given name.
  *
@@ -2048,19 +2268,25 @@ void display_roff(int r_idx)
  */
 int lookup_monster(const char *name)
 {
-	int i;
+	int r_idx;
 
-	/* Look for it */
-	for (i = 1; i < z_info->r_max; i++)
-	{
-		monster_race *r_ptr = &r_info[i];
-		const char *nm = r_ptr->name;
+	race_names_build();
+	r_idx = name_index_find(&race_names, name, NULL, 0);
+
+	return r_idx ? r_idx : -1;
+}
 
-		/* Found a match */
-		if (streq(name, nm))
-			return i;
+/*
+ * Return the r_idx of the monster race whose name starts with `prefix`,
+ * ignoring case, first in order of name, or -1 if none does; `matches` is
+ * set to how many do.
+ */
+int lookup_monster_prefix(const char *prefix, int *matches)
+{
+	int r_idx;
 
-	}
+	race_names_build();
+	r_idx = name_index_prefix(&race_names, prefix, matches);
 
-	return -1;
+	return r_idx ? r_idx : -1;
 }
@@ -20,10 +20,186 @@
 #include "cave.h"
 #include "generate.h"
 #include "history.h"
+#include "level-cache.h"
+#include "monster/monster.h"
 #include "object/tvalsval.h"
 #include "object/object.h"
 #include "target.h"
 
+/*
+ * The visible monsters, in increasing order of index, linked through their
+ * "vis_next" and "vis_prev" fields.  A monster is on the list exactly when
+ * its "ml" flag is set, so the monster list need only look at these.
+ */
+static s16b mon_vis_head;
+
+/*
+ * Add a monster to the visible list
+ */
+static void mon_vis_link(int m_idx)
+{
+	monster_type *m_ptr = &mon_list[m_idx];
+	int i, prev = 0;
+
+	for (i = mon_vis_head; i && (i < m_idx); i = mon_list[i].vis_next)
+		prev = i;
+
+	m_ptr->vis_prev = prev;
+	m_ptr->vis_next = i;
+
+	if (prev) mon_list[prev].vis_next = m_idx;
+	else mon_vis_head = m_idx;
+
+	if (i) mon_list[i].vis_prev = m_idx;
+
+	/* Multi-hued monsters shimmer while they're seen */
+	if (rf_has(r_info[m_ptr->r_idx].flags, RF_ATTR_MULTI))
+		shimmer_monsters = TRUE;
+}
+
+/*
+ * Take a monster off the visible list
+ */
+static void mon_vis_unlink(int m_idx)
+{
+	monster_type *m_ptr = &mon_list[m_idx];
+
+	if (m_ptr->vis_prev)
+		mon_list[m_ptr->vis_prev].vis_next = m_ptr->vis_next;
+	else
+		mon_vis_head = m_ptr->vis_next;
+
+	if (m_ptr->vis_next)
+		mon_list[m_ptr->vis_next].vis_prev = m_ptr->vis_prev;
+
+	m_ptr->vis_prev = m_ptr->vis_next = 0;
+}
+
+
+/*
+ * Whether the player can see any monster
+ */
+bool monsters_in_view(void)
+{
+	return (mon_vis_head != 0);
+}
+
+/*
+ * The next visible monster after `m_idx`, or the first if `m_idx` is 0;
+ * 0 if there are no more
+ */
+int mon_vis_next(int m_idx)
+{
+	return (m_idx ? mon_list[m_idx].vis_next : mon_vis_head);
+}
+
+
+/*
+ * Add a monster to the end of mon_live[]
+ */
+static void mon_live_add(int m_idx)
+{
+	mon_list[m_idx].live_pos = mon_live_num;
+	mon_live[mon_live_num++] = m_idx;
+}
+
+/*
+ * Take a monster out of mon_live[], moving the last entry into its place
+ */
+static void mon_live_remove(int m_idx)
+{
+	int pos = mon_list[m_idx].live_pos;
+	int last = mon_live[--mon_live_num];
+
+	mon_live[pos] = last;
+	mon_list[last].live_pos = pos;
+}
+
+
+/*
+ * Note that a monster has lost hit points, so that regen_monsters() will
+ * look at it until it has them all back
+ */
+void monster_hurt(int m_idx)
+{
+	monster_type *m_ptr = &mon_list[m_idx];
+
+	if (m_ptr->mflag & (MFLAG_HURT)) return;
+
+	m_ptr->mflag |= (MFLAG_HURT);
+	m_ptr->hurt_pos = mon_hurt_num;
+	mon_hurt[mon_hurt_num++] = m_idx;
+}
+
+/*
+ * Take a monster out of mon_hurt[], moving the last entry into its place
+ */
+void monster_healed(int m_idx)
+{
+	monster_type *m_ptr = &mon_list[m_idx];
+	int last;
+
+	if (!(m_ptr->mflag & (MFLAG_HURT))) return;
+
+	m_ptr->mflag &= ~(MFLAG_HURT);
+
+	last = mon_hurt[--mon_hurt_num];
+	mon_hurt[m_ptr->hurt_pos] = last;
+	mon_list[last].hurt_pos = m_ptr->hurt_pos;
+}
+
+
+/*
+ * Slots in mon_list[] freed since the list last filled up, so that
+ * mon_pop() doesn't have to search for one.  As with o_pop(), entries are
+ * checked before they are used.
+ */
+static s16b *mon_free;
+static int mon_free_num;
+
+static void mon_free_push(int m_idx)
+{
+	if (mon_free_num < mon_size) mon_free[mon_free_num++] = m_idx;
+}
+
+
+/*
+ * Resize mon_list[], and the lists of monster indexes with it, to `size`
+ * slots, wiping any new ones
+ */
+static void mon_list_resize(int size)
+{
+	mon_list = mem_realloc(mon_list, size * sizeof(monster_type));
+	if (size > mon_size)
+		C_WIPE(mon_list + mon_size, size - mon_size, monster_type);
+
+	mon_live = mem_realloc(mon_live, size * sizeof(s16b));
+	mon_hurt = mem_realloc(mon_hurt, size * sizeof(s16b));
+	mon_free = mem_realloc(mon_free, size * sizeof(s16b));
+
+	mon_size = size;
+}
+
+/*
+ * Make mon_list[] at least `size` slots long, growing it MON_LIST_CHUNK
+ * slots at a time up to z_info->m_max.  Returns FALSE if it can't be that
+ * long.  As with o_list_grow(), nothing may hold a pointer into the list
+ * across this.
+ */
+bool mon_list_grow(int size)
+{
+	int want;
+
+	if (size <= mon_size) return TRUE;
+
+	want = ((size + MON_LIST_CHUNK - 1) / MON_LIST_CHUNK) * MON_LIST_CHUNK;
+	want = MIN(want, z_info->m_max);
+	if (want > mon_size) mon_list_resize(want);
+
+	return (size <= mon_size);
+}
+
+
 /*
  * Delete a monster by index.
  *
@@ -48,6 +224,9 @@ void delete_monster_idx(int i)
 	/* Hack -- Reduce the racial counter */
 	r_ptr->cur_num--;
 
+	/* A unique may be available again */
+	if (rf_has(r_ptr->flags, RF_UNIQUE)) get_mon_num_reset();
+
 	/* Hack -- count the number of "reproducers" */
 	if (rf_has(r_ptr->flags, RF_MULTIPLY)) num_repro--;
 
@@ -60,7 +239,7 @@ void delete_monster_idx(int i)
 
 
 	/* Monster is gone */
-	cave_m_idx[y][x] = 0;
+	cave->grid[y][x].m_idx = 0;
 
 
 	/* Delete objects */
@@ -82,12 +261,25 @@ void delete_monster_idx(int i)
 	}
 
 
+	/* It won't be moving again */
+	monster_unschedule(i);
+
+	/* Nor seen */
+	if (m_ptr->ml) mon_vis_unlink(i);
+
+	/* Nor counted as alive */
+	mon_live_remove(i);
+	monster_healed(i);
+
 	/* Wipe the Monster */
 	(void)WIPE(m_ptr, monster_type);
 
 	/* Count monsters */
 	mon_cnt--;
 
+	/* Remember the hole */
+	mon_free_push(i);
+
 	/* Visual update */
 	light_spot(y, x);
 }
@@ -102,7 +294,7 @@ void delete_monster(int y, int x)
 	if (!in_bounds(y, x)) return;
 
 	/* Delete the monster (if any) */
-	if (cave_m_idx[y][x] > 0) delete_monster_idx(cave_m_idx[y][x]);
+	if (cave->grid[y][x].m_idx > 0) delete_monster_idx(cave->grid[y][x].m_idx);
 }
 
 
@@ -130,7 +322,7 @@ static void compact_monsters_aux(int i1, int i2)
 	x = m_ptr->fx;
 
 	/* Update the cave */
-	cave_m_idx[y][x] = i2;
+	cave->grid[y][x].m_idx = i2;
 
 	/* Repair objects being carried by monster */
 	for (this_o_idx = m_ptr->hold_o_idx; this_o_idx; this_o_idx = next_o_idx)
@@ -153,11 +345,23 @@ static void compact_monsters_aux(int i1, int i2)
 	/* Hack -- Update the health bar */
 	if (p_ptr->health_who == i1) p_ptr->health_who = i2;
 
+	/* Take the monster out of the schedule while it moves */
+	monster_unschedule(i1);
+	if (m_ptr->ml) mon_vis_unlink(i1);
+
 	/* Hack -- move monster */
 	COPY(&mon_list[i2], &mon_list[i1], monster_type);
 
 	/* Hack -- wipe hole */
 	(void)WIPE(&mon_list[i1], monster_type);
+
+	/* It keeps its place among the live monsters */
+	if (mon_list[i2].r_idx) mon_live[mon_list[i2].live_pos] = i2;
+	if (mon_list[i2].mflag & (MFLAG_HURT)) mon_hurt[mon_list[i2].hurt_pos] = i2;
+
+	/* Put it back, unless it is dormant */
+	if (!(mon_list[i2].mflag & (MFLAG_DORM))) monster_schedule(i2);
+	if (mon_list[i2].ml) mon_vis_link(i2);
 }
 
 
@@ -245,6 +449,9 @@ void compact_monsters(int size)
 		/* Compress "mon_max" */
 		mon_max--;
 	}
+
+	/* The list is packed now */
+	mon_free_num = 0;
 }
 
 
@@ -270,22 +477,43 @@ void wipe_mon_list(void)
 
 		/* Mega-Hack -- preserve Unique's XXX XXX XXX */
 
-		/* Hack -- Reduce the racial counter */
-		r_ptr->cur_num--;
+		/* Hack -- Reduce the racial counter (uniques on a kept level
+		   are still alive) */
+		if (!level_kept || !rf_has(r_ptr->flags, RF_UNIQUE))
+			r_ptr->cur_num--;
+
+		/* A unique may be available again */
+		if (rf_has(r_ptr->flags, RF_UNIQUE)) get_mon_num_reset();
 
 		/* Monster is gone */
-		cave_m_idx[m_ptr->fy][m_ptr->fx] = 0;
+		cave->grid[m_ptr->fy][m_ptr->fx].m_idx = 0;
 
 		/* Wipe the Monster */
 		(void)WIPE(m_ptr, monster_type);
 	}
 
+	/* Nothing left to schedule */
+	monster_schedule_wipe();
+
+	/* Nor to see */
+	mon_vis_head = 0;
+
+	/* Nor alive */
+	mon_live_num = 0;
+	mon_hurt_num = 0;
+
 	/* Reset "mon_max" */
 	mon_max = 1;
 
 	/* Reset "mon_cnt" */
 	mon_cnt = 0;
 
+	/* No holes left */
+	mon_free_num = 0;
+
+	/* The next level starts small again */
+	if (mon_size > MON_LIST_CHUNK) mon_list_resize(MON_LIST_CHUNK);
+
 	/* Hack -- reset "reproducer" count */
 	num_repro = 0;
 
@@ -294,6 +522,9 @@ void wipe_mon_list(void)
 
 	/* Hack -- no more tracking */
 	health_track(0);
+
+	/* The kept level is gone (wipe_o_list() comes first) */
+	level_kept = FALSE;
 }
 
 
@@ -308,7 +539,7 @@ s16b mon_pop(void)
 
 
 	/* Normal allocation */
-	if (mon_max < z_info->m_max)
+	if (mon_max < mon_size)
 	{
 		/* Get the next hole */
 		i = mon_max;
@@ -324,6 +555,22 @@ s16b mon_pop(void)
 	}
 
 
+	/* Reuse a hole left by a dead monster */
+	while (mon_free_num)
+	{
+		i = mon_free[--mon_free_num];
+
+		/* Compaction may have moved another monster in, or cut it off */
+		if ((i >= mon_max) || mon_list[i].r_idx) continue;
+
+		/* Count monsters */
+		mon_cnt++;
+
+		/* Use this monster */
+		return (i);
+	}
+
+
 	/* Recycle dead monsters */
 	for (i = 1; i < mon_max; i++)
 	{
@@ -379,11 +626,119 @@ void get_mon_num_prep(void)
 		}
 	}
 
+	/* The running totals must be recalculated */
+	get_mon_num_reset();
+
 	/* Success */
 	return;
 }
 
 
+/*
+ * The running totals of "prob3" in the allocation table are only worked
+ * out again when they may have changed, and the value of "p_ptr->depth"
+ * they were worked out for.
+ */
+static bool mon_num_valid = FALSE;
+static int mon_num_depth;
+
+
+/*
+ * Note that the "prob3" field of the allocation table is out of date, which
+ * is needed whenever "prob2" changes or a unique monster appears, leaves or
+ * dies.
+ */
+void get_mon_num_reset(void)
+{
+	mon_num_valid = FALSE;
+}
+
+
+/*
+ * Calculate the "prob3" field of the allocation table, and its running total
+ */
+static void get_mon_num_total(void)
+{
+	int i;
+
+	u32b total = 0L;
+
+	alloc_entry *table = alloc_race_table;
+
+	for (i = 0; i < alloc_race_size; i++)
+	{
+		monster_race *r_ptr = &r_info[table[i].index];
+
+		/* Default */
+		table[i].prob3 = 0;
+
+		/* Hack -- "unique" monsters must be "unique" */
+		if (rf_has(r_ptr->flags, RF_UNIQUE) &&
+		    r_ptr->cur_num >= r_ptr->max_num)
+		{
+			/* Nothing */
+		}
+
+		/* Depth Monsters never appear out of depth */
+		else if (rf_has(r_ptr->flags, RF_FORCE_DEPTH) &&
+		         r_ptr->level > p_ptr->depth)
+		{
+			/* Nothing */
+		}
+
+		/* Accept */
+		else
+		{
+			table[i].prob3 = table[i].prob2;
+		}
+
+		/* Total */
+		total += table[i].prob3;
+		table[i].total = total;
+	}
+
+	mon_num_valid = TRUE;
+	mon_num_depth = p_ptr->depth;
+}
+
+
+/*
+ * Return the first entry of the allocation table, between "lo" and "hi",
+ * whose running total is more than "value"
+ */
+static int get_mon_num_find(int lo, int hi, u32b value)
+{
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+
+		if (alloc_race_table[mid].total > value) hi = mid;
+		else lo = mid + 1;
+	}
+
+	return (lo);
+}
+
+
+/*
+ * Return the first entry of the allocation table deeper than "level"
+ */
+static int get_mon_num_level(int level)
+{
+	int lo = 0, hi = alloc_race_size;
+
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+
+		if (alloc_race_table[mid].level > level) hi = mid;
+		else lo = mid + 1;
+	}
+
+	return (lo);
+}
+
+
 
 /*
  * Choose a monster race that seems "appropriate" to the given level
@@ -391,7 +746,9 @@ void get_mon_num_prep(void)
  * This function uses the "prob2" field of the "monster allocation table",
  * and various local information, to calculate the "prob3" field of the
  * same table, which is then used to choose an "appropriate" monster, in
- * a relatively efficient manner.
+ * a relatively efficient manner.  The "prob3" field, and its running total,
+ * are kept between calls, so each choice is a binary search of the entries
+ * allowed at the given level.
  *
  * Note that "town" monsters will *only* be created in the town, and
  * "normal" monsters will *never* be created in the town, unless the
@@ -411,11 +768,9 @@ s16b get_mon_num(int level)
 {
 	int i, j, p;
 
-	int r_idx;
-
-	long value, total;
+	int lo, hi;
 
-	monster_race *r_ptr;
+	u32b base, total;
 
 	alloc_entry *table = alloc_race_table;
 
@@ -423,63 +778,26 @@ s16b get_mon_num(int level)
 	if (level > 0 && one_in_(NASTY_MON))
 		level += MIN(level / 4 + 2, MON_OOD_MAX);
 
-	/* Reset total */
-	total = 0L;
+	/* Bring the running totals up to date */
+	if (!mon_num_valid || (mon_num_depth != p_ptr->depth))
+		get_mon_num_total();
 
-	/* Process probabilities */
-	for (i = 0; i < alloc_race_size; i++)
-	{
-		/* Monsters are sorted by depth */
-		if (table[i].level > level) break;
+	/* Monsters are sorted by depth */
+	hi = get_mon_num_level(level);
 
-		/* Default */
-		table[i].prob3 = 0;
-
-		/* Hack -- No town monsters in dungeon */
-		if ((level > 0) && (table[i].level <= 0)) continue;
+	/* Hack -- No town monsters in dungeon */
+	lo = (level > 0) ? get_mon_num_level(0) : 0;
 
-		/* Get the "r_idx" of the chosen monster */
-		r_idx = table[i].index;
-
-		/* Get the actual race */
-		r_ptr = &r_info[r_idx];
-
-		/* Hack -- "unique" monsters must be "unique" */
-		if (rf_has(r_ptr->flags, RF_UNIQUE) &&
-		    r_ptr->cur_num >= r_ptr->max_num)
-		{
-			continue;
-		}
-
-		/* Depth Monsters never appear out of depth */
-		if (rf_has(r_ptr->flags, RF_FORCE_DEPTH) && r_ptr->level > p_ptr->depth)
-		{
-			continue;
-		}
-
-		/* Accept */
-		table[i].prob3 = table[i].prob2;
-
-		/* Total */
-		total += table[i].prob3;
-	}
+	/* Total of the entries in range */
+	base = (lo > 0) ? table[lo - 1].total : 0L;
+	total = ((hi > 0) ? table[hi - 1].total : 0L) - base;
 
 	/* No legal monsters */
-	if (total <= 0) return (0);
+	if ((hi <= lo) || !total) return (0);
 
 
 	/* Pick a monster */
-	value = randint0(total);
-
-	/* Find the monster */
-	for (i = 0; i < alloc_race_size; i++)
-	{
-		/* Found the entry */
-		if (value < table[i].prob3) break;
-
-		/* Decrement */
-		value = value - table[i].prob3;
-	}
+	i = get_mon_num_find(lo, hi, base + randint0(total));
 
 
 	/* Power boost */
@@ -492,17 +810,7 @@ s16b get_mon_num(int level)
 		j = i;
 
 		/* Pick a monster */
-		value = randint0(total);
-
-		/* Find the monster */
-		for (i = 0; i < alloc_race_size; i++)
-		{
-			/* Found the entry */
-			if (value < table[i].prob3) break;
-
-			/* Decrement */
-			value = value - table[i].prob3;
-		}
+		i = get_mon_num_find(lo, hi, base + randint0(total));
 
 		/* Keep the "best" one */
 		if (table[i].level < table[j].level) i = j;
@@ -515,17 +823,7 @@ s16b get_mon_num(int level)
 		j = i;
 
 		/* Pick a monster */
-		value = randint0(total);
-
-		/* Find the monster */
-		for (i = 0; i < alloc_race_size; i++)
-		{
-			/* Found the entry */
-			if (value < table[i].prob3) break;
-
-			/* Decrement */
-			value = value - table[i].prob3;
-		}
+		i = get_mon_num_find(lo, hi, base + randint0(total));
 
 		/* Keep the "best" one */
 		if (table[i].level < table[j].level) i = j;
@@ -542,7 +840,7 @@ s16b get_mon_num(int level)
  */
 void display_monlist(void)
 {
-	size_t i, j, k;
+	size_t i, j;
 	int max;
 	int line = 1, x = 0;
 	int cur_x;
@@ -560,6 +858,7 @@ void display_monlist(void)
 	monster_vis *list;
 
 	u16b *order;
+	s16b m_idx;
 
 	bool in_term = (Term != angband_term[0]);
 
@@ -591,22 +890,25 @@ void display_monlist(void)
 	/* Allocate the primary array */
 	list = C_ZNEW(z_info->r_max, monster_vis);
 
-	/* Scan the list of monsters on the level */
-	for (i = 1; i < (size_t)mon_max; i++)
+	/* Allocate the secondary array, big enough for every visible race */
+	for (m_idx = mon_vis_head; m_idx; m_idx = mon_list[m_idx].vis_next)
+		total_count++;
+	order = C_ZNEW(MIN(total_count, z_info->r_max), u16b);
+	total_count = 0;
+
+	/* Scan the visible monsters */
+	for (m_idx = mon_vis_head; m_idx; m_idx = mon_list[m_idx].vis_next)
 	{
 		monster_vis *v;
 
-		m_ptr = &mon_list[i];
+		m_ptr = &mon_list[m_idx];
 		r_ptr = &r_info[m_ptr->r_idx];
 
-		/* Only consider visible monsters */
-		if (!m_ptr->ml) continue;
-
 		/* Take a pointer to this monster visibility entry */
 		v = &list[m_ptr->r_idx];
 
 		/* Note each monster type and save its display attr (color) */
-		if (!v->count) type_count++;
+		if (!v->count) order[type_count++] = m_ptr->r_idx;
 		if (!v->attr) v->attr = m_ptr->attr ? m_ptr->attr : r_ptr->x_attr;
 		
 		/* Check for LOS
@@ -644,55 +946,37 @@ void display_monlist(void)
 
 		/* Free up memory */
 		FREE(list);
+		FREE(order);
 
 		/* Done */
 		return;
 	}
 
-	/* Allocate the secondary array */
-	order = C_ZNEW(type_count, u16b);
-
-	/* Sort, because we cannot rely on monster.txt being ordered */
-
-	/* Populate the ordered array, starting at 1 to ignore @ */
-	for (i = 1; i < z_info->r_max; i++)
+	/*
+	 * Sort, because we cannot rely on monster.txt being ordered:
+	 * monsters are sorted by depth, those of the same depth by power,
+	 * and any still equal in race order.
+	 */
+	for (i = 1; i < type_count; i++)
 	{
-		/* No monsters of this race are visible */
-		if (!list[i].count) continue;
+		u16b r_idx = order[i];
 
-		/* Get the monster info */
-		r_ptr = &r_info[i];
+		r_ptr = &r_info[r_idx];
 
-		/* Fit this monster into the sorted array */
-		for (j = 0; j < type_count; j++)
+		for (j = i; j > 0; j--)
 		{
-			/* If we get to the end of the list, put this one in */
-			if (!order[j])
-			{
-				order[j] = i;
-				break;
-			}
-
-			/* Get the monster info for comparison */
-			r2_ptr = &r_info[order[j]];
+			r2_ptr = &r_info[order[j - 1]];
 
-			/* Monsters are sorted by depth */
-			/* Monsters of same depth are sorted by power */
-			if ((r_ptr->level > r2_ptr->level) ||
+			if ((r_ptr->level < r2_ptr->level) ||
 				((r_ptr->level == r2_ptr->level) &&
-				(r_ptr->power > r2_ptr->power)))
-			{
-				/* Move weaker monsters down the array */
-				for (k = type_count - 1; k > j; k--)
-				{
-					order[k] = order[k - 1];
-				}
-
-				/* Put current monster in the right place */
-				order[j] = i;
+				((r_ptr->power < r2_ptr->power) ||
+				((r_ptr->power == r2_ptr->power) && (r_idx > order[j - 1])))))
 				break;
-			}
+
+			order[j] = order[j - 1];
 		}
+
+		order[j] = r_idx;
 	}
 
 	/* Message for monsters in LOS - even if there are none */
@@ -997,46 +1281,28 @@ void monster_desc(char *desc, size_t max, const monster_type *m_ptr, int mode)
 	/* Handle all other visible monster requests */
 	else
 	{
-		/* It could be a Unique */
+		cptr article;
+
+		/* Uniques go by their name (thus nominative and objective) */
 		if (rf_has(r_ptr->flags, RF_UNIQUE))
-		{
-			/* Start with the name (thus nominative and objective) */
-			my_strcpy(desc, name, max);
-		}
+			article = "";
 
-		/* It could be an indefinite monster */
+		/* Indefinite monsters need an indefinite article */
+		/* XXX Check plurality for "some" */
 		else if (mode & 0x08)
-		{
-			/* XXX Check plurality for "some" */
+			article = is_a_vowel(name[0]) ? "an " : "a ";
 
-			/* Indefinite monsters need an indefinite article */
-			my_strcpy(desc, is_a_vowel(name[0]) ? "an " : "a ", max);
-			my_strcat(desc, name, max);
-		}
-
-		/* It could be a normal, definite, monster */
+		/* Definite monsters need a definite article */
 		else
-		{
-			/* Definite monsters need a definite article */
-			my_strcpy(desc, "the ", max);
-			my_strcat(desc, name, max);
-		}
-
-		/* Handle the Possessive as a special afterthought */
-		if (mode & 0x02)
-		{
-			/* XXX Check for trailing "s" */
-
-			/* Simply append "apostrophe" and "s" */
-			my_strcat(desc, "'s", max);
-		}
+			article = "the ";
 
-		/* Mention "offscreen" monsters XXX XXX */
-		if (!panel_contains(m_ptr->fy, m_ptr->fx))
-		{
-			/* Append special notation */
-			my_strcat(desc, " (offscreen)", max);
-		}
+		/*
+		 * Put it all together in one go, with the possessive (XXX check
+		 * for trailing "s") and a mention of "offscreen" monsters
+		 */
+		strnfmt(desc, max, "%s%s%s%s", article, name,
+		        (mode & 0x02) ? "'s" : "",
+		        panel_contains(m_ptr->fy, m_ptr->fx) ? "" : " (offscreen)");
 	}
 }
 
@@ -1201,6 +1467,10 @@ void update_mon(int m_idx, bool full)
 
 		/* Save the distance */
 		m_ptr->cdis = d;
+
+		/* Rouse dormant monsters the player comes near */
+		if ((m_ptr->mflag & (MFLAG_DORM)) && !monster_remote(m_idx))
+			monster_rouse(m_idx);
 	}
 
 	/* Extract distance */
@@ -1211,6 +1481,16 @@ void update_mon(int m_idx, bool full)
 	}
 
 
+	/*
+	 * Out of sight and out of mind: a distant monster which is neither
+	 * detected nor seen stays that way, so there is nothing else to do.
+	 * Most of the monsters on a crowded level take this path.
+	 */
+	if ((d > MAX_SIGHT) && !m_ptr->ml &&
+	    !(m_ptr->mflag & (MFLAG_MARK | MFLAG_VIEW)))
+		return;
+
+
 	/* Detected */
 	if (m_ptr->mflag & (MFLAG_MARK)) flag = TRUE;
 
@@ -1317,6 +1597,7 @@ void update_mon(int m_idx, bool full)
 		{
 			/* Mark as visible */
 			m_ptr->ml = TRUE;
+			mon_vis_link(m_idx);
 
 			/* Draw the monster */
 			light_spot(fy, fx);
@@ -1343,6 +1624,7 @@ void update_mon(int m_idx, bool full)
 		{
 			/* Mark as not visible */
 			m_ptr->ml = FALSE;
+			mon_vis_unlink(m_idx);
 
 			/* Erase the monster */
 			light_spot(fy, fx);
@@ -1402,18 +1684,53 @@ void update_mon(int m_idx, bool full)
  */
 void update_monsters(bool full)
 {
-	int i;
+	static byte *ys, *xs, *dists;
+	static int ys_size;
+	int n;
 
-	/* Update each (live) monster */
-	for (i = 1; i < mon_max; i++)
+	if (!full)
 	{
-		monster_type *m_ptr = &mon_list[i];
+		/* Update each (live) monster */
+		for (n = mon_live_num - 1; n >= 0; n--)
+			update_mon(mon_live[n], FALSE);
 
-		/* Skip dead monsters */
-		if (!m_ptr->r_idx) continue;
+		return;
+	}
 
-		/* Update the monster */
-		update_mon(i, full);
+	if (ys_size < mon_size)
+	{
+		FREE(ys);
+		FREE(xs);
+		FREE(dists);
+
+		ys_size = mon_size;
+		ys = C_ZNEW(ys_size, byte);
+		xs = C_ZNEW(ys_size, byte);
+		dists = C_ZNEW(ys_size, byte);
+	}
+
+	/* Find all the distances at once */
+	for (n = 0; n < mon_live_num; n++)
+	{
+		ys[n] = mon_list[mon_live[n]].fy;
+		xs[n] = mon_list[mon_live[n]].fx;
+	}
+
+	distance_many(p_ptr->py, p_ptr->px, ys, xs, dists, mon_live_num);
+
+	/* Update each (live) monster, as update_mon(m_idx, TRUE) would */
+	for (n = mon_live_num - 1; n >= 0; n--)
+	{
+		int m_idx = mon_live[n];
+		monster_type *m_ptr = &mon_list[m_idx];
+
+		m_ptr->cdis = dists[n];
+
+		/* Rouse dormant monsters the player comes near */
+		if ((m_ptr->mflag & (MFLAG_DORM)) && !monster_remote(m_idx))
+			monster_rouse(m_idx);
+
+		update_mon(m_idx, FALSE);
 	}
 }
 
@@ -1502,13 +1819,13 @@ void monster_swap(int y1, int x1, int y2, int x2)
 	monster_race *r_ptr;
 
 	/* Monsters */
-	m1 = cave_m_idx[y1][x1];
-	m2 = cave_m_idx[y2][x2];
+	m1 = cave->grid[y1][x1].m_idx;
+	m2 = cave->grid[y2][x2].m_idx;
 
 
 	/* Update grids */
-	cave_m_idx[y1][x1] = m2;
-	cave_m_idx[y2][x2] = m1;
+	cave->grid[y1][x1].m_idx = m2;
+	cave->grid[y2][x2].m_idx = m1;
 
 
 	/* Monster 1 */
@@ -1610,7 +1927,7 @@ void monster_swap(int y1, int x1, int y2, int x2)
 s16b player_place(int y, int x)
 {
 	/* Paranoia XXX XXX */
-	if (cave_m_idx[y][x] != 0) return (0);
+	if (cave->grid[y][x].m_idx != 0) return (0);
 
 
 	/* Save player location */
@@ -1618,7 +1935,7 @@ s16b player_place(int y, int x)
 	p_ptr->px = x;
 
 	/* Mark cave grid */
-	cave_m_idx[y][x] = -1;
+	cave->grid[y][x].m_idx = -1;
 
 	/* Success */
 	return (-1);
@@ -1637,7 +1954,7 @@ s16b monster_place(int y, int x, monster_type *n_ptr)
 
 
 	/* Paranoia XXX XXX */
-	if (cave_m_idx[y][x] != 0) return (0);
+	if (cave->grid[y][x].m_idx != 0) return (0);
 
 
 	/* Get a new record */
@@ -1647,7 +1964,7 @@ s16b monster_place(int y, int x, monster_type *n_ptr)
 	if (m_idx)
 	{
 		/* Make a new monster */
-		cave_m_idx[y][x] = m_idx;
+		cave->grid[y][x].m_idx = m_idx;
 
 		/* Get the new monster */
 		m_ptr = &mon_list[m_idx];
@@ -1659,6 +1976,21 @@ s16b monster_place(int y, int x, monster_type *n_ptr)
 		m_ptr->fy = y;
 		m_ptr->fx = x;
 
+		/* Count it as alive */
+		mon_live_add(m_idx);
+
+		/* And as hurt, if it is (as it may be, coming from a savefile) */
+		m_ptr->mflag &= ~(MFLAG_HURT);
+		if (m_ptr->hp < m_ptr->maxhp) monster_hurt(m_idx);
+
+		/* Schedule the monster's first move */
+		m_ptr->energy_turn = turn;
+		m_ptr->sched_next = m_ptr->sched_prev = 0;
+		monster_schedule(m_idx);
+
+		/* A copy of a visible monster is seen too */
+		if (m_ptr->ml) mon_vis_link(m_idx);
+
 		/* Update the monster */
 		update_mon(m_idx, TRUE);
 
@@ -1673,6 +2005,9 @@ s16b monster_place(int y, int x, monster_type *n_ptr)
 
 		/* Count racial occurances */
 		r_ptr->cur_num++;
+
+		/* A unique may no longer be available */
+		if (rf_has(r_ptr->flags, RF_UNIQUE)) get_mon_num_reset();
 	}
 
 	/* Result */
@@ -1715,11 +2050,16 @@ static bool place_monster_one(int y, int x, int r_idx, bool slp)
 	/* Paranoia */
 	if (!in_bounds(y, x)) return (FALSE);
 
+	/* Don't fill a new level up (see "GEN_SLOTS_FREE") */
+	if (!character_dungeon && (mon_cnt + GEN_SLOTS_FREE >= mon_size) &&
+	    !mon_list_grow(mon_cnt + GEN_SLOTS_FREE + 1))
+		return (FALSE);
+
 	/* Require empty space */
 	if (!cave_empty_bold(y, x)) return (FALSE);
 
 	/* Hack -- no creation on glyph of warding */
-	if (cave_feat[y][x] == FEAT_GLYPH) return (FALSE);
+	if (cave->grid[y][x].feat == FEAT_GLYPH) return (FALSE);
 
 
 	/* Paranoia */
@@ -2164,6 +2504,20 @@ bool place_monster(int y, int x, int depth, bool slp, bool grp)
 
 
 
+/*
+ * How far from the player alloc_monster() wants its monster
+ */
+static int alloc_monster_dis;
+
+static bool alloc_monster_ok(int y, int x)
+{
+	/* Require "naked" floor grid */
+	if (!cave_naked_bold(y, x)) return FALSE;
+
+	/* Accept far away grids */
+	return (distance(y, x, p_ptr->py, p_ptr->px) > alloc_monster_dis);
+}
+
 /*
  * Attempt to allocate a random monster in the dungeon.
  *
@@ -2175,27 +2529,11 @@ bool place_monster(int y, int x, int depth, bool slp, bool grp)
  */
 bool alloc_monster(int dis, bool slp, int depth)
 {
-	int py = p_ptr->py;
-	int px = p_ptr->px;
-
-	int y = 0, x = 0;
-	int	attempts_left = 10000;
+	int y, x;
 
 	/* Find a legal, distant, unoccupied, space */
-	while (--attempts_left)
-	{
-		/* Pick a location */
-		y = randint0(level_hgt);
-		x = randint0(level_wid);
-
-		/* Require "naked" floor grid */
-		if (!cave_naked_bold(y, x)) continue;
-
-		/* Accept far away grids */
-		if (distance(y, x, py, px) > dis) break;
-	}
-
-	if (!attempts_left)
+	alloc_monster_dis = dis;
+	if (!cave_find(&y, &x, alloc_monster_ok))
 	{
 		if (OPT(cheat_xtra) || OPT(cheat_hear))
 		{
@@ -2402,7 +2740,7 @@ bool summon_specific(int y1, int x1, int lev, int type, int delay)
 		if (!cave_empty_bold(y, x)) continue;
 
 		/* Hack -- no summon on glyph of warding */
-		if (cave_feat[y][x] == FEAT_GLYPH) continue;
+		if (cave->grid[y][x].feat == FEAT_GLYPH) continue;
 
 		/* Okay */
 		break;
@@ -2443,7 +2781,7 @@ bool summon_specific(int y1, int x1, int lev, int type, int delay)
 	/* If delay, try to let the player act before the summoned monsters. */
 	/* NOTE: should really be -100, but energy is currently 0-255. */
 	if (delay)
-		mon_list[cave_m_idx[y][x]].energy = 0;
+		monster_set_energy(cave->grid[y][x].m_idx, 0);
 
 	/* Success */
 	return (TRUE);
@@ -2464,28 +2802,44 @@ bool multiply_monster(int m_idx)
 
 	int i, y, x;
 
-	bool result = FALSE;
+	int grids[9];
+	int n = 0;
+	bool any_empty = FALSE;
+
+	/*
+	 * List the grids a child could be scattered to, that is the ones in
+	 * bounds around (and including) the parent, and note if any are free
+	 */
+	for (y = m_ptr->fy - 1; y <= m_ptr->fy + 1; y++)
+	{
+		for (x = m_ptr->fx - 1; x <= m_ptr->fx + 1; x++)
+		{
+			if (!in_bounds_fully(y, x)) continue;
+
+			grids[n++] = GRID(y, x);
+			if (cave_empty_bold(y, x)) any_empty = TRUE;
+		}
+	}
+
+	/* Nowhere to go */
+	if (!any_empty) return (FALSE);
 
-	/* Try up to 18 times */
+	/* Try up to 18 times, as scatter() would */
 	for (i = 0; i < 18; i++)
 	{
-		int d = 1;
+		int g = grids[randint0(n)];
 
-		/* Pick a location */
-		scatter(&y, &x, m_ptr->fy, m_ptr->fx, d, 0);
+		y = GRID_Y(g);
+		x = GRID_X(g);
 
 		/* Require an "empty" floor grid */
 		if (!cave_empty_bold(y, x)) continue;
 
 		/* Create a new monster (awake, no groups) */
-		result = place_monster_aux(y, x, m_ptr->r_idx, FALSE, FALSE);
-
-		/* Done */
-		break;
+		return (place_monster_aux(y, x, m_ptr->r_idx, FALSE, FALSE));
 	}
 
-	/* Result */
-	return (result);
+	return (FALSE);
 }
 
 
@@ -2853,11 +3207,110 @@ static void build_quest_stairs(int y, int x)
 	/* Update the visuals */
 	p_ptr->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
 
-	/* Fully update the flow */
-	p_ptr->update |= (PU_FORGET_FLOW | PU_UPDATE_FLOW);
+	/* Update the flow */
+	p_ptr->update |= (PU_UPDATE_FLOW);
+}
+
+
+
+/*
+ * Make the objects and gold a monster of race `r_ptr` drops on dying at
+ * `depth` (not counting anything it carries), passing each to `drop` with
+ * `data`.  How many objects and piles of gold were made are added to
+ * `dump_item` and `dump_gold`.
+ *
+ * Nothing else is touched, bar what make_object() does (marking artifacts
+ * as created and changing the level rating), so the drops of a race can be
+ * simulated without a level; see stats_collect_drops().
+ */
+void monster_make_drops(const monster_race *r_ptr, int depth,
+		void (*drop)(object_type *o_ptr, void *data), void *data,
+		int *dump_item, int *dump_gold)
+{
+	int j, level;
+	int number = 0;
+
+	bool great = (rf_has(r_ptr->flags, RF_DROP_GREAT)) ? TRUE : FALSE;
+	bool good = (rf_has(r_ptr->flags, RF_DROP_GOOD) ? TRUE : FALSE) || great;
+
+	bool gold_ok = (!rf_has(r_ptr->flags, RF_ONLY_ITEM));
+	bool item_ok = (!rf_has(r_ptr->flags, RF_ONLY_GOLD));
+
+	int force_coin = get_coin_type(r_ptr);
+
+	object_type *i_ptr;
+	object_type object_type_body;
+
+	/* Determine how much we can drop */
+	if (rf_has(r_ptr->flags, RF_DROP_20) && randint0(100) < 20) number++;
+	if (rf_has(r_ptr->flags, RF_DROP_40) && randint0(100) < 40) number++;
+	if (rf_has(r_ptr->flags, RF_DROP_60) && randint0(100) < 60) number++;
+
+	if (rf_has(r_ptr->flags, RF_DROP_4)) number += rand_range(2, 6);
+	if (rf_has(r_ptr->flags, RF_DROP_3)) number += rand_range(2, 4);
+	if (rf_has(r_ptr->flags, RF_DROP_2)) number += rand_range(1, 3);
+	if (rf_has(r_ptr->flags, RF_DROP_1)) number++;
+
+	/* Take the best of average of monster level and current depth,
+	   and monster level - to reward fighting OOD monsters */
+	level = MAX((r_ptr->level + depth) / 2, r_ptr->level);
+
+	/* Drop some objects */
+	for (j = 0; j < number; j++)
+	{
+		/* Get local object */
+		i_ptr = &object_type_body;
+
+		/* Wipe the object */
+		object_wipe(i_ptr);
+
+		/* Make Gold */
+		if (gold_ok && (!item_ok || (randint0(100) < 50)))
+		{
+			/* Make some gold */
+			make_gold(i_ptr, level, force_coin);
+			(*dump_gold)++;
+		}
+
+		/* Make Object */
+		else
+		{
+			/* Make an object */
+			if (!make_object(i_ptr, level, good, great)) continue;
+			(*dump_item)++;
+		}
+
+		drop(i_ptr, data);
+	}
 }
 
 
+/*
+ * Where a dying monster's drops go, for monster_death_drop()
+ */
+struct death_drop
+{
+	int m_idx;
+	bool visible;
+	int y, x;
+};
+
+/*
+ * Drop an object a monster made on dying
+ */
+static void monster_death_drop(object_type *i_ptr, void *data)
+{
+	const struct death_drop *death = data;
+
+	/* Set origin */
+	i_ptr->origin = death->visible ? ORIGIN_DROP : ORIGIN_DROP_UNKNOWN;
+	i_ptr->origin_depth = p_ptr->depth;
+	i_ptr->origin_xtra = mon_list[death->m_idx].r_idx;
+
+	/* Drop it in the dungeon */
+	drop_near(i_ptr, 0, death->y, death->x, TRUE);
+}
+
 
 /*
  * Handle the "death" of a monster.
@@ -2875,12 +3328,11 @@ static void build_quest_stairs(int y, int x)
  */
 void monster_death(int m_idx)
 {
-	int i, j, y, x, level;
+	int i, y, x;
 
 	int dump_item = 0;
 	int dump_gold = 0;
 
-	int number = 0;
 	int total = 0;
 
 	s16b this_o_idx, next_o_idx = 0;
@@ -2891,13 +3343,7 @@ void monster_death(int m_idx)
 
 	bool visible = (m_ptr->ml || rf_has(r_ptr->flags, RF_UNIQUE));
 
-	bool great = (rf_has(r_ptr->flags, RF_DROP_GREAT)) ? TRUE : FALSE;
-	bool good = (rf_has(r_ptr->flags, RF_DROP_GOOD) ? TRUE : FALSE) || great;
-
-	bool gold_ok = (!rf_has(r_ptr->flags, RF_ONLY_ITEM));
-	bool item_ok = (!rf_has(r_ptr->flags, RF_ONLY_GOLD));
-
-	int force_coin = get_coin_type(r_ptr);
+	struct death_drop death;
 
 	object_type *i_ptr;
 	object_type object_type_body;
@@ -2975,53 +3421,13 @@ void monster_death(int m_idx)
 	}
 
 
-	/* Determine how much we can drop */
-	if (rf_has(r_ptr->flags, RF_DROP_20) && randint0(100) < 20) number++;
-	if (rf_has(r_ptr->flags, RF_DROP_40) && randint0(100) < 40) number++;
-	if (rf_has(r_ptr->flags, RF_DROP_60) && randint0(100) < 60) number++;
-
-	if (rf_has(r_ptr->flags, RF_DROP_4)) number += rand_range(2, 6);
-	if (rf_has(r_ptr->flags, RF_DROP_3)) number += rand_range(2, 4);
-	if (rf_has(r_ptr->flags, RF_DROP_2)) number += rand_range(1, 3);
-	if (rf_has(r_ptr->flags, RF_DROP_1)) number++;
-
-	/* Take the best of average of monster level and current depth,
-	   and monster level - to reward fighting OOD monsters */
-	level = MAX((r_ptr->level + p_ptr->depth) / 2, r_ptr->level);
-
 	/* Drop some objects */
-	for (j = 0; j < number; j++)
-	{
-		/* Get local object */
-		i_ptr = &object_type_body;
-
-		/* Wipe the object */
-		object_wipe(i_ptr);
-
-		/* Make Gold */
-		if (gold_ok && (!item_ok || (randint0(100) < 50)))
-		{
-			/* Make some gold */
-			make_gold(i_ptr, level, force_coin);
-			dump_gold++;
-		}
-
-		/* Make Object */
-		else
-		{
-			/* Make an object */
-			if (!make_object(i_ptr, level, good, great)) continue;
-			dump_item++;
-		}
-
-		/* Set origin */
-		i_ptr->origin = visible ? ORIGIN_DROP : ORIGIN_DROP_UNKNOWN;
-		i_ptr->origin_depth = p_ptr->depth;
-		i_ptr->origin_xtra = m_ptr->r_idx;
-
-		/* Drop it in the dungeon */
-		drop_near(i_ptr, 0, y, x, TRUE);
-	}
+	death.m_idx = m_idx;
+	death.visible = visible;
+	death.y = y;
+	death.x = x;
+	monster_make_drops(r_ptr, p_ptr->depth, monster_death_drop, &death,
+			&dump_item, &dump_gold);
 
 	/* Take note of any dropped treasure */
 	if (visible && (dump_item || dump_gold))
@@ -3077,6 +3483,9 @@ bool wake_monster(monster_type *m_ptr)
 
 	m_ptr->csleep = 0;
 
+	/* It can act again */
+	monster_rouse(m_ptr - mon_list);
+
 	/* If it just woke up, update the monster list */
 	p_ptr->redraw |= PR_MONLIST;
 	
@@ -3126,6 +3535,7 @@ bool mon_take_hit(int m_idx, int dam, bool *fear, cptr note)
 
 	/* Hurt it */
 	m_ptr->hp -= dam;
+	monster_hurt(m_idx);
 
 	/* It is dead now */
 	if (m_ptr->hp < 0)
@@ -3199,6 +3609,7 @@ bool mon_take_hit(int m_idx, int dam, bool *fear, cptr note)
 		{
 			char unique_name[80];
 			r_ptr->max_num = 0;
+			get_mon_num_reset();
 
 			/* This gets the correct name if we slay an invisible unique and don't have See Invisible. */
 			monster_desc(unique_name, sizeof(unique_name), m_ptr, MDESC_SHOW | MDESC_IND2);
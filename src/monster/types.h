@@ -124,28 +124,38 @@ typedef struct
  */
 typedef struct
 {
+	/* Looked at every time the monster is processed */
 	s16b r_idx;			/* Monster race index */
 
 	byte fy;			/* Y location on map */
 	byte fx;			/* X location on map */
 
-	s16b hp;			/* Current Hit points */
-	s16b maxhp;			/* Max Hit points */
+	s32b energy_due;	/* Game turn at which the monster can next act */
+	s32b energy_turn;	/* Game turn at which "energy" was correct */
+	s16b sched_next;	/* Next monster due on the same turn */
+	s16b sched_prev;	/* Previous monster due on the same turn */
 
+	s16b hp;			/* Current Hit points */
 	s16b csleep;		/* Inactive counter */
 
 	byte mspeed;		/* Monster "speed" */
-	byte energy;		/* Monster "energy" */
+	byte energy;		/* Monster "energy" (as of "energy_turn") */
+
+	byte cdis;			/* Current dis from player */
+	byte mflag;			/* Extra monster flags */
+	bool ml;			/* Monster is "visible" */
 
 	byte stunned;		/* Monster is stunned */
 	byte confused;		/* Monster is confused */
 	byte monfear;		/* Monster is afraid */
 
-	byte cdis;			/* Current dis from player */
-
-	byte mflag;			/* Extra monster flags */
+	/* Looked at now and then */
+	s16b maxhp;			/* Max Hit points */
 
-	bool ml;			/* Monster is "visible" */
+	s16b vis_next;		/* Next visible monster (see display_monlist()) */
+	s16b vis_prev;		/* Previous visible monster */
+	s16b live_pos;		/* Place in mon_live[] */
+	s16b hurt_pos;		/* Place in mon_hurt[], if MFLAG_HURT */
 
 	s16b hold_o_idx;	/* Object being held (if any) */
 
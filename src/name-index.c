@@ -0,0 +1,166 @@
+/*
+ * File: name-index.c
+ * Purpose: Finding entries of the info arrays by name
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+#include "angband.h"
+#include "name-index.h"
+
+/*
+ * A name index covers the entries 1 to max - 1 of one of the info arrays,
+ * with an open hash of them by exact name and a list of them in order of
+ * name (ignoring case) for finding those whose names start with something.
+ *
+ * Entries with the same name all go in the hash, in the order they come in
+ * the array, so a search meets the first of them first and a caller can
+ * skip those it doesn't want (object kinds are only told apart by tval).
+ *
+ * Each index notes the array it was built for, so that the lookup functions
+ * can build it on first use and again whenever the array is replaced.
+ */
+
+static u32b name_index_key(const char *name)
+{
+	u32b h = 5381;
+
+	while (*name)
+		h = h * 33 + (byte)*name++;
+
+	return h * 2654435761U;
+}
+
+/* The index being sorted, for name_index_cmp() */
+static const struct name_index *sorting;
+
+static int name_index_cmp(const void *a, const void *b)
+{
+	s16b ia = *(const s16b *)a;
+	s16b ib = *(const s16b *)b;
+	int c = my_stricmp(sorting->name(ia), sorting->name(ib));
+
+	/* The same names stay in array order */
+	return c ? c : (ia - ib);
+}
+
+
+/*
+ * Whether `ni` needs building for `max` entries of array `of`
+ */
+bool name_index_stale(const struct name_index *ni, const void *of, int max)
+{
+	return (ni->of != of) || (ni->max != max);
+}
+
+/*
+ * Build `ni` for entries 1 to `max` - 1 of array `of`, with the names given
+ * by `name` (which gives NULL for unused entries)
+ */
+void name_index_build(struct name_index *ni, const void *of, int max,
+		name_index_name_fn name)
+{
+	int i;
+
+	name_index_free(ni);
+
+	for (ni->hash_size = 16; ni->hash_size < 2 * (size_t)max; )
+		ni->hash_size *= 2;
+	ni->hash = C_ZNEW(ni->hash_size, s16b);
+	ni->sorted = C_ZNEW(MAX(max, 1), s16b);
+	ni->name = name;
+
+	for (i = 1; i < max; i++)
+	{
+		const char *nm = name(i);
+		size_t h;
+
+		if (!nm) continue;
+
+		h = name_index_key(nm) & (ni->hash_size - 1);
+		while (ni->hash[h])
+			h = (h + 1) & (ni->hash_size - 1);
+
+		ni->hash[h] = i;
+		ni->sorted[ni->n_sorted++] = i;
+	}
+
+	sorting = ni;
+	qsort(ni->sorted, ni->n_sorted, sizeof(s16b), name_index_cmp);
+	sorting = NULL;
+
+	ni->of = of;
+	ni->max = max;
+}
+
+/*
+ * Free the memory used by `ni`
+ */
+void name_index_free(struct name_index *ni)
+{
+	FREE(ni->hash);
+	FREE(ni->sorted);
+	WIPE(ni, struct name_index);
+}
+
+
+/*
+ * The first entry named exactly `name` which `test` (if any) accepts, or 0
+ * if there's none
+ */
+int name_index_find(const struct name_index *ni, const char *name,
+		name_index_test_fn test, int data)
+{
+	size_t h = name_index_key(name) & (ni->hash_size - 1);
+
+	for (; ni->hash[h]; h = (h + 1) & (ni->hash_size - 1))
+	{
+		int i = ni->hash[h];
+
+		if (streq(name, ni->name(i)) && (!test || test(i, data)))
+			return i;
+	}
+
+	return 0;
+}
+
+/*
+ * The entry, first in order of name, whose name starts with `prefix`
+ * (ignoring case), or 0 if there's none.  `matches`, if given, is set to
+ * how many names start that way.
+ */
+int name_index_prefix(const struct name_index *ni, const char *prefix,
+		int *matches)
+{
+	int len = strlen(prefix);
+	int lo = 0, hi = ni->n_sorted;
+	int n;
+
+	/* Find the first name not before the prefix */
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+
+		if (my_stricmp(ni->name(ni->sorted[mid]), prefix) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	/* Those starting with it all follow */
+	for (n = 0; lo + n < ni->n_sorted; n++)
+		if (my_strnicmp(ni->name(ni->sorted[lo + n]), prefix, len))
+			break;
+
+	if (matches) *matches = n;
+
+	return n ? ni->sorted[lo] : 0;
+}
@@ -0,0 +1,31 @@
+/* name-index.h - finding entries of the info arrays by name */
+
+#ifndef NAME_INDEX_H
+#define NAME_INDEX_H
+
+typedef const char *(*name_index_name_fn)(int idx);
+typedef bool (*name_index_test_fn)(int idx, int data);
+
+struct name_index
+{
+	const void *of;			/* The array indexed */
+	int max;			/* and its size */
+	name_index_name_fn name;
+
+	s16b *hash;			/* Open hash by exact name */
+	size_t hash_size;
+
+	s16b *sorted;			/* In order of name, ignoring case */
+	int n_sorted;
+};
+
+extern bool name_index_stale(const struct name_index *ni, const void *of, int max);
+extern void name_index_build(struct name_index *ni, const void *of, int max,
+		name_index_name_fn name);
+extern void name_index_free(struct name_index *ni);
+extern int name_index_find(const struct name_index *ni, const char *name,
+		name_index_test_fn test, int data);
+extern int name_index_prefix(const struct name_index *ni, const char *prefix,
+		int *matches);
+
+#endif /* !NAME_INDEX_H */
@@ -28,6 +28,9 @@
 /** Time last item was wielded */
 s32b object_last_wield;
 
+/** Whether things to notice over time have been noticed since then */
+static bool object_time_noticed;
+
 /*** Knowledge accessor functions ***/
 
 
@@ -628,8 +631,7 @@ static void object_notice_defence_plusses(object_type *o_ptr)
 	}
 
 	p_ptr->update |= (PU_BONUS);
-	event_signal(EVENT_INVENTORY);
-	event_signal(EVENT_EQUIPMENT);
+	p_ptr->redraw |= (PR_INVEN | PR_EQUIP);
 }
 
 
@@ -662,8 +664,7 @@ void object_notice_attack_plusses(object_type *o_ptr)
 	}
 
 	p_ptr->update |= (PU_BONUS);
-	event_signal(EVENT_INVENTORY);
-	event_signal(EVENT_EQUIPMENT);
+	p_ptr->redraw |= (PR_INVEN | PR_EQUIP);
 }
 
 
@@ -687,8 +688,7 @@ bool object_notice_flag(object_type *o_ptr, int flag)
 		 * but maybe this will interfere with savefile repair
 		 */
 		object_check_for_ident(o_ptr);
-		event_signal(EVENT_INVENTORY);
-		event_signal(EVENT_EQUIPMENT);
+		p_ptr->redraw |= (PR_INVEN | PR_EQUIP);
 
 		return TRUE;
 	}
@@ -709,8 +709,7 @@ bool object_notice_flags(object_type *o_ptr, bitflag flags[OF_SIZE])
 		 * but maybe this will interfere with savefile repair
 		 */
 		object_check_for_ident(o_ptr);
-		event_signal(EVENT_INVENTORY);
-		event_signal(EVENT_EQUIPMENT);
+		p_ptr->redraw |= (PR_INVEN | PR_EQUIP);
 
 		return TRUE;
 	}
@@ -754,8 +753,7 @@ void object_notice_on_defend(void)
 	for (i = INVEN_WIELD; i < INVEN_TOTAL; i++)
 		object_notice_defence_plusses(&p_ptr->inventory[i]);
 
-	event_signal(EVENT_INVENTORY);
-	event_signal(EVENT_EQUIPMENT);
+	p_ptr->redraw |= (PR_INVEN | PR_EQUIP);
 }
 
 
@@ -789,6 +787,7 @@ void object_notice_on_wield(object_type *o_ptr)
 
 	/* Save time of wield for later */
 	object_last_wield = turn;
+	object_time_noticed = FALSE;
 
 	/* Only deal with un-ID'd items */
 	if (object_is_known(o_ptr)) return;
@@ -1134,11 +1133,11 @@ void sense_inventory(void)
 	if (p_ptr->timed[TMD_CONFUSED]) return;
 
 
-	/* Notice some things after a while */
-	if (turn >= (object_last_wield + 3000))
+	/* Notice some things a while after wielding (or loading), once */
+	if (!object_time_noticed && (turn >= (object_last_wield + 3000)))
 	{
 		object_notice_after_time();
-		object_last_wield = 0;
+		object_time_noticed = TRUE;
 	}
 
 
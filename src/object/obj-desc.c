@@ -20,6 +20,77 @@
 #include "squelch.h"
 #include "tvalsval.h"
 
+/*
+ * Recently made descriptions.  Inventory, equipment, store and list
+ * windows describe the same objects over and over, so object_desc() keeps
+ * what it made last time for each, along with everything outside the
+ * object that went into the result.
+ */
+#define DESC_CACHE_SIZE		64
+#define DESC_CACHE_LEN		80
+
+struct desc_key
+{
+	odesc_detail_t mode;
+	bool aware;           /* The kind's knowledge and squelch settings */
+	bool tried;
+	byte squelch;
+	byte flavor;
+	byte squelch_level;   /* The squelch level for the object's type */
+	bool show_flavors;
+	bool squelch_worthless;
+};
+
+static struct desc_cache_entry
+{
+	bool valid;
+	struct desc_key key;
+	object_type obj;
+	size_t len;
+	char text[DESC_CACHE_LEN];
+} desc_cache[DESC_CACHE_SIZE];
+
+
+/*
+ * Forget every cached description, for when flavours or artifact names
+ * are assigned afresh.
+ */
+void object_desc_forget(void)
+{
+	C_WIPE(desc_cache, DESC_CACHE_SIZE, struct desc_cache_entry);
+}
+
+
+/*
+ * Fill in the cache key of object `o_ptr` under mode `mode`, and return the
+ * cache slot the description would live in.
+ */
+static struct desc_cache_entry *desc_cache_slot(struct desc_key *key,
+		const object_type *o_ptr, odesc_detail_t mode)
+{
+	const object_kind *k_ptr = &k_info[o_ptr->k_idx];
+	const byte *b = (const byte *)o_ptr;
+	squelch_type_t type = squelch_type_of(o_ptr);
+	u32b h = 2166136261U;
+	size_t i;
+
+	/* Zero the padding too, so keys can be compared whole */
+	WIPE(key, struct desc_key);
+	key->mode = mode;
+	key->aware = k_ptr->aware;
+	key->tried = k_ptr->tried;
+	key->squelch = k_ptr->squelch;
+	key->flavor = k_ptr->flavor;
+	key->squelch_level = (type == TYPE_MAX) ? 0 : squelch_level[type];
+	key->show_flavors = OPT(show_flavors);
+	key->squelch_worthless = OPT(squelch_worthless);
+
+	for (i = 0; i < sizeof(object_type); i++)
+		h = (h ^ b[i]) * 16777619U;
+
+	return &desc_cache[(h ^ mode) % DESC_CACHE_SIZE];
+}
+
 /*
  * Puts a very stripped-down version of an object's name into buf.
  * If easy_know is TRUE, then the IDed names are used, otherwise
@@ -792,6 +863,9 @@ size_t object_desc(char *buf, size_t max, const object_type *o_ptr,
 
 	size_t end = 0;
 
+	struct desc_key key;
+	struct desc_cache_entry *slot;
+
 
 	/* We've seen it at least once now we're aware of it */
 	if (known && o_ptr->name2) e_info[o_ptr->name2].everseen = TRUE;
@@ -807,6 +881,22 @@ size_t object_desc(char *buf, size_t max, const object_type *o_ptr,
 		return strnfmt(buf, max, "(nothing)");
 
 
+	/* Reuse the last description, if nothing it depends on has changed */
+	slot = desc_cache_slot(&key, o_ptr, mode);
+	if (slot->valid && (slot->len < max) &&
+			!memcmp(&slot->key, &key, sizeof(key)) &&
+			!memcmp(&slot->obj, o_ptr, sizeof(object_type)))
+	{
+		/* As obj_desc_name() would */
+		if (object_flavor_is_aware(o_ptr) || (o_ptr->ident & IDENT_STORE) ||
+				spoil)
+			k_ptr->everseen = TRUE;
+
+		memcpy(buf, slot->text, slot->len + 1);
+		return slot->len;
+	}
+
+
 	/** Construct the name **/
 
 	/* Copy the base name to the buffer */
@@ -837,5 +927,15 @@ size_t object_desc(char *buf, size_t max, const object_type *o_ptr,
 			end = obj_desc_inscrip(o_ptr, buf, max, end);
 	}
 
+	/* Remember it, unless it may have been cut short */
+	if ((end + 1 < max) && (end < DESC_CACHE_LEN))
+	{
+		slot->valid = TRUE;
+		slot->key = key;
+		COPY(&slot->obj, o_ptr, object_type);
+		slot->len = end;
+		memcpy(slot->text, buf, end + 1);
+	}
+
 	return end;
 }
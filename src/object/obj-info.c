@@ -21,6 +21,7 @@
 #include "attack.h"
 #include "effects.h"
 #include "cmds.h"
+#include "init.h"
 #include "tvalsval.h"
 #include "z-textblock.h"
 
@@ -1210,7 +1211,7 @@ static void describe_flavor_text(textblock *tb, const object_type *o_ptr)
 	if (!OPT(adult_randarts) && o_ptr->name1 &&
 			object_is_known(o_ptr) && a_info[o_ptr->name1].text)
 	{
-		textblock_append(tb, "%s\n\n", a_info[o_ptr->name1].text);
+		textblock_append(tb, "%s\n\n", cache_text(a_info[o_ptr->name1].text));
 	}
 
 	/* Display the known object description */
@@ -1220,7 +1221,7 @@ static void describe_flavor_text(textblock *tb, const object_type *o_ptr)
 
 		if (k_info[o_ptr->k_idx].text)
 		{
-			textblock_append(tb, "%s", k_info[o_ptr->k_idx].text);
+			textblock_append(tb, "%s", cache_text(k_info[o_ptr->k_idx].text));
 			did_desc = TRUE;
 		}
 
@@ -1228,7 +1229,7 @@ static void describe_flavor_text(textblock *tb, const object_type *o_ptr)
 		if (object_ego_is_visible(o_ptr) && e_info[o_ptr->name2].text)
 		{
 			if (did_desc) textblock_append(tb, "  ");
-			textblock_append(tb, "%s\n\n", e_info[o_ptr->name2].text);
+			textblock_append(tb, "%s\n\n", cache_text(e_info[o_ptr->name2].text));
 		}
 		else if (did_desc)
 		{
@@ -1256,9 +1257,10 @@ bool describe_ego(textblock *tb, const object_type *o_ptr)
 
 
 /*
- * Output object information
+ * Add object information to `tb`
  */
-static textblock *object_info_out(const object_type *o_ptr, oinfo_detail_t mode)
+static void object_info_out_to(textblock *tb, const object_type *o_ptr,
+		oinfo_detail_t mode)
 {
 	bitflag flags[OF_SIZE];
 	bool something = FALSE;
@@ -1269,8 +1271,6 @@ static textblock *object_info_out(const object_type *o_ptr, oinfo_detail_t mode)
 	bool subjective = mode & OINFO_SUBJ;
 	bool ego = mode & OINFO_EGO;
 
-	textblock *tb = textblock_new();
-
 	/* Grab the object flags */
 	if (full)
 		object_flags(o_ptr, flags);
@@ -1314,11 +1314,70 @@ static textblock *object_info_out(const object_type *o_ptr, oinfo_detail_t mode)
 
 	if (!something)
 		textblock_append(tb, "\n\nThis item does not seem to possess any special abilities.");
+}
+
+/*
+ * Output object information
+ */
+static textblock *object_info_out(const object_type *o_ptr, oinfo_detail_t mode)
+{
+	textblock *tb = textblock_new();
+
+	object_info_out_to(tb, o_ptr, mode);
 
 	return tb;
 }
 
 
+/*
+ * The last few descriptions made by object_info(), as the same items are
+ * looked at over and over (the object subwindow redraws on every change to
+ * the inventory, and menus show the item under the cursor).
+ *
+ * Each is for a copy of the object as it was, so anything learnt about the
+ * item itself, or any change to it, makes the copy differ.  Knowledge of
+ * the kind is kept alongside, and what comes from the player -- the combat
+ * and digging figures -- is covered by `info_stamp`, which changes whenever
+ * the equipment, the player's state or level have.
+ */
+#define INFO_CACHE_MAX	8
+
+struct info_cache
+{
+	object_type obj;
+	oinfo_detail_t mode;
+	bool worn_right;
+	bool aware, tried, everseen;
+	u32b stamp;
+
+	textblock *tb;
+};
+
+static struct info_cache info_cache[INFO_CACHE_MAX];
+static int info_cache_next;
+
+static u32b info_stamp = 1;
+static object_type info_equip[INVEN_TOTAL - INVEN_WIELD];
+static player_state info_state;
+static s16b info_lev;
+
+/*
+ * Change `info_stamp` if anything about the player the descriptions draw on
+ * has changed
+ */
+static void info_check_player(void)
+{
+	if (!memcmp(info_equip, &p_ptr->inventory[INVEN_WIELD], sizeof(info_equip)) &&
+	    !memcmp(&info_state, &p_ptr->state, sizeof(info_state)) &&
+	    (info_lev == p_ptr->lev))
+		return;
+
+	memcpy(info_equip, &p_ptr->inventory[INVEN_WIELD], sizeof(info_equip));
+	memcpy(&info_state, &p_ptr->state, sizeof(info_state));
+	info_lev = p_ptr->lev;
+	info_stamp++;
+}
+
 /**
  * Provide information on an item, including how it would affect the current
  * player's state.
@@ -1330,8 +1389,50 @@ static textblock *object_info_out(const object_type *o_ptr, oinfo_detail_t mode)
  */
 textblock *object_info(const object_type *o_ptr, oinfo_detail_t mode)
 {
+	const object_kind *k_ptr = &k_info[o_ptr->k_idx];
+	bool worn_right = (o_ptr == &p_ptr->inventory[INVEN_RIGHT]);
+	struct info_cache *c = NULL;
+	textblock *tb;
+	int i;
+
 	mode |= OINFO_SUBJ;
-	return object_info_out(o_ptr, mode);
+
+	info_check_player();
+
+	for (i = 0; i < INFO_CACHE_MAX; i++)
+	{
+		c = &info_cache[i];
+
+		if (c->tb && (c->mode == mode) && (c->stamp == info_stamp) &&
+		    (c->worn_right == worn_right) && (c->aware == k_ptr->aware) &&
+		    (c->tried == k_ptr->tried) && (c->everseen == k_ptr->everseen) &&
+		    !memcmp(&c->obj, o_ptr, sizeof(object_type)))
+			break;
+	}
+
+	/* Make the description and keep it, in place of the oldest */
+	if (i == INFO_CACHE_MAX)
+	{
+		c = &info_cache[info_cache_next];
+		info_cache_next = (info_cache_next + 1) % INFO_CACHE_MAX;
+
+		if (!c->tb) c->tb = textblock_new();
+		textblock_clear(c->tb);
+		object_info_out_to(c->tb, o_ptr, mode);
+
+		object_copy(&c->obj, o_ptr);
+		c->mode = mode;
+		c->worn_right = worn_right;
+		c->aware = k_ptr->aware;
+		c->tried = k_ptr->tried;
+		c->everseen = k_ptr->everseen;
+		c->stamp = info_stamp;
+	}
+
+	/* Callers keep (and free) their own copy */
+	tb = textblock_new();
+	textblock_append_textblock(tb, c->tb);
+	return tb;
 }
 
 /**
@@ -1365,11 +1466,12 @@ textblock *object_info_ego(struct ego_item *ego)
 /**
  * Provide information on an item suitable for writing to the character dump - keep it brief.
  */
-void object_info_chardump(ang_file *f, const object_type *o_ptr, int indent, int wrap)
+void object_info_chardump(textblock *tb, textblock *scratch,
+		const object_type *o_ptr, int indent, int wrap)
 {
-	textblock *tb = object_info_out(o_ptr, OINFO_TERSE | OINFO_SUBJ);
-	textblock_to_file(tb, f, indent, wrap);
-	textblock_free(tb);
+	textblock_clear(scratch);
+	object_info_out_to(scratch, o_ptr, OINFO_TERSE | OINFO_SUBJ);
+	textblock_append_wrapped(tb, scratch, indent, wrap);
 }
 
 
@@ -21,11 +21,15 @@
 
 static bool kind_is_good(const object_kind *);
 
+/*
+ * For each level, the running total of the allocation probabilities of the
+ * object kinds up to and including each kind, and the grand total
+ */
 static u32b obj_total[MAX_DEPTH];
-static byte *obj_alloc;
+static u32b *obj_alloc;
 
 static u32b obj_total_great[MAX_DEPTH];
-static byte *obj_alloc_great;
+static u32b *obj_alloc_great;
 
 /* Don't worry about probabilities for anything past dlev100 */
 #define MAX_O_DEPTH		100
@@ -50,11 +54,11 @@ bool init_obj_alloc(void)
 
 
 	/* Free obj_allocs if allocated */
-	FREE(obj_alloc);
+	free_obj_alloc();
 
 	/* Allocate and wipe */
-	obj_alloc = C_ZNEW((MAX_O_DEPTH + 1) * k_max, byte);
-	obj_alloc_great = C_ZNEW((MAX_O_DEPTH + 1) * k_max, byte);
+	obj_alloc = C_ZNEW((MAX_O_DEPTH + 1) * k_max, u32b);
+	obj_alloc_great = C_ZNEW((MAX_O_DEPTH + 1) * k_max, u32b);
 
 	/* Wipe the totals */
 	C_WIPE(obj_total, MAX_O_DEPTH + 1, u32b);
@@ -69,23 +73,22 @@ bool init_obj_alloc(void)
 		int min = k_ptr->alloc_min;
 		int max = k_ptr->alloc_max;
 
-		/* If an item doesn't have a rarity, move on */
-		if (!k_ptr->alloc_prob) continue;
+		bool good = kind_is_good(k_ptr);
 
 		/* Go through all the dungeon levels */
 		for (lev = 0; lev <= MAX_O_DEPTH; lev++)
 		{
 			int rarity = k_ptr->alloc_prob;
 
-			/* Save the probability in the standard table */
+			/* Add the probability to the standard table */
 			if ((lev < min) || (lev > max)) rarity = 0;
 			obj_total[lev] += rarity;
-			obj_alloc[(lev * k_max) + item] = rarity;
+			obj_alloc[(lev * k_max) + item] = obj_total[lev];
 
-			/* Save the probability in the "great" table if relevant */
-			if (!kind_is_good(k_ptr)) rarity = 0;
+			/* Add the probability to the "great" table if relevant */
+			if (!good) rarity = 0;
 			obj_total_great[lev] += rarity;
-			obj_alloc_great[(lev * k_max) + item] = rarity;
+			obj_alloc_great[(lev * k_max) + item] = obj_total_great[lev];
 		}
 	}
 
@@ -97,11 +100,15 @@ bool init_obj_alloc(void)
 
 /*
  * Choose an object kind given a dungeon level to choose it for.
+ *
+ * The kind is found by a binary search for the first kind whose running
+ * total in the level's table is more than a random value below the total.
  */
 s16b get_obj_num(int level, bool good)
 {
-	/* This is the base index into obj_alloc for this dlev */
-	size_t ind, item;
+	/* The running totals for this dlev */
+	const u32b *table;
+	size_t lo, hi;
 	u32b value;
 
 	/* Occasional level boost */
@@ -116,36 +123,30 @@ s16b get_obj_num(int level, bool good)
 	level = MAX(level, 0);
 
 	/* Pick an object */
-	ind = level * z_info->k_max;
-
 	if (!good)
 	{
+		table = obj_alloc + level * z_info->k_max;
 		value = randint0(obj_total[level]);
-		for (item = 1; item < z_info->k_max; item++)
-		{
-			/* Found it */
-			if (value < obj_alloc[ind + item]) break;
-
-			/* Decrement */
-			value -= obj_alloc[ind + item];
-		}
 	}
 	else
 	{
+		table = obj_alloc_great + level * z_info->k_max;
 		value = randint0(obj_total_great[level]);
-		for (item = 1; item < z_info->k_max; item++)
-		{
-			/* Found it */
-			if (value < obj_alloc_great[ind + item]) break;
-
-			/* Decrement */
-			value -= obj_alloc_great[ind + item];
-		}
 	}
 
+	/* Find it */
+	lo = 1;
+	hi = z_info->k_max;
+	while (lo < hi)
+	{
+		size_t mid = (lo + hi) / 2;
+
+		if (table[mid] > value) hi = mid;
+		else lo = mid + 1;
+	}
 
 	/* Return the item index */
-	return item;
+	return lo;
 }
 
 
@@ -892,20 +893,30 @@ void object_prep(object_type *o_ptr, struct object_kind *k, int lev, aspect rand
 	/* Default number */
 	o_ptr->number = 1;
 
-	/* Default "pval" */
-	o_ptr->pval = randcalc(k->pval, lev, rand_aspect);
-
 	/* Default weight */
 	o_ptr->weight = k->weight;
-	
-	/* Assign charges (wands/staves only) */
-	if (o_ptr->tval == TV_WAND || o_ptr->tval == TV_STAFF)
-		o_ptr->pval = randcalc(k->charge, lev, rand_aspect);
 
-	/* Default magic */
-	o_ptr->to_h = randcalc(k->to_h, lev, rand_aspect);
-	o_ptr->to_d = randcalc(k->to_d, lev, rand_aspect);
-	o_ptr->to_a = randcalc(k->to_a, lev, rand_aspect);
+	/* Default "pval", charges (wands/staves only) and magic */
+	if (rand_aspect == RANDOMISE)
+	{
+		o_ptr->pval = randcalc_random(k->pval, lev);
+		if (o_ptr->tval == TV_WAND || o_ptr->tval == TV_STAFF)
+			o_ptr->pval = randcalc_random(k->charge, lev);
+
+		o_ptr->to_h = randcalc_random(k->to_h, lev);
+		o_ptr->to_d = randcalc_random(k->to_d, lev);
+		o_ptr->to_a = randcalc_random(k->to_a, lev);
+	}
+	else
+	{
+		o_ptr->pval = randcalc(k->pval, lev, rand_aspect);
+		if (o_ptr->tval == TV_WAND || o_ptr->tval == TV_STAFF)
+			o_ptr->pval = randcalc(k->charge, lev, rand_aspect);
+
+		o_ptr->to_h = randcalc(k->to_h, lev, rand_aspect);
+		o_ptr->to_d = randcalc(k->to_d, lev, rand_aspect);
+		o_ptr->to_a = randcalc(k->to_a, lev, rand_aspect);
+	}
 
 	/* Default power */
 	o_ptr->ac = k->ac;
@@ -1097,12 +1108,12 @@ void apply_magic(object_type *o_ptr, int lev, bool allow_artifacts, bool good, b
 		if (cursed_p(o_ptr))
 		{
 			/* Apply extra ego bonuses */
-			o_ptr->to_h -= randcalc(e_ptr->to_h, lev, RANDOMISE);
-			o_ptr->to_d -= randcalc(e_ptr->to_d, lev, RANDOMISE);
-			o_ptr->to_a -= randcalc(e_ptr->to_a, lev, RANDOMISE);
+			o_ptr->to_h -= randcalc_random(e_ptr->to_h, lev);
+			o_ptr->to_d -= randcalc_random(e_ptr->to_d, lev);
+			o_ptr->to_a -= randcalc_random(e_ptr->to_a, lev);
 
 			/* Apply ego pval */
-			o_ptr->pval -= randcalc(e_ptr->pval, lev, RANDOMISE);
+			o_ptr->pval -= randcalc_random(e_ptr->pval, lev);
 
 			/* Apply minimums */
 			if (o_ptr->to_h > -1 * e_ptr->min_to_h) o_ptr->to_h = -1 * e_ptr->min_to_h;
@@ -1115,12 +1126,12 @@ void apply_magic(object_type *o_ptr, int lev, bool allow_artifacts, bool good, b
 		else
 		{
 			/* Apply extra ego bonuses */
-			o_ptr->to_h += randcalc(e_ptr->to_h, lev, RANDOMISE);
-			o_ptr->to_d += randcalc(e_ptr->to_d, lev, RANDOMISE);
-			o_ptr->to_a += randcalc(e_ptr->to_a, lev, RANDOMISE);
+			o_ptr->to_h += randcalc_random(e_ptr->to_h, lev);
+			o_ptr->to_d += randcalc_random(e_ptr->to_d, lev);
+			o_ptr->to_a += randcalc_random(e_ptr->to_a, lev);
 
 			/* Apply ego pval */
-			o_ptr->pval += randcalc(e_ptr->pval, lev, RANDOMISE);
+			o_ptr->pval += randcalc_random(e_ptr->pval, lev);
 
 			/* Apply minimums */
 			if (o_ptr->to_h < e_ptr->min_to_h) o_ptr->to_h = e_ptr->min_to_h;
@@ -1183,7 +1194,7 @@ static bool kind_is_good(const object_kind *k_ptr)
 		case TV_HELM:
 		case TV_CROWN:
 		{
-			if (randcalc(k_ptr->to_a, 0, MINIMISE) < 0) return (FALSE);
+			if (randcalc_min(k_ptr->to_a) < 0) return (FALSE);
 			return (TRUE);
 		}
 
@@ -1194,8 +1205,8 @@ static bool kind_is_good(const object_kind *k_ptr)
 		case TV_POLEARM:
 		case TV_DIGGING:
 		{
-			if (randcalc(k_ptr->to_h, 0, MINIMISE) < 0) return (FALSE);
-			if (randcalc(k_ptr->to_d, 0, MINIMISE) < 0) return (FALSE);
+			if (randcalc_min(k_ptr->to_h) < 0) return (FALSE);
+			if (randcalc_min(k_ptr->to_d) < 0) return (FALSE);
 			return (TRUE);
 		}
 
@@ -1278,7 +1289,7 @@ bool make_object(object_type *j_ptr, int lev, bool good, bool great)
 	if (k_ptr->gen_mult_prob >= 100 ||
 	    k_ptr->gen_mult_prob >= randint1(100))
 	{
-		j_ptr->number = randcalc(k_ptr->stack_size, lev, RANDOMISE);
+		j_ptr->number = randcalc_random(k_ptr->stack_size, lev);
 	}
 
 
@@ -102,6 +102,20 @@ static s16b ability_power[25] =
 	12, 16, 20, 24, 30, 36, 42, 48, 56, 64,
 	74, 84, 96, 110};
 
+/*
+ * Slay combinations not in slay_cache (those not found on any ego item,
+ * mostly from random artifacts), kept as they are rated so that each is
+ * only rated once.  Grown as needed.
+ */
+static flag_cache *slay_extra;
+static size_t slay_extra_num;
+static size_t slay_extra_max;
+
+/*
+ * The combination rated last
+ */
+static flag_cache slay_last;
+
 /*
  * Calculate the rating for a given slay combination
  */
@@ -110,30 +124,61 @@ static s32b slay_power(const object_type *o_ptr, int verbose, ang_file* log_file
 {
 	bitflag s_index[OF_SIZE];
 	s32b sv = 0;
-	int i;
+	int i, j, n = 0;
+	int slot;
 	int mult;
 	const slay_t *s_ptr;
+	const slay_t *slays[OF_MAX];
+	size_t k;
 
 	/* Combine the slay bytes into an index value */
 	of_copy(s_index, flags);
 	flags_mask(s_index, OF_SIZE, OF_ALL_SLAY_MASK, FLAG_END);
 
+	/* Most often it's the combination that was just rated */
+	if (slay_last.value && of_is_equal(s_index, slay_last.flags))
+	{
+		LOG_PRINT("Slay cache hit\n");
+		return slay_last.value;
+	}
+
 	/* Look in the cache to see if we know this one yet */
-	for (i = 0; !of_is_empty(slay_cache[i].flags); i++)
+	for (slot = 0; !of_is_empty(slay_cache[slot].flags); slot++)
 	{
-		if (of_is_equal(s_index, slay_cache[i].flags))
+		if (of_is_equal(s_index, slay_cache[slot].flags))
 			break;
 	}
 
-	sv = slay_cache[i].value;
+	sv = slay_cache[slot].value;
+
+	/* Not an ego's combination, so try the others */
+	if (of_is_empty(slay_cache[slot].flags))
+	{
+		for (k = 0; k < slay_extra_num; k++)
+		{
+			if (of_is_equal(s_index, slay_extra[k].flags))
+			{
+				sv = slay_extra[k].value;
+				break;
+			}
+		}
+	}
 
 	/* If it's cached (or there are no slays), return the value */
 	if (sv)
 	{
 		LOG_PRINT("Slay cache hit\n");
+		of_copy(slay_last.flags, s_index);
+		slay_last.value = sv;
 		return sv;
 	}
 
+	/* The slays to look for, in ascending order as below */
+	for (s_ptr = slay_table; s_ptr->slay_flag; s_ptr++)
+	{
+		if (of_has(flags, s_ptr->slay_flag)) slays[n++] = s_ptr;
+	}
+
 	/*
 	 * Otherwise we need to calculate the expected average multiplier
 	 * for this combination (multiplied by the total number of
@@ -148,9 +193,9 @@ static s32b slay_power(const object_type *o_ptr, int verbose, ang_file* log_file
 		 * Do the following in ascending order so that the best
 		 * multiple is retained
 		 */
-		for (s_ptr = slay_table; s_ptr->slay_flag; s_ptr++)
+		for (j = 0; j < n; j++)
 		{
-			if (!of_has(flags, s_ptr->slay_flag)) continue;
+			s_ptr = slays[j];
 
 			if (rf_has(r_ptr->flags, s_ptr->monster_flag) ||
 			    (s_ptr->resist_flag && !rf_has(r_ptr->flags,
@@ -198,19 +243,43 @@ static s32b slay_power(const object_type *o_ptr, int verbose, ang_file* log_file
 	}
 
 	/* Add to the cache */
-	for (i = 0; !of_is_empty(slay_cache[i].flags); i++)
+	if (!of_is_empty(slay_cache[slot].flags))
 	{
-		if (of_is_equal(s_index, slay_cache[i].flags))
+		slay_cache[slot].value = sv;
+		LOG_PRINT("Added to slay cache\n");
+	}
+	else
+	{
+		if (slay_extra_num == slay_extra_max)
 		{
-			slay_cache[i].value = sv;
-			LOG_PRINT("Added to slay cache\n");
-			break;
+			slay_extra_max = slay_extra_max ? slay_extra_max * 2 : 16;
+			slay_extra = mem_realloc(slay_extra,
+			                         slay_extra_max * sizeof(*slay_extra));
 		}
+
+		of_copy(slay_extra[slay_extra_num].flags, s_index);
+		slay_extra[slay_extra_num].value = sv;
+		slay_extra_num++;
 	}
 
+	of_copy(slay_last.flags, s_index);
+	slay_last.value = sv;
+
 	return sv;
 }
 
+/*
+ * Free the slay ratings, both the ego combinations and the rest
+ */
+void free_slay_cache(void)
+{
+	FREE(slay_cache);
+	FREE(slay_extra);
+	slay_extra_num = 0;
+	slay_extra_max = 0;
+	slay_last.value = 0;
+}
+
 /*
  * Calculate the multiplier we'll get with a given bow type.
  * Note that this relies on the multiplier being the 2nd digit of the bow's
@@ -225,6 +294,101 @@ static int bow_multiplier(int sval)
 }
 
 
+/*
+ * Groups of flags which get extra power for having several of them
+ */
+enum
+{
+	FP_NONE = 0,
+	FP_SUSTAIN,
+	FP_IMMUNITY,
+	FP_MISC,
+	FP_LOWRES,
+	FP_HIGHRES,
+
+	FP_MAX
+};
+
+/*
+ * Fixed power for each flag whose worth doesn't depend on the rest of the
+ * object, and the group it counts towards.
+ */
+struct flag_power
+{
+	int flag;
+	int power;
+	int group;
+	const char *desc;
+};
+
+static const struct flag_power flag_power_table[] =
+{
+	{ OF_SUST_STR,       9, FP_SUSTAIN,  "sustain STR" },
+	{ OF_SUST_INT,       4, FP_SUSTAIN,  "sustain INT" },
+	{ OF_SUST_WIS,       4, FP_SUSTAIN,  "sustain WIS" },
+	{ OF_SUST_DEX,       7, FP_SUSTAIN,  "sustain DEX" },
+	{ OF_SUST_CON,       8, FP_SUSTAIN,  "sustain CON" },
+	{ OF_SUST_CHR,       1, FP_NONE,     "sustain CHR" },
+	{ OF_IM_ACID,       38, FP_IMMUNITY, "acid immunity" },
+	{ OF_IM_ELEC,       35, FP_IMMUNITY, "elec immunity" },
+	{ OF_IM_FIRE,       40, FP_IMMUNITY, "fire immunity" },
+	{ OF_IM_COLD,       37, FP_IMMUNITY, "cold immunity" },
+	{ OF_FREE_ACT,      14, FP_MISC,     "free action" },
+	{ OF_HOLD_LIFE,     12, FP_MISC,     "hold life" },
+	{ OF_FEATHER,        1, FP_NONE,     "feather fall" },
+	{ OF_LIGHT,          3, FP_MISC,     "permanent light" },
+	{ OF_SEE_INVIS,     10, FP_MISC,     "see invisible" },
+	{ OF_TELEPATHY,     70, FP_MISC,     "telepathy" },
+	{ OF_SLOW_DIGEST,    2, FP_MISC,     "slow digestion" },
+	{ OF_RES_ACID,       5, FP_LOWRES,   "resist acid" },
+	{ OF_RES_ELEC,       6, FP_LOWRES,   "resist elec" },
+	{ OF_RES_FIRE,       6, FP_LOWRES,   "resist fire" },
+	{ OF_RES_COLD,       6, FP_LOWRES,   "resist cold" },
+	{ OF_RES_POIS,      28, FP_HIGHRES,  "resist poison" },
+	{ OF_RES_FEAR,       6, FP_HIGHRES,  "resist fear" },
+	{ OF_RES_LIGHT,      6, FP_HIGHRES,  "resist light" },
+	{ OF_RES_DARK,      16, FP_HIGHRES,  "resist dark" },
+	{ OF_RES_BLIND,     16, FP_HIGHRES,  "resist blindness" },
+	{ OF_RES_CONFU,     24, FP_HIGHRES,  "resist confusion" },
+	{ OF_RES_SOUND,     14, FP_HIGHRES,  "resist sound" },
+	{ OF_RES_SHARD,      8, FP_HIGHRES,  "resist shards" },
+	{ OF_RES_NEXUS,     15, FP_HIGHRES,  "resist nexus" },
+	{ OF_RES_NETHR,     20, FP_HIGHRES,  "resist nether" },
+	{ OF_RES_CHAOS,     20, FP_HIGHRES,  "resist chaos" },
+	{ OF_RES_DISEN,     20, FP_HIGHRES,  "resist disenchantment" },
+	{ OF_REGEN,          9, FP_MISC,     "regeneration" },
+	{ OF_BLESSED,        1, FP_NONE,     "blessed" },
+	{ OF_NO_FUEL,        5, FP_NONE,     "no fuel" },
+
+	/* Note: the curses are irrelevant until they are reworked */
+	{ OF_TELEPORT,      -1, FP_NONE,     "teleportation" },
+	{ OF_DRAIN_EXP,     -1, FP_NONE,     "drain experience" },
+	{ OF_AGGRAVATE,     -1, FP_NONE,     "aggravation" },
+	{ OF_LIGHT_CURSE,   -1, FP_NONE,     "light curse" },
+	{ OF_HEAVY_CURSE,   -1, FP_NONE,     "heavy curse" },
+
+	/* Tiny amounts for ignore flags */
+	{ OF_IGNORE_ACID,    1, FP_NONE,     "ignore acid" },
+	{ OF_IGNORE_FIRE,    1, FP_NONE,     "ignore fire" },
+	{ OF_IGNORE_COLD,    1, FP_NONE,     "ignore cold" },
+	{ OF_IGNORE_ELEC,    1, FP_NONE,     "ignore elec" },
+};
+
+/*
+ * flag_power_table[] indexed by flag, so that object_power() only has to
+ * look at the flags an object actually has.
+ */
+static const struct flag_power *flag_power_of[OF_MAX];
+
+static void flag_power_init(void)
+{
+	size_t i;
+
+	for (i = 0; i < N_ELEMENTS(flag_power_table); i++)
+		flag_power_of[flag_power_table[i].flag] = &flag_power_table[i];
+}
+
+
 /*
  * Evaluate the object's overall power level.
  */
@@ -233,15 +397,18 @@ s32b object_power(const object_type* o_ptr, int verbose, ang_file *log_file,
 {
 	s32b p = 0;
 	object_kind *k_ptr;
-	int immunities = 0;
-	int misc = 0;
-	int lowres = 0;
-	int highres = 0;
-	int sustains = 0;
+	int counts[FP_MAX] = { 0 };
 	int extra_stat_bonus = 0;
 	int i;
 	bitflag flags[OF_SIZE];
 	const slay_t *s_ptr;
+	static bool flag_power_ready = FALSE;
+
+	if (!flag_power_ready)
+	{
+		flag_power_init();
+		flag_power_ready = TRUE;
+	}
 
 	/* Extract the flags */
 	if (known)
@@ -783,27 +950,27 @@ s32b object_power(const object_type* o_ptr, int verbose, ang_file *log_file,
 		}
 	}
 
-#define ADD_POWER1(string, val, flag) \
-	if (of_has(flags, flag)) { \
-		p += (val); \
-		LOG_PRINT1("Adding power for " string ", total is %d\n", p); \
-	}
+	/* Add the fixed amounts for each independent flag */
+	for (i = of_next(flags, FLAG_START); i != FLAG_END; i = of_next(flags, i + 1))
+	{
+		const struct flag_power *fp = flag_power_of[i];
 
-#define ADD_POWER2(string, val, flag, extra) \
-	if (of_has(flags, flag)) { \
-		p += (val); \
-		extra; \
-		LOG_PRINT1("Adding power for " string ", total is %d\n", p); \
-	}
+		if (!fp) continue;
 
-	ADD_POWER2("sustain STR",         9, OF_SUST_STR, sustains++);
-	ADD_POWER2("sustain INT",         4, OF_SUST_INT, sustains++);
-	ADD_POWER2("sustain WIS",         4, OF_SUST_WIS, sustains++);
-	ADD_POWER2("sustain DEX",         7, OF_SUST_DEX, sustains++);
-	ADD_POWER2("sustain CON",         8, OF_SUST_CON, sustains++);
-	ADD_POWER1("sustain CHR",         1, OF_SUST_CHR);
+		p += fp->power;
+		counts[fp->group]++;
 
-	for (i = 2; i <= sustains; i++)
+		if (fp->power < 0)
+		{
+			LOG_PRINT2("Subtracting power for %s, total is %d\n", fp->desc, p);
+		}
+		else
+		{
+			LOG_PRINT2("Adding power for %s, total is %d\n", fp->desc, p);
+		}
+	}
+
+	for (i = 2; i <= counts[FP_SUSTAIN]; i++)
 	{
 		p += i;
 		LOG_PRINT1("Adding power for multiple sustains, total is %d\n", p);
@@ -814,12 +981,7 @@ s32b object_power(const object_type* o_ptr, int verbose, ang_file *log_file,
 		}
 	}
 
-	ADD_POWER2("acid immunity",      38, OF_IM_ACID, immunities++);
-	ADD_POWER2("elec immunity",      35, OF_IM_ELEC, immunities++);
-	ADD_POWER2("fire immunity",      40, OF_IM_FIRE, immunities++);
-	ADD_POWER2("cold immunity",      37, OF_IM_COLD, immunities++);
-
-	for (i = 2; i <= immunities; i++)
+	for (i = 2; i <= counts[FP_IMMUNITY]; i++)
 	{
 		p += IMMUNITY_POWER;
 		LOG_PRINT1("Adding power for multiple immunities, total is %d\n", p);
@@ -830,40 +992,13 @@ s32b object_power(const object_type* o_ptr, int verbose, ang_file *log_file,
 		}
 	}
 
-	ADD_POWER2("free action",           14, OF_FREE_ACT,    misc++);
-	ADD_POWER2("hold life",             12, OF_HOLD_LIFE,   misc++);
-	ADD_POWER1("feather fall",           1, OF_FEATHER);
-	ADD_POWER2("permanent light",        3, OF_LIGHT,       misc++);
-	ADD_POWER2("see invisible",         10, OF_SEE_INVIS,   misc++);
-	ADD_POWER2("telepathy",             70, OF_TELEPATHY,   misc++);
-	ADD_POWER2("slow digestion",         2, OF_SLOW_DIGEST, misc++);
-	ADD_POWER2("resist acid",            5, OF_RES_ACID,    lowres++);
-	ADD_POWER2("resist elec",            6, OF_RES_ELEC,    lowres++);
-	ADD_POWER2("resist fire",            6, OF_RES_FIRE,    lowres++);
-	ADD_POWER2("resist cold",            6, OF_RES_COLD,    lowres++);
-	ADD_POWER2("resist poison",         28, OF_RES_POIS,    highres++);
-	ADD_POWER2("resist fear",            6, OF_RES_FEAR,    highres++);
-	ADD_POWER2("resist light",           6, OF_RES_LIGHT,   highres++);
-	ADD_POWER2("resist dark",           16, OF_RES_DARK,    highres++);
-	ADD_POWER2("resist blindness",      16, OF_RES_BLIND,   highres++);
-	ADD_POWER2("resist confusion",      24, OF_RES_CONFU,   highres++);
-	ADD_POWER2("resist sound",          14, OF_RES_SOUND,   highres++);
-	ADD_POWER2("resist shards",          8, OF_RES_SHARD,   highres++);
-	ADD_POWER2("resist nexus",          15, OF_RES_NEXUS,   highres++);
-	ADD_POWER2("resist nether",         20, OF_RES_NETHR,   highres++);
-	ADD_POWER2("resist chaos",          20, OF_RES_CHAOS,   highres++);
-	ADD_POWER2("resist disenchantment", 20, OF_RES_DISEN,   highres++);
-	ADD_POWER2("regeneration",           9, OF_REGEN,       misc++);
-	ADD_POWER1("blessed",                1, OF_BLESSED);
-	ADD_POWER1("no fuel",                5, OF_NO_FUEL);
-
-	for (i = 2; i <= misc; i++)
+	for (i = 2; i <= counts[FP_MISC]; i++)
 	{
 		p += i;
 		LOG_PRINT1("Adding power for multiple misc abilities, total is %d\n", p);
 	}
 
-	for (i = 2; i <= lowres; i++)
+	for (i = 2; i <= counts[FP_LOWRES]; i++)
 	{
 		p += i;
 		LOG_PRINT1("Adding power for multiple low resists, total is %d\n", p);
@@ -874,39 +1009,12 @@ s32b object_power(const object_type* o_ptr, int verbose, ang_file *log_file,
 		}
 	}
 
-	for (i = 2; i <= highres; i++)
+	for (i = 2; i <= counts[FP_HIGHRES]; i++)
 	{
 		p += (i * 2);
 		LOG_PRINT1("Adding power for multiple high resists, total is %d\n", p);
 	}
 
-	/* Note: the following code is irrelevant until curses are reworked */
-	if (of_has(flags, OF_TELEPORT))
-	{
-		p -= 1;
-		LOG_PRINT1("Subtracting power for teleportation, total is %d\n", p);
-	}
-	if (of_has(flags, OF_DRAIN_EXP))
-	{
-		p -= 1;
-		LOG_PRINT1("Subtracting power for drain experience, total is %d\n", p);
-	}
-	if (of_has(flags, OF_AGGRAVATE))
-	{
-		p -= 1;
-		LOG_PRINT1("Subtracting power for aggravation, total is %d\n", p);
-	}
-	if (of_has(flags, OF_LIGHT_CURSE))
-	{
-		p -= 1;
-		LOG_PRINT1("Subtracting power for light curse, total is %d\n", p);
-	}
-	if (of_has(flags, OF_HEAVY_CURSE))
-	{
-		p -= 1;
-		LOG_PRINT1("Subtracting power for heavy curse, total is %d\n", p);
-	}
-
 	/*	if (of_has(flags, OF_PERMA_CURSE)) p -= 40; */
 
 	/* add power for effect */
@@ -924,13 +1032,31 @@ s32b object_power(const object_type* o_ptr, int verbose, ang_file *log_file,
 		}
 	}
 
-	/* add tiny amounts for ignore flags */
-	if (of_has(flags, OF_IGNORE_ACID)) p++;
-	if (of_has(flags, OF_IGNORE_FIRE)) p++;
-	if (of_has(flags, OF_IGNORE_COLD)) p++;
-	if (of_has(flags, OF_IGNORE_ELEC)) p++;
-
-	LOG_PRINT1("After ignore flags, FINAL POWER IS %d\n", p);
+	LOG_PRINT1("FINAL POWER IS %d\n", p);
 
 	return (p);
 }
+
+
+/*
+ * Evaluate the power of "n" objects at once, putting the results in
+ * "powers".  Objects with no kind (k_idx of zero) are given a power of zero,
+ * so callers can leave holes in the array for things that failed to forge.
+ */
+void object_power_batch(const object_type *objs, size_t n, s32b *powers,
+	int verbose, ang_file *log_file, bool known)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+	{
+		if (!objs[i].k_idx)
+		{
+			powers[i] = 0;
+			continue;
+		}
+
+		LOG_PRINT1("Batch entry %d\n", (int)i);
+		powers[i] = object_power(&objs[i], verbose, log_file, known);
+	}
+}
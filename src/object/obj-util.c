@@ -24,6 +24,8 @@
 #include "generate.h"
 #include "history.h"
 #include "inventory.h"
+#include "level-cache.h"
+#include "name-index.h"
 #include "prefs.h"
 #include "spells.h"
 #include "squelch.h"
@@ -227,6 +229,9 @@ void flavor_init(void)
 		/* No flavor yields aware */
 		if (!k_ptr->flavor) k_ptr->aware = TRUE;
 	}
+
+	/* Descriptions made with the old flavors are no good now */
+	object_desc_forget();
 }
 
 
@@ -329,17 +334,23 @@ void reset_visuals(bool load_prefs)
  */
 void object_flags(const object_type *o_ptr, bitflag flags[OF_SIZE])
 {
+	static bitflag curse_mask[OF_SIZE];
 	object_kind *k_ptr;
 
 	k_ptr = o_ptr->kind;
 
-	of_wipe(flags);
-
 	if (!o_ptr->kind)
+	{
+		of_wipe(flags);
 		return;
+	}
+
+	/* The curse flags never change, so only list them once */
+	if (of_is_empty(curse_mask))
+		flags_init(curse_mask, OF_SIZE, OF_CURSE_MASK, FLAG_END);
 
 	/* Obtain kind flags */
-	of_union(flags, k_ptr->flags);
+	of_copy(flags, k_ptr->flags);
 
 	/* Obtain artifact flags */
 	if (o_ptr->name1)
@@ -358,7 +369,7 @@ void object_flags(const object_type *o_ptr, bitflag flags[OF_SIZE])
 	}
 
 	/* Remove curse flags (use only the object's curse flags) */
-	flags_clear(flags, OF_SIZE, OF_CURSE_MASK, FLAG_END);
+	of_diff(flags, curse_mask);
 
 	/* Obtain the object's flags */
 	of_union(flags, o_ptr->flags);
@@ -748,7 +759,7 @@ int scan_floor(int *items, int max_size, int y, int x, int mode)
 	if (!in_bounds(y, x)) return 0;
 
 	/* Scan all objects in the grid */
-	for (this_o_idx = cave_o_idx[y][x]; this_o_idx; this_o_idx = next_o_idx)
+	for (this_o_idx = cave->grid[y][x].o_idx; this_o_idx; this_o_idx = next_o_idx)
 	{
 		object_type *o_ptr;
 
@@ -781,6 +792,35 @@ int scan_floor(int *items, int max_size, int y, int x, int mode)
 
 
 
+/*
+ * Return the index of the first object after "o_idx" which is lying on the
+ * floor between (y1, x1) and (y2, x2) inclusive, or zero if there are no
+ * more.  Start with an "o_idx" of zero.
+ *
+ * This only looks at o_list[], so it is proportional to the number of
+ * objects on the level rather than to its size.
+ */
+s16b floor_object_next(s16b o_idx, int y1, int x1, int y2, int x2)
+{
+	for (o_idx++; o_idx < o_max; o_idx++)
+	{
+		object_type *o_ptr = &o_list[o_idx];
+
+		/* Skip dead and held objects */
+		if (!o_ptr->k_idx || o_ptr->held_m_idx) continue;
+
+		if ((o_ptr->iy < y1) || (o_ptr->iy > y2) ||
+				(o_ptr->ix < x1) || (o_ptr->ix > x2))
+			continue;
+
+		return o_idx;
+	}
+
+	return 0;
+}
+
+
+
 
 /*
  * Excise a dungeon object from any stacks
@@ -857,7 +897,7 @@ void excise_object_idx(int o_idx)
 		int x = j_ptr->ix;
 
 		/* Scan all objects in the grid */
-		for (this_o_idx = cave_o_idx[y][x]; this_o_idx; this_o_idx = next_o_idx)
+		for (this_o_idx = cave->grid[y][x].o_idx; this_o_idx; this_o_idx = next_o_idx)
 		{
 			object_type *o_ptr;
 
@@ -874,7 +914,7 @@ void excise_object_idx(int o_idx)
 				if (prev_o_idx == 0)
 				{
 					/* Remove from list */
-					cave_o_idx[y][x] = next_o_idx;
+					cave->grid[y][x].o_idx = next_o_idx;
 				}
 
 				/* Real previous */
@@ -903,6 +943,55 @@ void excise_object_idx(int o_idx)
 }
 
 
+/*
+ * Slots in o_list[] freed since the list last filled up, so that o_pop()
+ * doesn't have to search for one.  Entries are only hints: o_pop() checks
+ * that each is still free and below o_max before using it.
+ */
+static s16b *o_free;
+static int o_free_num;
+
+static void o_free_push(int o_idx)
+{
+	if (o_free_num < o_size) o_free[o_free_num++] = o_idx;
+}
+
+
+/*
+ * Resize o_list[], and o_free[] with it, to `size` slots, wiping any new ones
+ */
+static void o_list_resize(int size)
+{
+	o_list = mem_realloc(o_list, size * sizeof(object_type));
+	if (size > o_size) C_WIPE(o_list + o_size, size - o_size, object_type);
+
+	o_free = mem_realloc(o_free, size * sizeof(s16b));
+
+	o_size = size;
+}
+
+/*
+ * Make o_list[] at least `size` slots long, growing it OBJ_LIST_CHUNK slots
+ * at a time up to z_info->o_max.  Returns FALSE if it can't be that long.
+ *
+ * Indexes stay the same, but the list may move, so this is only called
+ * where nothing holds a pointer into it: between game turns, before the
+ * level generator places each object, and when loading.
+ */
+bool o_list_grow(int size)
+{
+	int want;
+
+	if (size <= o_size) return TRUE;
+
+	want = ((size + OBJ_LIST_CHUNK - 1) / OBJ_LIST_CHUNK) * OBJ_LIST_CHUNK;
+	want = MIN(want, z_info->o_max);
+	if (want > o_size) o_list_resize(want);
+
+	return (size <= o_size);
+}
+
+
 /*
  * Delete a dungeon object
  *
@@ -936,6 +1025,9 @@ void delete_object_idx(int o_idx)
 
 	/* Count objects */
 	o_cnt--;
+
+	/* Remember the hole */
+	o_free_push(o_idx);
 }
 
 
@@ -952,7 +1044,7 @@ void delete_object(int y, int x)
 
 
 	/* Scan all objects in the grid */
-	for (this_o_idx = cave_o_idx[y][x]; this_o_idx; this_o_idx = next_o_idx)
+	for (this_o_idx = cave->grid[y][x].o_idx; this_o_idx; this_o_idx = next_o_idx)
 	{
 		object_type *o_ptr;
 
@@ -967,10 +1059,13 @@ void delete_object(int y, int x)
 
 		/* Count objects */
 		o_cnt--;
+
+		/* Remember the hole */
+		o_free_push(this_o_idx);
 	}
 
 	/* Objects are gone */
-	cave_o_idx[y][x] = 0;
+	cave->grid[y][x].o_idx = 0;
 
 	/* Visual update */
 	light_spot(y, x);
@@ -1040,10 +1135,10 @@ static void compact_objects_aux(int i1, int i2)
 		x = o_ptr->ix;
 
 		/* Repair grid */
-		if (cave_o_idx[y][x] == i1)
+		if (cave->grid[y][x].o_idx == i1)
 		{
 			/* Repair */
-			cave_o_idx[y][x] = i2;
+			cave->grid[y][x].o_idx = i2;
 		}
 	}
 
@@ -1099,6 +1194,9 @@ void compact_objects(int size)
 			o_max--;
 		}
 
+		/* The list is packed now */
+		o_free_num = 0;
+
 		return;
 	}
 
@@ -1212,7 +1310,7 @@ static void mention_preserve(const object_type *o_ptr)
  *
  * Note -- we do NOT visually reflect these (irrelevant) changes
  *
- * Hack -- we clear the "cave_o_idx[y][x]" field for every grid,
+ * Hack -- we clear the "cave->grid[y][x].o_idx" field for every grid,
  * and the "m_ptr->next_o_idx" field for every monster, since
  * we know we are clearing every object.  Technically, we only
  * clear those fields for grids/monsters containing objects,
@@ -1231,8 +1329,9 @@ void wipe_o_list(void)
 		/* Skip dead objects */
 		if (!o_ptr->k_idx) continue;
 
-		/* Preserve artifacts or mark them as lost in the history */
-		if (a_ptr) {
+		/* Preserve artifacts or mark them as lost in the history,
+		   unless the level is kept with them still on it */
+		if (a_ptr && !level_kept) {
 			/* Preserve if dungeon creation failed, or preserve mode, and only artifacts not seen */
 			if ((!character_dungeon || !OPT(adult_no_preserve)) && !object_was_sensed(o_ptr))
 			{
@@ -1268,7 +1367,7 @@ void wipe_o_list(void)
 			int x = o_ptr->ix;
 
 			/* Hack -- see above */
-			cave_o_idx[y][x] = 0;
+			cave->grid[y][x].o_idx = 0;
 		}
 
 		/* Wipe the object */
@@ -1280,6 +1379,12 @@ void wipe_o_list(void)
 
 	/* Reset "o_cnt" */
 	o_cnt = 0;
+
+	/* No holes left */
+	o_free_num = 0;
+
+	/* The next level starts small again */
+	if (o_size > OBJ_LIST_CHUNK) o_list_resize(OBJ_LIST_CHUNK);
 }
 
 
@@ -1293,9 +1398,11 @@ s16b o_pop(void)
 {
 	int i;
 
+	/* Whatever goes here may be charging */
+	o_list_charging = TRUE;
 
 	/* Initial allocation */
-	if (o_max < z_info->o_max)
+	if (o_max < o_size)
 	{
 		/* Get next space */
 		i = o_max;
@@ -1311,6 +1418,22 @@ s16b o_pop(void)
 	}
 
 
+	/* Reuse a hole left by a deleted object */
+	while (o_free_num)
+	{
+		i = o_free[--o_free_num];
+
+		/* Compaction may have moved another object in, or cut it off */
+		if ((i >= o_max) || o_list[i].k_idx) continue;
+
+		/* Count objects */
+		o_cnt++;
+
+		/* Use this object */
+		return (i);
+	}
+
+
 	/* Recycle dead objects */
 	for (i = 1; i < o_max; i++)
 	{
@@ -1344,7 +1467,7 @@ s16b o_pop(void)
  */
 object_type *get_first_object(int y, int x)
 {
-	s16b o_idx = cave_o_idx[y][x];
+	s16b o_idx = cave->grid[y][x].o_idx;
 
 	if (o_idx) return (&o_list[o_idx]);
 
@@ -1719,6 +1842,26 @@ bool object_similar(const object_type *o_ptr, const object_type *j_ptr,
 }
 
 
+/*
+ * A hash of what object_similar() always requires to be the same (the
+ * kind and the flags), so that objects with different keys don't need
+ * comparing at all.  Objects which never stack have a key of 0.
+ */
+static u32b object_stack_key(const object_type *o_ptr)
+{
+	u32b key = o_ptr->k_idx;
+	size_t i;
+
+	if (!o_ptr->k_idx || o_ptr->name1 || (o_ptr->tval == TV_CHEST))
+		return 0;
+
+	for (i = 0; i < OF_SIZE; i++)
+		key = key * 31 + o_ptr->flags[i];
+
+	return key ? key : 1;
+}
+
+
 /*
  * Allow one item to "absorb" another, assuming they are similar.
  *
@@ -1753,6 +1896,7 @@ void object_absorb(object_type *o_ptr, const object_type *j_ptr)
 	if (o_ptr->tval == TV_ROD)
 	{
 		o_ptr->timeout += j_ptr->timeout;
+		if (j_ptr->timeout) o_list_charging = TRUE;
 	}
 
 	/* Hack -- if wands or staves are stacking, combine the charges */
@@ -1872,7 +2016,7 @@ static s16b floor_get_idx_oldest_squelched(int y, int x)
 
 	object_type *o_ptr = NULL;
 
-	for (this_o_idx = cave_o_idx[y][x]; this_o_idx; this_o_idx = o_ptr->next_o_idx)
+	for (this_o_idx = cave->grid[y][x].o_idx; this_o_idx; this_o_idx = o_ptr->next_o_idx)
 	{
 		o_ptr = &o_list[this_o_idx];
 
@@ -1896,9 +2040,11 @@ s16b floor_carry(int y, int x, object_type *j_ptr)
 
 	s16b this_o_idx, next_o_idx = 0;
 
+	u32b key = object_stack_key(j_ptr);
+
 
 	/* Scan objects in that grid for combination */
-	for (this_o_idx = cave_o_idx[y][x]; this_o_idx; this_o_idx = next_o_idx)
+	for (this_o_idx = cave->grid[y][x].o_idx; this_o_idx; this_o_idx = next_o_idx)
 	{
 		object_type *o_ptr = &o_list[this_o_idx];
 
@@ -1906,7 +2052,8 @@ s16b floor_carry(int y, int x, object_type *j_ptr)
 		next_o_idx = o_ptr->next_o_idx;
 
 		/* Check for combination */
-		if (object_similar(o_ptr, j_ptr, OSTACK_FLOOR))
+		if (key && (object_stack_key(o_ptr) == key) &&
+		    object_similar(o_ptr, j_ptr, OSTACK_FLOOR))
 		{
 			/* Combine the items */
 			object_absorb(o_ptr, j_ptr);
@@ -1957,10 +2104,10 @@ s16b floor_carry(int y, int x, object_type *j_ptr)
 		o_ptr->held_m_idx = 0;
 
 		/* Link the object to the pile */
-		o_ptr->next_o_idx = cave_o_idx[y][x];
+		o_ptr->next_o_idx = cave->grid[y][x].o_idx;
 
 		/* Link the floor to the object */
-		cave_o_idx[y][x] = o_idx;
+		cave->grid[y][x].o_idx = o_idx;
 
 		/* Notice */
 		note_spot(y, x);
@@ -2061,7 +2208,7 @@ void drop_near(object_type *j_ptr, int chance, int y, int x, bool verbose)
 			if (!los(y, x, ty, tx)) continue;
 
 			/* Require floor space */
-			if (cave_feat[ty][tx] != FEAT_FLOOR) continue;
+			if (cave->grid[ty][tx].feat != FEAT_FLOOR) continue;
 
 			/* No objects */
 			k = 0;
@@ -2149,7 +2296,7 @@ void drop_near(object_type *j_ptr, int chance, int y, int x, bool verbose)
 		}
 
 		/* Require floor space */
-		if (cave_feat[ty][tx] != FEAT_FLOOR) continue;
+		if (cave->grid[ty][tx].feat != FEAT_FLOOR) continue;
 
 		/* Bounce to that location */
 		by = ty;
@@ -2185,7 +2332,7 @@ void drop_near(object_type *j_ptr, int chance, int y, int x, bool verbose)
 	sound(MSG_DROP);
 
 	/* Message when an object falls under the player */
-	if (verbose && (cave_m_idx[by][bx] < 0) && !squelch_item_ok(j_ptr))
+	if (verbose && (cave->grid[by][bx].m_idx < 0) && !squelch_item_ok(j_ptr))
 	{
 		msg_print("You feel something roll beneath your feet.");
 	}
@@ -2660,6 +2807,65 @@ bool inven_stack_okay(const object_type *o_ptr)
 }
 
 
+/*
+ * Everything that decides where an object goes in the pack, gathered once
+ * so that sorting needn't keep looking at the object
+ */
+struct pack_order
+{
+	bool book;	/* A book the player can read */
+	byte tval;
+	bool aware;
+	byte sval;
+	bool known;
+	s16b fuel;	/* Lights only */
+	s32b value;
+};
+
+static void pack_order_get(const object_type *o_ptr, struct pack_order *k)
+{
+	k->book = (o_ptr->tval == cp_ptr->spell_book);
+	k->tval = o_ptr->tval;
+	k->aware = object_flavor_is_aware(o_ptr);
+	k->sval = o_ptr->sval;
+	k->known = object_is_known(o_ptr);
+	k->fuel = (o_ptr->tval == TV_LIGHT) ? o_ptr->pval : 0;
+	k->value = k_info[o_ptr->k_idx].cost;
+}
+
+/*
+ * Return < 0 if an object with pack order `o` goes before one with `j`,
+ * > 0 if it goes after, or 0 if either will do
+ */
+static int pack_order_cmp(const struct pack_order *o, const struct pack_order *j)
+{
+	/* Hack -- readable books always come first */
+	if (o->book != j->book) return (o->book ? -1 : 1);
+
+	/* Objects sort by decreasing type */
+	if (o->tval != j->tval) return (o->tval > j->tval ? -1 : 1);
+
+	/* Non-aware (flavored) items always come last */
+	if (o->aware != j->aware) return (o->aware ? -1 : 1);
+	if (!o->aware) return 0;
+
+	/* Objects sort by increasing sval */
+	if (o->sval != j->sval) return (o->sval < j->sval ? -1 : 1);
+
+	/* Unidentified objects always come last */
+	if (o->known != j->known) return (o->known ? -1 : 1);
+	if (!o->known) return 0;
+
+	/* Lights sort by decreasing fuel */
+	if (o->fuel != j->fuel) return (o->fuel > j->fuel ? -1 : 1);
+
+	/* Objects sort by decreasing value */
+	if (o->value != j->value) return (o->value > j->value ? -1 : 1);
+
+	return 0;
+}
+
+
 /*
  * Add an item to the players inventory, and return the slot used.
  *
@@ -2684,10 +2890,13 @@ extern s16b inven_carry(struct player *p, struct object *o)
 
 	object_type *j_ptr;
 
+	u32b key;
+
 	/* Apply an autoinscription */
 	apply_autoinscription(o);
 
 	/* Check for combining */
+	key = object_stack_key(o);
 	for (j = 0; j < INVEN_PACK; j++)
 	{
 		j_ptr = &p->inventory[j];
@@ -2699,7 +2908,8 @@ extern s16b inven_carry(struct player *p, struct object *o)
 		n = j;
 
 		/* Check if the two items can be combined */
-		if (object_similar(j_ptr, o, OSTACK_PACK))
+		if (key && (object_stack_key(j_ptr) == key) &&
+		    object_similar(j_ptr, o, OSTACK_PACK))
 		{
 			/* Combine the items */
 			object_absorb(j_ptr, o);
@@ -2741,12 +2951,11 @@ extern s16b inven_carry(struct player *p, struct object *o)
 	/* Reorder the pack */
 	if (i < INVEN_MAX_PACK)
 	{
-		s32b o_value, j_value;
+		struct pack_order o_order, j_order;
 
-		/* Get the "value" of the item */
-		o_value = o->kind->cost;
+		pack_order_get(o, &o_order);
 
-		/* Scan every occupied slot */
+		/* Go before the first occupied slot it sorts ahead of */
 		for (j = 0; j < INVEN_MAX_PACK; j++)
 		{
 			j_ptr = &p->inventory[j];
@@ -2754,41 +2963,8 @@ extern s16b inven_carry(struct player *p, struct object *o)
 			/* Use empty slots */
 			if (!j_ptr->k_idx) break;
 
-			/* Hack -- readable books always come first */
-			if ((o->tval == cp_ptr->spell_book) &&
-			    (j_ptr->tval != cp_ptr->spell_book)) break;
-			if ((j_ptr->tval == cp_ptr->spell_book) &&
-			    (o->tval != cp_ptr->spell_book)) continue;
-
-			/* Objects sort by decreasing type */
-			if (o->tval > j_ptr->tval) break;
-			if (o->tval < j_ptr->tval) continue;
-
-			/* Non-aware (flavored) items always come last */
-			if (!object_flavor_is_aware(o)) continue;
-			if (!object_flavor_is_aware(j_ptr)) break;
-
-			/* Objects sort by increasing sval */
-			if (o->sval < j_ptr->sval) break;
-			if (o->sval > j_ptr->sval) continue;
-
-			/* Unidentified objects always come last */
-			if (!object_is_known(o)) continue;
-			if (!object_is_known(j_ptr)) break;
-
-			/* Lights sort by decreasing fuel */
-			if (o->tval == TV_LIGHT)
-			{
-				if (o->pval > j_ptr->pval) break;
-				if (o->pval < j_ptr->pval) continue;
-			}
-
-			/* Determine the "value" of the pack item */
-			j_value = j_ptr->kind->cost;
-
-			/* Objects sort by decreasing value */
-			if (o_value > j_value) break;
-			if (o_value < j_value) continue;
+			pack_order_get(j_ptr, &j_order);
+			if (pack_order_cmp(&o_order, &j_order) < 0) break;
 		}
 
 		/* Use that slot */
@@ -3012,6 +3188,12 @@ void combine_pack(void)
 
 	bool flag = FALSE;
 
+	u32b keys[INVEN_PACK + 1];
+
+
+	/* Find each item's stacking key */
+	for (i = 0; i <= INVEN_PACK; i++)
+		keys[i] = object_stack_key(&p_ptr->inventory[i]);
 
 	/* Combine the pack (backwards) */
 	for (i = INVEN_PACK; i > 0; i--)
@@ -3038,8 +3220,9 @@ void combine_pack(void)
 			/* Get the item */
 			j_ptr = &p_ptr->inventory[j];
 
-			/* Skip empty items */
+			/* Skip empty items, and those which can't stack with it */
 			if (!j_ptr->k_idx) continue;
+			if (!keys[i] || (keys[j] != keys[i])) continue;
 
 			/* Can we drop "o_ptr" onto "j_ptr"? */
 			if (object_similar(j_ptr, o_ptr, OSTACK_PACK))
@@ -3066,10 +3249,12 @@ void combine_pack(void)
 			{
 				/* Hack -- slide object */
 				COPY(&p_ptr->inventory[k], &p_ptr->inventory[k+1], object_type);
+				keys[k] = keys[k+1];
 			}
 
 			/* Hack -- wipe hole */
 			object_wipe(&p_ptr->inventory[k]);
+			keys[k] = 0;
 
 			/* Redraw stuff */
 			p_ptr->redraw |= (PR_INVEN);
@@ -3094,99 +3279,43 @@ void combine_pack(void)
  */
 void reorder_pack(void)
 {
-	int i, j, k;
+	int i, j, n;
 
-	s32b o_value;
-	s32b j_value;
+	struct pack_order order[INVEN_PACK];
+	int slot[INVEN_PACK];
 
-	object_type *o_ptr;
-	object_type *j_ptr;
-
-	object_type *i_ptr;
-	object_type object_type_body;
+	object_type old_pack[INVEN_PACK];
 
 	bool flag = FALSE;
 
 
-	/* Re-order the pack (forwards) */
-	for (i = 0; i < INVEN_PACK; i++)
+	/* Work out where everything goes, once */
+	for (n = 0; n < INVEN_PACK; n++)
 	{
-		/* Get the item */
-		o_ptr = &p_ptr->inventory[i];
-
-		/* Skip empty slots */
-		if (!o_ptr->k_idx) continue;
-
-		/* Get the "value" of the item */
-		o_value = k_info[o_ptr->k_idx].cost;
-
-		/* Scan every occupied slot */
-		for (j = 0; j < INVEN_PACK; j++)
-		{
-			/* Get the item already there */
-			j_ptr = &p_ptr->inventory[j];
-
-			/* Use empty slots */
-			if (!j_ptr->k_idx) break;
-
-			/* Hack -- readable books always come first */
-			if ((o_ptr->tval == cp_ptr->spell_book) &&
-			    (j_ptr->tval != cp_ptr->spell_book)) break;
-			if ((j_ptr->tval == cp_ptr->spell_book) &&
-			    (o_ptr->tval != cp_ptr->spell_book)) continue;
-
-			/* Objects sort by decreasing type */
-			if (o_ptr->tval > j_ptr->tval) break;
-			if (o_ptr->tval < j_ptr->tval) continue;
-
-			/* Non-aware (flavored) items always come last */
-			if (!object_flavor_is_aware(o_ptr)) continue;
-			if (!object_flavor_is_aware(j_ptr)) break;
-
-			/* Objects sort by increasing sval */
-			if (o_ptr->sval < j_ptr->sval) break;
-			if (o_ptr->sval > j_ptr->sval) continue;
-
-			/* Unidentified objects always come last */
-			if (!object_is_known(o_ptr)) continue;
-			if (!object_is_known(j_ptr)) break;
-
-			/* Lights sort by decreasing fuel */
-			if (o_ptr->tval == TV_LIGHT)
-			{
-				if (o_ptr->pval > j_ptr->pval) break;
-				if (o_ptr->pval < j_ptr->pval) continue;
-			}
-
-			/* Determine the "value" of the pack item */
-			j_value = k_info[j_ptr->k_idx].cost;
-
-			/* Objects sort by decreasing value */
-			if (o_value > j_value) break;
-			if (o_value < j_value) continue;
-		}
-
-		/* Never move down */
-		if (j >= i) continue;
+		/* The pack ends at the first empty slot */
+		if (!p_ptr->inventory[n].k_idx) break;
 
-		/* Take note */
-		flag = TRUE;
+		pack_order_get(&p_ptr->inventory[n], &order[n]);
+	}
 
-		/* Get local object */
-		i_ptr = &object_type_body;
+	/* Sort the slots, keeping items which sort the same in order */
+	for (i = 0; i < n; i++)
+	{
+		for (j = i; (j > 0) &&
+		     (pack_order_cmp(&order[i], &order[slot[j - 1]]) < 0); j--)
+			slot[j] = slot[j - 1];
 
-		/* Save a copy of the moving item */
-		object_copy(i_ptr, &p_ptr->inventory[i]);
+		slot[j] = i;
+		if (j != i) flag = TRUE;
+	}
 
-		/* Slide the objects */
-		for (k = i; k > j; k--)
-		{
-			/* Slide the item */
-			object_copy(&p_ptr->inventory[k], &p_ptr->inventory[k-1]);
-		}
+	/* Move the items */
+	if (flag)
+	{
+		C_COPY(old_pack, p_ptr->inventory, n, object_type);
 
-		/* Insert the moving item */
-		object_copy(&p_ptr->inventory[j], i_ptr);
+		for (i = 0; i < n; i++)
+			object_copy(&p_ptr->inventory[i], &old_pack[slot[i]]);
 
 		/* Redraw stuff */
 		p_ptr->redraw |= (PR_INVEN);
@@ -3362,6 +3491,33 @@ bool recharge_timeout(object_type *o_ptr)
 		return FALSE;
 }
 
+/*
+ * Recharge rods on the floor and carried by monsters.  Once a pass finds
+ * no rod still charging, o_list_charging is cleared and the list isn't
+ * scanned again until something that could bring a charging rod into it
+ * (o_pop(), object_absorb(), zapping a rod where it lies) sets it.
+ */
+void recharge_floor_rods(void)
+{
+	int i;
+	bool charging = FALSE;
+
+	if (!o_list_charging) return;
+
+	for (i = 1; i < o_max; i++)
+	{
+		object_type *o_ptr = &o_list[i];
+
+		/* Skip dead objects and non-rods */
+		if (!o_ptr->k_idx || (o_ptr->tval != TV_ROD)) continue;
+
+		recharge_timeout(o_ptr);
+		if (o_ptr->timeout) charging = TRUE;
+	}
+
+	o_list_charging = charging;
+}
+
 /*
  * Looks if "inscrip" is present on the given object.
  */
@@ -3389,20 +3545,69 @@ unsigned check_for_inscrip(const object_type *o_ptr, const char *inscrip)
 
 /*** Object kind lookup functions ***/
 
+/*
+ * Open hash of k_info indexes by tval and sval, built on first use and
+ * again whenever k_info is replaced
+ */
+static s16b *kind_hash;
+static size_t kind_hash_size;
+static const object_kind *kind_hash_of;
+static int kind_hash_max;
+
+#define KIND_HASH(tval, sval)	((((tval) << 8) | (sval)) * 2654435761U)
+
+static void kind_hash_build(void)
+{
+	int k;
+
+	FREE(kind_hash);
+
+	for (kind_hash_size = 16; kind_hash_size < 2 * (size_t)z_info->k_max; )
+		kind_hash_size *= 2;
+	kind_hash = C_ZNEW(kind_hash_size, s16b);
+
+	/* The first kind with each tval and sval wins, as in a search */
+	for (k = 1; k < z_info->k_max; k++)
+	{
+		const object_kind *k_ptr = &k_info[k];
+		size_t h = KIND_HASH(k_ptr->tval, k_ptr->sval) & (kind_hash_size - 1);
+
+		while (kind_hash[h])
+		{
+			const object_kind *j_ptr = &k_info[kind_hash[h]];
+
+			if ((j_ptr->tval == k_ptr->tval) && (j_ptr->sval == k_ptr->sval))
+				break;
+
+			h = (h + 1) & (kind_hash_size - 1);
+		}
+
+		if (!kind_hash[h]) kind_hash[h] = k;
+	}
+
+	kind_hash_of = k_info;
+	kind_hash_max = z_info->k_max;
+}
+
 /**
  * Return the k_idx of the object kind with the given `tval` and `sval`, or 0.
  */
 int lookup_kind(int tval, int sval)
 {
-	int k;
+	size_t h;
+
+	if ((kind_hash_of != k_info) || (kind_hash_max != z_info->k_max))
+		kind_hash_build();
 
 	/* Look for it */
-	for (k = 1; k < z_info->k_max; k++)
+	h = KIND_HASH(tval, sval) & (kind_hash_size - 1);
+	for (; kind_hash[h]; h = (h + 1) & (kind_hash_size - 1))
 	{
-		object_kind *k_ptr = &k_info[k];
+		object_kind *k_ptr = &k_info[kind_hash[h]];
 
 		/* Found a match */
-		if ((k_ptr->tval == tval) && (k_ptr->sval == sval)) return (k);
+		if ((k_ptr->tval == tval) && (k_ptr->sval == sval))
+			return (kind_hash[h]);
 	}
 
 	/* Failure */
@@ -3484,83 +3689,117 @@ static const grouper tval_names[] =
 	{ TV_GOLD,        "gold" },
 };
 
-/**
- * Return the k_idx of the object kind with the given `tval` and name `name`.
+/*
+ * Object kinds and artifacts by name.  Kinds are told apart by tval as well
+ * as name, and are named without any leading "& ".
  */
-int lookup_name(int tval, const char *name)
+static struct name_index kind_names;
+static struct name_index artifact_names;
+
+static const char *kind_name(int k)
 {
-	int k;
+	const char *nm = k_info[k].name;
 
-	/* Look for it */
-	for (k = 1; k < z_info->k_max; k++)
-	{
-		object_kind *k_ptr = &k_info[k];
-		const char *nm = k_ptr->name;
+	if (nm && *nm == '&' && *(nm+1))
+		nm += 2;
 
-		if (!nm) continue;
+	return nm;
+}
 
-		if (*nm == '&' && *(nm+1))
-			nm += 2;
+static bool kind_has_tval(int k, int tval)
+{
+	return (k_info[k].tval == tval);
+}
 
-		/* Found a match */
-		if (k_ptr->tval == tval && !strcmp(name, nm))
-			return k;
-	}
+static const char *artifact_name(int a_idx)
+{
+	return a_info[a_idx].name;
+}
+
+/*
+ * The k_idx of the kind with tval `tval` and name `name`, or 0
+ */
+static int lookup_kind_name(int tval, const char *name)
+{
+	if (name_index_stale(&kind_names, k_info, z_info->k_max))
+		name_index_build(&kind_names, k_info, z_info->k_max, kind_name);
+
+	return name_index_find(&kind_names, name, kind_has_tval, tval);
+}
+
+/*
+ * Build the kind lookups for a new k_info straight away.  The edit files
+ * which name kinds are read by several threads at once, and they mustn't
+ * all try to build them on first use.
+ */
+void kind_index_build(void)
+{
+	kind_hash_build();
+	name_index_build(&kind_names, k_info, z_info->k_max, kind_name);
+}
+
+/**
+ * Return the k_idx of the object kind with the given `tval` and name `name`.
+ */
+int lookup_name(int tval, const char *name)
+{
+	int k = lookup_kind_name(tval, name);
+
+	if (k) return k;
 
 	msg_format("No object (\"%s\",\"%s\")", tval_find_name(tval), name);
 	return -1;
 }
 
+static void artifact_names_build(void)
+{
+	if (name_index_stale(&artifact_names, a_info, z_info->a_max))
+		name_index_build(&artifact_names, a_info, z_info->a_max,
+				artifact_name);
+}
+
 /**
  * Return the a_idx of the artifact with the given name
  */
 int lookup_artifact_name(const char *name)
 {
-	int i;
-	
-	/* Look for it */
-	for (i = 1; i < z_info->a_max; i++)
-	{
-		artifact_type *a_ptr = &a_info[i];
-		
-		/* Found a match */
-		if (a_ptr->name && streq(name, a_ptr->name))
-			return i;
-		
-	} 
-	
-	return -1;
+	int a_idx;
+
+	artifact_names_build();
+	a_idx = name_index_find(&artifact_names, name, NULL, 0);
+
+	return a_idx ? a_idx : -1;
 }
 
+/**
+ * Return the a_idx of the artifact whose name starts with `prefix`,
+ * ignoring case, first in order of name, or -1 if none does; `matches` is
+ * set to how many do.
+ */
+int lookup_artifact_prefix(const char *prefix, int *matches)
+{
+	int a_idx;
+
+	artifact_names_build();
+	a_idx = name_index_prefix(&artifact_names, prefix, matches);
+
+	return a_idx ? a_idx : -1;
+}
 
 /**
  * Return the numeric sval of the object kind with the given `tval` and name `name`.
  */
 int lookup_sval(int tval, const char *name)
 {
-	int k;
 	unsigned int r;
+	int k;
 
 	if (sscanf(name, "%u", &r) == 1)
 		return r;
 
-	/* Look for it */
-	for (k = 1; k < z_info->k_max; k++)
-	{
-		object_kind *k_ptr = &k_info[k];
-		const char *nm = k_ptr->name;
-
-		if (!nm) continue;
+	k = lookup_kind_name(tval, name);
 
-		if (*nm == '&' && *(nm+1))
-			nm += 2;
-
-		/* Found a match */
-		if (k_ptr->tval == tval && !strcmp(name, nm))
-			return k_ptr->sval;
-	}
-
-	return -1;
+	return k ? k_info[k].sval : -1;
 }
 
 /**
@@ -3697,6 +3936,7 @@ void display_itemlist(void)
 {
 	int max;
 	int mx, my;
+	int g;
 	unsigned num;
 	int line = 1, x = 0;
 	int cur_x;
@@ -3710,13 +3950,11 @@ void display_itemlist(void)
 	int dx[MAX_ITEMLIST], dy[MAX_ITEMLIST];
 	unsigned counter = 0;
 
-	int dungeon_hgt = p_ptr->depth == 0 ? TOWN_HGT : DUNGEON_HGT;
-	int dungeon_wid = p_ptr->depth == 0 ? TOWN_WID : DUNGEON_WID;
-
 	byte attr;
 	char buf[80];
 
 	int floor_list[MAX_FLOOR_STACK];
+	planeword piles[CAVE_PLANE_SIZE];
 
 	/* Clear the term if in a subwindow, set x otherwise */
 	if (Term != angband_term[0])
@@ -3730,70 +3968,83 @@ void display_itemlist(void)
 		max = Term->hgt - 2;
 	}
 
-	/* Look at each square of the dungeon for items */
-	for (my = 0; my < dungeon_hgt; my++)
+	/* Find the grids holding items the player knows about */
+	plane_wipe(piles, CAVE_PLANE_SIZE);
+	for (g = floor_object_next(0, 0, 0, cave->height - 1, cave->width - 1); g;
+	     g = floor_object_next(g, 0, 0, cave->height - 1, cave->width - 1))
 	{
-		for (mx = 0; mx < dungeon_wid; mx++)
-		{
-			num = scan_floor(floor_list, MAX_FLOOR_STACK, my, mx, 0x02);
+		object_type *o_ptr = &o_list[g];
 
-			/* Iterate over all the items found on this square */
-			for (i = 0; i < num; i++)
-			{
-				object_type *o_ptr = &o_list[floor_list[i]];
-				unsigned j;
+		if (!o_ptr->marked) continue;
 
-				/* Skip gold/squelched */
-				if (o_ptr->tval == TV_GOLD || squelch_hide_item(o_ptr))
-					continue;
+		plane_on(piles, GRID(o_ptr->iy, o_ptr->ix));
+	}
+
+	/* Look at each of those grids, in the same order as the map */
+	for (g = plane_next(piles, CAVE_PLANE_SIZE, 0); g >= 0;
+	     g = plane_next(piles, CAVE_PLANE_SIZE, g + 1))
+	{
+		my = GRID_Y(g);
+		mx = GRID_X(g);
+
+		num = scan_floor(floor_list, MAX_FLOOR_STACK, my, mx, 0x02);
+
+		/* Iterate over all the items found on this square */
+		for (i = 0; i < num; i++)
+		{
+			object_type *o_ptr = &o_list[floor_list[i]];
+			unsigned j;
+
+			/* Skip gold/squelched */
+			if (o_ptr->tval == TV_GOLD || squelch_hide_item(o_ptr))
+				continue;
 
-				/* See if we've already seen a similar item; if so, just add */
-				/* to its count */
-				for (j = 0; j < counter; j++)
+			/* See if we've already seen a similar item; if so, just add */
+			/* to its count */
+			for (j = 0; j < counter; j++)
+			{
+				if (object_similar(o_ptr, types[j],
+					OSTACK_LIST))
 				{
-					if (object_similar(o_ptr, types[j],
-						OSTACK_LIST))
+					counts[j] += o_ptr->number;
+					if ((my - p_ptr->py) * (my - p_ptr->py) + (mx - p_ptr->px) * (mx - p_ptr->px) < dy[j] * dy[j] + dx[j] * dx[j])
 					{
-						counts[j] += o_ptr->number;
-						if ((my - p_ptr->py) * (my - p_ptr->py) + (mx - p_ptr->px) * (mx - p_ptr->px) < dy[j] * dy[j] + dx[j] * dx[j])
-						{
-							dy[j] = my - p_ptr->py;
-							dx[j] = mx - p_ptr->px;
-						}
-						break;
+						dy[j] = my - p_ptr->py;
+						dx[j] = mx - p_ptr->px;
 					}
+					break;
 				}
+			}
 
-				/* We saw a new item. So insert it at the end of the list and */
-				/* then sort it forward using compare_items(). The types list */
-				/* is always kept sorted. */
-				if (j == counter)
-				{
-					types[counter] = o_ptr;
-					counts[counter] = o_ptr->number;
-					dy[counter] = my - p_ptr->py;
-					dx[counter] = mx - p_ptr->px;
+			/* We saw a new item. So insert it at the end of the list and */
+			/* then sort it forward using compare_items(). The types list */
+			/* is always kept sorted. */
+			if (j == counter)
+			{
+				types[counter] = o_ptr;
+				counts[counter] = o_ptr->number;
+				dy[counter] = my - p_ptr->py;
+				dx[counter] = mx - p_ptr->px;
 
-					while (j > 0 && compare_items(types[j - 1], types[j]) > 0)
-					{
-						object_type *tmp_o = types[j - 1];
-						int tmpcount;
-						int tmpdx = dx[j-1];
-						int tmpdy = dy[j-1];
-
-						types[j - 1] = types[j];
-						types[j] = tmp_o;
-						dx[j-1] = dx[j];
-						dx[j] = tmpdx;
-						dy[j-1] = dy[j];
-						dy[j] = tmpdy;
-						tmpcount = counts[j - 1];
-						counts[j - 1] = counts[j];
-						counts[j] = tmpcount;
-						j--;
-					}
-					counter++;
+				while (j > 0 && compare_items(types[j - 1], types[j]) > 0)
+				{
+					object_type *tmp_o = types[j - 1];
+					int tmpcount;
+					int tmpdx = dx[j-1];
+					int tmpdy = dy[j-1];
+
+					types[j - 1] = types[j];
+					types[j] = tmp_o;
+					dx[j-1] = dx[j];
+					dx[j] = tmpdx;
+					dy[j-1] = dy[j];
+					dy[j] = tmpdy;
+					tmpcount = counts[j - 1];
+					counts[j - 1] = counts[j];
+					counts[j] = tmpcount;
+					j--;
 				}
+				counter++;
 			}
 		}
 	}
@@ -146,6 +146,7 @@ void object_know_all_flags(object_type *o_ptr);
 /* obj-desc.c */
 void object_kind_name(char *buf, size_t max, int k_idx, bool easy_know);
 size_t object_desc(char *buf, size_t max, const object_type *o_ptr, odesc_detail_t mode);
+void object_desc_forget(void);
 
 /* obj-info.c */
 extern const slay_t slay_table[];
@@ -154,7 +155,8 @@ size_t num_slays(void);
 textblock *object_info(const object_type *o_ptr, oinfo_detail_t mode);
 textblock *object_info_ego(struct ego_item *ego);
 void object_info_spoil(ang_file *f, const object_type *o_ptr, int wrap);
-void object_info_chardump(ang_file *f, const object_type *o_ptr, int indent, int wrap);
+void object_info_chardump(textblock *tb, textblock *scratch,
+		const object_type *o_ptr, int indent, int wrap);
 
 /* obj-make.c */
 void free_obj_alloc(void);
@@ -193,11 +195,13 @@ const char *mention_use(int slot);
 cptr describe_use(int i);
 bool item_tester_okay(const object_type *o_ptr);
 int scan_floor(int *items, int max_size, int y, int x, int mode);
+s16b floor_object_next(s16b o_idx, int y1, int x1, int y2, int x2);
 void excise_object_idx(int o_idx);
 void delete_object_idx(int o_idx);
 void delete_object(int y, int x);
 void compact_objects(int size);
 void wipe_o_list(void);
+bool o_list_grow(int size);
 s16b o_pop(void);
 object_type *get_first_object(int y, int x);
 object_type *get_next_object(const object_type *o_ptr);
@@ -233,11 +237,14 @@ void distribute_charges(object_type *o_ptr, object_type *q_ptr, int amt);
 void reduce_charges(object_type *o_ptr, int amt);
 int number_charging(const object_type *o_ptr);
 bool recharge_timeout(object_type *o_ptr);
+void recharge_floor_rods(void);
 unsigned check_for_inscrip(const object_type *o_ptr, const char *inscrip);
 int lookup_kind(int tval, int sval);
+void kind_index_build(void);
 bool lookup_reverse(s16b k_idx, int *tval, int *sval);
 int lookup_name(int tval, const char *name);
 int lookup_artifact_name(const char *name);
+int lookup_artifact_prefix(const char *prefix, int *matches);
 int lookup_sval(int tval, const char *name);
 int tval_find_idx(const char *name);
 const char *tval_find_name(int tval);
@@ -280,6 +287,9 @@ void pack_overflow(void);
 
 /* obj-power.c and randart.c */
 s32b object_power(const object_type *o_ptr, int verbose, ang_file *log_file, bool known);
+void object_power_batch(const object_type *objs, size_t n, s32b *powers,
+	int verbose, ang_file *log_file, bool known);
+void free_slay_cache(void);
 char *artifact_gen_name(struct artifact *a, const char ***wordlist);
 /*
  * Some constants used in randart generation and power calculation
@@ -363,6 +363,7 @@ static void store_base_power (void)
 	object_kind *k_ptr;
 	s16b k_idx;
 	int *fake_power;
+	object_type *fakes;
 
 	max_power = 0;
 	min_power = 32767;
@@ -370,9 +371,18 @@ static void store_base_power (void)
 	fake_power = C_ZNEW(z_info->a_max, int);
 	j = 0;
 
+	/* Forge every artifact and rate them all in one go */
+	fakes = C_ZNEW(z_info->a_max, object_type);
+	for (i = 0; i < z_info->a_max; i++)
+		if (!make_fake_artifact(&fakes[i], i)) object_wipe(&fakes[i]);
+
+	LOG_PRINT("********** EVALUATING BASE POWERS ********\n");
+	object_power_batch(fakes, z_info->a_max, base_power, verbose, log_file,
+		TRUE);
+	FREE(fakes);
+
 	for(i = 0; i < z_info->a_max; i++, j++)
 	{
-		base_power[i] = artifact_power(i);
 
 		/* capture power stats, ignoring cursed and uber arts */
 		if (base_power[i] > max_power && base_power[i] < INHIBIT_POWER)
@@ -3218,5 +3228,8 @@ errr do_randart(u32b randart_seed, bool full)
 	/* When done, resume use of the Angband "complex" RNG. */
 	Rand_quick = FALSE;
 
+	/* Descriptions may name the old artifacts */
+	object_desc_forget();
+
 	return (err);
 }
@@ -195,26 +195,30 @@ typedef struct ego_item
  */
 typedef struct object
 {
-	s16b k_idx;			/* Kind index (zero if "dead") */
+	/* Looked at all the time: in piles, on the map, in the pack */
 	struct object_kind *kind;
+	s16b k_idx;			/* Kind index (zero if "dead") */
 
 	byte iy;			/* Y-position on map, or zero */
 	byte ix;			/* X-position on map, or zero */
 
+	s16b next_o_idx;	/* Next object in stack (if any) */
+	s16b held_m_idx;	/* Monster holding us (if any) */
+
 	byte tval;			/* Item type (from kind) */
 	byte sval;			/* Item sub-type (from kind) */
 
-	s16b pval;			/* Item extra-parameter */
+	byte number;		/* Number of items */
+	byte marked;		/* Object is marked */
 
+	s16b pval;			/* Item extra-parameter */
+	s16b timeout;		/* Timeout Counter */
 	s16b weight;		/* Item weight */
 
+	/* Looked at when the object is used or described */
 	byte name1;			/* Artifact type, if any */
 	byte name2;			/* Ego-Item type, if any */
 
-	bitflag flags[OF_SIZE];		/**< Flags */
-	bitflag known_flags[OF_SIZE];	/**< Player-known flags */
-	u16b ident;			/* Special flags */
-
 	s16b ac;			/* Normal AC */
 	s16b to_a;			/* Plusses to AC */
 	s16b to_h;			/* Plusses to hit */
@@ -222,14 +226,11 @@ typedef struct object
 
 	byte dd, ds;		/* Damage dice/sides */
 
-	s16b timeout;		/* Timeout Counter */
-
-	byte number;		/* Number of items */
-	byte marked;		/* Object is marked */
-
-	s16b next_o_idx;	/* Next object in stack (if any) */
-	s16b held_m_idx;	/* Monster holding us (if any) */
+	u16b ident;			/* Special flags */
+	bitflag flags[OF_SIZE];		/**< Flags */
+	bitflag known_flags[OF_SIZE];	/**< Player-known flags */
 
+	/* Hardly ever looked at */
 	byte origin;        /* How this item was found */
 	byte origin_depth;  /* What depth the item was found at */
 	u16b origin_xtra;   /* Extra information about origin */
@@ -101,6 +101,7 @@ const int option_page[OPT_PAGE_MAX][OPT_PAGE_PER] =
 		OPT_birth_no_stairs,
 		OPT_birth_no_feelings,
 		OPT_birth_no_selling,
+		OPT_birth_persist,
 	},
 
 	/* Cheat */
@@ -273,7 +274,7 @@ static option_entry options[OPT_MAX] =
 { "birth_no_stairs",     "Don't generate connected stairs",             FALSE }, /* 136 */
 { "birth_no_feelings",   "Don't show level feelings",                   FALSE }, /* 137 */
 { "birth_no_selling",    "Items always sell for 0 gold",                FALSE }, /* 138 */
-{ NULL,                  NULL,                                          FALSE }, /* 139 */
+{ "birth_persist",       "Keep levels to come back to",                 FALSE }, /* 139 */
 { NULL,                  NULL,                                          FALSE }, /* 140 */
 { "birth_ai_sound",      "Monsters chase current location",             TRUE },  /* 141 */
 { "birth_ai_smell",      "Monsters chase recent locations",             TRUE },  /* 142 */
@@ -337,7 +338,7 @@ static option_entry options[OPT_MAX] =
 { "adult_no_stairs",     "Don't generate connected stairs",             FALSE }, /* 200 */
 { "adult_no_feelings",   "Don't show level feelings",                   FALSE }, /* 201 */
 { "adult_no_selling",    "Items always sell for 0 gold",                FALSE }, /* 202 */
-{ NULL,                  NULL,                                          FALSE }, /* 203 */
+{ "adult_persist",       "Keep levels to come back to",                 FALSE }, /* 203 */
 { NULL,                  NULL,                                          FALSE }, /* 204 */
 { "adult_ai_sound",      "Adult: Monsters chase current location",      TRUE },  /* 205 */
 { "adult_ai_smell",      "Adult: Monsters chase recent locations",      TRUE },  /* 206 */
@@ -406,23 +407,78 @@ const char *option_desc(int opt)
 	return options[opt].description;
 }
 
-/* Setup functions */
-bool option_set(const char *name, bool on)
+/*
+ * Options which can be set by name, in an open hash by name (each entry is
+ * the option's index plus one, so zero is empty).  The pref files set them
+ * by name on every level, so this saves going through the table for each.
+ */
+#define OPTION_HASH_SIZE	512
+
+static u16b option_hash[OPTION_HASH_SIZE];
+static bool option_hash_built;
+
+static size_t option_hash_key(const char *name)
+{
+	u32b h = 5381;
+
+	while (*name)
+		h = h * 33 + (byte)*name++;
+
+	return (h * 2654435761U) & (OPTION_HASH_SIZE - 1);
+}
+
+static void option_hash_build(void)
 {
 	size_t opt;
+
 	for (opt = 0; opt < OPT_ADULT; opt++)
 	{
-		if (!options[opt].name || !streq(options[opt].name, name))
-			continue;
+		size_t h;
+
+		if (!options[opt].name) continue;
+
+		h = option_hash_key(options[opt].name);
+		while (option_hash[h])
+			h = (h + 1) & (OPTION_HASH_SIZE - 1);
+
+		option_hash[h] = opt + 1;
+	}
 
-		op_ptr->opt[opt] = on;
-		if (on && opt > OPT_CHEAT && opt < OPT_ADULT)
-			op_ptr->opt[opt + (OPT_SCORE - OPT_CHEAT)] = TRUE;
+	option_hash_built = TRUE;
+}
+
+/*
+ * The index of the option named `name` which can be set by name, or -1
+ */
+static int option_lookup(const char *name)
+{
+	size_t h;
+
+	if (!option_hash_built) option_hash_build();
+
+	for (h = option_hash_key(name); option_hash[h];
+	     h = (h + 1) & (OPTION_HASH_SIZE - 1))
+	{
+		int opt = option_hash[h] - 1;
 
-		return TRUE;
+		if (streq(options[opt].name, name)) return opt;
 	}
 
-	return FALSE;
+	return -1;
+}
+
+/* Setup functions */
+bool option_set(const char *name, bool on)
+{
+	int opt = option_lookup(name);
+
+	if (opt < 0) return FALSE;
+
+	op_ptr->opt[opt] = on;
+	if (on && opt > OPT_CHEAT && opt < OPT_ADULT)
+		op_ptr->opt[opt + (OPT_SCORE - OPT_CHEAT)] = TRUE;
+
+	return TRUE;
 }
 
 void option_set_defaults(void)
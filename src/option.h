@@ -15,7 +15,7 @@ void option_set_defaults(void);
  * Information for "do_cmd_options()".
  */
 #define OPT_PAGE_MAX				5
-#define OPT_PAGE_PER				16
+#define OPT_PAGE_PER				17
 
 /* The option data structures */
 extern const int option_page[OPT_PAGE_MAX][OPT_PAGE_PER];
@@ -98,6 +98,7 @@ extern const int option_page[OPT_PAGE_MAX][OPT_PAGE_PER];
 #define OPT_birth_no_stairs	    (OPT_BIRTH+8)
 #define OPT_birth_no_feelings	    (OPT_BIRTH+9)
 #define OPT_birth_no_selling 	    (OPT_BIRTH+10)
+#define OPT_birth_persist	    (OPT_BIRTH+11)
 /* leave spaces for future */
 #define OPT_birth_ai_sound			(OPT_BIRTH+13)
 #define OPT_birth_ai_smell			(OPT_BIRTH+14)
@@ -124,6 +125,7 @@ extern const int option_page[OPT_PAGE_MAX][OPT_PAGE_PER];
 #define OPT_adult_no_stairs 	    (OPT_ADULT+8)
 #define OPT_adult_no_feelings	    (OPT_ADULT+9)
 #define OPT_adult_no_selling	    (OPT_ADULT+10)
+#define OPT_adult_persist	    (OPT_ADULT+11)
 /* leave spaces for future */
 #define OPT_adult_ai_sound			(OPT_ADULT+13)
 #define OPT_adult_ai_smell			(OPT_ADULT+14)
@@ -73,6 +73,7 @@ struct parser_hook {
 	struct parser_hook *next;
 	enum parser_error (*func)(struct parser *p);
 	char *dir;
+	u32b hash;
 	struct parser_spec *fhead;
 	struct parser_spec *ftail;
 };
@@ -83,9 +84,13 @@ struct parser {
 	unsigned int colno;
 	char errmsg[1024];
 	struct parser_hook *hooks;
+	struct parser_hook **htab;
+	size_t htab_size;
+	size_t nhooks;
 	struct parser_value *fhead;
 	struct parser_value *ftail;
 	void *priv;
+	mem_arena *strings;
 };
 
 struct parser *parser_new(void) {
@@ -93,15 +98,63 @@ struct parser *parser_new(void) {
 	return p;
 }
 
+/*
+ * Hooks are found by directive from an open-addressed table of p->hooks,
+ * kept at most half full, so that each line costs one string compare.
+ */
+static u32b hook_hash(const char *dir) {
+	/* FNV-1a */
+	u32b hash = 2166136261UL;
+	while (*dir)
+		hash = (hash ^ (unsigned char)*dir++) * 16777619UL;
+	return hash;
+}
+
+static void hook_insert(struct parser *p, struct parser_hook *h, bool newest) {
+	size_t i = h->hash & (p->htab_size - 1);
+
+	while (p->htab[i])
+	{
+		/* The table holds the newest hook for each directive */
+		if (!strcmp(p->htab[i]->dir, h->dir))
+		{
+			if (newest)
+				p->htab[i] = h;
+			return;
+		}
+		i = (i + 1) & (p->htab_size - 1);
+	}
+	p->htab[i] = h;
+}
+
+static void hook_rehash(struct parser *p) {
+	struct parser_hook *h;
+
+	mem_free(p->htab);
+	p->htab_size = p->htab_size ? 2 * p->htab_size : 16;
+	p->htab = mem_zalloc(p->htab_size * sizeof *p->htab);
+
+	/* The hooks list is newest first */
+	for (h = p->hooks; h; h = h->next)
+		hook_insert(p, h, FALSE);
+}
+
 struct parser_hook *findhook(struct parser *p, const char *dir) {
-	struct parser_hook *h = p->hooks;
-	while (h)
+	u32b hash;
+	size_t i;
+
+	if (!p->htab)
+		return NULL;
+
+	hash = hook_hash(dir);
+	for (i = hash & (p->htab_size - 1); p->htab[i];
+	     i = (i + 1) & (p->htab_size - 1))
 	{
-		if (!strcmp(h->dir, dir))
-			break;
-		h = h->next;
+		struct parser_hook *h = p->htab[i];
+		if (h->hash == hash && !strcmp(h->dir, dir))
+			return h;
 	}
-	return h;
+	return NULL;
 }
 
 static void parser_freeold(struct parser *p) {
@@ -219,12 +272,20 @@ static bool parse_random(const char *str, random_value *bonus) {
 
 /* This is a bit long and should probably be refactored a bit. */
 enum parser_error parser_parse(struct parser *p, const char *line) {
+	assert(line);
+
+	return parser_parse_n(p, line, strlen(line));
+}
+
+enum parser_error parser_parse_n(struct parser *p, const char *line,
+                                 size_t len) {
 	char *cline;
 	char *tok;
 	struct parser_hook *h;
 	struct parser_spec *s;
 	struct parser_value *v;
 	char *sp = NULL;
+	char *rest;
 	char *iline;
 
 	assert(p);
@@ -238,15 +299,20 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 	p->ftail = NULL;
 
 	/* Ignore empty lines and comments. */
-	while (*line && (isspace(*line)))
+	while (len && *line && (isspace((unsigned char)*line))) {
 		line++;
-	if (!*line || *line == '#')
+		len--;
+	}
+	if (!len || !*line || *line == '#')
 		return PARSE_ERROR_NONE;
 
-	cline = string_make(line);
+	/* Take a copy of the line to tokenize */
+	cline = mem_alloc(len + 1);
+	memcpy(cline, line, len);
+	cline[len] = '\0';
 	iline = cline;
 
-	tok = strtok(cline, ":");
+	tok = my_strtok(cline, ":", &rest);
 	if (!tok) {
 		mem_free(cline);
 		p->error = PARSE_ERROR_MISSING_FIELD;
@@ -272,14 +338,18 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 		/* These types are tokenized on ':'; strings are not tokenized
 		 * at all (i.e., they consume the remainder of the line) */
 		if (t == T_INT || t == T_SYM || t == T_RAND || t == T_UINT) {
-			tok = strtok(sp, ":");
+			tok = my_strtok(sp, ":", &rest);
 			sp = NULL;
 		} else if (t == T_CHAR) {
-			tok = strtok(sp, "");
-			if (tok)
+			tok = my_strtok(sp, "", &rest);
+
+			/* The next field starts after the separator, if any */
+			if (tok) {
 				sp = tok + 1;
+				if (*sp == ':') sp++;
+			}
 		} else {
-			tok = strtok(sp, "");
+			tok = my_strtok(sp, "", &rest);
 			sp = NULL;
 		}
 		if (!tok)
@@ -365,6 +435,22 @@ void parser_setpriv(struct parser *p, void *v) {
 	p->priv = v;
 }
 
+void parser_setarena(struct parser *p, mem_arena *a) {
+	p->strings = a;
+}
+
+char *parser_strdup(struct parser *p, const char *str) {
+	if (p->strings)
+		return arena_string(p->strings, str);
+	return string_make(str);
+}
+
+char *parser_strappend(struct parser *p, char *buf, const char *str) {
+	if (p->strings)
+		return arena_append(p->strings, buf, str);
+	return string_append(buf, str);
+}
+
 static int parse_type(const char *s) {
 	int rv = 0;
 	if (s[0] == '?')
@@ -409,19 +495,21 @@ void parser_destroy(struct parser *p) {
 		mem_free(p->hooks);
 		p->hooks = h;
 	}
+	mem_free(p->htab);
 	mem_free(p);
 }
 
 static errr parse_specs(struct parser_hook *h, char *fmt) {
 	char *name ;
 	char *stype = NULL;
+	char *rest;
 	int type;
 	struct parser_spec *s;
 
 	assert(h);
 	assert(fmt);
 
-	name = strtok(fmt, " ");
+	name = my_strtok(fmt, " ", &rest);
 	if (!name)
 		return -EINVAL;
 	h->dir = string_make(name);
@@ -431,12 +519,12 @@ static errr parse_specs(struct parser_hook *h, char *fmt) {
 	{
 		/* Lack of a type is legal; that means we're at the end of the
 		 * line. */
-		stype = strtok(NULL, " ");
+		stype = my_strtok(NULL, " ", &rest);
 		if (!stype)
 			break;
 
 		/* Lack of a name, on the other hand... */
-		name = strtok(NULL, " ");
+		name = my_strtok(NULL, " ", &rest);
 		if (!name)
 		{
 			clean_specs(h);
@@ -499,7 +587,13 @@ errr parser_reg(struct parser *p, const char *fmt,
 		return r;
 	}
 
+	h->hash = hook_hash(h->dir);
 	p->hooks = h;
+	p->nhooks++;
+	if (2 * p->nhooks > p->htab_size)
+		hook_rehash(p);
+	else
+		hook_insert(p, h, TRUE);
 	mem_free(cfmt);
 	return 0;
 }
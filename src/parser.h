@@ -10,6 +10,7 @@
 
 #include "h-basic.h"
 #include "z-rand.h"
+#include "z-virt.h"
 
 struct parser;
 
@@ -62,6 +63,13 @@ extern struct parser *parser_new(void);
  */
 extern enum parser_error parser_parse(struct parser *p, const char *line);
 
+/** Parses the `len` characters at `line`, which needn't be NUL-terminated.
+ *
+ * This is parser_parse() for lines that are slices of a larger buffer.
+ */
+extern enum parser_error parser_parse_n(struct parser *p, const char *line,
+                                        size_t len);
+
 /** Destroys a parser. */
 extern void parser_destroy(struct parser *p);
 
@@ -74,6 +82,19 @@ extern void *parser_priv(struct parser *p);
  */
 extern void parser_setpriv(struct parser *p, void *v);
 
+/** Sets the arena that parser_strdup() and parser_strappend() use.
+ *
+ * Without one, they allocate each string on its own, to be freed with
+ * string_free().
+ */
+extern void parser_setarena(struct parser *p, mem_arena *a);
+
+/** Copies `str` for keeping after the parse; see parser_setarena(). */
+extern char *parser_strdup(struct parser *p, const char *str);
+
+/** Appends `str` to a string made by parser_strdup(), as string_append(). */
+extern char *parser_strappend(struct parser *p, char *buf, const char *str);
+
 /** Registers a parser hook.
  *
  * Hooks have the following format:
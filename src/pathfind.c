@@ -19,168 +19,517 @@
 
 #include "angband.h"
 #include "cave.h"
+#include "cmds.h"
 #include "squelch.h"
 
 /****** Pathfinding code ******/
 
-/* Maximum size around the player to consider in the pathfinder */
-#define MAX_PF_RADIUS 50
-
 /* Maximum distance to consider in the pathfinder */
 #define MAX_PF_LENGTH 250
 
+/* Number of grids the pathfinder can see */
+#define PF_GRIDS (DUNGEON_HGT * DUNGEON_WID)
+
 
-static int terrain[MAX_PF_RADIUS][MAX_PF_RADIUS];
-char pf_result[MAX_PF_LENGTH];
+byte pf_result[MAX_PF_LENGTH];
 int pf_result_index;
 
-static int ox, oy, ex, ey;
 
+/*
+ * Search state, kept between searches so that nothing has to be allocated
+ * or cleared per call.  A grid's entries are only meaningful when its
+ * pf_stamp[] matches pf_search, which is bumped every search.
+ */
+static u16b pf_search;
+static u16b pf_stamp[PF_GRIDS];
+static s16b pf_cost[PF_GRIDS];
+static byte pf_from[PF_GRIDS];
+static bool pf_closed[PF_GRIDS];
 
+/* The open list, a binary heap ordered by estimated total length */
+static u16b pf_heap[PF_GRIDS];
+static u16b pf_heap_pos[PF_GRIDS];
+static s16b pf_heap_key[PF_GRIDS];
+static int pf_heap_size;
 
-static bool is_valid_pf(int y, int x)
-{
-	/* Unvisited means allowed */
-	if (!(cave_info[y][x] & (CAVE_MARK))) return (TRUE);
 
-	/* Require open space */
-	return (cave_floor_bold(y, x));
+/*
+ * Estimated number of steps between two grids.  Diagonal steps cost the
+ * same as orthogonal ones, so the octile distance reduces to the larger of
+ * the two offsets; it never overestimates, so the first path found is a
+ * shortest one.
+ */
+static int pf_estimate(int y1, int x1, int y2, int x2)
+{
+	return MAX(ABS(y2 - y1), ABS(x2 - x1));
 }
 
-static void fill_terrain_info(void)
+/*
+ * Heap comparison: lower estimate first, and among equal estimates the grid
+ * furthest from the start, which keeps the search heading for the target.
+ */
+static bool pf_heap_before(int a, int b)
 {
-	int i, j;
+	if (pf_heap_key[a] != pf_heap_key[b])
+		return (pf_heap_key[a] < pf_heap_key[b]);
 
-	ox = MAX(p_ptr->px - MAX_PF_RADIUS / 2, 0);
-	oy = MAX(p_ptr->py - MAX_PF_RADIUS / 2, 0);
+	return (pf_cost[a] > pf_cost[b]);
+}
 
-	ex = MIN(p_ptr->px + MAX_PF_RADIUS / 2 - 1, DUNGEON_WID);
-	ey = MIN(p_ptr->py + MAX_PF_RADIUS / 2 - 1, DUNGEON_HGT);
+static void pf_heap_up(int i)
+{
+	int g = pf_heap[i];
 
-	for (i = 0; i < MAX_PF_RADIUS * MAX_PF_RADIUS; i++)
-		terrain[0][i] = -1;
+	while (i > 0)
+	{
+		int parent = (i - 1) / 2;
 
-	for (j = oy; j < ey; j++)
-		for (i = ox; i < ex; i++)
-			if (is_valid_pf(j, i))
-				terrain[j - oy][i - ox] = MAX_PF_LENGTH;
+		if (!pf_heap_before(g, pf_heap[parent])) break;
 
-	terrain[p_ptr->py - oy][p_ptr->px - ox] = 1;
-}
+		pf_heap[i] = pf_heap[parent];
+		pf_heap_pos[pf_heap[i]] = i;
+		i = parent;
+	}
 
-#define MARK_DISTANCE(c,d) if ((c <= MAX_PF_LENGTH) && (c > d)) { c = d; try_again = (TRUE); }
+	pf_heap[i] = g;
+	pf_heap_pos[g] = i;
+}
 
-bool findpath(int y, int x)
+static void pf_heap_down(int i)
 {
-	int i, j, dir;
-	bool try_again;
-	int cur_distance;
+	int g = pf_heap[i];
 
-	fill_terrain_info();
+	while (2 * i + 1 < pf_heap_size)
+	{
+		int child = 2 * i + 1;
 
-	terrain[p_ptr->py - oy][p_ptr->px - ox] = 1;
+		if ((child + 1 < pf_heap_size) &&
+		    pf_heap_before(pf_heap[child + 1], pf_heap[child]))
+			child++;
 
-	if ((x >= ox) && (x < ex) && (y >= oy) && (y < ey))
-	{
-		if ((cave_m_idx[y][x] > 0) && (mon_list[cave_m_idx[y][x]].ml))
-		{
-			terrain[y - oy][x - ox] = MAX_PF_LENGTH;
-		}
+		if (!pf_heap_before(pf_heap[child], g)) break;
 
-#if 0
-		else if (terrain[y-oy][x-ox] != MAX_PF_LENGTH)
-		{
-		   bell("Target blocked");
-		   return (FALSE);
-		}
-#endif
+		pf_heap[i] = pf_heap[child];
+		pf_heap_pos[pf_heap[i]] = i;
+		i = child;
+	}
+
+	pf_heap[i] = g;
+	pf_heap_pos[g] = i;
+}
 
-		terrain[y - oy][x - ox] = MAX_PF_LENGTH;
+static int pf_heap_pop(void)
+{
+	int g = pf_heap[0];
+
+	pf_heap_size--;
+	if (pf_heap_size > 0)
+	{
+		pf_heap[0] = pf_heap[pf_heap_size];
+		pf_heap_down(0);
 	}
-	else
+
+	return (g);
+}
+
+
+/*
+ * Start a new search; on wraparound, forget every old one
+ */
+static void pf_begin(void)
+{
+	if (++pf_search == 0)
 	{
-		bell("Target out of range.");
-		return (FALSE);
+		C_WIPE(pf_stamp, PF_GRIDS, u16b);
+		pf_search = 1;
 	}
+}
 
-	/* 
-	 * And now starts the very naive and very 
-	 * inefficient pathfinding algorithm
-	 */
-	do
+/*
+ * Find a shortest path from (y1, x1) to (y2, x2), using A* search.
+ *
+ * Only grids for which passable() returns TRUE are entered, apart from the
+ * destination itself, which is always allowed.  Paths longer than max steps
+ * are not considered.
+ *
+ * On success the directions of each step are written to path[], last step
+ * first, so that path[n - 1] is the first step to take; the number of
+ * steps n is returned.  If there is no such path, -1 is returned.
+ */
+int path_search(int y1, int x1, int y2, int x2, path_passable_f passable,
+		byte *path, int max)
+{
+	int start = y1 * DUNGEON_WID + x1;
+	int goal = y2 * DUNGEON_WID + x2;
+	int n, g, d;
+
+	pf_begin();
+
+	pf_stamp[start] = pf_search;
+	pf_cost[start] = 0;
+	pf_closed[start] = FALSE;
+	pf_heap_key[start] = pf_estimate(y1, x1, y2, x2);
+	pf_heap[0] = start;
+	pf_heap_pos[start] = 0;
+	pf_heap_size = 1;
+
+	while (pf_heap_size > 0)
 	{
-		try_again = FALSE;
+		int y, x;
+
+		g = pf_heap_pop();
+		pf_closed[g] = TRUE;
+
+		if (g == goal) break;
 
-		for (j = oy + 1; j < ey - 1; j++)
+		/* No room for any more steps */
+		if (pf_cost[g] >= max) continue;
+
+		y = g / DUNGEON_WID;
+		x = g % DUNGEON_WID;
+
+		for (d = 0; d < 8; d++)
 		{
-			for (i = ox + 1; i < ex - 1; i++)
-			{
-				cur_distance = terrain[j - oy][i - ox] + 1;
+			int dir = ddd[d];
+			int ny = y + ddy[dir];
+			int nx = x + ddx[dir];
+			int next = ny * DUNGEON_WID + nx;
+			int cost = pf_cost[g] + 1;
 
-				if ((cur_distance > 0) && (cur_distance < MAX_PF_LENGTH))
-				{
-					for (dir = 1; dir < 10; dir++)
-					{
-						if (dir == 5)
-							dir++;
+			if (!in_bounds(ny, nx)) continue;
 
-						MARK_DISTANCE(terrain[j - oy + ddy[dir]][i - ox + ddx[dir]], cur_distance);
-					}
-				}
+			if (pf_stamp[next] == pf_search)
+			{
+				/* Already settled, or no improvement */
+				if (pf_closed[next] || (pf_cost[next] <= cost)) continue;
+
+				/* Shorter route to a grid on the open list */
+				pf_heap_key[next] -= pf_cost[next] - cost;
+				pf_cost[next] = cost;
+				pf_from[next] = dir;
+				pf_heap_up(pf_heap_pos[next]);
+				continue;
 			}
+
+			if ((next != goal) && !passable(ny, nx)) continue;
+
+			pf_stamp[next] = pf_search;
+			pf_cost[next] = cost;
+			pf_from[next] = dir;
+			pf_closed[next] = FALSE;
+			pf_heap_key[next] = cost + pf_estimate(ny, nx, y2, x2);
+			pf_heap[pf_heap_size] = next;
+			pf_heap_pos[next] = pf_heap_size++;
+			pf_heap_up(pf_heap_pos[next]);
 		}
+	}
 
-		if (terrain[y - oy][x - ox] < MAX_PF_LENGTH)
-			try_again = (FALSE);
+	/* Failure */
+	if ((pf_stamp[goal] != pf_search) || !pf_closed[goal]) return (-1);
 
+	/* Walk back from the goal, recording the steps */
+	n = 0;
+	for (g = goal; g != start; n++)
+	{
+		d = pf_from[g];
+		path[n] = d;
+		g -= ddy[d] * DUNGEON_WID + ddx[d];
 	}
-	while (try_again);
+
+	return (n);
+}
+
+
+/*
+ * The player may path through unknown grids, and known open ones.
+ */
+static bool is_valid_pf(int y, int x)
+{
+	/* Stay off the edge of the map */
+	if (!in_bounds_fully(y, x)) return (FALSE);
+
+	/* Unvisited means allowed */
+	if (!(cave->grid[y][x].info & (CAVE_MARK))) return (TRUE);
+
+	/* Require open space */
+	return (cave_floor_bold(y, x));
+}
+
+/*
+ * Compute the player's path to (y, x) into pf_result[], for running.
+ */
+bool findpath(int y, int x)
+{
+	int n;
+
+	if (!in_bounds_fully(y, x))
+	{
+		bell("Target out of range.");
+		return (FALSE);
+	}
+
+	n = path_search(p_ptr->py, p_ptr->px, y, x, is_valid_pf, pf_result,
+			MAX_PF_LENGTH);
 
 	/* Failure */
-	if (terrain[y - oy][x - ox] == MAX_PF_LENGTH)
+	if (n < 0)
 	{
 		bell("Target space unreachable.");
 		return (FALSE);
 	}
 
-	/* Success */
-	i = x;
-	j = y;
+	pf_result_index = n - 1;
+
+	return (TRUE);
+}
+
 
-	pf_result_index = 0;
+/****** Travelling ******/
 
-	while ((i != p_ptr->px) || (j != p_ptr->py))
+/*
+ * Travelling takes the player to a grid, to the nearest known staircase, or
+ * (exploring) to the nearest grid they haven't seen, one step a turn as a
+ * run does.  The way is found by a breadth-first search out from the player
+ * over the pathfinder's search state and kept, last step first, and is only
+ * looked for again when it goes wrong: the player has been moved off it,
+ * the next step is no longer known to be passable, or where it leads is no
+ * longer a goal (as when the unknown grid being explored towards is seen).
+ * Crossing a level to a grid or staircase so costs a search or two rather
+ * than one a step; exploring searches more often, but only as far as the
+ * nearest unknown grid, which is seldom far.
+ *
+ * Grids the player has seen count as known, even if not remembered, as
+ * torch-lit floor isn't.  Known closed doors on the way are opened, and
+ * known traps and shop entrances walked round; unknown grids are only
+ * passed through on the way to a grid, as with findpath().  Monsters
+ * coming into view stop travel by disturbing the player, as for runs.
+ */
+
+/* Turns spent on one door before giving up on it */
+#define TRAVEL_DOOR_TRIES	10
+
+static int travel_goal;		/* TRAVEL_*, or TRAVEL_NONE when not travelling */
+static int travel_y, travel_x;	/* The grid, for TRAVEL_GRID */
+
+static byte travel_path[PF_GRIDS];	/* The way, last step first */
+static int travel_len;
+static int travel_to;			/* The grid it leads to */
+static int travel_py, travel_px;	/* Where the player should be */
+static int travel_door_tries;
+
+/*
+ * Whether the player knows what is at (y, x)
+ */
+static bool travel_known(int y, int x)
+{
+	return ((cave->grid[y][x].info & (CAVE_MARK)) ||
+			(cave->grid[y][x].info2 & (CAVE2_SEEN)));
+}
+
+/*
+ * Whether (y, x) is somewhere being travelled to
+ */
+static bool travel_is_goal(int y, int x)
+{
+	bool marked = (cave->grid[y][x].info & (CAVE_MARK)) ? TRUE : FALSE;
+
+	switch (travel_goal)
 	{
-		cur_distance = terrain[j - oy][i - ox] - 1;
-		for (dir = 1; dir < 10; dir++)
-		{
-			if (terrain[j - oy + ddy[dir]][i - ox + ddx[dir]] == cur_distance)
-				break;
-		}
+		case TRAVEL_GRID:
+			return ((y == travel_y) && (x == travel_x));
 
-		/* Should never happend */
-		if (dir == 10)
-		{
-			bell("Wtf ?");
-			return (FALSE);
-		}
+		case TRAVEL_UP:
+			return (marked && (cave->grid[y][x].feat == FEAT_LESS));
 
-		else if (dir == 5)
+		case TRAVEL_DOWN:
+			return (marked && (cave->grid[y][x].feat == FEAT_MORE));
+
+		case TRAVEL_EXPLORE:
+			return (in_bounds_fully(y, x) && !travel_known(y, x));
+	}
+
+	return (FALSE);
+}
+
+/*
+ * Whether the player may travel through (y, x), opening it if need be
+ */
+static bool travel_passable(int y, int x)
+{
+	int feat = cave->grid[y][x].feat;
+
+	/* Stay off the edge of the map */
+	if (!in_bounds_fully(y, x)) return (FALSE);
+
+	/* Unknown grids only on the way to a grid */
+	if (!travel_known(y, x)) return (travel_goal == TRAVEL_GRID);
+
+	/* Seen but not remembered means floor */
+	if (!(cave->grid[y][x].info & (CAVE_MARK))) return (TRUE);
+
+	/* Never onto known traps, nor into the shops */
+	if ((feat >= FEAT_TRAP_HEAD) && (feat <= FEAT_TRAP_TAIL)) return (FALSE);
+	if ((feat >= FEAT_SHOP_HEAD) && (feat <= FEAT_SHOP_TAIL)) return (FALSE);
+
+	/* Doors are opened */
+	if ((feat >= FEAT_DOOR_HEAD) && (feat <= FEAT_DOOR_TAIL)) return (TRUE);
+
+	return (cave_floor_bold(y, x));
+}
+
+/*
+ * Find the way from the player to the nearest goal into travel_path[].
+ * Returns FALSE if there is none.
+ */
+static bool travel_plan(void)
+{
+	int py = p_ptr->py;
+	int px = p_ptr->px;
+	int start = py * DUNGEON_WID + px;
+	int head = 0, tail = 0;
+	int n, g, d;
+
+	pf_begin();
+
+	pf_stamp[start] = pf_search;
+	pf_heap[tail++] = start;
+
+	/* The heap is just a queue here */
+	for (g = -1; head < tail; g = -1)
+	{
+		int y, x;
+
+		g = pf_heap[head++];
+		y = g / DUNGEON_WID;
+		x = g % DUNGEON_WID;
+
+		if (travel_is_goal(y, x)) break;
+
+		for (d = 0; d < 8; d++)
 		{
-			bell("Heyyy !");
-			return (FALSE);
+			int dir = ddd[d];
+			int ny = y + ddy[dir];
+			int nx = x + ddx[dir];
+			int next = ny * DUNGEON_WID + nx;
+
+			if (!in_bounds(ny, nx) || (pf_stamp[next] == pf_search)) continue;
+			if (!travel_is_goal(ny, nx) && !travel_passable(ny, nx)) continue;
+
+			pf_stamp[next] = pf_search;
+			pf_from[next] = dir;
+			pf_heap[tail++] = next;
 		}
+	}
 
-		pf_result[pf_result_index++] = '0' + (char)(10 - dir);
-		i += ddx[dir];
-		j += ddy[dir];
+	/* Failure */
+	if (g < 0) return (FALSE);
+
+	travel_to = g;
+	travel_py = py;
+	travel_px = px;
+
+	/* Walk back from the goal, recording the steps */
+	for (n = 0; g != start; n++)
+	{
+		d = pf_from[g];
+		travel_path[n] = d;
+		g -= ddy[d] * DUNGEON_WID + ddx[d];
 	}
 
-	pf_result_index--;
+	travel_len = n;
+
+	return (TRUE);
+}
+
+/*
+ * Whether the way found is still good for the next step
+ */
+static bool travel_on_way(void)
+{
+	int y, x;
+
+	/* Moved off it */
+	if ((p_ptr->py != travel_py) || (p_ptr->px != travel_px)) return (FALSE);
+
+	/* Nowhere to go */
+	if (!travel_len) return (FALSE);
+	if (!travel_is_goal(travel_to / DUNGEON_WID, travel_to % DUNGEON_WID))
+		return (FALSE);
+
+	/* The next step is blocked (the goal itself may be anything) */
+	y = p_ptr->py + ddy[travel_path[travel_len - 1]];
+	x = p_ptr->px + ddx[travel_path[travel_len - 1]];
+	if ((travel_len > 1) && !travel_passable(y, x)) return (FALSE);
 
 	return (TRUE);
 }
 
+/*
+ * Start travelling to the nearest `goal` (a TRAVEL_* value); (y, x) is the
+ * grid for TRAVEL_GRID.  Returns FALSE, saying why, if there's no way.
+ */
+bool travel_start(int goal, int y, int x)
+{
+	travel_goal = goal;
+	travel_y = y;
+	travel_x = x;
+	travel_door_tries = 0;
+
+	if ((goal == TRAVEL_GRID) && !in_bounds_fully(y, x))
+	{
+		bell("Target out of range.");
+	}
+	else if (!travel_plan())
+	{
+		if (goal == TRAVEL_GRID) bell("Target space unreachable.");
+		else if (goal == TRAVEL_UP) msg_print("You know of no way to an up staircase.");
+		else if (goal == TRAVEL_DOWN) msg_print("You know of no way to a down staircase.");
+		else msg_print("There is nowhere left to explore.");
+	}
+	else if (!travel_len)
+	{
+		msg_print("You are already there.");
+	}
+	else
+	{
+		return (TRUE);
+	}
+
+	travel_goal = TRAVEL_NONE;
+	return (FALSE);
+}
+
+/*
+ * The direction of the player's next step while travelling, finding the way
+ * again if need be, or 0 if travelling is over
+ */
+static int travel_step(void)
+{
+	int dir, y, x, m_idx;
+
+	/* Arrived */
+	if (!travel_len && (travel_goal != TRAVEL_EXPLORE) &&
+	    (p_ptr->py == travel_py) && (p_ptr->px == travel_px))
+		return (0);
+
+	if (!travel_on_way() && (!travel_plan() || !travel_len))
+	{
+		if (travel_goal == TRAVEL_EXPLORE)
+			msg_print("There is nowhere left to explore.");
+		return (0);
+	}
+
+	dir = travel_path[travel_len - 1];
+	y = p_ptr->py + ddy[dir];
+	x = p_ptr->px + ddx[dir];
+
+	/* Stop for monsters in the way */
+	m_idx = cave->grid[y][x].m_idx;
+	if ((m_idx > 0) && mon_list[m_idx].ml) return (0);
+
+	return (dir);
+}
+
 
 
 /*
@@ -568,10 +917,10 @@ static int see_wall(int dir, int y, int x)
 	if (!in_bounds(y, x)) return (FALSE);
 
 	/* Non-wall grids are not known walls */
-	if (cave_feat[y][x] < FEAT_SECRET) return (FALSE);
+	if (cave->grid[y][x].feat < FEAT_SECRET) return (FALSE);
 
 	/* Unknown walls are not known walls */
-	if (!(cave_info[y][x] & (CAVE_MARK))) return (FALSE);
+	if (!(cave->grid[y][x].info & (CAVE_MARK))) return (FALSE);
 
 	/* Default */
 	return (TRUE);
@@ -603,6 +952,9 @@ static void run_init(int dir)
 	bool shortleft, shortright;
 
 
+	/* This replaces any travelling */
+	travel_goal = TRAVEL_NONE;
+
 	/* Save the direction */
 	p_ptr->run_cur_dir = dir;
 
@@ -736,9 +1088,9 @@ static bool run_test(void)
 
 
 		/* Visible monsters abort running */
-		if (cave_m_idx[row][col] > 0)
+		if (cave->grid[row][col].m_idx > 0)
 		{
-			monster_type *m_ptr = &mon_list[cave_m_idx[row][col]];
+			monster_type *m_ptr = &mon_list[cave->grid[row][col].m_idx];
 
 			/* Visible monster */
 			if (m_ptr->ml) return (TRUE);
@@ -756,12 +1108,12 @@ static bool run_test(void)
 		inv = TRUE;
 
 		/* Check memorized grids */
-		if (cave_info[row][col] & (CAVE_MARK))
+		if (cave->grid[row][col].info & (CAVE_MARK))
 		{
 			bool notice = TRUE;
 
 			/* Examine the terrain */
-			switch (cave_feat[row][col])
+			switch (cave->grid[row][col].feat)
 			{
 				/* Floors */
 				case FEAT_FLOOR:
@@ -881,13 +1233,13 @@ static bool run_test(void)
 		
 		/* HACK: Ugh. Sometimes we come up with illegal bounds. This will
 		 * treat the symptom but not the disease. */
-		if (row >= DUNGEON_HGT || col >= DUNGEON_WID) continue;
+		if (row >= cave->height || col >= cave->width) continue;
 		if (row < 0 || col < 0) continue;
 
 		/* Visible monsters abort running */
-		if (cave_m_idx[row][col] > 0)
+		if (cave->grid[row][col].m_idx > 0)
 		{
-			monster_type *m_ptr = &mon_list[cave_m_idx[row][col]];
+			monster_type *m_ptr = &mon_list[cave->grid[row][col].m_idx];
 			
 			/* Visible monster */
 			if (m_ptr->ml) return (TRUE);			
@@ -907,8 +1259,8 @@ static bool run_test(void)
 
 			/* Unknown grid or non-wall */
 			/* Was: cave_floor_bold(row, col) */
-			if (!(cave_info[row][col] & (CAVE_MARK)) ||
-			    (cave_feat[row][col] < FEAT_SECRET))
+			if (!(cave->grid[row][col].info & (CAVE_MARK)) ||
+			    (cave->grid[row][col].feat < FEAT_SECRET))
 			{
 				/* Looking to break right */
 				if (p_ptr->run_break_right)
@@ -938,8 +1290,8 @@ static bool run_test(void)
 
 			/* Unknown grid or non-wall */
 			/* Was: cave_floor_bold(row, col) */
-			if (!(cave_info[row][col] & (CAVE_MARK)) ||
-			    (cave_feat[row][col] < FEAT_SECRET))
+			if (!(cave->grid[row][col].info & (CAVE_MARK)) ||
+			    (cave->grid[row][col].feat < FEAT_SECRET))
 			{
 				/* Looking to break left */
 				if (p_ptr->run_break_left)
@@ -1031,7 +1383,49 @@ void run_step(int dir)
 	/* Continue run */
 	else
 	{
-		if (!p_ptr->running_withpathfind)
+		if (!p_ptr->running_withpathfind && travel_goal)
+		{
+			dir = travel_step();
+
+			/* Done */
+			if (!dir)
+			{
+				travel_goal = TRAVEL_NONE;
+				disturb(0, 0);
+				return;
+			}
+
+			y = p_ptr->py + ddy[dir];
+			x = p_ptr->px + ddx[dir];
+
+			/* Open known closed doors, giving up on those which won't */
+			if ((cave->grid[y][x].info & (CAVE_MARK)) &&
+			    (cave->grid[y][x].feat >= FEAT_DOOR_HEAD) &&
+			    (cave->grid[y][x].feat <= FEAT_DOOR_TAIL))
+			{
+				p_ptr->running--;
+				p_ptr->energy_use = 100;
+
+				/* Locked doors take a few goes; stuck ones never open */
+				if ((!do_cmd_open_aux(y, x) && !cave_floor_bold(y, x)) ||
+				    (++travel_door_tries >= TRAVEL_DOOR_TRIES))
+				{
+					travel_goal = TRAVEL_NONE;
+					disturb(0, 0);
+				}
+
+				return;
+			}
+
+			/* Where the player should be next */
+			travel_len--;
+			travel_py = y;
+			travel_px = x;
+			travel_door_tries = 0;
+
+			p_ptr->run_cur_dir = dir;
+		}
+		else if (!p_ptr->running_withpathfind)
 		{
 			/* Update run */
 			if (run_test())
@@ -1057,11 +1451,11 @@ void run_step(int dir)
 			else if (pf_result_index == 0)
 			{
 				/* Get next step */
-				y = p_ptr->py + ddy[pf_result[pf_result_index] - '0'];
-				x = p_ptr->px + ddx[pf_result[pf_result_index] - '0'];
+				y = p_ptr->py + ddy[pf_result[pf_result_index]];
+				x = p_ptr->px + ddx[pf_result[pf_result_index]];
 
 				/* Known wall */
-				if ((cave_info[y][x] & (CAVE_MARK)) && !cave_floor_bold(y, x))
+				if ((cave->grid[y][x].info & (CAVE_MARK)) && !cave_floor_bold(y, x))
 				{
 					disturb(0,0);
 					p_ptr->running_withpathfind = FALSE;
@@ -1082,11 +1476,11 @@ void run_step(int dir)
 			else if (pf_result_index > 0)
 			{
 				/* Get next step */
-				y = p_ptr->py + ddy[pf_result[pf_result_index] - '0'];
-				x = p_ptr->px + ddx[pf_result[pf_result_index] - '0'];
+				y = p_ptr->py + ddy[pf_result[pf_result_index]];
+				x = p_ptr->px + ddx[pf_result[pf_result_index]];
 
 				/* Known wall */
-				if ((cave_info[y][x] & (CAVE_MARK)) && !cave_floor_bold(y, x))
+				if ((cave->grid[y][x].info & (CAVE_MARK)) && !cave_floor_bold(y, x))
 				{
 					disturb(0,0);
 					p_ptr->running_withpathfind = FALSE;
@@ -1094,19 +1488,19 @@ void run_step(int dir)
 				}
 
 				/* Get step after */
-				y = y + ddy[pf_result[pf_result_index-1] - '0'];
-				x = x + ddx[pf_result[pf_result_index-1] - '0'];
+				y = y + ddy[pf_result[pf_result_index-1]];
+				x = x + ddx[pf_result[pf_result_index-1]];
 
 				/* Known wall */
-				if ((cave_info[y][x] & (CAVE_MARK)) && !cave_floor_bold(y, x))
+				if ((cave->grid[y][x].info & (CAVE_MARK)) && !cave_floor_bold(y, x))
 				{
 					p_ptr->running_withpathfind = FALSE;
 
-					run_init(pf_result[pf_result_index] - '0');
+					run_init(pf_result[pf_result_index]);
 				}
 			}
 
-			p_ptr->run_cur_dir = pf_result[pf_result_index--] - '0';
+			p_ptr->run_cur_dir = pf_result[pf_result_index--];
 		}
 	}
 
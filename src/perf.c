@@ -0,0 +1,212 @@
+/*
+ * File: perf.c
+ * Purpose: Per-turn timing and counters, for finding out what's slow
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+#include "angband.h"
+#include "perf.h"
+
+#ifdef ALLOW_PERF
+
+#include <time.h>
+
+/*
+ * Everything here is only compiled in with ALLOW_PERF (see config.h);
+ * otherwise the PERF_*() macros in perf.h expand to nothing.
+ *
+ * Each game turn's times and counts are gathered by the PERF_*() macros,
+ * then added to the running totals by perf_turn_end(), which also writes
+ * them to the trace file if there is one.
+ */
+static const char *perf_timer_names[PERF_TIMER_MAX] =
+{
+	"update_view",
+	"update_flow",
+	"process_monsters",
+	"process_world",
+	"update_stuff",
+	"redraw_stuff",
+	"Term_fresh"
+};
+
+static const char *perf_count_names[PERF_COUNT_MAX] =
+{
+	"monsters",
+	"projects",
+	"los",
+	"allocs"
+};
+
+/* This turn, so far */
+static clock_t perf_started[PERF_TIMER_MAX];
+static clock_t perf_times[PERF_TIMER_MAX];
+u32b perf_counts[PERF_COUNT_MAX];
+
+/* The last complete turn */
+static clock_t perf_last_times[PERF_TIMER_MAX];
+static u32b perf_last_counts[PERF_COUNT_MAX];
+
+/* Since the last reset */
+static double perf_total_times[PERF_TIMER_MAX];
+static double perf_total_counts[PERF_COUNT_MAX];
+static u32b perf_turns;
+
+/* mem_alloc_count() at the start of this turn */
+static u32b perf_allocs_base;
+
+/* The most objects and monsters at the end of a turn since the last reset,
+   and the longest o_list[] and mon_list[] */
+static s16b perf_o_high, perf_o_size_high;
+static s16b perf_mon_high, perf_mon_size_high;
+
+/* CSV trace of every turn */
+static ang_file *perf_file;
+
+
+/* Microseconds in a number of clock ticks */
+#define PERF_USEC(t)	(1000000.0 * (t) / CLOCKS_PER_SEC)
+
+
+void perf_start(int timer)
+{
+	perf_started[timer] = clock();
+}
+
+void perf_stop(int timer)
+{
+	perf_times[timer] += clock() - perf_started[timer];
+}
+
+
+/*
+ * Finish off a game turn
+ */
+void perf_turn_end(void)
+{
+	u32b allocs = mem_alloc_count();
+	int i;
+
+	perf_counts[PERF_ALLOCS] = allocs - perf_allocs_base;
+	perf_allocs_base = allocs;
+
+	perf_o_high = MAX(perf_o_high, o_cnt);
+	perf_o_size_high = MAX(perf_o_size_high, o_size);
+	perf_mon_high = MAX(perf_mon_high, mon_cnt);
+	perf_mon_size_high = MAX(perf_mon_size_high, mon_size);
+
+	if (perf_file)
+	{
+		file_putf(perf_file, "%ld", (long)turn);
+		for (i = 0; i < PERF_TIMER_MAX; i++)
+			file_putf(perf_file, ",%.0f", PERF_USEC(perf_times[i]));
+		for (i = 0; i < PERF_COUNT_MAX; i++)
+			file_putf(perf_file, ",%lu", (unsigned long)perf_counts[i]);
+		file_putf(perf_file, "\n");
+	}
+
+	for (i = 0; i < PERF_TIMER_MAX; i++)
+	{
+		perf_total_times[i] += perf_times[i];
+		perf_last_times[i] = perf_times[i];
+		perf_times[i] = 0;
+	}
+
+	for (i = 0; i < PERF_COUNT_MAX; i++)
+	{
+		perf_total_counts[i] += perf_counts[i];
+		perf_last_counts[i] = perf_counts[i];
+		perf_counts[i] = 0;
+	}
+
+	perf_turns++;
+}
+
+
+/*
+ * Forget the running totals
+ */
+void perf_reset(void)
+{
+	C_WIPE(perf_total_times, PERF_TIMER_MAX, double);
+	C_WIPE(perf_total_counts, PERF_COUNT_MAX, double);
+	perf_turns = 0;
+
+	perf_o_high = perf_o_size_high = 0;
+	perf_mon_high = perf_mon_size_high = 0;
+}
+
+
+/*
+ * Start or stop writing every turn to "perf.csv" in the user directory
+ */
+bool perf_trace(bool on)
+{
+	char buf[1024];
+	int i;
+
+	if (perf_file)
+	{
+		file_close(perf_file);
+		perf_file = NULL;
+	}
+
+	if (!on) return TRUE;
+
+	path_build(buf, sizeof(buf), ANGBAND_DIR_USER, "perf.csv");
+	perf_file = file_open(buf, MODE_WRITE, FTYPE_TEXT);
+	if (!perf_file) return FALSE;
+
+	file_putf(perf_file, "turn");
+	for (i = 0; i < PERF_TIMER_MAX; i++)
+		file_putf(perf_file, ",%s", perf_timer_names[i]);
+	for (i = 0; i < PERF_COUNT_MAX; i++)
+		file_putf(perf_file, ",%s", perf_count_names[i]);
+	file_putf(perf_file, "\n");
+
+	return TRUE;
+}
+
+/*
+ * Describe the last turn, and the average turn since the last reset
+ */
+void perf_describe(textblock *tb)
+{
+	int i;
+	double turns = MAX(perf_turns, 1);
+
+	textblock_append(tb, "%lu game turns measured, trace to perf.csv %s.\n\n",
+	                 (unsigned long)perf_turns, perf_file ? "on" : "off");
+
+	textblock_append(tb, "%-18s %12s %12s\n", "Time (us)", "last turn",
+	                 "average");
+	for (i = 0; i < PERF_TIMER_MAX; i++)
+		textblock_append(tb, "%-18s %12.0f %12.1f\n", perf_timer_names[i],
+		                 PERF_USEC(perf_last_times[i]),
+		                 PERF_USEC(perf_total_times[i]) / turns);
+
+	textblock_append(tb, "\n%-18s %12s %12s\n", "Count", "last turn",
+	                 "average");
+	for (i = 0; i < PERF_COUNT_MAX; i++)
+		textblock_append(tb, "%-18s %12lu %12.1f\n", perf_count_names[i],
+		                 (unsigned long)perf_last_counts[i],
+		                 perf_total_counts[i] / turns);
+
+	textblock_append(tb, "\n%-18s %12s %12s %12s %12s\n", "List", "in use",
+	                 "high water", "size", "largest");
+	textblock_append(tb, "%-18s %12d %12d %12d %12d\n", "o_list", o_cnt,
+	                 perf_o_high, o_size, perf_o_size_high);
+	textblock_append(tb, "%-18s %12d %12d %12d %12d\n", "mon_list", mon_cnt,
+	                 perf_mon_high, mon_size, perf_mon_size_high);
+}
+
+#endif /* ALLOW_PERF */
@@ -0,0 +1,62 @@
+/* perf.h - per-turn timing and counters */
+
+#ifndef PERF_H
+#define PERF_H
+
+#include "z-textblock.h"
+
+/*
+ * Parts of a game turn which are timed
+ */
+enum
+{
+	PERF_UPDATE_VIEW = 0,
+	PERF_UPDATE_FLOW,
+	PERF_PROCESS_MONSTERS,
+	PERF_PROCESS_WORLD,
+	PERF_UPDATE_STUFF,
+	PERF_REDRAW_STUFF,
+	PERF_TERM_FRESH,
+
+	PERF_TIMER_MAX
+};
+
+/*
+ * Things which are counted
+ */
+enum
+{
+	PERF_MONSTERS = 0,	/* Monsters processed */
+	PERF_PROJECTS,		/* Calls to project() */
+	PERF_LOS,		/* Calls to los() and projectable() */
+	PERF_ALLOCS,		/* Calls to mem_alloc() */
+
+	PERF_COUNT_MAX
+};
+
+#ifdef ALLOW_PERF
+
+extern u32b perf_counts[PERF_COUNT_MAX];
+
+void perf_start(int timer);
+void perf_stop(int timer);
+void perf_turn_end(void);
+void perf_reset(void);
+bool perf_trace(bool on);
+void perf_describe(textblock *tb);
+
+# define PERF_START(timer)	perf_start(timer)
+# define PERF_STOP(timer)	perf_stop(timer)
+# define PERF_COUNT(what)	(perf_counts[what]++)
+# define PERF_TURN_END()	perf_turn_end()
+
+#else /* ALLOW_PERF */
+
+# define PERF_START(timer)	((void)0)
+# define PERF_STOP(timer)	((void)0)
+# define PERF_COUNT(what)	((void)0)
+# define PERF_TURN_END()	((void)0)
+
+#endif /* ALLOW_PERF */
+
+#endif /* !PERF_H */
@@ -23,6 +23,7 @@
 #include "game-event.h"
 #include "monster/monster.h"
 #include "object/tvalsval.h"
+#include "perf.h"
 #include "spells.h"
 #include "squelch.h"
 
@@ -1343,6 +1344,152 @@ int weight_remaining()
 }
 
 
+/*
+ * What one piece of equipment adds to the player's state.
+ *
+ * calc_bonuses() is run every time anything about the player changes, and
+ * usually the equipment has not, so each slot remembers what it worked out
+ * last time along with everything that went into it.
+ */
+struct equip_bonus
+{
+	/* The key */
+	bool valid;
+	bool aware;                  /* The kind is known */
+	object_type obj;             /* The object itself */
+	bitflag art_flags[OF_SIZE];  /* Its artifact's flags, which randarts change */
+
+	/* The contribution */
+	bitflag flags[OF_SIZE];
+	s16b stat_add[A_MAX];
+	s16b skills[SKILL_MAX];
+	int see_infra, speed;
+	int blows, shots, might;
+	int ac, dis_ac, to_a, dis_to_a;
+	int to_h, to_d, dis_to_h, dis_to_d;
+};
+
+static struct equip_bonus equip_bonuses[2][INVEN_TOTAL];
+
+
+/*
+ * Work out what item `o_ptr` in slot `slot` adds to the player's state
+ */
+static void equip_bonus_calc(struct equip_bonus *b, const object_type *o_ptr,
+		int slot, bool id_only)
+{
+	bitflag *f = b->flags;
+
+	/* Extract the item flags */
+	if (id_only)
+		object_flags_known(o_ptr, f);
+	else
+		object_flags(o_ptr, f);
+
+	/* Affect stats */
+	if (of_has(f, OF_STR)) b->stat_add[A_STR] += o_ptr->pval;
+	if (of_has(f, OF_INT)) b->stat_add[A_INT] += o_ptr->pval;
+	if (of_has(f, OF_WIS)) b->stat_add[A_WIS] += o_ptr->pval;
+	if (of_has(f, OF_DEX)) b->stat_add[A_DEX] += o_ptr->pval;
+	if (of_has(f, OF_CON)) b->stat_add[A_CON] += o_ptr->pval;
+	if (of_has(f, OF_CHR)) b->stat_add[A_CHR] += o_ptr->pval;
+
+	/* Affect stealth */
+	if (of_has(f, OF_STEALTH)) b->skills[SKILL_STEALTH] += o_ptr->pval;
+
+	/* Affect searching ability (factor of five) */
+	if (of_has(f, OF_SEARCH)) b->skills[SKILL_SEARCH] += (o_ptr->pval * 5);
+
+	/* Affect searching frequency (factor of five) */
+	if (of_has(f, OF_SEARCH)) b->skills[SKILL_SEARCH_FREQUENCY] += (o_ptr->pval * 5);
+
+	/* Affect infravision */
+	if (of_has(f, OF_INFRA)) b->see_infra += o_ptr->pval;
+
+	/* Affect digging (factor of 20) */
+	if (of_has(f, OF_TUNNEL)) b->skills[SKILL_DIGGING] += (o_ptr->pval * 20);
+
+	/* Affect speed */
+	if (of_has(f, OF_SPEED)) b->speed += o_ptr->pval;
+
+	/* Affect blows */
+	if (of_has(f, OF_BLOWS)) b->blows += o_ptr->pval;
+
+	/* Affect shots */
+	if (of_has(f, OF_SHOTS)) b->shots += o_ptr->pval;
+
+	/* Affect Might */
+	if (of_has(f, OF_MIGHT)) b->might += o_ptr->pval;
+
+	/* Modify the base armor class */
+	b->ac += o_ptr->ac;
+
+	/* The base armor class is always known */
+	b->dis_ac += o_ptr->ac;
+
+	/* Apply the bonuses to armor class */
+	if (!id_only || object_is_known(o_ptr))
+		b->to_a += o_ptr->to_a;
+
+	/* Apply the mental bonuses to armor class, if known */
+	if (object_defence_plusses_are_visible(o_ptr))
+		b->dis_to_a += o_ptr->to_a;
+
+	/* Hack -- do not apply "weapon" bonuses */
+	if (slot == INVEN_WIELD) return;
+
+	/* Hack -- do not apply "bow" bonuses */
+	if (slot == INVEN_BOW) return;
+
+	/* Apply the bonuses to hit/damage */
+	if (!id_only || object_is_known(o_ptr))
+	{
+		b->to_h += o_ptr->to_h;
+		b->to_d += o_ptr->to_d;
+	}
+
+	/* Apply the mental bonuses tp hit/damage, if known */
+	if (object_attack_plusses_are_visible(o_ptr))
+	{
+		b->dis_to_h += o_ptr->to_h;
+		b->dis_to_d += o_ptr->to_d;
+	}
+}
+
+
+/*
+ * Find what item `o_ptr` in slot `slot` adds to the player's state,
+ * reusing the last answer for that slot if nothing has changed.
+ */
+static const struct equip_bonus *equip_bonus_get(const object_type *o_ptr,
+		int slot, bool id_only)
+{
+	struct equip_bonus *b = &equip_bonuses[id_only ? 1 : 0][slot];
+	bitflag art_flags[OF_SIZE];
+	bool aware = object_flavor_is_aware(o_ptr);
+
+	if (o_ptr->name1)
+		of_copy(art_flags, a_info[o_ptr->name1].flags);
+	else
+		of_wipe(art_flags);
+
+	if (b->valid && (b->aware == aware) &&
+			of_is_equal(b->art_flags, art_flags) &&
+			!memcmp(&b->obj, o_ptr, sizeof(object_type)))
+		return b;
+
+	WIPE(b, struct equip_bonus);
+	b->valid = TRUE;
+	b->aware = aware;
+	COPY(&b->obj, o_ptr, object_type);
+	of_copy(b->art_flags, art_flags);
+
+	equip_bonus_calc(b, o_ptr, slot, id_only);
+
+	return b;
+}
+
+
 /*
  * Calculate the players current "state", taking into account
  * not only race/class intrinsics, but also objects being worn
@@ -1375,7 +1522,6 @@ void calc_bonuses(object_type inventory[], player_state *state, bool id_only)
 
 	object_type *o_ptr;
 
-	bitflag f[OF_SIZE];
 	bitflag collect_f[OF_SIZE];
 
 
@@ -1406,90 +1552,41 @@ void calc_bonuses(object_type inventory[], player_state *state, bool id_only)
 
 	/*** Analyze equipment ***/
 
-	/* Scan the equipment */
+	/* Add up what each item gives, working it out again only if it changed */
 	for (i = INVEN_WIELD; i < INVEN_TOTAL; i++)
 	{
+		const struct equip_bonus *b;
+
 		o_ptr = &inventory[i];
 
 		/* Skip non-objects */
 		if (!o_ptr->k_idx) continue;
 
-		/* Extract the item flags */
-		if (id_only)
-			object_flags_known(o_ptr, f);
-		else
-			object_flags(o_ptr, f);
-
-		of_union(collect_f, f);
-
-		/* Affect stats */
-		if (of_has(f, OF_STR)) state->stat_add[A_STR] += o_ptr->pval;
-		if (of_has(f, OF_INT)) state->stat_add[A_INT] += o_ptr->pval;
-		if (of_has(f, OF_WIS)) state->stat_add[A_WIS] += o_ptr->pval;
-		if (of_has(f, OF_DEX)) state->stat_add[A_DEX] += o_ptr->pval;
-		if (of_has(f, OF_CON)) state->stat_add[A_CON] += o_ptr->pval;
-		if (of_has(f, OF_CHR)) state->stat_add[A_CHR] += o_ptr->pval;
-
-		/* Affect stealth */
-		if (of_has(f, OF_STEALTH)) state->skills[SKILL_STEALTH] += o_ptr->pval;
-
-		/* Affect searching ability (factor of five) */
-		if (of_has(f, OF_SEARCH)) state->skills[SKILL_SEARCH] += (o_ptr->pval * 5);
-
-		/* Affect searching frequency (factor of five) */
-		if (of_has(f, OF_SEARCH)) state->skills[SKILL_SEARCH_FREQUENCY] += (o_ptr->pval * 5);
-
-		/* Affect infravision */
-		if (of_has(f, OF_INFRA)) state->see_infra += o_ptr->pval;
-
-		/* Affect digging (factor of 20) */
-		if (of_has(f, OF_TUNNEL)) state->skills[SKILL_DIGGING] += (o_ptr->pval * 20);
-
-		/* Affect speed */
-		if (of_has(f, OF_SPEED)) state->speed += o_ptr->pval;
-
-		/* Affect blows */
-		if (of_has(f, OF_BLOWS)) extra_blows += o_ptr->pval;
-
-		/* Affect shots */
-		if (of_has(f, OF_SHOTS)) extra_shots += o_ptr->pval;
+		b = equip_bonus_get(o_ptr, i, id_only);
 
-		/* Affect Might */
-		if (of_has(f, OF_MIGHT)) extra_might += o_ptr->pval;
+		of_union(collect_f, b->flags);
 
-		/* Modify the base armor class */
-		state->ac += o_ptr->ac;
+		for (j = 0; j < A_MAX; j++)
+			state->stat_add[j] += b->stat_add[j];
 
-		/* The base armor class is always known */
-		state->dis_ac += o_ptr->ac;
+		for (j = 0; j < SKILL_MAX; j++)
+			state->skills[j] += b->skills[j];
 
-		/* Apply the bonuses to armor class */
-		if (!id_only || object_is_known(o_ptr))
-			state->to_a += o_ptr->to_a;
+		state->see_infra += b->see_infra;
+		state->speed += b->speed;
 
-		/* Apply the mental bonuses to armor class, if known */
-		if (object_defence_plusses_are_visible(o_ptr))
-			state->dis_to_a += o_ptr->to_a;
+		extra_blows += b->blows;
+		extra_shots += b->shots;
+		extra_might += b->might;
 
-		/* Hack -- do not apply "weapon" bonuses */
-		if (i == INVEN_WIELD) continue;
-
-		/* Hack -- do not apply "bow" bonuses */
-		if (i == INVEN_BOW) continue;
-
-		/* Apply the bonuses to hit/damage */
-		if (!id_only || object_is_known(o_ptr))
-		{
-			state->to_h += o_ptr->to_h;
-			state->to_d += o_ptr->to_d;
-		}
-
-		/* Apply the mental bonuses tp hit/damage, if known */
-		if (object_attack_plusses_are_visible(o_ptr))
-		{
-			state->dis_to_h += o_ptr->to_h;
-			state->dis_to_d += o_ptr->to_d;
-		}
+		state->ac += b->ac;
+		state->dis_ac += b->dis_ac;
+		state->to_a += b->to_a;
+		state->dis_to_a += b->dis_to_a;
+		state->to_h += b->to_h;
+		state->to_d += b->to_d;
+		state->dis_to_h += b->dis_to_h;
+		state->dis_to_d += b->dis_to_d;
 	}
 
 
@@ -2171,12 +2268,8 @@ void notice_stuff(void)
 /*
  * Handle "p_ptr->update"
  */
-void update_stuff(void)
+static void update_stuff_aux(void)
 {
-	/* Update stuff */
-	if (!p_ptr->update) return;
-
-
 	if (p_ptr->update & (PU_BONUS))
 	{
 		p_ptr->update &= ~(PU_BONUS);
@@ -2225,7 +2318,9 @@ void update_stuff(void)
 	if (p_ptr->update & (PU_UPDATE_VIEW))
 	{
 		p_ptr->update &= ~(PU_UPDATE_VIEW);
+		PERF_START(PERF_UPDATE_VIEW);
 		update_view();
+		PERF_STOP(PERF_UPDATE_VIEW);
 	}
 
 
@@ -2238,7 +2333,9 @@ void update_stuff(void)
 	if (p_ptr->update & (PU_UPDATE_FLOW))
 	{
 		p_ptr->update &= ~(PU_UPDATE_FLOW);
+		PERF_START(PERF_UPDATE_FLOW);
 		update_flow();
+		PERF_STOP(PERF_UPDATE_FLOW);
 	}
 
 
@@ -2263,6 +2360,16 @@ void update_stuff(void)
 	}
 }
 
+void update_stuff(void)
+{
+	/* Update stuff */
+	if (!p_ptr->update) return;
+
+	PERF_START(PERF_UPDATE_STUFF);
+	update_stuff_aux();
+	PERF_STOP(PERF_UPDATE_STUFF);
+}
+
 
 
 struct flag_event_trigger
@@ -2321,6 +2428,8 @@ void redraw_stuff(void)
 	/* Character is in "icky" mode, no screen updates */
 	if (character_icky) return;
 
+	PERF_START(PERF_REDRAW_STUFF);
+
 	/* For each listed flag, send the appropriate signal to the UI */
 	for (i = 0; i < N_ELEMENTS(redraw_events); i++)
 	{
@@ -2344,6 +2453,8 @@ void redraw_stuff(void)
 	 * is over.
 	 */
 	event_signal(EVENT_END);
+
+	PERF_STOP(PERF_REDRAW_STUFF);
 }
 
 
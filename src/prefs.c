@@ -515,6 +515,30 @@ static enum parser_error parse_prefs_load(struct parser *p)
 	return PARSE_ERROR_NONE;
 }
 
+/*
+ * The variables which pref file expressions can use, as "$NAME"
+ */
+static const char *pref_var_sys(void) { return ANGBAND_SYS; }
+static const char *pref_var_graf(void) { return ANGBAND_GRAF; }
+static const char *pref_var_race(void) { return rp_ptr->name; }
+static const char *pref_var_class(void) { return cp_ptr->name; }
+static const char *pref_var_player(void) { return op_ptr->base_name; }
+static const char *pref_var_version(void) { return VERSION_STRING; }
+
+static const struct
+{
+	const char *name;
+	const char *(*value)(void);
+} pref_vars[] =
+{
+	{ "SYS",     pref_var_sys },
+	{ "GRAF",    pref_var_graf },
+	{ "RACE",    pref_var_race },
+	{ "CLASS",   pref_var_class },
+	{ "PLAYER",  pref_var_player },
+	{ "VERSION", pref_var_version }
+};
+
 /*
  * Helper function for "process_pref_file()"
  *
@@ -673,18 +697,16 @@ static const char *process_pref_file_expr(char **sp, char *fp)
 		/* Variable */
 		if (*b == '$')
 		{
-			if (streq(b+1, "SYS"))
-				v = ANGBAND_SYS;
-			else if (streq(b+1, "GRAF"))
-				v = ANGBAND_GRAF;
-			else if (streq(b+1, "RACE"))
-				v = rp_ptr->name;
-			else if (streq(b+1, "CLASS"))
-				v = cp_ptr->name;
-			else if (streq(b+1, "PLAYER"))
-				v = op_ptr->base_name;
-			else if (streq(b+1, "VERSION"))
-				v = VERSION_STRING;
+			size_t i;
+
+			for (i = 0; i < N_ELEMENTS(pref_vars); i++)
+			{
+				if (streq(b+1, pref_vars[i].name))
+				{
+					v = pref_vars[i].value();
+					break;
+				}
+			}
 		}
 
 		/* Constant */
@@ -1244,15 +1266,17 @@ bool process_pref_file(const char *name, bool quiet)
 	}
 	else
 	{
-		char line[1024];
+		char buf2[1024];
+		const char *line;
+		size_t len;
 
 		p = init_parse_prefs();
 
-		while (file_getl(f, line, sizeof line))
+		while (file_getl_ref(f, buf2, sizeof buf2, &line, &len))
 		{
 			line_no++;
 
-			e = parser_parse(p, line);
+			e = parser_parse_n(p, line, len);
 			if (e != PARSE_ERROR_NONE)
 			{
 				print_error(buf, p);
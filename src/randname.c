@@ -24,9 +24,18 @@
 
 typedef unsigned short name_probs[S_WORD+1][S_WORD+1][TOTAL+1];
 
+/*
+ * The tables built for each name type, and the word list each came from
+ */
+static struct
+{
+	cptr *wordlist;
+	name_probs probs;
+} name_tables[RANDNAME_NUM_TYPES];
+
 /*
  * This function builds probability tables from a list of purely alphabetical
- * lower-case words, and puts them into the supplied name_probs object.
+ * lower-case words, and adds them to the supplied name_probs object.
  * The array of names should have a NULL entry at the end of the list.
  * It relies on the ASCII character set (through use of A2I).
  */
@@ -73,28 +82,24 @@ size_t randname_make(randname_type name_type, size_t min, size_t max, char *word
 	size_t lnum = 0;
 	bool found_word = FALSE;
 
-	static name_probs lprobs;
-	static randname_type cached_type = RANDNAME_NUM_TYPES;
+	unsigned short (*lprobs)[S_WORD+1][TOTAL+1];
 
 	assert(name_type > 0 && name_type < RANDNAME_NUM_TYPES);
 
 	/* To allow for a terminating character */
 	assert(buflen > max);
 
-	/* We cache one set of probabilities, only regenerate when
-	   the type changes.  It's as good a way as any for now.
-	   Frankly, we could probably regenerate every time. */
-	if (cached_type != name_type)
+	/* Each type keeps its own probabilities, only regenerated when
+	   it is asked for with a different word list. */
+	lprobs = name_tables[name_type].probs;
+	if (name_tables[name_type].wordlist != sections[name_type])
 	{
-		cptr *wordlist = NULL;
+		memset(lprobs, 0, sizeof(name_probs));
+		build_prob(lprobs, sections[name_type]);
 
-		wordlist = sections[name_type];
-
-		build_prob(lprobs, wordlist);
-
-		cached_type = name_type;
+		name_tables[name_type].wordlist = sections[name_type];
 	}
-        
+
 	/* Generate the actual word wanted. */
 	while (!found_word)
 	{
@@ -28,8 +28,6 @@
  */
 static void wr_item(const object_type *o_ptr)
 {
-	size_t i;
-
 	wr_u16b(0xffff);
 	wr_byte(ITEM_VERSION);
 
@@ -70,14 +68,12 @@ static void wr_item(const object_type *o_ptr)
 
 
 	/* Hack - XXX - MarbleDice - Maximum saveable flags = 96 */
-	for (i = 0; i < 12 && i < OF_SIZE; i++)
-		wr_byte(o_ptr->flags[i]);
-	if (i < 12) pad_bytes(12 - i);
+	wr_bytes(o_ptr->flags, MIN(12, OF_SIZE));
+	if (OF_SIZE < 12) pad_bytes(12 - OF_SIZE);
 
 	/* Hack - XXX - MarbleDice - Maximum saveable flags = 96 */
-	for (i = 0; i < 12 && i < OF_SIZE; i++)
-		wr_byte(o_ptr->known_flags[i]);
-	if (i < 12) pad_bytes(12 - i);
+	wr_bytes(o_ptr->known_flags, MIN(12, OF_SIZE));
+	if (OF_SIZE < 12) pad_bytes(12 - OF_SIZE);
 
 	/* Held by monster index */
 	wr_s16b(o_ptr->held_m_idx);
@@ -231,58 +227,101 @@ void wr_messages(void)
 }
 
 
-void wr_monster_memory(void)
+/*
+ * Which parts of race `r_idx`'s entry in the monster memory need writing
+ */
+static byte lore_parts(int r_idx)
 {
+	const monster_lore *l_ptr = &l_list[r_idx];
+	byte parts = 0;
 	size_t i;
+
+	if (l_ptr->sights || l_ptr->deaths || l_ptr->pkills || l_ptr->tkills)
+		parts |= LORE_COUNTS;
+	if (l_ptr->wake || l_ptr->ignore)
+		parts |= LORE_WAKE;
+	if (l_ptr->drop_gold || l_ptr->drop_item)
+		parts |= LORE_DROPS;
+	if (l_ptr->cast_innate || l_ptr->cast_spell)
+		parts |= LORE_CASTS;
+
+	for (i = 0; i < MONSTER_BLOW_MAX; i++)
+		if (l_ptr->blows[i]) parts |= LORE_BLOWS;
+
+	if (!flag_is_empty(l_ptr->flags, RF_SIZE))
+		parts |= LORE_FLAGS;
+	if (!flag_is_empty(l_ptr->spell_flags, RSF_SIZE))
+		parts |= LORE_SPELLS;
+
+	if (r_info[r_idx].max_num != lore_default_max_num(r_idx))
+		parts |= LORE_MAX_NUM;
+
+	return parts;
+}
+
+/*
+ * Write the monster memory: the number of races and the sizes of the flag
+ * sets, then an entry for each race with anything to remember.  Each entry
+ * is the race, a byte of which LORE_* parts follow, and those parts.
+ */
+void wr_monster_memory(void)
+{
 	int r_idx;
+	u16b n = 0;
+
+	for (r_idx = 0; r_idx < z_info->r_max; r_idx++)
+		if (lore_parts(r_idx)) n++;
 
 	wr_u16b(z_info->r_max);
+	wr_byte(RF_SIZE);
+	wr_byte(RSF_SIZE);
+	wr_u16b(n);
+
 	for (r_idx = 0; r_idx < z_info->r_max; r_idx++)
 	{
-		monster_race *r_ptr = &r_info[r_idx];
 		monster_lore *l_ptr = &l_list[r_idx];
+		byte parts = lore_parts(r_idx);
 
-		/* Count sights/deaths/kills */
-		wr_s16b(l_ptr->sights);
-		wr_s16b(l_ptr->deaths);
-		wr_s16b(l_ptr->pkills);
-		wr_s16b(l_ptr->tkills);
-
-		/* Count wakes and ignores */
-		wr_byte(l_ptr->wake);
-		wr_byte(l_ptr->ignore);
-
-		/* Count drops */
-		wr_byte(l_ptr->drop_gold);
-		wr_byte(l_ptr->drop_item);
+		if (!parts) continue;
 
-		/* Count spells */
-		wr_byte(l_ptr->cast_innate);
-		wr_byte(l_ptr->cast_spell);
+		wr_u16b(r_idx);
+		wr_byte(parts);
 
-		/* Count blows of each type */
-		for (i = 0; i < MONSTER_BLOW_MAX; i++)
-			wr_byte(l_ptr->blows[i]);
+		if (parts & LORE_COUNTS)
+		{
+			wr_s16b(l_ptr->sights);
+			wr_s16b(l_ptr->deaths);
+			wr_s16b(l_ptr->pkills);
+			wr_s16b(l_ptr->tkills);
+		}
 
-		/* Memorize flags */
+		if (parts & LORE_WAKE)
+		{
+			wr_byte(l_ptr->wake);
+			wr_byte(l_ptr->ignore);
+		}
 
-		/* Hack - XXX - MarbleDice - Maximum saveable flags = 96 */
-		for (i = 0; i < 12 && i < RF_SIZE; i++)
-			wr_byte(l_ptr->flags[i]);
-		if (i < 12) pad_bytes(12 - i);
+		if (parts & LORE_DROPS)
+		{
+			wr_byte(l_ptr->drop_gold);
+			wr_byte(l_ptr->drop_item);
+		}
 
-		/* Hack - XXX - MarbleDice - Maximum saveable flags = 96 */
-		for (i = 0; i < 12 && i < RSF_SIZE; i++)
-			wr_byte(l_ptr->spell_flags[i]);
-		if (i < 12) pad_bytes(12 - i);
+		if (parts & LORE_CASTS)
+		{
+			wr_byte(l_ptr->cast_innate);
+			wr_byte(l_ptr->cast_spell);
+		}
 
-		/* Monster limit per level */
-		wr_byte(r_ptr->max_num);
+		if (parts & LORE_BLOWS)
+			wr_bytes(l_ptr->blows, MONSTER_BLOW_MAX);
+		if (parts & LORE_FLAGS)
+			wr_bytes(l_ptr->flags, RF_SIZE);
+		if (parts & LORE_SPELLS)
+			wr_bytes(l_ptr->spell_flags, RSF_SIZE);
 
-		/* XXX */
-		wr_byte(0);
-		wr_byte(0);
-		wr_byte(0);
+		if (parts & LORE_MAX_NUM)
+			wr_byte(r_info[r_idx].max_num);
 	}
 }
 
@@ -420,8 +459,7 @@ void wr_player(void)
 	wr_byte(TMD_MAX);
 
 	/* Read all the effects, in a loop */
-	for (i = 0; i < TMD_MAX; i++)
-		wr_s16b(p_ptr->timed[i]);
+	wr_s16b_array(p_ptr->timed, TMD_MAX);
 
 	/* Total energy used so far */
 	wr_u32b(p_ptr->total_energy);
@@ -477,10 +515,12 @@ void wr_misc(void)
 	wr_u32b(seed_randart);
 
 
+	/* Dungeon level seed */
+	wr_u32b(seed_dungeon);
+
 	/* XXX Ignore some flags */
 	wr_u32b(0L);
 	wr_u32b(0L);
-	wr_u32b(0L);
 
 
 	/* Write the "object seeds" */
@@ -510,25 +550,17 @@ void wr_misc(void)
 
 void wr_player_hp(void)
 {
-	int i;
-
 	wr_u16b(PY_MAX_LEVEL);
-	for (i = 0; i < PY_MAX_LEVEL; i++)
-		wr_s16b(p_ptr->player_hp[i]);
+	wr_s16b_array(p_ptr->player_hp, PY_MAX_LEVEL);
 }
 
 
 void wr_player_spells(void)
 {
-	int i;
-
 	wr_u16b(PY_MAX_SPELLS);
 
-	for (i = 0; i < PY_MAX_SPELLS; i++)
-		wr_byte(p_ptr->spell_flags[i]);
-
-	for (i = 0; i < PY_MAX_SPELLS; i++)
-		wr_byte(p_ptr->spell_order[i]);
+	wr_bytes(p_ptr->spell_flags, PY_MAX_SPELLS);
+	wr_bytes(p_ptr->spell_order, PY_MAX_SPELLS);
 }
 
 
@@ -646,148 +678,89 @@ void wr_stores(void)
 
 
 /*
- * Write the current dungeon
+ * Append the run-length encoding of one byte of each grid to `out`, as
+ * pairs of (count, byte), and return the new length.  `plane` picks the
+ * saved cave_info flags (0), cave_info2 (1) or the feature (2).
  */
-void wr_dungeon(void)
+static size_t wr_dungeon_runs(byte *out, size_t len, int plane)
 {
 	int y, x;
 
-	byte tmp8u;
-
-	byte count;
-	byte prev_char;
-
-
-	if (p_ptr->is_dead)
-		return;
-
-	/*** Basic info ***/
-
-	/* Dungeon specific info follows */
-	wr_u16b(p_ptr->depth);
-	wr_u16b(daycount);
-	wr_u16b(p_ptr->py);
-	wr_u16b(p_ptr->px);
-	wr_u16b(DUNGEON_HGT);
-	wr_u16b(DUNGEON_WID);
-	wr_u16b(0);
-	wr_u16b(0);
-
-
-	/*** Simple "Run-Length-Encoding" of cave ***/
-
-	/* Note that this will induce two wasted bytes */
-	count = 0;
-	prev_char = 0;
+	byte count = 0;
+	byte prev_char = 0;
 
-	/* Dump the cave */
-	for (y = 0; y < DUNGEON_HGT; y++)
+	for (y = 0; y < cave->height; y++)
 	{
-		for (x = 0; x < DUNGEON_WID; x++)
+		for (x = 0; x < cave->width; x++)
 		{
-			/* Extract the important cave_info flags */
-			tmp8u = (cave_info[y][x] & (IMPORTANT_FLAGS));
+			byte tmp8u;
+
+			if (plane == 0)
+				tmp8u = (cave->grid[y][x].info & (IMPORTANT_FLAGS));
+			else if (plane == 1)
+				tmp8u = cave->grid[y][x].info2;
+			else
+				tmp8u = cave->grid[y][x].feat;
 
 			/* If the run is broken, or too full, flush it */
-			if ((tmp8u != prev_char) || (count == MAX_UCHAR))
+			if (count && ((tmp8u != prev_char) || (count == MAX_UCHAR)))
 			{
-				wr_byte((byte)count);
-				wr_byte((byte)prev_char);
-				prev_char = tmp8u;
-				count = 1;
+				out[len++] = count;
+				out[len++] = prev_char;
+				count = 0;
 			}
 
-			/* Continue the run */
-			else
-			{
-				count++;
-			}
+			prev_char = tmp8u;
+			count++;
 		}
 	}
 
-	/* Flush the data (if any) */
-	if (count)
-	{
-		wr_byte((byte)count);
-		wr_byte((byte)prev_char);
-	}
+	/* Flush the last run */
+	out[len++] = count;
+	out[len++] = prev_char;
 
-	/** Now dump the cave_info2[][] stuff **/
+	return len;
+}
 
-	/* Note that this will induce two wasted bytes */
-	count = 0;
-	prev_char = 0;
 
-	/* Dump the cave */
-	for (y = 0; y < DUNGEON_HGT; y++)
-	{
-		for (x = 0; x < DUNGEON_WID; x++)
-		{
-			/* Keep all the information from info2 */
-			tmp8u = cave_info2[y][x];
+/*
+ * Write the current dungeon
+ */
+void wr_dungeon(void)
+{
+	byte *runs;
+	size_t len = 0;
+	int plane;
 
-			/* If the run is broken, or too full, flush it */
-			if ((tmp8u != prev_char) || (count == MAX_UCHAR))
-			{
-				wr_byte((byte)count);
-				wr_byte((byte)prev_char);
-				prev_char = tmp8u;
-				count = 1;
-			}
 
-			/* Continue the run */
-			else
-			{
-				count++;
-			}
-		}
-	}
+	if (p_ptr->is_dead)
+		return;
 
-	/* Flush the data (if any) */
-	if (count)
-	{
-		wr_byte((byte)count);
-		wr_byte((byte)prev_char);
-	}
+	/*** Basic info ***/
 
+	/* Dungeon specific info follows */
+	wr_u16b(p_ptr->depth);
+	wr_u16b(daycount);
+	wr_u16b(p_ptr->py);
+	wr_u16b(p_ptr->px);
+	wr_u16b(cave->height);
+	wr_u16b(cave->width);
+	wr_u16b(0);
+	wr_u16b(0);
 
-	/*** Simple "Run-Length-Encoding" of cave ***/
 
-	/* Note that this will induce two wasted bytes */
-	count = 0;
-	prev_char = 0;
+	/*** Run-length encode the cave, then compress the runs ***/
 
-	/* Dump the cave */
-	for (y = 0; y < DUNGEON_HGT; y++)
-	{
-		for (x = 0; x < DUNGEON_WID; x++)
-		{
-			/* Extract a byte */
-			tmp8u = cave_feat[y][x];
+	/* At worst every grid starts a new run in each plane */
+	runs = mem_alloc(3 * 2 * cave->height * cave->width);
 
-			/* If the run is broken, or too full, flush it */
-			if ((tmp8u != prev_char) || (count == MAX_UCHAR))
-			{
-				wr_byte((byte)count);
-				wr_byte((byte)prev_char);
-				prev_char = tmp8u;
-				count = 1;
-			}
+	for (plane = 0; plane < 3; plane++)
+		len = wr_dungeon_runs(runs, len, plane);
 
-			/* Continue the run */
-			else
-			{
-				count++;
-			}
-		}
-	}
+	wr_u32b(len);
+	wr_compressed(runs, len);
 
-	/* Flush the data (if any) */
-	if (count)
-	{
-		wr_byte((byte)count);
-		wr_byte((byte)prev_char);
-	}
+	mem_free(runs);
 
 
 	/*** Compact ***/
@@ -843,7 +816,7 @@ void wr_monsters(void)
 		wr_s16b(m_ptr->maxhp);
 		wr_s16b(m_ptr->csleep);
 		wr_byte(m_ptr->mspeed);
-		wr_byte(m_ptr->energy);
+		wr_byte(monster_energy(i));
 		wr_byte(m_ptr->stunned);
 		wr_byte(m_ptr->confused);
 		wr_byte(m_ptr->monfear);
@@ -17,8 +17,13 @@
  */
 #include <errno.h>
 #include "angband.h"
+#include "history.h"
 #include "savefile.h"
 
+#ifdef HAVE_PTHREAD_H
+# include <pthread.h>
+#endif
+
 
 /** Magic bits at beginning of savefile */
 static const byte savefile_magic[4] = { 83, 97, 118, 101 };
@@ -40,7 +45,7 @@ static const struct
 	{ "rng", rd_randomizer, wr_randomizer, 1, 1 },
 	{ "options", rd_options, wr_options, 1, 1 },
 	{ "messages", rd_messages, wr_messages, 1, 1 },
-	{ "monster memory", rd_monster_memory, wr_monster_memory, 1, 1 },
+	{ "monster memory", rd_monster_memory, wr_monster_memory, 2, 1 },
 	{ "object memory", rd_object_memory, wr_object_memory, 1, 1 },
 	{ "quests", rd_quests, wr_quests, 1, 1 },
 	{ "artifacts", rd_artifacts, wr_artifacts, 2, 1 },
@@ -52,26 +57,93 @@ static const struct
 	{ "randarts", rd_randarts, wr_randarts, 1, 1 },
 	{ "inventory", rd_inventory, wr_inventory, 1, 1 },
 	{ "stores", rd_stores, wr_stores, 1, 1 },
-	{ "dungeon", rd_dungeon, wr_dungeon, 1, 1 },
+	{ "dungeon", rd_dungeon, wr_dungeon, 2, 1 },
 	{ "objects", rd_objects, wr_objects, 1, 1 },
 	{ "monsters", rd_monsters, wr_monsters, 1, 1 },
 	{ "ghost", rd_ghost, wr_ghost, 1, 1 },
 	{ "history", rd_history, wr_history, 1, 1 },
+	{ "levels", rd_levels, wr_levels, 1, 1 },
 };
 
 
+/*
+ * Autosaves only write what has changed since the last full save.
+ *
+ * After each full save, the bytes written for each block are kept.  A delta
+ * save serialises the game as usual, but only writes the blocks which
+ * differ from those, to a file beside the savefile (its name with ".delta"
+ * added) which loading lays over the savefile block by block.  Most blocks
+ * have no one place where they change, so it is the bytes that are
+ * compared, rather than blocks being marked as changed.
+ *
+ * The delta file is written and moved into place just as the savefile is,
+ * so a crash part way leaves a whole one, and it starts with the length and
+ * hash of the savefile it goes with, so that one left over from an earlier
+ * savefile (if the game stopped between writing a full save and deleting
+ * the delta) is ignored.  Once the delta file would be three quarters of
+ * the size of the savefile, or after SAVE_DELTA_MAX of them, the save is a
+ * full one again.
+ *
+ * A delta file is the savefile magic, "Dlta", the savefile's length and
+ * hash (four bytes each), and then blocks just as in a savefile.
+ */
+#define SAVE_DELTA_MAX		16
+#define SAVE_DELTA_HEAD_SIZE	16
+
+static const byte delta_name[4] = { 'D', 'l', 't', 'a' };
+
+/* How try_save() treats the blocks it writes */
+enum save_mode
+{
+	SAVE_PLAIN,	/* Just write them */
+	SAVE_FULL,	/* Write them, and keep them for delta saves */
+	SAVE_DELTA	/* Only write those which differ from those kept */
+};
+
+/*
+ * The savefile on disk which delta saves go with, and what it holds
+ */
+static struct
+{
+	bool valid;
+	char path[1024];
+	const char *const *wanted;
+
+	u32b len;
+	u32b hash;
+	int deltas;
+
+	byte *block[N_ELEMENTS(savefile_blocks)];
+	u32b block_len[N_ELEMENTS(savefile_blocks)];
+} save_base;
+
+
 /* Buffer bits */
 static byte *buffer;
 static u32b buffer_size;
 static u32b buffer_pos;
 static u32b buffer_check;
 
-#define BUFFER_INITIAL_SIZE		1024
-#define BUFFER_BLOCK_INCREMENT	1024
+#define BUFFER_INITIAL_SIZE		4096
 
 #define SAVEFILE_HEAD_SIZE		28
 
 
+/*
+ * A whole savefile, serialised into memory, and where it is to go
+ */
+struct save_image
+{
+	byte *data;
+	u32b len;
+	u32b size;
+
+	char path[1024];
+	bool full;	/* Delete the delta file once written */
+	bool ok;
+};
+
+
 /** Utility **/
 
 
@@ -95,38 +167,90 @@ void note(cptr msg)
 }
 
 
+/*
+ * The monster limit race `r_idx` starts each game with: one for uniques,
+ * none for the ghost, and plenty for everything else
+ */
+byte lore_default_max_num(int r_idx)
+{
+	if (r_idx == z_info->r_max - 1) return 0;
+	if (rf_has(r_info[r_idx].flags, RF_UNIQUE)) return 1;
+	return 100;
+}
+
+
 
 
 /** Base put/get **/
 
-static void sf_put(byte v)
+/*
+ * Make room for another `n` bytes in the buffer, doubling it as needed so
+ * that writing a block never costs more than a handful of reallocations.
+ */
+static void sf_reserve(u32b n)
 {
 	assert(buffer != NULL);
 	assert(buffer_size > 0);
 
-	if (buffer_size == buffer_pos)
-	{
-		buffer_size += BUFFER_BLOCK_INCREMENT;
-		buffer = mem_realloc(buffer, buffer_size);
-	}
+	if (buffer_pos + n <= buffer_size) return;
 
-	assert(buffer_pos < buffer_size);
+	while (buffer_pos + n > buffer_size)
+		buffer_size *= 2;
+
+	buffer = mem_realloc(buffer, buffer_size);
+}
+
+static void sf_put(byte v)
+{
+	sf_reserve(1);
 
 	buffer[buffer_pos++] = v;
 	buffer_check += v;
 }
 
+/*
+ * Reading doesn't keep a running checksum; try_load_image() checks each
+ * block's checksum in one go before loading it.
+ */
 static byte sf_get(void)
 {
 	assert(buffer != NULL);
 	assert(buffer_size > 0);
 	assert(buffer_pos < buffer_size);
 
-	buffer_check += buffer[buffer_pos];
-
 	return buffer[buffer_pos++];
 }
 
+/*
+ * Take the next `n` bytes of the buffer, returning where they start
+ */
+static const byte *sf_take(u32b n)
+{
+	const byte *p;
+
+	assert(buffer != NULL);
+	assert(n <= buffer_size - buffer_pos);
+
+	p = &buffer[buffer_pos];
+	buffer_pos += n;
+
+	return p;
+}
+
+/*
+ * The checksum of the `n` bytes at `data`, as try_save() works it out
+ */
+static u32b sf_checksum(const byte *data, u32b n)
+{
+	u32b check = 0;
+	u32b i;
+
+	for (i = 0; i < n; i++)
+		check += data[i];
+
+	return check;
+}
+
 
 /* accessor */
 
@@ -161,12 +285,44 @@ void wr_s32b(s32b v)
 
 void wr_string(cptr str)
 {
-	while (*str)
+	wr_bytes((const byte *)str, strlen(str) + 1);
+}
+
+/*
+ * Write `n` bytes at once
+ */
+void wr_bytes(const byte *v, size_t n)
+{
+	size_t i;
+
+	sf_reserve(n);
+
+	memcpy(&buffer[buffer_pos], v, n);
+	for (i = 0; i < n; i++)
+		buffer_check += v[i];
+
+	buffer_pos += n;
+}
+
+/*
+ * Write an array of `n` signed 16-bit values at once
+ */
+void wr_s16b_array(const s16b *v, size_t n)
+{
+	size_t i;
+
+	sf_reserve(2 * n);
+
+	for (i = 0; i < n; i++)
 	{
-		wr_byte(*str);
-		str++;
+		u16b u = (u16b)v[i];
+		byte lo = (byte)(u & 0xFF);
+		byte hi = (byte)((u >> 8) & 0xFF);
+
+		buffer[buffer_pos++] = lo;
+		buffer[buffer_pos++] = hi;
+		buffer_check += lo + hi;
 	}
-	wr_byte(*str);
 }
 
 
@@ -177,8 +333,9 @@ void rd_byte(byte *ip)
 
 void rd_u16b(u16b *ip)
 {
-	(*ip) = sf_get();
-	(*ip) |= ((u16b)(sf_get()) << 8);
+	const byte *p = sf_take(2);
+
+	(*ip) = p[0] | ((u16b)p[1] << 8);
 }
 
 void rd_s16b(s16b *ip)
@@ -188,10 +345,10 @@ void rd_s16b(s16b *ip)
 
 void rd_u32b(u32b *ip)
 {
-	(*ip) = sf_get();
-	(*ip) |= ((u32b)(sf_get()) << 8);
-	(*ip) |= ((u32b)(sf_get()) << 16);
-	(*ip) |= ((u32b)(sf_get()) << 24);
+	const byte *p = sf_take(4);
+
+	(*ip) = p[0] | ((u32b)p[1] << 8) | ((u32b)p[2] << 16) |
+			((u32b)p[3] << 24);
 }
 
 void rd_s32b(s32b *ip)
@@ -201,24 +358,201 @@ void rd_s32b(s32b *ip)
 
 void rd_string(char *str, int max)
 {
-	byte tmp8u;
-	int i = 0;
+	const byte *p;
+	const byte *end;
+	size_t len;
+
+	assert(buffer != NULL);
+
+	p = &buffer[buffer_pos];
+	end = memchr(p, '\0', buffer_size - buffer_pos);
+	assert(end != NULL);
 
-	do
+	/* Take the string and its terminator, keeping what fits */
+	len = end - p;
+	sf_take(len + 1);
+
+	if (len >= (size_t)max) len = max - 1;
+	memcpy(str, p, len);
+	str[len] = '\0';
+}
+
+/*
+ * Read `n` bytes at once
+ */
+void rd_bytes(byte *v, size_t n)
+{
+	memcpy(v, sf_take(n), n);
+}
+
+/*
+ * Read an array of `n` signed 16-bit values at once
+ */
+void rd_s16b_array(s16b *v, size_t n)
+{
+	const byte *p = sf_take(2 * n);
+	size_t i;
+
+	for (i = 0; i < n; i++, p += 2)
+		v[i] = (s16b)(p[0] | ((u16b)p[1] << 8));
+}
+
+/*
+ * A small LZ77 codec, for blocks with a lot of repetition.
+ *
+ * The data is a series of groups, each a flag byte followed by up to eight
+ * items.  If bit `n` of the flag byte is clear the `n`th item is a single
+ * literal byte; if it is set, the item is a copy of earlier output: a
+ * two-byte distance back, then the length less LZ_MIN_MATCH.  The length
+ * of the uncompressed data must be known to the reader.
+ */
+#define LZ_MIN_MATCH	3
+#define LZ_MAX_MATCH	(255 + LZ_MIN_MATCH)
+#define LZ_WINDOW		65535
+#define LZ_HASH_SIZE	4096
+#define LZ_CHAIN		32
+
+#define LZ_HASH(p) \
+	((((p)[0] << 8) ^ ((p)[1] << 4) ^ (p)[2]) & (LZ_HASH_SIZE - 1))
+
+/*
+ * Write the `n` bytes at `data` compressed
+ */
+void wr_compressed(const byte *data, size_t n)
+{
+	s32b *head = mem_alloc(LZ_HASH_SIZE * sizeof(s32b));
+	s32b *prev = mem_alloc(MAX(n, 1) * sizeof(s32b));
+
+	byte group[1 + 8 * 3];
+	size_t group_len = 1;
+	int items = 0;
+
+	size_t i = 0, k;
+
+	for (k = 0; k < LZ_HASH_SIZE; k++)
+		head[k] = -1;
+
+	group[0] = 0;
+
+	while (i < n)
 	{
-		rd_byte(&tmp8u);
+		size_t best_len = 0, best_dist = 0;
+
+		/* Look back along the chain of earlier places with the same hash */
+		if (i + LZ_MIN_MATCH <= n)
+		{
+			s32b j = head[LZ_HASH(&data[i])];
+			int tries = LZ_CHAIN;
 
-		if (i < max) str[i] = tmp8u;
-		if (!tmp8u) break;
-	} while (++i);
+			while ((j >= 0) && (i - j <= LZ_WINDOW) && tries--)
+			{
+				size_t len = 0;
 
-	str[max - 1] = '\0';
+				while ((len < LZ_MAX_MATCH) && (i + len < n) &&
+						(data[j + len] == data[i + len]))
+					len++;
+
+				if (len > best_len)
+				{
+					best_len = len;
+					best_dist = i - j;
+					if (len == LZ_MAX_MATCH) break;
+				}
+
+				j = prev[j];
+			}
+		}
+
+		/* Add the copy or literal to the group */
+		if (best_len >= LZ_MIN_MATCH)
+		{
+			group[0] |= (1 << items);
+			group[group_len++] = (byte)(best_dist & 0xFF);
+			group[group_len++] = (byte)((best_dist >> 8) & 0xFF);
+			group[group_len++] = (byte)(best_len - LZ_MIN_MATCH);
+		}
+		else
+		{
+			best_len = 1;
+			group[group_len++] = data[i];
+		}
+
+		/* Remember where everything covered started */
+		for (k = i; k < i + best_len; k++)
+		{
+			if (k + LZ_MIN_MATCH <= n)
+			{
+				int h = LZ_HASH(&data[k]);
+
+				prev[k] = head[h];
+				head[h] = (s32b)k;
+			}
+		}
+
+		i += best_len;
+
+		/* Flush full groups */
+		if (++items == 8)
+		{
+			wr_bytes(group, group_len);
+			group[0] = 0;
+			group_len = 1;
+			items = 0;
+		}
+	}
+
+	if (items) wr_bytes(group, group_len);
+
+	mem_free(prev);
+	mem_free(head);
+}
+
+/*
+ * Read `n` bytes written by wr_compressed() into `data`, returning nonzero
+ * if they don't make sense.
+ */
+int rd_compressed(byte *data, size_t n)
+{
+	size_t pos = 0;
+
+	while (pos < n)
+	{
+		byte flags;
+		int item;
+
+		rd_byte(&flags);
+
+		for (item = 0; (item < 8) && (pos < n); item++)
+		{
+			if (flags & (1 << item))
+			{
+				u16b dist;
+				byte len8;
+				size_t len;
+
+				rd_u16b(&dist);
+				rd_byte(&len8);
+				len = len8 + LZ_MIN_MATCH;
+
+				if (!dist || (dist > pos) || (len > n - pos))
+					return -1;
+
+				for (; len; len--, pos++)
+					data[pos] = data[pos - dist];
+			}
+			else
+			{
+				rd_byte(&data[pos++]);
+			}
+		}
+	}
+
+	return 0;
 }
 
 void strip_bytes(int n)
 {
-	byte tmp8u;
-	while (n--) rd_byte(&tmp8u);
+	sf_take(n);
 }
 
 void pad_bytes(int n)
@@ -232,7 +566,65 @@ void pad_bytes(int n)
 /*** ****/
 
 
-static bool try_save(ang_file *file)
+/*
+ * Add `n` bytes to the savefile image
+ */
+static void image_add(struct save_image *img, const void *data, u32b n)
+{
+	if (img->len + n > img->size)
+	{
+		while (img->len + n > img->size)
+			img->size *= 2;
+
+		img->data = mem_realloc(img->data, img->size);
+	}
+
+	memcpy(img->data + img->len, data, n);
+	img->len += n;
+}
+
+/*
+ * Whether block `name` is one of the NULL-terminated list `wanted`; a NULL
+ * list means every block.
+ */
+static bool block_wanted(const char *name, const char *const *wanted)
+{
+	if (!wanted) return TRUE;
+
+	for (; *wanted; wanted++)
+		if (streq(*wanted, name)) return TRUE;
+
+	return FALSE;
+}
+
+/*
+ * Keep what the buffer holds as block `i` of the savefile being written
+ */
+static void base_block_keep(size_t i)
+{
+	FREE(save_base.block[i]);
+
+	save_base.block[i] = mem_alloc(buffer_pos);
+	save_base.block_len[i] = buffer_pos;
+	if (buffer_pos) memcpy(save_base.block[i], buffer, buffer_pos);
+}
+
+/*
+ * Whether the buffer holds just what the savefile on disk has as block `i`
+ */
+static bool base_block_same(size_t i)
+{
+	if (save_base.block_len[i] != buffer_pos) return FALSE;
+
+	return !buffer_pos || !memcmp(save_base.block[i], buffer, buffer_pos);
+}
+
+/*
+ * Serialise the blocks listed in `wanted` (see block_wanted()) into `img`,
+ * as `mode` says
+ */
+static bool try_save(struct save_image *img, const char *const *wanted,
+		enum save_mode mode)
 {
 	byte savefile_head[SAVEFILE_HEAD_SIZE];
 	size_t i, pos;
@@ -243,11 +635,16 @@ static bool try_save(ang_file *file)
 
 	for (i = 0; i < N_ELEMENTS(savefile_blocks); i++)
 	{
+		if (!block_wanted(savefile_blocks[i].name, wanted)) continue;
+
 		buffer_pos = 0;
 		buffer_check = 0;
 
 		savefile_blocks[i].saver();
 
+		if ((mode == SAVE_DELTA) && base_block_same(i)) continue;
+		if (mode == SAVE_FULL) base_block_keep(i);
+
 		/* 16-byte block name */
 		pos = my_strcpy((char *)savefile_head,
 				savefile_blocks[i].name,
@@ -275,13 +672,13 @@ static bool try_save(ang_file *file)
 
 		assert(pos == SAVEFILE_HEAD_SIZE);
 
-		file_write(file, (char *)savefile_head, SAVEFILE_HEAD_SIZE);
+		image_add(img, savefile_head, SAVEFILE_HEAD_SIZE);
 
-		file_write(file, (char *)buffer, buffer_pos);
+		image_add(img, buffer, buffer_pos);
 
 		/* pad to 4 byte multiples */
 		if (buffer_pos % 4)
-			file_write(file, "xxx", 4 - (buffer_pos % 4));
+			image_add(img, "xxx", 4 - (buffer_pos % 4));
 	}
 
 	mem_free(buffer);
@@ -290,97 +687,301 @@ static bool try_save(ang_file *file)
 }
 
 
-static bool try_load(ang_file *file)
+
+/*
+ * Decode a little-endian 4-byte value from a block header
+ */
+static u32b block_head_u32b(const byte *p)
 {
-	byte savefile_head[SAVEFILE_HEAD_SIZE];
-	u32b block_version, block_size, block_checksum;
+	return ((u32b) p[0]) | ((u32b) p[1] << 8) |
+			((u32b) p[2] << 16) | ((u32b) p[3] << 24);
+}
 
-	while (TRUE)
+/*
+ * Find the savefile_blocks[] entry named by block header `head`, or return
+ * N_ELEMENTS(savefile_blocks) if there isn't one
+ */
+static size_t block_head_find(const byte *head)
+{
+	size_t i;
+
+	for (i = 0; i < N_ELEMENTS(savefile_blocks); i++)
 	{
+		if (strncmp((const char *) head, savefile_blocks[i].name,
+				sizeof savefile_blocks[i].name) == 0)
+			break;
+	}
+
+	return i;
+}
+
+
+/*
+ * Load the blocks listed in `wanted` from the `len` bytes of blocks at
+ * `data`, as made by try_save(), reading them in place.
+ */
+static bool try_load_image(byte *data, u32b len, const char *const *wanted)
+{
+	u32b pos = 0;
+
+	while (pos + SAVEFILE_HEAD_SIZE <= len)
+	{
+		const byte *head = data + pos;
+		u32b block_version, block_size;
 		size_t i;
-		size_t size;
+		int err = 0;
+
+		i = block_head_find(head);
+		if (i == N_ELEMENTS(savefile_blocks)) return FALSE;
+
+		block_version = block_head_u32b(&head[16]);
+		block_size = block_head_u32b(&head[20]);
+
+		pos += SAVEFILE_HEAD_SIZE;
+		if (block_size > len - pos) return FALSE;
+
+		if (block_wanted(savefile_blocks[i].name, wanted))
+		{
+			if (sf_checksum(data + pos, block_size) !=
+					block_head_u32b(&head[24]))
+			{
+				note(format("Bad checksum in the %s block.",
+						savefile_blocks[i].name));
+				return FALSE;
+			}
+
+			buffer = data + pos;
+			buffer_size = block_size;
+			buffer_pos = 0;
+
+			err = savefile_blocks[i].loader(block_version);
+
+			buffer = NULL;
+		}
+
+		if (err) return FALSE;
+
+		/* Blocks are padded to 4 bytes */
+		pos += block_size;
+		if (block_size % 4)
+			pos += 4 - (block_size % 4);
+	}
+
+	return TRUE;
+}
+
 
-		/* Load in the next header */
-		size = file_read(file,
-				(char *)savefile_head, SAVEFILE_HEAD_SIZE);
+/*
+ * A hash of the `len` bytes at `data` (FNV-1a)
+ */
+static u32b image_hash(const byte *data, u32b len)
+{
+	u32b h = 2166136261U;
+	u32b i;
+
+	for (i = 0; i < len; i++)
+		h = (h ^ data[i]) * 16777619U;
+
+	return h;
+}
+
+/*
+ * The length of the block with header `head`, with its padding
+ */
+static u32b block_head_len(const byte *head)
+{
+	u32b size = block_head_u32b(&head[20]);
+
+	if (size % 4) size += 4 - (size % 4);
+
+	return SAVEFILE_HEAD_SIZE + size;
+}
+
+/*
+ * Find the block named like the one with header `head` among the `len`
+ * bytes of blocks at `data`, or return NULL
+ */
+static const byte *block_find(const byte *data, u32b len, const byte *head)
+{
+	u32b pos = 0;
+
+	while (pos + SAVEFILE_HEAD_SIZE <= len)
+	{
+		if (!strncmp((const char *)data + pos, (const char *)head, 16))
+			return data + pos;
+
+		pos += block_head_len(data + pos);
+	}
+
+	return NULL;
+}
+
+/*
+ * Whether the `len` bytes of blocks at `data` are whole, with none running
+ * past the end
+ */
+static bool blocks_whole(const byte *data, u32b len)
+{
+	u32b pos = 0;
+
+	while (pos + SAVEFILE_HEAD_SIZE <= len)
+	{
+		u32b n = block_head_len(data + pos);
 
-		/* If nothing was read, that's the end of the file */
-		if (size == 0) break;
+		if (n > len - pos) return FALSE;
+		pos += n;
+	}
+
+	return (pos == len);
+}
 
-		assert(size == SAVEFILE_HEAD_SIZE);
+/*
+ * Keep the blocks of savefile `data` of length `len`, from `path`, for
+ * delta saves to go with
+ */
+static void base_keep(const char *path, const byte *data, u32b len)
+{
+	u32b pos = 8;
 
-		/* 16-byte block name, null-terminated */
-		assert(savefile_head[15] == '\0');
+	while (pos + SAVEFILE_HEAD_SIZE <= len)
+	{
+		const byte *head = data + pos;
+		size_t i = block_head_find(head);
 
-		/* Determine the block ID */
-		for (i = 0; i < N_ELEMENTS(savefile_blocks); i++)
+		if (i < N_ELEMENTS(savefile_blocks))
 		{
-			if (strncmp((char *) savefile_head,
-					savefile_blocks[i].name,
-					sizeof savefile_blocks[i].name) == 0)
-				break;
+			u32b size = block_head_u32b(&head[20]);
+
+			FREE(save_base.block[i]);
+			save_base.block[i] = mem_alloc(size);
+			save_base.block_len[i] = size;
+			if (size) memcpy(save_base.block[i], head + SAVEFILE_HEAD_SIZE, size);
 		}
-		assert(i < N_ELEMENTS(savefile_blocks));
 
+		pos += block_head_len(head);
+	}
 
-		/* 4-byte block version */
-		block_version = ((u32b) savefile_head[16]) |
-				((u32b) savefile_head[17] << 8) |
-				((u32b) savefile_head[18] << 16) |
-				((u32b) savefile_head[19] << 24);
+	my_strcpy(save_base.path, path, sizeof(save_base.path));
+	save_base.wanted = NULL;
+	save_base.len = len;
+	save_base.hash = image_hash(data, len);
+	save_base.deltas = 0;
+	save_base.valid = TRUE;
+}
 
-		/* 4-byte block size */
-		block_size = ((u32b) savefile_head[20]) |
-				((u32b) savefile_head[21] << 8) |
-				((u32b) savefile_head[22] << 16) |
-				((u32b) savefile_head[23] << 24);
+/*
+ * Read the delta file for the `len` bytes of savefile at `data`, from
+ * `path`, if it has a good one, putting its length in `delta_len`
+ */
+static byte *delta_read(const char *path, const byte *data, u32b len,
+		u32b *delta_len)
+{
+	char delta_path[1024];
+	ang_file *fh;
+	const byte *map;
+	size_t map_len;
+	byte *delta = NULL;
 
-		/* 4-byte block checksum */
-		block_checksum = ((u32b) savefile_head[24]) |
-				((u32b) savefile_head[25] << 8) |
-				((u32b) savefile_head[26] << 16) |
-				((u32b) savefile_head[27] << 24);
+	strnfmt(delta_path, sizeof(delta_path), "%s.delta", path);
+	if (!file_exists(delta_path)) return NULL;
 
-		/* pad to 4 bytes */
-		if (block_size % 4)
-			block_size += 4 - (block_size % 4);
+	fh = file_open(delta_path, MODE_READ, -1);
+	if (!fh) return NULL;
 
-		/* Read stuff in */
-		buffer = mem_alloc(block_size);
-		buffer_size = block_size;
-		buffer_pos = 0;
-		buffer_check = 0;
+	map = (const byte *)file_map(fh, &map_len);
+
+	if (map && (map_len >= SAVE_DELTA_HEAD_SIZE) &&
+			!memcmp(map, savefile_magic, 4) &&
+			!memcmp(map + 4, delta_name, 4) &&
+			(block_head_u32b(map + 8) == len) &&
+			(block_head_u32b(map + 12) == image_hash(data, len)) &&
+			blocks_whole(map + SAVE_DELTA_HEAD_SIZE,
+					map_len - SAVE_DELTA_HEAD_SIZE))
+	{
+		*delta_len = map_len - SAVE_DELTA_HEAD_SIZE;
+		delta = mem_alloc(MAX(*delta_len, 1));
+		memcpy(delta, map + SAVE_DELTA_HEAD_SIZE, *delta_len);
+	}
+
+	file_close(fh);
 
-		size = file_read(file, (char *) buffer, block_size);
-		assert(size == block_size);
+	return delta;
+}
 
-		/* Try loading */
-		if (savefile_blocks[i].loader(block_version))
-			return -1;
+/*
+ * Read the current-format savefile `path` into memory, with the blocks of
+ * its delta file (if it has a good one) in place of those it replaces,
+ * returning the image (which the caller must mem_free()) and putting its
+ * length in `len`.  If `keep` is set, delta saves will go with the file.
+ */
+static byte *savefile_read(const char *path, u32b *len, bool keep)
+{
+	ang_file *fh;
+	const byte *data;
+	size_t data_len;
+	byte *delta = NULL;
+	u32b delta_len = 0;
+	byte *img = NULL;
+	u32b pos;
 
-/*		assert(buffer_check == block_checksum); */
-		mem_free(buffer);
+	fh = file_open(path, MODE_READ, -1);
+	if (!fh) return NULL;
+
+	data = (const byte *)file_map(fh, &data_len);
+
+	if (!data || (data_len < 8) || memcmp(data, savefile_magic, 4) ||
+			memcmp(data + 4, savefile_name, 4) ||
+			!blocks_whole(data + 8, data_len - 8))
+	{
+		file_close(fh);
+		return NULL;
 	}
 
-	return 0;
+	if (keep) base_keep(path, data, data_len);
+
+	delta = delta_read(path, data, data_len, &delta_len);
+	if (delta && keep) save_base.deltas = 1;
+
+	/* Each block from the delta file if it's there, else the savefile */
+	img = mem_alloc(data_len + delta_len);
+	memcpy(img, data, 8);
+	*len = 8;
+
+	for (pos = 8; pos < data_len; pos += block_head_len(data + pos))
+	{
+		const byte *head = data + pos;
+		const byte *over = delta ? block_find(delta, delta_len, head) : NULL;
+
+		if (over) head = over;
+
+		memcpy(img + *len, head, block_head_len(head));
+		*len += block_head_len(head);
+	}
+
+	FREE(delta);
+	file_close(fh);
+
+	return img;
 }
 
 
 
 
 /*
- * Attempt to save the player in a savefile
+ * Write the savefile image `img` out to its file.  This only touches the
+ * image and the filesystem, so it can run off the game thread.
  */
-bool old_save(void)
+static bool save_image_write(struct save_image *img)
 {
 	ang_file *file;
+	bool ok = FALSE;
 
 	char new_savefile[1024];
 	char old_savefile[1024];
 
 	/* New savefile */
-	strnfmt(new_savefile, sizeof(new_savefile), "%s.new", savefile);
-	strnfmt(old_savefile, sizeof(old_savefile), "%s.old", savefile);
+	strnfmt(new_savefile, sizeof(new_savefile), "%s.new", img->path);
+	strnfmt(old_savefile, sizeof(old_savefile), "%s.old", img->path);
 
 	/* Make sure that the savefile doesn't already exist */
 	safe_setuid_grab();
@@ -395,33 +996,37 @@ bool old_save(void)
 
 	if (file)
 	{
-		file_write(file, (char *) &savefile_magic, 4);
-		file_write(file, (char *) &savefile_name, 4);
-
-		character_saved = try_save(file);
-		file_close(file);
+		ok = file_write(file, (char *)img->data, img->len);
+		if (!file_close(file)) ok = FALSE;
 	}
 
-	if (character_saved)
+	if (ok)
 	{
 		bool err = FALSE;
 
 		safe_setuid_grab();
 
-		if (file_exists(savefile) && !file_move(savefile, old_savefile))
+		if (file_exists(img->path) && !file_move(img->path, old_savefile))
 			err = TRUE;
 
 		if (!err)
 		{
-			if (!file_move(new_savefile, savefile))
+			if (!file_move(new_savefile, img->path))
 				err = TRUE;
 
 			if (err)
-				file_move(old_savefile, savefile);
+				file_move(old_savefile, img->path);
 			else
 				file_delete(old_savefile);
 		}
 
+		/* Any delta file went with the old savefile */
+		if (!err && img->full)
+		{
+			strnfmt(new_savefile, sizeof(new_savefile), "%s.delta", img->path);
+			file_delete(new_savefile);
+		}
+
 		safe_setuid_drop();
 
 		return err ? FALSE : TRUE;
@@ -436,6 +1041,207 @@ bool old_save(void)
 }
 
 
+/*
+ * Free savefile image `img`
+ */
+static void save_image_free(struct save_image *img)
+{
+	mem_free(img->data);
+	FREE(img);
+}
+
+
+/*
+ * Serialise the blocks listed in `wanted` into a new savefile image bound
+ * for `path`, or (if `mode` is SAVE_DELTA) a delta file image for it
+ */
+static struct save_image *save_image_make(const char *path,
+		const char *const *wanted, enum save_mode mode)
+{
+	struct save_image *img = ZNEW(struct save_image);
+
+	img->size = 65536;
+	img->data = mem_alloc(img->size);
+
+	if (mode == SAVE_DELTA)
+	{
+		byte head[8];
+		int i;
+
+		for (i = 0; i < 4; i++)
+		{
+			head[i] = (byte)(save_base.len >> (8 * i));
+			head[4 + i] = (byte)(save_base.hash >> (8 * i));
+		}
+
+		strnfmt(img->path, sizeof(img->path), "%s.delta", path);
+		image_add(img, savefile_magic, 4);
+		image_add(img, delta_name, 4);
+		image_add(img, head, 8);
+	}
+	else
+	{
+		my_strcpy(img->path, path, sizeof(img->path));
+		image_add(img, savefile_magic, 4);
+		image_add(img, savefile_name, 4);
+	}
+
+	if (!try_save(img, wanted, mode))
+	{
+		mem_free(img->data);
+		FREE(img);
+		return NULL;
+	}
+
+	/* Delta saves now go with this */
+	if (mode == SAVE_FULL)
+	{
+		my_strcpy(save_base.path, path, sizeof(save_base.path));
+		save_base.wanted = wanted;
+		save_base.len = img->len;
+		save_base.hash = image_hash(img->data, img->len);
+		save_base.deltas = 0;
+		save_base.valid = TRUE;
+		img->full = TRUE;
+	}
+
+	return img;
+}
+
+/*
+ * Serialise the blocks listed in `wanted` into a delta file image for
+ * `path`, if the last full save was of them to `path` and the delta file
+ * is still worth having, or else into a new savefile image
+ */
+static struct save_image *save_image_make_delta(const char *path,
+		const char *const *wanted)
+{
+	struct save_image *img;
+
+	if (!save_base.valid || !streq(save_base.path, path) ||
+			(save_base.wanted != wanted) ||
+			(save_base.deltas >= SAVE_DELTA_MAX))
+		return save_image_make(path, wanted, SAVE_FULL);
+
+	img = save_image_make(path, wanted, SAVE_DELTA);
+	if (!img) return NULL;
+
+	if (img->len > save_base.len / 4 * 3)
+	{
+		save_image_free(img);
+		return save_image_make(path, wanted, SAVE_FULL);
+	}
+
+	save_base.deltas++;
+
+	return img;
+}
+
+/*
+ * The savefile being written in the background, if any
+ */
+static struct save_image *save_pending;
+
+#ifdef HAVE_PTHREAD_H
+static pthread_t save_thread;
+
+static void *save_thread_main(void *arg)
+{
+	struct save_image *img = arg;
+
+	img->ok = save_image_write(img);
+
+	return NULL;
+}
+#endif
+
+
+/*
+ * Wait for any savefile being written in the background to be finished,
+ * returning FALSE if writing it failed.
+ */
+bool old_save_wait(void)
+{
+	bool ok;
+
+	if (!save_pending) return TRUE;
+
+#ifdef HAVE_PTHREAD_H
+	pthread_join(save_thread, NULL);
+#endif
+
+	ok = save_pending->ok;
+	save_image_free(save_pending);
+	save_pending = NULL;
+
+	/* Don't lay deltas over a savefile that may not be there */
+	if (!ok) save_base.valid = FALSE;
+
+	return ok;
+}
+
+
+/*
+ * Attempt to save the player in a savefile
+ */
+bool old_save(void)
+{
+	struct save_image *img;
+	bool ok;
+
+	/* Don't race a background save to the file */
+	old_save_wait();
+
+	img = save_image_make(savefile, NULL, SAVE_FULL);
+	character_saved = (img != NULL);
+	if (!img) return FALSE;
+
+	ok = save_image_write(img);
+	save_image_free(img);
+
+	if (!ok) save_base.valid = FALSE;
+
+	return ok;
+}
+
+
+/*
+ * Save the player as old_save() does, but only take the snapshot of the
+ * game before returning, and leave writing it out to a background thread
+ * where there is one.  A failure to write it is reported by the next call
+ * to old_save_wait().  Only what has changed since the last full save is
+ * written, where that's worth doing.
+ */
+bool old_save_background(void)
+{
+	struct save_image *img;
+	bool ok;
+
+	/* One at a time */
+	if (!old_save_wait()) return FALSE;
+
+	img = save_image_make_delta(savefile, NULL);
+	character_saved = (img != NULL);
+	if (!img) return FALSE;
+
+#ifdef HAVE_PTHREAD_H
+	if (pthread_create(&save_thread, NULL, save_thread_main, img) == 0)
+	{
+		save_pending = img;
+		return TRUE;
+	}
+#endif
+
+	/* No thread, so write it now */
+	ok = save_image_write(img);
+	save_image_free(img);
+
+	if (!ok) save_base.valid = FALSE;
+
+	return ok;
+}
+
+
 
 /*
  * Attempt to Load a "savefile"
@@ -466,6 +1272,8 @@ bool old_load(void)
 	/* Clear screen */
 	Term_clear();
 
+	/* Let any background save finish first */
+	old_save_wait();
 
 	fh = file_open(savefile, MODE_READ, -1);
 	if (!fh)
@@ -506,9 +1314,19 @@ bool old_load(void)
 			}
 			else
 			{
-				err = try_load(fh);
+				byte *img;
+				u32b len;
+
 				file_close(fh);
-				if (!err) what = "cannot read savefile";
+
+				img = savefile_read(savefile, &len, TRUE);
+				if (!img || !try_load_image(img + 8, len - 8, NULL))
+				{
+					err = -1;
+					what = "Cannot read savefile";
+				}
+
+				FREE(img);
 			}
 		}
 		else if (sf_major == 3 && sf_minor == 0 &&
@@ -558,3 +1376,140 @@ bool old_load(void)
 	/* Oops */
 	return (FALSE);
 }
+
+
+/*
+ * Write a savefile `path` holding only the blocks named in the
+ * NULL-terminated list `blocks`.  This is for tests and tools; a savefile
+ * missing blocks won't restore a whole game.
+ */
+bool savefile_save_blocks(const char *path, const char *const *blocks)
+{
+	struct save_image *img;
+	bool ok;
+
+	img = save_image_make(path, blocks, SAVE_FULL);
+	if (!img) return FALSE;
+
+	ok = save_image_write(img);
+	save_image_free(img);
+
+	if (!ok) save_base.valid = FALSE;
+
+	return ok;
+}
+
+/*
+ * Save the blocks named in `blocks` as savefile_save_blocks() does, but
+ * as an autosave would: only those changed since the last full save, if
+ * that was of the same blocks to `path`.
+ */
+bool savefile_save_blocks_delta(const char *path, const char *const *blocks)
+{
+	struct save_image *img;
+	bool ok;
+
+	img = save_image_make_delta(path, blocks);
+	if (!img) return FALSE;
+
+	ok = save_image_write(img);
+	save_image_free(img);
+
+	if (!ok) save_base.valid = FALSE;
+
+	return ok;
+}
+
+/*
+ * Load only the blocks named in the NULL-terminated list `blocks` from
+ * savefile `path`, for tools that want to look at a character without
+ * setting up the whole game.  Only current-format savefiles are read.
+ */
+bool savefile_load_blocks(const char *path, const char *const *blocks)
+{
+	byte *img;
+	u32b len;
+	bool ok;
+
+	img = savefile_read(path, &len, FALSE);
+	if (!img) return FALSE;
+
+	ok = try_load_image(img + 8, len - 8, blocks);
+	mem_free(img);
+
+	return ok;
+}
+
+
+/*
+ * The blocks which make up a level, for the level cache
+ */
+static const char *const level_blocks[] =
+{
+	"dungeon", "objects", "monsters", NULL
+};
+
+/*
+ * Serialise the current level into memory, returning the data (which the
+ * caller must mem_free()) and putting its length in `len`.  Note that,
+ * like saving, this compacts the object and monster lists.
+ */
+byte *savefile_save_level(u32b *len)
+{
+	struct save_image img;
+
+	WIPE(&img, struct save_image);
+	img.size = 16384;
+	img.data = mem_alloc(img.size);
+
+	if (!try_save(&img, level_blocks, SAVE_PLAIN))
+	{
+		mem_free(img.data);
+		return NULL;
+	}
+
+	*len = img.len;
+	return img.data;
+}
+
+/*
+ * Load a level made by savefile_save_level() into a cleared cave.  The
+ * player ends up where they were when it was saved.
+ */
+bool savefile_load_level(byte *data, u32b len)
+{
+	return try_load_image(data, len, level_blocks);
+}
+
+
+/*
+ * Print a summary of the character in savefile `path` to stdout, reading
+ * nothing but the player, misc and history blocks.
+ */
+bool savefile_describe(const char *path)
+{
+	static const char *const blocks[] = { "player", "misc", "history", NULL };
+	size_t i;
+
+	if (!savefile_load_blocks(path, blocks))
+	{
+		printf("%s: can't read savefile\n", path);
+		return FALSE;
+	}
+
+	printf("name: %s\n", op_ptr->full_name);
+	printf("race: %s\n", p_ptr->race->name);
+	printf("class: %s\n", p_ptr->class->name);
+	printf("level: %d (max %d)\n", p_ptr->lev, p_ptr->max_lev);
+	printf("exp: %ld (max %ld)\n", (long)p_ptr->exp, (long)p_ptr->max_exp);
+	printf("max depth: %d\n", p_ptr->max_depth);
+	printf("turn: %ld\n", (long)turn);
+	printf("status: %s\n", p_ptr->died_from);
+
+	for (i = 0; i < history_get_num(); i++)
+		printf("history: %ld %d %d %s\n", (long)history_list[i].turn,
+				history_list[i].dlev, history_list[i].clev,
+				history_list[i].event);
+
+	return TRUE;
+}
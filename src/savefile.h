@@ -10,6 +10,20 @@ int rd_savefile_old(void);
 /* Utility */
 void note(cptr msg);
 bool older_than(int x, int y, int z);
+byte lore_default_max_num(int r_idx);
+
+/*
+ * The parts of a race's entry in the "monster memory" block (from version
+ * 2), which only has entries for the races with something to remember
+ */
+#define LORE_COUNTS		0x01	/* Sights, deaths and kills */
+#define LORE_WAKE		0x02	/* Wakes and ignores */
+#define LORE_DROPS		0x04	/* Most gold and items dropped */
+#define LORE_CASTS		0x08	/* Most spells seen */
+#define LORE_BLOWS		0x10	/* Blows seen */
+#define LORE_FLAGS		0x20	/* Flags known */
+#define LORE_SPELLS		0x40	/* Spell flags known */
+#define LORE_MAX_NUM	0x80	/* Monster limit, if not the usual */
 
 /* Writing bits */
 void wr_byte(byte v);
@@ -18,6 +32,9 @@ void wr_s16b(s16b v);
 void wr_u32b(u32b v);
 void wr_s32b(s32b v);
 void wr_string(cptr str);
+void wr_bytes(const byte *v, size_t n);
+void wr_s16b_array(const s16b *v, size_t n);
+void wr_compressed(const byte *data, size_t n);
 void pad_bytes(int n);
 
 /* Reading bits */
@@ -27,6 +44,9 @@ void rd_s16b(s16b *ip);
 void rd_u32b(u32b *ip);
 void rd_s32b(s32b *ip);
 void rd_string(char *str, int max);
+void rd_bytes(byte *v, size_t n);
+void rd_s16b_array(s16b *v, size_t n);
+int rd_compressed(byte *data, size_t n);
 void strip_bytes(int n);
 
 
@@ -75,5 +95,9 @@ void wr_monsters(void);
 void wr_ghost(void);
 void wr_history(void);
 
+/* level-cache.c */
+int rd_levels(u32b version);
+void wr_levels(void);
+
 
 #endif /* INCLUDED_SAVEFILE_H */
@@ -68,31 +68,11 @@ static long total_points(void)
 
 
 /*
- * Read in a highscore file.
+ * Deaths are appended to scores.log, which is only folded into the sorted
+ * scores.raw once it holds this many, so most deaths don't rewrite the
+ * whole table.
  */
-static size_t highscore_read(high_score scores[], size_t sz)
-{
-	char fname[1024];
-	ang_file *scorefile;
-	size_t i;
-
-	/* Wipe current scores */
-	C_WIPE(scores, sz, high_score);
-
-	path_build(fname, sizeof(fname), ANGBAND_DIR_APEX, "scores.raw");
-	scorefile = file_open(fname, MODE_READ, -1);
-
-	if (!scorefile) return TRUE;
-
-	for (i = 0; i < sz &&
-			file_read(scorefile, (char *)&scores[i], sizeof(high_score)) > 0;
-			i++)
-		;
-
-	file_close(scorefile);
-
-	return i;
-}
+#define SCORE_LOG_MAX	16
 
 
 /*
@@ -101,23 +81,26 @@ static size_t highscore_read(high_score scores[], size_t sz)
  */
 static size_t highscore_where(const high_score *entry, const high_score scores[], size_t sz)
 {
-	size_t i;
-
-	/* Read until we get to a higher score */
-	for (i = 0; i < sz; i++)
+	long entry_pts = strtoul(entry->pts, NULL, 0);
+	size_t lo = 0, hi = sz;
+
+	/*
+	 * Find the first empty entry or one with no more points than ours;
+	 * the scores are sorted highest first, with the empty entries last.
+	 */
+	while (lo < hi)
 	{
-		long entry_pts = strtoul(entry->pts, NULL, 0);
-		long score_pts = strtoul(scores[i].pts, NULL, 0);
+		size_t mid = lo + (hi - lo) / 2;
 
-		if (entry_pts >= score_pts)
-			return i;
-
-		if (scores[i].what[0] == '\0')
-			return i;
+		if (scores[mid].what[0] == '\0' ||
+				entry_pts >= (long)strtoul(scores[mid].pts, NULL, 0))
+			hi = mid;
+		else
+			lo = mid + 1;
 	}
 
 	/* The last entry is always usable */
-	return sz - 1;
+	return (lo < sz) ? lo : sz - 1;
 }
 
 static size_t highscore_add(const high_score *entry, high_score scores[], size_t sz)
@@ -143,37 +126,64 @@ static size_t highscore_count(const high_score scores[], size_t sz)
 
 
 /*
- * Actually place an entry into the high score file
- * Return the location (0 is best) or -1 on "failure"
+ * Read in a highscore file, along with any deaths logged since it was
+ * written.
  */
-static void highscore_write(const high_score scores[], size_t sz)
+static size_t highscore_read(high_score scores[], size_t sz)
 {
-	size_t n;
-
-	ang_file *lok;
+	char fname[1024];
 	ang_file *scorefile;
+	high_score entry;
+	size_t i;
 
-	char old_name[1024];
-	char cur_name[1024];
-	char new_name[1024];
-	char lok_name[1024];
+	/* Wipe current scores */
+	C_WIPE(scores, sz, high_score);
 
-	path_build(old_name, sizeof(old_name), ANGBAND_DIR_APEX, "scores.old");
-	path_build(cur_name, sizeof(cur_name), ANGBAND_DIR_APEX, "scores.raw");
-	path_build(new_name, sizeof(new_name), ANGBAND_DIR_APEX, "scores.new");
-	path_build(lok_name, sizeof(lok_name), ANGBAND_DIR_APEX, "scores.lok");
+	path_build(fname, sizeof(fname), ANGBAND_DIR_APEX, "scores.raw");
+	scorefile = file_open(fname, MODE_READ, -1);
 
+	if (scorefile)
+	{
+		for (i = 0; i < sz &&
+				file_read(scorefile, (char *)&scores[i], sizeof(high_score)) > 0;
+				i++)
+			;
 
-	/* Read in and add new score */
-	n = highscore_count(scores, sz);
+		file_close(scorefile);
+	}
+
+	/* Place the logged deaths, oldest first */
+	path_build(fname, sizeof(fname), ANGBAND_DIR_APEX, "scores.log");
+	scorefile = file_open(fname, MODE_READ, -1);
+
+	if (scorefile)
+	{
+		while (file_read(scorefile, (char *)&entry, sizeof(entry)) ==
+				sizeof(entry))
+			highscore_add(&entry, scores, sz);
+
+		file_close(scorefile);
+	}
+
+	return highscore_count(scores, sz);
+}
 
 
-	/*** Lock scores ***/
+/*
+ * Take the lock on the scorefile, returning NULL after saying why if it
+ * can't be had.
+ */
+static ang_file *highscore_lock(void)
+{
+	ang_file *lok;
+	char lok_name[1024];
+
+	path_build(lok_name, sizeof(lok_name), ANGBAND_DIR_APEX, "scores.lok");
 
 	if (file_exists(lok_name))
 	{
 		msg_print("Lock file in place for scorefile; not writing.");
-		return;
+		return NULL;
 	}
 
 	safe_setuid_grab();
@@ -182,10 +192,50 @@ static void highscore_write(const high_score scores[], size_t sz)
 	safe_setuid_drop();
 
 	if (!lok)
-	{
 		msg_print("Failed to create lock for scorefile; not writing.");
-		return;
-	}
+
+	return lok;
+}
+
+/*
+ * Release the lock taken by highscore_lock()
+ */
+static void highscore_unlock(ang_file *lok)
+{
+	char lok_name[1024];
+
+	path_build(lok_name, sizeof(lok_name), ANGBAND_DIR_APEX, "scores.lok");
+
+	safe_setuid_grab();
+	file_close(lok);
+	file_delete(lok_name);
+	safe_setuid_drop();
+}
+
+
+/*
+ * Write out the whole table, which must include everything in scores.log,
+ * and empty the log.  The caller must hold the lock.
+ */
+static void highscore_write(const high_score scores[], size_t sz)
+{
+	size_t n;
+
+	ang_file *scorefile;
+
+	char old_name[1024];
+	char cur_name[1024];
+	char new_name[1024];
+	char log_name[1024];
+
+	path_build(old_name, sizeof(old_name), ANGBAND_DIR_APEX, "scores.old");
+	path_build(cur_name, sizeof(cur_name), ANGBAND_DIR_APEX, "scores.raw");
+	path_build(new_name, sizeof(new_name), ANGBAND_DIR_APEX, "scores.new");
+	path_build(log_name, sizeof(log_name), ANGBAND_DIR_APEX, "scores.log");
+
+
+	/* Read in and add new score */
+	n = highscore_count(scores, sz);
 
 
 	/*** Open the new file for writing ***/
@@ -197,9 +247,6 @@ static void highscore_write(const high_score scores[], size_t sz)
 	if (!scorefile)
 	{
 		msg_print("Failed to open new scorefile for writing.");
-
-		file_close(lok);
-		file_delete(lok_name);
 		return;
 	}
 
@@ -219,14 +266,69 @@ static void highscore_write(const high_score scores[], size_t sz)
 	if (!file_move(new_name, cur_name))
 		msg_print("Couldn't rename new scorefile to scores.raw");
 
-	/* Remove the lock */
-	file_close(lok);
-	file_delete(lok_name);
+	/* The log is part of scores.raw now */
+	else if (file_exists(log_name))
+		file_delete(log_name);
 
 	safe_setuid_drop();
 }
 
 
+/*
+ * Record a new score by appending it to scores.log, folding the log into
+ * scores.raw when it gets too long.
+ */
+static void highscore_append(const high_score *entry)
+{
+	ang_file *lok;
+	ang_file *logfile;
+	high_score tmp;
+	size_t logged = 0;
+
+	char log_name[1024];
+
+	path_build(log_name, sizeof(log_name), ANGBAND_DIR_APEX, "scores.log");
+
+	lok = highscore_lock();
+	if (!lok) return;
+
+	safe_setuid_grab();
+	logfile = file_open(log_name, MODE_APPEND, FTYPE_RAW);
+	safe_setuid_drop();
+
+	if (!logfile)
+	{
+		msg_print("Failed to open scores.log for writing.");
+		highscore_unlock(lok);
+		return;
+	}
+
+	file_write(logfile, (const char *)entry, sizeof(high_score));
+	file_close(logfile);
+
+	/* See how long the log has got */
+	logfile = file_open(log_name, MODE_READ, -1);
+	if (logfile)
+	{
+		while (file_read(logfile, (char *)&tmp, sizeof(tmp)) == sizeof(tmp))
+			logged++;
+
+		file_close(logfile);
+	}
+
+	/* Fold it into the table */
+	if (logged >= SCORE_LOG_MAX)
+	{
+		high_score scores[MAX_HISCORES];
+
+		highscore_read(scores, N_ELEMENTS(scores));
+		highscore_write(scores, N_ELEMENTS(scores));
+	}
+
+	highscore_unlock(lok);
+}
+
+
 
 /*
  * Display the scores in a given range.
@@ -453,13 +555,9 @@ void enter_score(time_t *death_time)
 	else
 	{
 		high_score entry;
-		high_score scores[MAX_HISCORES];
 
 		build_score(&entry, p_ptr->died_from, death_time);
-
-		highscore_read(scores, N_ELEMENTS(scores));
-		highscore_add(&entry, scores, N_ELEMENTS(scores));
-		highscore_write(scores, N_ELEMENTS(scores));
+		highscore_append(&entry);
 	}
 
 	/* Success */
@@ -33,12 +33,19 @@ static bool no_cache_audio = FALSE;
 /* Arbitary limit on number of samples per event */
 #define MAX_SAMPLES      8
 
+/*
+ * Arbitrary limit on the memory used by samples loaded as they are played,
+ * when the audio cache is disabled
+ */
+#define SAMPLE_CACHE_BYTES	(4L * 1024L * 1024L)
+
 /* Struct representing all data about an event sample */
 typedef struct
 {
 	int num;                        /* Number of samples for this event */
 	Mix_Chunk *wavs[MAX_SAMPLES];   /* Sample array */
 	char *paths[MAX_SAMPLES]; /* Relative pathnames for samples */
+	u32b played[MAX_SAMPLES];       /* When each sample was last played */
 } sample_list;
 
 
@@ -47,6 +54,82 @@ typedef struct
  */
 static sample_list samples[MSG_MAX];
 
+/* Count of samples played, for sample_list.played */
+static u32b samples_played;
+
+/* Bytes of samples loaded as they were played */
+static long sample_bytes;
+
+/* The sample playing on each channel, if any */
+static Mix_Chunk *channel_wavs[MIX_CHANNELS];
+
+
+/*
+ * Note that a channel has finished playing.
+ *
+ * This is called from the mixer's own thread, so only clears a pointer.
+ */
+static void channel_finished(int channel)
+{
+	if ((channel >= 0) && (channel < MIX_CHANNELS))
+		channel_wavs[channel] = NULL;
+}
+
+
+/*
+ * Check whether sample "wave" is playing on any channel.
+ */
+static bool sample_playing(Mix_Chunk *wave)
+{
+	int i;
+
+	for (i = 0; i < MIX_CHANNELS; i++)
+	{
+		if (channel_wavs[i] == wave) return TRUE;
+	}
+
+	return FALSE;
+}
+
+
+/*
+ * Free the least recently played samples which aren't playing now, until
+ * those loaded as they were played fit in SAMPLE_CACHE_BYTES.
+ */
+static void trim_samples(void)
+{
+	while (sample_bytes > SAMPLE_CACHE_BYTES)
+	{
+		sample_list *oldest = NULL;
+		int i, j, oldest_j = 0;
+
+		/* Find the least recently played sample */
+		for (i = 0; i < MSG_MAX; i++)
+		{
+			sample_list *smp = &samples[i];
+
+			for (j = 0; j < smp->num; j++)
+			{
+				if (!smp->wavs[j] || sample_playing(smp->wavs[j])) continue;
+
+				if (!oldest || (smp->played[j] < oldest->played[oldest_j]))
+				{
+					oldest = smp;
+					oldest_j = j;
+				}
+			}
+		}
+
+		/* Everything left is playing */
+		if (!oldest) return;
+
+		/* Free it, to be loaded again next time */
+		sample_bytes -= oldest->wavs[oldest_j]->alen;
+		Mix_FreeChunk(oldest->wavs[oldest_j]);
+		oldest->wavs[oldest_j] = NULL;
+	}
+}
+
 
 /*
  * Shut down the sound system and free resources.
@@ -105,6 +188,9 @@ static bool open_audio(void)
 		return FALSE;
 	}
 
+	/* Keep track of what is playing where */
+	Mix_ChannelFinished(channel_finished);
+
 	/* Success */
 	return TRUE;
 }
@@ -112,10 +198,10 @@ static bool open_audio(void)
 
 
 /*
- * Read sound.cfg and map events to sounds; then load all the sounds into
- * memory to avoid I/O latency later.
+ * Read sound.cfg and map events to sounds.  Each sound is only loaded the
+ * first time it's played, so that starting up doesn't wait for all of them.
  */
-static bool sound_sdl_init(bool no_cache)
+static bool sound_sdl_init(void)
 {
 	char path[2048];
 	char buffer[2048];
@@ -209,22 +295,8 @@ static bool sound_sdl_init(bool no_cache)
 			path_build(path, sizeof(path), ANGBAND_DIR_XTRA_SOUND, cur_token);
 			if (!file_exists(path)) goto next_token;
 
-			/* Don't load now if we're not caching */
-			if (no_cache)
-			{
-				/* Just save the path for later */
-				samples[event].paths[num] = string_make(path);
-			}
-			else
-			{
-				/* Load the file now */
-				samples[event].wavs[num] = Mix_LoadWAV(path);
-				if (!samples[event].wavs[num])
-				{
-					plog_fmt("%s: %s", SDL_GetError(), strerror(errno));
-					goto next_token;
-				}
-			}
+			/* Save the path for when it's played */
+			samples[event].paths[num] = string_make(path);
 
 			/* Imcrement the sample count */
 			samples[event].num++;
@@ -267,7 +339,7 @@ static bool sound_sdl_init(bool no_cache)
 static void play_sound(int event)
 {
 	Mix_Chunk *wave = NULL;
-	int s;
+	int s, channel;
 
 	/* Paranoia */
 	if (event < 0 || event >= MSG_MAX) return;
@@ -279,15 +351,20 @@ static void play_sound(int event)
 	s = randint0(samples[event].num);
 	wave = samples[event].wavs[s];
 
-	/* Try loading it, if it's not cached */
+	/* Try loading it, if it's not loaded yet */
 	if (!wave)
 	{
 		/* Verify it exists */
 		const char *filename = samples[event].paths[s];
 		if (!file_exists(filename)) return;
 
-		/* Load */
+		/* Load, and keep it for next time */
 		wave = Mix_LoadWAV(filename);
+		if (wave)
+		{
+			samples[event].wavs[s] = wave;
+			sample_bytes += wave->alen;
+		}
 	}
 
 	/* Check to see if we have a wave again */
@@ -298,7 +375,13 @@ static void play_sound(int event)
 	}
 
 	/* Actually play the thing */
-	Mix_PlayChannel(-1, wave, 0);
+	samples[event].played[s] = ++samples_played;
+	channel = Mix_PlayChannel(-1, wave, 0);
+	if ((channel >= 0) && (channel < MIX_CHANNELS))
+		channel_wavs[channel] = wave;
+
+	/* Make room for the samples played next, unless keeping them all */
+	if (no_cache_audio) trim_samples();
 }
 
 
@@ -321,7 +404,7 @@ errr init_sound_sdl(int argc, char **argv)
 	}
 
 	/* Load sound preferences if requested */
-	if (!sound_sdl_init(no_cache_audio))
+	if (!sound_sdl_init())
 	{
 		plog("Failed to load sound config");
 
@@ -21,6 +21,7 @@
 #include "generate.h"
 #include "object/tvalsval.h"
 #include "object/object.h"
+#include "perf.h"
 #include "monster/constants.h"
 #include "monster/monster.h"
 #include "squelch.h"
@@ -75,74 +76,131 @@ s16b poly_r_idx(int r_idx)
 
 
 /*
- * Teleport a monster, normally up to "dis" grids away.
- *
- * Attempt to move the monster at least "dis/2" grids away.
- *
- * But allow variation to prevent infinite loops.
+ * Grids a teleport could land on, as GRID() values
  */
-void teleport_away(int m_idx, int dis)
+static u16b teleport_grids[DUNGEON_HGT * DUNGEON_WID];
+
+
+/*
+ * Grids a monster may be teleported to
+ */
+static bool teleport_ok_monster(int y, int x)
 {
-	int ny = 0, nx = 0, oy, ox, d, i, min;
+	/* Require "empty" floor space */
+	if (!cave_empty_bold(y, x)) return FALSE;
 
-	bool look = TRUE;
+	/* Hack -- no teleport onto glyph of warding */
+	if (cave->grid[y][x].feat == FEAT_GLYPH) return FALSE;
 
-	monster_type *m_ptr = &mon_list[m_idx];
+	/* No teleporting into vaults and such */
+	/* if (cave->grid[y][x].info & (CAVE_ICKY)) return FALSE; */
 
+	return TRUE;
+}
 
-	/* Paranoia */
-	if (!m_ptr->r_idx) return;
 
-	/* Save the old location */
-	oy = m_ptr->fy;
-	ox = m_ptr->fx;
+/*
+ * Grids the player may be teleported to
+ */
+static bool teleport_ok_player(int y, int x)
+{
+	/* Require "naked" floor space */
+	if (!cave_naked_bold(y, x)) return FALSE;
+
+	/* No teleporting into vaults and such */
+	if (cave->grid[y][x].info & (CAVE_ICKY)) return FALSE;
+
+	return TRUE;
+}
+
 
-	/* Minimum distance */
-	min = dis / 2;
+/*
+ * Pick a grid between "dis/2" and "dis" grids from (y0, x0) which "ok"
+ * accepts, putting it in (*ty, *tx).
+ *
+ * Every such grid is equally likely.  If there are none, the distance is
+ * doubled and the minimum halved until there are, so this only fails if
+ * there is no grid "ok" accepts anywhere within 200 grids.
+ */
+static bool teleport_find(int y0, int x0, int dis, bool (*ok)(int y, int x),
+		int *ty, int *tx)
+{
+	int min = dis / 2;
 
-	/* Look until done */
-	while (look)
+	while (1)
 	{
+		int y, x, y1, y2, x1, x2;
+		int n = 0;
+
 		/* Verify max distance */
 		if (dis > 200) dis = 200;
+		if (dis < 1) dis = 1;
 
-		/* Try several locations */
-		for (i = 0; i < 500; i++)
+		/* Only look at legal grids */
+		y1 = MAX(y0 - dis, 1);
+		y2 = MIN(y0 + dis, cave->height - 2);
+		x1 = MAX(x0 - dis, 1);
+		x2 = MIN(x0 + dis, cave->width - 2);
+
+		/* Collect every grid that will do */
+		for (y = y1; y <= y2; y++)
 		{
-			/* Pick a (possibly illegal) location */
-			while (1)
+			for (x = x1; x <= x2; x++)
 			{
-				ny = rand_spread(oy, dis);
-				nx = rand_spread(ox, dis);
-				d = distance(oy, ox, ny, nx);
-				if ((d >= min) && (d <= dis)) break;
-			}
+				int d = distance(y0, x0, y, x);
 
-			/* Ignore illegal locations */
-			if (!in_bounds_fully(ny, nx)) continue;
+				if ((d < min) || (d > dis)) continue;
+				if (!ok(y, x)) continue;
 
-			/* Require "empty" floor space */
-			if (!cave_empty_bold(ny, nx)) continue;
-
-			/* Hack -- no teleport onto glyph of warding */
-			if (cave_feat[ny][nx] == FEAT_GLYPH) continue;
-
-			/* No teleporting into vaults and such */
-			/* if (cave_info[ny][nx] & (CAVE_ICKY)) continue; */
+				teleport_grids[n++] = GRID(y, x);
+			}
+		}
 
-			/* This grid looks good */
-			look = FALSE;
+		/* Pick one */
+		if (n)
+		{
+			int g = teleport_grids[randint0(n)];
 
-			/* Stop looking */
-			break;
+			*ty = GRID_Y(g);
+			*tx = GRID_X(g);
+			return TRUE;
 		}
 
+		/* Nowhere left to look */
+		if ((dis == 200) && !min) return FALSE;
+
 		/* Increase the maximum distance */
 		dis = dis * 2;
 
 		/* Decrease the minimum distance */
 		min = min / 2;
 	}
+}
+
+
+/*
+ * Teleport a monster, normally up to "dis" grids away.
+ *
+ * Attempt to move the monster at least "dis/2" grids away.
+ *
+ * But allow variation to prevent infinite loops.
+ */
+void teleport_away(int m_idx, int dis)
+{
+	int ny, nx, oy, ox;
+
+	monster_type *m_ptr = &mon_list[m_idx];
+
+
+	/* Paranoia */
+	if (!m_ptr->r_idx) return;
+
+	/* Save the old location */
+	oy = m_ptr->fy;
+	ox = m_ptr->fx;
+
+	/* Find somewhere to go */
+	if (!teleport_find(oy, ox, dis, teleport_ok_monster, &ny, &nx)) return;
 
 	/* Sound */
 	sound(MSG_TPOTHER);
@@ -163,58 +221,11 @@ void teleport_player(int dis)
 	int py = p_ptr->py;
 	int px = p_ptr->px;
 
-	int d, i, min, y, x;
-
-	bool look = TRUE;
-
-
-	/* Initialize */
-	y = py;
-	x = px;
-
-	/* Minimum distance */
-	min = dis / 2;
-
-	/* Look until done */
-	while (look)
-	{
-		/* Verify max distance */
-		if (dis > 200) dis = 200;
-
-		/* Try several locations */
-		for (i = 0; i < 500; i++)
-		{
-			/* Pick a (possibly illegal) location */
-			while (1)
-			{
-				y = rand_spread(py, dis);
-				x = rand_spread(px, dis);
-				d = distance(py, px, y, x);
-				if ((d >= min) && (d <= dis)) break;
-			}
-
-			/* Ignore illegal locations */
-			if (!in_bounds_fully(y, x)) continue;
-
-			/* Require "naked" floor space */
-			if (!cave_naked_bold(y, x)) continue;
-
-			/* No teleporting into vaults and such */
-			if (cave_info[y][x] & (CAVE_ICKY)) continue;
-
-			/* This grid looks good */
-			look = FALSE;
+	int y, x;
 
-			/* Stop looking */
-			break;
-		}
 
-		/* Increase the maximum distance */
-		dis = dis * 2;
-
-		/* Decrease the minimum distance */
-		min = min / 2;
-	}
+	/* Find somewhere to go */
+	if (!teleport_find(py, px, dis, teleport_ok_player, &y, &x)) return;
 
 	/* Sound */
 	sound(MSG_TELEPORT);
@@ -1398,7 +1409,7 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 		case GF_KILL_TRAP:
 		{
 			/* Reveal secret doors */
-			if (cave_feat[y][x] == FEAT_SECRET)
+			if (cave->grid[y][x].feat == FEAT_SECRET)
 			{
 				place_closed_door(y, x);
 
@@ -1410,9 +1421,9 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 			}
 
 			/* Destroy traps */
-			if ((cave_feat[y][x] == FEAT_INVIS) ||
-			    ((cave_feat[y][x] >= FEAT_TRAP_HEAD) &&
-			     (cave_feat[y][x] <= FEAT_TRAP_TAIL)))
+			if ((cave->grid[y][x].feat == FEAT_INVIS) ||
+			    ((cave->grid[y][x].feat >= FEAT_TRAP_HEAD) &&
+			     (cave->grid[y][x].feat <= FEAT_TRAP_TAIL)))
 			{
 				/* Check line of sight */
 				if (player_has_los_bold(y, x))
@@ -1422,15 +1433,15 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 				}
 
 				/* Forget the trap */
-				cave_info[y][x] &= ~(CAVE_MARK);
+				cave->grid[y][x].info &= ~(CAVE_MARK);
 
 				/* Destroy the trap */
 				cave_set_feat(y, x, FEAT_FLOOR);
 			}
 
 			/* Locked doors are unlocked */
-			else if ((cave_feat[y][x] >= FEAT_DOOR_HEAD + 0x01) &&
-			          (cave_feat[y][x] <= FEAT_DOOR_HEAD + 0x07))
+			else if ((cave->grid[y][x].feat >= FEAT_DOOR_HEAD + 0x01) &&
+			          (cave->grid[y][x].feat <= FEAT_DOOR_HEAD + 0x07))
 			{
 				/* Unlock the door */
 				cave_set_feat(y, x, FEAT_DOOR_HEAD + 0x00);
@@ -1450,13 +1461,13 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 		case GF_KILL_DOOR:
 		{
 			/* Destroy all doors and traps */
-			if ((cave_feat[y][x] == FEAT_OPEN) ||
-			    (cave_feat[y][x] == FEAT_BROKEN) ||
-			    (cave_feat[y][x] == FEAT_INVIS) ||
-			    ((cave_feat[y][x] >= FEAT_TRAP_HEAD) &&
-			     (cave_feat[y][x] <= FEAT_TRAP_TAIL)) ||
-			    ((cave_feat[y][x] >= FEAT_DOOR_HEAD) &&
-			     (cave_feat[y][x] <= FEAT_DOOR_TAIL)))
+			if ((cave->grid[y][x].feat == FEAT_OPEN) ||
+			    (cave->grid[y][x].feat == FEAT_BROKEN) ||
+			    (cave->grid[y][x].feat == FEAT_INVIS) ||
+			    ((cave->grid[y][x].feat >= FEAT_TRAP_HEAD) &&
+			     (cave->grid[y][x].feat <= FEAT_TRAP_TAIL)) ||
+			    ((cave->grid[y][x].feat >= FEAT_DOOR_HEAD) &&
+			     (cave->grid[y][x].feat <= FEAT_DOOR_TAIL)))
 			{
 				/* Check line of sight */
 				if (player_has_los_bold(y, x))
@@ -1466,8 +1477,8 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 					obvious = TRUE;
 
 					/* Visibility change */
-					if ((cave_feat[y][x] >= FEAT_DOOR_HEAD) &&
-					    (cave_feat[y][x] <= FEAT_DOOR_TAIL))
+					if ((cave->grid[y][x].feat >= FEAT_DOOR_HEAD) &&
+					    (cave->grid[y][x].feat <= FEAT_DOOR_TAIL))
 					{
 						/* Update the visuals */
 						p_ptr->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
@@ -1475,7 +1486,7 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 				}
 
 				/* Forget the door */
-				cave_info[y][x] &= ~(CAVE_MARK);
+				cave->grid[y][x].info &= ~(CAVE_MARK);
 
 				/* Destroy the feature */
 				cave_set_feat(y, x, FEAT_FLOOR);
@@ -1491,30 +1502,30 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 			if (cave_floor_bold(y, x)) break;
 
 			/* Permanent walls */
-			if (cave_feat[y][x] >= FEAT_PERM_EXTRA) break;
+			if (cave->grid[y][x].feat >= FEAT_PERM_EXTRA) break;
 
 			/* Granite */
-			if (cave_feat[y][x] >= FEAT_WALL_EXTRA)
+			if (cave->grid[y][x].feat >= FEAT_WALL_EXTRA)
 			{
 				/* Message */
-				if (cave_info[y][x] & (CAVE_MARK))
+				if (cave->grid[y][x].info & (CAVE_MARK))
 				{
 					msg_print("The wall turns into mud!");
 					obvious = TRUE;
 				}
 
 				/* Forget the wall */
-				cave_info[y][x] &= ~(CAVE_MARK);
+				cave->grid[y][x].info &= ~(CAVE_MARK);
 
 				/* Destroy the wall */
 				cave_set_feat(y, x, FEAT_FLOOR);
 			}
 
 			/* Quartz / Magma with treasure */
-			else if (cave_feat[y][x] >= FEAT_MAGMA_H)
+			else if (cave->grid[y][x].feat >= FEAT_MAGMA_H)
 			{
 				/* Message */
-				if (cave_info[y][x] & (CAVE_MARK))
+				if (cave->grid[y][x].info & (CAVE_MARK))
 				{
 					msg_print("The vein turns into mud!");
 					msg_print("You have found something!");
@@ -1522,7 +1533,7 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 				}
 
 				/* Forget the wall */
-				cave_info[y][x] &= ~(CAVE_MARK);
+				cave->grid[y][x].info &= ~(CAVE_MARK);
 
 				/* Destroy the wall */
 				cave_set_feat(y, x, FEAT_FLOOR);
@@ -1532,34 +1543,34 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 			}
 
 			/* Quartz / Magma */
-			else if (cave_feat[y][x] >= FEAT_MAGMA)
+			else if (cave->grid[y][x].feat >= FEAT_MAGMA)
 			{
 				/* Message */
-				if (cave_info[y][x] & (CAVE_MARK))
+				if (cave->grid[y][x].info & (CAVE_MARK))
 				{
 					msg_print("The vein turns into mud!");
 					obvious = TRUE;
 				}
 
 				/* Forget the wall */
-				cave_info[y][x] &= ~(CAVE_MARK);
+				cave->grid[y][x].info &= ~(CAVE_MARK);
 
 				/* Destroy the wall */
 				cave_set_feat(y, x, FEAT_FLOOR);
 			}
 
 			/* Rubble */
-			else if (cave_feat[y][x] == FEAT_RUBBLE)
+			else if (cave->grid[y][x].feat == FEAT_RUBBLE)
 			{
 				/* Message */
-				if (cave_info[y][x] & (CAVE_MARK))
+				if (cave->grid[y][x].info & (CAVE_MARK))
 				{
 					msg_print("The rubble turns into mud!");
 					obvious = TRUE;
 				}
 
 				/* Forget the wall */
-				cave_info[y][x] &= ~(CAVE_MARK);
+				cave->grid[y][x].info &= ~(CAVE_MARK);
 
 				/* Destroy the rubble */
 				cave_set_feat(y, x, FEAT_FLOOR);
@@ -1580,17 +1591,17 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 			}
 
 			/* Destroy doors (and secret doors) */
-			else /* if (cave_feat[y][x] >= FEAT_DOOR_HEAD) */
+			else /* if (cave->grid[y][x].feat >= FEAT_DOOR_HEAD) */
 			{
 				/* Hack -- special message */
-				if (cave_info[y][x] & (CAVE_MARK))
+				if (cave->grid[y][x].info & (CAVE_MARK))
 				{
 					msg_print("The door turns into mud!");
 					obvious = TRUE;
 				}
 
 				/* Forget the wall */
-				cave_info[y][x] &= ~(CAVE_MARK);
+				cave->grid[y][x].info &= ~(CAVE_MARK);
 
 				/* Destroy the feature */
 				cave_set_feat(y, x, FEAT_FLOOR);
@@ -1599,8 +1610,8 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 			/* Update the visuals */
 			p_ptr->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
 
-			/* Fully update the flow */
-			p_ptr->update |= (PU_FORGET_FLOW | PU_UPDATE_FLOW);
+			/* Update the flow */
+			p_ptr->update |= (PU_UPDATE_FLOW);
 
 			break;
 		}
@@ -1615,7 +1626,7 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 			cave_set_feat(y, x, FEAT_DOOR_HEAD + 0x00);
 
 			/* Observe */
-			if (cave_info[y][x] & (CAVE_MARK)) obvious = TRUE;
+			if (cave->grid[y][x].info & (CAVE_MARK)) obvious = TRUE;
 
 			/* Update the visuals */
 			p_ptr->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
@@ -1640,7 +1651,7 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 		case GF_LIGHT:
 		{
 			/* Turn on the light */
-			cave_info[y][x] |= (CAVE_GLOW);
+			cave->grid[y][x].info |= (CAVE_GLOW);
 
 			/* Grid is in line of sight */
 			if (player_has_los_bold(y, x))
@@ -1665,11 +1676,11 @@ static bool project_f(int who, int r, int y, int x, int dam, int typ, bool obvio
 			if (p_ptr->depth != 0 || !is_daytime())
 			{
 				/* Turn off the light */
-				cave_info[y][x] &= ~(CAVE_GLOW);
+				cave->grid[y][x].info &= ~(CAVE_GLOW);
 
 				/* Hack -- Forget "boring" grids */
-				if (cave_feat[y][x] <= FEAT_INVIS)
-					cave_info[y][x] &= ~(CAVE_MARK);
+				if (cave->grid[y][x].feat <= FEAT_INVIS)
+					cave->grid[y][x].info &= ~(CAVE_MARK);
 			}
 
 			/* Grid is in line of sight */
@@ -1730,7 +1741,7 @@ static bool project_o(int who, int r, int y, int x, int dam, int typ, bool obvio
 
 
 	/* Scan all objects in the grid */
-	for (this_o_idx = cave_o_idx[y][x]; this_o_idx; this_o_idx = next_o_idx)
+	for (this_o_idx = cave->grid[y][x].o_idx; this_o_idx; this_o_idx = next_o_idx)
 	{
 		object_type *o_ptr;
 
@@ -2060,14 +2071,14 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ, bool obvio
 
 
 	/* No monster here */
-	if (!(cave_m_idx[y][x] > 0)) return (FALSE);
+	if (!(cave->grid[y][x].m_idx > 0)) return (FALSE);
 
 	/* Never affect projector */
-	if (cave_m_idx[y][x] == who) return (FALSE);
+	if (cave->grid[y][x].m_idx == who) return (FALSE);
 
 
 	/* Obtain monster info */
-	m_ptr = &mon_list[cave_m_idx[y][x]];
+	m_ptr = &mon_list[cave->grid[y][x].m_idx];
 	r_ptr = &r_info[m_ptr->r_idx];
 	l_ptr = &l_list[m_ptr->r_idx];
 	name = r_ptr->name;
@@ -2078,11 +2089,23 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ, bool obvio
 	dam = (dam + r) / (r + 1);
 
 
-	/* Get the monster name (BEFORE polymorphing) */
-	monster_desc(m_name, sizeof(m_name), m_ptr, 0);
+	/*
+	 * Get the monster name (BEFORE polymorphing).  Only seen monsters, or
+	 * ones killed by another monster, get messages naming them, so big
+	 * blasts needn't describe every unseen monster they hit.
+	 */
+	if (seen || (who > 0))
+	{
+		monster_desc(m_name, sizeof(m_name), m_ptr, 0);
 
-	/* Get the monster possessive ("his"/"her"/"its") */
-	monster_desc(m_poss, sizeof(m_poss), m_ptr, MDESC_PRO2 | MDESC_POSS);
+		/* Get the monster possessive ("his"/"her"/"its") */
+		monster_desc(m_poss, sizeof(m_poss), m_ptr, MDESC_PRO2 | MDESC_POSS);
+	}
+	else
+	{
+		m_name[0] = '\0';
+		m_poss[0] = '\0';
+	}
 
 
 	/* Some monsters get "destroyed" */
@@ -2512,10 +2535,11 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ, bool obvio
 			m_ptr->hp = m_ptr->maxhp;
 
 			/* Speed up */
-			if (m_ptr->mspeed < 150) m_ptr->mspeed += 10;
+			if (m_ptr->mspeed < 150)
+				monster_set_speed(cave->grid[y][x].m_idx, m_ptr->mspeed + 10);
 
 			/* Attempt to clone. */
-			if (multiply_monster(cave_m_idx[y][x]))
+			if (multiply_monster(cave->grid[y][x].m_idx))
 			{
 				note = " spawns!";
 			}
@@ -2542,7 +2566,7 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ, bool obvio
 			if (m_ptr->hp > m_ptr->maxhp) m_ptr->hp = m_ptr->maxhp;
 
 			/* Redraw (later) if needed */
-			if (p_ptr->health_who == cave_m_idx[y][x]) p_ptr->redraw |= (PR_HEALTH);
+			if (p_ptr->health_who == cave->grid[y][x].m_idx) p_ptr->redraw |= (PR_HEALTH);
 
 			/* Message */
 			note = " looks healthier.";
@@ -2559,7 +2583,8 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ, bool obvio
 			if (seen) obvious = TRUE;
 
 			/* Speed up */
-			if (m_ptr->mspeed < 150) m_ptr->mspeed += 10;
+			if (m_ptr->mspeed < 150)
+				monster_set_speed(cave->grid[y][x].m_idx, m_ptr->mspeed + 10);
 			note = " starts moving faster.";
 
 			/* No "real" damage */
@@ -2584,7 +2609,8 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ, bool obvio
 			/* Normal monsters slow down */
 			else
 			{
-				if (m_ptr->mspeed > 60) m_ptr->mspeed -= 10;
+				if (m_ptr->mspeed > 60)
+					monster_set_speed(cave->grid[y][x].m_idx, m_ptr->mspeed - 10);
 				note = " starts moving slower.";
 			}
 
@@ -2975,7 +3001,7 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ, bool obvio
 					dam = 0;
 
 					/* "Kill" the "old" monster */
-					delete_monster_idx(cave_m_idx[y][x]);
+					delete_monster_idx(cave->grid[y][x].m_idx);
 
 					/* Create a new monster (no groups) */
 					(void)place_monster_aux(y, x, tmp, FALSE, FALSE);
@@ -2983,7 +3009,7 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ, bool obvio
 					/* Hack -- Assume success XXX XXX XXX */
 
 					/* Hack -- Get new monster */
-					m_ptr = &mon_list[cave_m_idx[y][x]];
+					m_ptr = &mon_list[cave->grid[y][x].m_idx];
 
 					/* Hack -- Get new race */
 					r_ptr = &r_info[m_ptr->r_idx];
@@ -3002,7 +3028,7 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ, bool obvio
 		note = " disappears!";
 
 		/* Teleport */
-		teleport_away(cave_m_idx[y][x], do_dist);
+		teleport_away(cave->grid[y][x].m_idx, do_dist);
 
 		/* Hack -- get new location */
 		y = m_ptr->fy;
@@ -3139,22 +3165,23 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ, bool obvio
 	if (who > 0)
 	{
 		/* Redraw (later) if needed */
-		if (p_ptr->health_who == cave_m_idx[y][x]) p_ptr->redraw |= (PR_HEALTH);
+		if (p_ptr->health_who == cave->grid[y][x].m_idx) p_ptr->redraw |= (PR_HEALTH);
 
 		/* Wake the monster up */
 		wake_monster(m_ptr);
 
 		/* Hurt the monster */
 		m_ptr->hp -= dam;
+		monster_hurt(cave->grid[y][x].m_idx);
 
 		/* Dead monster */
 		if (m_ptr->hp < 0)
 		{
 			/* Generate treasure, etc */
-			monster_death(cave_m_idx[y][x]);
+			monster_death(cave->grid[y][x].m_idx);
 
 			/* Delete the monster */
-			delete_monster_idx(cave_m_idx[y][x]);
+			delete_monster_idx(cave->grid[y][x].m_idx);
 
 			/* Give detailed messages if destroyed */
 			if (note) msg_format("%^s%s", m_name, note);
@@ -3169,7 +3196,7 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ, bool obvio
 			if (note && seen) msg_format("%^s%s", m_name, note);
 
 			/* Hack -- Pain message */
-			else if (dam > 0) message_pain(cave_m_idx[y][x], dam);
+			else if (dam > 0) message_pain(cave->grid[y][x].m_idx, dam);
 		}
 	}
 
@@ -3179,7 +3206,7 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ, bool obvio
 		bool fear = FALSE;
 
 		/* Hurt the monster, check for fear and death */
-		if (mon_take_hit(cave_m_idx[y][x], dam, &fear, note_dies))
+		if (mon_take_hit(cave->grid[y][x].m_idx, dam, &fear, note_dies))
 		{
 			/* Dead monster */
 			mon_died = TRUE;
@@ -3192,7 +3219,7 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ, bool obvio
 			if (note && seen) msg_format("%^s%s", m_name, note);
 
 			/* Hack -- Pain message */
-			else if (dam > 0) message_pain(cave_m_idx[y][x], dam);
+			else if (dam > 0) message_pain(cave->grid[y][x].m_idx, dam);
 
 			/* Take note */
 			if (seen && (fear || m_ptr->monfear))
@@ -3245,7 +3272,7 @@ static bool project_m(int who, int r, int y, int x, int dam, int typ, bool obvio
 	/* Verify this code XXX XXX XXX */
 
 	/* Update the monster */
-	update_mon(cave_m_idx[y][x], FALSE);
+	update_mon(cave->grid[y][x].m_idx, FALSE);
 
 	/* Redraw the monster grid */
 	light_spot(y, x);
@@ -3312,10 +3339,10 @@ static bool project_p(int who, int r, int y, int x, int dam, int typ, bool obvio
 
 
 	/* No player here */
-	if (!(cave_m_idx[y][x] < 0)) return (FALSE);
+	if (!(cave->grid[y][x].m_idx < 0)) return (FALSE);
 
 	/* Never affect projector */
-	if (cave_m_idx[y][x] == who) return (FALSE);
+	if (cave->grid[y][x].m_idx == who) return (FALSE);
 
 
 	/* Limit maximum damage XXX XXX XXX */
@@ -3965,6 +3992,49 @@ static bool project_p(int who, int r, int y, int x, int dam, int typ, bool obvio
  * in the blast radius, in case the "illumination" of the grid was changed,
  * and "update_view()" and "update_monsters()" need to be called.
  */
+/*
+ * The largest blast radius, given the size of gm[] in project()
+ */
+#define BLAST_RAD_MAX	14
+
+/*
+ * The offsets of every grid within BLAST_RAD_MAX of a blast centre, in the
+ * order project() takes them: outwards by distance(), then by row, then by
+ * column.  Those at distance "d" start at blast_start[d].
+ */
+static s16b blast_dy[(2 * BLAST_RAD_MAX + 1) * (2 * BLAST_RAD_MAX + 1)];
+static s16b blast_dx[(2 * BLAST_RAD_MAX + 1) * (2 * BLAST_RAD_MAX + 1)];
+static int blast_start[BLAST_RAD_MAX + 2];
+
+static void blast_init(void)
+{
+	int dist, dy, dx;
+	int n = 0;
+
+	/* Only once */
+	if (blast_start[BLAST_RAD_MAX + 1]) return;
+
+	for (dist = 0; dist <= BLAST_RAD_MAX; dist++)
+	{
+		blast_start[dist] = n;
+
+		for (dy = -dist; dy <= dist; dy++)
+		{
+			for (dx = -dist; dx <= dist; dx++)
+			{
+				if (distance(0, 0, dy, dx) != dist) continue;
+
+				blast_dy[n] = dy;
+				blast_dx[n] = dx;
+				n++;
+			}
+		}
+	}
+
+	blast_start[BLAST_RAD_MAX + 1] = n;
+}
+
+
 bool project(int who, int rad, int y, int x, int dam, int typ, int flg)
 {
 	int py = p_ptr->py;
@@ -4005,6 +4075,8 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg)
 	byte gm[16];
 
 
+	PERF_COUNT(PERF_PROJECTS);
+
 	/* Hack -- Jump to target */
 	if (flg & (PROJECT_JUMP))
 	{
@@ -4055,6 +4127,9 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg)
 	/* Hack -- Assume there will be no blast (max radius 16) */
 	for (dist = 0; dist < 16; dist++) gm[dist] = 0;
 
+	/* Keep within gm[] */
+	if (rad > BLAST_RAD_MAX) rad = BLAST_RAD_MAX;
+
 
 	/* Initial grid */
 	y = y1;
@@ -4177,28 +4252,27 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg)
 		grids--;
 	}
 
+	blast_init();
+
 	/* Determine the blast area, work from the inside out */
 	for (dist = 0; dist <= rad; dist++)
 	{
-		/* Scan the maximal blast area of radius "dist" */
-		for (y = y2 - dist; y <= y2 + dist; y++)
+		/* Take the grids of the "circular" explosion at radius "dist" */
+		for (i = blast_start[dist]; i < blast_start[dist + 1]; i++)
 		{
-			for (x = x2 - dist; x <= x2 + dist; x++)
-			{
-				/* Ignore "illegal" locations */
-				if (!in_bounds(y, x)) continue;
+			y = y2 + blast_dy[i];
+			x = x2 + blast_dx[i];
 
-				/* Enforce a "circular" explosion */
-				if (distance(y2, x2, y, x) != dist) continue;
+			/* Ignore "illegal" locations */
+			if (!in_bounds(y, x)) continue;
 
-				/* Ball explosions are stopped by walls */
-				if (!los(y2, x2, y, x)) continue;
+			/* Ball explosions are stopped by walls */
+			if (!los(y2, x2, y, x)) continue;
 
-				/* Save this grid */
-				gy[grids] = y;
-				gx[grids] = x;
-				grids++;
-			}
+			/* Save this grid */
+			gy[grids] = y;
+			gx[grids] = x;
+			grids++;
 		}
 
 		/* Encode some more "radius" info */
@@ -4371,15 +4445,15 @@ bool project(int who, int rad, int y, int x, int dam, int typ, int flg)
 			y = project_m_y;
 
 			/* Track if possible */
-			if (cave_m_idx[y][x] > 0)
+			if (cave->grid[y][x].m_idx > 0)
 			{
-				monster_type *m_ptr = &mon_list[cave_m_idx[y][x]];
+				monster_type *m_ptr = &mon_list[cave->grid[y][x].m_idx];
 
 				/* Hack -- auto-recall */
 				if (m_ptr->ml) monster_race_track(m_ptr->r_idx);
 
 				/* Hack - auto-track */
-				if (m_ptr->ml) health_track(cave_m_idx[y][x]);
+				if (m_ptr->ml) health_track(cave->grid[y][x].m_idx);
 			}
 		}
 	}
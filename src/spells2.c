@@ -18,6 +18,7 @@
 
 #include "angband.h"
 #include "cave.h"
+#include "game-event.h"
 #include "generate.h"
 #include "history.h"
 #include "monster/monster.h"
@@ -106,7 +107,7 @@ void warding_glyph(void)
 	int py = p_ptr->py;
 	int px = p_ptr->px;
 
-	if (cave_feat[py][px] != FEAT_FLOOR)
+	if (cave->grid[py][px].feat != FEAT_FLOOR)
 	{
 		msg_print("There is no clear floor on which to cast the spell.");
 		return;
@@ -478,8 +479,11 @@ void map_area(void)
 	/* Drag the co-ordinates into the dungeon */
 	if (y1 < 0) y1 = 0;
 	if (x1 < 0) x1 = 0;
-	if (y2 > DUNGEON_HGT - 1) y2 = DUNGEON_HGT - 1;
-	if (x2 > DUNGEON_WID - 1) x2 = DUNGEON_WID - 1;
+	if (y2 > cave->height - 1) y2 = cave->height - 1;
+	if (x2 > cave->width - 1) x2 = cave->width - 1;
+
+	/* Walls next to several floors are only redrawn once */
+	event_queue_begin();
 
 	/* Scan the dungeon */
 	for (y = y1; y < y2; y++)
@@ -487,15 +491,15 @@ void map_area(void)
 		for (x = x1; x < x2; x++)
 		{
 			/* All non-walls are "checked" */
-			if (cave_feat[y][x] < FEAT_SECRET)
+			if (cave->grid[y][x].feat < FEAT_SECRET)
 			{
 				if (!in_bounds_fully(y, x)) continue;
 
 				/* Memorize normal features */
-				if (cave_feat[y][x] > FEAT_INVIS)
+				if (cave->grid[y][x].feat > FEAT_INVIS)
 				{
 					/* Memorize the object */
-					cave_info[y][x] |= (CAVE_MARK);
+					cave->grid[y][x].info |= (CAVE_MARK);
 					light_spot(y, x);
 				}
 
@@ -506,16 +510,18 @@ void map_area(void)
 					int xx = x + ddx_ddd[i];
 
 					/* Memorize walls (etc) */
-					if (cave_feat[yy][xx] >= FEAT_SECRET)
+					if (cave->grid[yy][xx].feat >= FEAT_SECRET)
 					{
 						/* Memorize the walls */
-						cave_info[yy][xx] |= (CAVE_MARK);
+						cave->grid[yy][xx].info |= (CAVE_MARK);
 						light_spot(yy, xx);
 					}
 				}
 			}
 		}
 	}
+
+	event_queue_end();
 }
 
 
@@ -530,6 +536,10 @@ bool detect_traps(bool aware)
 
 	bool detect = FALSE;
 
+	/* Grids on the edge of the detected area, and detected traps */
+	planeword old_edge[CAVE_PLANE_SIZE];
+	planeword traps[CAVE_PLANE_SIZE];
+
 	(void)aware;
 
 	/* Pick an area to map */
@@ -541,6 +551,19 @@ bool detect_traps(bool aware)
 	if (y1 < 0) y1 = 0;
 	if (x1 < 0) x1 = 0;
 
+	plane_wipe(old_edge, CAVE_PLANE_SIZE);
+	plane_wipe(traps, CAVE_PLANE_SIZE);
+
+	/* Note the old dtrap edge, which can only move near the new area */
+	for (y = y1 - 1; y < y2 + 1; y++)
+	{
+		for (x = x1 - 1; x < x2 + 1; x++)
+		{
+			if (!in_bounds_fully(y, x)) continue;
+
+			if (dtrap_edge(y, x)) plane_on(old_edge, GRID(y, x));
+		}
+	}
 
 	/* Scan the dungeon */
 	for (y = y1; y < y2; y++)
@@ -550,37 +573,41 @@ bool detect_traps(bool aware)
 			if (!in_bounds_fully(y, x)) continue;
 
 			/* Detect invisible traps */
-			if (cave_feat[y][x] == FEAT_INVIS)
+			if (cave->grid[y][x].feat == FEAT_INVIS)
 			{
 				/* Pick a trap */
 				pick_trap(y, x);
 			}
 
 			/* Detect traps */
-			if ((cave_feat[y][x] >= FEAT_TRAP_HEAD) &&
-			    (cave_feat[y][x] <= FEAT_TRAP_TAIL))
+			if ((cave->grid[y][x].feat >= FEAT_TRAP_HEAD) &&
+			    (cave->grid[y][x].feat <= FEAT_TRAP_TAIL))
 			{
 				/* Hack -- Memorize */
-				cave_info[y][x] |= (CAVE_MARK);
+				cave->grid[y][x].info |= (CAVE_MARK);
+				plane_on(traps, GRID(y, x));
 
 				/* We found something to detect */
 				detect = TRUE;
 			}
 
 			/* Mark as trap-detected */
-			cave_info2[y][x] |= (CAVE2_DTRAP);
+			cave->grid[y][x].info2 |= (CAVE2_DTRAP);
 		}
 	}
 
-	/* Rescan the map for the new dtrap edge */
+	/* Redraw the traps, and wherever the dtrap edge has come or gone */
 	for (y = y1 - 1; y < y2 + 1; y++)
 	{
 		for (x = x1 - 1; x < x2 + 1; x++)
 		{
+			int g = GRID(y, x);
+
 			if (!in_bounds_fully(y, x)) continue;
 
-			/* Redraw */
-			light_spot(y, x);
+			if (plane_has(traps, g) ||
+			    (dtrap_edge(y, x) != (plane_has(old_edge, g) != 0)))
+				light_spot(y, x);
 		}
 	}
 
@@ -631,17 +658,17 @@ bool detect_doorstairs(bool aware)
 			if (!in_bounds_fully(y, x)) continue;
 
 			/* Detect secret doors */
-			if (cave_feat[y][x] == FEAT_SECRET)
+			if (cave->grid[y][x].feat == FEAT_SECRET)
 				place_closed_door(y, x);
 
 			/* Detect doors */
-			if (((cave_feat[y][x] >= FEAT_DOOR_HEAD) &&
-			     (cave_feat[y][x] <= FEAT_DOOR_TAIL)) ||
-			    ((cave_feat[y][x] == FEAT_OPEN) ||
-			     (cave_feat[y][x] == FEAT_BROKEN)))
+			if (((cave->grid[y][x].feat >= FEAT_DOOR_HEAD) &&
+			     (cave->grid[y][x].feat <= FEAT_DOOR_TAIL)) ||
+			    ((cave->grid[y][x].feat == FEAT_OPEN) ||
+			     (cave->grid[y][x].feat == FEAT_BROKEN)))
 			{
 				/* Hack -- Memorize */
-				cave_info[y][x] |= (CAVE_MARK);
+				cave->grid[y][x].info |= (CAVE_MARK);
 
 				/* Redraw */
 				light_spot(y, x);
@@ -651,11 +678,11 @@ bool detect_doorstairs(bool aware)
 			}
 
 			/* Detect stairs */
-			if ((cave_feat[y][x] == FEAT_LESS) ||
-			    (cave_feat[y][x] == FEAT_MORE))
+			if ((cave->grid[y][x].feat == FEAT_LESS) ||
+			    (cave->grid[y][x].feat == FEAT_MORE))
 			{
 				/* Hack -- Memorize */
-				cave_info[y][x] |= (CAVE_MARK);
+				cave->grid[y][x].info |= (CAVE_MARK);
 
 				/* Redraw */
 				light_spot(y, x);
@@ -709,19 +736,19 @@ bool detect_treasure(bool aware)
 			if (!in_bounds_fully(y, x)) continue;
 
 			/* Notice embedded gold */
-			if ((cave_feat[y][x] == FEAT_MAGMA_H) ||
-			    (cave_feat[y][x] == FEAT_QUARTZ_H))
+			if ((cave->grid[y][x].feat == FEAT_MAGMA_H) ||
+			    (cave->grid[y][x].feat == FEAT_QUARTZ_H))
 			{
 				/* Expose the gold */
-				cave_feat[y][x] += 0x02;
+				cave->grid[y][x].feat += 0x02;
 			}
 
 			/* Magma/Quartz + Known Gold */
-			if ((cave_feat[y][x] == FEAT_MAGMA_K) ||
-			    (cave_feat[y][x] == FEAT_QUARTZ_K))
+			if ((cave->grid[y][x].feat == FEAT_MAGMA_K) ||
+			    (cave->grid[y][x].feat == FEAT_QUARTZ_K))
 			{
 				/* Hack -- Memorize */
-				cave_info[y][x] |= (CAVE_MARK);
+				cave->grid[y][x].info |= (CAVE_MARK);
 
 				/* Redraw */
 				light_spot(y, x);
@@ -732,24 +759,16 @@ bool detect_treasure(bool aware)
 		}
 	}
 
-	/* Scan objects */
-	for (i = 1; i < o_max; i++)
+	/* Scan nearby objects */
+	for (i = floor_object_next(0, y1, x1, y2, x2); i;
+	     i = floor_object_next(i, y1, x1, y2, x2))
 	{
 		object_type *o_ptr = &o_list[i];
 
-		/* Skip dead objects */
-		if (!o_ptr->k_idx) continue;
-
-		/* Skip held objects */
-		if (o_ptr->held_m_idx) continue;
-
 		/* Location */
 		y = o_ptr->iy;
 		x = o_ptr->ix;
 
-		/* Only detect nearby objects */
-		if (x < x1 || y < y1 || x > x2 || y > y2) continue;
-
 		/* Hack -- memorize it */
 		o_ptr->marked = TRUE;
 
@@ -803,19 +822,19 @@ bool detect_close_buried_treasure(void)
 			if (!in_bounds_fully(y, x)) continue;
 
 			/* Notice embedded gold */
-			if ((cave_feat[y][x] == FEAT_MAGMA_H) ||
-			    (cave_feat[y][x] == FEAT_QUARTZ_H))
+			if ((cave->grid[y][x].feat == FEAT_MAGMA_H) ||
+			    (cave->grid[y][x].feat == FEAT_QUARTZ_H))
 			{
 				/* Expose the gold */
-				cave_feat[y][x] += 0x02;
+				cave->grid[y][x].feat += 0x02;
 			}
 
 			/* Magma/Quartz + Known Gold */
-			if ((cave_feat[y][x] == FEAT_MAGMA_K) ||
-			    (cave_feat[y][x] == FEAT_QUARTZ_K))
+			if ((cave->grid[y][x].feat == FEAT_MAGMA_K) ||
+			    (cave->grid[y][x].feat == FEAT_QUARTZ_K))
 			{
 				/* Hack -- Memorize */
-				cave_info[y][x] |= (CAVE_MARK);
+				cave->grid[y][x].info |= (CAVE_MARK);
 
 				/* Redraw */
 				light_spot(y, x);
@@ -856,25 +875,16 @@ bool detect_objects_magic(bool aware)
 	if (x1 < 0) x1 = 0;
 
 
-	/* Scan all objects */
-	for (i = 1; i < o_max; i++)
+	/* Scan nearby objects */
+	for (i = floor_object_next(0, y1, x1, y2, x2); i;
+	     i = floor_object_next(i, y1, x1, y2, x2))
 	{
 		object_type *o_ptr = &o_list[i];
 
-		/* Skip dead objects */
-		if (!o_ptr->k_idx) continue;
-
-		/* Skip held objects */
-		if (o_ptr->held_m_idx) continue;
-
 		/* Location */
 		y = o_ptr->iy;
 		x = o_ptr->ix;
 
-
-		/* Only detect nearby objects */
-		if (x < x1 || y < y1 || x > x2 || y > y2) continue;
-
 		/* Examine the tval */
 		tv = o_ptr->tval;
 
@@ -912,7 +922,7 @@ bool detect_objects_magic(bool aware)
  */
 bool detect_monsters_normal(bool aware)
 {
-	int i, y, x;
+	int n, y, x;
 	int x1, x2, y1, y2;
 
 	bool flag = FALSE;
@@ -930,9 +940,10 @@ bool detect_monsters_normal(bool aware)
 
 
 	/* Scan monsters */
-	for (i = 1; i < mon_max; i++)
+	for (n = mon_live_num - 1; n >= 0; n--)
 	{
-		monster_type *m_ptr = &mon_list[i];
+		int m_idx = mon_live[n];
+		monster_type *m_ptr = &mon_list[m_idx];
 		monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
 		/* Skip dead monsters */
@@ -955,7 +966,7 @@ bool detect_monsters_normal(bool aware)
 			m_ptr->mflag |= (MFLAG_MARK | MFLAG_SHOW);
 
 			/* Update the monster */
-			update_mon(i, FALSE);
+			update_mon(m_idx, FALSE);
 
 			/* Detect */
 			flag = TRUE;
@@ -977,7 +988,7 @@ bool detect_monsters_normal(bool aware)
  */
 bool detect_monsters_invis(bool aware)
 {
-	int i, y, x;
+	int n, y, x;
 	int x1, x2, y1, y2;
 
 	bool flag = FALSE;
@@ -993,9 +1004,10 @@ bool detect_monsters_invis(bool aware)
 
 
 	/* Scan monsters */
-	for (i = 1; i < mon_max; i++)
+	for (n = mon_live_num - 1; n >= 0; n--)
 	{
-		monster_type *m_ptr = &mon_list[i];
+		int m_idx = mon_live[n];
+		monster_type *m_ptr = &mon_list[m_idx];
 		monster_race *r_ptr = &r_info[m_ptr->r_idx];
 		monster_lore *l_ptr = &l_list[m_ptr->r_idx];
 
@@ -1029,7 +1041,7 @@ bool detect_monsters_invis(bool aware)
 			m_ptr->mflag |= (MFLAG_MARK | MFLAG_SHOW);
 
 			/* Update the monster */
-			update_mon(i, FALSE);
+			update_mon(m_idx, FALSE);
 
 			/* Detect */
 			flag = TRUE;
@@ -1051,7 +1063,7 @@ bool detect_monsters_invis(bool aware)
  */
 bool detect_monsters_evil(bool aware)
 {
-	int i, y, x;
+	int n, y, x;
 	int x1, x2, y1, y2;
 
 	bool flag = FALSE;
@@ -1067,9 +1079,10 @@ bool detect_monsters_evil(bool aware)
 
 
 	/* Scan monsters */
-	for (i = 1; i < mon_max; i++)
+	for (n = mon_live_num - 1; n >= 0; n--)
 	{
-		monster_type *m_ptr = &mon_list[i];
+		int m_idx = mon_live[n];
+		monster_type *m_ptr = &mon_list[m_idx];
 		monster_race *r_ptr = &r_info[m_ptr->r_idx];
 		monster_lore *l_ptr = &l_list[m_ptr->r_idx];
 
@@ -1103,7 +1116,7 @@ bool detect_monsters_evil(bool aware)
 			m_ptr->mflag |= (MFLAG_MARK | MFLAG_SHOW);
 
 			/* Update the monster */
-			update_mon(i, FALSE);
+			update_mon(m_idx, FALSE);
 
 			/* Detect */
 			flag = TRUE;
@@ -1595,16 +1608,17 @@ bool recharge(int num)
  */
 bool project_los(int typ, int dam, bool obvious)
 {
-	int i, x, y;
+	int n, x, y;
 
 	int flg = PROJECT_JUMP | PROJECT_KILL | PROJECT_HIDE;
 
 	if(obvious) flg |= PROJECT_AWARE;
 
 	/* Affect all (nearby) monsters */
-	for (i = 1; i < mon_max; i++)
+	for (n = mon_live_num - 1; n >= 0; n--)
 	{
-		monster_type *m_ptr = &mon_list[i];
+		int m_idx = mon_live[n];
+		monster_type *m_ptr = &mon_list[m_idx];
 
 		/* Paranoia -- Skip dead monsters */
 		if (!m_ptr->r_idx) continue;
@@ -1709,22 +1723,23 @@ bool dispel_monsters(int dam)
  */
 void aggravate_monsters(int who)
 {
-	int i;
+	int n;
 
 	bool sleep = FALSE;
 	bool speed = FALSE;
 
 	/* Aggravate everyone nearby */
-	for (i = 1; i < mon_max; i++)
+	for (n = mon_live_num - 1; n >= 0; n--)
 	{
-		monster_type *m_ptr = &mon_list[i];
+		int m_idx = mon_live[n];
+		monster_type *m_ptr = &mon_list[m_idx];
 		monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
 		/* Paranoia -- Skip dead monsters */
 		if (!m_ptr->r_idx) continue;
 
 		/* Skip aggravating monster (or player) */
-		if (i == who) continue;
+		if (m_idx == who) continue;
 
 		/* Wake up nearby sleeping monsters */
 		if (m_ptr->cdis < MAX_SIGHT * 2)
@@ -1745,7 +1760,7 @@ void aggravate_monsters(int who)
 			if (m_ptr->mspeed < r_ptr->speed + 10)
 			{
 				/* Speed up */
-				m_ptr->mspeed = r_ptr->speed + 10;
+				monster_set_speed(m_idx, r_ptr->speed + 10);
 				speed = TRUE;
 			}
 		}
@@ -1763,7 +1778,7 @@ void aggravate_monsters(int who)
  */
 bool banishment(void)
 {
-	int i;
+	int n;
 	unsigned dam = 0;
 
 	char typ;
@@ -1774,9 +1789,10 @@ bool banishment(void)
 		return FALSE;
 
 	/* Delete the monsters of that "type" */
-	for (i = 1; i < mon_max; i++)
+	for (n = mon_live_num - 1; n >= 0; n--)
 	{
-		monster_type *m_ptr = &mon_list[i];
+		int m_idx = mon_live[n];
+		monster_type *m_ptr = &mon_list[m_idx];
 		monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
 		/* Paranoia -- Skip dead monsters */
@@ -1789,7 +1805,7 @@ bool banishment(void)
 		if (r_ptr->d_char != typ) continue;
 
 		/* Delete the monster */
-		delete_monster_idx(i);
+		delete_monster_idx(m_idx);
 
 		/* Take some damage */
 		dam += randint1(4);
@@ -1811,16 +1827,17 @@ bool banishment(void)
  */
 bool mass_banishment(void)
 {
-	int i;
+	int n;
 	unsigned dam = 0;
 
 	bool result = FALSE;
 
 
 	/* Delete the (nearby) monsters */
-	for (i = 1; i < mon_max; i++)
+	for (n = mon_live_num - 1; n >= 0; n--)
 	{
-		monster_type *m_ptr = &mon_list[i];
+		int m_idx = mon_live[n];
+		monster_type *m_ptr = &mon_list[m_idx];
 		monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
 		/* Paranoia -- Skip dead monsters */
@@ -1833,7 +1850,7 @@ bool mass_banishment(void)
 		if (m_ptr->cdis > MAX_SIGHT) continue;
 
 		/* Delete the monster */
-		delete_monster_idx(i);
+		delete_monster_idx(m_idx);
 
 		/* Take some damage */
 		dam += randint1(3);
@@ -1858,15 +1875,16 @@ bool mass_banishment(void)
  */
 bool probing(void)
 {
-	int i;
+	int n;
 
 	bool probe = FALSE;
 
 
 	/* Probe all (nearby) monsters */
-	for (i = 1; i < mon_max; i++)
+	for (n = mon_live_num - 1; n >= 0; n--)
 	{
-		monster_type *m_ptr = &mon_list[i];
+		int m_idx = mon_live[n];
+		monster_type *m_ptr = &mon_list[m_idx];
 
 		/* Paranoia -- Skip dead monsters */
 		if (!m_ptr->r_idx) continue;
@@ -1889,7 +1907,7 @@ bool probing(void)
 			msg_format("%^s has %d hit points.", m_name, m_ptr->hp);
 
 			/* Learn all of the non-spell, non-treasure flags */
-			lore_do_probe(i);
+			lore_do_probe(m_idx);
 
 			/* Probe worked */
 			probe = TRUE;
@@ -1933,6 +1951,10 @@ void destroy_area(int y1, int x1, int r, bool full)
 		return;
 	}
 
+	/* Change the terrain all at once, and redraw it once */
+	event_queue_begin();
+	cave_batch_begin();
+
 	/* Big area of affect */
 	for (y = (y1 - r); y <= (y1 + r); y++)
 	{
@@ -1948,15 +1970,13 @@ void destroy_area(int y1, int x1, int r, bool full)
 			if (k > r) continue;
 
 			/* Lose room and vault */
-			cave_info[y][x] &= ~(CAVE_ROOM | CAVE_ICKY);
+			cave->grid[y][x].info &= ~(CAVE_ROOM | CAVE_ICKY);
 
 			/* Lose light and knowledge */
-			cave_info[y][x] &= ~(CAVE_GLOW | CAVE_MARK);
-			
-			light_spot(y, x);
+			cave->grid[y][x].info &= ~(CAVE_GLOW | CAVE_MARK);
 
 			/* Hack -- Notice player affect */
-			if (cave_m_idx[y][x] < 0)
+			if (cave->grid[y][x].m_idx < 0)
 			{
 				/* Hurt the player later */
 				flag = TRUE;
@@ -2009,6 +2029,9 @@ void destroy_area(int y1, int x1, int r, bool full)
 		}
 	}
 
+	cave_batch_end();
+	event_queue_end();
+
 
 	/* Hack -- Affect player */
 	if (flag)
@@ -2031,8 +2054,8 @@ void destroy_area(int y1, int x1, int r, bool full)
 	/* Fully update the flow */
 	p_ptr->update |= (PU_FORGET_FLOW | PU_UPDATE_FLOW);
 
-	/* Redraw monster list */
-	p_ptr->redraw |= (PR_MONLIST | PR_ITEMLIST);
+	/* Redraw map, monster list */
+	p_ptr->redraw |= (PR_MAP | PR_MONLIST | PR_ITEMLIST);
 }
 
 
@@ -2101,10 +2124,10 @@ void earthquake(int cy, int cx, int r)
 			if (distance(cy, cx, yy, xx) > r) continue;
 
 			/* Lose room and vault */
-			cave_info[yy][xx] &= ~(CAVE_ROOM | CAVE_ICKY);
+			cave->grid[yy][xx].info &= ~(CAVE_ROOM | CAVE_ICKY);
 
 			/* Lose light and knowledge */
-			cave_info[yy][xx] &= ~(CAVE_GLOW | CAVE_MARK);
+			cave->grid[yy][xx].info &= ~(CAVE_GLOW | CAVE_MARK);
 			
 			/* Skip the epicenter */
 			if (!dx && !dy) continue;
@@ -2222,9 +2245,9 @@ void earthquake(int cy, int cx, int r)
 			if (!map[16+yy-cy][16+xx-cx]) continue;
 
 			/* Process monsters */
-			if (cave_m_idx[yy][xx] > 0)
+			if (cave->grid[yy][xx].m_idx > 0)
 			{
-				monster_type *m_ptr = &mon_list[cave_m_idx[yy][xx]];
+				monster_type *m_ptr = &mon_list[cave->grid[yy][xx].m_idx];
 				monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
 				/* Most monsters cannot co-exist with rock */
@@ -2249,7 +2272,7 @@ void earthquake(int cy, int cx, int r)
 							if (!cave_empty_bold(y, x)) continue;
 
 							/* Hack -- no safety on glyph of warding */
-							if (cave_feat[y][x] == FEAT_GLYPH) continue;
+							if (cave->grid[y][x].feat == FEAT_GLYPH) continue;
 
 							/* Important -- Skip "quake" grids */
 							if (map[16+y-cy][16+x-cx]) continue;
@@ -2277,6 +2300,7 @@ void earthquake(int cy, int cx, int r)
 
 					/* Apply damage directly */
 					m_ptr->hp -= damage;
+					monster_hurt(cave->grid[yy][xx].m_idx);
 
 					/* Delete (not kill) "dead" monsters */
 					if (m_ptr->hp < 0)
@@ -2313,6 +2337,10 @@ void earthquake(int cy, int cx, int r)
 	map[16+py-cy][16+px-cx] = FALSE;
 
 
+	/* Change the terrain all at once, and redraw it once */
+	event_queue_begin();
+	cave_batch_begin();
+
 	/* Examine the quaked region */
 	for (dy = -r; dy <= r; dy++)
 	{
@@ -2325,14 +2353,11 @@ void earthquake(int cy, int cx, int r)
 			/* ignore invalid grids */
 			if (!in_bounds_fully(yy, xx)) continue;
 
-			/* Note unaffected grids for light changes, etc. */
-			if (!map[16+yy-cy][16+xx-cx])
-			{
-				light_spot(yy, xx);
-			}
+			/* Unaffected grids are redrawn with the map */
+			if (!map[16+yy-cy][16+xx-cx]) continue;
 
 			/* Destroy location (if valid) */
-			else if (cave_valid_bold(yy, xx))
+			if (cave_valid_bold(yy, xx))
 			{
 				int feat = FEAT_FLOOR;
 
@@ -2371,6 +2396,9 @@ void earthquake(int cy, int cx, int r)
 		}
 	}
 
+	cave_batch_end();
+	event_queue_end();
+
 
 	/* Fully update the visuals */
 	p_ptr->update |= (PU_FORGET_VIEW | PU_UPDATE_VIEW | PU_MONSTERS);
@@ -2378,8 +2406,8 @@ void earthquake(int cy, int cx, int r)
 	/* Fully update the flow */
 	p_ptr->update |= (PU_FORGET_FLOW | PU_UPDATE_FLOW);
 
-	/* Update the health bar */
-	p_ptr->redraw |= (PR_HEALTH);
+	/* Redraw the map and health bar */
+	p_ptr->redraw |= (PR_MAP | PR_HEALTH);
 
 	/* Window stuff */
 	p_ptr->redraw |= (PR_MONLIST | PR_ITEMLIST);
@@ -2405,6 +2433,7 @@ void earthquake(int cy, int cx, int r)
 static void cave_temp_room_light(void)
 {
 	int i;
+	int y1 = DUNGEON_HGT, x1 = DUNGEON_WID, y2 = 0, x2 = 0;
 
 	/* Apply flag changes */
 	for (i = 0; i < temp_n; i++)
@@ -2413,14 +2442,23 @@ static void cave_temp_room_light(void)
 		int x = temp_x[i];
 
 		/* No longer in the array */
-		cave_info[y][x] &= ~(CAVE_TEMP);
+		cave->grid[y][x].info &= ~(CAVE_TEMP);
 
 		/* Perma-Light */
-		cave_info[y][x] |= (CAVE_GLOW);
+		cave->grid[y][x].info |= (CAVE_GLOW);
+
+		/* Note the area changed */
+		y1 = MIN(y1, y);
+		y2 = MAX(y2, y);
+		x1 = MIN(x1, x);
+		x2 = MAX(x2, x);
 	}
 
-	/* Fully update the visuals */
-	p_ptr->update |= (PU_FORGET_VIEW | PU_UPDATE_VIEW | PU_MONSTERS);
+	/* Recast the view around it */
+	if (temp_n) view_area_changed(y1, x1, y2, x2);
+
+	/* Update the visuals */
+	p_ptr->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
 
 	/* Update stuff */
 	update_stuff();
@@ -2431,15 +2469,16 @@ static void cave_temp_room_light(void)
 		int y = temp_y[i];
 		int x = temp_x[i];
 
-		/* Redraw the grid */
+		/* Notice and redraw the grid */
+		note_spot(y, x);
 		light_spot(y, x);
 
 		/* Process affected monsters */
-		if (cave_m_idx[y][x] > 0)
+		if (cave->grid[y][x].m_idx > 0)
 		{
 			int chance = 25;
 
-			monster_type *m_ptr = &mon_list[cave_m_idx[y][x]];
+			monster_type *m_ptr = &mon_list[cave->grid[y][x].m_idx];
 			monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
 			/* Stupid monsters rarely wake up */
@@ -2487,6 +2526,7 @@ static void cave_temp_room_light(void)
 static void cave_temp_room_unlight(void)
 {
 	int i;
+	int y1 = DUNGEON_HGT, x1 = DUNGEON_WID, y2 = 0, x2 = 0;
 
 	/* Apply flag changes */
 	for (i = 0; i < temp_n; i++)
@@ -2495,21 +2535,30 @@ static void cave_temp_room_unlight(void)
 		int x = temp_x[i];
 
 		/* No longer in the array */
-		cave_info[y][x] &= ~(CAVE_TEMP);
+		cave->grid[y][x].info &= ~(CAVE_TEMP);
 
 		/* Darken the grid */
-		cave_info[y][x] &= ~(CAVE_GLOW);
+		cave->grid[y][x].info &= ~(CAVE_GLOW);
 
 		/* Hack -- Forget "boring" grids */
-		if (cave_feat[y][x] <= FEAT_INVIS)
+		if (cave->grid[y][x].feat <= FEAT_INVIS)
 		{
 			/* Forget the grid */
-			cave_info[y][x] &= ~(CAVE_MARK);
+			cave->grid[y][x].info &= ~(CAVE_MARK);
 		}
+
+		/* Note the area changed */
+		y1 = MIN(y1, y);
+		y2 = MAX(y2, y);
+		x1 = MIN(x1, x);
+		x2 = MAX(x2, x);
 	}
 
-	/* Fully update the visuals */
-	p_ptr->update |= (PU_FORGET_VIEW | PU_UPDATE_VIEW | PU_MONSTERS);
+	/* Recast the view around it */
+	if (temp_n) view_area_changed(y1, x1, y2, x2);
+
+	/* Update the visuals */
+	p_ptr->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
 
 	/* Update stuff */
 	update_stuff();
@@ -2537,16 +2586,16 @@ static void cave_temp_room_unlight(void)
 static void cave_temp_room_aux(int y, int x)
 {
 	/* Avoid infinite recursion */
-	if (cave_info[y][x] & (CAVE_TEMP)) return;
+	if (cave->grid[y][x].info & (CAVE_TEMP)) return;
 
 	/* Do not "leave" the current room */
-	if (!(cave_info[y][x] & (CAVE_ROOM))) return;
+	if (!(cave->grid[y][x].info & (CAVE_ROOM))) return;
 
 	/* Paranoia -- verify space */
 	if (temp_n == TEMP_MAX) return;
 
 	/* Mark the grid as "seen" */
-	cave_info[y][x] |= (CAVE_TEMP);
+	cave->grid[y][x].info |= (CAVE_TEMP);
 
 	/* Add it to the "seen" set */
 	temp_y[temp_n] = y;
@@ -2558,14 +2607,16 @@ static void cave_temp_room_aux(int y, int x)
 
 
 /*
- * Illuminate any room containing the given location.
+ * Put the room containing the given location, and its walls, in the "temp"
+ * set, spreading breadth first
  */
-void light_room(int y1, int x1)
+static void cave_temp_room_fill(int y1, int x1)
 {
 	int i, x, y;
 
-        /* Assure that temp_n =0 to avoid strange bugs*/
-        temp_n = 0;
+	/* Assure that temp_n =0 to avoid strange bugs*/
+	temp_n = 0;
+
 	/* Add the initial grid */
 	cave_temp_room_aux(y1, x1);
 
@@ -2574,7 +2625,7 @@ void light_room(int y1, int x1)
 	{
 		x = temp_x[i], y = temp_y[i];
 
-		/* Walls get lit, but stop light */
+		/* Walls get lit or darkened, but stop the spread */
 		if (!cave_floor_bold(y, x)) continue;
 
 		/* Spread adjacent */
@@ -2589,6 +2640,15 @@ void light_room(int y1, int x1)
 		cave_temp_room_aux(y - 1, x + 1);
 		cave_temp_room_aux(y + 1, x - 1);
 	}
+}
+
+
+/*
+ * Illuminate any room containing the given location.
+ */
+void light_room(int y1, int x1)
+{
+	cave_temp_room_fill(y1, x1);
 
 	/* Now, light them all up at once */
 	cave_temp_room_light();
@@ -2600,34 +2660,7 @@ void light_room(int y1, int x1)
  */
 void unlight_room(int y1, int x1)
 {
-	int i, x, y;
-
-        /* Assure that temp_n =0 to avoid strange bugs*/
-        temp_n = 0;
-
-	/* Add the initial grid */
-	cave_temp_room_aux(y1, x1);
-
-	/* Spread, breadth first */
-	for (i = 0; i < temp_n; i++)
-	{
-		x = temp_x[i], y = temp_y[i];
-
-		/* Walls get dark, but stop darkness */
-		if (!cave_floor_bold(y, x)) continue;
-
-		/* Spread adjacent */
-		cave_temp_room_aux(y + 1, x);
-		cave_temp_room_aux(y - 1, x);
-		cave_temp_room_aux(y, x + 1);
-		cave_temp_room_aux(y, x - 1);
-
-		/* Spread diagonal */
-		cave_temp_room_aux(y + 1, x + 1);
-		cave_temp_room_aux(y - 1, x - 1);
-		cave_temp_room_aux(y - 1, x + 1);
-		cave_temp_room_aux(y + 1, x - 1);
-	}
+	cave_temp_room_fill(y1, x1);
 
 	/* Now, darken them all at once */
 	cave_temp_room_unlight();
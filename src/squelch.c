@@ -118,15 +118,9 @@ int get_autoinscription_index(s16b k_idx)
  */
 const char *get_autoinscription(s16b kind_idx)
 {
-	int i;
-
-	for (i = 0; i < inscriptions_count; i++)
-	{
-		if (kind_idx == inscriptions[i].kind_idx)
-			return quark_str(inscriptions[i].inscription_idx);
-	}
+	u16b note = k_info[kind_idx].note;
 
-	return 0;
+	return note ? quark_str(note) : 0;
 }
 
 /* Put the autoinscription on an object */
@@ -165,6 +159,8 @@ int remove_autoinscription(s16b kind)
 	/* It's not here. */
 	if (i == -1) return 0;
 
+	k_info[kind].note = 0;
+
 	while (i < inscriptions_count - 1)
 	{
 		inscriptions[i] = inscriptions[i+1];
@@ -201,6 +197,7 @@ int add_autoinscription(s16b kind, cptr inscription)
 
 	inscriptions[index].kind_idx = kind;
 	inscriptions[index].inscription_idx = quark_add(inscription);
+	k_info[kind].note = inscriptions[index].inscription_idx;
 
 	/* Only increment count if inscription added to end of array */
 	if (index == inscriptions_count)
@@ -217,7 +214,7 @@ void autoinscribe_ground(void)
 	s16b this_o_idx, next_o_idx = 0;
 
 	/* Scan the pile of objects */
-	for (this_o_idx = cave_o_idx[py][px]; this_o_idx; this_o_idx = next_o_idx)
+	for (this_o_idx = cave->grid[py][px].o_idx; this_o_idx; this_o_idx = next_o_idx)
 	{
 		/* Get the next object */
 		next_o_idx = o_list[this_o_idx].next_o_idx;
@@ -264,22 +261,43 @@ void object_squelch_flavor_of(const object_type *o_ptr)
 /*
  * Find the squelch type of the object, or TYPE_MAX if none
  */
-squelch_type_t squelch_type_of(const object_type *o_ptr)
+static squelch_type_t squelch_type_of_kind(int tval, int sval)
 {
 	size_t i;
 
 	/* Find the appropriate squelch group */
 	for (i = 0; i < N_ELEMENTS(quality_mapping); i++)
 	{
-		if ((quality_mapping[i].tval == o_ptr->tval) &&
-			(quality_mapping[i].min_sval <= o_ptr->sval) &&
-			(quality_mapping[i].max_sval >= o_ptr->sval))
+		if ((quality_mapping[i].tval == tval) &&
+			(quality_mapping[i].min_sval <= sval) &&
+			(quality_mapping[i].max_sval >= sval))
 			return quality_mapping[i].squelch_type;
 	}
 
 	return TYPE_MAX;
 }
 
+squelch_type_t squelch_type_of(const object_type *o_ptr)
+{
+	/* Squelch group of each kind, worked out the first time it is needed */
+	static byte *kind_squelch_type;
+
+	if (!o_ptr->k_idx)
+		return squelch_type_of_kind(o_ptr->tval, o_ptr->sval);
+
+	if (!kind_squelch_type)
+	{
+		int i;
+
+		kind_squelch_type = C_ZNEW(z_info->k_max, byte);
+		for (i = 0; i < z_info->k_max; i++)
+			kind_squelch_type[i] = squelch_type_of_kind(k_info[i].tval,
+					k_info[i].sval);
+	}
+
+	return kind_squelch_type[o_ptr->k_idx];
+}
+
 
 /*
  * Determine the squelch level of an object, which is similar to its pseudo.
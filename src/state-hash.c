@@ -0,0 +1,231 @@
+/*
+ * File: state-hash.c
+ * Purpose: Hash the game state, to show that a change leaves play the same
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+#include "angband.h"
+#include "state-hash.h"
+
+/*
+ * state_hash() boils down what the player could tell apart -- the player,
+ * the monsters, the objects, the level and the RNG -- to 32 bits.  Two runs
+ * of the same game which hash the same on every turn played the same, so
+ * a change which was only meant to make the game faster can be checked by
+ * logging the hashes with and without it and comparing them.
+ *
+ * Things only kept to make the game faster are left out: which slot of
+ * mon_list[] or o_list[] things are in, whether a monster is dormant, and
+ * the like.  Monsters and objects are hashed one by one and the results
+ * added, so they can be in any order.
+ *
+ * The log is a line of "<turn> <hash>" every `every` game turns, written to
+ * (or checked against) a file in the user directory.  `every` is rounded up
+ * to a multiple of 10, as skip_idle_turns() never skips those turns.
+ */
+static int hash_every;
+static ang_file *hash_file;
+static bool hash_checking;
+
+/* Lines checked, and the first turn which didn't match (or -1) */
+static u32b hash_checked;
+static s32b hash_bad_turn;
+
+
+/*
+ * Mix `v` into hash `h` (FNV-1a, a word at a time)
+ */
+#define HASH_MIX(h, v) \
+	((h) = ((h) ^ (u32b)(v)) * 16777619UL)
+
+#define HASH_START	2166136261UL
+
+
+static u32b hash_object(const object_type *o_ptr)
+{
+	u32b h = HASH_START;
+
+	HASH_MIX(h, o_ptr->k_idx);
+	HASH_MIX(h, (o_ptr->iy << 8) | o_ptr->ix);
+	HASH_MIX(h, o_ptr->held_m_idx ? mon_list[o_ptr->held_m_idx].r_idx : 0);
+	HASH_MIX(h, o_ptr->number);
+	HASH_MIX(h, o_ptr->pval);
+	HASH_MIX(h, o_ptr->timeout);
+	HASH_MIX(h, (o_ptr->name1 << 8) | o_ptr->name2);
+	HASH_MIX(h, o_ptr->to_a);
+	HASH_MIX(h, o_ptr->to_h);
+	HASH_MIX(h, o_ptr->to_d);
+	HASH_MIX(h, o_ptr->ident);
+
+	return h;
+}
+
+static u32b hash_monster(int m_idx)
+{
+	const monster_type *m_ptr = &mon_list[m_idx];
+	u32b h = HASH_START;
+
+	HASH_MIX(h, m_ptr->r_idx);
+	HASH_MIX(h, (m_ptr->fy << 8) | m_ptr->fx);
+	HASH_MIX(h, m_ptr->hp);
+	HASH_MIX(h, m_ptr->maxhp);
+	HASH_MIX(h, m_ptr->csleep);
+	HASH_MIX(h, m_ptr->mspeed);
+	HASH_MIX(h, monster_energy(m_idx));
+	HASH_MIX(h, (m_ptr->stunned << 16) | (m_ptr->confused << 8) |
+			m_ptr->monfear);
+	HASH_MIX(h, m_ptr->mflag & ~(MFLAG_DORM | MFLAG_HURT));
+	HASH_MIX(h, m_ptr->ml);
+
+	return h;
+}
+
+
+/*
+ * Hash the state of the game
+ */
+u32b state_hash(void)
+{
+	u32b h = HASH_START;
+	u32b sum;
+	size_t g;
+	int i, y, x;
+
+	/* Time and chance */
+	HASH_MIX(h, turn);
+	HASH_MIX(h, Rand_quick);
+	HASH_MIX(h, Rand_value);
+	HASH_MIX(h, state_i);
+	for (i = 0; i < RAND_DEG; i++)
+		HASH_MIX(h, STATE[i]);
+
+	/* The player */
+	HASH_MIX(h, (p_ptr->py << 8) | p_ptr->px);
+	HASH_MIX(h, p_ptr->depth);
+	HASH_MIX(h, p_ptr->chp);
+	HASH_MIX(h, p_ptr->chp_frac);
+	HASH_MIX(h, p_ptr->csp);
+	HASH_MIX(h, p_ptr->exp);
+	HASH_MIX(h, p_ptr->au);
+	HASH_MIX(h, p_ptr->energy);
+	HASH_MIX(h, p_ptr->food);
+	for (i = 0; i < A_MAX; i++)
+		HASH_MIX(h, p_ptr->stat_cur[i]);
+	for (i = 0; i < TMD_MAX; i++)
+		HASH_MIX(h, p_ptr->timed[i]);
+	for (i = 0; i < ALL_INVEN_TOTAL; i++)
+		HASH_MIX(h, hash_object(&p_ptr->inventory[i]));
+
+	/* The monsters, in any order */
+	for (sum = 0, i = 1; i < mon_max; i++)
+		if (mon_list[i].r_idx) sum += hash_monster(i);
+	HASH_MIX(h, sum);
+
+	/* The objects, in any order */
+	for (sum = 0, i = 1; i < o_max; i++)
+		if (o_list[i].k_idx) sum += hash_object(&o_list[i]);
+	HASH_MIX(h, sum);
+
+	/* The level, and what the player remembers and sees of it */
+	for (y = 0; y < cave->height; y++)
+		for (x = 0; x < cave->width; x++)
+			HASH_MIX(h, (cave->grid[y][x].feat << 8) |
+					(cave->grid[y][x].info & (CAVE_MARK | CAVE_GLOW)));
+
+	for (g = 0; g < CAVE_PLANE_SIZE; g++)
+	{
+		HASH_MIX(h, cave->view[g]);
+		HASH_MIX(h, cave->seen[g]);
+	}
+
+	return h;
+}
+
+
+/*
+ * Start writing the hash to file `name` in the user directory every `every`
+ * game turns, or checking it against that file if `check` is set.  An
+ * `every` of 0 stops.  Returns FALSE if the file can't be opened.
+ */
+bool state_hash_start(int every, const char *name, bool check)
+{
+	char buf[1024];
+
+	if (hash_file)
+	{
+		file_close(hash_file);
+		hash_file = NULL;
+	}
+
+	hash_every = 0;
+	if (every <= 0) return TRUE;
+
+	path_build(buf, sizeof(buf), ANGBAND_DIR_USER, name);
+	hash_file = file_open(buf, check ? MODE_READ : MODE_WRITE, FTYPE_TEXT);
+	if (!hash_file) return FALSE;
+
+	hash_every = (every + 9) / 10 * 10;
+	hash_checking = check;
+	hash_checked = 0;
+	hash_bad_turn = -1;
+
+	return TRUE;
+}
+
+
+/*
+ * Log or check the hash, if it's due this game turn
+ */
+void state_hash_turn(void)
+{
+	char buf[80];
+	long log_turn;
+	unsigned long log_hash;
+	u32b h;
+
+	if (!hash_every || (turn % hash_every)) return;
+
+	h = state_hash();
+
+	if (!hash_checking)
+	{
+		file_putf(hash_file, "%ld %08lx\n", (long)turn, (unsigned long)h);
+		return;
+	}
+
+	/* Past the end of the log */
+	if (!file_getl(hash_file, buf, sizeof(buf))) return;
+
+	hash_checked++;
+
+	if ((sscanf(buf, "%ld %lx", &log_turn, &log_hash) == 2) &&
+	    (log_turn == turn) && (log_hash == h))
+		return;
+
+	if (hash_bad_turn < 0)
+	{
+		hash_bad_turn = turn;
+		msg_format("The game state differs from the log at turn %ld.",
+		           (long)turn);
+	}
+}
+
+
+/*
+ * How many hashes have been checked, and the first turn which didn't match
+ * or -1 if they all did
+ */
+u32b state_hash_checked(s32b *bad_turn)
+{
+	if (bad_turn) *bad_turn = hash_bad_turn;
+	return hash_checked;
+}
@@ -0,0 +1,11 @@
+/* state-hash.h - hashing the game state, to compare runs */
+
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+extern u32b state_hash(void);
+extern bool state_hash_start(int every, const char *name, bool check);
+extern void state_hash_turn(void);
+extern u32b state_hash_checked(s32b *bad_turn);
+
+#endif /* !STATE_HASH_H */
@@ -207,6 +207,7 @@ static struct store *store_new(int idx) {
 	struct store *s = mem_zalloc(sizeof *s);
 	s->sidx = idx;
 	s->stock = mem_zalloc(sizeof(*s->stock) * STORE_INVEN_MAX);
+	s->stock_key = mem_zalloc(sizeof(*s->stock_key) * STORE_INVEN_MAX);
 	s->stock_size = STORE_INVEN_MAX;
 	return s;
 }
@@ -279,7 +280,7 @@ static enum parser_error parse_own_n(struct parser *p) {
 static enum parser_error parse_own_s(struct parser *p) {
 	struct owner_parser_state *s = parser_priv(p);
 	unsigned int maxcost = parser_getuint(p, "maxcost");
-	char *name = string_make(parser_getstr(p, "name"));
+	char *name = parser_strdup(p, parser_getstr(p, "name"));
 	struct owner *o;
 
 	if (!s->cur)
@@ -544,9 +545,9 @@ static int current_store()
 	if (store_knowledge != STORE_NONE)
 		return store_knowledge;
 
-	if ((cave_feat[p_ptr->py][p_ptr->px] >= FEAT_SHOP_HEAD) &&
-		(cave_feat[p_ptr->py][p_ptr->px] <= FEAT_SHOP_TAIL))
-		return (cave_feat[p_ptr->py][p_ptr->px] - FEAT_SHOP_HEAD);
+	if ((cave->grid[p_ptr->py][p_ptr->px].feat >= FEAT_SHOP_HEAD) &&
+		(cave->grid[p_ptr->py][p_ptr->px].feat <= FEAT_SHOP_TAIL))
+		return (cave->grid[p_ptr->py][p_ptr->px].feat - FEAT_SHOP_HEAD);
 
 	return STORE_NONE;
 }
@@ -555,6 +556,62 @@ static int current_store()
 
 /*** Basics: pricing, generation, etc. ***/
 
+/*
+ * Cache of object_value() for the stock of the store last priced, since the
+ * store screen asks for every price each time it is redrawn.  Each entry
+ * keeps a copy of the object it was worked out for, so anything that could
+ * change the value (identification, a change in quantity, the stock being
+ * shuffled along) just makes the copy differ and the value be recomputed.
+ */
+struct stock_value
+{
+	object_type obj;
+	s32b value;
+};
+
+static struct stock_value *stock_values;
+static int stock_values_num;
+static int stock_values_store = STORE_NONE;
+
+
+/*
+ * Return object_value(o_ptr, 1, FALSE), from the cache if "o_ptr" is an item
+ * in the stock of store "st".
+ */
+static s32b store_object_value(int st, const object_type *o_ptr)
+{
+	store_type *st_ptr = &store[st];
+	struct stock_value *sv;
+	int item;
+
+	/* Only items on sale are known well enough to be cached */
+	if ((o_ptr < st_ptr->stock) || (o_ptr >= st_ptr->stock + st_ptr->stock_size) ||
+			!(o_ptr->ident & IDENT_STORE))
+		return object_value(o_ptr, 1, FALSE);
+
+	item = o_ptr - st_ptr->stock;
+
+	/* Start again for a different store */
+	if ((stock_values_store != st) || (stock_values_num != st_ptr->stock_size))
+	{
+		FREE(stock_values);
+		stock_values = C_ZNEW(st_ptr->stock_size, struct stock_value);
+		stock_values_num = st_ptr->stock_size;
+		stock_values_store = st;
+	}
+
+	sv = &stock_values[item];
+
+	if (memcmp(&sv->obj, o_ptr, sizeof(object_type)) || !sv->obj.k_idx)
+	{
+		object_copy(&sv->obj, o_ptr);
+		sv->value = object_value(o_ptr, 1, FALSE);
+	}
+
+	return sv->value;
+}
+
+
 /*
  * Determine the price of an object (qty one) in a store.
  *
@@ -582,10 +639,10 @@ s32b price_item(const object_type *o_ptr, bool store_buying, int qty)
 
 
 	/* Get the value of the stack of wands, or a single item */
-	if ((o_ptr->tval == TV_WAND) || (o_ptr->tval == TV_STAFF))
+	if (((o_ptr->tval == TV_WAND) || (o_ptr->tval == TV_STAFF)) && (qty != 1))
 		price = object_value(o_ptr, qty, FALSE);
 	else
-		price = object_value(o_ptr, 1, FALSE);
+		price = store_object_value(this_store, o_ptr);
 
 	/* Worthless items */
 	if (price <= 0) return (0L);
@@ -849,6 +906,103 @@ static bool store_check_num(int st, const object_type *o_ptr)
 }
 
 
+/*
+ * The stock is kept in order of a key for each item, worked out once as the
+ * item comes in, so finding where a new item goes is a binary search rather
+ * than an object_value() for every item already there.  Items are sorted by
+ * decreasing key: by decreasing tval, increasing sval and decreasing value,
+ * with the home putting the books the player can read first and unaware or
+ * unknown items after the rest of their kind.
+ *
+ * Items which come in some other way (from the savefile) get keys the next
+ * time one is needed.
+ */
+static void stock_key_make(int st, const object_type *o_ptr, u32b value,
+		struct stock_key *key)
+{
+	bool aware = TRUE, known = TRUE;
+
+	if (st == STORE_HOME)
+	{
+		aware = object_flavor_is_aware(o_ptr);
+		known = aware && object_is_known(o_ptr);
+		if (o_ptr->tval == cp_ptr->spell_book) key->order = 1L << 25;
+		else key->order = 0;
+	}
+	else
+	{
+		key->order = 0;
+	}
+
+	key->order |= (u32b)o_ptr->tval << 17;
+	if (aware) key->order |= (1L << 16) | ((u32b)(255 - o_ptr->sval) << 8);
+	if (known) key->order |= 1L << 7;
+
+	key->value = known ? value : 0;
+}
+
+static int stock_key_cmp(const struct stock_key *a, const struct stock_key *b)
+{
+	if (a->order != b->order) return (a->order < b->order) ? -1 : 1;
+	if (a->value != b->value) return (a->value < b->value) ? -1 : 1;
+	return 0;
+}
+
+/*
+ * Find where `key` goes in the stock of store `st`: after every item with a
+ * key at least as great.
+ */
+static int stock_key_slot(int st, const struct stock_key *key)
+{
+	store_type *st_ptr = &store[st];
+	int lo = 0, hi = st_ptr->stock_num;
+
+	/* Key anything which came in without one */
+	for (; st_ptr->stock_keyed < st_ptr->stock_num; st_ptr->stock_keyed++)
+	{
+		int i = st_ptr->stock_keyed;
+		object_type *j_ptr = &st_ptr->stock[i];
+
+		stock_key_make(st, j_ptr, object_value(j_ptr, 1, FALSE),
+				&st_ptr->stock_key[i]);
+	}
+
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+
+		if (stock_key_cmp(&st_ptr->stock_key[mid], key) >= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/*
+ * Put object `o_ptr`, with key `key`, into slot `slot` of the stock of
+ * store `st`, sliding the others up
+ */
+static void stock_insert(int st, int slot, const object_type *o_ptr,
+		const struct stock_key *key)
+{
+	store_type *st_ptr = &store[st];
+	int i;
+
+	for (i = st_ptr->stock_num; i > slot; i--)
+	{
+		object_copy(&st_ptr->stock[i], &st_ptr->stock[i-1]);
+		st_ptr->stock_key[i] = st_ptr->stock_key[i-1];
+	}
+
+	object_copy(&st_ptr->stock[slot], o_ptr);
+	st_ptr->stock_key[slot] = *key;
+
+	st_ptr->stock_num++;
+	st_ptr->stock_keyed++;
+}
+
 
 /*
  * Add an object to the inventory of the Home.
@@ -862,9 +1016,9 @@ static bool store_check_num(int st, const object_type *o_ptr)
  */
 static int home_carry(object_type *o_ptr)
 {
-	int i, slot;
-	u32b value, j_value;
+	int slot;
 	object_type *j_ptr;
+	struct stock_key key;
 
 	store_type *st_ptr = &store[STORE_HOME];
 
@@ -888,55 +1042,12 @@ static int home_carry(object_type *o_ptr)
 	/* No space? */
 	if (st_ptr->stock_num >= st_ptr->stock_size) return (-1);
 
-	/* Determine the "value" of the object */
-	value = object_value(o_ptr, 1, FALSE);
-
-	/* Check existing slots to see if we must "slide" */
-	for (slot = 0; slot < st_ptr->stock_num; slot++)
-	{
-		/* Get that object */
-		j_ptr = &st_ptr->stock[slot];
-
-		/* Hack -- readable books always come first */
-		if ((o_ptr->tval == cp_ptr->spell_book) &&
-		    (j_ptr->tval != cp_ptr->spell_book)) break;
-		if ((j_ptr->tval == cp_ptr->spell_book) &&
-		    (o_ptr->tval != cp_ptr->spell_book)) continue;
-
-		/* Objects sort by decreasing type */
-		if (o_ptr->tval > j_ptr->tval) break;
-		if (o_ptr->tval < j_ptr->tval) continue;
-
-		/* Can happen in the home */
-		if (!object_flavor_is_aware(o_ptr)) continue;
-		if (!object_flavor_is_aware(j_ptr)) break;
-
-		/* Objects sort by increasing sval */
-		if (o_ptr->sval < j_ptr->sval) break;
-		if (o_ptr->sval > j_ptr->sval) continue;
+	/* Find its place */
+	stock_key_make(STORE_HOME, o_ptr, object_value(o_ptr, 1, FALSE), &key);
+	slot = stock_key_slot(STORE_HOME, &key);
 
-		/* Objects in the home can be unknown */
-		if (!object_is_known(o_ptr)) continue;
-		if (!object_is_known(j_ptr)) break;
-
-		/* Objects sort by decreasing value */
-		j_value = object_value(j_ptr, 1, FALSE);
-		if (value > j_value) break;
-		if (value < j_value) continue;
-	}
-
-	/* Slide the others up */
-	for (i = st_ptr->stock_num; i > slot; i--)
-	{
-		/* Hack -- slide the objects */
-		object_copy(&st_ptr->stock[i], &st_ptr->stock[i-1]);
-	}
-
-	/* More stuff now */
-	st_ptr->stock_num++;
-
-	/* Hack -- Insert the new object */
-	object_copy(&st_ptr->stock[slot], o_ptr);
+	/* Insert the new object */
+	stock_insert(STORE_HOME, slot, o_ptr, &key);
 
 	/* Return the location */
 	return (slot);
@@ -959,8 +1070,9 @@ static int store_carry(int st, object_type *o_ptr)
 {
 	unsigned int i;
 	unsigned int slot;
-	u32b value, j_value;
+	u32b value;
 	object_type *j_ptr;
+	struct stock_key key;
 
 	store_type *st_ptr = &store[st];
 	object_kind *k_ptr = &k_info[o_ptr->k_idx];
@@ -1054,40 +1166,12 @@ static int store_carry(int st, object_type *o_ptr)
 		return (-1);
 	}
 
-	/* Check existing slots to see if we must "slide" */
-	for (slot = 0; slot < st_ptr->stock_num; slot++)
-	{
-		/* Get that object */
-		j_ptr = &st_ptr->stock[slot];
-
-		/* Objects sort by decreasing type */
-		if (o_ptr->tval > j_ptr->tval) break;
-		if (o_ptr->tval < j_ptr->tval) continue;
-
-		/* Objects sort by increasing sval */
-		if (o_ptr->sval < j_ptr->sval) break;
-		if (o_ptr->sval > j_ptr->sval) continue;
-
-		/* Evaluate that slot */
-		j_value = object_value(j_ptr, 1, FALSE);
-
-		/* Objects sort by decreasing value */
-		if (value > j_value) break;
-		if (value < j_value) continue;
-	}
-
-	/* Slide the others up */
-	for (i = st_ptr->stock_num; i > slot; i--)
-	{
-		/* Hack -- slide the objects */
-		object_copy(&st_ptr->stock[i], &st_ptr->stock[i-1]);
-	}
+	/* Find its place */
+	stock_key_make(st, o_ptr, value, &key);
+	slot = stock_key_slot(st, &key);
 
-	/* More stuff now */
-	st_ptr->stock_num++;
-
-	/* Hack -- Insert the new object */
-	object_copy(&st_ptr->stock[slot], o_ptr);
+	/* Insert the new object */
+	stock_insert(st, slot, o_ptr, &key);
 
 	/* Return the location */
 	return (slot);
@@ -1137,13 +1221,15 @@ static void store_item_optimize(int st, int item)
 	/* Must have no items */
 	if (o_ptr->number) return;
 
-	/* One less object */
+	/* One less object, and one less key if it had one */
 	st_ptr->stock_num--;
+	if (st_ptr->stock_keyed > item) st_ptr->stock_keyed--;
 
 	/* Slide everyone */
 	for (j = item; j < st_ptr->stock_num; j++)
 	{
 		st_ptr->stock[j] = st_ptr->stock[j + 1];
+		st_ptr->stock_key[j] = st_ptr->stock_key[j + 1];
 	}
 
 	/* Nuke the final slot */
@@ -1669,6 +1755,7 @@ static struct store *add_builtin_stores(struct store *stores) {
 
 static void parse_owners(struct store *stores) {
 	struct parser *p = store_owner_parser_new(stores);
+	parser_setarena(p, init_strings);
 	parse_file(p, "shop_own");
 	mem_free(parser_priv(p));
 	parser_destroy(p);
@@ -1707,16 +1794,66 @@ void store_reset(void) {
 	for (i = 0; i < MAX_STORES; i++) {
 		s = &store[i];
 		s->stock_num = 0;
+		s->stock_keyed = 0;
 		store_shuffle(i);
 		for (j = 0; j < s->stock_size; j++)
 			object_wipe(&s->stock[j]);
 		if (i == STORE_HOME)
 			continue;
-		for (j = 0; j < 10; j++)
+		for (j = 0; j < STORE_REFRESH; j++)
 			store_maint(i);
 	}
 }
 
+/*
+ * Bring the stores up to date after the player has been away for "days"
+ * days.
+ *
+ * Only the last STORE_REFRESH days' maintenance is actually run, since that
+ * many is enough to replace a whole stock (see store_reset()), and anything
+ * done before it would only be thrown away.  The owners still get a chance
+ * to retire every day.
+ */
+void store_update(int days)
+{
+	int day;
+
+	for (day = 0; day < days; day++)
+	{
+		int n;
+
+		/* Maintain each shop (except home) */
+		if (day >= days - STORE_REFRESH)
+		{
+			for (n = 0; n < MAX_STORES; n++)
+			{
+				/* Skip the home */
+				if (n == STORE_HOME) continue;
+
+				/* Maintain */
+				store_maint(n);
+			}
+		}
+
+		/* Sometimes, shuffle the shop-keepers */
+		if (one_in_(STORE_SHUFFLE))
+		{
+			/* Message */
+			if (OPT(cheat_xtra)) msg_print("Shuffling a Shopkeeper...");
+
+			/* Pick a random shop (except home) */
+			while (1)
+			{
+				n = randint0(MAX_STORES);
+				if (n != STORE_HOME) break;
+			}
+
+			/* Shuffle it */
+			store_shuffle(n);
+		}
+	}
+}
+
 /*
  * Shuffle one of the stores.
  */
@@ -2299,7 +2436,7 @@ void do_cmd_buy(cmd_code code, cmd_arg args[])
 		}
 
 		/* New inventory */
-		for (i = 0; i < 10; ++i)
+		for (i = 0; i < STORE_REFRESH; ++i)
 		{
 			/* Maintain the store */
 			store_maint(this_store);
@@ -2308,6 +2445,7 @@ void do_cmd_buy(cmd_code code, cmd_arg args[])
 
 	event_signal(EVENT_INVENTORY);
 	event_signal(EVENT_EQUIPMENT);
+	event_signal(EVENT_END);
 }
 
 /*
@@ -2368,6 +2506,7 @@ void do_cmd_retrieve(cmd_code code, cmd_arg args[])
 	
 	event_signal(EVENT_INVENTORY);
 	event_signal(EVENT_EQUIPMENT);
+	event_signal(EVENT_END);
 }
 
 /*
@@ -2627,6 +2766,7 @@ void do_cmd_sell(cmd_code code, cmd_arg args[])
 
 	event_signal(EVENT_INVENTORY);
 	event_signal(EVENT_EQUIPMENT);
+	event_signal(EVENT_END);
 }
 
 /*
@@ -2684,6 +2824,7 @@ void do_cmd_stash(cmd_code code, cmd_arg args[])
 
 	event_signal(EVENT_INVENTORY);
 	event_signal(EVENT_EQUIPMENT);
+	event_signal(EVENT_END);
 }
 
 /*
@@ -3041,6 +3182,7 @@ bool store_menu_handle(menu_type *m, const ui_event_data *event, int oid)
 		{
 			event_signal(EVENT_INVENTORY);
 			event_signal(EVENT_EQUIPMENT);
+			event_signal(EVENT_END);
 		}
 
 		/* Notice and handle stuff */
@@ -7,6 +7,7 @@
 #define STORE_INVEN_MAX		24    /* Max number of discrete objs in inven */
 #define STORE_TURNS		1000  /* Number of turns between turnovers */
 #define STORE_SHUFFLE		25    /* 1/Chance (per day) of an owner changing */
+#define STORE_REFRESH		10    /* Maintenances that renew a whole stock */
 
 /* List of store indices */
 enum
@@ -30,6 +31,12 @@ typedef struct owner {
 	s32b max_cost;
 } owner_type;
 
+/* Where an item goes in a store's stock; see stock_key_make() */
+struct stock_key {
+	u32b order;
+	u32b value;
+};
+
 typedef struct store {
 	struct store *next;
 	struct owner *owners;
@@ -39,6 +46,8 @@ typedef struct store {
 	byte stock_num;			/* Stock -- Number of entries */
 	s16b stock_size;		/* Stock -- Total Size of Array */
 	object_type *stock;		/* Stock -- Actual stock items */
+	struct stock_key *stock_key;	/* Stock -- Sort key of each item */
+	byte stock_keyed;		/* Stock -- Number of items with keys */
 
 	unsigned int table_num;     /* Table -- Number of entries */
 	unsigned int table_size;    /* Table -- Total Size of Array */
@@ -49,6 +58,7 @@ void store_init(void);
 void store_reset(void);
 void store_shuffle(int which);
 void store_maint(int which);
+void store_update(int days);
 s32b price_item(const object_type *o_ptr, bool store_buying, int qty);
 
 extern struct owner *store_ownerbyidx(struct store *s, unsigned int idx);
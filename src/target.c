@@ -266,6 +266,12 @@ static int cmp_distance(const void *a, const void *b)
 		return -1;
 	if (da > db)
 		return 1;
+
+	/* Break ties in panel scan order */
+	if (pa->y != pb->y)
+		return (pa->y < pb->y) ? -1 : 1;
+	if (pa->x != pb->x)
+		return (pa->x < pb->x) ? -1 : 1;
 	return 0;
 }
 
@@ -330,7 +336,7 @@ static bool target_set_interactive_accept(int y, int x)
 
 
 	/* Player grids are always interesting */
-	if (cave_m_idx[y][x] < 0) return (TRUE);
+	if (cave->grid[y][x].m_idx < 0) return (TRUE);
 
 
 	/* Handle hallucination */
@@ -338,9 +344,9 @@ static bool target_set_interactive_accept(int y, int x)
 
 
 	/* Visible monsters */
-	if (cave_m_idx[y][x] > 0)
+	if (cave->grid[y][x].m_idx > 0)
 	{
-		monster_type *m_ptr = &mon_list[cave_m_idx[y][x]];
+		monster_type *m_ptr = &mon_list[cave->grid[y][x].m_idx];
 
 		/* Visible monsters */
 		if (m_ptr->ml) return (TRUE);
@@ -354,90 +360,124 @@ static bool target_set_interactive_accept(int y, int x)
 	}
 
 	/* Interesting memorized features */
-	if (cave_info[y][x] & (CAVE_MARK))
+	if (cave->grid[y][x].info & (CAVE_MARK))
 	{
 		/* Notice glyphs */
-		if (cave_feat[y][x] == FEAT_GLYPH) return (TRUE);
+		if (cave->grid[y][x].feat == FEAT_GLYPH) return (TRUE);
 
 		/* Notice doors */
-		if (cave_feat[y][x] == FEAT_OPEN) return (TRUE);
-		if (cave_feat[y][x] == FEAT_BROKEN) return (TRUE);
+		if (cave->grid[y][x].feat == FEAT_OPEN) return (TRUE);
+		if (cave->grid[y][x].feat == FEAT_BROKEN) return (TRUE);
 
 		/* Notice stairs */
-		if (cave_feat[y][x] == FEAT_LESS) return (TRUE);
-		if (cave_feat[y][x] == FEAT_MORE) return (TRUE);
+		if (cave->grid[y][x].feat == FEAT_LESS) return (TRUE);
+		if (cave->grid[y][x].feat == FEAT_MORE) return (TRUE);
 
 		/* Notice shops */
-		if ((cave_feat[y][x] >= FEAT_SHOP_HEAD) &&
-		    (cave_feat[y][x] <= FEAT_SHOP_TAIL)) return (TRUE);
+		if ((cave->grid[y][x].feat >= FEAT_SHOP_HEAD) &&
+		    (cave->grid[y][x].feat <= FEAT_SHOP_TAIL)) return (TRUE);
 
 		/* Notice traps */
-		if ((cave_feat[y][x] >= FEAT_TRAP_HEAD) &&
-		    (cave_feat[y][x] <= FEAT_TRAP_TAIL)) return (TRUE);
+		if ((cave->grid[y][x].feat >= FEAT_TRAP_HEAD) &&
+		    (cave->grid[y][x].feat <= FEAT_TRAP_TAIL)) return (TRUE);
 
 		/* Notice doors */
-		if ((cave_feat[y][x] >= FEAT_DOOR_HEAD) &&
-		    (cave_feat[y][x] <= FEAT_DOOR_TAIL)) return (TRUE);
+		if ((cave->grid[y][x].feat >= FEAT_DOOR_HEAD) &&
+		    (cave->grid[y][x].feat <= FEAT_DOOR_TAIL)) return (TRUE);
 
 		/* Notice rubble */
-		if (cave_feat[y][x] == FEAT_RUBBLE) return (TRUE);
+		if (cave->grid[y][x].feat == FEAT_RUBBLE) return (TRUE);
 
 		/* Notice veins with treasure */
-		if (cave_feat[y][x] == FEAT_MAGMA_K) return (TRUE);
-		if (cave_feat[y][x] == FEAT_QUARTZ_K) return (TRUE);
+		if (cave->grid[y][x].feat == FEAT_MAGMA_K) return (TRUE);
+		if (cave->grid[y][x].feat == FEAT_QUARTZ_K) return (TRUE);
 	}
 
 	/* Nope */
 	return (FALSE);
 }
 
+/*
+ * Candidate locations for targeting, before they are copied to "temp"
+ */
+static struct point target_pts[TEMP_MAX];
+
 /*
  * Prepare the "temp" array for "target_interactive_set"
  *
- * Return the number of target_able monsters in the set.
+ * When only monsters are wanted they are taken from the list of live
+ * monsters and kept in order as they are found, rather than scanning and
+ * sorting the whole panel; the "closest target" commands do this every
+ * time they are used.
  */
 /* XXX: Untangle this. The whole temp_* thing is complete madness. */
 static void target_set_interactive_prepare(int mode)
 {
 	int y, x;
-	struct point *pts = mem_zalloc(sizeof(*pts) * SCREEN_HGT * SCREEN_WID);
 	unsigned int n = 0;
 
-	/* Scan the current panel */
-	for (y = Term->offset_y; y < Term->offset_y + SCREEN_HGT; y++)
+	if (mode & (TARGET_KILL))
 	{
-		for (x = Term->offset_x; x < Term->offset_x + SCREEN_WID; x++)
+		int i;
+
+		for (i = 0; (i < mon_live_num) && (n < TEMP_MAX); i++)
 		{
-			/* Check bounds */
-			if (!in_bounds_fully(y, x)) continue;
+			int m_idx = mon_live[i];
+			monster_type *m_ptr = &mon_list[m_idx];
+			struct point pt;
+			unsigned int k;
 
-			/* Require "interesting" contents */
-			if (!target_set_interactive_accept(y, x)) continue;
+			y = m_ptr->fy;
+			x = m_ptr->fx;
 
-			/* Special mode */
-			if (mode & (TARGET_KILL))
-			{
-				/* Must contain a monster */
-				if (!(cave_m_idx[y][x] > 0)) continue;
+			/* Must be on the current panel */
+			if ((y < Term->offset_y) || (y >= Term->offset_y + SCREEN_HGT))
+				continue;
+			if ((x < Term->offset_x) || (x >= Term->offset_x + SCREEN_WID))
+				continue;
+			if (!in_bounds_fully(y, x)) continue;
 
-				/* Must be a targettable monster */
-			 	if (!target_able(cave_m_idx[y][x])) continue;
-			}
+			/* Must be a targettable monster */
+			if (!target_able(m_idx)) continue;
 
-			/* Save the location */
-			pts[n].x = x;
-			pts[n].y = y;
+			/* Insert the location in order of distance */
+			pt.x = x;
+			pt.y = y;
+			for (k = n; (k > 0) && (cmp_distance(&pt, &target_pts[k - 1]) < 0); k--)
+				target_pts[k] = target_pts[k - 1];
+			target_pts[k] = pt;
 			n++;
 		}
 	}
+	else
+	{
+		/* Scan the current panel */
+		for (y = Term->offset_y; y < Term->offset_y + SCREEN_HGT; y++)
+		{
+			for (x = Term->offset_x; x < Term->offset_x + SCREEN_WID; x++)
+			{
+				/* Check bounds */
+				if (!in_bounds_fully(y, x)) continue;
+
+				/* Require "interesting" contents */
+				if (!target_set_interactive_accept(y, x)) continue;
 
-	sort(pts, n, sizeof(*pts), cmp_distance);
+				/* Save the location */
+				if (n == TEMP_MAX) continue;
+				target_pts[n].x = x;
+				target_pts[n].y = y;
+				n++;
+			}
+		}
+
+		sort(target_pts, n, sizeof(*target_pts), cmp_distance);
+	}
 
 	/* Reset "temp" array */
 	temp_n = n;
 	while (n--) {
-		temp_x[n] = pts[n].x;
-		temp_y[n] = pts[n].y;
+		temp_x[n] = target_pts[n].x;
+		temp_y[n] = target_pts[n].y;
 	}
 }
 
@@ -642,7 +682,7 @@ static ui_event_data target_set_interactive_aux(int y, int x, int mode)
 
 
 		/* The player */
-		if (cave_m_idx[y][x] < 0)
+		if (cave->grid[y][x].m_idx < 0)
 		{
 			/* Description */
 			s1 = "You are ";
@@ -680,9 +720,9 @@ static ui_event_data target_set_interactive_aux(int y, int x, int mode)
 		}
 
 		/* Actual monsters */
-		if (cave_m_idx[y][x] > 0)
+		if (cave->grid[y][x].m_idx > 0)
 		{
-			monster_type *m_ptr = &mon_list[cave_m_idx[y][x]];
+			monster_type *m_ptr = &mon_list[cave->grid[y][x].m_idx];
 			monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
 			/* Visible */
@@ -702,7 +742,7 @@ static ui_event_data target_set_interactive_aux(int y, int x, int mode)
 				monster_race_track(m_ptr->r_idx);
 
 				/* Hack -- health bar for this monster */
-				health_track(cave_m_idx[y][x]);
+				health_track(cave->grid[y][x].m_idx);
 
 				/* Hack -- handle stuff */
 				handle_stuff();
@@ -732,7 +772,7 @@ static ui_event_data target_set_interactive_aux(int y, int x, int mode)
 						char buf[80];
 
 						/* Describe the monster */
-						look_mon_desc(buf, sizeof(buf), cave_m_idx[y][x]);
+						look_mon_desc(buf, sizeof(buf), cave->grid[y][x].m_idx);
 
 						/* Describe, and prompt for recall */
 						if (p_ptr->wizard)
@@ -965,10 +1005,10 @@ static ui_event_data target_set_interactive_aux(int y, int x, int mode)
 
 
 		/* Feature (apply "mimic") */
-		feat = f_info[cave_feat[y][x]].mimic;
+		feat = f_info[cave->grid[y][x].feat].mimic;
 
 		/* Require knowledge about grid, or ability to see grid */
-		if (!(cave_info[y][x] & (CAVE_MARK)) && !player_can_see_bold(y,x))
+		if (!(cave->grid[y][x].info & (CAVE_MARK)) && !player_can_see_bold(y,x))
 		{
 			/* Forget feature */
 			feat = FEAT_NONE;
@@ -1046,7 +1086,7 @@ bool target_set_closest(int mode)
 	/* Find the first monster in the queue */
 	y = temp_y[0];
 	x = temp_x[0];
-	m_idx = cave_m_idx[y][x];
+	m_idx = cave->grid[y][x].m_idx;
 	
 	/* Target the monster, if possible */
 	if ((m_idx <= 0) || !target_able(m_idx))
@@ -1064,7 +1104,7 @@ bool target_set_closest(int mode)
 
 	/* Set up target information */
 	monster_race_track(m_ptr->r_idx);
-	health_track(cave_m_idx[y][x]);
+	health_track(cave->grid[y][x].m_idx);
 	target_set_monster(m_idx);
 
 	/* Visual cue */
@@ -1194,8 +1234,8 @@ bool target_set_interactive(int mode, int x, int y)
 			/* Update help */
 			if (help)
 			{
-				bool good_target = ((cave_m_idx[y][x] > 0) &&
-								target_able(cave_m_idx[y][x]));
+				bool good_target = ((cave->grid[y][x].m_idx > 0) &&
+								target_able(cave->grid[y][x].m_idx));
 				target_display_help(good_target, !(flag && temp_n));
 			}
 
@@ -1278,7 +1318,7 @@ bool target_set_interactive(int mode, int x, int y)
 				case '0':
 				case '.':
 				{
-					int m_idx = cave_m_idx[y][x];
+					int m_idx = cave->grid[y][x].m_idx;
 
 					if ((m_idx > 0) && target_able(m_idx))
 					{
@@ -1295,8 +1335,9 @@ bool target_set_interactive(int mode, int x, int y)
 
 				case 'g':
 				{
-					cmd_insert(CMD_PATHFIND);
-					cmd_set_arg_point(cmd_get_top(), 0, y, x);
+					cmd_insert(CMD_TRAVEL);
+					cmd_set_arg_choice(cmd_get_top(), 0, TRAVEL_GRID);
+					cmd_set_arg_point(cmd_get_top(), 1, y, x);
 					done = TRUE;
 					break;
 				}
@@ -1376,7 +1417,7 @@ bool target_set_interactive(int mode, int x, int y)
 			/* Update help */
 			if (help) 
 			{
-				bool good_target = ((cave_m_idx[y][x] > 0) && target_able(cave_m_idx[y][x]));
+				bool good_target = ((cave->grid[y][x].m_idx > 0) && target_able(cave->grid[y][x].m_idx));
 				target_display_help(good_target, !(flag && temp_n));
 			}
 
@@ -1399,7 +1440,7 @@ bool target_set_interactive(int mode, int x, int y)
 					   square rather than the square itself (it seems this
 					   is the more likely intention of clicking on a 
 					   monster). */
-					int m_idx = cave_m_idx[y][x];
+					int m_idx = cave->grid[y][x].m_idx;
 
 					if ((m_idx > 0) && target_able(m_idx))
 					{
@@ -1500,8 +1541,9 @@ bool target_set_interactive(int mode, int x, int y)
 
 				case 'g':
 				{
-					cmd_insert(CMD_PATHFIND);
-					cmd_set_arg_point(cmd_get_top(), 0, y, x);
+					cmd_insert(CMD_TRAVEL);
+					cmd_set_arg_choice(cmd_get_top(), 0, TRAVEL_GRID);
+					cmd_set_arg_point(cmd_get_top(), 1, y, x);
 					done = TRUE;
 					break;
 				}
@@ -1537,8 +1579,8 @@ bool target_set_interactive(int mode, int x, int y)
 			/* Handle "direction" */
 			if (d)
 			{
-				int dungeon_hgt = (p_ptr->depth == 0) ? TOWN_HGT : DUNGEON_HGT;
-				int dungeon_wid = (p_ptr->depth == 0) ? TOWN_WID : DUNGEON_WID;
+				int dungeon_hgt = cave->height;
+				int dungeon_wid = cave->width;
 
 				/* Move */
 				x += ddx[d];
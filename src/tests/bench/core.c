@@ -0,0 +1,329 @@
+/* bench/core
+ *
+ * Microbenchmarks of the engine's hottest primitives.  Each case checks
+ * that the primitive still gives a sane answer, and with -v prints the
+ * best time per call of BENCH_RUNS runs, in nanoseconds.
+ *
+ * BENCH_SAVE=file writes those times out as "name ns" lines, and
+ * BENCH_BASELINE=file compares this run against a file written that way.
+ */
+
+#include "unit-test.h"
+#include "angband.h"
+#include "cave.h"
+#include "parser.h"
+
+#define BENCH_RUNS 5
+
+static FILE *bench_save;
+static FILE *bench_base;
+
+static int setup(void **state) {
+	rand_stream rs;
+	char *s;
+	int y, x;
+
+	cave = ZNEW(struct cave);
+	cave->height = DUNGEON_HGT;
+	cave->width = DUNGEON_WID;
+	p_ptr = ZNEW(player_type);
+	op_ptr = ZNEW(player_other);
+	z_info = ZNEW(maxima);
+	view_g = C_ZNEW(VIEW_MAX, u16b);
+	vinfo_init();
+
+	quarks_init();
+	messages_init();
+
+	/* Permanent walls around a level of floor, with a pillar here and there */
+	Rand_stream_init(&rs, 1234);
+	for (y = 0; y < DUNGEON_HGT; y++) {
+		for (x = 0; x < DUNGEON_WID; x++) {
+			bool wall = !in_bounds_fully(y, x) ||
+				(Rand_stream_next(&rs) % 16 == 0);
+
+			cave->grid[y][x].feat = wall ? FEAT_PERM_SOLID : FEAT_FLOOR;
+			cave->grid[y][x].info = wall ? CAVE_WALL : CAVE_GLOW;
+		}
+	}
+
+	p_ptr->py = DUNGEON_HGT / 2;
+	p_ptr->px = DUNGEON_WID / 2;
+	p_ptr->cur_light = 2;
+	cave->grid[p_ptr->py][p_ptr->px].feat = FEAT_FLOOR;
+	cave->grid[p_ptr->py][p_ptr->px].info = CAVE_GLOW;
+	cave->grid[p_ptr->py][p_ptr->px + 1].feat = FEAT_FLOOR;
+	cave->grid[p_ptr->py][p_ptr->px + 1].info = CAVE_GLOW;
+	OPT(adult_ai_sound) = TRUE;
+
+	s = getenv("BENCH_SAVE");
+	if (s && s[0]) bench_save = fopen(s, "w");
+	s = getenv("BENCH_BASELINE");
+	if (s && s[0]) bench_base = fopen(s, "r");
+
+	return 0;
+}
+
+static int teardown(void *state) {
+	if (bench_save) fclose(bench_save);
+	if (bench_base) fclose(bench_base);
+
+	messages_free();
+	quarks_free();
+
+	FREE(view_g);
+	FREE(z_info);
+	FREE(op_ptr);
+	FREE(p_ptr);
+	FREE(cave);
+	return 0;
+}
+
+/* The baseline time of "name", or 0 if there isn't one */
+static double bench_baseline(const char *name) {
+	char buf[80];
+	char key[40];
+	double ns;
+
+	if (!bench_base) return 0;
+
+	rewind(bench_base);
+	while (fgets(buf, sizeof(buf), bench_base)) {
+		if (sscanf(buf, "%39s %lf", key, &ns) != 2) continue;
+		if (!strcmp(key, name)) return ns;
+	}
+
+	return 0;
+}
+
+/* Report the best of the runs, "best" clock ticks for "ops" calls */
+static void bench_report(const char *name, clock_t best, long ops) {
+	double ns = 1e9 * best / CLOCKS_PER_SEC / ops;
+	double base = bench_baseline(name);
+
+	if (bench_save) fprintf(bench_save, "%s %.1f\n", name, ns);
+
+	if (!verbose) return;
+
+	printf("%9.1f ns/op", ns);
+	if (base > 0) printf(" (%.2fx baseline)", ns / base);
+	printf("  ");
+}
+
+/* Time the statement "body", run "ops" times, and keep the best run */
+#define BENCH(name, ops, body) \
+	do { \
+		clock_t best_ = 0; \
+		int run_; \
+		long op_; \
+		for (run_ = 0; run_ < BENCH_RUNS; run_++) { \
+			clock_t start_ = clock(); \
+			for (op_ = 0; op_ < (ops); op_++) { body; } \
+			start_ = clock() - start_; \
+			if (!run_ || start_ < best_) best_ = start_; \
+		} \
+		bench_report(name, best_, ops); \
+	} while (0)
+
+/* Grids around the player for the line-of-sight cases */
+#define BENCH_GRIDS 256
+
+static void bench_grids(int *gy, int *gx) {
+	rand_stream rs;
+	int i;
+
+	Rand_stream_init(&rs, 5678);
+	for (i = 0; i < BENCH_GRIDS; i++) {
+		gy[i] = p_ptr->py - MAX_SIGHT + Rand_stream_next(&rs) % (2 * MAX_SIGHT);
+		gx[i] = p_ptr->px - MAX_SIGHT + Rand_stream_next(&rs) % (2 * MAX_SIGHT);
+	}
+}
+
+static int test_los(void *state) {
+	int gy[BENCH_GRIDS], gx[BENCH_GRIDS];
+	int py = p_ptr->py, px = p_ptr->px;
+	int seen = 0;
+
+	bench_grids(gy, gx);
+
+	require(los(py, px, py, px + 1));
+
+	BENCH("los", 200000L,
+		seen += los(py, px, gy[op_ % BENCH_GRIDS], gx[op_ % BENCH_GRIDS]));
+
+	require(seen > 0);
+	ok;
+}
+
+static int test_project_path(void *state) {
+	int gy[BENCH_GRIDS], gx[BENCH_GRIDS];
+	int py = p_ptr->py, px = p_ptr->px;
+	u16b path[MAX_RANGE];
+	long steps = 0;
+
+	bench_grids(gy, gx);
+
+	eq(project_path(path, MAX_RANGE, py, px, py, px + 1, 0), 1);
+
+	BENCH("project_path", 200000L,
+		steps += project_path(path, MAX_RANGE, py, px,
+		                      gy[op_ % BENCH_GRIDS], gx[op_ % BENCH_GRIDS], 0));
+
+	require(steps > 0);
+	ok;
+}
+
+static int test_update_view(void *state) {
+	int px = p_ptr->px;
+
+	update_view();
+	require(player_has_los_bold(p_ptr->py, px + 1));
+
+	/* Step back and forth, so that every call casts every octant */
+	BENCH("update_view", 2000L,
+		p_ptr->px = px + (op_ & 1); update_view());
+
+	p_ptr->px = px;
+	update_view();
+	ok;
+}
+
+static int test_update_flow(void *state) {
+	int py = p_ptr->py, px = p_ptr->px;
+
+	update_flow();
+	eq(cave->cost[py][px], 0);
+	eq(cave->cost[py][px + 1], 1);
+
+	BENCH("update_flow", 500L,
+		p_ptr->px = px + (op_ & 1); update_flow());
+
+	p_ptr->px = px;
+	ok;
+}
+
+#define BENCH_QUARKS 1000
+
+static int test_quark_add(void *state) {
+	static char names[BENCH_QUARKS][32];
+	quark_t q = 0;
+	int i;
+
+	for (i = 0; i < BENCH_QUARKS; i++) {
+		sprintf(names[i], "@r%d!k", i);
+		quark_add(names[i]);
+	}
+
+	/* Looking up inscriptions which are already there is the usual case */
+	BENCH("quark_add", 200000L, q = quark_add(names[op_ % BENCH_QUARKS]));
+
+	require(!strcmp(quark_str(q), names[(200000L - 1) % BENCH_QUARKS]));
+	ok;
+}
+
+static int test_message_add(void *state) {
+	static const char *msgs[] = {
+		"You hit the cave orc.", "The cave orc hits you.",
+		"You have slain the cave orc.", "You feel something roll beneath your feet."
+	};
+
+	BENCH("message_add", 200000L, message_add(msgs[op_ & 3], MSG_GENERIC));
+
+	require(!strcmp(message_str(0), msgs[(200000L - 1) & 3]));
+	ok;
+}
+
+static int test_flags(void *state) {
+	bitflag f1[OF_SIZE], f2[OF_SIZE];
+	int hits = 0;
+
+	flag_wipe(f1, OF_SIZE);
+	flag_wipe(f2, OF_SIZE);
+	flag_on(f2, OF_SIZE, 5);
+
+	BENCH("flag_ops", 1000000L,
+		flag_on(f1, OF_SIZE, op_ % (OF_SIZE * FLAG_WIDTH) + 1);
+		hits += flag_is_inter(f1, f2, OF_SIZE);
+		flag_union(f2, f1, OF_SIZE);
+		flag_off(f1, OF_SIZE, op_ % (OF_SIZE * FLAG_WIDTH) + 1));
+
+	require(hits > 0);
+	ok;
+}
+
+static int bench_directives;
+
+static enum parser_error count_directive(struct parser *p) {
+	(void)parser_getint(p, "level");
+	(void)parser_getstr(p, "name");
+	bench_directives++;
+	return PARSE_ERROR_NONE;
+}
+
+static int test_strnfmt(void *state) {
+	char buf[80];
+	size_t n = 0;
+
+	/* The shape of most monster and object messages */
+	BENCH("strnfmt", 500000L,
+		n = strnfmt(buf, sizeof(buf), "%^s hits %s.", "the cave orc", "you"));
+
+	eq(n, strlen("The cave orc hits you."));
+	require(!strcmp(buf, "The cave orc hits you."));
+	ok;
+}
+
+static int test_term_save(void *state) {
+	term t, *old = Term;
+
+	/* A big main window */
+	eq(term_init(&t, 200, 60, 64), 0);
+	Term_activate(&t);
+	Term_putstr(0, 0, -1, TERM_WHITE, "Saved");
+
+	/* A menu popping up and going away */
+	BENCH("Term_save", 20000L, {
+		Term_save();
+		Term_putstr(0, 0, -1, TERM_WHITE, "Menu");
+		Term_load();
+	});
+
+	eq(t.saved, 0);
+	require(!memcmp(t.scr->c[0], "Saved", 5));
+
+	Term_activate(old);
+	term_nuke(&t);
+	ok;
+}
+
+static int test_parser_parse(void *state) {
+	struct parser *p = parser_new();
+	enum parser_error r = PARSE_ERROR_NONE;
+
+	require(p);
+	eq(parser_reg(p, "N int level str name", count_directive), 0);
+
+	BENCH("parser_parse", 100000L,
+		r |= parser_parse(p, "N:42:Grip, Farmer Maggot's Dog"));
+
+	eq(r, PARSE_ERROR_NONE);
+	eq(bench_directives, 100000L * BENCH_RUNS);
+
+	parser_destroy(p);
+	ok;
+}
+
+static const char *suite_name = "bench/core";
+static struct test tests[] = {
+	{ "los", test_los },
+	{ "project_path", test_project_path },
+	{ "update_view", test_update_view },
+	{ "update_flow", test_update_flow },
+	{ "quark_add", test_quark_add },
+	{ "message_add", test_message_add },
+	{ "flag_ops", test_flags },
+	{ "strnfmt", test_strnfmt },
+	{ "Term_save", test_term_save },
+	{ "parser_parse", test_parser_parse },
+	{ NULL, NULL }
+};
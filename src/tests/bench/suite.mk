@@ -0,0 +1,3 @@
+TESTPROGS += bench/core
+
+bench/core : bench/core.c ../angband.o
@@ -0,0 +1,121 @@
+/* game-event/queue.c */
+
+#include "unit-test.h"
+#include "z-virt.h"
+#include "game-event.h"
+
+static int points, hps, flags, wholes;
+static int points_at_flag;
+static int last_x, last_y;
+
+static void handler(game_event_type type, game_event_data *data, void *user) {
+	if (type == EVENT_MAP) {
+		if (data->point.x == -1 && data->point.y == -1)
+			wholes++;
+		else
+			points++;
+		last_x = data->point.x;
+		last_y = data->point.y;
+	} else if (type == EVENT_HP) {
+		hps++;
+	} else if (type == EVENT_STATE) {
+		points_at_flag = points;
+		flags++;
+	}
+}
+
+static int setup(void **state) {
+	event_add_handler(EVENT_MAP, handler, NULL);
+	event_add_handler(EVENT_HP, handler, NULL);
+	event_add_handler(EVENT_STATE, handler, NULL);
+	return 0;
+}
+
+static int teardown(void *state) {
+	event_remove_handler(EVENT_MAP, handler, NULL);
+	event_remove_handler(EVENT_HP, handler, NULL);
+	event_remove_handler(EVENT_STATE, handler, NULL);
+	return 0;
+}
+
+static void reset(void) {
+	points = hps = flags = wholes = 0;
+}
+
+static int test_direct(void *state) {
+	reset();
+	event_signal_point(EVENT_MAP, 1, 2);
+	event_signal_point(EVENT_MAP, 1, 2);
+	event_signal(EVENT_HP);
+	eq(points, 2);
+	eq(hps, 1);
+	ok;
+}
+
+static int test_coalesce(void *state) {
+	int i;
+
+	reset();
+	event_queue_begin();
+	for (i = 0; i < 1000; i++) {
+		event_signal_point(EVENT_MAP, i % 10, i % 7);
+		event_signal(EVENT_HP);
+	}
+	eq(points, 0);
+	eq(hps, 0);
+	event_queue_end();
+	eq(points, 70);
+	eq(hps, 1);
+	ok;
+}
+
+static int test_nested(void *state) {
+	reset();
+	event_queue_begin();
+	event_queue_begin();
+	event_signal_point(EVENT_MAP, 3, 4);
+	event_queue_end();
+	eq(points, 0);
+	event_queue_end();
+	eq(points, 1);
+	eq(last_x, 3);
+	eq(last_y, 4);
+	ok;
+}
+
+static int test_whole_map(void *state) {
+	reset();
+	event_queue_begin();
+	event_signal_point(EVENT_MAP, 3, 4);
+	event_signal_point(EVENT_MAP, -1, -1);
+	event_signal_point(EVENT_MAP, 5, 6);
+	event_queue_end();
+	eq(points, 0);
+	eq(wholes, 1);
+	ok;
+}
+
+static int test_order(void *state) {
+	reset();
+	event_queue_begin();
+	event_signal_point(EVENT_MAP, 3, 4);
+	event_signal_flag(EVENT_STATE, TRUE);
+	eq(flags, 1);
+
+	/* Anything queued must have been sent first */
+	eq(points_at_flag, 1);
+	event_signal_point(EVENT_MAP, 3, 4);
+	event_queue_end();
+	eq(points, 2);
+	ok;
+}
+
+static const char *suite_name = "game-event/queue";
+static struct test tests[] = {
+	{ "direct", test_direct },
+	{ "coalesce", test_coalesce },
+	{ "nested", test_nested },
+	{ "whole_map", test_whole_map },
+	{ "order", test_order },
+	{ NULL, NULL }
+};
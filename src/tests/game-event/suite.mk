@@ -0,0 +1,3 @@
+TESTPROGS += game-event/queue
+
+game-event/queue : game-event/queue.c ../angband.o
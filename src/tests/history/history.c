@@ -0,0 +1,81 @@
+/* history/history */
+
+#include "unit-test.h"
+#include "unit-test-data.h"
+
+#include "history.h"
+
+static int setup(void **state) {
+	history_clear();
+	return 0;
+}
+
+static int teardown(void *state) {
+	history_clear();
+	return 0;
+}
+
+static int test_grow(void *state) {
+	char buf[80];
+	int i;
+
+	history_clear();
+	for (i = 0; i < 1000; i++) {
+		strnfmt(buf, sizeof(buf), "Event %d", i);
+		require(history_add_full(HISTORY_USER_INPUT, 0, 1, 2, i, buf));
+	}
+
+	eq(history_get_num(), 1000);
+	require(streq(history_list[0].event, "Event 0"));
+	require(streq(history_list[999].event, "Event 999"));
+	eq(history_list[999].turn, 999);
+	ok;
+}
+
+static int test_artifact_known(void *state) {
+	history_clear();
+	history_add_full(HISTORY_PLAYER_BIRTH, 0, 0, 1, 1, "Born");
+	history_add_full(HISTORY_ARTIFACT_UNKNOWN, 5, 3, 4, 10, "Found it");
+	require(!history_is_artifact_known(5));
+	require(!history_is_artifact_known(6));
+
+	history_add_full(HISTORY_ARTIFACT_KNOWN, 6, 3, 4, 11, "Found another");
+	require(history_is_artifact_known(6));
+
+	history_unmask_unknown();
+	require(history_is_artifact_known(5));
+	eq(history_list[1].type, HISTORY_ARTIFACT_KNOWN);
+
+	history_clear();
+	require(!history_is_artifact_known(5));
+	require(!history_is_artifact_known(6));
+	ok;
+}
+
+static int test_artifact_lost(void *state) {
+	history_clear();
+	history_add_full(HISTORY_ARTIFACT_KNOWN, 7, 3, 4, 10, "Found it");
+	history_add_full(HISTORY_GAIN_LEVEL, 0, 3, 5, 12, "Levelled up");
+
+	/* Losing it marks the newest entry */
+	require(history_lose_artifact(7));
+	require(history_list[0].type & HISTORY_ARTIFACT_LOST);
+	require(!(history_list[1].type & HISTORY_ARTIFACT_LOST));
+
+	/* It stays known, lost or not */
+	require(history_is_artifact_known(7));
+
+	/* A second find gets its own entry, which is the one lost next */
+	history_add_full(HISTORY_ARTIFACT_UNKNOWN, 7, 8, 9, 20, "Found it again");
+	require(history_lose_artifact(7));
+	require(history_list[2].type & HISTORY_ARTIFACT_LOST);
+	ok;
+}
+
+static const char *suite_name = "history/history";
+static struct test tests[] = {
+	{ "grow", test_grow },
+	{ "artifact-known", test_artifact_known },
+	{ "artifact-lost", test_artifact_lost },
+	{ NULL, NULL }
+};
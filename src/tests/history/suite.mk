@@ -0,0 +1,3 @@
+TESTPROGS += history/history
+
+history/history : history/history.c ../angband.o
@@ -0,0 +1,118 @@
+/* macro/lookup.c */
+
+#include <time.h>
+
+#include "unit-test.h"
+#include "defines.h"
+#include "macro.h"
+#include "z-util.h"
+
+static int setup(void **state) {
+	macro_init();
+	ok;
+}
+
+static int teardown(void *state) {
+	macro_free();
+	ok;
+}
+
+static int test_exact(void *state) {
+	require(macro_add("\033[A", "8") == 0);
+	require(macro_add("\033[B", "2") == 0);
+	require(macro_add("\033[", "x") == 0);
+	require(macro_add("q", "Q") == 0);
+
+	require(macro_find_exact("\033[A") >= 0);
+	require(streq(macro__act[macro_find_exact("\033[B")], "2"));
+	require(streq(macro__act[macro_find_exact("\033[")], "x"));
+	require(macro_find_exact("\033") < 0);
+	require(macro_find_exact("\033[C") < 0);
+	require(macro_find_exact("z") < 0);
+
+	/* Redefinition replaces the action */
+	require(macro_add("q", "R") == 0);
+	require(streq(macro__act[macro_find_exact("q")], "R"));
+
+	ok;
+}
+
+static int test_prefix(void *state) {
+	/* Patterns which contain the keys so far */
+	require(macro_find_check("\033") >= 0);
+	require(macro_find_check("\033[") >= 0);
+	require(macro_find_check("\033[A") >= 0);
+	require(macro_find_check("\033]") < 0);
+
+	/* Patterns which contain them and more */
+	require(macro_find_maybe("\033[") >= 0);
+	require(macro_find_maybe("\033[A") < 0);
+	require(macro_find_maybe("q") < 0);
+
+	/* The longest pattern the keys start with */
+	require(streq(macro__act[macro_find_ready("\033[A")], "8"));
+	require(streq(macro__act[macro_find_ready("\033[Ab")], "8"));
+	require(streq(macro__act[macro_find_ready("\033[C")], "x"));
+	require(macro_find_ready("\033") < 0);
+	require(macro_find_ready("z") < 0);
+
+	ok;
+}
+
+#define BENCH_MACROS 400
+#define BENCH_KEYS 200000
+
+/*
+ * Look keys up the way inkey_aux() does: check the first key, then take
+ * more while a longer macro might match, then find the longest match.
+ */
+static int replay_keys(const char *keys) {
+	char buf[32];
+	int p = 0;
+
+	buf[p++] = keys[0];
+	buf[p] = '\0';
+	if (macro_find_check(buf) < 0) return -1;
+
+	while (macro_find_maybe(buf) >= 0 && keys[p]) {
+		buf[p] = keys[p];
+		buf[++p] = '\0';
+	}
+
+	return macro_find_ready(buf);
+}
+
+static int test_bench(void *state) {
+	char buf[32];
+	clock_t start;
+	int i, found = 0;
+
+	for (i = 0; i < BENCH_MACROS; i++) {
+		sprintf(buf, "\033O%d~", i);
+		require(macro_add(buf, "a") == 0);
+	}
+
+	/* Keys which mostly match a macro, and sometimes don't */
+	start = clock();
+	for (i = 0; i < BENCH_KEYS; i++) {
+		sprintf(buf, "\033O%d~", i % (BENCH_MACROS + 50));
+		if (replay_keys(buf) >= 0) found++;
+	}
+
+	require(found == BENCH_KEYS / (BENCH_MACROS + 50) * BENCH_MACROS +
+		MIN(BENCH_KEYS % (BENCH_MACROS + 50), BENCH_MACROS));
+
+	if (verbose)
+		printf("%d keys against %d macros %.1fms  ", BENCH_KEYS,
+		       macro__num, 1000.0 * (clock() - start) / CLOCKS_PER_SEC);
+
+	ok;
+}
+
+static const char *suite_name = "macro/lookup";
+static struct test tests[] = {
+	{ "exact", test_exact },
+	{ "prefix", test_prefix },
+	{ "bench", test_bench },
+	{ NULL, NULL }
+};
@@ -0,0 +1,3 @@
+TESTPROGS += macro/lookup
+
+macro/lookup : macro/lookup.c ../angband.o
@@ -3,6 +3,8 @@
 #include "unit-test.h"
 
 #include "parser.h"
+#include "z-form.h"
+#include "z-util.h"
 
 static int setup(void **state) {
 	struct parser *p = parser_new();
@@ -104,6 +106,32 @@ static int test_reg_str(void *state) {
 	ok;
 }
 
+static enum parser_error failed(struct parser *p) {
+	return PARSE_ERROR_GENERIC;
+}
+
+static int test_reg_dup(void *state) {
+	char fmt[32];
+	int i;
+	errr r = parser_reg(state, "test-reg-dup int foo", failed);
+	eq(r, 0);
+	r = parser_reg(state, "test-reg-dup int foo", ignored);
+	eq(r, 0);
+
+	/* Enough more hooks to grow the lookup table */
+	for (i = 0; i < 40; i++) {
+		strnfmt(fmt, sizeof(fmt), "test-reg-dup%d int foo", i);
+		r = parser_reg(state, fmt, failed);
+		eq(r, 0);
+	}
+
+	r = parser_parse(state, "test-reg-dup:1");
+	eq(r, PARSE_ERROR_NONE);
+	r = parser_parse(state, "test-reg-dup39:1");
+	eq(r, PARSE_ERROR_GENERIC);
+	ok;
+}
+
 static enum parser_error helper_sym0(struct parser *p) {
 	const char *s = parser_getsym(p, "foo");
 	int *wasok = parser_priv(p);
@@ -202,6 +230,29 @@ static int test_str0(void *state) {
 	ok;
 }
 
+static enum parser_error helper_slice0(struct parser *p) {
+	const char *s = parser_getstr(p, "s0");
+	int *wasok = parser_priv(p);
+	if (!streq(s, "foo:bar"))
+		return PARSE_ERROR_GENERIC;
+	*wasok = 1;
+	return PARSE_ERROR_NONE;
+}
+
+static int test_slice0(void *state) {
+	const char *lines = "test-slice0:foo:bar\ntest-slice0:baz";
+	int wasok = 0;
+	errr r = parser_reg(state, "test-slice0 str s0", helper_slice0);
+	eq(r, 0);
+	parser_setpriv(state, &wasok);
+	r = parser_parse_n(state, lines, strchr(lines, '\n') - lines);
+	eq(r, PARSE_ERROR_NONE);
+	eq(wasok, 1);
+	r = parser_parse_n(state, lines, 0);
+	eq(r, PARSE_ERROR_NONE);
+	ok;
+}
+
 static int test_syntax0(void *state) {
 	struct parser_state s;
 	int v;
@@ -428,6 +479,7 @@ static struct test tests[] = {
 	{ "int1", test_int1 },
 
 	{ "str0", test_str0 },
+	{ "slice0", test_slice0 },
 
 	{ "rand0", test_rand0 },
 	{ "rand1", test_rand1 },
@@ -442,5 +494,7 @@ static struct test tests[] = {
 
 	{ "baddir", test_baddir },
 
+	{ "reg-dup", test_reg_dup },
+
 	{ NULL, NULL }
 };
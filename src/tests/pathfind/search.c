@@ -0,0 +1,89 @@
+/* pathfind/search */
+
+#include "unit-test.h"
+#include "angband.h"
+
+/* A wall from (5, 1) to (5, 18), with a gap at the bottom */
+static bool walled(int y, int x) {
+	if (!in_bounds_fully(y, x)) return FALSE;
+	return (x != 5) || (y >= 19);
+}
+
+static bool open_floor(int y, int x) {
+	return in_bounds_fully(y, x);
+}
+
+static bool nowhere(int y, int x) {
+	return FALSE;
+}
+
+static int setup(void **state) {
+	cave = ZNEW(struct cave);
+	cave->height = DUNGEON_HGT;
+	cave->width = DUNGEON_WID;
+	return 0;
+}
+
+static int teardown(void *state) {
+	FREE(cave);
+	return 0;
+}
+
+static int test_straight(void *state) {
+	byte path[250];
+	int n = path_search(10, 10, 10, 20, open_floor, path, 250);
+	int i;
+	eq(n, 10);
+	for (i = 0; i < n; i++)
+		eq(path[i], 6);
+	ok;
+}
+
+static int test_diagonal(void *state) {
+	byte path[250];
+	int n = path_search(10, 10, 20, 15, open_floor, path, 250);
+	eq(n, 10);
+	ok;
+}
+
+static int test_around(void *state) {
+	byte path[250];
+	int y = 10, x = 2, i;
+	int n = path_search(y, x, 10, 8, walled, path, 250);
+	require(n > 0);
+	for (i = n - 1; i >= 0; i--) {
+		y += ddy[path[i]];
+		x += ddx[path[i]];
+		require(walled(y, x));
+	}
+	eq(y, 10);
+	eq(x, 8);
+	/* Down to the gap at y = 19, then back up */
+	eq(n, 18);
+	ok;
+}
+
+static int test_unreachable(void *state) {
+	byte path[250];
+	eq(path_search(10, 10, 10, 12, nowhere, path, 250), -1);
+	/* The destination itself needn't be passable */
+	eq(path_search(10, 10, 10, 11, nowhere, path, 250), 1);
+	ok;
+}
+
+static int test_toolong(void *state) {
+	byte path[250];
+	eq(path_search(10, 10, 10, 20, open_floor, path, 9), -1);
+	eq(path_search(10, 10, 10, 20, open_floor, path, 10), 10);
+	ok;
+}
+
+static const char *suite_name = "pathfind/search";
+static struct test tests[] = {
+	{ "straight", test_straight },
+	{ "diagonal", test_diagonal },
+	{ "around", test_around },
+	{ "unreachable", test_unreachable },
+	{ "toolong", test_toolong },
+	{ NULL, NULL }
+};
@@ -0,0 +1,3 @@
+TESTPROGS += pathfind/search
+
+pathfind/search : pathfind/search.c ../angband.o
@@ -0,0 +1,366 @@
+/* savefile/blocks */
+
+#include "unit-test.h"
+#include "unit-test-data.h"
+
+#include <time.h>
+
+#include "history.h"
+#include "savefile.h"
+#include "z-msg.h"
+
+#define SAVE_A	"savefile-test-a.sav"
+#define SAVE_B	"savefile-test-b.sav"
+#define DELTA_A	SAVE_A ".delta"
+
+/* Enough history and messages to look like a character at the end of a game */
+#define FIXTURE_HISTORY		2000
+#define FIXTURE_MESSAGES	400
+
+/* Times each block is saved and loaded for the timings */
+#define TIMING_TRIES		50
+
+static const char *const rng_blocks[] = { "rng", NULL };
+static const char *const misc_blocks[] = { "misc", NULL };
+static const char *const message_blocks[] = { "messages", NULL };
+static const char *const history_blocks[] = { "history", NULL };
+static const char *const lore_blocks[] = { "monster memory", NULL };
+static const char *const all_blocks[] =
+		{ "rng", "misc", "messages", "history", NULL };
+
+/* A few monster races to remember, the last being the ghost */
+#define FIXTURE_RACES	5
+
+static maxima fixture_z;
+static monster_race fixture_races[FIXTURE_RACES];
+static monster_lore fixture_lore[FIXTURE_RACES];
+
+/* Know a fair bit about race 1, and have killed unique race 3 */
+static void fixture_fill_lore(void) {
+	int i;
+
+	z_info = &fixture_z;
+	z_info->r_max = FIXTURE_RACES;
+	r_info = fixture_races;
+	l_list = fixture_lore;
+
+	rf_on(r_info[3].flags, RF_UNIQUE);
+	rsf_on(r_info[1].spell_flags, RSF_BLINK);
+	for (i = 0; i < FIXTURE_RACES; i++)
+		r_info[i].max_num = lore_default_max_num(i);
+
+	l_list[1].sights = 12;
+	l_list[1].pkills = 3;
+	l_list[1].blows[2] = 7;
+	rf_on(l_list[1].flags, RF_UNIQUE);
+	rsf_on(l_list[1].spell_flags, RSF_BLINK);
+	l_list[3].pkills = 1;
+	r_info[3].max_num = 0;
+}
+
+static void fixture_fill(void) {
+	char buf[80];
+	int i;
+
+	Rand_state_init(0x1234abcd);
+
+	seed_randart = 0x11111111;
+	seed_dungeon = 0x22222222;
+	seed_flavor = 0x33333333;
+	seed_town = 0x44444444;
+	p_ptr->total_winner = 1;
+	p_ptr->noscore = 0x0002;
+	feeling = 7;
+	old_turn = 123456;
+	turn = 9876543;
+
+	history_clear();
+	for (i = 0; i < FIXTURE_HISTORY; i++) {
+		strnfmt(buf, sizeof(buf), "Reached level %d and slew foe %d.",
+				i / 40, i);
+		history_add_full(HISTORY_PLAYER_BIRTH, i % 256, i % 128, i / 40,
+				i * 1000, buf);
+	}
+
+	messages_free();
+	messages_init();
+	for (i = 0; i < FIXTURE_MESSAGES; i++) {
+		strnfmt(buf, sizeof(buf), "You hit the test monster %d.", i);
+		message_add(buf, i % 4);
+	}
+}
+
+static void fixture_wipe(void) {
+	int i;
+
+	Rand_state_init(0);
+
+	seed_randart = seed_dungeon = seed_flavor = seed_town = 0;
+	p_ptr->total_winner = 0;
+	p_ptr->noscore = 0;
+	feeling = 0;
+	old_turn = turn = 0;
+
+	history_clear();
+
+	messages_free();
+	messages_init();
+
+	if (l_list == fixture_lore) {
+		C_WIPE(l_list, FIXTURE_RACES, monster_lore);
+		for (i = 0; i < FIXTURE_RACES; i++)
+			r_info[i].max_num = 99;
+	}
+}
+
+/* Read all of file `path` into a new buffer of size `*len` */
+static char *slurp(const char *path, size_t *len) {
+	FILE *f = fopen(path, "rb");
+	char *buf;
+
+	if (!f) return NULL;
+	fseek(f, 0, SEEK_END);
+	*len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	buf = mem_alloc(*len ? *len : 1);
+	if (fread(buf, 1, *len, f) != *len) {
+		mem_free(buf);
+		buf = NULL;
+	}
+
+	fclose(f);
+	return buf;
+}
+
+/* Whether files `a` and `b` are identical */
+static bool same_file(const char *a, const char *b) {
+	size_t alen, blen;
+	char *abuf = slurp(a, &alen);
+	char *bbuf = slurp(b, &blen);
+	bool same = abuf && bbuf && alen == blen && !memcmp(abuf, bbuf, alen);
+
+	mem_free(abuf);
+	mem_free(bbuf);
+	return same;
+}
+
+/* Write the `len` bytes at `buf` to file `path` */
+static bool spit(const char *path, const char *buf, size_t len) {
+	FILE *f = fopen(path, "wb");
+	bool done;
+
+	if (!f) return FALSE;
+	done = (fwrite(buf, 1, len, f) == len);
+	fclose(f);
+	return done;
+}
+
+/* Whether the `len` bytes at `buf` hold a block named `name` */
+static bool has_block(const char *buf, size_t len, const char *name) {
+	size_t i;
+
+	for (i = 0; i + strlen(name) < len; i++)
+		if (!memcmp(buf + i, name, strlen(name) + 1)) return TRUE;
+
+	return FALSE;
+}
+
+/*
+ * Save `blocks`, wipe the game, load them back and save them again; the
+ * two savefiles have to match byte for byte.
+ */
+static bool roundtrip(const char *const *blocks) {
+	if (!savefile_save_blocks(SAVE_A, blocks)) return FALSE;
+	fixture_wipe();
+	if (!savefile_load_blocks(SAVE_A, blocks)) return FALSE;
+	if (!savefile_save_blocks(SAVE_B, blocks)) return FALSE;
+
+	return same_file(SAVE_A, SAVE_B);
+}
+
+static int setup(void **state) {
+	messages_init();
+	return 0;
+}
+
+static int teardown(void *state) {
+	remove(SAVE_A);
+	remove(SAVE_B);
+	remove(DELTA_A);
+	history_clear();
+	messages_free();
+	return 0;
+}
+
+static int test_rng(void *state) {
+	u32b before, after;
+
+	fixture_fill();
+	require(roundtrip(rng_blocks));
+
+	/* The generator has to carry on where it left off */
+	fixture_fill();
+	require(savefile_save_blocks(SAVE_A, rng_blocks));
+	before = randint0(0x10000000);
+	fixture_wipe();
+	require(savefile_load_blocks(SAVE_A, rng_blocks));
+	after = randint0(0x10000000);
+	eq(before, after);
+	ok;
+}
+
+static int test_misc(void *state) {
+	fixture_fill();
+	require(roundtrip(misc_blocks));
+	eq(seed_flavor, 0x33333333);
+	eq(p_ptr->total_winner, 1);
+	eq(feeling, 7);
+	eq(turn, 9876543);
+	ok;
+}
+
+static int test_messages(void *state) {
+	fixture_fill();
+	require(roundtrip(message_blocks));
+
+	/* Only the last 80 are kept */
+	eq(messages_num(), 80);
+	require(streq(message_str(0), "You hit the test monster 399."));
+	ok;
+}
+
+static int test_history(void *state) {
+	fixture_fill();
+	require(roundtrip(history_blocks));
+	eq(history_get_num(), FIXTURE_HISTORY);
+	require(streq(history_list[FIXTURE_HISTORY - 1].event,
+			"Reached level 49 and slew foe 1999."));
+	eq(history_list[FIXTURE_HISTORY - 1].turn, (FIXTURE_HISTORY - 1) * 1000);
+	ok;
+}
+
+static int test_lore(void *state) {
+	fixture_fill_lore();
+	require(roundtrip(lore_blocks));
+	eq(l_list[1].sights, 12);
+	eq(l_list[1].blows[2], 7);
+	require(rf_has(l_list[1].flags, RF_UNIQUE));
+	require(rsf_has(l_list[1].spell_flags, RSF_BLINK));
+	eq(l_list[3].pkills, 1);
+
+	/* Limits not written come back as they start a game */
+	eq(r_info[1].max_num, 100);
+	eq(r_info[3].max_num, 0);
+	eq(r_info[FIXTURE_RACES - 1].max_num, 0);
+	eq(l_list[2].sights, 0);
+	ok;
+}
+
+static int test_selective(void *state) {
+	fixture_fill();
+	require(savefile_save_blocks(SAVE_A, all_blocks));
+	fixture_wipe();
+
+	/* Load just the history, stepping over everything before it */
+	require(savefile_load_blocks(SAVE_A, history_blocks));
+	eq(history_get_num(), FIXTURE_HISTORY);
+	eq(turn, 0);
+	eq(messages_num(), 0);
+
+	/* And then everything */
+	history_clear();
+	require(savefile_load_blocks(SAVE_A, all_blocks));
+	eq(history_get_num(), FIXTURE_HISTORY);
+	eq(turn, 9876543);
+	eq(messages_num(), 80);
+	ok;
+}
+
+static int test_delta(void *state) {
+	char *delta;
+	size_t len;
+
+	fixture_fill();
+	require(savefile_save_blocks(SAVE_A, all_blocks));
+
+	/* Only the turn changes, so only the misc block goes in the delta */
+	turn = 5555;
+	require(savefile_save_blocks_delta(SAVE_A, all_blocks));
+	delta = slurp(DELTA_A, &len);
+	require(delta);
+	require(has_block(delta, len, "misc"));
+	require(!has_block(delta, len, "history"));
+
+	/* Loading lays it over the savefile */
+	fixture_wipe();
+	require(savefile_load_blocks(SAVE_A, all_blocks));
+	eq(turn, 5555);
+	eq(history_get_num(), FIXTURE_HISTORY);
+	eq(messages_num(), 80);
+
+	/* A full save does away with it */
+	require(savefile_save_blocks(SAVE_A, all_blocks));
+	require(!fopen(DELTA_A, "rb"));
+
+	/* And one left over from another savefile is ignored */
+	fixture_fill();
+	turn = 1234;
+	require(savefile_save_blocks(SAVE_A, all_blocks));
+	require(spit(DELTA_A, delta, len));
+	mem_free(delta);
+	fixture_wipe();
+	require(savefile_load_blocks(SAVE_A, all_blocks));
+	eq(history_get_num(), FIXTURE_HISTORY);
+	eq(turn, 1234);
+	ok;
+}
+
+/*
+ * Time saving and loading each block of the fixture; the figures are only
+ * shown in verbose mode, for comparing changes to the format.
+ */
+static int test_timing(void *state) {
+	static const char *const *const block_lists[] =
+			{ rng_blocks, misc_blocks, message_blocks, history_blocks };
+	size_t i;
+	int j;
+
+	for (i = 0; i < N_ELEMENTS(block_lists); i++) {
+		clock_t start, saved, loaded;
+
+		fixture_fill();
+
+		start = clock();
+		for (j = 0; j < TIMING_TRIES; j++)
+			require(savefile_save_blocks(SAVE_A, block_lists[i]));
+		saved = clock();
+		for (j = 0; j < TIMING_TRIES; j++) {
+			fixture_wipe();
+			require(savefile_load_blocks(SAVE_A, block_lists[i]));
+		}
+		loaded = clock();
+
+		if (verbose)
+			printf("\n    %-10s save %6.1fus  load %6.1fus",
+					block_lists[i][0],
+					(saved - start) * 1e6 / CLOCKS_PER_SEC / TIMING_TRIES,
+					(loaded - saved) * 1e6 / CLOCKS_PER_SEC / TIMING_TRIES);
+	}
+
+	if (verbose) printf("\n  %-16s  ", "");
+	ok;
+}
+
+static const char *suite_name = "savefile/blocks";
+static struct test tests[] = {
+	{ "rng", test_rng },
+	{ "misc", test_misc },
+	{ "messages", test_messages },
+	{ "history", test_history },
+	{ "lore", test_lore },
+	{ "selective", test_selective },
+	{ "delta", test_delta },
+	{ "timing", test_timing },
+	{ NULL, NULL }
+};
@@ -0,0 +1,3 @@
+TESTPROGS += savefile/blocks
+
+savefile/blocks : savefile/blocks.c ../angband.o
@@ -0,0 +1,3 @@
+TESTPROGS += x-char/trans
+
+x-char/trans : x-char/trans.c ../angband.o
@@ -0,0 +1,62 @@
+/* x-char/trans */
+
+#include "unit-test.h"
+#include "angband.h"
+
+nosetup;
+noteardown;
+
+static int test_plain(void *state) {
+	char buf[80] = "No encodes here [nor here";
+
+	xstr_trans(buf, LATIN1);
+	require(streq(buf, "No encodes here [nor here"));
+	ok;
+}
+
+static int test_decode(void *state) {
+	char buf[80] = "[Aacute]b[`e] [bogus] [\"y][yuml]";
+
+	xstr_trans(buf, LATIN1);
+	eq((byte)buf[0], 193);
+	eq(buf[1], 'b');
+	eq((byte)buf[2], 232);
+	require(!strncmp(buf + 3, " [bogus] ", 9));
+	eq((byte)buf[12], 255);
+	eq((byte)buf[13], 255);
+	eq(buf[14], '\0');
+	ok;
+}
+
+static int test_ascii(void *state) {
+	char buf[80] = "[Eacute]owyn";
+
+	xstr_trans(buf, ASCII);
+	require(streq(buf, "Eowyn"));
+	ok;
+}
+
+static int test_escape(void *state) {
+	char buf[80] = "[Aacute]b[`e]";
+	char out[80];
+
+	xstr_trans(buf, LATIN1);
+
+	/* The first encode in the table for each character is used */
+	escape_latin1(out, sizeof(out), buf);
+	require(streq(out, "['A]b[`e]"));
+
+	/* Running out of space */
+	escape_latin1(out, 4, buf);
+	require(streq(out, "['A"));
+	ok;
+}
+
+static const char *suite_name = "x-char/trans";
+static struct test tests[] = {
+	{ "plain", test_plain },
+	{ "decode", test_decode },
+	{ "ascii", test_ascii },
+	{ "escape", test_escape },
+	{ NULL, NULL }
+};
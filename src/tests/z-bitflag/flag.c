@@ -0,0 +1,166 @@
+/* z-bitflag/flag */
+
+#include "unit-test.h"
+#include "z-bitflag.h"
+#include "z-rand.h"
+
+/* Odd-sized, so that there are bytes left over after the whole words */
+#define SIZE 13
+
+nosetup;
+noteardown;
+
+static void fill(bitflag *f, int seed) {
+	size_t i;
+
+	for (i = 0; i < SIZE; i++)
+		f[i] = (bitflag) ((seed * 37 + i * 101) ^ (i * i));
+}
+
+int test_tests(void *state) {
+	bitflag f1[SIZE], f2[SIZE];
+
+	flag_wipe(f1, SIZE);
+	require(flag_is_empty(f1, SIZE));
+	f1[SIZE - 1] = 0x10;
+	require(!flag_is_empty(f1, SIZE));
+
+	flag_setall(f1, SIZE);
+	require(flag_is_full(f1, SIZE));
+	f1[SIZE - 1] = 0x7f;
+	require(!flag_is_full(f1, SIZE));
+
+	flag_wipe(f1, SIZE);
+	flag_wipe(f2, SIZE);
+	f1[2] = 0x01;
+	f2[2] = 0x02;
+	require(!flag_is_inter(f1, f2, SIZE));
+	f1[SIZE - 1] = 0x04;
+	f2[SIZE - 1] = 0x04;
+	require(flag_is_inter(f1, f2, SIZE));
+	ok;
+}
+
+int test_subset(void *state) {
+	bitflag f1[SIZE], f2[SIZE];
+
+	/* Everything has the empty set */
+	fill(f1, 1);
+	flag_wipe(f2, SIZE);
+	require(flag_is_subset(f1, f2, SIZE));
+
+	/* And itself */
+	flag_copy(f2, f1, SIZE);
+	require(flag_is_subset(f1, f2, SIZE));
+
+	/* But not one more flag, in the words or the bytes after */
+	flag_wipe(f1, SIZE);
+	flag_wipe(f2, SIZE);
+	f2[1] = 0x80;
+	require(!flag_is_subset(f1, f2, SIZE));
+	f1[1] = 0x80;
+	f2[SIZE - 1] = 0x01;
+	require(!flag_is_subset(f1, f2, SIZE));
+	f1[SIZE - 1] = 0x03;
+	require(flag_is_subset(f1, f2, SIZE));
+	ok;
+}
+
+int test_bulk(void *state) {
+	bitflag f1[SIZE], f2[SIZE], want[SIZE];
+	size_t i;
+	int seed;
+
+	for (seed = 0; seed < 20; seed++) {
+		fill(f1, seed);
+		fill(f2, seed * 3 + 1);
+		for (i = 0; i < SIZE; i++) want[i] = f1[i] | f2[i];
+		flag_union(f1, f2, SIZE);
+		require(!memcmp(f1, want, SIZE));
+
+		fill(f1, seed);
+		for (i = 0; i < SIZE; i++) want[i] = f1[i] & f2[i];
+		flag_inter(f1, f2, SIZE);
+		require(!memcmp(f1, want, SIZE));
+
+		fill(f1, seed);
+		for (i = 0; i < SIZE; i++) want[i] = f1[i] & ~f2[i];
+		flag_diff(f1, f2, SIZE);
+		require(!memcmp(f1, want, SIZE));
+
+		fill(f1, seed);
+		for (i = 0; i < SIZE; i++) want[i] = f1[i] | ~f2[i];
+		flag_comp_union(f1, f2, SIZE);
+		require(!memcmp(f1, want, SIZE));
+
+		fill(f1, seed);
+		for (i = 0; i < SIZE; i++) want[i] = ~f1[i];
+		flag_negate(f1, SIZE);
+		require(!memcmp(f1, want, SIZE));
+	}
+	ok;
+}
+
+int test_delta(void *state) {
+	bitflag f1[SIZE], f2[SIZE];
+
+	/* Each returns whether it changed anything */
+	flag_wipe(f1, SIZE);
+	flag_wipe(f2, SIZE);
+	f1[SIZE - 1] = 0x01;
+	f2[SIZE - 1] = 0x01;
+	require(!flag_union(f1, f2, SIZE));
+	f2[0] = 0x01;
+	require(flag_union(f1, f2, SIZE));
+
+	require(!flag_inter(f1, f2, SIZE));
+	f2[0] = 0;
+	require(flag_inter(f1, f2, SIZE));
+
+	require(flag_diff(f1, f2, SIZE));
+	require(!flag_diff(f1, f2, SIZE));
+
+	flag_setall(f1, SIZE);
+	require(!flag_comp_union(f1, f2, SIZE));
+	f1[SIZE - 1] = 0;
+	require(flag_comp_union(f1, f2, SIZE));
+	ok;
+}
+
+static const char *suite_name = "z-bitflag/flag";
+int test_next(void *state) {
+	bitflag f[SIZE];
+	int flag, want;
+
+	fill(f, 5);
+
+	/* Every flag that's on, in order, and nothing else */
+	want = FLAG_START;
+	for (flag = flag_next(f, SIZE, FLAG_END); flag != FLAG_END;
+	     flag = flag_next(f, SIZE, flag + 1)) {
+		for (; want < flag; want++)
+			require(!flag_has(f, SIZE, want));
+		require(flag_has(f, SIZE, flag));
+		want = flag + 1;
+	}
+	for (; want < FLAG_MAX(SIZE); want++)
+		require(!flag_has(f, SIZE, want));
+
+	/* Including one that is asked for, and across empty bytes */
+	flag_wipe(f, SIZE);
+	flag_on(f, SIZE, 3);
+	flag_on(f, SIZE, FLAG_MAX(SIZE) - 1);
+	eq(flag_next(f, SIZE, 3), 3);
+	eq(flag_next(f, SIZE, 4), FLAG_MAX(SIZE) - 1);
+	eq(flag_next(f, SIZE, FLAG_MAX(SIZE)), FLAG_END);
+	ok;
+}
+
+static struct test tests[] = {
+	{ "tests", test_tests },
+	{ "subset", test_subset },
+	{ "bulk", test_bulk },
+	{ "delta", test_delta },
+	{ "next", test_next },
+	{ NULL, NULL }
+};
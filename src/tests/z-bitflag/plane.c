@@ -0,0 +1,97 @@
+/* z-bitflag/plane */
+
+#include "unit-test.h"
+#include "z-bitflag.h"
+
+#define CELLS 300
+
+nosetup;
+noteardown;
+
+int test_onoff(void *state) {
+	planeword p[PLANE_SIZE(CELLS)];
+
+	plane_wipe(p, PLANE_SIZE(CELLS));
+	require(plane_is_empty(p, PLANE_SIZE(CELLS)));
+
+	plane_on(p, 0);
+	plane_on(p, 63);
+	plane_on(p, 64);
+	plane_on(p, 299);
+	require(plane_has(p, 0));
+	require(plane_has(p, 63));
+	require(plane_has(p, 64));
+	require(plane_has(p, 299));
+	require(!plane_has(p, 1));
+	require(!plane_has(p, 65));
+	eq(plane_count(p, PLANE_SIZE(CELLS)), 4);
+
+	plane_off(p, 63);
+	require(!plane_has(p, 63));
+	eq(plane_count(p, PLANE_SIZE(CELLS)), 3);
+	ok;
+}
+
+int test_next(void *state) {
+	planeword p[PLANE_SIZE(CELLS)];
+
+	plane_wipe(p, PLANE_SIZE(CELLS));
+	eq(plane_next(p, PLANE_SIZE(CELLS), 0), -1);
+
+	plane_on(p, 5);
+	plane_on(p, 130);
+	plane_on(p, 131);
+	eq(plane_next(p, PLANE_SIZE(CELLS), 0), 5);
+	eq(plane_next(p, PLANE_SIZE(CELLS), 5), 5);
+	eq(plane_next(p, PLANE_SIZE(CELLS), 6), 130);
+	eq(plane_next(p, PLANE_SIZE(CELLS), 131), 131);
+	eq(plane_next(p, PLANE_SIZE(CELLS), 132), -1);
+	ok;
+}
+
+int test_ops(void *state) {
+	planeword a[PLANE_SIZE(CELLS)];
+	planeword b[PLANE_SIZE(CELLS)];
+	planeword c[PLANE_SIZE(CELLS)];
+
+	plane_wipe(a, PLANE_SIZE(CELLS));
+	plane_wipe(b, PLANE_SIZE(CELLS));
+	plane_on(a, 10);
+	plane_on(a, 200);
+	plane_on(b, 200);
+	plane_on(b, 250);
+
+	/* Gained and lost cells */
+	plane_andnot(c, a, b, PLANE_SIZE(CELLS));
+	eq(plane_count(c, PLANE_SIZE(CELLS)), 1);
+	require(plane_has(c, 10));
+	plane_andnot(c, b, a, PLANE_SIZE(CELLS));
+	eq(plane_count(c, PLANE_SIZE(CELLS)), 1);
+	require(plane_has(c, 250));
+
+	plane_copy(c, a, PLANE_SIZE(CELLS));
+	plane_union(c, b, PLANE_SIZE(CELLS));
+	eq(plane_count(c, PLANE_SIZE(CELLS)), 3);
+
+	plane_copy(c, a, PLANE_SIZE(CELLS));
+	plane_inter(c, b, PLANE_SIZE(CELLS));
+	eq(plane_count(c, PLANE_SIZE(CELLS)), 1);
+	require(plane_has(c, 200));
+
+	plane_copy(c, a, PLANE_SIZE(CELLS));
+	plane_diff(c, b, PLANE_SIZE(CELLS));
+	eq(plane_count(c, PLANE_SIZE(CELLS)), 1);
+	require(plane_has(c, 10));
+
+	plane_setall(c, PLANE_SIZE(CELLS));
+	eq(plane_count(c, PLANE_SIZE(CELLS)), PLANE_SIZE(CELLS) * PLANE_WIDTH);
+	ok;
+}
+
+static const char *suite_name = "z-bitflag/plane";
+static struct test tests[] = {
+	{ "onoff", test_onoff },
+	{ "next", test_next },
+	{ "ops", test_ops },
+	{ NULL, NULL }
+};
@@ -0,0 +1,4 @@
+TESTPROGS += z-bitflag/flag z-bitflag/plane
+
+z-bitflag/flag : z-bitflag/flag.c ../angband.o
+z-bitflag/plane : z-bitflag/plane.c ../angband.o
@@ -0,0 +1,103 @@
+/* z-msg/ring.c */
+
+#include "unit-test.h"
+#include "z-form.h"
+#include "z-msg.h"
+#include "z-term.h"
+
+static int setup(void **state) {
+	messages_init();
+}
+
+static int teardown(void *state) {
+	messages_free();
+}
+
+static int test_add(void *state) {
+	message_add("0-foo", MSG_GENERIC);
+	message_add("0-bar", MSG_HIT);
+
+	eq(messages_num(), 2);
+	require(!strcmp(message_str(0), "0-bar"));
+	require(!strcmp(message_str(1), "0-foo"));
+	eq(message_type(0), MSG_HIT);
+	eq(message_type(1), MSG_GENERIC);
+	require(!strcmp(message_str(2), ""));
+	eq(message_count(2), 0);
+	ok;
+}
+
+static int test_repeat(void *state) {
+	message_add("1-foo", MSG_GENERIC);
+	message_add("1-foo", MSG_GENERIC);
+	message_add("1-foo", MSG_HIT);
+
+	eq(messages_num(), 4);
+	eq(message_count(0), 1);
+	eq(message_count(1), 2);
+	ok;
+}
+
+static int test_full(void *state) {
+	char buf[32];
+	int i;
+
+	for (i = 0; i < 5000; i++) {
+		strnfmt(buf, sizeof(buf), "2-%d", i);
+		message_add(buf, MSG_GENERIC);
+	}
+
+	eq(messages_num(), MESSAGE_MAX);
+	require(!strcmp(message_str(0), "2-4999"));
+	strnfmt(buf, sizeof(buf), "2-%d", 5000 - MESSAGE_MAX);
+	require(!strcmp(message_str(MESSAGE_MAX - 1), buf));
+	ok;
+}
+
+static int test_long(void *state) {
+	char buf[201];
+	int i, n;
+
+	for (i = 0; i < 3000; i++) {
+		memset(buf, 'a' + i % 26, sizeof(buf) - 1);
+		buf[sizeof(buf) - 1] = '\0';
+		buf[0] = '0' + i % 10;
+		message_add(buf, MSG_GENERIC);
+	}
+
+	/* The text pushes the old messages out before the records do */
+	n = messages_num();
+	require(n > MESSAGE_TEXT / 402 && n < MESSAGE_MAX);
+	for (i = 0; i < n; i++) {
+		const char *s = message_str(i);
+
+		eq(strlen(s), 200);
+		eq(s[0], '0' + (2999 - i) % 10);
+		eq(s[199], 'a' + (2999 - i) % 26);
+	}
+	ok;
+}
+
+static int test_color(void *state) {
+	message_color_define(MSG_HIT, TERM_RED);
+	message_color_define(1000, TERM_BLUE);
+	message_color_define(1000, TERM_GREEN);
+	message_color_define(MSG_MISS, TERM_DARK);
+
+	eq(message_type_color(MSG_HIT), TERM_RED);
+	eq(message_type_color(1000), TERM_GREEN);
+	eq(message_type_color(MSG_MISS), TERM_WHITE);
+	eq(message_type_color(MSG_KILL), TERM_WHITE);
+	eq(message_type_color(1001), TERM_WHITE);
+	ok;
+}
+
+static const char *suite_name = "z-msg/ring";
+static struct test tests[] = {
+	{ "add", test_add },
+	{ "repeat", test_repeat },
+	{ "full", test_full },
+	{ "long", test_long },
+	{ "color", test_color },
+	{ NULL, NULL }
+};
@@ -0,0 +1,3 @@
+TESTPROGS += z-msg/ring
+
+z-msg/ring : z-msg/ring.c ../angband.o
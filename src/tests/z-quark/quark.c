@@ -1,5 +1,7 @@
 /* z-quark/quark.c */
 
+#include <time.h>
+
 #include "unit-test.h"
 #include "z-quark.h"
 
@@ -44,9 +46,47 @@ static int test_dedup(void *state) {
 	ok;
 }
 
+#define BENCH_QUARKS 20000
+
+static int test_bench(void *state) {
+	static quark_t qs[BENCH_QUARKS];
+	char buf[32];
+	clock_t start, add, again;
+	int i;
+
+	start = clock();
+	for (i = 0; i < BENCH_QUARKS; i++) {
+		sprintf(buf, "2-inscription %d", i);
+		qs[i] = quark_add(buf);
+	}
+	add = clock() - start;
+
+	/* Adding them again finds the same quarks */
+	start = clock();
+	for (i = 0; i < BENCH_QUARKS; i++) {
+		sprintf(buf, "2-inscription %d", i);
+		require(quark_add(buf) == qs[i]);
+	}
+	again = clock() - start;
+
+	for (i = 1; i < BENCH_QUARKS; i++)
+		require(qs[i] == qs[i - 1] + 1);
+
+	sprintf(buf, "2-inscription %d", BENCH_QUARKS - 1);
+	require(!strcmp(quark_str(qs[BENCH_QUARKS - 1]), buf));
+
+	if (verbose)
+		printf("%d new quarks %.1fms, again %.1fms  ", BENCH_QUARKS,
+		       1000.0 * add / CLOCKS_PER_SEC,
+		       1000.0 * again / CLOCKS_PER_SEC);
+
+	ok;
+}
+
 static const char *suite_name = "z-quark/quark";
 static struct test tests[] = {
 	{ "alloc", test_alloc },
 	{ "dedup", test_dedup },
+	{ "bench", test_bench },
 	{ NULL, NULL }
 };
@@ -0,0 +1,58 @@
+/* z-rand/normal.c */
+
+#include <time.h>
+
+#include "unit-test.h"
+#include "z-rand.h"
+
+#define BENCH_ROLLS 2000000
+
+nosetup;
+noteardown;
+
+static int test_agree(void *state) {
+	int tmp;
+
+	/* Both searches must find the same entry for every probability */
+	for (tmp = 0; tmp < 32768; tmp++)
+		eq(Rand_normal_index(tmp, TRUE), Rand_normal_index(tmp, FALSE));
+
+	ok;
+}
+
+static int test_bench(void *state) {
+	static u32b rolls[BENCH_ROLLS];
+	rand_stream rs;
+	clock_t start, search, bucket;
+	long sum_search = 0, sum_bucket = 0;
+	int i;
+
+	Rand_stream_init(&rs, 32768);
+	Rand_fill_div(&rs, rolls, BENCH_ROLLS, 32768);
+
+	start = clock();
+	for (i = 0; i < BENCH_ROLLS; i++)
+		sum_search += Rand_normal_index(rolls[i], FALSE);
+	search = clock() - start;
+
+	start = clock();
+	for (i = 0; i < BENCH_ROLLS; i++)
+		sum_bucket += Rand_normal_index(rolls[i], TRUE);
+	bucket = clock() - start;
+
+	eq(sum_search, sum_bucket);
+
+	if (verbose)
+		printf("binary search %.1fms, bucketed %.1fms for %d rolls  ",
+		       1000.0 * search / CLOCKS_PER_SEC,
+		       1000.0 * bucket / CLOCKS_PER_SEC, BENCH_ROLLS);
+
+	ok;
+}
+
+static const char *suite_name = "z-rand/normal";
+static struct test tests[] = {
+	{ "agree", test_agree },
+	{ "bench", test_bench },
+	{ NULL, NULL }
+};
@@ -0,0 +1,82 @@
+/* z-rand/randcalc.c */
+
+#include "unit-test.h"
+#include "z-rand.h"
+
+nosetup;
+noteardown;
+
+static const random_value values[] = {
+	{ 0, 0, 0, 0 },
+	{ 5, 0, 0, 0 },
+	{ 0, 2, 6, 0 },
+	{ -3, 1, 4, 0 },
+	{ 1, 0, 0, 10 },
+	{ 2, 3, 8, 5 },
+	{ -10, 0, 0, 0 },
+	{ 0, 1, 0, 0 }
+};
+
+/* randcalc() as it was worked out before each aspect had its own */
+static int randcalc_old(random_value v, int level, aspect a) {
+	if (a == EXTREMIFY) {
+		int min = randcalc_old(v, level, MINIMISE);
+		int max = randcalc_old(v, level, MAXIMISE);
+		return abs(min) > abs(max) ? min : max;
+	}
+
+	return v.base + damcalc(v.dice, v.sides, a) +
+			m_bonus_calc(v.m_bonus, level, a);
+}
+
+static int test_fixed(void *state) {
+	aspect a;
+	int i, level;
+
+	for (i = 0; i < N_ELEMENTS(values); i++) {
+		eq(randcalc_min(values[i]), randcalc_old(values[i], 0, MINIMISE));
+		eq(randcalc_max(values[i]), randcalc_old(values[i], 0, MAXIMISE));
+
+		for (level = 0; level < MAX_DEPTH; level += 9) {
+			eq(randcalc_average(values[i], level),
+			   randcalc_old(values[i], level, AVERAGE));
+
+			for (a = MINIMISE; a < RANDOMISE; a++)
+				eq(randcalc(values[i], level, a),
+				   randcalc_old(values[i], level, a));
+		}
+	}
+
+	ok;
+}
+
+static int test_random(void *state) {
+	bool old_quick = Rand_quick;
+	int i, j, level;
+
+	/* The same rolls, from the same numbers */
+	Rand_quick = FALSE;
+	for (i = 0; i < N_ELEMENTS(values); i++) {
+		for (level = 0; level < MAX_DEPTH; level += 9) {
+			int old[20];
+
+			Rand_state_init(i * 1000 + level);
+			for (j = 0; j < N_ELEMENTS(old); j++)
+				old[j] = randcalc_old(values[i], level, RANDOMISE);
+
+			Rand_state_init(i * 1000 + level);
+			for (j = 0; j < N_ELEMENTS(old); j++)
+				eq(randcalc_random(values[i], level), old[j]);
+		}
+	}
+
+	Rand_quick = old_quick;
+	ok;
+}
+
+static const char *suite_name = "z-rand/randcalc";
+static struct test tests[] = {
+	{ "fixed", test_fixed },
+	{ "random", test_random },
+	{ NULL, NULL }
+};
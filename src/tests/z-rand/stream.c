@@ -0,0 +1,133 @@
+/* z-rand/stream.c */
+
+#include "unit-test.h"
+#include "z-rand.h"
+
+nosetup;
+noteardown;
+
+/* The next 32 bits from the game's complex RNG */
+static u32b game_next(void) {
+	u32b x;
+
+	Rand_fill(NULL, &x, 1);
+	return x;
+}
+
+static int test_repeat(void *state) {
+	rand_stream a, b;
+	int i;
+
+	Rand_stream_init(&a, 12345);
+	Rand_stream_init(&b, 12345);
+
+	for (i = 0; i < 1000; i++)
+		eq(Rand_stream_next(&a), Rand_stream_next(&b));
+
+	Rand_stream_init(&b, 54321);
+	require(Rand_stream_next(&a) != Rand_stream_next(&b));
+
+	ok;
+}
+
+static int test_game(void *state) {
+	rand_stream rs;
+	bool old_quick = Rand_quick;
+	int i;
+
+	/* A stream follows the same sequence as the game's RNG */
+	Rand_quick = FALSE;
+	Rand_state_init(777);
+	Rand_stream_init(&rs, 777);
+
+	for (i = 0; i < 1000; i++)
+		eq(Rand_stream_next(&rs), game_next());
+
+	/* ... and drawing from it leaves the game's RNG alone */
+	Rand_state_init(777);
+	for (i = 0; i < 1000; i++)
+		Rand_stream_next(&rs);
+	Rand_stream_init(&rs, 777);
+	eq(Rand_stream_next(&rs), game_next());
+
+	Rand_quick = old_quick;
+	ok;
+}
+
+static int test_fill(void *state) {
+	rand_stream a, b;
+	u32b buf[100];
+	int i;
+
+	Rand_stream_init(&a, 99);
+	Rand_stream_init(&b, 99);
+	Rand_fill(&a, buf, N_ELEMENTS(buf));
+
+	for (i = 0; i < N_ELEMENTS(buf); i++)
+		eq(buf[i], Rand_stream_next(&b));
+
+	/* Filling from the game's RNG advances it too */
+	Rand_state_init(99);
+	Rand_fill(NULL, buf, N_ELEMENTS(buf));
+	eq(game_next(), Rand_stream_next(&b));
+
+	ok;
+}
+
+static int test_fill_div(void *state) {
+	rand_stream rs;
+	u32b buf[6000];
+	int seen[6] = { 0 };
+	int i;
+
+	Rand_stream_init(&rs, 2010);
+	Rand_fill_div(&rs, buf, N_ELEMENTS(buf), 6);
+
+	for (i = 0; i < N_ELEMENTS(buf); i++) {
+		require(buf[i] < 6);
+		seen[buf[i]]++;
+	}
+
+	/* Each face should come up about 1000 times */
+	for (i = 0; i < 6; i++)
+		require(seen[i] > 800 && seen[i] < 1200);
+
+	Rand_fill_div(&rs, buf, 10, 1);
+	for (i = 0; i < 10; i++)
+		eq(buf[i], 0);
+
+	ok;
+}
+
+static int test_damroll(void *state) {
+	rand_stream rs;
+	int buf[1000];
+	int i;
+	bool low = FALSE, high = FALSE;
+
+	Rand_stream_init(&rs, 42);
+	damroll_fill(&rs, buf, N_ELEMENTS(buf), 3, 4);
+
+	for (i = 0; i < N_ELEMENTS(buf); i++) {
+		require(buf[i] >= 3 && buf[i] <= 12);
+		if (buf[i] == 3) low = TRUE;
+		if (buf[i] == 12) high = TRUE;
+	}
+	require(low && high);
+
+	damroll_fill(&rs, buf, 10, 3, 0);
+	for (i = 0; i < 10; i++)
+		eq(buf[i], 0);
+
+	ok;
+}
+
+static const char *suite_name = "z-rand/stream";
+static struct test tests[] = {
+	{ "repeat", test_repeat },
+	{ "game", test_game },
+	{ "fill", test_fill },
+	{ "fill-div", test_fill_div },
+	{ "damroll", test_damroll },
+	{ NULL, NULL }
+};
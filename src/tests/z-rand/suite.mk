@@ -0,0 +1,5 @@
+TESTPROGS += z-rand/stream z-rand/normal z-rand/randcalc
+
+z-rand/stream : z-rand/stream.c ../angband.o
+z-rand/normal : z-rand/normal.c ../angband.o
+z-rand/randcalc : z-rand/randcalc.c ../angband.o
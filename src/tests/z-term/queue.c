@@ -0,0 +1,103 @@
+/* z-term/queue.c */
+
+#include "unit-test.h"
+#include "z-term.h"
+
+static term test_term;
+
+static int setup(void **state) {
+	term_init(&test_term, 80, 24, 4);
+	Term_activate(&test_term);
+	return 0;
+}
+
+static int teardown(void *state) {
+	term_nuke(&test_term);
+	return 0;
+}
+
+static int test_grow(void *state) {
+	ui_event_data ke;
+	int i;
+
+	/* Far more than the queue started with, and all in order */
+	for (i = 1; i <= 100; i++)
+		eq(Term_keypress(i), 0);
+	require(Term_key_behind());
+
+	for (i = 1; i <= 100; i++) {
+		eq(Term_inkey(&ke, FALSE, TRUE), 0);
+		eq(ke.key, i);
+	}
+	eq(Term_inkey(&ke, FALSE, TRUE), 1);
+	require(!Term_key_behind());
+	ok;
+}
+
+static int test_push(void *state) {
+	ui_event_data ke;
+
+	Term_keypress('b');
+	Term_keypress('c');
+	Term_key_push('a');
+
+	eq(Term_inkey(&ke, FALSE, TRUE), 0);
+	eq(ke.key, 'a');
+	eq(Term_inkey(&ke, FALSE, TRUE), 0);
+	eq(ke.key, 'b');
+	eq(Term_inkey(&ke, FALSE, TRUE), 0);
+	eq(ke.key, 'c');
+	ok;
+}
+
+static int test_mouse(void *state) {
+	ui_event_data ke;
+
+	/* Repeats of a waiting click come to one */
+	Term_mousepress(3, 4, 1);
+	Term_mousepress(3, 4, 1);
+	Term_mousepress(3, 4, 1);
+	Term_mousepress(5, 4, 1);
+	Term_keypress('x');
+	Term_mousepress(5, 4, 1);
+
+	eq(Term_inkey(&ke, FALSE, TRUE), 0);
+	eq(ke.type, EVT_MOUSE);
+	eq(ke.mousex, 3);
+	eq(Term_inkey(&ke, FALSE, TRUE), 0);
+	eq(ke.mousex, 5);
+	eq(Term_inkey(&ke, FALSE, TRUE), 0);
+	eq(ke.key, 'x');
+	eq(Term_inkey(&ke, FALSE, TRUE), 0);
+	eq(ke.mousex, 5);
+	eq(Term_inkey(&ke, FALSE, TRUE), 1);
+	ok;
+}
+
+static int test_max(void *state) {
+	ui_event_data ke;
+	int i, first;
+
+	/* Past the limit the oldest are forgotten; number them by place */
+	for (i = 0; i < 5000; i++)
+		Term_mousepress(i % 200, i / 200, 1);
+
+	eq(Term_inkey(&ke, FALSE, TRUE), 0);
+	first = ke.mousey * 200 + ke.mousex;
+	require(first > 0);
+	for (i = first + 1; i < 5000; i++) {
+		eq(Term_inkey(&ke, FALSE, TRUE), 0);
+		eq(ke.mousey * 200 + ke.mousex, i);
+	}
+	eq(Term_inkey(&ke, FALSE, TRUE), 1);
+	ok;
+}
+
+static const char *suite_name = "z-term/queue";
+static struct test tests[] = {
+	{ "grow", test_grow },
+	{ "push", test_push },
+	{ "mouse", test_mouse },
+	{ "max", test_max },
+	{ NULL, NULL }
+};
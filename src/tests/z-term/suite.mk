@@ -0,0 +1,3 @@
+TESTPROGS += z-term/queue
+
+z-term/queue : z-term/queue.c ../angband.o
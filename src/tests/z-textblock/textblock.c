@@ -3,6 +3,7 @@
 #include "unit-test.h"
 #include "z-textblock.h"
 #include "z-term.h"
+#include "z-virt.h"
 
 static int setup(void **state) {
 	ok;
@@ -74,11 +75,100 @@ static int test_length(void *state) {
 	ok;
 }
 
+static int test_reserve(void *state) {
+	textblock *tb = textblock_new();
+	const char *text;
+	int i;
+
+	textblock_append(tb, "abc");
+	textblock_reserve(tb, 10000);
+
+	/* Reserving room keeps what is already there */
+	text = textblock_text(tb);
+	require(!strcmp(text, "abc"));
+
+	/* And the room is there */
+	for (i = 0; i < 100; i++)
+		textblock_append(tb, "%50s", "x");
+	ptreq(textblock_text(tb), text);
+	eq(strlen(textblock_text(tb)), 5003);
+
+	textblock_free(tb);
+	ok;
+}
+
+static int test_lines(void *state) {
+	textblock *tb = textblock_new();
+	size_t *starts = NULL, *lengths = NULL;
+	int i;
+
+	for (i = 0; i < 100; i++)
+		textblock_append(tb, "line %d\n", i);
+
+	eq(textblock_calculate_lines(tb, &starts, &lengths, 20), 100);
+	eq(lengths[99], 7);
+	require(!strncmp(textblock_text(tb) + starts[99], "line 99", 7));
+
+	mem_free(starts);
+	mem_free(lengths);
+	textblock_free(tb);
+	ok;
+}
+
+static int test_cached_lines(void *state) {
+	textblock *tb = textblock_new();
+	const size_t *starts, *lengths;
+	const size_t *starts2, *lengths2;
+
+	textblock_append(tb, "aaaa bbbb cccc\n");
+	eq(textblock_lines(tb, &starts, &lengths, 10), 2);
+	eq(lengths[0], 9);
+
+	/* The same width gives back the same lines */
+	eq(textblock_lines(tb, &starts2, &lengths2, 10), 2);
+	ptreq(starts2, starts);
+
+	/* Another width, or more text, wraps again */
+	eq(textblock_lines(tb, &starts, &lengths, 30), 1);
+	textblock_append(tb, "five\n");
+	eq(textblock_lines(tb, &starts, &lengths, 30), 2);
+	eq(lengths[1], 4);
+
+	textblock_free(tb);
+	ok;
+}
+
+static int test_wrapped(void *state) {
+	textblock *tb = textblock_new();
+	textblock *from = textblock_new();
+	const size_t *starts, *lengths;
+
+	textblock_append(tb, "a)\n");
+	textblock_append(from, "aaaa bbbb cccc\n");
+	textblock_append_wrapped(tb, from, 2, 12);
+	require(!strcmp(textblock_text(tb), "a)\n  aaaa bbbb\n  cccc\n"));
+
+	/* A cleared textblock is wrapped afresh, however long it is */
+	textblock_clear(from);
+	require(!strcmp(textblock_text(from), ""));
+	textblock_append(from, "dddddddd ee\n");
+	eq(textblock_lines(from, &starts, &lengths, 10), 2);
+	eq(lengths[0], 8);
+
+	textblock_free(from);
+	textblock_free(tb);
+	ok;
+}
+
 static const char *suite_name = "z-textblock/textblock";
 static struct test tests[] = {
 	{ "alloc", test_alloc },
 	{ "append", test_append },
 	{ "colour", test_colour },
 	{ "length", test_length },
+	{ "reserve", test_reserve },
+	{ "lines", test_lines },
+	{ "cached_lines", test_cached_lines },
+	{ "wrapped", test_wrapped },
 	{ NULL, NULL }
 };
@@ -25,9 +25,86 @@ int test_realloc(void *state) {
 	return 0;
 }
 
+int test_tags(void *state) {
+	struct mem_stats st;
+	long bytes;
+	u32b count;
+	char *p;
+
+	mem_tag_stats(MEM_TAG_MENU, &st);
+	bytes = st.bytes;
+	count = st.count;
+	p = mem_alloc_tagged(40, MEM_TAG_MENU);
+
+	mem_tag_stats(MEM_TAG_MENU, &st);
+	eq(st.bytes, bytes + 40);
+	eq(st.count, count + 1);
+	require(st.peak >= st.bytes);
+
+	/* Resizing keeps the tag */
+	p = mem_realloc(p, 100);
+	mem_tag_stats(MEM_TAG_MENU, &st);
+	eq(st.bytes, bytes + 100);
+
+	mem_free(p);
+	mem_tag_stats(MEM_TAG_MENU, &st);
+	eq(st.bytes, bytes);
+	eq(st.count, count);
+	ok;
+}
+
+int test_grow(void *state) {
+	char *p = mem_alloc(8);
+	int i;
+
+	/* Contents survive moving between small and large blocks */
+	memcpy(p, "abcdefg", 8);
+	p = mem_realloc(p, 1000);
+	require(!strcmp(p, "abcdefg"));
+	for (i = 8; i < 1000; i++)
+		p[i] = 'x';
+	p = mem_realloc(p, 8);
+	require(!strcmp(p, "abcdefg"));
+	mem_free(p);
+	ok;
+}
+
+static int hooked;
+
+static void *hook_alloc(size_t len) {
+	hooked++;
+	return malloc(len);
+}
+
+static void hook_free(void *p) {
+	hooked--;
+	free(p);
+}
+
+int test_allocator(void *state) {
+	static const struct mem_allocator hooks = { hook_alloc, realloc, hook_free };
+	void *p;
+
+	/* Big enough not to come from a pool */
+	mem_set_allocator(&hooks);
+	p = mem_alloc(4096);
+	eq(hooked, 1);
+	mem_free(p);
+	eq(hooked, 0);
+	mem_set_allocator(NULL);
+
+	p = mem_alloc(4096);
+	eq(hooked, 0);
+	mem_free(p);
+	ok;
+}
+
 static const char *suite_name = "z-virt/mem";
 static struct test tests[] = {
 	{ "alloc", test_alloc },
 	{ "realloc", test_realloc },
+	{ "tags", test_tags },
+	{ "grow", test_grow },
+	{ "allocator", test_allocator },
 	{ NULL, NULL }
 };
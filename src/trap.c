@@ -66,7 +66,7 @@ void pick_trap(int y, int x)
 	};
 
 	/* Paranoia */
-	if (cave_feat[y][x] != FEAT_INVIS) return;
+	if (cave->grid[y][x].feat != FEAT_INVIS) return;
 
 	/* Pick a trap */
 	while (1)
@@ -131,7 +131,7 @@ void hit_trap(int y, int x)
 	disturb(0, 0);
 
 	/* Analyze XXX XXX XXX */
-	switch (cave_feat[y][x])
+	switch (cave->grid[y][x].feat)
 	{
 		case FEAT_TRAP_HEAD + 0x00:
 		{
@@ -246,7 +246,7 @@ void hit_trap(int y, int x)
 		{
 			sound(MSG_SUM_MONSTER);
 			msg_print("You are enveloped in a cloud of smoke!");
-			cave_info[y][x] &= ~(CAVE_MARK);
+			cave->grid[y][x].info &= ~(CAVE_MARK);
 			cave_set_feat(y, x, FEAT_FLOOR);
 			num = 2 + randint1(3);
 			for (i = 0; i < num; i++)
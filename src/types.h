@@ -16,17 +16,6 @@
 
 /**** Available Types ****/
 
-/** An array of 256 bytes */
-typedef byte byte_256[256];
-
-/** An array of DUNGEON_WID bytes */
-typedef byte byte_wid[DUNGEON_WID];
-
-/** An array of DUNGEON_WID s16b's */
-typedef s16b s16b_wid[DUNGEON_WID];
-
-
-
 /** Function hook types **/
 
 /** Function prototype for the UI to provide to create native buttons */
@@ -35,6 +24,9 @@ typedef int (*button_add_f)(const char *, unsigned char);
 /** Function prototype for the UI to provide to remove native buttons */
 typedef int (*button_kill_f)(unsigned char);
 
+/** Function prototype for deciding which grids a path may enter */
+typedef bool (*path_passable_f)(int y, int x);
+
 
 
 /**** Available Structs ****/
@@ -109,6 +101,69 @@ typedef struct feature
 
 
 
+/**
+ * The "hot" per-grid state of the current dungeon level.
+ *
+ * Everything the common grid queries (cave_floor_bold(), cave_naked_bold(),
+ * player_has_los_bold(), and friends) need is packed into this one 8-byte
+ * record, so that asking about a grid costs a single cache line rather than
+ * one load from each of several parallel arrays.
+ */
+typedef struct grid_type
+{
+	s16b o_idx;   /**< Index of the top object in the grid (0 for none) */
+	s16b m_idx;   /**< Monster index, or -1 for the player (0 for none) */
+
+	byte feat;    /**< Terrain feature */
+	byte info;    /**< CAVE_* flags (but see struct cave for view/seen) */
+	byte info2;   /**< CAVE2_* flags */
+} grid_type;
+
+
+/**
+ * The current dungeon level.
+ *
+ * Grid records are padded to rows of CAVE_ROW so that a "grid" value from
+ * GRID() indexes &grid[0][0] directly.  The flow arrays are only touched
+ * by update_flow() and monster pathing, so they are kept "cold" and out of
+ * the grid records.
+ *
+ * The "view" and "seen" state of each grid is kept as a bitplane, indexed
+ * by GRID() value, rather than as CAVE_* flags, so that update_view() can
+ * clear it and find the grids whose state changed a word at a time.
+ *
+ * Only the top left "height" by "width" grids are part of the level; the
+ * rest of each array is never looked at, so whole-level loops should stop
+ * there rather than at DUNGEON_HGT and DUNGEON_WID.
+ */
+struct cave
+{
+	int height;                       /**< Rows in this level */
+	int width;                        /**< Columns in this level */
+
+	grid_type grid[DUNGEON_HGT][CAVE_ROW];
+
+	planeword view[CAVE_PLANE_SIZE];  /**< Grids in line of sight */
+	planeword seen[CAVE_PLANE_SIZE];  /**< Grids in view and lit */
+	u32b view_stamp;                  /**< Changed whenever "view" may have */
+	u32b flow_stamp;                  /**< Changed whenever the flow may have */
+
+	byte cost[DUNGEON_HGT][DUNGEON_WID];  /**< Flow "cost" values */
+	u16b when[DUNGEON_HGT][DUNGEON_WID];  /**< Flow "when" stamps */
+};
+
+
+
+/*
+ * A grid of a vault which isn't blank, as an offset from its top left corner
+ */
+struct vault_grid
+{
+	byte y;
+	byte x;
+	char code;			/* The grid's symbol in "vault.txt" */
+};
+
 /*
  * Information about "vault generation"
  */
@@ -125,6 +180,12 @@ typedef struct vault
 
 	byte hgt;			/* Vault height */
 	byte wid;			/* Vault width */
+
+	struct vault_grid *grids;	/* All the non-blank grids, in text order */
+	u16b n_grids;
+
+	struct vault_grid *spawns;	/* The grids which place monsters, in order */
+	u16b n_spawns;
 } vault_type;
 
 
@@ -144,7 +205,7 @@ struct alloc_entry
 	byte prob2;		/* Probability, pass 2 */
 	byte prob3;		/* Probability, pass 3 */
 
-	u16b total;		/* Unused for now */
+	u32b total;		/* Running total of pass 3 (monsters only) */
 };
 
 
@@ -510,6 +510,9 @@ static enum birth_stage roller_command(bool first_call)
 	/* Used to keep track of whether we've rolled a character before or not. */
 	static bool prev_roll = FALSE;
 
+	/* The last minimum stats asked for */
+	static char autoroll_mins[40] = "";
+
    	/* Display the player - a bit cheaty, but never mind. */
 	display_player(0);
 
@@ -520,6 +523,7 @@ static enum birth_stage roller_command(bool first_call)
 	button_add("[ESC]", ESCAPE);
 	button_add("[Enter]", '\r');
 	button_add("[r]", 'r');
+	button_add("[a]", 'a');
 	if (prev_roll) button_add("[p]", 'p');
 	clear_from(Term->hgt - 2);
 	redraw_stuff();
@@ -528,6 +532,7 @@ static enum birth_stage roller_command(bool first_call)
 	strnfcat(prompt, sizeof (prompt), &promptlen, "['r' to reroll");
 	if (prev_roll) 
 		strnfcat(prompt, sizeof(prompt), &promptlen, ", 'p' for prev");
+	strnfcat(prompt, sizeof(prompt), &promptlen, ", 'a' to autoroll");
 	strnfcat(prompt, sizeof (prompt), &promptlen, " or 'Enter' to accept]");
 
 	/* Prompt for it */
@@ -540,6 +545,7 @@ static enum birth_stage roller_command(bool first_call)
 	if (ch == ESCAPE) 
 	{
 		button_kill('r');
+		button_kill('a');
 		button_kill('p');
 
 		next = BIRTH_BACK;
@@ -558,6 +564,18 @@ static enum birth_stage roller_command(bool first_call)
 		prev_roll = TRUE;
 	}
 
+	/* Reroll until the stats are good enough */
+	else if (ch == 'a')
+	{
+		if (get_string("Minimum stats (e.g. 17 10 10 18/10 16 8): ",
+		               autoroll_mins, sizeof(autoroll_mins)))
+		{
+			cmd_insert(CMD_AUTOROLL_STATS);
+			cmd_set_arg_string(cmd_get_top(), 0, autoroll_mins);
+			prev_roll = TRUE;
+		}
+	}
+
 	/* Previous character */
 	else if (prev_roll && (ch == 'p'))
 	{
@@ -587,6 +605,7 @@ static enum birth_stage roller_command(bool first_call)
 	button_kill(ESCAPE);
 	button_kill('\r');
 	button_kill('r');
+	button_kill('a');
 	button_kill('p');
 	redraw_stuff();
 
@@ -1055,46 +1055,42 @@ static int count_known_monsters(void)
 }
 
 /*
- * Display known monsters.
+ * Every (race, group) pair, in display order.  Which races are known
+ * changes, but the order doesn't, so this is only sorted once and then
+ * just filtered each time the menu is opened.
  */
-static void do_cmd_knowledge_monsters(const char *name, int row)
-{
-	group_funcs r_funcs = {N_ELEMENTS(monster_group), FALSE, race_name,
-							m_cmp_race, default_group, mon_summary};
+static join_t *mon_sorted;
+static int mon_sorted_n;
 
-	member_funcs m_funcs = {display_monster, mon_lore, m_xchar, m_xattr, recall_prompt, 0, 0};
-
-	int *monsters;
-	int m_count = 0;
-	int i;
+static void mon_sort_all(void)
+{
+	int *order;
+	int i, n = 0;
 	size_t j;
 
 	for (i = 0; i < z_info->r_max; i++)
 	{
 		monster_race *r_ptr = &r_info[i];
-		if (!OPT(cheat_know) && !l_list[i].sights) continue;
 		if (!r_ptr->name) continue;
 
-		if (rf_has(r_ptr->flags, RF_UNIQUE)) m_count++;
+		if (rf_has(r_ptr->flags, RF_UNIQUE)) n++;
 
 		for (j = 1; j < N_ELEMENTS(monster_group) - 1; j++)
 		{
 			const char *pat = monster_group[j].chars;
-			if (strchr(pat, r_ptr->d_char)) m_count++;
+			if (strchr(pat, r_ptr->d_char)) n++;
 		}
 	}
 
-	default_join = C_ZNEW(m_count, join_t);
-	monsters = C_ZNEW(m_count, int);
+	default_join = C_ZNEW(n, join_t);
 
-	m_count = 0;
+	n = 0;
 	for (i = 0; i < z_info->r_max; i++)
 	{
 		monster_race *r_ptr = &r_info[i];
-		if (!OPT(cheat_know) && !l_list[i].sights) continue;
 		if (!r_ptr->name) continue;
 
-		for (j = 0; j < N_ELEMENTS(monster_group)-1; j++)
+		for (j = 0; j < N_ELEMENTS(monster_group) - 1; j++)
 		{
 			const char *pat = monster_group[j].chars;
 			if (j == 0 && !rf_has(r_ptr->flags, RF_UNIQUE))
@@ -1102,12 +1098,53 @@ static void do_cmd_knowledge_monsters(const char *name, int row)
 			else if (j > 0 && !strchr(pat, r_ptr->d_char))
 				continue;
 
-			monsters[m_count] = m_count;
-			default_join[m_count].oid = i;
-			default_join[m_count++].gid = j;
+			default_join[n].oid = i;
+			default_join[n++].gid = j;
 		}
 	}
 
+	order = C_ZNEW(n, int);
+	for (i = 0; i < n; i++)
+		order[i] = i;
+	sort(order, n, sizeof(*order), m_cmp_race);
+
+	mon_sorted = C_ZNEW(n, join_t);
+	for (i = 0; i < n; i++)
+		mon_sorted[i] = default_join[order[i]];
+	mon_sorted_n = n;
+
+	FREE(order);
+	FREE(default_join);
+}
+
+/*
+ * Display known monsters.
+ */
+static void do_cmd_knowledge_monsters(const char *name, int row)
+{
+	/* Already in order, see mon_sort_all() */
+	group_funcs r_funcs = {N_ELEMENTS(monster_group), FALSE, race_name,
+							NULL, default_group, mon_summary};
+
+	member_funcs m_funcs = {display_monster, mon_lore, m_xchar, m_xattr, recall_prompt, 0, 0};
+
+	int *monsters;
+	int m_count = 0;
+	int i;
+
+	if (!mon_sorted) mon_sort_all();
+
+	default_join = C_ZNEW(mon_sorted_n, join_t);
+	monsters = C_ZNEW(mon_sorted_n, int);
+
+	for (i = 0; i < mon_sorted_n; i++)
+	{
+		if (!OPT(cheat_know) && !l_list[mon_sorted[i].oid].sights) continue;
+
+		monsters[m_count] = m_count;
+		default_join[m_count++] = mon_sorted[i];
+	}
+
 	display_knowledge("monsters", monsters, m_count, r_funcs, m_funcs,
 			"                   Sym  Kills");
 	FREE(default_join);
@@ -1145,7 +1182,7 @@ static object_type *find_artifact(int a_idx)
 	int i, j;
 
 	/* Look for the artifact, either in inventory, store or the object list */
-	for (i = 0; i < z_info->o_max; i++)
+	for (i = 0; i < o_max; i++)
 	{
 		if (o_list[i].name1 == a_idx)
 			return &o_list[i];
@@ -1285,22 +1322,58 @@ static int collect_known_artifacts(int *artifacts, size_t artifacts_len)
 	return a_count;
 }
 
+/*
+ * Every artifact, in display order.  The order only changes when the
+ * random artifacts do, so it is kept until then.
+ */
+static int *art_sorted;
+static int art_sorted_n;
+static bool art_sorted_rand;
+static u32b art_sorted_seed;
+
+static void art_sort_all(void)
+{
+	int j;
+
+	if (!art_sorted) art_sorted = C_ZNEW(z_info->a_max, int);
+
+	art_sorted_n = 0;
+	for (j = 0; j < z_info->a_max; j++)
+		if (a_info[j].name) art_sorted[art_sorted_n++] = j;
+
+	sort(art_sorted, art_sorted_n, sizeof(*art_sorted), a_cmp_tval);
+
+	art_sorted_rand = OPT(adult_randarts);
+	art_sorted_seed = seed_randart;
+}
+
 /*
  * Display known artifacts
  */
 static void do_cmd_knowledge_artifacts(const char *name, int row)
 {
-	/* HACK -- should be TV_MAX */
-	group_funcs obj_f = {TV_GOLD, FALSE, kind_name, a_cmp_tval, art2gid, 0};
+	/* HACK -- should be TV_MAX; already in order, see art_sort_all() */
+	group_funcs obj_f = {TV_GOLD, FALSE, kind_name, NULL, art2gid, 0};
 	member_funcs art_f = {display_artifact, desc_art_fake, 0, 0, recall_prompt, 0, 0};
 
 	int *artifacts;
 	int a_count = 0;
+	int i;
+
+	if (!art_sorted || art_sorted_rand != OPT(adult_randarts) ||
+	    art_sorted_seed != seed_randart)
+		art_sort_all();
 
 	artifacts = C_ZNEW(z_info->a_max, int);
 
 	/* Collect valid artifacts */
-	a_count = collect_known_artifacts(artifacts, z_info->a_max);
+	for (i = 0; i < art_sorted_n; i++)
+	{
+		int j = art_sorted[i];
+
+		if (OPT(cheat_xtra) || artifact_is_known(j))
+			artifacts[a_count++] = j;
+	}
 
 	display_knowledge("artifacts", artifacts, a_count, obj_f, art_f, NULL);
 	FREE(artifacts);
@@ -1693,12 +1766,87 @@ static void o_xtra_act(char ch, int oid)
 
 
 
+/*
+ * Every object kind, in display order.  The order depends on which kinds
+ * are known, tried and how they're flavoured, so those are noted for each
+ * kind, and the list sorted again only when one of them has changed.
+ */
+static int *obj_sorted;
+static int obj_sorted_n;
+static u32b *obj_sorted_key;
+
+/* Keep macro counts happy. */
+static void cleanup_cmds(void) {
+	mem_free(obj_group_order);
+}
+
+/*
+ * Work out the group of each tval, the first time it's needed
+ */
+static void obj_group_order_init(void)
+{
+	int i;
+	int gid = -1;
+
+	if (obj_group_order) return;
+
+	obj_group_order = C_ZNEW(TV_GOLD + 1, int);
+	atexit(cleanup_cmds);
+
+	/* Allow for missing values */
+	for (i = 0; i <= TV_GOLD; i++)
+		obj_group_order[i] = -1;
+
+	for (i = 0; 0 != object_text_order[i].tval; i++)
+	{
+		if (object_text_order[i].name) gid = i;
+		obj_group_order[object_text_order[i].tval] = gid;
+	}
+}
+
+static u32b obj_sort_key(const object_kind *k_ptr)
+{
+	return (k_ptr->flavor << 2) | (k_ptr->tried ? 2 : 0) |
+		(k_ptr->aware ? 1 : 0);
+}
+
+static void obj_sort_all(void)
+{
+	int i;
+	bool changed = FALSE;
+
+	if (!obj_sorted)
+	{
+		obj_sorted = C_ZNEW(z_info->k_max, int);
+		obj_sorted_key = C_ZNEW(z_info->k_max, u32b);
+		changed = TRUE;
+	}
+
+	for (i = 0; i < z_info->k_max; i++)
+	{
+		u32b key = obj_sort_key(&k_info[i]);
+
+		if (obj_sorted_key[i] != key) changed = TRUE;
+		obj_sorted_key[i] = key;
+	}
+
+	if (!changed) return;
+
+	obj_sorted_n = 0;
+	for (i = 0; i < z_info->k_max; i++)
+		if (obj_group_order[k_info[i].tval] >= 0)
+			obj_sorted[obj_sorted_n++] = i;
+
+	sort(obj_sorted, obj_sorted_n, sizeof(*obj_sorted), o_cmp_tval);
+}
+
 /*
  * Display known objects
  */
 void textui_browse_object_knowledge(const char *name, int row)
 {
-	group_funcs kind_f = {TV_GOLD, FALSE, kind_name, o_cmp_tval, obj2gid, 0};
+	/* Already in order, see obj_sort_all() */
+	group_funcs kind_f = {TV_GOLD, FALSE, kind_name, NULL, obj2gid, 0};
 	member_funcs obj_f = {display_object, desc_obj_fake, o_xchar, o_xattr, o_xtra_prompt, o_xtra_act, 0};
 
 	int *objects;
@@ -1706,11 +1854,14 @@ void textui_browse_object_knowledge(const char *name, int row)
 	int i;
 	object_kind *k_ptr;
 
+	obj_group_order_init();
+	obj_sort_all();
+
 	objects = C_ZNEW(z_info->k_max, int);
 
-	for (i = 0; i < z_info->k_max; i++)
+	for (i = 0; i < obj_sorted_n; i++)
 	{
-		k_ptr = &k_info[i];
+		k_ptr = &k_info[obj_sorted[i]];
 		/* It's in the list if we've ever seen it, or it has a flavour,
 		 * and either it's not one of the special artifacts, or if it is,
 		 * we're not aware of it yet. This way the flavour appears in the list
@@ -1719,10 +1870,7 @@ void textui_browse_object_knowledge(const char *name, int row)
 		if ((k_ptr->everseen || k_ptr->flavor || OPT(cheat_xtra)) &&
 				(!of_has(k_ptr->flags, OF_INSTA_ART) ||
 				 !artifact_is_known(get_artifact_from_kind(k_ptr))))
-		{
-			int c = obj_group_order[k_info[i].tval];
-			if (c >= 0) objects[o_count++] = i;
-		}
+			objects[o_count++] = obj_sorted[i];
 	}
 
 	display_knowledge("known objects", objects, o_count, kind_f, obj_f, "Squelch  Inscribed          Sym");
@@ -1860,15 +2008,16 @@ static menu_type knowledge_menu;
 
 
 
-/* Keep macro counts happy. */
-static void cleanup_cmds(void) {
-	mem_free(obj_group_order);
-}
-
+/*
+ * Set up the knowledge menus, the first time they're used
+ */
 void textui_knowledge_init(void)
 {
 	/* Initialize the menus */
 	menu_type *menu = &knowledge_menu;
+
+	if (menu->title) return;
+
 	menu_init(menu, MN_SKIN_SCROLL, menu_find_iter(MN_ITER_ACTIONS));
 	menu_setpriv(menu, N_ELEMENTS(knowledge_actions), knowledge_actions);
 
@@ -1876,24 +2025,7 @@ void textui_knowledge_init(void)
 	menu->selections = lower_case;
 
 	/* initialize other static variables */
-	if (!obj_group_order)
-	{
-		int i;
-		int gid = -1;
-
-		obj_group_order = C_ZNEW(TV_GOLD + 1, int);
-		atexit(cleanup_cmds);
-
-		/* Allow for missing values */
-		for (i = 0; i <= TV_GOLD; i++)
-			obj_group_order[i] = -1;
-
-		for (i = 0; 0 != object_text_order[i].tval; i++)
-		{
-			if (object_text_order[i].name) gid = i;
-			obj_group_order[object_text_order[i].tval] = gid;
-		}
-	}
+	obj_group_order_init();
 }
 
 
@@ -1907,6 +2039,8 @@ void textui_browse_knowledge(void)
 	int i;
 	region knowledge_region = { 0, 0, -1, 18 };
 
+	textui_knowledge_init();
+
 	/* Grey out menu items that won't display anything */
 	if (collect_known_artifacts(NULL, 0) > 0)
 		knowledge_actions[1].flags = 0;
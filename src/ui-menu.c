@@ -811,7 +811,7 @@ void menu_init(menu_type *menu, skin_id skin_id, const menu_iter *iter)
 
 menu_type *menu_new(skin_id skin_id, const menu_iter *iter)
 {
-	menu_type *m = mem_alloc(sizeof *m);
+	menu_type *m = mem_alloc_tagged(sizeof *m, MEM_TAG_MENU);
 	menu_init(m, skin_id, iter);
 	return m;
 }
@@ -1258,6 +1258,9 @@ char inkey(void)
  */
 void bell(cptr reason)
 {
+	/* Hack -- Nobody is listening */
+	if (msg_quiet) return;
+
 	/* Mega-Hack -- Flush the output */
 	Term_fresh();
 
@@ -1360,6 +1363,9 @@ static void msg_print_aux(u16b type, cptr msg)
 	int limit;
 
 
+	/* Hack -- Nobody is reading */
+	if (msg_quiet) return;
+
 	/* Obtain the size */
 	(void)Term_get_size(&w, &h);
 
@@ -1913,6 +1919,23 @@ void text_out_to_file(byte a, cptr str)
 }
 
 
+/*
+ * Format and translate a string, as x_file_putf() does, and add it to `tb`
+ */
+void x_textblock_append(textblock *tb, int encoding, const char *fmt, ...)
+{
+	va_list vp;
+	char buf[1024];
+
+	va_start(vp, fmt);
+	(void)vstrnfmt(buf, sizeof(buf), fmt, vp);
+	va_end(vp);
+
+	xstr_trans(buf, encoding);
+	textblock_append(tb, "%s", buf);
+}
+
+
 /*
  * Output text to the screen or to a file depending on the selected
  * text_out hook.
@@ -40,6 +40,16 @@ const char *copyright =
  */
 bool arg_wizard;			/* Command arg -- Request wizard mode */
 bool arg_rebalance;			/* Command arg -- Rebalance monsters */
+u32b arg_bench_seed;		/* Command arg -- Level seed to benchmark */
+int arg_bench_depth;		/* Command arg -- Depth to benchmark at */
+int arg_bench_depth_max;	/* Command arg -- ... up to this depth */
+int arg_bench_count;		/* Command arg -- Levels to benchmark */
+int arg_fight_race;		/* Command arg -- Monster race to fight */
+int arg_fight_level;		/* Command arg -- Level to fight it at */
+int arg_fight_count;		/* Command arg -- Fights to have */
+cptr arg_describe;		/* Command arg -- Savefile to describe */
+bool arg_spoil;			/* Command arg -- Write the spoilers */
+u32b arg_spoil_seed;		/* Command arg -- Random artifact seed, or 0 */
 int arg_graphics;			/* Command arg -- Request graphics mode */
 bool arg_graphics_nice;			/* Command arg -- Request nice graphics mode */
 
@@ -58,6 +68,7 @@ u32b seed_randart;		/* Hack -- consistent random artifacts */
 
 u32b seed_flavor;		/* Hack -- consistent object colors */
 u32b seed_town;			/* Hack -- consistent town layout */
+u32b seed_dungeon;		/* Hack -- reproducible dungeon levels */
 
 s16b num_repro;			/* Current reproducer count */
 
@@ -76,6 +87,7 @@ byte tile_height = 1;           /* Tile height in units of font height */
 s16b signal_count;		/* Hack -- Count interrupts */
 
 bool msg_flag;			/* Player has pending message */
+bool msg_quiet;			/* Hack -- Messages are thrown away */
 
 bool inkey_base;		/* See the "inkey()" function */
 bool inkey_xtra;		/* See the "inkey()" function */
@@ -93,9 +105,12 @@ bool repair_mflag_mark;	/* Hack -- repair monster flags (mark) */
 
 s16b o_max = 1;			/* Number of allocated objects */
 s16b o_cnt = 0;			/* Number of live objects */
+s16b o_size = 0;		/* Size of o_list[] */
+bool o_list_charging = TRUE;	/* Some rod in o_list[] may be charging */
 
 s16b mon_max = 1;	/* Number of allocated monsters */
 s16b mon_cnt = 0;	/* Number of live monsters */
+s16b mon_size = 0;	/* Size of mon_list[] */
 
 
 
@@ -446,66 +461,43 @@ byte *temp_x;
 
 
 /*
- * Array[DUNGEON_HGT][256] of cave grid info flags (padded)
+ * The current dungeon level
  *
- * These arrays are padded to a width of 256 to allow fast access to elements
- * in the array via "grid" values (see the GRID() macros).
+ * Note that each grid's "m_idx" yields the index of the monster or player in
+ * that grid, where negative numbers are used to represent the player,
+ * positive numbers are used to represent a monster, and zero is used to
+ * indicate "nobody".  Each grid's "o_idx" yields the index of the top object
+ * in the stack of objects in that grid, using the "next_o_idx" field in that
+ * object to indicate the next object in the stack, and so on, using zero to
+ * indicate "nothing".  Both replicate information held in the monster and
+ * object lists, for efficiency.
  */
-byte (*cave_info)[256];
-byte (*cave_info2)[256];
-
-/*
- * Array[DUNGEON_HGT][DUNGEON_WID] of cave grid feature codes
- */
-byte (*cave_feat)[DUNGEON_WID];
+struct cave *cave;
 
 
 /*
- * Array[DUNGEON_HGT][DUNGEON_WID] of cave grid object indexes
- *
- * Note that this array yields the index of the top object in the stack of
- * objects in a given grid, using the "next_o_idx" field in that object to
- * indicate the next object in the stack, and so on, using zero to indicate
- * "nothing".  This array replicates the information contained in the object
- * list, for efficiency, providing extremely fast determination of whether
- * any object is in a grid, and relatively fast determination of which objects
- * are in a grid.
+ * Array[o_size] of dungeon objects, grown as needed (see o_list_grow())
  */
-s16b (*cave_o_idx)[DUNGEON_WID];
-
-/*
- * Array[DUNGEON_HGT][DUNGEON_WID] of cave grid monster indexes
- *
- * Note that this array yields the index of the monster or player in a grid,
- * where negative numbers are used to represent the player, positive numbers
- * are used to represent a monster, and zero is used to indicate "nobody".
- * This array replicates the information contained in the monster list and
- * the player structure, but provides extremely fast determination of which,
- * if any, monster or player is in any given grid.
- */
-s16b (*cave_m_idx)[DUNGEON_WID];
-
-
-/*
- * Array[DUNGEON_HGT][DUNGEON_WID] of cave grid flow "cost" values
- */
-byte (*cave_cost)[DUNGEON_WID];
+object_type *o_list;
 
 /*
- * Array[DUNGEON_HGT][DUNGEON_WID] of cave grid flow "when" stamps
+ * Array[mon_size] of dungeon monsters, grown as needed (see mon_list_grow())
  */
-byte (*cave_when)[DUNGEON_WID];
-
+monster_type *mon_list;
 
 /*
- * Array[z_info->o_max] of dungeon objects
+ * Array[mon_live_num] of the indexes of the live monsters, in no particular
+ * order.  Loop over it backwards if monsters may be deleted on the way.
  */
-object_type *o_list;
+s16b *mon_live;
+s16b mon_live_num = 0;
 
 /*
- * Array[z_info->m_max] of dungeon monsters
+ * Array[mon_hurt_num] of the indexes of the monsters which have been hurt
+ * and may not have healed yet, the ones marked MFLAG_HURT (see regen_monsters())
  */
-monster_type *mon_list;
+s16b *mon_hurt;
+s16b mon_hurt_num = 0;
 
 /*
  * Total monster power
@@ -231,7 +231,7 @@ static void kind_info(char *buf, size_t buf_len,
 /*
  * Create a spoiler file for items
  */
-static void spoil_obj_desc(cptr fname)
+static bool spoil_obj_desc(cptr fname)
 {
 	int i, k, s, t, n = 0;
 
@@ -252,11 +252,7 @@ static void spoil_obj_desc(cptr fname)
 	fh = file_open(buf, MODE_WRITE, FTYPE_TEXT);
 
 	/* Oops */
-	if (!fh)
-	{
-		msg_print("Cannot create spoiler file.");
-		return;
-	}
+	if (!fh) return FALSE;
 
 
 	/* Header */
@@ -341,14 +337,7 @@ static void spoil_obj_desc(cptr fname)
 
 
 	/* Check for errors */
-	if (!file_close(fh))
-	{
-		msg_print("Cannot close spoiler file.");
-		return;
-	}
-
-	/* Message */
-	msg_print("Successfully created a spoiler file.");
+	return file_close(fh);
 }
 
 
@@ -444,7 +433,7 @@ bool make_fake_artifact(object_type *o_ptr, byte name1)
 /*
  * Create a spoiler file for artifacts
  */
-static void spoil_artifact(cptr fname)
+static bool spoil_artifact(cptr fname)
 {
 	int i, j;
 
@@ -459,11 +448,7 @@ static void spoil_artifact(cptr fname)
 	fh = file_open(buf, MODE_WRITE, FTYPE_TEXT);
 
 	/* Oops */
-	if (!fh)
-	{
-		msg_print("Cannot create spoiler file.");
-		return;
-	}
+	if (!fh) return FALSE;
 
 	/* Dump to the spoiler file */
 	text_out_hook = text_out_to_file;
@@ -529,14 +514,7 @@ static void spoil_artifact(cptr fname)
 	}
 
 	/* Check for errors */
-	if (!file_close(fh))
-	{
-		msg_print("Cannot close spoiler file.");
-		return;
-	}
-
-	/* Message */
-	msg_print("Successfully created a spoiler file.");
+	return file_close(fh);
 }
 
 
@@ -546,7 +524,7 @@ static void spoil_artifact(cptr fname)
 /*
  * Create a spoiler file for monsters
  */
-static void spoil_mon_desc(cptr fname)
+static bool spoil_mon_desc(cptr fname)
 {
 	int i, n = 0;
 
@@ -570,11 +548,7 @@ static void spoil_mon_desc(cptr fname)
 	fh = file_open(buf, MODE_WRITE, FTYPE_TEXT);
 
 	/* Oops */
-	if (!fh)
-	{
-		msg_print("Cannot create spoiler file.");
-		return;
-	}
+	if (!fh) return FALSE;
 
 	/* Dump the header */
 	x_file_putf(fh, encoding, "Monster Spoilers for %s Version %s\n",
@@ -662,14 +636,7 @@ static void spoil_mon_desc(cptr fname)
 
 
 	/* Check for errors */
-	if (!file_close(fh))
-	{
-		msg_print("Cannot close spoiler file.");
-		return;
-	}
-
-	/* Worked */
-	msg_print("Successfully created a spoiler file.");
+	return file_close(fh);
 }
 
 
@@ -683,7 +650,7 @@ static void spoil_mon_desc(cptr fname)
 /*
  * Create a spoiler file for monsters (-SHAWN-)
  */
-static void spoil_mon_info(cptr fname)
+static bool spoil_mon_info(cptr fname)
 {
 	char buf[1024];
 	int i, n;
@@ -696,11 +663,7 @@ static void spoil_mon_info(cptr fname)
 	fh = file_open(buf, MODE_WRITE, FTYPE_TEXT);
 
 	/* Oops */
-	if (!fh)
-	{
-		msg_print("Cannot create spoiler file.");
-		return;
-	}
+	if (!fh) return FALSE;
 
 	/* Dump to the spoiler file */
 	text_out_hook = text_out_to_file;
@@ -799,26 +762,69 @@ static void spoil_mon_info(cptr fname)
 	FREE(who);
 
 	/* Check for errors */
-	if (!file_close(fh))
+	return file_close(fh);
+}
+
+
+/*
+ * Write every spoiler file to the user directory, for a game with the
+ * random artifacts from `randart_seed` if `randarts` is set, without a
+ * character or a screen; used for the "-p" command line option.
+ */
+void spoil_all(bool randarts, u32b randart_seed)
+{
+	static const struct
 	{
-		msg_print("Cannot close spoiler file.");
-		return;
+		bool (*make)(cptr fname);
+		cptr fname;
+	} spoilers[] =
+	{
+		{ spoil_obj_desc, "obj-desc.spo" },
+		{ spoil_artifact, "artifact.spo" },
+		{ spoil_mon_desc, "mon-desc.spo" },
+		{ spoil_mon_info, "mon-info.spo" }
+	};
+
+	size_t i;
+
+	if (randarts)
+	{
+		seed_randart = randart_seed;
+		if (do_randart(seed_randart, TRUE))
+		{
+			printf("Could not make the random artifacts.\n");
+			return;
+		}
 	}
 
-	msg_print("Successfully created a spoiler file.");
+	for (i = 0; i < N_ELEMENTS(spoilers); i++)
+	{
+		char buf[1024];
+
+		path_build(buf, sizeof(buf), ANGBAND_DIR_USER, spoilers[i].fname);
+		printf("%s %s\n", spoilers[i].make(spoilers[i].fname) ?
+		       "Wrote" : "Could not write", buf);
+	}
 }
 
 
 static void spoiler_menu_act(const char *title, int row)
 {
+	bool ok = FALSE;
+
 	if (row == 0)
-		spoil_obj_desc("obj-desc.spo");
+		ok = spoil_obj_desc("obj-desc.spo");
 	else if (row == 1)
-		spoil_artifact("artifact.spo");
+		ok = spoil_artifact("artifact.spo");
 	else if (row == 2)
-		spoil_mon_desc("mon-desc.spo");
+		ok = spoil_mon_desc("mon-desc.spo");
 	else if (row == 3)
-		spoil_mon_info("mon-info.spo");
+		ok = spoil_mon_info("mon-info.spo");
+
+	if (ok)
+		msg_print("Successfully created a spoiler file.");
+	else
+		msg_print("Cannot create spoiler file.");
 
 	message_flush();
 }
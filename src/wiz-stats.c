@@ -16,12 +16,18 @@
  */
 #include "angband.h"
 #include "cmds.h"
+#include "generate.h"
 #include "wizard.h"
+#include "monster/monster.h"
 #include "object/tvalsval.h"
 
 
 #ifdef WITH_STATS
 
+#ifdef SET_UID
+# include <sys/wait.h>
+#endif /* SET_UID */
+
 /*** Utility ***/
 
 typedef struct
@@ -30,7 +36,7 @@ typedef struct
 	char *value;
 } keyv;
 
-static keyv results[10];
+static keyv results[32];
 static size_t no_results = 0;
 
 static void results_reset(void)
@@ -52,22 +58,22 @@ static void result_add(const char *key, const char *value)
 	no_results++;
 }
 
-static void results_print_csv_titles(void)
+static void results_print_csv_titles(ang_file *fh)
 {
 	size_t i;
 	for (i = 0; i < no_results; i++)
-		printf("%s,", results[i].key);
+		file_putf(fh, "%s,", results[i].key);
 
-	printf("\n");
+	file_putf(fh, "\n");
 }
 
-static void results_print_csv(void)
+static void results_print_csv(ang_file *fh)
 {
 	size_t i;
 	for (i = 0; i < no_results; i++)
-		printf("%s,", results[i].value);
+		file_putf(fh, "%s,", results[i].value);
 
-	printf("\n");
+	file_putf(fh, "\n");
 }
 #if 0
 static void results_print_csv_pair(const char *field1, const char *field2)
@@ -102,11 +108,27 @@ static void results_print_csv_pair(const char *field1, const char *field2)
  * This file does some very simple operations; namely, it iterates over the
  * entire dungeon grid and collects statistics on what monsters, objects, and
  * terrain are being generated.  The results are very useful for balancing.
+ * Objects, vaults and the level rating are taken from the level tally kept
+ * while the level was made, rather than looked for again.
+ *
+ * The results go to "stats.csv" in the user directory, one line per depth.
+ * Where fork() is available the depths are shared out between a number of
+ * worker processes, each with its own copy of the level and its own RNG
+ * seed, and the parent merges their lines back into depth order; otherwise
+ * (or with one worker) everything is done in this process.
  */
 
 #define TRIES	5000
 static size_t o_count[TRIES];
 static size_t gold_count[TRIES];
+static size_t m_count[TRIES];
+
+/* Depths to collect statistics for */
+#define STATS_DEPTH_STEP	5
+#define STATS_DEPTHS		(100 / STATS_DEPTH_STEP + 1)
+
+/* Most worker processes allowed */
+#define STATS_WORKERS_MAX	32
 
 
 inline static void stats_print_o(void)
@@ -125,20 +147,26 @@ inline static void stats_print_o(void)
 }
 
 
-double mon_drop;
-double mon_gold;
+static double mon_drop;
+static double mon_gold;
 
 inline static void stats_print_m(void)
 {
+	int i;
+	u64b x = 0;
 	float level_avg = 2*p_ptr->depth + 20;
 
+	for (i = 0; i < TRIES; i++)
+		x += m_count[i];
+
+	result_add("monsters", format("%f", (float) x / TRIES));
 	result_add("mon-drops", format("%f", mon_drop / TRIES));
 	result_add("mon-gold", format("%f", mon_gold * level_avg / TRIES));
 }
 
 static void stats_monster(const monster_type *m_ptr)
 {
-	const monster_race r_ptr = &r_info[m_ptr->r_idx];
+	const monster_race *r_ptr = &r_info[m_ptr->r_idx];
 	float prob = 0.0;
 
 	bool gold_ok = (!rf_has(r_ptr->flags, RF_ONLY_ITEM));
@@ -170,83 +198,412 @@ static void stats_monster(const monster_type *m_ptr)
 
 
 /*
- * This is the entry point for generation statistics.
+ * The level tallies added up over TRIES levels
+ */
+static struct
+{
+	double ood, vaults, pits, rating, feeling;
+} tally_sum;
+
+static void stats_tally(void)
+{
+	tally_sum.ood += level_tally.ood;
+	tally_sum.vaults += level_tally.vaults;
+	tally_sum.pits += level_tally.pits;
+	tally_sum.rating += level_tally.rating;
+	tally_sum.feeling += level_tally.feeling;
+}
+
+static void stats_print_tally(void)
+{
+	result_add("ood-objs", format("%f", tally_sum.ood / TRIES));
+	result_add("vaults", format("%f", tally_sum.vaults / TRIES));
+	result_add("pits", format("%f", tally_sum.pits / TRIES));
+	result_add("rating", format("%f", tally_sum.rating / TRIES));
+	result_add("feeling", format("%f", tally_sum.feeling / TRIES));
+}
+
+
+/*
+ * Add the level generation profile: the average time spent in each phase
+ * of generation, and the number of attempts thrown away.
+ */
+static void stats_print_gen(void)
+{
+	static const char *phases[GEN_PHASE_MAX] =
+	{
+		"ms-rooms", "ms-tunnels", "ms-streamers",
+		"ms-stairs", "ms-monsters", "ms-objects"
+	};
+
+	size_t i;
+
+	for (i = 0; i < GEN_PHASE_MAX; i++)
+		result_add(phases[i], format("%.3f",
+		           gen_profile_msec(gen_profile.phase[i]) / TRIES));
+
+	result_add("restarts", format("%lu", (unsigned long)gen_profile.restarts));
+}
+
+
+/*
+ * Generate TRIES levels at the current depth, and write a line of
+ * statistics on them to "fh" (after a line of titles, if "titles" is set).
  */
-static void stats_collect_level(void)
+static void stats_collect_level(ang_file *fh, bool titles)
 {
-	static bool first = TRUE;
-	size_t i, x, y;
+	size_t i;
+	int x, y;
 
 	memset(o_count, 0, sizeof(o_count));
 	memset(gold_count, 0, sizeof(gold_count));
+	memset(m_count, 0, sizeof(m_count));
 
 	mon_gold = 0.0;
 	mon_drop = 0.0;
 
 	results_reset();
+	gen_profile_reset();
 	result_add("level", format("%d", p_ptr->depth));
 
 
+	memset(&tally_sum, 0, sizeof(tally_sum));
+
 	for (i = 0; i < TRIES; i++)
 	{
 		generate_cave();
 
-		/* Get stats on objects */
-		for (y = 1; y < DUNGEON_HGT - 1; y++)
+		/* Get stats on objects, as they were counted while placed */
+		o_count[i] = level_tally.objects;
+		gold_count[i] = level_tally.gold;
+		stats_tally();
+
+		/* Get stats on monsters */
+		for (y = 1; y < cave->height - 1; y++)
 		{
-			for (x = 1; x < DUNGEON_WID - 1; x++)
+			for (x = 1; x < cave->width - 1; x++)
 			{
-				const object_type *obj = get_first_object(y, x);
-
-				if (obj) do
+				if (cave->grid[y][x].m_idx)
 				{
-					if (obj->tval == TV_GOLD) gold_count[i] += obj->pval;
-					else o_count[i]++;
+					m_count[i]++;
+					stats_monster(&mon_list[cave->grid[y][x].m_idx]);
 				}
-				while ((obj = get_next_object(obj)));
 			}
 		}
+	}
 
-		/* Get stats on monsters */
-		for (y = 1; y < DUNGEON_HGT - 1; y++)
+	stats_print_o();
+	stats_print_m();
+	stats_print_tally();
+	stats_print_gen();
+
+	if (titles) results_print_csv_titles(fh);
+	results_print_csv(fh);
+}
+
+
+/*
+ * Collect statistics for every depth "worker" is responsible for, out of
+ * "workers", into "fh".
+ */
+static void stats_collect_depths(ang_file *fh, int worker, int workers)
+{
+	int k;
+
+	for (k = worker; k < STATS_DEPTHS; k += workers)
+	{
+		p_ptr->depth = k * STATS_DEPTH_STEP;
+		if (p_ptr->depth == 0) p_ptr->depth = 1;
+
+		stats_collect_level(fh, (k == 0));
+	}
+}
+
+
+#ifdef SET_UID
+
+/*
+ * Share the depths out between "workers" child processes, and merge their
+ * results into "fh".  Returns FALSE if the workers couldn't be started.
+ */
+static bool stats_collect_forked(ang_file *fh, int workers)
+{
+	char buf[1024];
+	char line[1024];
+	ang_file *part[STATS_WORKERS_MAX];
+	u32b seed[STATS_WORKERS_MAX];
+	pid_t pid[STATS_WORKERS_MAX];
+	int w, k, status;
+	bool ok = TRUE;
+
+	/* Give each worker its own seed */
+	for (w = 0; w < workers; w++)
+		seed[w] = randint0(0x10000000);
+
+	/* Make sure nothing is written twice */
+	message_flush();
+
+	for (w = 0; w < workers; w++)
+	{
+		pid[w] = fork();
+
+		if (pid[w] < 0)
 		{
-			for (x = 1; x < DUNGEON_WID - 1; x++)
-			{
-				if (cave_m_idx[y][x])
-					stats_monster(&mon_list[cave_m_idx[y][x]]);
-			}
+			workers = w;
+			ok = FALSE;
+			break;
+		}
+
+		/* The worker writes its lines to a file of its own */
+		if (pid[w] == 0)
+		{
+			path_build(buf, sizeof(buf), ANGBAND_DIR_USER,
+			           format("stats-%d.csv", w));
+			part[w] = file_open(buf, MODE_WRITE, FTYPE_TEXT);
+			if (!part[w]) _exit(1);
+
+			Rand_state_init(seed[w]);
+			stats_collect_depths(part[w], w, workers);
+
+			file_close(part[w]);
+			_exit(0);
 		}
 	}
 
-	stats_print_o();
-	stats_print_m();
+	/* Wait for them all */
+	for (w = 0; w < workers; w++)
+	{
+		if ((waitpid(pid[w], &status, 0) < 0) ||
+		    !WIFEXITED(status) || WEXITSTATUS(status))
+			ok = FALSE;
+	}
 
-	if (first)
+	/* Open their results */
+	for (w = 0; w < workers; w++)
 	{
-		/* printf("level,mon-drops"); */
-		results_print_csv_titles();
-		first = FALSE;
+		path_build(buf, sizeof(buf), ANGBAND_DIR_USER,
+		           format("stats-%d.csv", w));
+		part[w] = ok ? file_open(buf, MODE_READ, FTYPE_TEXT) : NULL;
+		if (!part[w]) ok = FALSE;
 	}
 
-	/* results_print_csv_pair("level", "mon-drops"); */
-	results_print_csv();
+	/* Merge them back into depth order (the first has the titles too) */
+	if (ok && file_getl(part[0], line, sizeof(line)))
+		file_putf(fh, "%s\n", line);
 
-	do_cmd_redraw();
+	for (k = 0; ok && k < STATS_DEPTHS; k++)
+	{
+		if (file_getl(part[k % workers], line, sizeof(line)))
+			file_putf(fh, "%s\n", line);
+	}
+
+	/* Clean up */
+	for (w = 0; w < workers; w++)
+	{
+		if (part[w]) file_close(part[w]);
+
+		path_build(buf, sizeof(buf), ANGBAND_DIR_USER,
+		           format("stats-%d.csv", w));
+		file_delete(buf);
+	}
+
+	if (!ok) msg_print("Statistics workers failed.");
+
+	return (ok);
+}
+
+#endif /* SET_UID */
+
+
+/*** Monster drops ***/
+
+/*
+ * What a race dropped over a number of kills at one depth
+ */
+struct drop_totals
+{
+	int items;		/* Objects made, a stack counting once */
+	int piles;		/* Piles of gold made */
+	long objects;		/* Objects made, counting every one in a stack */
+	long egos;
+	long artifacts;
+	long gold;		/* Value of the gold */
+};
+
+static void stats_drop(object_type *o_ptr, void *data)
+{
+	struct drop_totals *t = data;
+
+	if (o_ptr->tval == TV_GOLD)
+	{
+		t->gold += o_ptr->pval;
+		return;
+	}
+
+	t->objects += o_ptr->number;
+	if (o_ptr->name1) t->artifacts++;
+	else if (o_ptr->name2) t->egos++;
 }
 
+/*
+ * Whether monsters of race `r_ptr` drop anything when they die
+ */
+static bool stats_race_drops(const monster_race *r_ptr)
+{
+	return rf_has(r_ptr->flags, RF_DROP_20) ||
+			rf_has(r_ptr->flags, RF_DROP_40) ||
+			rf_has(r_ptr->flags, RF_DROP_60) ||
+			rf_has(r_ptr->flags, RF_DROP_1) ||
+			rf_has(r_ptr->flags, RF_DROP_2) ||
+			rf_has(r_ptr->flags, RF_DROP_3) ||
+			rf_has(r_ptr->flags, RF_DROP_4);
+}
+
+/*
+ * Simulate `kills` deaths of every race that drops anything, at its own
+ * level and every STATS_DEPTH_STEP levels deeper (shallower than its own
+ * level makes no difference), and write what they dropped to "drops.csv"
+ * in the user directory, a line for each race and depth.
+ *
+ * Only the drops are made, by monster_make_drops(), without any level or
+ * monster.  The artifacts made are forgotten after each kill, so that
+ * every kill has the same chance of one, and the level rating and depth
+ * are put back afterwards.
+ */
+bool stats_collect_drops(int kills)
+{
+	char buf[1024];
+	ang_file *fh;
+	bool *created;
+	s16b old_depth = p_ptr->depth;
+	s16b old_rating = rating;
+	bool old_peek = OPT(cheat_peek);
+	int r_idx, depth, i, k;
+
+	path_build(buf, sizeof(buf), ANGBAND_DIR_USER, "drops.csv");
+	fh = file_open(buf, MODE_WRITE, FTYPE_TEXT);
+
+	if (!fh)
+	{
+		msg_print("Cannot create statistics file.");
+		return FALSE;
+	}
+
+	created = C_ZNEW(z_info->a_max, bool);
+	for (i = 0; i < z_info->a_max; i++)
+		created[i] = a_info[i].created;
+
+	/* Nothing to mention */
+	OPT(cheat_peek) = FALSE;
+
+	file_putf(fh, "race,name,level,depth,kills,items,objects,egos,"
+	          "artifacts,gold-piles,gold\n");
+
+	for (r_idx = 1; r_idx < z_info->r_max; r_idx++)
+	{
+		const monster_race *r_ptr = &r_info[r_idx];
+
+		if (!r_ptr->name || !stats_race_drops(r_ptr)) continue;
+
+		for (depth = MIN(r_ptr->level, 100); depth <= 100;
+		     depth = (depth / STATS_DEPTH_STEP + 1) * STATS_DEPTH_STEP)
+		{
+			struct drop_totals t;
+
+			WIPE(&t, struct drop_totals);
+			p_ptr->depth = depth;
+
+			for (k = 0; k < kills; k++)
+			{
+				long artifacts = t.artifacts;
+
+				monster_make_drops(r_ptr, depth, stats_drop, &t, &t.items,
+				                   &t.piles);
+
+				/* Let them be made again */
+				if (t.artifacts != artifacts)
+				{
+					for (i = 0; i < z_info->a_max; i++)
+						a_info[i].created = created[i];
+				}
+			}
+
+			file_putf(fh, "%d,\"%s\",%d,%d,%d,%d,%ld,%ld,%ld,%d,%ld\n",
+			          r_idx, r_ptr->name, r_ptr->level, depth, kills, t.items,
+			          t.objects, t.egos, t.artifacts, t.piles, t.gold);
+		}
+	}
+
+	/* Put things back */
+	for (i = 0; i < z_info->a_max; i++)
+		a_info[i].created = created[i];
+	FREE(created);
+
+	OPT(cheat_peek) = old_peek;
+	rating = old_rating;
+	p_ptr->depth = old_depth;
+
+	file_close(fh);
+	msg_format("Statistics written to %s.", buf);
+
+	return TRUE;
+}
 
 
 void stats_collect(void)
 {
-	int depth;
+	char buf[1024];
+	ang_file *fh;
+	int workers = 1;
+	char ch;
 
-	for (depth = 0; depth < 101; depth += 5)
+	/* Ask which statistics */
+	if (!get_com("Collect statistics on [l]evels or monster [d]rops? ", &ch))
+		return;
+
+	if (ch == 'd' || ch == 'D')
 	{
-		p_ptr->depth = depth;
-		if (p_ptr->depth == 0) p_ptr->depth = 1;
+		int kills = get_quantity("Kills per race and depth? ", 1000000);
 
-		stats_collect_level();
+		if (kills > 0) stats_collect_drops(kills);
+		return;
 	}
+
+	if (ch != 'l' && ch != 'L') return;
+
+#ifdef SET_UID
+	/* Ask how many processes to use */
+	workers = get_quantity("Worker processes? ", STATS_WORKERS_MAX);
+	if (workers < 1) return;
+#endif /* SET_UID */
+
+	path_build(buf, sizeof(buf), ANGBAND_DIR_USER, "stats.csv");
+	fh = file_open(buf, MODE_WRITE, FTYPE_TEXT);
+
+	if (!fh)
+	{
+		msg_print("Cannot create statistics file.");
+		return;
+	}
+
+#ifdef SET_UID
+	/* The workers leave this process's level alone */
+	if (workers > 1)
+	{
+		bool ok = stats_collect_forked(fh, workers);
+
+		file_close(fh);
+		if (ok) msg_format("Statistics written to %s.", buf);
+		return;
+	}
+#endif /* SET_UID */
+
+	stats_collect_depths(fh, 0, 1);
+
+	file_close(fh);
+	msg_format("Statistics written to %s.", buf);
+
+	do_cmd_redraw();
 }
 
 
@@ -260,11 +617,11 @@ static void print_dun(void)
 	int y, x;
 
 	/* Get stats on objects */
-	for (y = 1; y < DUNGEON_HGT - 1; y++)
+	for (y = 1; y < cave->height - 1; y++)
 	{
-		for (x = 1; x < DUNGEON_WID - 1; x++)
+		for (x = 1; x < cave->width - 1; x++)
 		{
-			char feat = 'A' + cave_feat[y][x];
+			char feat = 'A' + cave->grid[y][x].feat;
 			printf("%c", feat);
 		}
 		printf("\n");
@@ -279,4 +636,10 @@ void stats_collect(void)
 	msg_print("Statistics generation not turned on in this build.");
 }
 
+bool stats_collect_drops(int kills)
+{
+	msg_print("Statistics generation not turned on in this build.");
+	return FALSE;
+}
+
 #endif /* WITH_STATS */
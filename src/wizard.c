@@ -20,14 +20,21 @@
 #include "cave.h"
 #include "cmds.h"
 #include "files.h"
+#include "generate.h"
 #include "monster/monster.h"
 #include "object/tvalsval.h"
 #include "object/object.h"
+#include "perf.h"
+#include "state-hash.h"
 #include "ui-menu.h"
 #include "spells.h"
 #include "target.h"
 #include "wizard.h"
 
+#ifdef SET_UID
+# include <sys/wait.h>
+#endif /* SET_UID */
+
 
 #ifdef ALLOW_DEBUG
 
@@ -42,6 +49,27 @@ s16b get_idx_from_name(char *s)
 	return *endptr == '\0' ? (s16b)l : 0;
 }
 
+/*
+ * The index of the only `what` whose name starts with `prefix`, as found by
+ * `lookup`, or -1 (saying why) if there isn't just one
+ */
+static int wiz_only_match(const char *prefix, const char *what,
+		int (*lookup)(const char *prefix, int *matches))
+{
+	int matches;
+	int idx = lookup(prefix, &matches);
+
+	if (matches == 1) return idx;
+
+	if (!matches)
+		msg_format("No %s's name starts with \"%s\".", what, prefix);
+	else
+		msg_format("%d %ss' names start with \"%s\".", matches, what,
+				prefix);
+
+	return -1;
+}
+
 /*
  * Hack -- quick debugging hook
  */
@@ -65,10 +93,10 @@ static void do_cmd_wiz_hack_ben(void)
 				if (!in_bounds_fully(y, x)) continue;
 
 				/* Display proper cost */
-				if (cave_cost[y][x] != i) continue;
+				if (cave->cost[y][x] != i) continue;
 
 				/* Reliability in yellow */
-				if (cave_when[y][x] == cave_when[py][px])
+				if (cave->when[y][x] == cave->when[py][px])
 				{
 					a = TERM_YELLOW;
 				}
@@ -698,6 +726,227 @@ static void wiz_reroll_item(object_type *o_ptr)
  */
 #define TEST_ROLL 100000
 
+/*
+ * Most worker processes to roll items in
+ */
+#define TEST_WORKERS_MAX 32
+
+
+/*
+ * Count how `i_ptr` compares with the reference item `o_ptr` in `stats`
+ */
+static void wiz_roll_compare(const object_type *o_ptr, const object_type *i_ptr,
+		struct wiz_roll_stats *stats)
+{
+	/* Test for the same tval and sval. */
+	if ((o_ptr->tval) != (i_ptr->tval)) return;
+	if ((o_ptr->sval) != (i_ptr->sval)) return;
+
+	/* Check for match */
+	if ((i_ptr->pval == o_ptr->pval) &&
+	    (i_ptr->to_a == o_ptr->to_a) &&
+	    (i_ptr->to_h == o_ptr->to_h) &&
+	    (i_ptr->to_d == o_ptr->to_d))
+	{
+		stats->matches++;
+	}
+
+	/* Check for better */
+	else if ((i_ptr->pval >= o_ptr->pval) &&
+	         (i_ptr->to_a >= o_ptr->to_a) &&
+	         (i_ptr->to_h >= o_ptr->to_h) &&
+	         (i_ptr->to_d >= o_ptr->to_d))
+	{
+		stats->better++;
+	}
+
+	/* Check for worse */
+	else if ((i_ptr->pval <= o_ptr->pval) &&
+	         (i_ptr->to_a <= o_ptr->to_a) &&
+	         (i_ptr->to_h <= o_ptr->to_h) &&
+	         (i_ptr->to_d <= o_ptr->to_d))
+	{
+		stats->worse++;
+	}
+
+	/* Assume different */
+	else
+	{
+		stats->other++;
+	}
+}
+
+/*
+ * Make `rolls` items at `level` and count how they compare with `o_ptr`
+ * into `stats`.  If `show` is set the counts are shown as it goes, and a
+ * keypress stops it.
+ */
+static void wiz_roll_serial(const object_type *o_ptr, int level, bool good,
+		bool great, long rolls, struct wiz_roll_stats *stats, bool show)
+{
+	cptr q = "Rolls: %ld, Matches: %ld, Better: %ld, Worse: %ld, Other: %ld";
+	artifact_type *a_ptr;
+
+	object_type *i_ptr;
+	object_type object_type_body;
+
+	/* Let's rock and roll */
+	for (; stats->rolls < rolls; stats->rolls++)
+	{
+		long i = stats->rolls;
+
+		/* Output every few rolls */
+		if (show && ((i < 100) || (i % 100 == 0)))
+		{
+			/* Do not wait */
+			inkey_scan = SCAN_INSTANT;
+
+			/* Allow interupt */
+			if (inkey())
+			{
+				/* Flush */
+				flush();
+
+				/* Stop rolling */
+				break;
+			}
+
+			/* Dump the stats */
+			prt(format(q, i, stats->matches, stats->better, stats->worse,
+			           stats->other), 0, 0);
+			Term_fresh();
+		}
+
+
+		/* Get local object */
+		i_ptr = &object_type_body;
+
+		/* Wipe the object */
+		object_wipe(i_ptr);
+
+		/* Create an object */
+		make_object(i_ptr, level, good, great);
+
+		/* Allow multiple artifacts, because breaking the game is fine here */
+		a_ptr = artifact_of(o_ptr);
+		if (a_ptr) a_ptr->created = FALSE;
+
+		wiz_roll_compare(o_ptr, i_ptr, stats);
+	}
+}
+
+
+#ifdef SET_UID
+
+/*
+ * Share `rolls` out between `workers` child processes, each with an RNG
+ * seed of its own, and add up their counts in `stats`.  Returns FALSE if
+ * the workers couldn't be started.
+ */
+static bool wiz_roll_forked(const object_type *o_ptr, int level, bool good,
+		bool great, long rolls, int workers, struct wiz_roll_stats *stats)
+{
+	struct wiz_roll_stats part;
+	int fd[TEST_WORKERS_MAX];
+	pid_t pid[TEST_WORKERS_MAX];
+	u32b seed[TEST_WORKERS_MAX];
+	int w, status;
+	bool ok = TRUE;
+
+	/* Give each worker its own seed */
+	for (w = 0; w < workers; w++)
+		seed[w] = randint0(0x10000000);
+
+	/* Make sure nothing is written twice */
+	message_flush();
+
+	for (w = 0; w < workers; w++)
+	{
+		int pipe_fd[2];
+
+		if (pipe(pipe_fd) < 0) break;
+
+		pid[w] = fork();
+
+		if (pid[w] < 0)
+		{
+			close(pipe_fd[0]);
+			close(pipe_fd[1]);
+			break;
+		}
+
+		/* The worker sends back its counts */
+		if (pid[w] == 0)
+		{
+			close(pipe_fd[0]);
+
+			WIPE(&part, struct wiz_roll_stats);
+			Rand_state_init(seed[w]);
+			wiz_roll_serial(o_ptr, level, good, great,
+			                rolls / workers + (w < rolls % workers),
+			                &part, FALSE);
+
+			if (write(pipe_fd[1], &part, sizeof(part)) != sizeof(part))
+				_exit(1);
+			_exit(0);
+		}
+
+		close(pipe_fd[1]);
+		fd[w] = pipe_fd[0];
+	}
+
+	if (w < workers) ok = FALSE;
+	workers = w;
+
+	/* Add up what they found */
+	for (w = 0; w < workers; w++)
+	{
+		if (read(fd[w], &part, sizeof(part)) == sizeof(part))
+		{
+			stats->rolls += part.rolls;
+			stats->matches += part.matches;
+			stats->better += part.better;
+			stats->worse += part.worse;
+			stats->other += part.other;
+		}
+		else ok = FALSE;
+
+		close(fd[w]);
+
+		if ((waitpid(pid[w], &status, 0) < 0) ||
+		    !WIFEXITED(status) || WEXITSTATUS(status))
+			ok = FALSE;
+	}
+
+	return (ok);
+}
+
+#endif /* SET_UID */
+
+
+/*
+ * Make `rolls` items at `level` in `workers` processes and count how they
+ * compare with `o_ptr` into `stats`.  Returns FALSE if the workers failed,
+ * in which case the counts are only of those that didn't.
+ */
+bool wiz_roll_items(const object_type *o_ptr, int level, bool good,
+		bool great, long rolls, int workers, struct wiz_roll_stats *stats)
+{
+	bool ok = TRUE;
+
+	WIPE(stats, struct wiz_roll_stats);
+
+#ifdef SET_UID
+	if (workers > 1)
+		ok = wiz_roll_forked(o_ptr, level, good, great, rolls,
+		                     MIN(workers, TEST_WORKERS_MAX), stats);
+	else
+#endif /* SET_UID */
+		wiz_roll_serial(o_ptr, level, good, great, rolls, stats, FALSE);
+
+	return (ok);
+}
+
 
 /*
  * Try to create an item again. Output some statistics.    -Bernd-
@@ -710,16 +959,14 @@ static void wiz_reroll_item(object_type *o_ptr)
  */
 static void wiz_statistics(object_type *o_ptr, int level)
 {
-	long i, matches, better, worse, other;
+	struct wiz_roll_stats stats;
+	int workers = 1;
 
 	char ch;
 	cptr quality;
 
 	bool good, great;
 
-	object_type *i_ptr;
-	object_type object_type_body;
-
 	cptr q = "Rolls: %ld, Matches: %ld, Better: %ld, Worse: %ld, Other: %ld";
 
 
@@ -767,92 +1014,39 @@ static void wiz_statistics(object_type *o_ptr, int level)
 			break;
 		}
 
+#ifdef SET_UID
+		/* Ask how many processes to use */
+		workers = get_quantity("Worker processes? ", TEST_WORKERS_MAX);
+		if (workers < 1) break;
+#endif /* SET_UID */
+
 		/* Let us know what we are doing */
 		msg_format("Creating a lot of %s items. Base level = %d.",
 		           quality, p_ptr->depth);
 		message_flush();
 
 		/* Set counters to zero */
-		matches = better = worse = other = 0;
+		WIPE(&stats, struct wiz_roll_stats);
 
-		/* Let's rock and roll */
-		for (i = 0; i <= TEST_ROLL; i++)
+		/* Only one process can show how it's going, or be stopped */
+		if (workers > 1)
 		{
-			/* Output every few rolls */
-			if ((i < 100) || (i % 100 == 0))
-			{
-				/* Do not wait */
-				inkey_scan = SCAN_INSTANT;
-
-				/* Allow interupt */
-				if (inkey())
-				{
-					/* Flush */
-					flush();
-
-					/* Stop rolling */
-					break;
-				}
-
-				/* Dump the stats */
-				prt(format(q, i, matches, better, worse, other), 0, 0);
-				Term_fresh();
-			}
-
-
-			/* Get local object */
-			i_ptr = &object_type_body;
-
-			/* Wipe the object */
-			object_wipe(i_ptr);
-
-			/* Create an object */
-			make_object(i_ptr, level, good, great);
-
-			/* Allow multiple artifacts, because breaking the game is fine here */
-			a_ptr = artifact_of(o_ptr);
-			if (a_ptr) a_ptr->created = FALSE;
-
-			/* Test for the same tval and sval. */
-			if ((o_ptr->tval) != (i_ptr->tval)) continue;
-			if ((o_ptr->sval) != (i_ptr->sval)) continue;
-
-			/* Check for match */
-			if ((i_ptr->pval == o_ptr->pval) &&
-			    (i_ptr->to_a == o_ptr->to_a) &&
-			    (i_ptr->to_h == o_ptr->to_h) &&
-			    (i_ptr->to_d == o_ptr->to_d))
-			{
-				matches++;
-			}
-
-			/* Check for better */
-			else if ((i_ptr->pval >= o_ptr->pval) &&
-			         (i_ptr->to_a >= o_ptr->to_a) &&
-			         (i_ptr->to_h >= o_ptr->to_h) &&
-			         (i_ptr->to_d >= o_ptr->to_d))
-			{
-				better++;
-			}
-
-			/* Check for worse */
-			else if ((i_ptr->pval <= o_ptr->pval) &&
-			         (i_ptr->to_a <= o_ptr->to_a) &&
-			         (i_ptr->to_h <= o_ptr->to_h) &&
-			         (i_ptr->to_d <= o_ptr->to_d))
-			{
-				worse++;
-			}
+			prt("Rolling...", 0, 0);
+			Term_fresh();
 
-			/* Assume different */
-			else
-			{
-				other++;
-			}
+			if (!wiz_roll_items(o_ptr, level, good, great, TEST_ROLL,
+			                    workers, &stats))
+				msg_print("Some workers failed.");
+		}
+		else
+		{
+			wiz_roll_serial(o_ptr, level, good, great, TEST_ROLL, &stats,
+			                TRUE);
 		}
 
 		/* Final dump */
-		msg_format(q, i, matches, better, worse, other);
+		msg_format(q, stats.rolls, stats.matches, stats.better, stats.worse,
+		           stats.other);
 		message_flush();
 	}
 
@@ -1322,12 +1516,13 @@ static void do_cmd_wiz_named(int r_idx, bool slp)
  */
 static void do_cmd_wiz_zap(int d)
 {
-	int i;
+	int n;
 
 	/* Banish everyone nearby */
-	for (i = 1; i < mon_max; i++)
+	for (n = mon_live_num - 1; n >= 0; n--)
 	{
-		monster_type *m_ptr = &mon_list[i];
+		int m_idx = mon_live[n];
+		monster_type *m_ptr = &mon_list[m_idx];
 
 		/* Skip dead monsters */
 		if (!m_ptr->r_idx) continue;
@@ -1336,7 +1531,7 @@ static void do_cmd_wiz_zap(int d)
 		if (m_ptr->cdis > d) continue;
 
 		/* Delete the monster */
-		delete_monster_idx(i);
+		delete_monster_idx(m_idx);
 	}
 
 	/* Update monster list window */
@@ -1349,12 +1544,13 @@ static void do_cmd_wiz_zap(int d)
  */
 static void do_cmd_wiz_unhide(int d)
 {
-	int i;
+	int n;
 
 	/* Process monsters */
-	for (i = 1; i < mon_max; i++)
+	for (n = mon_live_num - 1; n >= 0; n--)
 	{
-		monster_type *m_ptr = &mon_list[i];
+		int m_idx = mon_live[n];
+		monster_type *m_ptr = &mon_list[m_idx];
 
 		/* Skip dead monsters */
 		if (!m_ptr->r_idx) continue;
@@ -1369,7 +1565,7 @@ static void do_cmd_wiz_unhide(int d)
 		m_ptr->mflag |= (MFLAG_MARK | MFLAG_SHOW);
 
 		/* Update the monster */
-		update_mon(i, FALSE);
+		update_mon(m_idx, FALSE);
 	}
 }
 
@@ -1387,6 +1583,7 @@ static void do_cmd_wiz_query(void)
 	char cmd;
 
 	u16b mask = 0x00;
+	planeword *plane = NULL;
 
 
 	/* Get a "debug command" */
@@ -1408,8 +1605,8 @@ static void do_cmd_wiz_query(void)
 		case 'g': mask |= (CAVE_GLOW); break;
 		case 'r': mask |= (CAVE_ROOM); break;
 		case 'i': mask |= (CAVE_ICKY); break;
-		case 's': mask |= (CAVE_SEEN); break;
-		case 'v': mask |= (CAVE_VIEW); break;
+		case 's': plane = cave->seen; break;
+		case 'v': plane = cave->view; break;
 		case 't': mask |= (CAVE_TEMP); break;
 		case 'w': mask |= (CAVE_WALL); break;
 	}
@@ -1424,10 +1621,14 @@ static void do_cmd_wiz_query(void)
 			if (!in_bounds_fully(y, x)) continue;
 
 			/* Given mask, show only those grids */
-			if (mask && !(cave_info[y][x] & mask)) continue;
+			if (mask && !(cave->grid[y][x].info & mask)) continue;
 
-			/* Given no mask, show unknown grids */
-			if (!mask && (cave_info[y][x] & (CAVE_MARK))) continue;
+			/* Given plane, show only those grids */
+			if (plane && !plane_has(plane, GRID(y, x))) continue;
+
+			/* Given neither, show unknown grids */
+			if (!mask && !plane && (cave->grid[y][x].info & (CAVE_MARK)))
+				continue;
 
 			/* Color */
 			if (cave_floor_bold(y, x)) a = TERM_YELLOW;
@@ -1495,6 +1696,95 @@ static void wiz_test_kind(int tval)
 	msg_print("Done.");
 }
 
+/*
+ * Show the level generation profile, and start it again
+ */
+static void do_cmd_wiz_gen_profile(void)
+{
+	textblock *tb = textblock_new();
+	region area = { 0, 0, 0, 0 };
+
+	gen_profile_describe(tb);
+	textui_textblock_show(tb, area, "Level generation profile");
+	textblock_free(tb);
+
+	gen_profile_reset();
+}
+
+/*
+ * Show how much memory is in use, by what it is for
+ */
+static void do_cmd_wiz_memory(void)
+{
+	textblock *tb = textblock_new();
+	region area = { 0, 0, 0, 0 };
+	int i;
+
+	textblock_append(tb, "%-12s %10s %10s %10s %10s\n", "Use", "blocks",
+	                 "bytes", "peak", "allocs");
+
+	for (i = 0; i < MEM_TAG_MAX; i++)
+	{
+		struct mem_stats st;
+
+		mem_tag_stats(i, &st);
+		textblock_append(tb, "%-12s %10lu %10ld %10ld %10lu\n",
+		                 mem_tag_name(i), (unsigned long)st.count,
+		                 st.bytes, st.peak, (unsigned long)st.allocs);
+	}
+
+	textui_textblock_show(tb, area, "Memory use");
+	textblock_free(tb);
+}
+
+#ifdef ALLOW_PERF
+
+/*
+ * Show the per-turn timings and counts, start them again, and turn the
+ * trace file on or off
+ */
+static void do_cmd_wiz_perf(void)
+{
+	textblock *tb = textblock_new();
+	region area = { 0, 0, 0, 0 };
+
+	perf_describe(tb);
+	textui_textblock_show(tb, area, "Turn profile");
+	textblock_free(tb);
+
+	perf_reset();
+
+	if (get_check("Trace every turn to perf.csv? "))
+	{
+		if (!perf_trace(TRUE)) msg_print("Could not open perf.csv.");
+	}
+	else
+	{
+		perf_trace(FALSE);
+	}
+}
+
+#endif /* ALLOW_PERF */
+
+/*
+ * Show the hash of the game state, and start or stop logging it every
+ * "num" game turns to statehash.log, or checking it against that
+ */
+static void do_cmd_wiz_hash(int num)
+{
+	msg_format("The game state hashes to %08lx.", (unsigned long)state_hash());
+
+	if (num <= 0)
+	{
+		state_hash_start(0, NULL, FALSE);
+		return;
+	}
+
+	if (!state_hash_start(num, "statehash.log",
+			get_check("Check against statehash.log, rather than write it? ")))
+		msg_print("Could not open statehash.log.");
+}
+
 /*
  * Display the debug commands help file.
  */
@@ -1602,6 +1892,11 @@ void do_cmd_debug(void)
 					/* If not, find the artifact with that name */
 					if (a_idx < 1)
 						a_idx = lookup_artifact_name(name); 
+
+					/* Or the only one whose name starts that way */
+					if (a_idx == -1)
+						a_idx = wiz_only_match(name, "artifact",
+								lookup_artifact_prefix);
 					
 					/* Did we find a valid artifact? */
 					if (a_idx != -1)
@@ -1634,6 +1929,38 @@ void do_cmd_debug(void)
 			break;
 		}
 
+		/* Level generation profile */
+		case 'G':
+		{
+			do_cmd_wiz_gen_profile();
+			break;
+		}
+
+		/* Memory use */
+		case 'M':
+		{
+			do_cmd_wiz_memory();
+			break;
+		}
+
+		/* Hash the game state */
+		case 'H':
+		{
+			do_cmd_wiz_hash(p_ptr->command_arg);
+			break;
+		}
+
+#ifdef ALLOW_PERF
+
+		/* Turn profile */
+		case 'P':
+		{
+			do_cmd_wiz_perf();
+			break;
+		}
+
+#endif
+
 		/* Good Objects */
 		case 'g':
 		{
@@ -1704,6 +2031,11 @@ void do_cmd_debug(void)
 					/* If not, find the monster with that name */
 					if (r_idx < 1)
 						r_idx = lookup_monster(name); 
+
+					/* Or the only one whose name starts that way */
+					if (r_idx == -1)
+						r_idx = wiz_only_match(name, "monster",
+								lookup_monster_prefix);
 					
 					/* Did we find a valid monster? */
 					if (r_idx != -1)
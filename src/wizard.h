@@ -2,10 +2,22 @@
 #define INCLUDED_WIZARD_H
 
 /* wizard.c */
+struct wiz_roll_stats
+{
+	long rolls;
+	long matches;	/* Same bonuses as the reference item */
+	long better;	/* None lower */
+	long worse;	/* None higher */
+	long other;	/* Some higher, some lower */
+};
+
 extern void do_cmd_debug(void);
+extern bool wiz_roll_items(const object_type *o_ptr, int level, bool good,
+		bool great, long rolls, int workers, struct wiz_roll_stats *stats);
 
 /* wiz-stats.c */
 void stats_collect(void);
+bool stats_collect_drops(int kills);
 
 /* wiz-spoil.c */
 void do_cmd_spoilers(void);
@@ -40,19 +40,64 @@ void xchar_trans_hook(char *s, int encoding)
 }
 
 
+/*
+ * The encodes in latin1_encode[], looked up by name through an open hash
+ * (of their indexes plus one) and by character through a direct table of
+ * the first encode for each, set up on first use.
+ */
+#define XCHAR_HASH_SIZE		256
+
+static bool xchar_ready;
+static s16b xchar_hash[XCHAR_HASH_SIZE];
+static const char *xchar_tag[256];
+
+static int xchar_key(const char *encode)
+{
+	u32b h = 5381;
+
+	while (*encode)
+		h = h * 33 + (byte)*encode++;
+
+	return (int)(h & (XCHAR_HASH_SIZE - 1));
+}
+
+static void xchar_init(void)
+{
+	int i, h;
+
+	/* Keep the hash from filling up */
+	for (i = 0; latin1_encode[i].c && (i < XCHAR_HASH_SIZE - 1); i++)
+	{
+		for (h = xchar_key(latin1_encode[i].tag); xchar_hash[h]; )
+			h = (h + 1) & (XCHAR_HASH_SIZE - 1);
+
+		xchar_hash[h] = i + 1;
+
+		/* The first encode for a character is the one written */
+		if (!xchar_tag[latin1_encode[i].c])
+			xchar_tag[latin1_encode[i].c] = latin1_encode[i].tag;
+	}
+
+	xchar_ready = TRUE;
+}
+
+
 /*
  * Given what we think is an encode, return a Latin-1 character position.
  */
 static byte encode_to_xchar(char *encode)
 {
- 	int i;
+ 	int h;
+
+ 	if (!xchar_ready) xchar_init();
 
- 	/* Scan until we hit the end-of-table marker */
- 	for (i = 0; latin1_encode[i].c; i++)
+ 	/* Probe until we hit an empty slot */
+ 	for (h = xchar_key(encode); xchar_hash[h]; h = (h + 1) & (XCHAR_HASH_SIZE - 1))
  	{
+ 		const xchar_type *x = &latin1_encode[xchar_hash[h] - 1];
+
  		/* We found the encode; return the character */
- 		if (streq(encode, latin1_encode[i].tag))
- 			return (latin1_encode[i].c);
+ 		if (streq(encode, x->tag)) return (x->c);
  	}
 
  	/* This encode is not recognized */
@@ -100,15 +145,9 @@ bool get_encode(char *str, char *c)
 
 
 /*
- * Take a 7-bit ASCII string and use any encodes in it to insert 8-bit
- * characters.  Use the Latin-1 (ISO) standard by default.  -LM-
- *
- * Optionally, translate into 7-bit ASCII or a system-specific character set.
- *
- * The input string must be '\0'-terminated, and should not be greater than
- * 1024 character in length (we check this).
+ * Use any encodes in a 7-bit ASCII string to insert 8-bit characters.
  */
-void xstr_trans(char *str, int encoding)
+static void xstr_decode(char *str)
 {
  	/* Assume no encodes in this string */
  	bool flag = FALSE;
@@ -119,9 +158,6 @@ void xstr_trans(char *str, int encoding)
  	char buf[1024];
  	char encode[80];
 
- 	/* Require a string */
- 	if (!str) return;
-
  	/* Start at the beginning */
  	s = str;
  	b = buf;
@@ -197,6 +233,26 @@ void xstr_trans(char *str, int encoding)
 
  	/* Copy the edited string back, if we've found encodes */
  	if (flag) strcpy(str, buf);
+}
+
+/*
+ * Take a 7-bit ASCII string and use any encodes in it to insert 8-bit
+ * characters.  Use the Latin-1 (ISO) standard by default.  -LM-
+ *
+ * Optionally, translate into 7-bit ASCII or a system-specific character set.
+ *
+ * The input string must be '\0'-terminated, and should not be greater than
+ * 1024 character in length (we check this).
+ */
+void xstr_trans(char *str, int encoding)
+{
+ 	char *s;
+
+ 	/* Require a string */
+ 	if (!str) return;
+
+ 	/* Most strings have no encodes at all */
+ 	if (strchr(str, '[')) xstr_decode(str);
 
 	/* Translate the string if we don't want standard Latin-1 */
 	if (encoding != LATIN1)
@@ -226,18 +282,11 @@ void escape_latin1(char *dest, size_t max, cptr src)
 		if (chr > 127)
 		{
 			int j;
-			const char *tag = NULL;
+			const char *tag;
 
 			/* Find the escape secuence of the character */
-			for (j = 0; latin1_encode[j].c > 0; j++)
-			{
-				if (latin1_encode[j].c == chr)
-				{
-					tag = latin1_encode[j].tag;
-
-					break;
-				}
-			}
+			if (!xchar_ready) xchar_init();
+			tag = xchar_tag[chr];
 
 			/* Found? */
 			if (tag)
@@ -202,7 +202,51 @@ cptr get_spell_name(int tval, int spell)
 }
 
 
+/*
+ * The info strings already made for each book's spells, as they are drawn
+ * on every row of every spell menu.  They only depend on the character's
+ * level, race and class, so all are made again when any of those change.
+ */
+#define SPELL_INFO_LEN	30
+
+static char spell_info[2][PY_MAX_SPELLS][SPELL_INFO_LEN];
+static bool spell_info_made[2][PY_MAX_SPELLS];
+static s16b spell_info_lev = -1;
+static const player_race *spell_info_race;
+static const player_class *spell_info_class;
+
+static void spell_info_make(int tval, int spell, char *p, size_t len);
+
 void get_spell_info(int tval, int spell, char *p, size_t len)
+{
+	int realm = (tval == TV_MAGIC_BOOK) ? 0 : 1;
+
+	if ((spell < 0) || (spell >= PY_MAX_SPELLS) ||
+	    ((tval != TV_MAGIC_BOOK) && (tval != TV_PRAYER_BOOK)))
+	{
+		spell_info_make(tval, spell, p, len);
+		return;
+	}
+
+	if ((spell_info_lev != p_ptr->lev) || (spell_info_race != rp_ptr) ||
+	    (spell_info_class != cp_ptr))
+	{
+		C_WIPE(spell_info_made, 2, bool[PY_MAX_SPELLS]);
+		spell_info_lev = p_ptr->lev;
+		spell_info_race = rp_ptr;
+		spell_info_class = cp_ptr;
+	}
+
+	if (!spell_info_made[realm][spell])
+	{
+		spell_info_make(tval, spell, spell_info[realm][spell], SPELL_INFO_LEN);
+		spell_info_made[realm][spell] = TRUE;
+	}
+
+	my_strcpy(p, spell_info[realm][spell], len);
+}
+
+static void spell_info_make(int tval, int spell, char *p, size_t len)
 {
 	/* Blank 'p' first */
 	p[0] = '\0';
@@ -24,6 +24,7 @@
 #include "files.h"
 #include "game-event.h"
 #include "game-cmd.h"
+#include "init.h"
 #include "monster/monster.h"
 #include "object/tvalsval.h"
 #include "textui.h"
@@ -903,7 +904,7 @@ static size_t prt_state(int row, int col)
  */
 static size_t prt_dtrap(int row, int col)
 {
-	byte info = cave_info2[p_ptr->py][p_ptr->px];
+	byte info = cave->grid[p_ptr->py][p_ptr->px].info2;
 
 	/* The player is in a trap-detected grid */
 	if (info & (CAVE2_DTRAP))
@@ -1301,6 +1302,13 @@ static struct minimap_flags
 {
 	int win_idx;
 	bool needs_redraw;
+
+	/* Grids changed since the last redraw, if it wasn't a whole-map one */
+	planeword changed[CAVE_PLANE_SIZE];
+	bool any_changed;
+
+	/* The window size the map was last drawn for */
+	int wid, hgt;
 } minimap_data[ANGBAND_TERM_MAX];
 
 static void update_minimap_subwindow(game_event_type type, game_event_data *data, void *user)
@@ -1312,27 +1320,52 @@ static void update_minimap_subwindow(game_event_type type, game_event_data *data
 		/* Set flag if whole-map redraw. */
 		if (data->point.x == -1 && data->point.y == -1)
 			flags->needs_redraw = TRUE;
+
+		/* Otherwise just note the grid */
+		else if (in_bounds(data->point.y, data->point.x))
+		{
+			plane_on(flags->changed, GRID(data->point.y, data->point.x));
+			flags->any_changed = TRUE;
+		}
 	}
 	else if (type == EVENT_END)
 	{
 		term *old = Term;
 		term *t = angband_term[flags->win_idx];
+
+		/* Redraw everything if the window has changed size */
+		if ((t->wid != flags->wid) || (t->hgt != flags->hgt))
+			flags->needs_redraw = TRUE;
+
+		/* Nothing to do */
+		if (!flags->needs_redraw && !flags->any_changed) return;
 		
 		/* Activate */
 		Term_activate(t);
 
 		/* If whole-map redraw, clear window first. */
 		if (flags->needs_redraw)
+		{
 			Term_clear();
+			display_map(NULL, NULL);
+		}
+
+		/* Otherwise only redraw what has changed */
+		else
+		{
+			display_map_grids(flags->changed);
+		}
 
-		/* Redraw map */
-		display_map(NULL, NULL);
 		Term_fresh();
 		
 		/* Restore */
 		Term_activate(old);
 
 		flags->needs_redraw = FALSE;
+		flags->any_changed = FALSE;
+		plane_wipe(flags->changed, CAVE_PLANE_SIZE);
+		flags->wid = t->wid;
+		flags->hgt = t->hgt;
 	}
 }
 
@@ -1450,65 +1483,120 @@ static void flush_subwindow(game_event_type type, game_event_data *data, void *u
 }
 
 
+/*
+ * Most subwindows are redrawn once at the end of a series of events,
+ * however many of the events they show were signalled; redrawing a player
+ * window for each of the player events at once was a lot of wasted work.
+ * The events just mark the window as needing a redraw, and EVENT_END does
+ * the drawing.  Messages are still shown as they arrive, and the map windows
+ * look after themselves.
+ */
+static struct subwindow_redraw
+{
+	term *t;
+	game_event_handler *draw;
+	bool dirty;
+} subwindow_redraws[ANGBAND_TERM_MAX][PW_MAX_FLAGS];
+
+static void mark_subwindow(game_event_type type, game_event_data *data, void *user)
+{
+	struct subwindow_redraw *redraw = user;
+
+	redraw->dirty = TRUE;
+}
+
+static void redraw_subwindow(game_event_type type, game_event_data *data, void *user)
+{
+	struct subwindow_redraw *redraw = user;
+
+	if (!redraw->dirty) return;
+
+	redraw->dirty = FALSE;
+	redraw->draw(type, data, redraw->t);
+}
+
+/*
+ * Start or stop (as "new_state") redrawing the "flag" display in window
+ * "win_idx" with "draw" after any of the "n_events" in "events"
+ */
+static void subwindow_set_deferred(int win_idx, u32b flag, bool new_state,
+		game_event_type *events, size_t n_events, game_event_handler *draw)
+{
+	struct subwindow_redraw *redraw;
+	int i = 0;
+
+	while (!(flag & (1L << i))) i++;
+	redraw = &subwindow_redraws[win_idx][i];
+
+	if (new_state)
+	{
+		redraw->t = angband_term[win_idx];
+		redraw->draw = draw;
+		redraw->dirty = FALSE;
+
+		event_add_handler_set(events, n_events, mark_subwindow, redraw);
+		event_add_handler(EVENT_END, redraw_subwindow, redraw);
+	}
+	else
+	{
+		event_remove_handler_set(events, n_events, mark_subwindow, redraw);
+		event_remove_handler(EVENT_END, redraw_subwindow, redraw);
+	}
+}
+
 static void subwindow_flag_changed(int win_idx, u32b flag, bool new_state)
 {
+	game_event_type event;
+
 	void (*register_or_deregister)(game_event_type type, game_event_handler *fn, void *user);
-	void (*set_register_or_deregister)(game_event_type *type, size_t n_events, game_event_handler *fn, void *user);
 
 	/* Decide whether to register or deregister an evenrt handler */
 	if (new_state == FALSE)
-	{
 		register_or_deregister = event_remove_handler;
-		set_register_or_deregister = event_remove_handler_set;
-	}
 	else
-	{
 		register_or_deregister = event_add_handler;
-		set_register_or_deregister = event_add_handler_set;
-	}
 
 	switch (flag)
 	{
 		case PW_INVEN:
 		{
-			register_or_deregister(EVENT_INVENTORY,
-					       update_inven_subwindow,
-					       angband_term[win_idx]);
+			event = EVENT_INVENTORY;
+			subwindow_set_deferred(win_idx, flag, new_state,
+			                       &event, 1,
+			                       update_inven_subwindow);
 			break;
 		}
 
 		case PW_EQUIP:
 		{
-			register_or_deregister(EVENT_EQUIPMENT,
-					       update_equip_subwindow,
-					       angband_term[win_idx]);
+			event = EVENT_EQUIPMENT;
+			subwindow_set_deferred(win_idx, flag, new_state,
+			                       &event, 1,
+			                       update_equip_subwindow);
 			break;
 		}
 
 		case PW_PLAYER_0:
 		{
-			set_register_or_deregister(player_events, 
-						   N_ELEMENTS(player_events),
-						   update_player0_subwindow,
-						   angband_term[win_idx]);
+			subwindow_set_deferred(win_idx, flag, new_state,
+			                       player_events, N_ELEMENTS(player_events),
+			                       update_player0_subwindow);
 			break;
 		}
 
 		case PW_PLAYER_1:
 		{
-			set_register_or_deregister(player_events, 
-						   N_ELEMENTS(player_events),
-						   update_player1_subwindow,
-						   angband_term[win_idx]);
+			subwindow_set_deferred(win_idx, flag, new_state,
+			                       player_events, N_ELEMENTS(player_events),
+			                       update_player1_subwindow);
 			break;
 		}
 
 		case PW_PLAYER_2:
 		{
-			set_register_or_deregister(player_events, 
-						   N_ELEMENTS(player_events),
-						   update_player_compact_subwindow,
-						   angband_term[win_idx]);
+			subwindow_set_deferred(win_idx, flag, new_state,
+			                       player_events, N_ELEMENTS(player_events),
+			                       update_player_compact_subwindow);
 			break;
 		}
 
@@ -1536,6 +1624,7 @@ static void subwindow_flag_changed(int win_idx, u32b flag, bool new_state)
 		case PW_OVERHEAD:
 		{
 			minimap_data[win_idx].win_idx = win_idx;
+			minimap_data[win_idx].needs_redraw = TRUE;
 
 			register_or_deregister(EVENT_MAP,
 					       update_minimap_subwindow,
@@ -1549,37 +1638,41 @@ static void subwindow_flag_changed(int win_idx, u32b flag, bool new_state)
 
 		case PW_MONSTER:
 		{
-			register_or_deregister(EVENT_MONSTERTARGET,
-					       update_monster_subwindow,
-					       angband_term[win_idx]);
+			event = EVENT_MONSTERTARGET;
+			subwindow_set_deferred(win_idx, flag, new_state,
+			                       &event, 1,
+			                       update_monster_subwindow);
 			break;
 		}
 
 		case PW_OBJECT:
 		{
-			register_or_deregister(EVENT_OBJECTTARGET,
-						   update_object_subwindow,
-						   angband_term[win_idx]);
+			event = EVENT_OBJECTTARGET;
+			subwindow_set_deferred(win_idx, flag, new_state,
+			                       &event, 1,
+			                       update_object_subwindow);
 			break;
 		}
 
 		case PW_MONLIST:
 		{
-			register_or_deregister(EVENT_MONSTERLIST,
-					       update_monlist_subwindow,
-					       angband_term[win_idx]);
+			event = EVENT_MONSTERLIST;
+			subwindow_set_deferred(win_idx, flag, new_state,
+			                       &event, 1,
+			                       update_monlist_subwindow);
 			break;
 		}
 
 		case PW_ITEMLIST:
 		{
-			register_or_deregister(EVENT_ITEMLIST,
-						   update_itemlist_subwindow,
-						   angband_term[win_idx]);
+			event = EVENT_ITEMLIST;
+			subwindow_set_deferred(win_idx, flag, new_state,
+			                       &event, 1,
+			                       update_itemlist_subwindow);
 			break;
+		}
 	}
 }
-}
 
 
 /*
@@ -1820,11 +1913,14 @@ void init_display(void)
 }
 
 
-/* Return a random hint from the global hints list */
+/* Return a random hint from the global hints list, reading it if need be */
 char* random_hint(void)
 {
 	struct hint *v, *r = NULL;
 	int n;
+
+	if (!init_hints()) return "";
+
 	for (v = hints, n = 1; v; v = v->next, n++)
 		if (one_in_(n))
 			r = v;
@@ -19,6 +19,28 @@
 #include "z-bitflag.h"
 
 
+/*
+ * The bulk operations below work through bitfields a word at a time, and
+ * then finish off any bytes left over.  Bitfields are only byte-aligned, so
+ * the words are copied in and out with memcpy(), which the compiler turns
+ * into plain loads and stores.
+ */
+typedef u64b flagword;
+#define FLAGWORD_SIZE     sizeof(flagword)
+
+static flagword flagword_get(const bitflag *flags)
+{
+	flagword w;
+	memcpy(&w, flags, FLAGWORD_SIZE);
+	return w;
+}
+
+static void flagword_put(bitflag *flags, flagword w)
+{
+	memcpy(flags, &w, FLAGWORD_SIZE);
+}
+
+
 /**
  * Tests if a flag is "on" in a bitflag set.
  *
@@ -63,7 +85,7 @@ bool flag_has_dbg(const bitflag *flags, const size_t size, const int flag, const
 /**
  * Interates over the flags which are "on" in a bitflag set.
  *
- * Returns the next on flag in `flags`, starting from (but not including)
+ * Returns the next on flag in `flags`, starting from (and including)
  * `flag`. FLAG_END will be returned when the end of the flag set is reached.
  * Iteration will start at the beginning of the flag set when `flag` is
  * FLAG_END. The bitfield size is supplied in `size`.
@@ -71,14 +93,23 @@ bool flag_has_dbg(const bitflag *flags, const size_t size, const int flag, const
 int flag_next(const bitflag *flags, const size_t size, const int flag)
 {
 	const int max_flags = FLAG_MAX(size);
-	int f, flag_offset, flag_binary;
+	int f = (flag < FLAG_START) ? FLAG_START : flag;
 
-	for (f = flag; f < max_flags; f++)
+	while (f < max_flags)
 	{
-		flag_offset = FLAG_OFFSET(f);
-		flag_binary = FLAG_BINARY(f);
+		size_t i = FLAG_OFFSET(f);
+		bitflag rest = flags[i] & ~(FLAG_BINARY(f) - 1);
+		int b;
+
+		/* Skip whole empty bytes */
+		if (!rest)
+		{
+			f = FLAG_MAX(i + 1);
+			continue;
+		}
 
-		if (flags[flag_offset] & flag_binary) return f;
+		for (b = 0; !(rest & (1 << b)); b++) ;
+		return FLAG_MAX(i) + b;
 	}
 
 	return FLAG_END;
@@ -95,7 +126,10 @@ bool flag_is_empty(const bitflag *flags, const size_t size)
 {
 	size_t i;
 
-	for (i = 0; i < size; i++)
+	for (i = 0; i + FLAGWORD_SIZE <= size; i += FLAGWORD_SIZE)
+		if (flagword_get(&flags[i])) return FALSE;
+
+	for (; i < size; i++)
 		if (flags[i] > 0) return FALSE;
 
 	return TRUE;
@@ -112,7 +146,10 @@ bool flag_is_full(const bitflag *flags, const size_t size)
 {
 	size_t i;
 
-	for (i = 0; i < size; i++)
+	for (i = 0; i + FLAGWORD_SIZE <= size; i += FLAGWORD_SIZE)
+		if (flagword_get(&flags[i]) != (flagword) -1) return FALSE;
+
+	for (; i < size; i++)
 		if (flags[i] != (bitflag) -1) return FALSE;
 
 	return TRUE;
@@ -129,7 +166,10 @@ bool flag_is_inter(const bitflag *flags1, const bitflag *flags2, const size_t si
 {
 	size_t i;
 
-	for (i = 0; i < size; i++)
+	for (i = 0; i + FLAGWORD_SIZE <= size; i += FLAGWORD_SIZE)
+		if (flagword_get(&flags1[i]) & flagword_get(&flags2[i])) return TRUE;
+
+	for (; i < size; i++)
 		if (flags1[i] & flags2[i]) return TRUE;
 
 	return FALSE;
@@ -146,8 +186,11 @@ bool flag_is_subset(const bitflag *flags1, const bitflag *flags2, const size_t s
 {
 	size_t i;
 
-	for (i = 0; i < size; i++)
-		if (!(~flags1[i] & flags2[i])) return FALSE;
+	for (i = 0; i + FLAGWORD_SIZE <= size; i += FLAGWORD_SIZE)
+		if (~flagword_get(&flags1[i]) & flagword_get(&flags2[i])) return FALSE;
+
+	for (; i < size; i++)
+		if (~flags1[i] & flags2[i]) return FALSE;
 
 	return TRUE;
 }
@@ -259,8 +302,11 @@ void flag_setall(bitflag *flags, const size_t size)
 void flag_negate(bitflag *flags, const size_t size)
 {
 	size_t i;
-	
-	for (i = 0; i < size; i++)
+
+	for (i = 0; i + FLAGWORD_SIZE <= size; i += FLAGWORD_SIZE)
+		flagword_put(&flags[i], ~flagword_get(&flags[i]));
+
+	for (; i < size; i++)
 		flags[i] = ~flags[i];
 }
 
@@ -289,9 +335,19 @@ bool flag_union(bitflag *flags1, const bitflag *flags2, const size_t size)
 	size_t i;
 	bool delta = FALSE;
 
-	for (i = 0; i < size; i++)
+	for (i = 0; i + FLAGWORD_SIZE <= size; i += FLAGWORD_SIZE)
 	{
+		flagword w1 = flagword_get(&flags1[i]);
+		flagword w2 = flagword_get(&flags2[i]);
+
 		/* !flag_is_subset() */
+		if (~w1 & w2) delta = TRUE;
+
+		flagword_put(&flags1[i], w1 | w2);
+	}
+
+	for (; i < size; i++)
+	{
 		if (~flags1[i] & flags2[i]) delta = TRUE;
 
 		flags1[i] |= flags2[i];
@@ -313,10 +369,20 @@ bool flag_comp_union(bitflag *flags1, const bitflag *flags2, const size_t size)
 	size_t i;
 	bool delta = FALSE;
 
-	for (i = 0; i < size; i++)
+	for (i = 0; i + FLAGWORD_SIZE <= size; i += FLAGWORD_SIZE)
 	{
+		flagword w1 = flagword_get(&flags1[i]);
+		flagword w2 = flagword_get(&flags2[i]);
+
 		/* no equivalent fn */
-		if (!(~flags1[i] & ~flags2[i])) delta = TRUE;
+		if (~w1 & ~w2) delta = TRUE;
+
+		flagword_put(&flags1[i], w1 | ~w2);
+	}
+
+	for (; i < size; i++)
+	{
+		if ((bitflag) (~flags1[i] & ~flags2[i])) delta = TRUE;
 
 		flags1[i] |= ~flags2[i];
 	}
@@ -337,10 +403,20 @@ bool flag_inter(bitflag *flags1, const bitflag *flags2, const size_t size)
 	size_t i;
 	bool delta = FALSE;
 
-	for (i = 0; i < size; i++)
+	for (i = 0; i + FLAGWORD_SIZE <= size; i += FLAGWORD_SIZE)
 	{
-		/* !flag_is_equal() */
-		if (!(flags1[i] == flags2[i])) delta = TRUE;
+		flagword w1 = flagword_get(&flags1[i]);
+		flagword w2 = flagword_get(&flags2[i]);
+
+		/* !flag_is_subset(flags2, flags1) */
+		if (w1 & ~w2) delta = TRUE;
+
+		flagword_put(&flags1[i], w1 & w2);
+	}
+
+	for (; i < size; i++)
+	{
+		if ((bitflag) (flags1[i] & ~flags2[i])) delta = TRUE;
 
 		flags1[i] &= flags2[i];
 	}
@@ -362,9 +438,19 @@ bool flag_diff(bitflag *flags1, const bitflag *flags2, const size_t size)
 	size_t i;
 	bool delta = FALSE;
 
-	for (i = 0; i < size; i++)
+	for (i = 0; i + FLAGWORD_SIZE <= size; i += FLAGWORD_SIZE)
 	{
+		flagword w1 = flagword_get(&flags1[i]);
+		flagword w2 = flagword_get(&flags2[i]);
+
 		/* flag_is_inter() */
+		if (w1 & w2) delta = TRUE;
+
+		flagword_put(&flags1[i], w1 & ~w2);
+	}
+
+	for (; i < size; i++)
+	{
 		if (flags1[i] & flags2[i]) delta = TRUE;
 
 		flags1[i] &= ~flags2[i];
@@ -598,3 +684,181 @@ bool flags_mask(bitflag *flags, const size_t size, ...)
 
 	return delta;
 }
+
+
+
+/**
+ * Clears all cells in a bitplane.
+ *
+ * The bitplane size (in words) is supplied in `size`.
+ */
+void plane_wipe(planeword *plane, const size_t size)
+{
+	memset(plane, 0, size * sizeof(planeword));
+}
+
+
+/**
+ * Sets all cells in a bitplane.
+ *
+ * The bitplane size (in words) is supplied in `size`.
+ */
+void plane_setall(planeword *plane, const size_t size)
+{
+	memset(plane, 255, size * sizeof(planeword));
+}
+
+
+/**
+ * Copies one bitplane into another.
+ *
+ * All cells in `plane2` are copied into `plane1`. The size of the bitplanes
+ * is supplied in `size`.
+ */
+void plane_copy(planeword *plane1, const planeword *plane2, const size_t size)
+{
+	memcpy(plane1, plane2, size * sizeof(planeword));
+}
+
+
+/**
+ * Computes the union of two bitplanes.
+ *
+ * Every cell set in `plane2` is set in `plane1`. The size of the bitplanes is
+ * supplied in `size`.
+ */
+void plane_union(planeword *plane1, const planeword *plane2, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		plane1[i] |= plane2[i];
+}
+
+
+/**
+ * Computes the intersection of two bitplanes.
+ *
+ * Every cell not set in `plane2` is cleared in `plane1`. The size of the
+ * bitplanes is supplied in `size`.
+ */
+void plane_inter(planeword *plane1, const planeword *plane2, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		plane1[i] &= plane2[i];
+}
+
+
+/**
+ * Computes the difference of two bitplanes.
+ *
+ * Every cell set in `plane2` is cleared in `plane1`. The size of the
+ * bitplanes is supplied in `size`.
+ */
+void plane_diff(planeword *plane1, const planeword *plane2, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		plane1[i] &= ~plane2[i];
+}
+
+
+/**
+ * Stores the cells set in one bitplane but not another.
+ *
+ * `dest` becomes `plane1` with every cell set in `plane2` cleared, which is
+ * the set of cells that were "gained" going from `plane2` to `plane1`. The
+ * size of the bitplanes is supplied in `size`.
+ */
+void plane_andnot(planeword *dest, const planeword *plane1,
+		const planeword *plane2, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		dest[i] = plane1[i] & ~plane2[i];
+}
+
+
+/**
+ * Tests a bitplane for emptiness.
+ *
+ * TRUE is returned when no cells are set in `plane`, and FALSE otherwise.
+ * The bitplane size is supplied in `size`.
+ */
+bool plane_is_empty(const planeword *plane, const size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		if (plane[i]) return FALSE;
+
+	return TRUE;
+}
+
+
+/**
+ * Counts the cells which are set in a bitplane.
+ *
+ * The bitplane size is supplied in `size`.
+ */
+int plane_count(const planeword *plane, const size_t size)
+{
+	size_t i;
+	int count = 0;
+
+	for (i = 0; i < size; i++)
+	{
+		planeword w = plane[i];
+
+		/* Clear the lowest set bit until none remain */
+		for (; w; w &= w - 1)
+			count++;
+	}
+
+	return count;
+}
+
+
+/**
+ * Iterates over the cells which are set in a bitplane.
+ *
+ * Returns the first set cell in `plane` at or after cell `n`, or -1 when
+ * there are no more. Empty words are skipped a whole word at a time. The
+ * bitplane size is supplied in `size`.
+ */
+int plane_next(const planeword *plane, const size_t size, const int n)
+{
+	size_t i = n / PLANE_WIDTH;
+	planeword w;
+
+	if (n < 0 || i >= size) return -1;
+
+	/* Ignore the cells before n in the first word */
+	w = plane[i] & (~(planeword)0 << (n % PLANE_WIDTH));
+
+	while (!w)
+	{
+		if (++i >= size) return -1;
+		w = plane[i];
+	}
+
+#ifdef __GNUC__
+	return (int)(i * PLANE_WIDTH) + __builtin_ctzll(w);
+#else
+	{
+		int bit = 0;
+
+		while (!(w & 1))
+		{
+			w >>= 1;
+			bit++;
+		}
+
+		return (int)(i * PLANE_WIDTH) + bit;
+	}
+#endif
+}
@@ -75,4 +75,37 @@ bool flags_set      (bitflag *flags, const size_t size, ...);
 void flags_init     (bitflag *flags, const size_t size, ...);
 bool flags_mask     (bitflag *flags, const size_t size, ...);
 
+
+/*** Bitplanes ***/
+
+/*
+ * A bitplane holds one bit for each cell of some grid, packed into whole
+ * machine words so that bulk operations work a word (64 cells) at a time.
+ * Cells are numbered from 0; callers decide how (y,x) maps to a cell.
+ */
+typedef u64b planeword;
+#define PLANE_WIDTH       (sizeof(planeword)*8)
+
+/* The array size necessary to hold "n" cells */
+#define PLANE_SIZE(n)     (((n) + PLANE_WIDTH - 1) / PLANE_WIDTH)
+
+/* Test, set and clear single cells */
+#define plane_has(p, n) \
+	((int)(((p)[(n) / PLANE_WIDTH] >> ((n) % PLANE_WIDTH)) & 1))
+#define plane_on(p, n) \
+	((p)[(n) / PLANE_WIDTH] |= ((planeword)1 << ((n) % PLANE_WIDTH)))
+#define plane_off(p, n) \
+	((p)[(n) / PLANE_WIDTH] &= ~((planeword)1 << ((n) % PLANE_WIDTH)))
+
+void plane_wipe     (planeword *plane, const size_t size);
+void plane_setall   (planeword *plane, const size_t size);
+void plane_copy     (planeword *plane1, const planeword *plane2, const size_t size);
+void plane_union    (planeword *plane1, const planeword *plane2, const size_t size);
+void plane_inter    (planeword *plane1, const planeword *plane2, const size_t size);
+void plane_diff     (planeword *plane1, const planeword *plane2, const size_t size);
+void plane_andnot   (planeword *dest, const planeword *plane1, const planeword *plane2, const size_t size);
+bool plane_is_empty (const planeword *plane, const size_t size);
+int  plane_count    (const planeword *plane, const size_t size);
+int  plane_next     (const planeword *plane, const size_t size, const int n);
+
 #endif
@@ -43,6 +43,10 @@
 # include <sys/types.h>
 #endif
 
+#ifdef HAVE_MMAP
+# include <sys/mman.h>
+#endif
+
 #ifdef WINDOWS
 # define my_mkdir(path, perms) mkdir(path)
 #elif HAVE_MKDIR || MACH_O_CARBON
@@ -244,6 +248,13 @@ struct ang_file
 	FILE *fh;
 	char *fname;
 	file_mode mode;
+
+	/* The whole file, from file_map() */
+	const char *map;
+	size_t map_len;
+	size_t map_pos;
+	bool map_tried;
+	bool map_alloced;
 };
 
 
@@ -391,6 +402,8 @@ ang_file *file_open(const char *fname, file_mode mode, file_type ftype)
  */
 bool file_close(ang_file *f)
 {
+	file_unmap(f);
+
 	if (fclose(f->fh) != 0)
 		return FALSE;
 
@@ -441,10 +454,41 @@ void file_unlock(ang_file *f)
 
 /*
  * Seek to location 'pos' in file 'f'.
+ *
+ * file_read() goes straight to the descriptor when HAVE_READ is set, so the
+ * seek has to as well; fseek() is free to move it elsewhere.
  */
 bool file_seek(ang_file *f, u32b pos)
 {
+	/* A mapped file is read from the map */
+	if (f->map)
+	{
+		if ((size_t)pos > f->map_len) return FALSE;
+		f->map_pos = pos;
+		return TRUE;
+	}
+
+#ifdef HAVE_READ
+	if (fflush(f->fh) != 0) return FALSE;
+	return (lseek(fileno(f->fh), pos, SEEK_SET) == (off_t) pos);
+#else
 	return (fseek(f->fh, pos, SEEK_SET) == 0);
+#endif
+}
+
+/*
+ * Find out where in file 'f' file_seek() would have to go to get back here.
+ */
+u32b file_tell(ang_file *f)
+{
+	if (f->map) return (u32b)f->map_pos;
+
+#ifdef HAVE_READ
+	if (fflush(f->fh) != 0) return 0;
+	return (u32b)lseek(fileno(f->fh), 0, SEEK_CUR);
+#else
+	return (u32b)ftell(f->fh);
+#endif
 }
 
 /*
@@ -452,7 +496,7 @@ bool file_seek(ang_file *f, u32b pos)
  */
 bool file_readc(ang_file *f, byte *b)
 {
-	int i = fgetc(f->fh);
+	int i = getc(f->fh);
 
 	if (i == EOF)
 		return FALSE;
@@ -541,6 +585,14 @@ bool file_write(ang_file *f, const char *buf, size_t n)
 {
 	int fd = fileno(f->fh);
 
+	/* Small writes, like lines of text, go through stdio's buffer */
+	if (n < BUFSIZ)
+		return (fwrite(buf, 1, n, f->fh) == n);
+
+	/* Larger ones go straight out, after anything already buffered */
+	if (fflush(f->fh) != 0)
+		return FALSE;
+
 #ifndef SET_UID
 
 	while (n >= WRITE_BUF_SIZE)
@@ -659,6 +711,179 @@ bool file_getl(ang_file *f, char *buf, size_t len)
 	return TRUE;
 }
 
+/*
+ * Read all of file 'f' into a buffer, for file_map() where the file can't be
+ * mapped.  Where the file has got to is left alone.
+ */
+static bool file_map_read(ang_file *f, long pos)
+{
+	long len;
+	char *buf;
+
+	if (fseek(f->fh, 0, SEEK_END) != 0) return FALSE;
+	len = ftell(f->fh);
+
+	if (len <= 0 || fseek(f->fh, 0, SEEK_SET) != 0)
+	{
+		fseek(f->fh, pos, SEEK_SET);
+		return FALSE;
+	}
+
+	buf = mem_alloc(len);
+	if (fread(buf, 1, len, f->fh) != (size_t)len)
+	{
+		mem_free(buf);
+		fseek(f->fh, pos, SEEK_SET);
+		return FALSE;
+	}
+
+	fseek(f->fh, pos, SEEK_SET);
+
+	f->map = buf;
+	f->map_len = len;
+	f->map_alloced = TRUE;
+
+	return TRUE;
+}
+
+const char *file_map(ang_file *f, size_t *len)
+{
+	long pos;
+
+	if (f->map_tried)
+	{
+		if (f->map && len) *len = f->map_len;
+		return f->map;
+	}
+	f->map_tried = TRUE;
+
+	if (f->mode != MODE_READ) return NULL;
+
+	/* file_getl_ref() starts from where the file has got to */
+	pos = ftell(f->fh);
+	if (pos < 0) return NULL;
+
+#ifdef HAVE_MMAP
+	{
+		struct stat st;
+
+		if (fstat(fileno(f->fh), &st) == 0 && st.st_size > 0)
+		{
+			void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+			                 fileno(f->fh), 0);
+
+			if (map != MAP_FAILED)
+			{
+#ifdef MADV_SEQUENTIAL
+				/* It will usually be read from start to end, so read ahead */
+				(void)madvise(map, st.st_size, MADV_SEQUENTIAL);
+#endif
+
+				f->map = map;
+				f->map_len = st.st_size;
+			}
+		}
+	}
+#endif
+
+	if (!f->map && !file_map_read(f, pos)) return NULL;
+
+	if ((size_t)pos > f->map_len)
+	{
+		file_unmap(f);
+		f->map_tried = TRUE;
+		return NULL;
+	}
+
+	f->map_pos = pos;
+
+	if (len) *len = f->map_len;
+	return f->map;
+}
+
+void file_unmap(ang_file *f)
+{
+	if (f->map)
+	{
+		if (f->map_alloced)
+			mem_free((void *)f->map);
+#ifdef HAVE_MMAP
+		else
+			munmap((void *)f->map, f->map_len);
+#endif
+	}
+
+	f->map = NULL;
+	f->map_len = 0;
+	f->map_pos = 0;
+	f->map_tried = FALSE;
+	f->map_alloced = FALSE;
+}
+
+bool file_getl_ref(ang_file *f, char *buf, size_t len, const char **line,
+                   size_t *line_len)
+{
+	const char *start, *end;
+	size_t i;
+
+	if (!file_map(f, NULL))
+	{
+		if (!file_getl(f, buf, len)) return FALSE;
+
+		*line = buf;
+		*line_len = strlen(buf);
+		return TRUE;
+	}
+
+	if (f->map_pos >= f->map_len) return FALSE;
+
+	start = f->map + f->map_pos;
+	end = f->map + f->map_len;
+
+	/* Find the end of the line, and anything file_getl() would change */
+	for (i = 0; start + i < end && i < len - 1; i++)
+	{
+		char c = start[i];
+
+		if (c == '\r' || c == '\n') break;
+		if (c == '\t' || c == '[' || !my_isprint((unsigned char)c)) break;
+	}
+
+	if (start + i < end && (start[i] == '\r' || start[i] == '\n'))
+	{
+		/* A clean line: point at it, and step past its line ending */
+		*line = start;
+		*line_len = i;
+
+		if (start[i] == '\r' && start + i + 1 < end && start[i + 1] == '\n')
+			i++;
+
+		f->map_pos += i + 1;
+		return TRUE;
+	}
+
+	if (start + i == end)
+	{
+		/* The last line, with no line ending */
+		*line = start;
+		*line_len = i;
+
+		f->map_pos = f->map_len;
+		return TRUE;
+	}
+
+	/* Otherwise let file_getl() deal with the rest of the line */
+	if (fseek(f->fh, (long)f->map_pos, SEEK_SET) != 0 ||
+			!file_getl(f, buf, len))
+		return FALSE;
+
+	f->map_pos = ftell(f->fh);
+
+	*line = buf;
+	*line_len = strlen(buf);
+	return TRUE;
+}
+
 /*
  * Append a line of text 'buf' to the end of file 'f', using system-dependent
  * line ending.
@@ -158,6 +158,38 @@ void file_unlock(ang_file *f);
  */
 bool file_getl(ang_file *f, char *buf, size_t n);
 
+/**
+ * Get the whole of the file represented by `f`, which must have been opened
+ * with MODE_READ, putting its length in `len` if that isn't NULL.
+ *
+ * The file is mapped into memory where the platform allows it, and read into
+ * a buffer where it doesn't.  The contents are read-only and stay valid until
+ * file_unmap() or file_close().  Mapping doesn't move where the file has got
+ * to for the other file functions.
+ *
+ * Returns NULL if the file is empty or can't be read.
+ */
+const char *file_map(ang_file *f, size_t *len);
+
+/**
+ * Release the contents got with file_map(), if there are any.
+ */
+void file_unmap(ang_file *f);
+
+/**
+ * Get a line of text from the file represented by `f` as file_getl() does,
+ * placing the start of the line in `line` and its length in `line_len`.
+ *
+ * Where the file can be mapped into memory, `line` points straight into the
+ * file, so isn't NUL-terminated; only lines file_getl() would change are
+ * copied into `buf`.  This uses file_map(), so a file read this way must not
+ * then be read with the other file functions.
+ *
+ * Returns TRUE when data is returned; FALSE otherwise.
+ */
+bool file_getl_ref(ang_file *f, char *buf, size_t n, const char **line,
+                   size_t *line_len);
+
 /**
  * Write the string pointed to by `buf` to the file represented by `f`.
  *
@@ -185,6 +217,14 @@ bool x_file_putf(ang_file *f, int encoding, const char *fmt, ...);
  */
 bool file_seek(ang_file *f, u32b pos);
 
+/**
+ * Get the position in the file represented by `f`, for a later file_seek().
+ *
+ * Once the file has been mapped with file_map(), both work on where
+ * file_getl_ref() will read the next line from.
+ */
+u32b file_tell(ang_file *f);
+
 /**
  * Reads n bytes from file 'f' info buffer 'buf'.
  * \returns Number of bytes read; -1 on error
@@ -553,6 +553,39 @@ size_t vstrnfmt(char *buf, size_t max, cptr fmt, va_list vp)
 				/* Hack -- convert NULL to EMPTY */
 				if (!arg) arg = "";
 
+				/*
+				 * Plain "%s" or "%^s" of a string with no encodes
+				 * goes straight into the buffer, which is the same
+				 * as the long way round below but a good deal
+				 * quicker.
+				 */
+				if (q == 2 && !strchr(arg, '['))
+				{
+					size_t len;
+
+					for (len = 0; arg[len] && len < sizeof(arg2) - 1; len++)
+					{
+						char c = arg[len];
+
+						/* Check total length */
+						if (n == max-1) break;
+
+						/* Capitalize the first non-space */
+						if (do_xtra && !my_isspace((unsigned char)c))
+						{
+							if (my_islower((unsigned char)c))
+								c = my_toupper((unsigned char)c);
+							do_xtra = FALSE;
+						}
+
+						buf[n++] = c;
+					}
+
+					/* Nothing left in "tmp" */
+					do_xtra = FALSE;
+					break;
+				}
+
 				/* Prevent buffer overflows */
 				(void)my_strcpy(arg2, arg, sizeof(arg2));
 
@@ -18,11 +18,17 @@
 #include "z-term.h"
 #include "z-msg.h"
 
+/*
+ * Messages are kept in a ring of MESSAGE_MAX records, with their text in a
+ * ring of MESSAGE_TEXT bytes.  Each new text goes straight after the last,
+ * or back at the start of the buffer if it won't fit before the end, and
+ * pushes out the oldest messages whose text is in its way.  So adding a
+ * message never allocates, and any message can be found by its age alone.
+ */
+
 typedef struct _message_t
 {
-	char *str;
-	struct _message_t *newer;
-	struct _message_t *older;
+	u32b text;		/* Offset of the text in msgqueue_t.text */
 	u16b type;
 	u16b count;
 } message_t;
@@ -36,11 +42,13 @@ typedef struct _msgcolor_t
 
 typedef struct _msgqueue_t
 {
-	message_t *head;
-	message_t *tail;
-	msgcolor_t *colors;
+	message_t ring[MESSAGE_MAX];
+	char text[MESSAGE_TEXT];
+	u32b head;		/* Slot for the next message */
 	u32b count;
-	u32b max;
+	u32b text_head;	/* Offset for the next message's text */
+	byte type_colors[MSG_MAX];
+	msgcolor_t *colors;		/* Colours of types past MSG_MAX */
 } msgqueue_t;
 
 static msgqueue_t *messages = NULL;
@@ -48,8 +56,7 @@ static msgqueue_t *messages = NULL;
 /* Functions operating on the entire list */
 errr messages_init(void)
 {
-	messages = ZNEW(msgqueue_t);
-	messages->max = 2048;
+	messages = mem_zalloc_tagged(sizeof(msgqueue_t), MEM_TAG_MSG);
 	return 0;
 }
 
@@ -57,16 +64,6 @@ void messages_free(void)
 {
 	msgcolor_t *c = messages->colors;
 	msgcolor_t *nextc;
-	message_t *m = messages->head;
-	message_t *nextm;
-
-	while (m)
-	{
-		nextm = m->older;
-		FREE(m->str);
-		FREE(m);
-		m = nextm;
-	}
 
 	while (c)
 	{
@@ -85,60 +82,74 @@ u16b messages_num(void)
 
 /* Functions for individual messages */
 
+static message_t *message_get(u16b age)
+{
+	if (age >= messages->count) return NULL;
+
+	return &messages->ring[(messages->head + MESSAGE_MAX - 1 - age) %
+			MESSAGE_MAX];
+}
+
+/*
+ * Forget the oldest messages while their text starts in [from, to)
+ */
+static void message_drop_text(u32b from, u32b to)
+{
+	while (messages->count)
+	{
+		message_t *m = message_get(messages->count - 1);
+
+		if (m->text < from || m->text >= to) break;
+		messages->count--;
+	}
+}
+
 void message_add(const char *str, u16b type)
 {
-	message_t *m;
+	message_t *m = message_get(0);
+	size_t len;
+	u32b at;
 
-	if (messages->head &&
-	    messages->head->type == type &&
-	    !strcmp(messages->head->str, str))
+	if (m && m->type == type && !strcmp(messages->text + m->text, str))
 	{
-		messages->head->count++;
+		m->count++;
 		return;
 	}
 
-	m = ZNEW(message_t);
-	m->str = string_make(str);
-	m->type = type;
-	m->count = 1;
-	m->older = messages->head;
-
-	if (messages->head)
-		messages->head->newer = m;
+	/* Make room for the text */
+	len = MIN(strlen(str), MESSAGE_TEXT - 1);
+	at = messages->text_head;
 
-	messages->head = m;
-	messages->count++;
+	if (at + len + 1 > MESSAGE_TEXT)
+	{
+		message_drop_text(at, MESSAGE_TEXT);
+		at = 0;
+	}
 
-	if (!messages->tail)
-		messages->tail = m;
+	message_drop_text(at, at + len + 1);
 
-	if (messages->count > messages->max)
-	{
-		message_t *old_tail = messages->tail;
+	memcpy(messages->text + at, str, len);
+	messages->text[at + len] = '\0';
+	messages->text_head = at + len + 1;
 
-		messages->tail = old_tail->newer;
-		messages->tail->older = NULL;
-		FREE(old_tail->str);
-		FREE(old_tail);
+	/* Make room for the record */
+	if (messages->count == MESSAGE_MAX)
 		messages->count--;
-	}
-}
 
-static message_t *message_get(u16b age)
-{
-	message_t *m = messages->head;
-
-	while (m && age--)
-		m = m->older;
+	m = &messages->ring[messages->head];
+	m->text = at;
+	m->type = type;
+	m->count = 1;
 
-	return m;
+	messages->head = (messages->head + 1) % MESSAGE_MAX;
+	messages->count++;
 }
 
 
 const char *message_str(u16b age)
 {
 	message_t *m = message_get(age);
-	return (m ? m->str : "");
+	return (m ? messages->text + m->text : "");
 }
 
 u16b message_count(u16b age)
@@ -162,47 +173,59 @@ byte message_color(u16b age)
 
 /* Message-color functions */
 
+/*
+ * The colours of the MSG_* types are in msgqueue_t.type_colors; any others
+ * the pref files mention go in the msgcolor_t list.  A colour of TERM_DARK,
+ * including one never set, means the default.
+ */
 void message_color_define(u16b type, byte color)
 {
 	msgcolor_t *mc;
 
-	if (!messages->colors)
+	if (type < MSG_MAX)
 	{
-		messages->colors = ZNEW(msgcolor_t);
-		messages->colors->type = type;
-		messages->colors->color = color;
+		messages->type_colors[type] = color;
+		return;
 	}
 
-	mc = messages->colors;
-	while (mc->next)
+	for (mc = messages->colors; mc; mc = mc->next)
 	{
 		if (mc->type == type)
 		{
 			mc->color = color;
+			return;
 		}
-		mc = mc->next;
 	}
 
-	mc->next = ZNEW(msgcolor_t);
-	mc->next->type = type;
-	mc->next->color = color;
+	mc = mem_zalloc_tagged(sizeof(msgcolor_t), MEM_TAG_MSG);
+	mc->type = type;
+	mc->color = color;
+	mc->next = messages->colors;
+	messages->colors = mc;
 }
 
 byte message_type_color(u16b type)
 {
 	msgcolor_t *mc;
-	byte color = TERM_WHITE;
-
-	if (messages)
-	{
-		mc = messages->colors;
+	byte color = TERM_DARK;
 
-		while (mc && mc->type != type)
-			mc = mc->next;
+	if (!messages) return TERM_WHITE;
 
-		if (mc && (mc->color != TERM_DARK))
-			color = mc->color;
+	if (type < MSG_MAX)
+	{
+		color = messages->type_colors[type];
+	}
+	else
+	{
+		for (mc = messages->colors; mc; mc = mc->next)
+		{
+			if (mc->type == type)
+			{
+				color = mc->color;
+				break;
+			}
+		}
 	}
 
-	return color;
+	return (color == TERM_DARK) ? TERM_WHITE : color;
 }
@@ -5,6 +5,15 @@
 
 /*** Constants ***/
 
+/* Messages kept, and bytes of text for them (see z-msg.c) */
+#ifdef LOW_MEMORY
+# define MESSAGE_MAX		256
+# define MESSAGE_TEXT	8192
+#else
+# define MESSAGE_MAX		2048
+# define MESSAGE_TEXT	65536
+#endif
+
 
 /*** Message constants ***/
 
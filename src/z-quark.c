@@ -24,17 +24,62 @@ static char **quarks;
 static size_t nr_quarks = 1;
 static size_t alloc_quarks = 0;
 
+/*
+ * Quarks are found from their strings through an open-addressed hash of
+ * quark numbers (zero marking an empty slot), kept at most half full.  The
+ * numbers themselves are still handed out in order, as savefiles need.
+ */
+static quark_t *quark_hash;
+static size_t quark_hash_size = 0;
+
 #define QUARKS_INIT	16
 
-quark_t quark_add(const char *str)
+static u32b quark_hash_str(const char *str)
+{
+	/* FNV-1a */
+	u32b hash = 2166136261UL;
+
+	while (*str)
+		hash = (hash ^ (unsigned char)*str++) * 16777619UL;
+
+	return hash;
+}
+
+/*
+ * Find the slot for "str", which is either empty or holds its quark
+ */
+static size_t quark_slot(const char *str)
+{
+	size_t i = quark_hash_str(str) & (quark_hash_size - 1);
+
+	while (quark_hash[i] && strcmp(quarks[quark_hash[i]], str))
+		i = (i + 1) & (quark_hash_size - 1);
+
+	return i;
+}
+
+/*
+ * Make the hash twice the size, and put all the quarks back in it
+ */
+static void quark_rehash(void)
 {
 	quark_t q;
 
+	FREE(quark_hash);
+	quark_hash_size *= 2;
+	quark_hash = C_ZNEW(quark_hash_size, quark_t);
+
 	for (q = 1; q < nr_quarks; q++)
-	{
-		if (!strcmp(quarks[q], str))
-			return q;
-	}
+		quark_hash[quark_slot(quarks[q])] = q;
+}
+
+quark_t quark_add(const char *str)
+{
+	quark_t q;
+	size_t i = quark_slot(str);
+
+	if (quark_hash[i])
+		return quark_hash[i];
 
 	if (nr_quarks == alloc_quarks)
 	{
@@ -44,6 +89,10 @@ quark_t quark_add(const char *str)
 	
 	q = nr_quarks++;
 	quarks[q] = string_make(str);
+	quark_hash[i] = q;
+
+	if (2 * nr_quarks > quark_hash_size)
+		quark_rehash();
 
 	return q;
 }
@@ -58,6 +107,9 @@ errr quarks_init(void)
 	alloc_quarks = QUARKS_INIT;
 	quarks = C_ZNEW(alloc_quarks, char *);
 
+	quark_hash_size = 2 * QUARKS_INIT;
+	quark_hash = C_ZNEW(quark_hash_size, quark_t);
+
 	return 0;
 }
 
@@ -69,5 +121,10 @@ errr quarks_free(void)
 		string_free(quarks[i]);
 
 	FREE(quarks);
+	nr_quarks = 1;
+	alloc_quarks = 0;
+
+	FREE(quark_hash);
+	quark_hash_size = 0;
 	return 0;
 }
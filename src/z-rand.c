@@ -55,22 +55,33 @@ u32b STATE[RAND_DEG] = {0, 0, 0, 0, 0, 0, 0, 0,
 						0, 0, 0, 0, 0, 0, 0, 0};
 u32b z0, z1, z2;
 
-#define V0    STATE[state_i]
-#define VM1   STATE[(state_i + M1) & 0x0000001fU]
-#define VM2   STATE[(state_i + M2) & 0x0000001fU]
-#define VM3   STATE[(state_i + M3) & 0x0000001fU]
-#define VRm1  STATE[(state_i + 31) & 0x0000001fU]
-#define newV0 STATE[(state_i + 31) & 0x0000001fU]
-#define newV1 STATE[state_i]
+#define V0    s[i]
+#define VM1   s[(i + M1) & 0x0000001fU]
+#define VM2   s[(i + M2) & 0x0000001fU]
+#define VM3   s[(i + M3) & 0x0000001fU]
+#define VRm1  s[(i + 31) & 0x0000001fU]
+#define newV0 s[(i + 31) & 0x0000001fU]
+#define newV1 s[i]
+
+/*
+ * Advance the WELL state "s", at index "*pi", by one step.  This is
+ * shared by the game's own RNG and by RNG streams.
+ */
+static u32b WELL_step(u32b *s, u32b *pi) {
+	u32b i = *pi;
+	u32b t0, t1, t2;
+
+	t0      = VRm1;
+	t1      = Identity(V0) ^ MAT0POS (8, VM1);
+	t2      = MAT0NEG (-19, VM2) ^ MAT0NEG(-14,VM3);
+	newV1   = t1 ^ t2; 
+	newV0   = MAT0NEG (-11,t0) ^ MAT0NEG(-7,t1) ^ MAT0NEG(-13,t2);
+	*pi = (i + 31) & 0x0000001fU;
+	return s[*pi];
+}
 
 u32b WELLRNG1024a (void){
-	z0      = VRm1;
-	z1      = Identity(V0) ^ MAT0POS (8, VM1);
-	z2      = MAT0NEG (-19, VM2) ^ MAT0NEG(-14,VM3);
-	newV1   = z1 ^ z2; 
-	newV0   = MAT0NEG (-11,z0) ^ MAT0NEG(-7,z1) ^ MAT0NEG(-13,z2);
-	state_i = (state_i + 31) & 0x0000001fU;
-	return STATE[state_i];
+	return WELL_step(STATE, &state_i);
 }
 /* end WELL RNG */
 
@@ -91,30 +102,163 @@ bool Rand_quick = TRUE;
 u32b Rand_value;
 
 
-/**
- * Initialize the complex RNG using a new seed.
+/*
+ * Seed the WELL state "s", and its index "*pi", from "seed".
  */
-void Rand_state_init(u32b seed) {
+static void WELL_seed(u32b *s, u32b *pi, u32b seed) {
 	int i, j;
 
+	/* Start at the top of the table, so the seed alone decides the state */
+	*pi = 0;
+
 	/* Seed the table */
-	STATE[0] = seed;
+	s[0] = seed;
 
 	/* Propagate the seed */
 	for (i = 1; i < RAND_DEG; i++)
-		STATE[i] = LCRNG(STATE[i - 1]);
+		s[i] = LCRNG(s[i - 1]);
 
 	/* Cycle the table ten times per degree */
 	for (i = 0; i < RAND_DEG * 10; i++) {
 		/* Acquire the next index */
-		j = (state_i + 1) % RAND_DEG;
+		j = (*pi + 1) % RAND_DEG;
 
 		/* Update the table, extract an entry */
-		STATE[j] += STATE[state_i];
+		s[j] += s[*pi];
 
 		/* Advance the index */
-		state_i = j;
+		*pi = j;
+	}
+}
+
+
+/**
+ * Initialize the complex RNG using a new seed.
+ */
+void Rand_state_init(u32b seed) {
+	WELL_seed(STATE, &state_i, seed);
+}
+
+
+/**
+ * Initialize an RNG stream using a new seed.
+ */
+void Rand_stream_init(rand_stream *rs, u32b seed) {
+	WELL_seed(rs->state, &rs->i, seed);
+}
+
+
+/**
+ * Get the next 32 random bits from stream "rs".
+ */
+u32b Rand_stream_next(rand_stream *rs) {
+	return WELL_step(rs->state, &rs->i);
+}
+
+
+/*
+ * Pick the state the batch functions below draw from: stream "rs", or the
+ * game's complex RNG if "rs" is NULL.
+ */
+static rand_stream *Rand_batch_start(rand_stream *rs, rand_stream *game) {
+	if (rs) return rs;
+
+	memcpy(game->state, STATE, sizeof(game->state));
+	game->i = state_i;
+	return game;
+}
+
+/*
+ * Hand the state back to the game's complex RNG, if it came from there.
+ */
+static void Rand_batch_end(rand_stream *rs, rand_stream *game) {
+	if (rs != game) return;
+
+	memcpy(STATE, game->state, sizeof(game->state));
+	state_i = game->i;
+}
+
+/*
+ * Generate a random number X where "0 <= X < m", using Lemire's method: the
+ * top half of a 64-bit product, with the few biased products rejected.
+ * This needs one multiplication and, almost always, no division.
+ */
+static u32b Rand_lemire(u32b *s, u32b *pi, u32b m) {
+	u64b x = (u64b)WELL_step(s, pi) * m;
+	u32b l = (u32b)x;
+
+	if (l < m) {
+		u32b t = (0U - m) % m;
+
+		while (l < t) {
+			x = (u64b)WELL_step(s, pi) * m;
+			l = (u32b)x;
+		}
+	}
+
+	return (u32b)(x >> 32);
+}
+
+
+/**
+ * Fill "buf" with "n" random 32-bit numbers from stream "rs", or from the
+ * game's complex RNG if "rs" is NULL.
+ */
+void Rand_fill(rand_stream *rs, u32b *buf, size_t n) {
+	rand_stream game;
+	size_t k;
+
+	rs = Rand_batch_start(rs, &game);
+	for (k = 0; k < n; k++)
+		buf[k] = WELL_step(rs->state, &rs->i);
+	Rand_batch_end(rs, &game);
+}
+
+
+/**
+ * Fill "buf" with "n" random numbers X, where "0 <= X < m", from stream
+ * "rs", or from the game's complex RNG if "rs" is NULL.  The numbers are
+ * uniform, as from Rand_div(), but not the same ones Rand_div() would give.
+ */
+void Rand_fill_div(rand_stream *rs, u32b *buf, size_t n, u32b m) {
+	rand_stream game;
+	size_t k;
+
+	if (m <= 1) {
+		for (k = 0; k < n; k++) buf[k] = 0;
+		return;
+	}
+
+	rs = Rand_batch_start(rs, &game);
+	for (k = 0; k < n; k++)
+		buf[k] = Rand_lemire(rs->state, &rs->i, m);
+	Rand_batch_end(rs, &game);
+}
+
+
+/**
+ * Fill "buf" with "n" rolls of "num"d"sides", from stream "rs", or from the
+ * game's complex RNG if "rs" is NULL.
+ */
+void damroll_fill(rand_stream *rs, int *buf, size_t n, int num, int sides) {
+	rand_stream game;
+	size_t k;
+	int i;
+
+	if (sides <= 0) {
+		for (k = 0; k < n; k++) buf[k] = 0;
+		return;
 	}
+
+	rs = Rand_batch_start(rs, &game);
+	for (k = 0; k < n; k++) {
+		int sum = num;
+
+		for (i = 0; i < num; i++)
+			sum += (int)Rand_lemire(rs->state, &rs->i, (u32b)sides);
+		buf[k] = sum;
+	}
+	Rand_batch_end(rs, &game);
 }
 
 
@@ -225,6 +369,75 @@ static s16b Rand_normal_table[RANDNOR_NUM] = {
 };
 
 
+/**
+ * The number of "buckets" the normal table is split into for lookups; each
+ * covers (32768 / RANDNOR_BUCKETS) of the probabilities in the table
+ */
+#define RANDNOR_BUCKETS	256
+
+/**
+ * The first entry of the normal table that any probability in each bucket
+ * can land on; no probability in a bucket can land past the first entry of
+ * the next one.  Most buckets hold one or two entries, and none more than
+ * seventy, out in the tail.
+ */
+static const byte Rand_normal_bucket[RANDNOR_BUCKETS + 1] = {
+	0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 5,
+	5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 8, 9, 9, 9, 10,
+	10, 10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15,
+	15, 16, 16, 16, 16, 17, 17, 17, 18, 18, 18, 19, 19, 19, 20, 20,
+	20, 21, 21, 21, 22, 22, 22, 23, 23, 23, 24, 24, 24, 25, 25, 25,
+	26, 26, 26, 27, 27, 27, 28, 28, 28, 29, 29, 30, 30, 30, 31, 31,
+	31, 32, 32, 32, 33, 33, 33, 34, 34, 34, 35, 35, 36, 36, 36, 37,
+	37, 37, 38, 38, 39, 39, 39, 40, 40, 40, 41, 41, 42, 42, 42, 43,
+	43, 44, 44, 44, 45, 45, 46, 46, 46, 47, 47, 48, 48, 48, 49, 49,
+	50, 50, 51, 51, 51, 52, 52, 53, 53, 54, 54, 54, 55, 55, 56, 56,
+	57, 57, 58, 58, 59, 59, 60, 60, 61, 61, 62, 62, 63, 63, 64, 64,
+	65, 65, 66, 66, 67, 67, 68, 68, 69, 70, 70, 71, 71, 72, 72, 73,
+	74, 74, 75, 75, 76, 77, 77, 78, 79, 79, 80, 81, 81, 82, 83, 84,
+	84, 85, 86, 87, 87, 88, 89, 90, 91, 92, 92, 93, 94, 95, 96, 97,
+	98, 99, 100, 101, 102, 104, 105, 106, 107, 109, 110, 111, 113, 114, 116, 117,
+	119, 121, 123, 125, 127, 130, 132, 135, 138, 141, 145, 149, 155, 161, 170, 185,
+	255,
+};
+
+
+/**
+ * Find the first entry of the normal table that is at least "tmp", where
+ * "0 <= tmp < 32768".
+ *
+ * With "bucketed" the search starts from the bucket "tmp" falls in, which
+ * usually settles it at once, and never takes more than seven steps; without,
+ * it is a plain binary search over the whole table, which always takes
+ * eight.  Both give the same answer.
+ */
+int Rand_normal_index(int tmp, bool bucketed) {
+	int low = 0;
+	int high = RANDNOR_NUM;
+
+	if (bucketed) {
+		int b = tmp / (32768 / RANDNOR_BUCKETS);
+
+		low = Rand_normal_bucket[b];
+		high = Rand_normal_bucket[b + 1];
+	}
+
+	/* Binary Search */
+	while (low < high) {
+		int mid = (low + high) >> 1;
+
+		/* Move right if forced */
+		if (Rand_normal_table[mid] < tmp) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+
 /**
  * Generate a random integer number of NORMAL distribution
  *
@@ -242,14 +455,12 @@ static s16b Rand_normal_table[RANDNOR_NUM] = {
  * standard deviations away from the mean.  This results in "conservative"
  * distribution of approximately 1/32768 values.
  *
- * Note that the binary search takes up to 16 quick iterations.
+ * The table is searched through its buckets, unless the game is built with
+ * RAND_NORMAL_BSEARCH, for comparison; see Rand_normal_index().
  */
 s16b Rand_normal(int mean, int stand) {
 	s16b tmp, offset;
-
-	// foo
-	s16b low = 0;
-	s16b high = RANDNOR_NUM;
+	int low;
 
 	/* Paranoia */
 	if (stand < 1) return (mean);
@@ -257,17 +468,11 @@ s16b Rand_normal(int mean, int stand) {
 	/* Roll for probability */
 	tmp = (s16b)randint0(32768);
 
-	/* Binary Search */
-	while (low < high) {
-		int mid = (low + high) >> 1;
-
-		/* Move right if forced */
-		if (Rand_normal_table[mid] < tmp) {
-			low = mid + 1;
-		} else {
-			high = mid;
-		}
-	}
+#ifdef RAND_NORMAL_BSEARCH
+	low = Rand_normal_index(tmp, FALSE);
+#else
+	low = Rand_normal_index(tmp, TRUE);
+#endif
 
 	/* Convert the index into an offset */
 	offset = (long)stand * (long)low / RANDNOR_STD;
@@ -428,16 +633,38 @@ s16b m_bonus_calc(int max, int level, aspect bonus_aspect) {
  * Calculation helper function for random_value structs
  */
 int randcalc(random_value v, int level, aspect rand_aspect) {
-	if (rand_aspect == EXTREMIFY) {
-		int min = randcalc(v, level, MINIMISE);
-		int max = randcalc(v, level, MAXIMISE);
-		return abs(min) > abs(max) ? min : max;
+	switch (rand_aspect) {
+		case RANDOMISE: return randcalc_random(v, level);
 
-	} else {
-		int dmg   = damcalc(v.dice, v.sides, rand_aspect);
-		int bonus = m_bonus_calc(v.m_bonus, level, rand_aspect);
-		return v.base + dmg + bonus;
+		case MINIMISE:  return randcalc_min(v);
+
+		case MAXIMISE:  return randcalc_max(v);
+
+		case AVERAGE:   return randcalc_average(v, level);
+
+		case EXTREMIFY: {
+			int min = randcalc_min(v);
+			int max = randcalc_max(v);
+			return abs(min) > abs(max) ? min : max;
+		}
 	}
+
+	return 0;
+}
+
+
+/**
+ * randcalc() for RANDOMISE.  Most random_values have no dice, which then
+ * take nothing from the RNG, but the bonus is always rolled: m_bonus(0, ...)
+ * takes numbers from the RNG like any other, and every roll after it
+ * depends on that.
+ */
+int randcalc_random(random_value v, int level) {
+	int value = v.base;
+
+	if (v.dice) value += damroll(v.dice, v.sides);
+
+	return value + m_bonus(v.m_bonus, level);
 }
 
 
@@ -445,9 +672,9 @@ int randcalc(random_value v, int level, aspect rand_aspect) {
  * Test to see if a value is within a random_value's range
  */
 bool randcalc_valid(random_value v, int test) {
-	if (test < randcalc(v, 0, MINIMISE))
+	if (test < randcalc_min(v))
 		return FALSE;
-	else if (test > randcalc(v, 0, MAXIMISE))
+	else if (test > randcalc_max(v))
 		return FALSE;
 	else
 		return TRUE;
@@ -457,5 +684,5 @@ bool randcalc_valid(random_value v, int test) {
  * Test to see if a random_value actually varies
  */
 bool randcalc_varies(random_value v) {
-	return randcalc(v, 0, MINIMISE) != randcalc(v, 0, MAXIMISE);
+	return randcalc_min(v) != randcalc_max(v);
 }
@@ -22,6 +22,15 @@ typedef struct random {
  */
 #define RAND_DEG 32
 
+/**
+ * An RNG stream: the state of a complex RNG of its own, independent of the
+ * game's, so that (say) parallel workers needn't share one.
+ */
+typedef struct rand_stream {
+	u32b i;
+	u32b state[RAND_DEG];
+} rand_stream;
+
 /* Random aspects used by damcalc, m_bonus_calc, and ranvals */
 typedef enum {
 	MINIMISE,
@@ -85,6 +94,30 @@ extern u32b z2;
  */
 void Rand_state_init(u32b seed);
 
+/**
+ * Initialise an RNG stream with the given seed.
+ */
+void Rand_stream_init(rand_stream *rs, u32b seed);
+
+/**
+ * Get the next 32 random bits from an RNG stream.
+ */
+u32b Rand_stream_next(rand_stream *rs);
+
+/**
+ * Fill a buffer with random 32-bit integers from an RNG stream, or from the
+ * game's complex RNG if the stream is NULL.
+ */
+void Rand_fill(rand_stream *rs, u32b *buf, size_t n);
+
+/**
+ * Fill a buffer with random integers X where "0 <= X < M" holds, from an
+ * RNG stream, or from the game's complex RNG if the stream is NULL.
+ *
+ * The integers fall along a uniform distribution.
+ */
+void Rand_fill_div(rand_stream *rs, u32b *buf, size_t n, u32b m);
+
 /**
  * Generates a random unsigned long integer X where "0 <= X < M" holds.
  *
@@ -98,6 +131,12 @@ u32b Rand_div(u32b m);
  */
 s16b Rand_normal(int mean, int stand);
 
+/**
+ * Find the entry of the normal distribution table for probability `tmp`,
+ * where "0 <= tmp < 32768", searching from the table's buckets or not.
+ */
+int Rand_normal_index(int tmp, bool bucketed);
+
 /**
  * Generate a semi-random number from 0 to m-1, in a way that doesn't affect
  * gameplay.  This is intended for use by external program parts like the
@@ -110,6 +149,12 @@ u32b Rand_simple(u32b m);
  */
 int damroll(int num, int sides);
 
+/**
+ * Fill a buffer with dice rolls of `num` dice with `sides` sides, from an
+ * RNG stream, or from the game's complex RNG if the stream is NULL.
+ */
+void damroll_fill(rand_stream *rs, int *buf, size_t n, int num, int sides);
+
 /**
  * Calculation helper function for damroll
  */
@@ -139,6 +184,22 @@ s16b m_bonus_calc(int max, int level, aspect bonus_aspect);
  */
 int randcalc(random_value v, int level, aspect rand_aspect);
 
+/**
+ * randcalc() for RANDOMISE, MINIMISE, MAXIMISE and AVERAGE, for callers
+ * who know which they want.  The macros evaluate `v` more than once.
+ */
+int randcalc_random(random_value v, int level);
+
+#define randcalc_min(v) \
+	((v).base + (v).dice)
+
+#define randcalc_max(v) \
+	((v).base + (v).dice * (v).sides + (v).m_bonus)
+
+#define randcalc_average(v, level) \
+	((v).base + (v).dice * ((v).sides + 1) / 2 + \
+	 (v).m_bonus * (level) / MAX_DEPTH)
+
 /**
  * Test to see if a value is within a random_value's range.
  */
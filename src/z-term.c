@@ -355,31 +355,16 @@ static errr term_win_init(term_win *s, int w, int h)
  */
 static errr term_win_copy(term_win *s, term_win *f, int w, int h)
 {
-	int x, y;
+	int y;
 
 	/* Copy contents */
 	for (y = 0; y < h; y++)
 	{
-		byte *f_aa = f->a[y];
-		char *f_cc = f->c[y];
-
-		byte *s_aa = s->a[y];
-		char *s_cc = s->c[y];
+		memcpy(s->a[y], f->a[y], w);
+		memcpy(s->c[y], f->c[y], w);
 
-		byte *f_taa = f->ta[y];
-		char *f_tcc = f->tc[y];
-
-		byte *s_taa = s->ta[y];
-		char *s_tcc = s->tc[y];
-
-		for (x = 0; x < w; x++)
-		{
-			*s_aa++ = *f_aa++;
-			*s_cc++ = *f_cc++;
-
-			*s_taa++ = *f_taa++;
-			*s_tcc++ = *f_tcc++;
-		}
+		memcpy(s->ta[y], f->ta[y], w);
+		memcpy(s->tc[y], f->tc[y], w);
 	}
 
 	/* Copy cursor */
@@ -393,6 +378,23 @@ static errr term_win_copy(term_win *s, term_win *f, int w, int h)
 }
 
 
+/*
+ * Free the windows kept for reuse by "Term_save()"
+ */
+static void term_pool_nuke(term *t)
+{
+	while (t->pool)
+	{
+		term_win *s = t->pool;
+
+		t->pool = s->next;
+
+		term_win_nuke(s);
+		FREE(s);
+	}
+}
+
+
 
 /*** External hooks ***/
 
@@ -417,12 +419,27 @@ errr Term_xtra(int n, int v)
 	/* Verify the hook */
 	if (!Term->xtra_hook) return (-1);
 
+	/* The journal may stand in for the port */
+	if (Term_xtra_journal && (*Term_xtra_journal)(n, v)) return (0);
+
 	/* Call the hook */
 	return ((*Term->xtra_hook)(n, v));
 }
 
 
 
+/*
+ * Hooks for a journal of the input the port gives the game, which can be
+ * played back later (see journal.c).  Term_xtra_journal() is called before
+ * the port's own hook for every Term_xtra(), and handles the action itself
+ * if it returns TRUE; Term_key_journal() is told of every key or mouse
+ * press the port adds to the queue.
+ */
+bool (*Term_xtra_journal)(int n, int v);
+void (*Term_key_journal)(const ui_event_data *ke);
+
+
+
 /*** Fake hooks ***/
 
 
@@ -534,7 +551,7 @@ void Term_big_queue_char(term *t, int x, int y, byte a, char c, byte a1, char c1
 	if (tile_width > 1)
 	{
 	        /* Horizontal first */
-	        for (hor = 0; hor <= tile_width; hor++)
+	        for (hor = 0; hor < tile_width; hor++)
 		{
 		        /* Queue dummy character */
 		        if (hor != 0)
@@ -546,7 +563,7 @@ void Term_big_queue_char(term *t, int x, int y, byte a, char c, byte a1, char c1
 			}
 
 			/* Now vertical */
-			for (vert = 1; vert <= tile_height; vert++)
+			for (vert = 1; vert < tile_height; vert++)
 			{
 			        /* Queue dummy character */
 			        if (a & 0x80)
@@ -559,7 +576,7 @@ void Term_big_queue_char(term *t, int x, int y, byte a, char c, byte a1, char c1
 	else
 	{
 	        /* Only vertical */
-	        for (vert = 1; vert <= tile_height; vert++)
+	        for (vert = 1; vert < tile_height; vert++)
 		{
 		        /* Queue dummy character */
 		        if (a & 0x80)
@@ -630,6 +647,97 @@ void Term_queue_chars(int x, int y, int n, byte a, cptr s)
 /*** Refresh routines ***/
 
 
+/*
+ * Narrow the "modified" columns "x1" to "x2" of row "y" to those which
+ * really differ from what is on the screen, and return FALSE if none do.
+ *
+ * A grid can be marked as modified without ending up any different, for
+ * example when a row is erased and then printed again with the same text,
+ * so this saves sending anything at all for most such rows.
+ */
+static bool Term_fresh_span(int y, int *x1, int *x2)
+{
+	byte *old_aa = Term->old->a[y];
+	char *old_cc = Term->old->c[y];
+	byte *old_taa = Term->old->ta[y];
+	char *old_tcc = Term->old->tc[y];
+
+	byte *scr_aa = Term->scr->a[y];
+	char *scr_cc = Term->scr->c[y];
+	byte *scr_taa = Term->scr->ta[y];
+	char *scr_tcc = Term->scr->tc[y];
+
+	int l = *x1;
+	int r = *x2;
+
+	/* Skip unchanged grids at the start */
+	while ((l <= r) &&
+	       (old_aa[l] == scr_aa[l]) && (old_cc[l] == scr_cc[l]) &&
+	       (old_taa[l] == scr_taa[l]) && (old_tcc[l] == scr_tcc[l]))
+		l++;
+
+	/* Nothing really changed */
+	if (l > r) return (FALSE);
+
+	/* Skip unchanged grids at the end */
+	while ((old_aa[r] == scr_aa[r]) && (old_cc[r] == scr_cc[r]) &&
+	       (old_taa[r] == scr_taa[r]) && (old_tcc[r] == scr_tcc[r]))
+		r--;
+
+	*x1 = l;
+	*x2 = r;
+
+	return (TRUE);
+}
+
+
+/*
+ * Add the grids "x1" to "x2" of row "y" which differ from what is on the
+ * screen to "Term->cells", starting at index "n", and mark them as drawn.
+ * Return the new number of grids.
+ */
+static int Term_fresh_row_cells(int y, int x1, int x2, int n)
+{
+	int x;
+
+	byte *old_aa = Term->old->a[y];
+	char *old_cc = Term->old->c[y];
+	byte *old_taa = Term->old->ta[y];
+	char *old_tcc = Term->old->tc[y];
+
+	byte *scr_aa = Term->scr->a[y];
+	char *scr_cc = Term->scr->c[y];
+	byte *scr_taa = Term->scr->ta[y];
+	char *scr_tcc = Term->scr->tc[y];
+
+	for (x = x1; x <= x2; x++)
+	{
+		term_cell *cell;
+
+		/* Handle unchanged grids */
+		if ((old_aa[x] == scr_aa[x]) && (old_cc[x] == scr_cc[x]) &&
+		    (old_taa[x] == scr_taa[x]) && (old_tcc[x] == scr_tcc[x]))
+			continue;
+
+		/* Save new contents */
+		old_aa[x] = scr_aa[x];
+		old_cc[x] = scr_cc[x];
+		old_taa[x] = scr_taa[x];
+		old_tcc[x] = scr_tcc[x];
+
+		cell = &Term->cells[n++];
+		cell->x = x;
+		cell->y = y;
+		cell->a = scr_aa[x];
+		cell->c = scr_cc[x];
+		cell->ta = scr_taa[x];
+		cell->tc = scr_tcc[x];
+	}
+
+	return (n);
+}
+
+
 /*
  * Flush a row of the current window (see "Term_fresh")
  *
@@ -1095,6 +1203,14 @@ bool smlcurs = TRUE;
  * high-bit set) to be sent (one pair at a time) to the "Term->pict_hook"
  * hook, which can draw these pairs in whatever way it would like.
  *
+ * If the "Term->batch_hook" hook is set, then none of the above is used.
+ * Instead every grid that has changed since the last refresh, in any row,
+ * is collected (in row order, then column order) and the whole list is
+ * sent to the hook in a single call.  This suits front ends which can
+ * draw a whole frame faster than they can draw it in pieces.  The hook
+ * must then draw "black" grids and the "special" attr/char pairs itself,
+ * and "TERM_XTRA_FROSH" is not used.
+ *
  * Normally, the "Term_wipe()" function is used only to display "blanks"
  * that were induced by "Term_clear()" or "Term_erase()", and then only
  * if the "attr_blank" and "char_blank" fields have not been redefined
@@ -1140,6 +1256,7 @@ bool smlcurs = TRUE;
 errr Term_fresh(void)
 {
 	int x, y;
+	int n = 0;
 
 	int w = Term->wid;
 	int h = Term->hgt;
@@ -1303,6 +1420,10 @@ errr Term_fresh(void)
 		}
 
 
+		/* Gather every change for the "batch" hook */
+		if (Term->batch_hook && !Term->cells)
+			Term->cells = C_ZNEW(w * h, term_cell);
+
 		/* Scan the "modified" rows */
 		for (y = y1; y <= y2; ++y)
 		{
@@ -1312,6 +1433,20 @@ errr Term_fresh(void)
 			/* Flush each "modified" row */
 			if (x1 <= x2)
 			{
+				/* This row is all done */
+				Term->x1[y] = w;
+				Term->x2[y] = 0;
+
+				/* Ignore grids that ended up as they were */
+				if (!Term_fresh_span(y, &x1, &x2)) continue;
+
+				/* Draw the row along with all the others */
+				if (Term->batch_hook)
+				{
+					n = Term_fresh_row_cells(y, x1, x2, n);
+					continue;
+				}
+
 				/* Always use "Term_pict()" */
 				if (Term->always_pict)
 				{
@@ -1333,15 +1468,14 @@ errr Term_fresh(void)
 					Term_fresh_row_text(y, x1, x2);
 				}
 
-				/* This row is all done */
-				Term->x1[y] = w;
-				Term->x2[y] = 0;
-
 				/* Hack -- Flush that row (if allowed) */
 				if (!Term->never_frosh) Term_xtra(TERM_XTRA_FROSH, y);
 			}
 		}
 
+		/* Draw all the changes */
+		if (n) (void)((*Term->batch_hook)(n, Term->cells));
+
 		/* No rows are invalid */
 		Term->y1 = h;
 		Term->y2 = 0;
@@ -1627,7 +1761,7 @@ void Term_big_putch(int x, int y, byte a, char c)
 	if (tile_width > 1)
 	{
 	        /* Horizontal first */
-	        for (hor = 0; hor <= tile_width; hor++)
+	        for (hor = 0; hor < tile_width; hor++)
 		{
 		        /* Queue dummy character */
 		        if (hor != 0)
@@ -1639,7 +1773,7 @@ void Term_big_putch(int x, int y, byte a, char c)
 			}
 
 			/* Now vertical */
-			for (vert = 1; vert <= tile_height; vert++)
+			for (vert = 1; vert < tile_height; vert++)
 			{
 			        /* Queue dummy character */
 			        if (a & 0x80)
@@ -1652,7 +1786,7 @@ void Term_big_putch(int x, int y, byte a, char c)
 	else
 	{
 	        /* Only vertical */
-	        for (vert = 1; vert <= tile_height; vert++)
+	        for (vert = 1; vert < tile_height; vert++)
 		{
 		        /* Queue dummy character */
 		        if (a & 0x80)
@@ -1962,6 +2096,11 @@ errr Term_what(int x, int y, byte *a, char *c)
 
 /*** Input routines ***/
 
+/*
+ * The most events the input queue grows to hold
+ */
+#define KEY_QUEUE_MAX	4096
+
 
 /*
  * Flush and forget the input
@@ -1979,56 +2118,126 @@ errr Term_flush(void)
 }
 
 
+/*
+ * The number of events waiting in the "queue"
+ */
+static int Term_key_count(void)
+{
+	return (Term->key_head + Term->key_size - Term->key_tail) % Term->key_size;
+}
+
+/*
+ * Make room in the "queue" for one more event.
+ *
+ * One slot is always left empty, so that a full queue can't be taken for an
+ * empty one; when that's all that is left the queue doubles in size.  Once
+ * it holds KEY_QUEUE_MAX events, the oldest is forgotten instead.
+ */
+static void Term_key_room(void)
+{
+	int n = Term_key_count();
+	int i;
+	ui_event_data *queue;
+
+	if (n + 1 < Term->key_size) return;
+
+	/* Hack -- Forget the oldest key */
+	if (2 * Term->key_size > KEY_QUEUE_MAX)
+	{
+		if (++Term->key_tail == Term->key_size) Term->key_tail = 0;
+		return;
+	}
+
+	/* Unwrap the queue into a bigger one */
+	queue = C_ZNEW(2 * Term->key_size, ui_event_data);
+	for (i = 0; i < n; i++)
+		queue[i] = Term->key_queue[(Term->key_tail + i) % Term->key_size];
+
+	FREE(Term->key_queue);
+	Term->key_queue = queue;
+	Term->key_size *= 2;
+	Term->key_tail = 0;
+	Term->key_head = n;
+}
+
+/*
+ * Add an event to the end of the "queue"
+ */
+static void Term_key_add(const ui_event_data *ke)
+{
+	if (Term_key_journal) (*Term_key_journal)(ke);
+
+	Term_key_room();
+
+	Term->key_queue[Term->key_head] = *ke;
+
+	/* Circular queue, handle wrap */
+	if (++Term->key_head == Term->key_size) Term->key_head = 0;
+}
+
 /*
  * Add a keypress to the "queue"
  */
 errr Term_keypress(int k)
 {
-  /* Hack -- Refuse to enqueue non-keys */
-  if (!k) return (-1);
-  
-  /* Store the char, advance the queue */
-  Term->key_queue[Term->key_head].key = k;
-  Term->key_queue[Term->key_head].index = 0;
-  Term->key_queue[Term->key_head].type = EVT_KBRD;
-  Term->key_head++;
-  
-  /* Circular queue, handle wrap */
-  if (Term->key_head == Term->key_size) Term->key_head = 0;
-  
-  /* Success (unless overflow) */
-  if (Term->key_head != Term->key_tail) return (0);
-  
-  /* Problem */
-  return (1);
+	ui_event_data ke;
+
+	/* Hack -- Refuse to enqueue non-keys */
+	if (!k) return (-1);
+
+	WIPE(&ke, ui_event_data);
+	ke.type = EVT_KBRD;
+	ke.key = k;
+
+	Term_key_add(&ke);
+
+	/* Success */
+	return (0);
 }
 
 /*
  * Add a mouse event to the "queue"
+ *
+ * A click just like the last one, which the game hasn't got to yet, adds
+ * nothing, so a port sending a burst of them only costs the game one.
  */
 errr Term_mousepress(int x, int y, char button)
 {
-  /* Store the char, advance the queue */
-  Term->key_queue[Term->key_head].key = 0;
-  Term->key_queue[Term->key_head].mousex = x;
-  Term->key_queue[Term->key_head].mousey = y;
-  Term->key_queue[Term->key_head].index = button;
-  Term->key_queue[Term->key_head].type = EVT_MOUSE;
-  Term->key_head++;
-  
-  /* Circular queue, handle wrap */
-  if (Term->key_head == Term->key_size) Term->key_head = 0;
-  
-  /* Success (unless overflow) */
-  if (Term->key_head != Term->key_tail) return (0);
-  
-#if 0
-  /* Hack -- Forget the oldest key */
-  if (++Term->key_tail == Term->key_size) Term->key_tail = 0;
-#endif
-  
-  /* Problem */
-  return (1);
+	ui_event_data ke;
+
+	WIPE(&ke, ui_event_data);
+	ke.type = EVT_MOUSE;
+	ke.mousex = x;
+	ke.mousey = y;
+	ke.index = button;
+
+	if (Term->key_head != Term->key_tail)
+	{
+		int last = (Term->key_head + Term->key_size - 1) % Term->key_size;
+		const ui_event_data *l_ptr = &Term->key_queue[last];
+
+		if ((l_ptr->type == EVT_MOUSE) && (l_ptr->mousex == x) &&
+		    (l_ptr->mousey == y) && (l_ptr->index == button))
+		{
+			if (Term_key_journal) (*Term_key_journal)(&ke);
+			return (0);
+		}
+	}
+
+	Term_key_add(&ke);
+
+	/* Success */
+	return (0);
+}
+
+/*
+ * Whether the game has fallen behind the input: the "queue" has had to grow
+ * to hold what is waiting, which is then too old to act on if something
+ * happens.  See "disturb()".
+ */
+bool Term_key_behind(void)
+{
+	return (Term_key_count() >= Term->key_stale);
 }
 
 
@@ -2053,23 +2262,14 @@ errr Term_event_push(const ui_event_data *ke)
 	/* Hack -- Refuse to enqueue non-keys */
 	if (!ke) return (-1);
 
-	/* Hack -- Overflow may induce circular queue */
-	if (Term->key_tail == 0) Term->key_tail = Term->key_size;
+	Term_key_room();
 
-	/* Back up, Store the char */
-	/* Store the char, advance the queue */
+	/* Back up, handling wrap, and store the event */
+	if (Term->key_tail == 0) Term->key_tail = Term->key_size;
 	Term->key_queue[--Term->key_tail] = *ke;
 
-	/* Success (unless overflow) */
-	if (Term->key_head != Term->key_tail) return (0);
-
-#if 0
-	/* Hack -- Forget the oldest key */
-	if (++Term->key_tail == Term->key_size) Term->key_tail = 0;
-#endif
-
-	/* Problem */
-	return (1);
+	/* Success */
+	return (0);
 }
 
 
@@ -2149,11 +2349,22 @@ errr Term_save(void)
 
 	term_win *mem;
 
-	/* Allocate window */
-	mem = ZNEW(term_win);
+	/* Reuse a window from an earlier save */
+	if (Term->pool)
+	{
+		mem = Term->pool;
+		Term->pool = mem->next;
+	}
+
+	/* Or make a new one */
+	else
+	{
+		/* Allocate window */
+		mem = ZNEW(term_win);
 
-	/* Initialize window */
-	term_win_init(mem, w, h);
+		/* Initialize window */
+		term_win_init(mem, w, h);
+	}
 
 	/* Grab */
 	term_win_copy(mem, Term->scr, w, h);
@@ -2196,8 +2407,9 @@ errr Term_load(void)
 		/* Load */
 		term_win_copy(Term->scr, tmp, w, h);
 
-		/* Free the old window */
-		(void)term_win_nuke(tmp);
+		/* Keep the old window for the next save */
+		tmp->next = Term->pool;
+		Term->pool = tmp;
 	}
 
 	/* Assume change */
@@ -2270,6 +2482,9 @@ errr Term_resize(int w, int h)
 	/* Save old window */
 	hold_mem = Term->mem;
 
+	/* Spare windows are the wrong size now */
+	term_pool_nuke(Term);
+
 	/* Save old window */
 	hold_tmp = Term->tmp;
 
@@ -2325,6 +2540,9 @@ errr Term_resize(int w, int h)
 	FREE(hold_x1);
 	FREE(hold_x2);
 
+	/* The "batch" space is made again at the new size */
+	FREE(Term->cells);
+
 	/* Nuke */
 	term_win_nuke(hold_old);
 
@@ -2494,9 +2712,13 @@ errr term_nuke(term *t)
 		FREE(t->tmp);
 	}
 
+	/* Nuke spare "memorized" */
+	term_pool_nuke(t);
+
 	/* Free some arrays */
 	FREE(t->x1);
 	FREE(t->x2);
+	FREE(t->cells);
 
 	/* Free the input queue */
 	FREE(t->key_queue);
@@ -2524,8 +2746,9 @@ errr term_init(term *t, int w, int h, int k)
 	/* Prepare the input queue */
 	t->key_head = t->key_tail = 0;
 
-	/* Determine the input queue size */
-	t->key_size = k;
+	/* Determine the input queue size, to start with */
+	t->key_size = MAX(k, 2);
+	t->key_stale = t->key_size;
 
 	/* Allocate the input queue */
 	t->key_queue = C_ZNEW(t->key_size, ui_event_data);
@@ -57,6 +57,23 @@ struct term_win
 };
 
 
+/*
+ * A grid changed by "Term_fresh()", as passed to the "batch" hook
+ */
+typedef struct term_cell term_cell;
+
+struct term_cell
+{
+	byte x, y;
+
+	byte a;
+	char c;
+
+	byte ta;
+	char tc;
+};
+
+
 /*
  * An actual "term" structure
  *
@@ -139,6 +156,7 @@ struct term_win
  *
  *	- Temporary screen image
  *	- Memorized screen image
+ *	- Spare screen images, for reuse by Term_save()
  *
  *
  *	- Hook for init-ing the term
@@ -155,6 +173,9 @@ struct term_win
  *	- Hook for drawing a string of chars using an attr
  *
  *	- Hook for drawing a sequence of special attr/char pairs
+ *
+ *	- Hook for drawing every grid changed by a refresh at once (optional)
+ *	- Space for the grids passed to it
  */
 
 typedef struct term term;
@@ -191,6 +212,7 @@ struct term
 	u16b key_tail;
 	u16b key_xtra;
 	u16b key_size;
+	u16b key_stale;
 
 	byte wid;
 	byte hgt;
@@ -210,6 +232,7 @@ struct term
 
 	term_win *tmp;
 	term_win *mem;
+	term_win *pool;
 
         /* Number of times saved */
         byte saved;
@@ -232,6 +255,9 @@ struct term
 	errr (*pict_hook)(int x, int y, int n, const byte *ap, const char *cp, const byte *tap, const char *tcp);
 
 	byte (*xchar_hook)(byte c);
+
+	errr (*batch_hook)(int n, const term_cell *cells);
+	term_cell *cells;
 };
 
 
@@ -341,6 +367,9 @@ extern byte tile_height;
 extern bool bigcurs;
 extern bool smlcurs;
 
+extern bool (*Term_xtra_journal)(int n, int v);
+extern void (*Term_key_journal)(const ui_event_data *ke);
+
 /**** Available Functions ****/
 
 extern errr Term_user(int n);
@@ -374,6 +403,7 @@ extern errr Term_mousepress(int x, int y, char button);
 extern errr Term_keypress(int k);
 extern errr Term_key_push(int k);
 extern errr Term_event_push(const ui_event_data *ke);
+extern bool Term_key_behind(void);
 extern errr Term_inkey(ui_event_data *ch, bool wait, bool take);
 
 extern errr Term_save(void);
@@ -20,7 +20,7 @@
 #include "z-form.h"
 
 #define TEXTBLOCK_LEN_INITIAL		128
-#define TEXTBLOCK_LEN_INCR(x)		(x + 128)
+#define TEXTBLOCK_LEN_INCR(x)		((x) * 2)
 
 struct textblock {
 	char *text;
@@ -28,6 +28,14 @@ struct textblock {
 
 	size_t strlen;
 	size_t size;
+
+	/* The text as last wrapped by textblock_lines() */
+	size_t *line_starts;
+	size_t *line_lengths;
+	size_t n_lines;
+	size_t lines_size;	/* Room in line_starts and line_lengths */
+	size_t lines_width;	/* Width wrapped to, or 0 if not wrapped */
+	size_t lines_strlen;	/* strlen when wrapped */
 };
 
 
@@ -36,11 +44,12 @@ struct textblock {
  */
 textblock *textblock_new(void)
 {
-	textblock *tb = mem_zalloc(sizeof *tb);
+	textblock *tb = mem_zalloc_tagged(sizeof *tb, MEM_TAG_TEXTBLOCK);
 
 	tb->size = TEXTBLOCK_LEN_INITIAL;
-	tb->text = mem_zalloc(tb->size);
-	tb->attrs = mem_zalloc(tb->size * sizeof *tb->attrs);
+	tb->text = mem_zalloc_tagged(tb->size, MEM_TAG_TEXTBLOCK);
+	tb->attrs = mem_zalloc_tagged(tb->size * sizeof *tb->attrs,
+			MEM_TAG_TEXTBLOCK);
 
 	return tb;
 }
@@ -52,9 +61,63 @@ void textblock_free(textblock *tb)
 {
 	mem_free(tb->text);
 	mem_free(tb->attrs);
+	mem_free(tb->line_starts);
+	mem_free(tb->line_lengths);
 	mem_free(tb);
 }
 
+/**
+ * Resize the buffers of `tb` to hold `size` bytes.
+ */
+static void textblock_resize(textblock *tb, size_t size)
+{
+	tb->size = size;
+	tb->text = mem_realloc(tb->text, tb->size);
+	tb->attrs = mem_realloc(tb->attrs, tb->size * sizeof *tb->attrs);
+}
+
+/**
+ * Make room for at least `len` more characters, so that a caller which
+ * knows roughly how much it will add can avoid growing the buffers bit by
+ * bit.
+ */
+void textblock_reserve(textblock *tb, size_t len)
+{
+	size_t need = tb->strlen + len + 2;
+
+	if (need > tb->size)
+		textblock_resize(tb, MAX(need, TEXTBLOCK_LEN_INCR(tb->size)));
+}
+
+/**
+ * Empty `tb`, keeping its buffers to be filled again.
+ */
+void textblock_clear(textblock *tb)
+{
+	tb->strlen = 0;
+	tb->text[0] = '\0';
+	tb->lines_width = 0;
+}
+
+/**
+ * Add `len` characters of `text` as they are, in the colours `attrs` (or
+ * white, if NULL).
+ */
+static void textblock_add(textblock *tb, const char *text, const byte *attrs,
+		size_t len)
+{
+	textblock_reserve(tb, len);
+
+	memcpy(tb->text + tb->strlen, text, len);
+	if (attrs)
+		memcpy(tb->attrs + tb->strlen, attrs, len * sizeof *tb->attrs);
+	else
+		memset(tb->attrs + tb->strlen, TERM_WHITE, len * sizeof *tb->attrs);
+
+	tb->strlen += len;
+	tb->text[tb->strlen] = '\0';
+}
+
 static void textblock_vappend_c(textblock *tb, byte attr, const char *fmt,
 		va_list vp)
 {
@@ -78,9 +141,7 @@ static void textblock_vappend_c(textblock *tb, byte attr, const char *fmt,
 			break;
 		}
 
-		tb->size = TEXTBLOCK_LEN_INCR(tb->size);
-		tb->text = mem_realloc(tb->text, tb->size);
-		tb->attrs = mem_realloc(tb->attrs, tb->size * sizeof *tb->attrs);
+		textblock_resize(tb, TEXTBLOCK_LEN_INCR(tb->size));
 	}
 }
 
@@ -133,7 +194,7 @@ static void new_line(size_t **line_starts, size_t **line_lengths,
 {
 	if (*cur_line == *n_lines) {
 		/* this number is not arbitrary: it's the height of a "standard" term */
-		(*n_lines) += 24;
+		(*n_lines) = *n_lines ? *n_lines * 2 : 24;
 
 		*line_starts = mem_realloc(*line_starts,
 				*n_lines * sizeof **line_starts);
@@ -148,18 +209,20 @@ static void new_line(size_t **line_starts, size_t **line_lengths,
 }
 
 /**
- * Given a certain width, split a textblock into wrapped lines of text.
+ * Wrap the text of `tb` to `width` into the arrays `line_starts` and
+ * `line_lengths`, which have room for `*n_lines` lines and are grown as
+ * needed.
  *
  * \returns Number of lines in output.
  */
-size_t textblock_calculate_lines(textblock *tb,
-		size_t **line_starts, size_t **line_lengths, size_t width)
+static size_t textblock_wrap(textblock *tb, size_t **line_starts,
+		size_t **line_lengths, size_t *n_lines, size_t width)
 {
 	const char *text = tb->text;
 
-	size_t cur_line = 0, n_lines = 0;
+	size_t cur_line = 0;
 
-	size_t len = strlen(text);
+	size_t len = tb->strlen;
 	size_t text_offset;
 
 	size_t line_start = 0, line_length = 0;
@@ -169,7 +232,7 @@ size_t textblock_calculate_lines(textblock *tb,
 
 	for (text_offset = 0; text_offset < len; text_offset++) {
 		if (text[text_offset] == '\n') {
-			new_line(line_starts, line_lengths, &n_lines, &cur_line,
+			new_line(line_starts, line_lengths, n_lines, &cur_line,
 					line_start, line_length);
 
 			line_start = text_offset + 1;
@@ -186,7 +249,7 @@ size_t textblock_calculate_lines(textblock *tb,
 
 		/* special case: if we have a very long word, just slice it */
 		if (word_length == width) {
-			new_line(line_starts, line_lengths, &n_lines, &cur_line,
+			new_line(line_starts, line_lengths, n_lines, &cur_line,
 					line_start, line_length);
 
 			line_start += line_length;
@@ -199,7 +262,7 @@ size_t textblock_calculate_lines(textblock *tb,
 			while (text[line_start + last_word_offset] != ' ')
 				last_word_offset--;
 
-			new_line(line_starts, line_lengths, &n_lines, &cur_line,
+			new_line(line_starts, line_lengths, n_lines, &cur_line,
 					line_start, last_word_offset);
 
 			line_start += word_start;
@@ -210,24 +273,121 @@ size_t textblock_calculate_lines(textblock *tb,
 	return cur_line;
 }
 
+/**
+ * Given a certain width, split a textblock into wrapped lines of text, in
+ * new arrays which the caller must free.
+ *
+ * \returns Number of lines in output.
+ */
+size_t textblock_calculate_lines(textblock *tb,
+		size_t **line_starts, size_t **line_lengths, size_t width)
+{
+	size_t n_lines = 0;
+
+	return textblock_wrap(tb, line_starts, line_lengths, &n_lines, width);
+}
+
+/**
+ * As textblock_calculate_lines(), but the arrays belong to the textblock,
+ * and are only worked out again when the text or the width has changed;
+ * they last until then, or until the textblock is freed.
+ *
+ * \returns Number of lines in output.
+ */
+size_t textblock_lines(textblock *tb, const size_t **line_starts,
+		const size_t **line_lengths, size_t width)
+{
+	if (tb->lines_width != width || tb->lines_strlen != tb->strlen) {
+		tb->n_lines = textblock_wrap(tb, &tb->line_starts,
+				&tb->line_lengths, &tb->lines_size, width);
+		tb->lines_width = width;
+		tb->lines_strlen = tb->strlen;
+	}
+
+	*line_starts = tb->line_starts;
+	*line_lengths = tb->line_lengths;
+
+	return tb->n_lines;
+}
+
+/**
+ * Add the text of `from` to `tb` as it is, colours and all.
+ */
+void textblock_append_textblock(textblock *tb, const textblock *from)
+{
+	textblock_add(tb, from->text, from->attrs, from->strlen);
+}
+
+/**
+ * Add the text of `from` to `tb`, wrapped and indented as
+ * textblock_to_file() would write it.
+ */
+void textblock_append_wrapped(textblock *tb, textblock *from, int indent,
+		int wrap_at)
+{
+	const size_t *line_starts;
+	const size_t *line_lengths;
+	char spaces[32];
+
+	size_t n_lines, i;
+
+	int width = wrap_at - indent;
+	assert(width > 0);
+
+	n_lines = textblock_lines(from, &line_starts, &line_lengths, width);
+
+	/* There's always at least one space before a line */
+	memset(spaces, ' ', sizeof(spaces));
+	indent = MAX(indent, 1);
+
+	for (i = 0; i < n_lines; i++) {
+		int j;
+
+		for (j = indent; j > 0; j -= sizeof(spaces))
+			textblock_add(tb, spaces, NULL, MIN(j, (int)sizeof(spaces)));
+
+		textblock_add(tb, from->text + line_starts[i],
+				from->attrs + line_starts[i], line_lengths[i]);
+		textblock_add(tb, "\n", NULL, 1);
+	}
+}
+
+/**
+ * Write the text of `tb` to file, as it is.
+ */
+bool textblock_write(textblock *tb, ang_file *f)
+{
+	return file_write(f, tb->text, tb->strlen);
+}
+
 /**
  * Output a textblock to file.
  */
 void textblock_to_file(textblock *tb, ang_file *f, int indent, int wrap_at)
 {
-	size_t *line_starts = NULL;
-	size_t *line_lengths = NULL;
+	const size_t *line_starts;
+	const size_t *line_lengths;
+	char spaces[32];
 
 	size_t n_lines, i;
 
 	int width = wrap_at - indent;
 	assert(width > 0);
 
-	n_lines = textblock_calculate_lines(tb, &line_starts, &line_lengths, width);
+	n_lines = textblock_lines(tb, &line_starts, &line_lengths, width);
+
+	/* There's always at least one space before a line */
+	memset(spaces, ' ', sizeof(spaces));
+	indent = MAX(indent, 1);
 
+	/* Write straight from the buffer, so long lines aren't cut short */
 	for (i = 0; i < n_lines; i++) {
-		file_putf(f, "%*c%.*s\n",
-				indent, ' ',
-				line_lengths[i], tb->text + line_starts[i]);
+		int j;
+
+		for (j = indent; j > 0; j -= sizeof(spaces))
+			file_write(f, spaces, MIN(j, (int)sizeof(spaces)));
+
+		file_write(f, tb->text + line_starts[i], line_lengths[i]);
+		file_write(f, "\n", 1);
 	}
 }
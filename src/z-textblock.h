@@ -11,6 +11,8 @@ typedef struct textblock textblock;
 textblock *textblock_new(void);
 void textblock_free(textblock *tb);
 
+void textblock_clear(textblock *tb);
+void textblock_reserve(textblock *tb, size_t len);
 void textblock_append(textblock *tb, const char *fmt, ...);
 void textblock_append_c(textblock *tb, byte attr, const char *fmt, ...);
 
@@ -18,7 +20,11 @@ const char *textblock_text(textblock *tb);
 const byte *textblock_attrs(textblock *tb);
 
 size_t textblock_calculate_lines(textblock *tb, size_t **line_starts, size_t **line_lengths, size_t width);
+size_t textblock_lines(textblock *tb, const size_t **line_starts, const size_t **line_lengths, size_t width);
 
+void textblock_append_textblock(textblock *tb, const textblock *from);
+void textblock_append_wrapped(textblock *tb, textblock *from, int indent, int wrap_at);
+bool textblock_write(textblock *tb, ang_file *f);
 void textblock_to_file(textblock *tb, ang_file *f, int indent, int wrap_at);
 
 #endif /* INCLUDED_Z_TEXTBLOCK_H */
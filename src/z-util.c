@@ -178,6 +178,32 @@ size_t my_strcat(char *buf, const char *src, size_t bufsize)
 }
 
 
+/*
+ * The next token of "str", or of what's left from last time if "str" is NULL
+ */
+char *my_strtok(char *str, const char *delim, char **rest)
+{
+	char *end;
+
+	if (!str) str = *rest;
+
+	/* Skip leading separators */
+	str += strspn(str, delim);
+	if (!*str)
+	{
+		*rest = str;
+		return NULL;
+	}
+
+	/* Terminate the token, and remember where to carry on from */
+	end = str + strcspn(str, delim);
+	if (*end) *end++ = '\0';
+	*rest = end;
+
+	return str;
+}
+
+
 /*
  * Determine if string "a" is equal to string "b"
  */
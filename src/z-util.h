@@ -59,6 +59,15 @@ extern size_t my_strcpy(char *buf, const char *src, size_t bufsize);
  */
 extern size_t my_strcat(char *buf, const char *src, size_t bufsize);
 
+/**
+ * Split 'str' into tokens separated by any of the characters in 'delim', as
+ * strtok() does, but keeping its place in '*rest' rather than in a static,
+ * so that it can be used from more than one thread at once.
+ *
+ * This function should be equivalent to the strtok_r() function in POSIX.
+ */
+extern char *my_strtok(char *str, const char *delim, char **rest);
+
 /* Test equality, prefix, suffix */
 extern bool streq(cptr s, cptr t);
 extern bool prefix(cptr s, cptr t);
@@ -18,12 +18,232 @@
 #include "z-virt.h"
 #include "z-util.h"
 
+#ifdef HAVE_PTHREAD_H
+# include <pthread.h>
+#endif
+
 unsigned int mem_flags = 0;
 
-#define SZ(uptr)	*((size_t *)((char *)(uptr) - sizeof(size_t)))
+/*
+ * Every block starts with a header holding its size and tag; it's two
+ * size_t's, rather than one, so as not to lose any alignment.
+ */
+struct mem_header {
+	size_t len;
+	size_t tag;
+};
+
+#define HDR(uptr)	((struct mem_header *)((char *)(uptr) - sizeof(struct mem_header)))
+
+
+static const struct mem_allocator mem_default = { malloc, realloc, free };
+static const struct mem_allocator *mem_hooks = &mem_default;
+
+static struct mem_stats mem_tags[MEM_TAG_MAX];
+static u32b mem_allocs;
+
+/*
+ * Blocks are allocated and freed by the edit file parsers, the autosave
+ * thread and the monster flow threads as well as the main thread, so the
+ * counts are kept under a lock.
+ */
+#ifdef HAVE_PTHREAD_H
+static pthread_mutex_t mem_lock = PTHREAD_MUTEX_INITIALIZER;
+# define mem_stats_lock()		pthread_mutex_lock(&mem_lock)
+# define mem_stats_unlock()	pthread_mutex_unlock(&mem_lock)
+#else
+# define mem_stats_lock()
+# define mem_stats_unlock()
+#endif
+
+static const char *mem_tag_names[MEM_TAG_MAX] = {
+	"misc",
+	"string",
+	"arena",
+	"message",
+	"textblock",
+	"menu"
+};
+
+/*
+ * Use allocator `a`, or malloc() again if `a` is NULL.  This must be done
+ * before anything is allocated, as blocks must be freed by the allocator
+ * which made them.
+ */
+void mem_set_allocator(const struct mem_allocator *a)
+{
+	mem_hooks = a ? a : &mem_default;
+}
 
 /*
- * Allocate `len` bytes of memory.
+ * Copy the statistics for `tag` into `st`
+ */
+void mem_tag_stats(int tag, struct mem_stats *st)
+{
+	mem_stats_lock();
+	*st = mem_tags[tag];
+	mem_stats_unlock();
+}
+
+/*
+ * The number of blocks ever allocated
+ */
+u32b mem_alloc_count(void)
+{
+	u32b n;
+
+	mem_stats_lock();
+	n = mem_allocs;
+	mem_stats_unlock();
+
+	return n;
+}
+
+const char *mem_tag_name(int tag)
+{
+	return mem_tag_names[tag];
+}
+
+
+#ifdef MEM_POOL
+
+/*
+ * Small blocks, header included, come from pools of slots of a few fixed
+ * sizes: POOL_GRAIN bytes, twice that, and so on up to POOL_MAX.  Each pool
+ * is a list of free slots, which is refilled a slab at a time; slabs are
+ * never given back, but their slots are used again and again, so small
+ * blocks neither fragment the heap nor cost a malloc() each.
+ *
+ * The free lists are shared by every thread which allocates, so they are
+ * kept under a lock of their own.
+ */
+#define POOL_GRAIN	16
+#define POOL_CLASSES	16
+#define POOL_MAX	(POOL_GRAIN * POOL_CLASSES)
+#define POOL_SLAB	65536
+
+struct pool_slot {
+	struct pool_slot *next;
+};
+
+static struct pool_slot *pool_slots[POOL_CLASSES];
+
+#ifdef HAVE_PTHREAD_H
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+# define pool_lock()		pthread_mutex_lock(&pool_mutex)
+# define pool_unlock()	pthread_mutex_unlock(&pool_mutex)
+#else
+# define pool_lock()
+# define pool_unlock()
+#endif
+
+static void *pool_alloc(size_t size)
+{
+	int c = (size - 1) / POOL_GRAIN;
+	struct pool_slot *s;
+
+	pool_lock();
+	s = pool_slots[c];
+
+	if (!s) {
+		size_t slot = (c + 1) * POOL_GRAIN;
+		size_t i = POOL_SLAB / slot;
+		char *slab = mem_hooks->alloc(POOL_SLAB);
+
+		if (!slab) {
+			pool_unlock();
+			return NULL;
+		}
+
+		/* Hand the slots out in address order */
+		while (i--) {
+			s = (struct pool_slot *)(slab + i * slot);
+			s->next = pool_slots[c];
+			pool_slots[c] = s;
+		}
+	}
+
+	pool_slots[c] = s->next;
+	pool_unlock();
+
+	return s;
+}
+
+static void pool_free(void *p, size_t size)
+{
+	int c = (size - 1) / POOL_GRAIN;
+	struct pool_slot *s = p;
+
+	pool_lock();
+	s->next = pool_slots[c];
+	pool_slots[c] = s;
+	pool_unlock();
+}
+
+#endif /* MEM_POOL */
+
+/*
+ * Get, give back and resize `size` bytes of raw memory
+ */
+static void *block_alloc(size_t size)
+{
+#ifdef MEM_POOL
+	if (size <= POOL_MAX) return pool_alloc(size);
+#endif
+
+	return mem_hooks->alloc(size);
+}
+
+static void block_free(void *b, size_t size)
+{
+#ifdef MEM_POOL
+	if (size <= POOL_MAX) {
+		pool_free(b, size);
+		return;
+	}
+#else
+	(void)size;
+#endif
+
+	mem_hooks->free(b);
+}
+
+static void *block_realloc(void *b, size_t old, size_t size)
+{
+#ifdef MEM_POOL
+	/* Moving in or out of a pool needs a copy */
+	if (old <= POOL_MAX || size <= POOL_MAX) {
+		void *res = block_alloc(size);
+
+		if (res) {
+			memcpy(res, b, MIN(old, size));
+			block_free(b, old);
+		}
+
+		return res;
+	}
+#else
+	(void)old;
+#endif
+
+	return mem_hooks->realloc(b, size);
+}
+
+/*
+ * Note that `len` more bytes (which may be negative) belong to `tag`; the
+ * caller holds the lock
+ */
+static void mem_account(size_t tag, long len)
+{
+	struct mem_stats *st = &mem_tags[tag];
+
+	st->bytes += len;
+	if (st->bytes > st->peak)
+		st->peak = st->bytes;
+}
+
+/*
+ * Allocate `len` bytes of memory, to be counted against `tag`.
  *
  * Returns:
  *  - NULL if `len` == 0; or
@@ -31,55 +251,97 @@ unsigned int mem_flags = 0;
  *
  * Doesn't return on out of memory.
  */
-void *mem_alloc(size_t len)
+void *mem_alloc_tagged(size_t len, int tag)
 {
+	struct mem_header *h;
 	char *mem;
 
 	/* Allow allocation of "zero bytes" */
 	if (len == 0) return (NULL);
 
-	mem = malloc(len + sizeof(size_t));
-	if (!mem)
+	h = block_alloc(len + sizeof(*h));
+	if (!h)
 		quit("Out of Memory!");
-	mem += sizeof(size_t);
+	h->len = len;
+	h->tag = tag;
+
+	mem_stats_lock();
+	mem_allocs++;
+	mem_tags[tag].count++;
+	mem_tags[tag].allocs++;
+	mem_account(tag, len);
+	mem_stats_unlock();
+
+	mem = (char *)(h + 1);
 	if (mem_flags & MEM_POISON_ALLOC)
 		memset(mem, 0xCC, len);
-	SZ(mem) = len;
 
 	return mem;
 }
 
-void *mem_zalloc(size_t len)
+void *mem_alloc(size_t len)
 {
-	void *mem = mem_alloc(len);
+	return mem_alloc_tagged(len, MEM_TAG_MISC);
+}
+
+void *mem_zalloc_tagged(size_t len, int tag)
+{
+	void *mem = mem_alloc_tagged(len, tag);
 	memset(mem, 0, len);
 	return mem;
 }
 
+void *mem_zalloc(size_t len)
+{
+	return mem_zalloc_tagged(len, MEM_TAG_MISC);
+}
+
 void mem_free(void *p)
 {
+	struct mem_header *h;
+
 	if (!p) return;
 
+	h = HDR(p);
+	mem_stats_lock();
+	mem_tags[h->tag].count--;
+	mem_account(h->tag, -(long)h->len);
+	mem_stats_unlock();
+
 	if (mem_flags & MEM_POISON_FREE)
-		memset(p, 0xCD, SZ(p));
-	free((char *)p - sizeof(size_t));
+		memset(p, 0xCD, h->len);
+	block_free(h, h->len + sizeof(*h));
 }
 
+/*
+ * Resize block `p`, which keeps its tag; if `p` is NULL this is just
+ * mem_alloc().
+ */
 void *mem_realloc(void *p, size_t len)
 {
-	char *m = p;
+	struct mem_header *h;
+	size_t tag, old;
 
 	/* Fail gracefully */
 	if (len == 0) return (NULL);
 
-	m = realloc(m ? m - sizeof(size_t) : NULL, len + sizeof(size_t));
-	m += sizeof(size_t);
+	if (!p) return mem_alloc(len);
+
+	h = HDR(p);
+	tag = h->tag;
+	old = h->len;
+
+	h = block_realloc(h, old + sizeof(*h), len + sizeof(*h));
 
 	/* Handle OOM */
-	if (!m) quit("Out of Memory!");
-	SZ(m) = len;
+	if (!h) quit("Out of Memory!");
+	h->len = len;
+
+	mem_stats_lock();
+	mem_account(tag, (long)len - (long)old);
+	mem_stats_unlock();
 
-	return m;
+	return h + 1;
 }
 
 /*
@@ -95,7 +357,7 @@ char *string_make(const char *str)
 
 	/* Allocate space for the string (including terminator) */
 	siz = strlen(str) + 1;
-	res = mem_alloc(siz);
+	res = mem_alloc_tagged(siz, MEM_TAG_STRING);
 
 	/* Copy the string (with terminator) */
 	my_strcpy(res, str, siz);
@@ -122,3 +384,119 @@ char *string_append(char *s1, const char *s2) {
 	strcpy(s1 + len, s2);
 	return s1;
 }
+
+
+/*
+ * A string arena hands out strings from large blocks, and frees them all
+ * together.  It suits strings which are never freed one by one, such as
+ * those read from the edit files; it saves a malloc() and a size header
+ * for each, and keeps related text close together.
+ */
+#define ARENA_BLOCK_SIZE	65536
+
+struct arena_block {
+	struct arena_block *next;
+	size_t used;
+	size_t size;
+	char data[1];
+};
+
+struct mem_arena {
+	struct arena_block *blocks;
+	char *last;		/* Most recent string, which can grow in place */
+};
+
+mem_arena *arena_new(void)
+{
+	return mem_zalloc_tagged(sizeof(mem_arena), MEM_TAG_ARENA);
+}
+
+/*
+ * Find room for `len` bytes in arena `a`, starting a new block if needed.
+ */
+static char *arena_alloc(mem_arena *a, size_t len)
+{
+	struct arena_block *b = a->blocks;
+	char *res;
+
+	if (!b || b->size - b->used < len) {
+		size_t size = MAX(len, ARENA_BLOCK_SIZE);
+
+		b = mem_alloc_tagged(sizeof(*b) + size, MEM_TAG_ARENA);
+		b->size = size;
+		b->used = 0;
+		b->next = a->blocks;
+		a->blocks = b;
+	}
+
+	res = b->data + b->used;
+	b->used += len;
+	a->last = res;
+
+	return res;
+}
+
+/*
+ * Duplicates `str` in arena `a`.
+ */
+char *arena_string(mem_arena *a, const char *str)
+{
+	size_t siz;
+	char *res;
+
+	if (!str) return NULL;
+
+	siz = strlen(str) + 1;
+	res = arena_alloc(a, siz);
+	memcpy(res, str, siz);
+
+	return res;
+}
+
+/*
+ * Appends `s2` to `s1`, which must be NULL or from arena `a`, as
+ * string_append() does.  `s1` is extended in place if it was the last
+ * string made and there is room after it; otherwise it is copied, and the
+ * old copy wasted until the arena is freed.
+ */
+char *arena_append(mem_arena *a, char *s1, const char *s2)
+{
+	struct arena_block *b = a->blocks;
+	size_t len1, len2;
+	char *res;
+
+	if (!s2) return s1;
+	if (!s1) return arena_string(a, s2);
+
+	len1 = strlen(s1);
+	len2 = strlen(s2);
+
+	if (s1 == a->last && b->size - b->used >= len2) {
+		memcpy(s1 + len1, s2, len2 + 1);
+		b->used += len2;
+		return s1;
+	}
+
+	res = arena_alloc(a, len1 + len2 + 1);
+	memcpy(res, s1, len1);
+	memcpy(res + len1, s2, len2 + 1);
+
+	return res;
+}
+
+/*
+ * Frees arena `a` and every string in it.
+ */
+void arena_free(mem_arena *a)
+{
+	struct arena_block *b, *next;
+
+	if (!a) return;
+
+	for (b = a->blocks; b; b = next) {
+		next = b->next;
+		mem_free(b);
+	}
+
+	mem_free(a);
+}
@@ -13,6 +13,12 @@
 
 #include "h-basic.h"
 
+/*
+ * OPTION: Serve small blocks from pools of fixed-size slots, rather than
+ * from malloc() one by one (see z-virt.c)
+ */
+/* #define MEM_POOL */
+
 /* Wipe an array of type T[N], at location P, and return P */
 #define C_WIPE(P, N, T) \
 	(memset((P), 0, (N) * sizeof(T)))
@@ -53,7 +59,47 @@
 #define FREE(P) (mem_free(P), P = NULL)
 
 /* Replacements for malloc() and friends that die on failure. */
+/*
+ * What memory is allocated for, so that its use can be counted
+ */
+enum {
+	MEM_TAG_MISC = 0,
+	MEM_TAG_STRING,		/* string_make() */
+	MEM_TAG_ARENA,		/* String arenas */
+	MEM_TAG_MSG,		/* The message log */
+	MEM_TAG_TEXTBLOCK,	/* Text blocks */
+	MEM_TAG_MENU,		/* Menus */
+
+	MEM_TAG_MAX
+};
+
+/*
+ * Memory use of one tag
+ */
+struct mem_stats {
+	long bytes;		/* Bytes in use now */
+	long peak;		/* Most bytes ever in use at once */
+	u32b count;		/* Blocks in use now */
+	u32b allocs;		/* Blocks ever allocated */
+};
+
+/*
+ * Where the memory comes from; malloc(), realloc() and free() by default
+ */
+struct mem_allocator {
+	void *(*alloc)(size_t len);
+	void *(*realloc)(void *p, size_t len);
+	void (*free)(void *p);
+};
+
+void mem_set_allocator(const struct mem_allocator *a);
+void mem_tag_stats(int tag, struct mem_stats *st);
+u32b mem_alloc_count(void);
+const char *mem_tag_name(int tag);
+
+void *mem_alloc_tagged(size_t len, int tag);
 void *mem_alloc(size_t len);
+void *mem_zalloc_tagged(size_t len, int tag);
 void *mem_zalloc(size_t len);
 void mem_free(void *p);
 void *mem_realloc(void *p, size_t len);
@@ -62,6 +108,14 @@ char *string_make(const char *str);
 void string_free(char *str);
 char *string_append(char *s1, const char *s2);
 
+/* Strings that are all freed at once */
+typedef struct mem_arena mem_arena;
+
+mem_arena *arena_new(void);
+char *arena_string(mem_arena *a, const char *str);
+char *arena_append(mem_arena *a, char *s1, const char *s2);
+void arena_free(mem_arena *a);
+
 enum {
 	MEM_POISON_ALLOC = 0x00000001,
 	MEM_POISON_FREE  = 0x00000002